@@ -217,7 +217,8 @@ async function loadInitialData() {
         loadWeather(),
         loadCalendar(),
         loadIntegrations(),
-        loadVoiceConfig()
+        loadVoiceConfig(),
+        loadCalibrationStatus()
     ]);
 }
 
@@ -308,9 +309,12 @@ function updateSystemStatus(status) {
     }
 }
 
+let loadedCommands = [];
+
 async function loadCommands() {
     const data = await apiGet('commands');
     if (data && data.commands) {
+        loadedCommands = data.commands;
         renderCommandsTable(data.commands);
     } else {
         // Show sample commands
@@ -810,14 +814,76 @@ async function saveVoiceSettings() {
     }
 }
 
+// Microphone calibration
+let calibrationPollInterval = null;
+
+async function startCalibration() {
+    const duration = parseInt(document.getElementById('calibrationDuration').value) || 5;
+    const phrase = document.getElementById('calibrationPhrase').checked;
+    
+    const result = await apiPost('voice/calibrate', { duration, phrase });
+    if (!result || !result.success) {
+        showNotification('Failed to start calibration', 'error');
+        return;
+    }
+    
+    showNotification('Calibrating - keep quiet...', 'info');
+    if (calibrationPollInterval) clearInterval(calibrationPollInterval);
+    calibrationPollInterval = setInterval(loadCalibrationStatus, 1000);
+}
+
+async function loadCalibrationStatus() {
+    const status = await apiGet('voice/calibration');
+    if (!status) return;
+    
+    const statusText = status.running ? `${status.phase} (${status.progress}%)` :
+        (status.calibrated ? 'Calibrated' : 'Defaults');
+    document.getElementById('calibrationStatus').textContent = statusText;
+    document.getElementById('calibrationNoiseFloor').textContent = status.noise?.floor ?? 0;
+    document.getElementById('calibrationThresholds').textContent =
+        `${status.thresholds?.speech ?? 0} / ${status.thresholds?.silence ?? 0}`;
+    
+    if (!status.running && calibrationPollInterval) {
+        clearInterval(calibrationPollInterval);
+        calibrationPollInterval = null;
+        if (status.phase === 'failed') {
+            showNotification('Calibration failed: ' + (status.error || 'unknown error'), 'error');
+        } else {
+            showNotification('Calibration complete', 'success');
+        }
+    }
+}
+
 // Keep old function name for backwards compatibility
 async function saveWakeWordSettings() {
     return saveVoiceSettings();
 }
 
+// Prompt for a command's fields; returns null if cancelled
+function promptCommand(cmd) {
+    const command = prompt('Spoken phrase:', cmd.command || '');
+    if (!command) return null;
+    const action = prompt('Action (homeassistant:<domain>.<id>:<service>, scene:<id>, mqtt:<topic>:<payload>, query:<name>):',
+                          cmd.action || 'homeassistant:light.living_room:on');
+    if (!action) return null;
+    const category = prompt('Category:', cmd.category || 'Custom');
+    if (category === null) return null;
+    return { ...cmd, command, action, category };
+}
+
+async function saveCommand(cmd) {
+    const result = await apiPost('commands', cmd);
+    if (result && result.success) {
+        showNotification('Command saved', 'success');
+        loadCommands();
+    } else {
+        showNotification('Failed to save command (check the action format)', 'error');
+    }
+}
+
 function showAddCommandModal() {
-    // TODO: Implement modal for adding commands
-    alert('Add Command feature coming soon!');
+    const cmd = promptCommand({ enabled: true });
+    if (cmd) saveCommand(cmd);
 }
 
 function showAddPersonModal() {
@@ -826,8 +892,10 @@ function showAddPersonModal() {
 }
 
 function editCommand(id) {
-    console.log('Editing command:', id);
-    alert('Edit command feature coming soon!');
+    const existing = loadedCommands.find(c => c.id === id);
+    if (!existing) return;
+    const cmd = promptCommand(existing);
+    if (cmd) saveCommand(cmd);
 }
 
 async function deleteCommand(id) {
@@ -0,0 +1,181 @@
+#ifndef ACTION_EXECUTOR_H
+#define ACTION_EXECUTOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "command_engine.h"
+
+// Asynchronous execution of command actions
+//
+// Matching a command only queues its action; a drain pass performs it and
+// reports completion later. On the way in, an action identical to one
+// accepted within the dedup window is dropped, so a double trigger does not
+// open the gate twice. An object-id list ("light.porch,hallway,kitchen:off")
+// fans out into one action per entity. All of them are issued in the same
+// pass and retried independently, so one unreachable entity does not hold
+// up the others or the commands queued behind it. A failed action is retried
+// with exponential backoff. The command completes once all of its actions
+// have succeeded or given up, with its latency measured from submission.
+//
+// Fixed-size tables, no allocation after construction. The queue is
+// portable and takes the time as a parameter; scripts/action_queue_test.cpp
+// drives it with a simulated clock on the host.
+
+#define ACTION_QUEUE_SIZE       16      // Entity actions in flight
+#define ACTION_MAX_GROUPS       8       // Submitted commands awaiting completion
+#define ACTION_DEDUP_HISTORY    8
+#define ACTION_LABEL_LEN        64
+#define ACTION_DEFAULT_DEDUP_MS 1500
+#define ACTION_DEFAULT_ATTEMPTS 4
+#define ACTION_DEFAULT_RETRY_MS 250     // Backoff 250, 500, 1000 ms, ...
+
+enum ActionStatus : uint8_t {
+    ACTION_QUEUED,
+    ACTION_DUPLICATE,           // Same action accepted within the dedup window
+    ACTION_REJECTED             // Queue full or no entities in the target list
+};
+
+struct ActionOutcome {
+    uint32_t id;
+    bool success;               // Every entity action succeeded
+    uint8_t actions;            // Fan-out
+    uint8_t failed;
+    uint8_t attempts;           // Over all entity actions
+    uint32_t latencyMs;         // Submission to last completion
+    const char* label;
+};
+
+// Perform one entity action; false to retry later
+typedef bool (*ActionPerformer)(const CommandAction& action, void* ctx);
+typedef void (*ActionCompletion)(const ActionOutcome& outcome, void* ctx);
+
+struct ActionStats {
+    uint32_t submitted;
+    uint32_t duplicates;
+    uint32_t rejected;
+    uint32_t completed;         // Commands, all actions succeeded
+    uint32_t failed;            // Commands with at least one action given up
+    uint32_t performed;         // Entity action attempts
+    uint32_t retries;
+    uint32_t lastLatencyMs;     // Per entity action, successful ones
+    uint32_t maxLatencyMs;
+    uint64_t latencySumMs;
+    uint32_t latencyCount;
+};
+
+class ActionQueue {
+public:
+    ActionQueue();
+
+    void setPerformer(ActionPerformer fn, void* ctx);
+    void setCompletion(ActionCompletion fn, void* ctx);
+    void configure(uint32_t dedupMs, uint8_t maxAttempts, uint32_t retryMs);
+
+    // Queue an action; `label` is reported back on completion. `id` (optional)
+    // receives the command id for ACTION_QUEUED.
+    ActionStatus submit(const CommandAction& action, const char* label, uint32_t now, uint32_t* id = nullptr);
+
+    // Perform up to `budget` due actions, oldest first; returns how many ran
+    int process(uint32_t now, int budget = ACTION_QUEUE_SIZE);
+
+    // Time until the next retry is due (0 = now, UINT32_MAX = idle)
+    uint32_t nextDue(uint32_t now) const;
+
+    size_t getPending() const;
+    const ActionStats& getStats() const { return stats; }
+
+private:
+    struct Job {
+        CommandAction action;
+        uint32_t seq;           // Submission order
+        uint32_t due;
+        uint8_t group;
+        uint8_t attempts;
+        bool used;
+    };
+
+    struct Group {
+        uint32_t id;
+        uint32_t submitted;
+        uint8_t actions;
+        uint8_t remaining;
+        uint8_t failed;
+        uint8_t attempts;
+        bool used;
+        char label[ACTION_LABEL_LEN];
+    };
+
+    struct Recent {
+        uint32_t hash;
+        uint32_t time;
+        bool used;
+    };
+
+    Job jobs[ACTION_QUEUE_SIZE];
+    Group groups[ACTION_MAX_GROUPS];
+    Recent recent[ACTION_DEDUP_HISTORY];
+    uint8_t recentNext;
+    uint32_t nextId;
+    uint32_t nextSeq;
+
+    ActionPerformer performer;
+    void* performerCtx;
+    ActionCompletion completion;
+    void* completionCtx;
+    uint32_t dedupMs;
+    uint8_t maxAttempts;
+    uint32_t retryMs;
+    ActionStats stats;
+
+    void finish(Job& job, bool success, uint32_t now);
+};
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#define ACTION_MAX_DEFERRED     4       // Command texts from callbacks
+#define ACTION_DEFERRED_LEN     128
+
+// Performs queued actions over MQTT from the main loop (PubSubClient is not
+// thread-safe, so the drain pass runs there rather than in its own task)
+class ActionExecutor {
+public:
+    ActionExecutor();
+
+    // config["actions"]: dedup_ms, max_attempts, retry_ms
+    void begin(JsonDocument& config);
+    void loop();
+
+    ActionStatus submit(const CommandAction& action, const char* label, uint32_t* id = nullptr);
+    // Action string as in commands.json
+    ActionStatus submit(const char* action, const char* label, uint32_t* id = nullptr);
+
+    void setCompletion(ActionCompletion fn, void* ctx) { queue.setCompletion(fn, ctx); }
+
+    // Hand a command text received in a callback to `handler` on the next
+    // loop(). The MQTT callback must not publish: PubSubClient reuses its
+    // buffer, so the payload would be overwritten.
+    bool defer(const char* text);
+    void setCommandHandler(void (*handler)(const char* text)) { commandHandler = handler; }
+
+    void getStatusJson(JsonObject obj);
+
+private:
+    ActionQueue queue;
+    void (*commandHandler)(const char* text);
+    char deferred[ACTION_MAX_DEFERRED][ACTION_DEFERRED_LEN];
+    uint8_t deferredHead;
+    uint8_t deferredCount;
+    uint32_t deferredDropped;
+
+    static bool perform(const CommandAction& action, void* ctx);
+};
+
+extern ActionExecutor actionExecutor;
+#endif
+
+#endif
@@ -2,6 +2,7 @@
 #define AUDIO_HANDLER_H
 
 #include <driver/i2s.h>
+#include <atomic>
 #include "config.h"
 
 class AudioHandler {
@@ -20,11 +21,17 @@ public:
     int16_t* getAudioBuffer();
     size_t getBufferSize();
     
+    // Latest frame level for the UI, published once per captured frame.
+    // Lock-free: (sequence << 16) | peak, so readers can skip stale values.
+    void publishLevel(int16_t peak);
+    uint32_t getLevelSnapshot() const { return levelSnapshot.load(std::memory_order_relaxed); }
+    
 private:
     bool initialized;
     bool recording;
     int16_t audioBuffer[AUDIO_BUFFER_SIZE];
     size_t bufferIndex;
+    std::atomic<uint32_t> levelSnapshot;
     
     void configureI2S();
     void processAudio();
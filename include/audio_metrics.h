@@ -0,0 +1,98 @@
+#ifndef AUDIO_METRICS_H
+#define AUDIO_METRICS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "config.h"
+
+// Per-utterance audio quality metrics
+// Computed incrementally while samples are copied into the STT recording
+// buffer (no extra pass over the audio), then attached to the STT result
+// and kept in a small ring buffer for the web API / MQTT.
+
+#define AUDIO_METRICS_HISTORY   16
+#define AUDIO_METRICS_MAX_FRAMES 256   // Per-utterance frame power slots (~8s of 512-sample frames)
+
+struct UtteranceMetrics {
+    uint32_t id;
+    time_t timestamp;
+    uint32_t samples;            // Samples stored in the recording buffer
+    uint32_t durationMs;
+    uint32_t speechMs;           // Duration of frames above the silence threshold
+    float peakDbfs;
+    float rmsDbfs;
+    float snrDb;                 // Speech frame power vs noise frame power
+    uint32_t clippedSamples;
+    int16_t dcOffset;
+    uint32_t droppedSamples;     // Lost to I2S DMA overrun while the loop stalled
+    uint32_t truncatedSamples;   // Lost because the recording buffer was full
+    char transcription[96];
+    char error[48];
+};
+
+class AudioMetrics {
+public:
+    AudioMetrics();
+
+    // Start a new utterance; frames with a peak above silenceLevel count as speech
+    void beginUtterance(int16_t silenceLevel);
+
+    // Copy samples into the recording buffer and accumulate metrics in the same pass
+    void copyAndAccumulate(int16_t* dest, const int16_t* src, size_t count);
+
+    // Samples that could not be stored (recording buffer full)
+    void addTruncated(size_t count);
+
+    // Finalize metrics for the current utterance (before it is sent to STT)
+    void endUtterance();
+
+    // Drop the current utterance (recording cancelled)
+    void discard();
+
+    // Attach the STT result and store the finalized utterance in the history
+    // Returns the stored entry, or nullptr if no utterance was pending
+    const UtteranceMetrics* attachResult(const char* transcription, const char* error);
+
+    const UtteranceMetrics* getLast() const;
+    uint32_t getCount() const { return totalCount; }
+
+    static void toJson(const UtteranceMetrics& m, JsonObject obj);
+    void getHistoryJson(JsonDocument& doc);
+
+private:
+    // History ring buffer
+    UtteranceMetrics history[AUDIO_METRICS_HISTORY];
+    int historyHead;             // Next slot to write
+    int historyCount;
+    uint32_t totalCount;
+
+    // Current utterance accumulators
+    bool active;
+    bool pending;                // Finalized, waiting for the STT result
+    UtteranceMetrics current;
+    int16_t silenceLevel;
+    uint32_t sampleCount;
+    int64_t sum;
+    uint64_t sumSquares;
+    int32_t peak;
+    uint32_t clipped;
+    uint32_t truncated;
+    unsigned long startMs;
+
+    // Per-frame power (mean square) for SNR / speech duration
+    uint32_t framePower[AUDIO_METRICS_MAX_FRAMES];
+    bool frameIsSpeech[AUDIO_METRICS_MAX_FRAMES];
+    int frameCount;
+    uint32_t speechSamples;
+
+    // I2S DMA backlog model for dropped sample estimation
+    unsigned long lastFrameMicros;
+    uint32_t backlogSamples;
+    uint32_t dropped;
+
+    static float toDbfs(float level);
+};
+
+extern AudioMetrics audioMetrics;
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef AUDIO_PIPELINE_H
+#define AUDIO_PIPELINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// Composable audio pipeline
+// A fixed-size frame is pulled from the source stage and handed through an
+// ordered list of stages. Each stage declares its input/output format and a
+// per-frame CPU budget; the pipeline measures every stage against it.
+//
+// This file and the DSP stages in audio_stages.h do not depend on Arduino so
+// they can be built and benchmarked on a Linux host.
+
+#define AUDIO_FRAME_SAMPLES     AUDIO_BUFFER_SIZE
+#define AUDIO_FRAME_PERIOD_US   ((uint32_t)AUDIO_FRAME_SAMPLES * 1000000UL / SAMPLE_RATE)
+#define AUDIO_PIPELINE_MAX_STAGES 10
+
+enum AudioFormat {
+    AUDIO_FORMAT_NONE = 0,      // No audio (source input / sink output)
+    AUDIO_FORMAT_PCM16          // 16-bit mono PCM at SAMPLE_RATE
+};
+
+struct AudioFrame {
+    int16_t samples[AUDIO_FRAME_SAMPLES];
+    size_t count;
+    uint32_t seq;
+
+    // Filled in by stages
+    int16_t peak;               // Max absolute sample (level stage)
+    int16_t rms;                // RMS level (level stage)
+    uint16_t zeroCrossings;     // Zero crossings in frame (features stage)
+    bool vadArmed;              // Set by the caller: VAD may trigger on this frame
+    bool vadTriggered;          // VAD stage detected voice activity
+};
+
+const char* audioFormatName(AudioFormat format);
+
+// Per-stage CPU statistics
+struct AudioStageStats {
+    uint32_t frames;
+    uint64_t totalUs;
+    uint32_t maxUs;
+    uint32_t lastUs;
+    uint32_t overruns;          // Frames that exceeded the stage budget
+};
+
+class AudioStage {
+public:
+    AudioStage(const char* name, AudioFormat input, AudioFormat output, uint32_t budgetUs);
+    virtual ~AudioStage() {}
+
+    // Process one frame in place. Return false to stop the chain for this frame.
+    virtual bool process(AudioFrame& frame) = 0;
+
+    // Reset internal filter/gain state (e.g. after the pipeline is rebuilt)
+    virtual void reset() {}
+
+    const char* getName() const { return name; }
+    AudioFormat getInputFormat() const { return inputFormat; }
+    AudioFormat getOutputFormat() const { return outputFormat; }
+
+    uint32_t getBudgetUs() const { return budgetUs; }
+    void setBudgetUs(uint32_t us) { budgetUs = us; }
+
+    const AudioStageStats& getStats() const { return stats; }
+    void resetStats();
+    void recordTiming(uint32_t us);
+
+private:
+    const char* name;
+    AudioFormat inputFormat;
+    AudioFormat outputFormat;
+    uint32_t budgetUs;
+    AudioStageStats stats;
+};
+
+class AudioPipeline {
+public:
+    AudioPipeline();
+    ~AudioPipeline();
+
+    // Append a stage; the pipeline takes ownership. Returns false if the
+    // stage's input format does not match the previous stage's output.
+    bool addStage(AudioStage* stage);
+
+    // Delete all stages
+    void clear();
+
+    // Run one frame through all stages. The first stage is the source and
+    // fills the frame; returns false if it produced no samples.
+    bool run(AudioFrame& frame);
+
+    int getStageCount() const { return stageCount; }
+    AudioStage* getStage(int index) const { return (index >= 0 && index < stageCount) ? stages[index] : nullptr; }
+    AudioStage* findStage(const char* name) const;
+
+    uint32_t getFrameCount() const { return frameCount; }
+    uint32_t getLastFrameUs() const { return lastFrameUs; }
+    uint32_t getMaxFrameUs() const { return maxFrameUs; }
+    void resetStats();
+
+private:
+    AudioStage* stages[AUDIO_PIPELINE_MAX_STAGES];
+    int stageCount;
+    uint32_t frameCount;
+    uint32_t lastFrameUs;
+    uint32_t maxFrameUs;
+};
+
+// Monotonic microsecond clock (micros() on the device, steady_clock on a host)
+uint32_t audioPipelineMicros();
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef AUDIO_STAGES_H
+#define AUDIO_STAGES_H
+
+#include "audio_pipeline.h"
+
+// Audio pipeline stages
+//
+// Stage names used in config["voice"]["pipeline"]:
+//   source     - I2S microphone (INMP441), fills the frame
+//   condition  - DC / rumble removal (one-pole high-pass)
+//   agc        - Automatic gain control towards a target peak level
+//   level      - Frame peak / RMS (drives VAD thresholds and calibration)
+//   features   - Per-frame features (zero-crossing count)
+//   vad        - Voice activity trigger (VoiceActivityHandler)
+//   tones      - DTMF / fixed-tone detection (see tone_detector.h)
+//   events     - Acoustic event detection (see sound_events.h)
+//   recorder   - Feeds the HA Assist recording buffer
+//   streamer   - Hands frames to a registered sink (e.g. network streaming)
+
+// Default per-frame CPU budgets (µs); one frame is AUDIO_FRAME_PERIOD_US long
+#define STAGE_BUDGET_CONDITION_US   300
+#define STAGE_BUDGET_AGC_US         300
+#define STAGE_BUDGET_LEVEL_US       200
+#define STAGE_BUDGET_FEATURES_US    200
+#define STAGE_BUDGET_VAD_US         500
+#define STAGE_BUDGET_RECORDER_US    1000
+#define STAGE_BUDGET_STREAMER_US    1000
+
+// ============================================
+// Portable DSP stages (no Arduino dependency)
+// ============================================
+
+class DcRemovalStage : public AudioStage {
+public:
+    DcRemovalStage();
+    bool process(AudioFrame& frame) override;
+    void reset() override;
+
+private:
+    int32_t prevInput;
+    int32_t prevOutput;
+};
+
+class AgcStage : public AudioStage {
+public:
+    // targetPeak: desired frame peak, maxGain: upper gain limit (x1..x16)
+    AgcStage(int16_t targetPeak = 8000, uint8_t maxGain = 8, int16_t noiseGate = 200);
+    bool process(AudioFrame& frame) override;
+    void reset() override;
+
+    float getGain() const { return gainQ8 / 256.0f; }
+
+private:
+    int32_t targetPeak;
+    int32_t maxGainQ8;
+    int32_t noiseGate;
+    int32_t gainQ8;             // Current gain, 256 = x1
+};
+
+class LevelStage : public AudioStage {
+public:
+    LevelStage();
+    bool process(AudioFrame& frame) override;
+};
+
+class FeatureStage : public AudioStage {
+public:
+    FeatureStage();
+    bool process(AudioFrame& frame) override;
+};
+
+// ============================================
+// Device stages and pipeline setup
+// ============================================
+#ifdef ARDUINO
+#include <ArduinoJson.h>
+
+typedef void (*AudioFrameSink)(const AudioFrame& frame);
+
+class I2SSourceStage : public AudioStage {
+public:
+    I2SSourceStage();
+    bool process(AudioFrame& frame) override;
+};
+
+class VadStage : public AudioStage {
+public:
+    VadStage();
+    bool process(AudioFrame& frame) override;
+};
+
+class RecorderStage : public AudioStage {
+public:
+    RecorderStage();
+    bool process(AudioFrame& frame) override;
+};
+
+class StreamerStage : public AudioStage {
+public:
+    StreamerStage();
+    bool process(AudioFrame& frame) override;
+
+    static void setSink(AudioFrameSink sink);
+
+private:
+    static volatile AudioFrameSink sink;
+};
+
+extern AudioPipeline audioPipeline;
+
+// Build the pipeline from config["voice"]["pipeline"] (falls back to defaults)
+bool setupAudioPipeline(JsonDocument& config);
+
+// Per-stage timing statistics for /api/status
+void getAudioPipelineStatsJson(JsonObject obj);
+#endif
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef BOOT_PROFILER_H
+#define BOOT_PROFILER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Boot times and reset causes, kept across reboots
+//
+// The boot graph (boot_sequencer.h) times every init task in microseconds,
+// but only for the boot that is running: after a reset nothing said how
+// long the previous boot took, how far it got or why the unit rebooted -
+// the WiFi watchdog's ESP.restart(), a brownout or a crash.
+//
+// Two pieces of state survive:
+//
+//   BootTrace    RTC memory that is not cleared on reset (RTC_NOINIT). It
+//                holds the boot tasks running right now ("wifi+display"),
+//                or "running" once boot is done, the uptime in 10 s steps
+//                and the reason the firmware gave before restarting itself.
+//                Survives software resets, panics, watchdogs and brownouts,
+//                not a power cut; checked by magic and CRC.
+//   BootHistory  The last BOOT_HISTORY_LEN boots in NVS: reset reason, where
+//                the run before was when it ended, how long it lasted, when
+//                the dashboard was up and boot finished, the slowest task.
+//
+// Each boot's record is written once at start, so a unit that resets before
+// boot finishes still leaves a trail, and again when boot finishes.
+//
+// Portable; scripts/boot_profiler_test.cpp checks it on the host.
+
+#define BOOT_HISTORY_LEN        8
+#define BOOT_STAGE_LEN          32
+#define BOOT_NOTE_LEN           16
+#define BOOT_VERSION_LEN        12
+
+#define BOOT_TRACE_MAGIC        0x45425452u     // "RTBE"
+#define BOOT_HISTORY_VERSION    1
+
+#define BOOT_STAGE_RUNNING      "running"       // Boot done, main loop
+#define BOOT_UPTIME_STEP_S      10
+
+// esp_reset_reason_t values
+enum BootResetReason : uint8_t {
+    BOOT_RESET_UNKNOWN = 0,
+    BOOT_RESET_POWERON = 1,
+    BOOT_RESET_EXT = 2,
+    BOOT_RESET_SW = 3,
+    BOOT_RESET_PANIC = 4,
+    BOOT_RESET_INT_WDT = 5,
+    BOOT_RESET_TASK_WDT = 6,
+    BOOT_RESET_WDT = 7,
+    BOOT_RESET_DEEPSLEEP = 8,
+    BOOT_RESET_BROWNOUT = 9,
+    BOOT_RESET_SDIO = 10
+};
+
+// "power_on", "brownout", "task_watchdog", ...
+const char* bootResetName(uint8_t reason);
+
+struct BootTrace {
+    uint32_t magic;
+    char stage[BOOT_STAGE_LEN];     // Running boot tasks, or BOOT_STAGE_RUNNING
+    char note[BOOT_NOTE_LEN];       // Set just before the firmware restarts itself
+    uint32_t uptimeS;
+    uint32_t crc;
+};
+
+// Start a trace for this boot; the previous one must have been read first
+void bootTraceReset(BootTrace& t);
+bool bootTraceValid(const BootTrace& t);
+void bootTraceSetStage(BootTrace& t, const char* stage);
+void bootTraceSetNote(BootTrace& t, const char* note);
+void bootTraceSetUptime(BootTrace& t, uint32_t uptimeS);
+
+struct BootRecord {
+    uint32_t seq;                   // Boot number, counted in the history
+    uint8_t resetReason;            // BootResetReason
+    bool traced;                    // The previous run's trace survived the reset
+    char lastStage[BOOT_STAGE_LEN]; // Where the previous run was, "" if not traced
+    char note[BOOT_NOTE_LEN];       // Why the previous run restarted itself, or ""
+    uint32_t prevUptimeS;           // How long the previous run lasted (traced only)
+    uint32_t dashboardUs;           // From reset; 0 = boot did not get there
+    uint32_t finishedUs;
+    char slowest[BOOT_STAGE_LEN];   // Longest boot task
+    uint32_t slowestUs;
+    char version[BOOT_VERSION_LEN];
+};
+
+// Record for this boot from the reset reason and the previous run's trace
+void bootRecordStart(BootRecord& r, uint8_t resetReason, const BootTrace& previous, const char* version);
+
+class BootHistory {
+public:
+    BootHistory();
+
+    // Add a record with the next sequence number; returns it for updates
+    BootRecord& add(const BootRecord& r);
+
+    int getCount() const { return count; }
+    // 0 = newest
+    const BootRecord& get(int i) const;
+    BootRecord& newest() { return records[(head + BOOT_HISTORY_LEN - 1) % BOOT_HISTORY_LEN]; }
+
+    // Image for NVS: version, CRC-32 of the rest (flash_record.h), state
+    size_t serializedSize() const { return sizeof(Image); }
+    size_t serialize(uint8_t* out, size_t size) const;
+    // false (and the history left empty) on a short image, another version or
+    // a CRC mismatch
+    bool deserialize(const uint8_t* in, size_t size);
+
+private:
+    struct Image {
+        uint32_t version;
+        uint32_t crc;
+        uint32_t nextSeq;
+        uint32_t head;
+        uint32_t count;
+        BootRecord records[BOOT_HISTORY_LEN];
+    };
+
+    BootRecord records[BOOT_HISTORY_LEN];
+    int head;                       // Next slot to write
+    int count;
+    uint32_t nextSeq;
+};
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#define BOOT_NVS_NAMESPACE      "boot"
+#define BOOT_NVS_KEY            "history"
+#define BOOT_MQTT_HISTORY       4       // Records in the MQTT report, to fit MQTT_BUFFER_SIZE
+
+class BootProfiler {
+public:
+    BootProfiler();
+
+    // First thing in setup(): reads the reset reason and the previous run's
+    // trace, starts this boot's trace and record
+    void begin();
+
+    // Boot tasks running now (boot sequencer, any task)
+    void setStage(const char* stage);
+
+    // Right before ESP.restart(), e.g. "wifi_watchdog"
+    void noteRestart(const char* reason);
+
+    // When boot is done: times from the boot graph, record to NVS
+    void finish(uint32_t dashboardUs, uint32_t finishedUs, const char* slowest, uint32_t slowestUs);
+
+    // Uptime into the trace every BOOT_UPTIME_STEP_S
+    void loop();
+
+    // reset_reason, previous run, up to maxHistory records (newest first)
+    void getStatusJson(JsonObject obj, int maxHistory = BOOT_HISTORY_LEN);
+
+private:
+    BootHistory history;
+    bool started;
+    unsigned long lastUptimeWrite;
+
+    void save();
+};
+
+extern BootProfiler bootProfiler;
+#endif
+
+#endif
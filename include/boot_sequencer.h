@@ -0,0 +1,178 @@
+#ifndef BOOT_SEQUENCER_H
+#define BOOT_SEQUENCER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Boot as a dependency graph
+//
+// setupSystem() used to run every init step in a row: WiFi, then up to 10 s
+// of NTP polling, MQTT, the web server, HA discovery after a fixed 2 s, and
+// only then the display, followed by the first HA fetch, integration probes
+// and another 3 s of delays. After a power cut the panel stayed dark for
+// all of that. Each step is now a task with the tasks it needs:
+//
+//   storage -> config -> wifi -> ntp, mqtt (-> ha), web, ota
+//                     -> display -> dashboard (cached state) -> audio
+//
+// A task runs as soon as everything it depends on is done, so the display
+// comes up while WiFi is still connecting. Tasks that block on the network
+// (WiFi, NTP, the integration probes) run on worker tasks; everything else,
+// in particular anything that touches LVGL or registers callbacks, runs on
+// the main loop between LVGL passes.
+//
+// A failed task counts as done: its dependents still run, as the serial
+// boot carried on after a warning. Dependencies must be added first, so the
+// graph cannot have a cycle.
+//
+// The core is portable and takes the time as a parameter;
+// scripts/boot_graph_test.cpp simulates a boot on the host.
+
+#define BOOT_MAX_TASKS      24
+
+#define BOOT_DEP(id)        (1u << (id))
+
+enum BootWhere : uint8_t {
+    BOOT_MAIN,                  // Main loop: LVGL, callbacks, module state
+    BOOT_WORKER                 // Worker task: may block on the network
+};
+
+enum BootState : uint8_t {
+    BOOT_WAITING,
+    BOOT_RUNNING,
+    BOOT_DONE
+};
+
+// Returns false on failure; dependents run anyway
+typedef bool (*BootFn)(void* ctx);
+typedef void (*BootDoneFn)(bool ok, void* ctx);
+// Whenever the set of running tasks changes: their names joined by '+'
+typedef void (*BootStageFn)(const char* running, void* ctx);
+
+struct BootTaskSpec {
+    const char* name;
+    BootWhere where;
+    BootFn run;
+    BootDoneFn done;            // BOOT_WORKER only: main loop, after run; may be nullptr
+    void* ctx;
+};
+
+class BootGraph {
+public:
+    BootGraph();
+
+    // Task id, or -1 if the table is full or deps names a task not added
+    // yet. deps: BOOT_DEP(id) | ...
+    int add(const BootTaskSpec& spec, uint32_t deps);
+
+    // First task for `where`, in the order added, whose dependencies are
+    // all done; it is running until finish(). -1 if there is none now.
+    int next(BootWhere where);
+
+    void finish(int id, bool ok, uint32_t startUs, uint32_t endUs);
+
+    bool isDone(int id) const { return id >= 0 && id < count && tasks[id].state == BOOT_DONE; }
+    bool isFinished() const { return doneCount == count; }
+    int getRunning() const { return running; }
+
+    // Names of the running tasks, "a+b", cut at size; "" if none
+    void describeRunning(char* out, size_t size) const;
+
+    // Longest finished task, -1 if none
+    int getSlowest() const;
+
+    int getCount() const { return count; }
+    const BootTaskSpec& getSpec(int id) const { return tasks[id].spec; }
+    BootState getState(int id) const { return tasks[id].state; }
+    bool getOk(int id) const { return tasks[id].ok; }
+    uint32_t getDeps(int id) const { return tasks[id].deps; }
+    uint32_t getStartUs(int id) const { return tasks[id].startUs; }
+    uint32_t getEndUs(int id) const { return tasks[id].endUs; }
+
+private:
+    struct Task {
+        BootTaskSpec spec;      // name points at the caller's string
+        uint32_t deps;
+        BootState state;
+        bool ok;
+        uint32_t startUs;
+        uint32_t endUs;
+    };
+
+    Task tasks[BOOT_MAX_TASKS];
+    int count;
+    int doneCount;
+    int running;
+    uint32_t doneMask;
+};
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#define BOOT_WORKERS            2
+#define BOOT_PASS_BUDGET_MS     20      // Main tasks per pass, then LVGL's turn
+
+// BootGraph run from setup() and the main loop, with BOOT_WORKERS worker
+// tasks on core 0. Times are micros() since reset.
+class BootSequencer {
+public:
+    BootSequencer();
+
+    // setup(), before start()
+    int add(const BootTaskSpec& spec, uint32_t deps);
+
+    // Create the workers; without them worker tasks run on the main loop
+    bool start();
+
+    // Collect finished worker tasks, hand out ready ones and run ready main
+    // tasks for up to BOOT_PASS_BUDGET_MS. Main loop only.
+    void loop();
+
+    // loop() until task id is done (setup() uses it to get the dashboard
+    // up before returning); false on timeout
+    bool runUntil(int id, uint32_t timeoutMs);
+
+    bool isDone(int id) const { return graph.isDone(id); }
+    bool isFinished() const { return graph.isFinished(); }
+
+    void setStageCallback(BootStageFn fn, void* ctx);
+    const BootGraph& getGraph() const { return graph; }
+
+    // Boot time, from reset, when task id finished (0 = not yet)
+    uint32_t getDoneUs(int id) const { return graph.isDone(id) ? graph.getEndUs(id) : 0; }
+    uint32_t getFinishedUs() const { return finishedUs; }
+
+    void getStatusJson(JsonObject obj);
+    // Compact: name -> [start_us, duration_us] per finished task
+    void getTimingsJson(JsonObject obj);
+
+private:
+    struct Result {
+        int id;
+        bool ok;
+        uint32_t startUs;
+        uint32_t endUs;
+    };
+
+    BootGraph graph;
+    QueueHandle_t work;             // Task ids for the workers, -1 = exit
+    QueueHandle_t results;
+    int workers;
+    uint32_t finishedUs;
+    BootStageFn stageFn;
+    void* stageCtx;
+
+    static void workerTask(void* param);
+    void runTask(int id);
+    void finishTask(int id, bool ok, uint32_t startUs, uint32_t endUs);
+    void reportStage();
+};
+
+extern BootSequencer bootSequencer;
+#endif
+
+#endif
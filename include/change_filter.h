@@ -0,0 +1,88 @@
+#ifndef CHANGE_FILTER_H
+#define CHANGE_FILTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Change detection in front of the display
+//
+// The weather, presence, gate and calendar widgets were rewritten on every
+// poll and every pushed state: label texts reset, styles re-applied and the
+// cards invalidated, so LVGL redrew them even when HA reported exactly what
+// was already on screen. Each widget now hashes the values it would show
+// (after formatting, so 21.04 and 21.02 are both "21.0°") and asks the filter
+// first:
+//
+//   ChangeHash h;
+//   h.add(tempText).add(condition);
+//   if (!changes.update("weather", h.value(), millis())) return;
+//
+// Only a different hash gets through. Suppressed updates are counted per
+// key and per clock hour.
+//
+// Portable; scripts/change_filter_test.cpp checks it on the host.
+
+#define CHANGE_MAX_KEYS     12
+#define CHANGE_KEY_LEN      16
+#define CHANGE_HOUR_MS      3600000u
+
+// FNV-1a over the fields that make up what is shown
+class ChangeHash {
+public:
+    ChangeHash() : h(2166136261u) {}
+
+    ChangeHash& add(const void* data, size_t len);
+    // With its terminator, so ("ab", "c") and ("a", "bc") differ
+    ChangeHash& add(const char* text);
+    ChangeHash& add(int32_t value) { return add(&value, sizeof(value)); }
+    ChangeHash& add(bool value) { return add((int32_t)value); }
+
+    uint32_t value() const { return h; }
+
+private:
+    uint32_t h;
+};
+
+struct ChangeStats {
+    uint32_t changes;           // Updates let through
+    uint32_t suppressed;        // Same as what is shown
+    uint32_t suppressedThisHour;
+    uint32_t suppressedLastHour;
+};
+
+class ChangeFilter {
+public:
+    ChangeFilter();
+
+    // True if key is new or its hash differs from the last one let through
+    bool update(const char* key, uint32_t hash, uint32_t now);
+
+    // Next update of key (or of every key) goes through, e.g. after the
+    // widget was recreated
+    void invalidate(const char* key);
+    void invalidateAll();
+
+    int getCount() const { return count; }
+    const char* getKey(int i) const { return entries[i].key; }
+    const ChangeStats& getKeyStats(int i) const { return entries[i].stats; }
+    const ChangeStats& getStats(uint32_t now);
+
+private:
+    struct Entry {
+        char key[CHANGE_KEY_LEN];
+        uint32_t hash;
+        bool valid;
+        ChangeStats stats;
+    };
+
+    Entry entries[CHANGE_MAX_KEYS];
+    int count;
+    ChangeStats total;
+    uint32_t hourStart;
+    bool started;
+
+    void rollHour(uint32_t now);
+    static void rollHour(ChangeStats& s);
+};
+
+#endif
@@ -0,0 +1,304 @@
+#ifndef COMMAND_ENGINE_H
+#define COMMAND_ENGINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// Voice command engine driven by data/commands.json
+//
+// Every enabled command phrase (plus optional "phrases" aliases) is tokenized
+// and compiled into a token-level Aho-Corasick automaton. A transcription is
+// matched in a single left-to-right pass over its words; the longest phrase
+// found anywhere in the text wins, ties go to the command listed first. The
+// action string is parsed once at compile time and dispatched as a tuple.
+//
+// Tokenization: lowercase, apostrophes dropped ("what's" -> "whats"), any
+// other non-alphanumeric character separates words, filler words ("the",
+// "a", "please", ...) are skipped and a trailing plural "s" is stripped, so
+// "turn on the lights" also matches "please turn on light".
+//
+// When no phrase occurs verbatim, a fuzzy pass aligns every phrase against
+// the text with a bounded word-level Levenshtein distance. Substituting a
+// word costs by spelling and phonetic key (so "open the date" still reaches
+// "open gate", "good nite" reaches "good night"). The result carries a
+// confidence (1 - cost / phrase words). Vocabulary words and their phonetic
+// keys are indexed when the commands are compiled, and matching a query does
+// not allocate.
+//
+// Phrases with one {slot} ("turn on {light}") are templates: their fixed words
+// must appear verbatim, and the words in the slot position are handed to a
+// resolver (the Home Assistant entity index, see entity_index.h) that turns
+// them into a value such as "porch" for light.porch.
+//
+// The matcher is portable; scripts/command_engine_bench.cpp benchmarks it on
+// the host against the previous indexOf() chain, scripts/command_fuzzy_test.cpp
+// runs the mishearing corpus in scripts/command_mishearings.tsv.
+
+#define COMMAND_MAX_WORD        32      // Longer words are truncated
+#define COMMAND_MAX_PHRASE_WORDS 16
+#define COMMAND_MAX_QUERY_WORDS 24      // Fuzzy pass only looks at the first 24 words
+#define COMMAND_KEY_LEN         8       // Phonetic key length
+#define COMMAND_MIN_CONFIDENCE  0.65f   // Default fuzzy acceptance threshold
+#define COMMAND_MAX_SLOT_WORDS  5       // Longest slot value in words
+#define COMMAND_MAX_SLOT_NAME   16
+#define COMMAND_SLOT_SKIP_PENALTY 0.25f // Per text word after a trailing slot value
+
+// Word-level edit costs for the fuzzy pass (100 = one whole word)
+#define COMMAND_COST_WORD       100     // Phrase word missing from the text
+#define COMMAND_COST_EXTRA      50      // Extra text word inside the phrase
+#define COMMAND_COST_SOUNDALIKE 15      // Same phonetic key, different spelling
+#define COMMAND_COST_MERGED     10      // Two phrase words run together ("opengate")
+
+// ============================================
+// Action tuples
+// ============================================
+
+enum CommandActionType : uint8_t {
+    CMD_ACTION_HOMEASSISTANT,   // homeassistant:<domain>.<object_id>:<service>
+    CMD_ACTION_SCENE,           // scene:<scene_id>
+    CMD_ACTION_MQTT,            // mqtt:<topic>:<payload>
+    CMD_ACTION_QUERY            // query:<name> (answered on the device)
+};
+
+struct CommandAction {
+    CommandActionType type;
+    char domain[16];            // HA domain (homeassistant only)
+    char target[64];            // Object id, scene id, MQTT topic or query name
+    char arg[64];               // Service or MQTT payload
+};
+
+// Parse an action string; false if malformed
+bool parseCommandAction(const char* action, CommandAction& out);
+
+// Metaphone-style phonetic key of a lowercase word (up to COMMAND_KEY_LEN
+// characters, not terminated); returns the key length
+size_t phoneticKey(const char* word, size_t len, char* key);
+
+// ============================================
+// Phrase automaton
+// ============================================
+
+struct CommandMatch {
+    int command;                // Caller's command index
+    int words;                  // Phrase length in (non-filler) words
+    int end;                    // Index of the last matched word in the text
+    float confidence;           // 1.0 for a verbatim match
+    char slot[COMMAND_MAX_SLOT_NAME];   // Template matches: slot name and
+    char value[64];                     // resolved value
+};
+
+// Resolve slot text (normalized words) for a template slot; writes the value
+// and returns a confidence in 0..1 (0 = no match)
+typedef float (*CommandSlotResolver)(const char* slot, const char* text, char* value, size_t valueSize, void* ctx);
+
+class CommandMatcher {
+public:
+    CommandMatcher();
+
+    void clear();
+
+    // Add a phrase for command index `command`. Returns false if the phrase
+    // has no words left after normalization. Call compile() after adding.
+    bool addPhrase(const char* phrase, int command);
+
+    // Add a template phrase with exactly one {slot}, e.g. "open {cover}"
+    bool addTemplate(const char* phrase, int command);
+
+    // Build failure links and the flat transition table
+    void compile();
+
+    // One pass over the text; false if no phrase occurs in it
+    bool match(const char* text, CommandMatch& out) const;
+
+    // Nearest phrase by word-level edit distance; false if the best
+    // confidence is below minConfidence. Uses per-matcher scratch buffers,
+    // so one matcher must not be queried from two tasks at once.
+    bool matchFuzzy(const char* text, CommandMatch& out, float minConfidence = COMMAND_MIN_CONFIDENCE) const;
+
+    // Template whose fixed words occur in the text and whose slot resolves
+    // with the highest confidence (same scratch caveat as matchFuzzy)
+    bool matchTemplate(const char* text, CommandSlotResolver resolve, void* ctx, CommandMatch& out,
+                       float minConfidence = COMMAND_MIN_CONFIDENCE) const;
+
+    size_t getStateCount() const { return states.size(); }
+    size_t getVocabularySize() const { return words.size(); }
+    size_t getPhraseCount() const { return phraseCount; }
+    size_t getTemplateCount() const { return templates.size(); }
+    size_t getMemoryBytes() const;
+
+    // Split text into normalized words (filler skipped); returns word count
+    static int tokenize(const char* text, std::vector<std::string>& words);
+
+    // Normalized words joined by single spaces; returns the length
+    static size_t normalize(const char* text, char* out, size_t size);
+
+private:
+    struct State {
+        uint32_t fail;
+        uint32_t outputLink;    // Nearest state on the fail chain with an output (0 = none)
+        uint32_t firstEdge;
+        uint16_t edgeCount;
+        uint16_t depth;
+        int32_t output;         // Command whose phrase ends here, -1 if none
+    };
+
+    struct Edge {
+        uint32_t token;
+        uint32_t next;
+    };
+
+    // Vocabulary word (token id = index + 1; 0 = not in any phrase)
+    struct Word {
+        uint32_t offset;        // Into wordText
+        uint8_t len;
+        uint8_t keyLen;
+        char key[COMMAND_KEY_LEN];
+    };
+
+    struct Phrase {
+        uint32_t first;         // Into phraseTokens
+        uint16_t len;
+        int32_t command;
+    };
+
+    struct Template {
+        uint32_t first;         // Prefix then suffix tokens in templateTokens
+        uint8_t prefixLen;
+        uint8_t suffixLen;
+        char slot[COMMAND_MAX_SLOT_NAME];
+        int32_t command;
+    };
+
+    // Query word as seen by the fuzzy pass
+    struct QueryWord {
+        char text[COMMAND_MAX_WORD];
+        uint8_t len;
+        uint8_t keyLen;
+        char key[COMMAND_KEY_LEN];
+        uint32_t token;
+    };
+
+    std::vector<State> states;
+    std::vector<Edge> edges;                    // Per-state ranges, sorted by token
+    std::vector<std::vector<Edge>> pending;     // Trie edges until compile()
+    std::vector<Word> words;
+    std::vector<char> wordText;
+    std::vector<uint32_t> wordTable;            // Open addressing: hash -> token
+    std::vector<Phrase> phrases;
+    std::vector<uint32_t> phraseTokens;
+    std::vector<Template> templates;
+    std::vector<uint32_t> templateTokens;
+    size_t phraseCount;
+    bool compiled;
+
+    // Fuzzy scratch, sized by compile()
+    mutable QueryWord query[COMMAND_MAX_QUERY_WORDS];
+    mutable std::vector<uint8_t> costCache;     // [query word][token], 255 = not computed
+
+    int loadQuery(const char* text) const;
+    uint32_t findToken(const char* word, size_t len) const;
+    uint32_t addToken(const char* word, size_t len);
+    uint32_t step(uint32_t state, uint32_t token) const;
+    uint32_t child(uint32_t state, uint32_t token) const;
+    uint8_t wordCost(int q, uint32_t token) const;
+    int mergedCost(int q, uint32_t a, uint32_t b) const;
+
+    template <typename F>
+    static void forEachWord(const char* text, F&& fn);
+};
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Answers query:<name> actions (e.g. "time", "weather"); returns the reply text
+typedef String (*CommandQueryHandler)(const char* query);
+
+struct CommandResult {
+    bool matched;
+    bool success;               // Action queued (or query answered)
+    bool duplicate;             // Same action already queued within the dedup window
+    int id;                     // commands.json id
+    uint32_t actionId;          // actionExecutor id, reported again on completion
+    float confidence;           // 1.0 verbatim, lower for a fuzzy match
+    String phrase;
+    String reply;               // Query answer, empty otherwise
+};
+
+class CommandEngine {
+public:
+    CommandEngine();
+
+    // Load and compile commands.json
+    bool begin();
+
+    // Recompile on the next loop() (safe to call from web handlers)
+    void requestReload() { reloadPending = true; }
+    void loop();
+
+    // Match the raw transcription (verbatim, then templates, then fuzzy);
+    // false if nothing reaches min_confidence
+    bool match(const char* text, CommandMatch& m);
+
+    // Run a match: queue the command's action with actionExecutor, or
+    // answer a query
+    CommandResult execute(const char* text, const CommandMatch& m);
+
+    // match() + execute()
+    CommandResult execute(const char* text);
+
+    // The match only answers on the device (query:<name>), it acts on nothing
+    bool isQuery(const CommandMatch& m) const;
+
+    void setQueryHandler(CommandQueryHandler handler) { queryHandler = handler; }
+
+    // Resolves {slot} phrases; without one, templates never match
+    void setSlotResolver(CommandSlotResolver resolver, void* ctx) {
+        slotResolver = resolver;
+        slotContext = ctx;
+    }
+
+    // Hash of the compiled commands (phrases, aliases, actions, threshold);
+    // changes whenever commands.json does
+    uint32_t getFingerprint() const { return fingerprint; }
+
+    void getStatusJson(JsonObject obj);
+
+private:
+    struct Command {
+        int id;
+        String phrase;
+        CommandAction action;
+    };
+
+    CommandMatcher matcher;
+    std::vector<Command> commands;
+    CommandQueryHandler queryHandler;
+    CommandSlotResolver slotResolver;
+    void* slotContext;
+    volatile bool reloadPending;
+    float minConfidence;        // commands.json "min_confidence"
+    uint32_t fingerprint;
+
+    uint32_t compileUs;
+    uint32_t lastMatchUs;
+    float lastConfidence;
+    uint32_t executed;
+    uint32_t fuzzyMatches;
+    uint32_t templateMatches;
+    uint32_t unmatched;
+
+    bool reload();
+    bool addPhrase(const char* phrase, int index);
+    bool dispatch(const Command& cmd, const CommandMatch& m, const char* text, CommandResult& result);
+};
+
+extern CommandEngine commandEngine;
+#endif
+
+#endif
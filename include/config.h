@@ -73,6 +73,7 @@
 #define CONFIG_FILE         "/config.json"
 #define COMMANDS_FILE       "/commands.json"
 #define PRESENCE_FILE       "/presence.json"
+#define DASHBOARD_FILE      "/dashboard.json"  // Last shown HA state, only ever a record
 
 // ============================================
 // Security
@@ -99,6 +100,18 @@
 #define COMMAND_TIMEOUT_MS      5000
 #define VOICE_BUFFER_DURATION_MS 3000
 
+// Default recording thresholds (16-bit peak levels), replaced by calibration
+#define VOICE_DEFAULT_SPEECH_THRESHOLD  500     // Audio level to consider as speech
+#define VOICE_DEFAULT_SILENCE_THRESHOLD 100     // Below this = silence
+#define VOICE_DEFAULT_MIN_SPEECH_LEVEL  300     // Minimum max level during recording to send to STT
+
+// Microphone calibration
+#define CALIBRATION_DEFAULT_NOISE_SECONDS   5
+#define CALIBRATION_MAX_NOISE_SECONDS       30
+#define CALIBRATION_PHRASE_TIMEOUT_MS       6000    // Time allowed for the prompted phrase
+#define CALIBRATION_DRIFT_CHECK_MS          900000  // Compare noise floor every 15 minutes
+#define CALIBRATION_DRIFT_MIN_SAVE_MS       3600000 // Persist drift re-tunes at most hourly
+
 // ============================================
 // Home Assistant
 // ============================================
@@ -0,0 +1,132 @@
+#ifndef CONFIG_SERVICE_H
+#define CONFIG_SERVICE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <memory>
+
+// In-memory configuration with change notifications
+//
+// storage.loadConfig() read and parsed /config.json from LittleFS on every
+// weather, presence, calendar and timezone poll and in nearly every web
+// handler. ConfigService parses it once at boot into an immutable snapshot
+// and hands out shared references to it:
+//
+//   ConfigRef config = configService.get();   // Refcount, no copy
+//   if (config->haConfigured) ... config->haUrl ... config->json["voice"]
+//
+// The fields read on every poll are typed members; everything else is in
+// the read-only json document. Editors take a private copy and save it back:
+//
+//   JsonDocument config;
+//   uint32_t generation;
+//   configService.copy(config, &generation);
+//   config["mqtt"]["enabled"] = true;
+//   configService.save(config, generation);   // false if someone saved first
+//
+// Saves are serialized: the file is written, a new snapshot with the next
+// generation replaces the old one (readers holding the old one keep it
+// until they let go), and subscribers of the changed top-level sections
+// are called from the main loop so they reconfigure without a reboot. A save
+// that changes nothing is not written to flash.
+
+#define CONFIG_MAX_LISTENERS    8
+#define CONFIG_MAX_PRESENCE     8
+
+// Top-level sections, for subscribe() and the changed mask
+#define CONFIG_DEVICE           (1u << 0)
+#define CONFIG_NETWORK          (1u << 1)
+#define CONFIG_MQTT             (1u << 2)
+#define CONFIG_VOICE            (1u << 3)
+#define CONFIG_DISPLAY          (1u << 4)
+#define CONFIG_WEATHER          (1u << 5)
+#define CONFIG_INTEGRATIONS     (1u << 6)
+#define CONFIG_PRESENCE         (1u << 7)
+#define CONFIG_GATE             (1u << 8)
+#define CONFIG_NOTIFICATIONS    (1u << 9)
+#define CONFIG_OTHER            (1u << 10)  // Any other top-level key
+#define CONFIG_ALL              0xFFFFFFFFu
+
+struct ConfigSnapshot {
+    uint32_t generation;        // 0 = nothing loaded or saved yet
+    JsonDocument json;          // The whole config; never modified once published
+
+    // Typed view of the fields read on every poll
+    String haUrl;
+    String haToken;
+    bool haConfigured;          // URL and token both set
+    String weatherProvider;     // "none", "homeassistant", "openweathermap"
+    String weatherEntity;       // Home Assistant weather entity
+    String presenceEntities[CONFIG_MAX_PRESENCE];
+    int presenceCount;
+    String gateEntity;          // "" = gate tile not driven
+    bool calendarEnabled;       // Enabled with the homeassistant provider
+    String calendarEntity;
+    float voiceSensitivity;     // NAN if not configured
+};
+
+typedef std::shared_ptr<const ConfigSnapshot> ConfigRef;
+
+// changed: CONFIG_* bits of the sections that differ from the previous
+// snapshot the listener saw
+typedef void (*ConfigListener)(const ConfigSnapshot& config, uint32_t changed, void* ctx);
+
+class ConfigService {
+public:
+    ConfigService();
+
+    // Parse /config.json; false if it is missing or invalid, in which case
+    // an empty snapshot is published until the first save()
+    bool begin();
+
+    // Current snapshot; never null
+    ConfigRef get();
+    uint32_t getGeneration();
+
+    // Editable copy of the current config; false if nothing is loaded
+    bool copy(JsonDocument& doc, uint32_t* generation = nullptr);
+
+    // Write doc to flash and publish it. ifGeneration != 0 makes it a
+    // compare-and-set against the generation copy() returned.
+    bool save(const JsonDocument& doc, uint32_t ifGeneration = 0);
+
+    // Called from loop() after saves touching any of sections
+    bool subscribe(ConfigListener listener, void* ctx, uint32_t sections = CONFIG_ALL);
+
+    // Delivers pending change notifications; call from the main loop
+    void loop();
+
+    void getStatusJson(JsonObject obj);
+
+private:
+    struct Listener {
+        ConfigListener fn;
+        void* ctx;
+        uint32_t sections;
+    };
+
+    SemaphoreHandle_t mutex;        // Guards current, pending and stats
+    SemaphoreHandle_t writeMutex;   // One save at a time, file and publish in order
+    ConfigRef current;
+    uint32_t pendingSections;       // Changed since the last loop()
+    Listener listeners[CONFIG_MAX_LISTENERS];
+    int listenerCount;
+
+    uint32_t flashReads;
+    uint32_t flashWrites;
+    uint32_t unchangedSaves;        // Skipped: identical to the current config
+    uint32_t conflicts;             // Compare-and-set lost
+    uint32_t failures;
+    uint32_t gets;
+    uint32_t copies;
+    uint32_t notifications;
+    uint32_t lastSaveMs;
+
+    static void fillTyped(ConfigSnapshot& s);
+    static uint32_t diffSections(const JsonDocument& a, const JsonDocument& b);
+    void publish(ConfigSnapshot* next, uint32_t changed);
+};
+
+extern ConfigService configService;
+
+#endif
@@ -0,0 +1,203 @@
+#ifndef ENTITY_INDEX_H
+#define ENTITY_INDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// Fuzzy index of Home Assistant entity names for command slots
+//
+// Every entity contributes a few normalized keys: its friendly name, the name
+// without a trailing device noun ("Porch Light" -> "porch"), its object id
+// and "<area> <name>". Keys go into a BK-tree per domain under character
+// edit distance (computed bit-parallel, a key fits one 64-bit word), so
+// "porch", "porch light" and "the porch lights" all reach light.porch, and
+// misspellings like "porsh light" or "hall way" still resolve.
+//
+// Refreshes are incremental: upsert() every entity seen during a refresh and
+// call endRefresh(). Unchanged entities are left alone, changed ones get new
+// keys, and vanished ones are tombstoned. The trees are only rebuilt once
+// tombstones make up a quarter of the entities. On the device all storage
+// lives in PSRAM.
+//
+// Portable; scripts/entity_index_bench.cpp measures lookups over 1000+
+// entities on the host.
+
+#define ENTITY_MAX_KEY          48      // Normalized key length
+#define ENTITY_MAX_DISTANCE     3       // Edit distance cap for lookups
+#define ENTITY_MAX_DOMAINS      16      // Separate trees; further domains share the last
+
+#ifdef ARDUINO
+#include <esp_heap_caps.h>
+#include <new>
+
+// Allocate in PSRAM, falling back to internal RAM
+template <typename T>
+struct PsramAllocator {
+    typedef T value_type;
+    PsramAllocator() = default;
+    template <typename U> PsramAllocator(const PsramAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        void* p = heap_caps_malloc(n * sizeof(T), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!p) p = malloc(n * sizeof(T));
+        if (!p) throw std::bad_alloc();
+        return (T*)p;
+    }
+    void deallocate(T* p, size_t) { free(p); }
+
+    template <typename U> bool operator==(const PsramAllocator<U>&) const { return true; }
+    template <typename U> bool operator!=(const PsramAllocator<U>&) const { return false; }
+};
+
+template <typename T> using EntityVector = std::vector<T, PsramAllocator<T>>;
+#else
+template <typename T> using EntityVector = std::vector<T>;
+#endif
+
+struct EntityHit {
+    uint32_t entity;
+    int distance;
+    float confidence;           // 1 - distance / key length
+};
+
+class EntityIndex {
+public:
+    EntityIndex();
+
+    void clear();
+
+    // Mark-and-sweep refresh
+    void beginRefresh();
+    // Returns true if the entity is new or its name/area changed
+    bool upsert(const char* entityId, const char* name, const char* area);
+    // Drops entities not upserted since beginRefresh(); returns how many
+    int endRefresh();
+
+    // Best live entity for the text, optionally restricted to a domain
+    // ("light"); false if nothing is within the distance bound
+    bool lookup(const char* text, const char* domain, EntityHit& hit) const;
+
+    const char* getEntityId(uint32_t entity) const;
+    const char* getObjectId(uint32_t entity) const;     // Part after the dot
+    const char* getName(uint32_t entity) const;
+    const char* getArea(uint32_t entity) const;
+
+    size_t size() const { return live; }
+    size_t getKeyCount() const { return nodes.size(); }
+    size_t getTombstones() const { return entities.size() - live; }
+    size_t getMemoryBytes() const;
+    uint32_t getRebuilds() const { return rebuilds; }
+
+    // Order-independent hash of the live entity ids, names and areas
+    uint32_t getFingerprint() const { return fingerprint; }
+
+private:
+    struct Entity {
+        uint32_t idOffset;      // Strings in pool, NUL-terminated
+        uint32_t nameOffset;
+        uint32_t areaOffset;
+        uint32_t hash;          // Of name + area, to detect changes
+        uint8_t domainLen;
+        bool alive;
+        bool seen;
+    };
+
+    // BK-tree node; children are a sibling list labelled with their
+    // distance to the parent
+    struct Node {
+        uint32_t keyOffset;
+        uint32_t entity;
+        uint32_t firstChild;    // 0 = none (node 0 is the root)
+        uint32_t nextSibling;
+        uint8_t keyLen;
+        uint8_t dist;
+    };
+
+    EntityVector<Entity> entities;
+    EntityVector<char> pool;
+    EntityVector<Node> nodes;
+    EntityVector<uint32_t> idTable;     // Open addressing: hash(entity_id) -> entity + 1
+    struct Tree {
+        char domain[16];        // Empty for the shared overflow tree
+        uint32_t root;
+    } trees[ENTITY_MAX_DOMAINS];
+    int treeCount;
+    size_t live;
+    uint32_t rebuilds;
+    uint32_t fingerprint;      // Sum of contribution() over live entities
+
+    uint32_t addString(const char* s, size_t len);
+    uint32_t contribution(const Entity& e) const;
+    int findEntity(const char* entityId) const;
+    int findTree(const char* domain, size_t len) const;
+    void insertId(uint32_t entity);
+    void addKeys(uint32_t entity);
+    void insertKey(const char* key, size_t len, uint32_t entity);
+    void rebuild();
+};
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Keeps an EntityIndex in sync with Home Assistant. A background task posts
+// one /api/template request that renders "entity_id<TAB>name<TAB>area" lines
+// for the configured domains only, and streams the response into a PSRAM
+// buffer; the main loop then applies it as an incremental refresh.
+class HAEntityIndex {
+public:
+    HAEntityIndex();
+
+    // config["entities"]: enabled, domains[], refresh_minutes
+    void begin(JsonDocument& config);
+    void loop();
+    void requestRefresh() { refreshRequested = true; }
+
+    // Resolve slot text to an entity id in `domain`; returns confidence (0 = none)
+    float resolve(const char* text, const char* domain, char* entityId, size_t size);
+
+    // CommandSlotResolver adapter: slot name = domain, value = object id
+    static float resolveSlot(const char* slot, const char* text, char* value, size_t valueSize, void* ctx);
+
+    // Changes whenever resolutions may change: 0 until the first refresh,
+    // constant while the index is disabled
+    uint32_t getFingerprint() const { return !enabled ? 1 : loaded ? (index.getFingerprint() | 1) : 0; }
+
+    void getStatusJson(JsonObject obj);
+
+private:
+    EntityIndex index;
+    bool enabled;
+    bool loaded;                // At least one refresh applied
+    String haUrl;
+    String haToken;
+    String domains;             // Jinja list literal, e.g. ['light','cover']
+    unsigned long refreshInterval;
+    unsigned long lastRefresh;
+    volatile bool refreshRequested;
+
+    // Fetch task -> loop
+    TaskHandle_t task;
+    volatile bool fetchDone;
+    EntityVector<char> staging;
+    int lastHttpCode;
+    uint32_t fetchMs;
+    uint32_t applyUs;
+    int lastChanged;
+    int lastRemoved;
+    uint32_t lookups;
+    uint32_t lookupUsMax;
+
+    static void fetchTask(void* param);
+    void fetch();
+    void apply();
+};
+
+extern HAEntityIndex haEntities;
+#endif
+
+#endif
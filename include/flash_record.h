@@ -0,0 +1,47 @@
+#ifndef FLASH_RECORD_H
+#define FLASH_RECORD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Versioned, checksummed container for files kept on flash
+//
+// config.json, commands.json and presence.json used to be stored as JSON
+// text, so every change re-serialized the whole document to text and every
+// boot parsed it back. StorageManager now keeps them as MessagePack inside
+// this container (/config.bin etc.); JSON stays the format of the REST API
+// and of files imported from the data/ image.
+//
+//   offset  size
+//   0       4     magic "EHR1"
+//   4       1     FLASH_RECORD_VERSION
+//   5       1     payload format (FLASH_RECORD_MSGPACK)
+//   6       2     reserved, 0
+//   8       4     payload length
+//   12      4     CRC-32 (IEEE) of the payload
+//   16      n     payload
+//
+// Little-endian, as written by the ESP32. A record with a different
+// version, a short payload or a CRC mismatch (a write cut off by a reset) is
+// rejected as a whole and the caller falls back to the JSON file.
+//
+// Portable; scripts/config_format_bench.cpp checks it on the host.
+
+#define FLASH_RECORD_MAGIC      0x31524845u     // "EHR1"
+#define FLASH_RECORD_VERSION    1
+#define FLASH_RECORD_HEADER     16
+
+#define FLASH_RECORD_MSGPACK    1
+
+// Incremental: crc = flashRecordCrc(part2, n2, flashRecordCrc(part1, n1))
+uint32_t flashRecordCrc(const uint8_t* data, size_t len, uint32_t crc = 0);
+
+// Fill in the header in front of a payload that is already in place at
+// record + FLASH_RECORD_HEADER; returns the total record size
+size_t flashRecordSeal(uint8_t* record, size_t payloadLen, uint8_t format);
+
+// Check a record read from flash; nullptr if it is valid, otherwise why not
+const char* flashRecordOpen(const uint8_t* record, size_t size, uint8_t format,
+                            const uint8_t** payload, size_t* payloadLen);
+
+#endif
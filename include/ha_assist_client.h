@@ -24,6 +24,25 @@ enum AssistState {
 // Result callback
 typedef void (*AssistResultCallback)(const char* transcription, const char* response, const char* error);
 
+// /api/conversation/process request: the connection and pipeline are
+// copied on the calling task, so converse() can run on another one while
+// setConnection() changes the client
+struct ConversationRequest {
+    String url;
+    String token;
+    String body;
+};
+
+// Reply of /api/conversation/process
+struct ConversationReply {
+    bool sent;                  // Request reached HA (it may have acted on it)
+    int httpCode;
+    String responseType;        // action_done, query_answer or error
+    String errorCode;           // e.g. no_intent_match
+    String speech;
+    String error;               // Transport / parse error
+};
+
 class HAAssistClient {
 public:
     HAAssistClient();
@@ -35,6 +54,12 @@ public:
      */
     void begin(const char* baseUrl, const char* token);
     
+    /**
+     * Point the client at another HA instance or token (after a config
+     * change); takes effect with the next request
+     */
+    void setConnection(const char* baseUrl, const char* token);
+    
     /**
      * Process voice from audio buffer (main entry point)
      * Call this when voice activity is detected
@@ -78,6 +103,21 @@ public:
      */
     bool sendTextCommand(const char* text);
     
+    /**
+     * Snapshot of the connection and pipeline for a conversation request
+     */
+    void prepareConversation(const char* text, ConversationRequest& request) const;
+    
+    /**
+     * One conversation request without touching the client, so it can run
+     * in another task. Checks *cancel right before sending and sets *sent
+     * once the text is on its way.
+     * 
+     * @return true if HA answered (see reply.responseType for the outcome)
+     */
+    static bool converse(const ConversationRequest& request, ConversationReply& reply,
+                         volatile bool* cancel = nullptr, volatile bool* sent = nullptr);
+    
     /**
      * Non-blocking loop - call regularly to check async operations
      */
@@ -95,6 +135,11 @@ public:
     const char* getLastTranscription() const { return _lastTranscription.c_str(); }
     const char* getLastResponse() const { return _lastResponse.c_str(); }
     const char* getLastError() const { return _lastError.c_str(); }
+    uint32_t getLastSttMs() const { return _lastSttMs; }
+    
+    // Audio of the last recording (valid until the next startRecording())
+    const int16_t* getRecordedAudio() const { return _recordBuffer; }
+    size_t getRecordedSamples() const { return _recordIndex; }
     
     // Pipeline configuration
     void setPipeline(const char* pipelineId);
@@ -102,6 +147,7 @@ public:
     void setSTTProvider(const char* provider);
     
 private:
+    SemaphoreHandle_t _connLock;    // _baseUrl, _token, _pipelineId, _language
     String _baseUrl;
     String _token;
     String _pipelineId;
@@ -120,6 +166,7 @@ private:
     String _lastTranscription;
     String _lastResponse;
     String _lastError;
+    uint32_t _lastSttMs;
     
     // Internal methods
     void discoverSTTProviders();
@@ -0,0 +1,125 @@
+#ifndef HA_BATCH_H
+#define HA_BATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Batched Home Assistant state fetch through one /api/template round trip
+//
+// Presence, weather, gate and timezone each used to cost their own
+// GET /api/states/<entity> (or /api/config). HAStateBatch collects entity ids,
+// the attributes wanted from them and extra template values such as the time
+// zone. It renders them into a single template that HA answers with one
+// compact line per entity:
+//
+//   entity_id<TAB>state<TAB>attr1<TAB>attr2...
+//   =name<TAB>value
+//
+// Tabs and newlines inside values are replaced by spaces on the HA side, so
+// the response never needs a JSON parser. Missing attributes come back empty.
+// Entities HA does not have get no line at all, so they stay found = false
+// like a 404 from /api/states/<entity> (states() would render "unknown").
+//
+// Portable; scripts/ha_batch_test.cpp checks template building and parsing
+// on the host.
+
+#define HA_BATCH_MAX_ENTITIES   12
+#define HA_BATCH_MAX_ATTRS      6       // Attributes requested from every entity
+#define HA_BATCH_MAX_VALUES     4       // Extra template expressions
+#define HA_BATCH_ID_LEN         64
+#define HA_BATCH_NAME_LEN       32
+#define HA_BATCH_TEXT_LEN       48      // State, attribute and value text (truncated)
+#define HA_BATCH_EXPR_LEN       64
+
+struct HABatchEntity {
+    char entityId[HA_BATCH_ID_LEN];
+    char state[HA_BATCH_TEXT_LEN];
+    char attrs[HA_BATCH_MAX_ATTRS][HA_BATCH_TEXT_LEN];
+    bool found;                 // Line present in the last response
+};
+
+struct HABatchValue {
+    char name[HA_BATCH_NAME_LEN];
+    char expression[HA_BATCH_EXPR_LEN];
+    char text[HA_BATCH_TEXT_LEN];
+    bool found;
+};
+
+class HAStateBatch {
+public:
+    HAStateBatch();
+
+    // Forget entities, attributes and values
+    void clear();
+
+    // Index of the entity, or -1 if the batch is full or the id is not a
+    // plain domain.object_id. Adding an entity twice returns the same index.
+    int addEntity(const char* entityId);
+    // Attribute requested from every entity (friendly_name, temperature, ...)
+    bool addAttribute(const char* name);
+    // Extra template expression, e.g. addValue("tz", "now().tzinfo")
+    bool addValue(const char* name, const char* expression);
+
+    bool isEmpty() const { return entityCount == 0 && valueCount == 0; }
+    int getEntityCount() const { return entityCount; }
+    int getValueCount() const { return valueCount; }
+    // Requests one GET per entity or value would have cost
+    int getItemCount() const { return entityCount + valueCount; }
+
+    // Template for /api/template; returns its length, 0 if out is too small
+    size_t buildTemplate(char* out, size_t size) const;
+
+    // Rendered template; clears previous results and returns the number of
+    // entities and values found
+    int parse(const char* text, size_t len);
+
+    const HABatchEntity& getEntity(int i) const { return entities[i]; }
+    const HABatchEntity* find(const char* entityId) const;
+    // Attribute text, "" if not requested or absent
+    const char* getAttribute(const HABatchEntity& e, const char* name) const;
+    // Value text, nullptr if not in the response
+    const char* getValue(const char* name) const;
+
+private:
+    HABatchEntity entities[HA_BATCH_MAX_ENTITIES];
+    int entityCount;
+    char attrNames[HA_BATCH_MAX_ATTRS][HA_BATCH_NAME_LEN];
+    int attrCount;
+    HABatchValue values[HA_BATCH_MAX_VALUES];
+    int valueCount;
+};
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+class HABatchClient {
+public:
+    HABatchClient();
+
+    // POST the batch to /api/template over the HA connection pool and parse
+    // the response into it; false on a transport or HTTP error
+    bool fetch(HAStateBatch& batch, const char* haUrl, const char* token, uint32_t timeoutMs = 5000);
+
+    int getLastHttpCode() const { return lastHttpCode; }
+
+    void getStatusJson(JsonObject obj);
+
+private:
+    int lastHttpCode;
+    uint32_t fetches;
+    uint32_t failures;
+    uint32_t items;             // Entities and values over all fetches
+    uint32_t lastItems;
+    uint32_t lastMs;
+    uint32_t msSum;
+    uint32_t msMax;
+};
+
+extern HABatchClient haBatch;
+#endif
+
+#endif
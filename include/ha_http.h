@@ -0,0 +1,136 @@
+#ifndef HA_HTTP_H
+#define HA_HTTP_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <HTTPClient.h>
+#include <WiFiClient.h>
+#include <WiFiClientSecure.h>
+#include "json_stream.h"
+
+// Keep-alive connection pool for Home Assistant REST calls
+//
+// A plain HTTPClient owns its connection and closes it in end(), so every
+// request paid a TCP handshake (plus TLS for https) and rebuilt the bearer
+// header. HARequest is a drop-in HTTPClient that leases one of a few
+// persistent connections from haHttp instead and hands it back afterwards.
+// The next request to the same HA instance reuses the open socket.
+//
+//   HARequest http(url, haToken, 5000);     // url as before, deadline in ms
+//   int httpCode = http.GET();
+//   String payload = http.getString();
+//   http.end();                             // or let it go out of scope
+//
+// Large JSON responses should go through readJson() instead of getString():
+// the body is parsed as it arrives and never held in memory whole.
+//
+// A connection goes back to the pool only if the response body was read
+// (getString(), writeToStream() or readJson()) and HA allowed keep-alive.
+// Otherwise it is closed, so a later request never reads a previous answer.
+// Connections idle longer than idle_s are reopened before HA's own
+// keep-alive timeout (75 s) can close them under a request. A request that
+// fails on a reused connection before HA could have acted on it is sent once
+// more on a fresh one. When every slot is busy the request gets a connection
+// of its own, as before.
+
+#define HA_HTTP_SLOTS           3
+#define HA_HTTP_HOST_LEN        64
+#define HA_HTTP_TIMEOUT_MS      5000    // Default request deadline
+#define HA_HTTP_IDLE_MS         50000   // Default idle limit for a kept connection
+
+struct HAHttpSlot {
+    WiFiClient* client;         // WiFiClientSecure when secure
+    char host[HA_HTTP_HOST_LEN];
+    uint16_t port;
+    bool secure;
+    bool busy;
+    uint32_t lastUsedMs;
+    uint32_t requests;          // On the current connection
+};
+
+struct HAHttpStats {
+    uint32_t requests;
+    uint32_t reused;            // Sent on an already open connection
+    uint32_t connects;
+    uint32_t connectFailures;
+    uint32_t connectMsSum;
+    uint32_t connectMsMax;
+    uint32_t retries;           // Resent after a stale reused connection
+    uint32_t expired;           // Closed for being idle too long
+    uint32_t discarded;         // Closed because the body was not read or HA refused keep-alive
+    uint32_t unpooled;          // All slots busy (or keep-alive off)
+    uint32_t streamed;          // Bodies parsed by readJson()
+    uint32_t streamedBytes;
+    uint32_t streamedMaxBytes;  // Largest body that was never buffered
+};
+
+class HAHttpPool {
+public:
+    HAHttpPool();
+
+    // config["ha_http"]: keep_alive, idle_s. Requests work before begin()
+    // with the defaults.
+    void begin(JsonDocument& config);
+
+    // Close every idle connection (e.g. after the HA URL changed)
+    void closeIdle();
+
+    void getStatusJson(JsonObject obj);
+
+private:
+    friend class HARequest;
+
+    HAHttpSlot slots[HA_HTTP_SLOTS];
+    SemaphoreHandle_t mutex;
+    bool keepAlive;
+    uint32_t idleMs;
+    HAHttpStats stats;
+
+    // Bearer header of the last token seen, rebuilt only when it changes
+    String authToken;
+    String authHeader;
+
+    int acquire(const char* host, uint16_t port, bool secure);
+    void release(int slot, bool discarded);
+    void getAuthHeader(const char* token, String& header);
+    void recordRequest(bool reused, bool retried);
+    void recordConnect(bool ok, uint32_t ms);
+    void recordStreamed(size_t bytes);
+};
+
+class HARequest : public HTTPClient {
+public:
+    // url: full HA URL; token: long-lived access token ("" or nullptr for
+    // none); timeoutMs: deadline for connecting and receiving the response
+    HARequest(const String& url, const char* token, uint32_t timeoutMs = HA_HTTP_TIMEOUT_MS);
+    ~HARequest();
+
+    int GET();
+    int POST(String payload);
+    int POST(uint8_t* payload, size_t size);
+    int sendRequest(const char* type, uint8_t* payload = NULL, size_t size = 0);
+
+    String getString();
+    int writeToStream(Stream* stream);
+    // Feed the body to a parser set up with begin(), without buffering it;
+    // true if the document was complete or the parser stopped early
+    bool readJson(JsonStreamParser& parser);
+
+    // Hands the connection back to the pool; safe to call twice
+    void end();
+
+    bool isPooled() const { return slot >= 0; }
+
+private:
+    int slot;                   // -1 = own connection (plain HTTPClient)
+    bool began;
+    bool consumed;              // Response body fully read
+    bool requested;
+    uint32_t timeoutMs;
+
+    bool connectSlot(uint32_t timeout);
+};
+
+extern HAHttpPool haHttp;
+
+#endif
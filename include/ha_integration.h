@@ -16,18 +16,21 @@ public:
     void publishBinarySensorDiscovery(const char* name, const char* deviceClass);
     void publishSwitchDiscovery(const char* name);
     
-    // Entity control
-    void controlLight(const char* entityId, bool state, int brightness = -1);
-    void controlSwitch(const char* entityId, bool state);
-    void controlLock(const char* entityId, bool locked);
-    void controlCover(const char* entityId, const char* action); // open, close, stop
+    // Entity control; false if the command could not be published
+    bool controlLight(const char* entityId, bool state, int brightness = -1);
+    bool controlSwitch(const char* entityId, bool state);
+    bool controlLock(const char* entityId, bool locked);
+    bool controlCover(const char* entityId, const char* action); // open, close, stop
     
     // State updates
     void updatePresenceSensor(const char* person, bool present);
     void updateVoiceCommandSensor(const char* command);
     
     // Scenes
-    void activateScene(const char* sceneId);
+    bool activateScene(const char* sceneId);
+    
+    // Already-parsed action: domain "light", object id "living_room", service "on"
+    bool callService(const char* domain, const char* objectId, const char* service);
     
 private:
     unsigned long lastUpdate;
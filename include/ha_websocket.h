@@ -0,0 +1,300 @@
+#ifndef HA_WEBSOCKET_H
+#define HA_WEBSOCKET_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// Push-based Home Assistant state over the WebSocket API (/api/websocket)
+//
+// One persistent connection replaces the presence and weather REST polls.
+// After "auth", the client sends "subscribe_entities" restricted to the
+// entities the panel shows. HA answers with a compressed snapshot
+// ({"a": {entity: {"s", "a", "lc"}}}) and then pushes only diffs
+// ({"c": {entity: {"+": {...}, "-": {...}}}}, {"r": [entity]}) as they
+// happen. HAStateCache applies them and flags the entities that changed.
+// The main loop hands flagged entities to the UI.
+//
+// Layers, all portable except the device client at the bottom:
+//   wsEncodeFrame / WsDecoder  RFC 6455 client framing; fragments are
+//                              reassembled, control frames passed through
+//   HASession                  auth, subscription and keep-alive pings,
+//                              driven by whole text messages
+//   HAStateCache               fixed table of subscribed entities
+//
+// scripts/ha_ws_standin.py is a stand-in HA WebSocket server, and
+// scripts/ha_ws_test.cpp drives the portable layers against it over a real
+// socket.
+
+#define HA_WS_MAX_MESSAGE       16384   // Reassembled text message limit
+#define HA_WS_MAX_ENTITIES      24
+#define HA_WS_MAX_ATTRS         4       // Attributes kept per entity
+#define HA_WS_ENTITY_LEN        64
+#define HA_WS_STATE_LEN         48
+#define HA_WS_ATTR_LEN          48
+#define HA_WS_PING_MS           30000   // Idle time before a keep-alive ping
+#define HA_WS_PONG_TIMEOUT_MS   10000
+
+// ============================================
+// WebSocket framing (client side)
+// ============================================
+
+enum WsOpcode : uint8_t {
+    WS_OP_CONTINUATION = 0x0,
+    WS_OP_TEXT = 0x1,
+    WS_OP_BINARY = 0x2,
+    WS_OP_CLOSE = 0x8,
+    WS_OP_PING = 0x9,
+    WS_OP_PONG = 0xA
+};
+
+// Sec-WebSocket-Key for 16 random bytes (24 characters + NUL)
+void wsMakeKey(const uint8_t nonce[16], char key[25]);
+
+// Sec-WebSocket-Accept the server must answer a key with (28 characters + NUL)
+void wsAcceptFor(const char* key, char accept[29]);
+
+// HTTP upgrade request; returns its length (0 if out is too small)
+size_t wsBuildHandshake(const char* host, uint16_t port, const char* path, const char* key, char* out, size_t size);
+
+// Check the server's response headers (up to the blank line): 101 status
+// and the expected accept value
+bool wsCheckHandshake(const char* response, const char* key);
+
+// Masked client frame; returns bytes written (0 if out is too small)
+size_t wsEncodeFrame(WsOpcode op, const uint8_t* payload, size_t len, const uint8_t mask[4], uint8_t* out, size_t size);
+
+// Incremental frame decoder. Feed it whatever the socket returned. Whole
+// messages (fragments joined) and control frames come out of the handler.
+class WsDecoder {
+public:
+    typedef void (*Handler)(WsOpcode op, const uint8_t* data, size_t len, void* ctx);
+
+    WsDecoder();
+
+    void reset();
+    void setHandler(Handler fn, void* ctx) { handler = fn; handlerCtx = ctx; }
+
+    // False on a protocol error (masked server frame, unknown opcode,
+    // fragmented control frame, message over HA_WS_MAX_MESSAGE); the
+    // connection must be dropped
+    bool feed(const uint8_t* data, size_t len);
+
+private:
+    Handler handler;
+    void* handlerCtx;
+
+    uint8_t header[14];
+    size_t headerLen;
+    size_t headerNeed;
+    uint64_t remaining;         // Payload bytes left in the current frame
+    WsOpcode opcode;
+    bool fin;
+
+    WsOpcode messageOp;         // Opcode of the message being reassembled
+    bool inMessage;
+    std::vector<uint8_t> message;
+    uint8_t control[125];
+    size_t controlLen;
+
+    bool startFrame();
+    bool endFrame();
+};
+
+// ============================================
+// State cache
+// ============================================
+
+struct HAEntityState {
+    char entityId[HA_WS_ENTITY_LEN];
+    char state[HA_WS_STATE_LEN];
+    char attrs[HA_WS_MAX_ATTRS][HA_WS_ATTR_LEN];    // Watched attributes, "" if absent
+    double lastChanged;         // HA "lc", seconds since the epoch
+    uint32_t receivedMs;        // Clock value passed to apply()
+    uint32_t updates;
+    bool known;                 // Present in HA (false before the snapshot or after removal)
+    bool changed;               // Set by apply(), cleared by popChanged()
+};
+
+class HAStateCache {
+public:
+    HAStateCache();
+
+    // Entities to keep; everything else in a message is ignored
+    bool addEntity(const char* entityId);
+    // Attributes to keep per entity (friendly_name, temperature, ...)
+    bool watchAttribute(const char* name);
+
+    // Forget states (entities and attributes stay registered)
+    void reset();
+
+    // Apply the "event" object of a subscribe_entities message; returns the
+    // number of entities whose state or watched attributes changed
+    int apply(const char* json, size_t len, uint32_t now);
+
+    const HAEntityState* find(const char* entityId) const;
+    const char* getAttribute(const HAEntityState& s, const char* name) const;
+
+    // Next changed entity, cleared on return; false when none are left
+    bool popChanged(HAEntityState& out);
+
+    size_t getEntityCount() const { return entityCount; }
+    const char* getEntityId(size_t i) const { return entities[i].entityId; }
+
+    uint32_t getEvents() const { return events; }
+    uint32_t getChanges() const { return changes; }
+    uint32_t getIgnored() const { return ignored; }
+
+private:
+    HAEntityState entities[HA_WS_MAX_ENTITIES];
+    size_t entityCount;
+    char attrNames[HA_WS_MAX_ATTRS][32];
+    size_t attrCount;
+    uint32_t events;
+    uint32_t changes;
+    uint32_t ignored;           // Entities in messages we did not subscribe to
+
+    int indexOf(const char* entityId, size_t len) const;
+    bool applyState(HAEntityState& e, const char* json, size_t len, bool replace);
+};
+
+// ============================================
+// Session protocol
+// ============================================
+
+enum HASessionState : uint8_t {
+    HA_SESSION_CONNECTING,      // Waiting for auth_required
+    HA_SESSION_AUTHENTICATING,
+    HA_SESSION_SUBSCRIBING,
+    HA_SESSION_LIVE,
+    HA_SESSION_FAILED           // auth_invalid or subscription refused
+};
+
+class HASession {
+public:
+    // Sends one text message; false if the connection is gone
+    typedef bool (*Sender)(const char* text, size_t len, void* ctx);
+
+    HASession();
+
+    void begin(const char* token, Sender sender, void* ctx);
+
+    // New connection: back to waiting for auth_required. The cache keeps
+    // its states until the fresh snapshot replaces them.
+    void reset(uint32_t now);
+
+    // One text message from HA; false if the connection should be dropped
+    bool onMessage(const char* text, size_t len, uint32_t now);
+
+    // Keep-alive; false if a ping went unanswered
+    bool poll(uint32_t now);
+
+    HASessionState getState() const { return state; }
+    bool isLive() const { return state == HA_SESSION_LIVE; }
+    const char* getError() const { return error; }
+
+    HAStateCache& getCache() { return cache; }
+
+    uint32_t getMessages() const { return messages; }
+    uint32_t getPings() const { return pings; }
+    uint32_t getLastPingRttMs() const { return lastPingRttMs; }
+
+private:
+    HAStateCache cache;
+    const char* token;
+    Sender sender;
+    void* senderCtx;
+
+    HASessionState state;
+    uint32_t nextId;
+    uint32_t subscribeId;
+    uint32_t pingId;            // Outstanding ping, 0 = none
+    uint32_t pingSentMs;
+    uint32_t lastRxMs;
+    uint32_t messages;
+    uint32_t pings;
+    uint32_t lastPingRttMs;
+    char error[64];
+
+    bool send(const char* text, size_t len);
+    bool subscribe();
+    void fail(const char* why, const char* detail, size_t detailLen);
+};
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <WiFi.h>
+
+typedef void (*HAStateCallback)(const HAEntityState& state);
+
+// Runs the connection on its own network task; the main loop only drains
+// changed entities from the cache (under a mutex) and calls the callback.
+// While the session is not live, isLive() is false and callers keep using
+// their REST polls.
+class HAWebSocketClient {
+public:
+    HAWebSocketClient();
+
+    // config["ha_websocket"]: enabled; HA URL and token from integrations
+    void begin(JsonDocument& config);
+    // New HA URL or token saved: drop the session (and the old instance's
+    // states) and reconnect from the network task
+    void setConnection(const char* haUrl, const char* haToken);
+    // Before the first loop(): entities and attributes to follow
+    bool addEntity(const char* entityId) { return session.getCache().addEntity(entityId); }
+    bool watchAttribute(const char* name) { return session.getCache().watchAttribute(name); }
+    void setStateCallback(HAStateCallback callback) { stateCallback = callback; }
+    const char* getAttribute(const HAEntityState& s, const char* name) {
+        return session.getCache().getAttribute(s, name);
+    }
+
+    void loop();
+    bool isLive() const { return live; }
+
+    void getStatusJson(JsonObject obj);
+
+private:
+    HASession session;
+    WsDecoder decoder;
+    WiFiClient client;
+    SemaphoreHandle_t mutex;
+    TaskHandle_t task;
+    HAStateCallback stateCallback;
+
+    bool allowed;               // config["ha_websocket"]["enabled"]
+    volatile bool enabled;
+    String host;                // host, port and token under mutex
+    uint16_t port;
+    String token;
+    volatile bool live;
+    volatile bool dropRequested;
+    volatile bool reconnectRequested;
+
+    uint32_t connects;
+    uint32_t failures;
+    uint32_t disconnects;
+    uint32_t bytesIn;
+    uint32_t handshakeMs;
+    uint32_t delivered;
+    uint32_t deliveryMsMax;     // Message received -> callback
+    uint32_t deliveryMsSum;
+    uint32_t lastChangeAgeMs;   // HA last_changed -> callback (needs NTP)
+
+    bool applyConnection(const char* haUrl, const char* haToken);
+    static void networkTask(void* param);
+    void run();
+    void pause(uint32_t ms);
+    bool connect();
+    bool sendFrame(WsOpcode op, const uint8_t* data, size_t len);
+    static bool sendText(const char* text, size_t len, void* ctx);
+    static void onFrame(WsOpcode op, const uint8_t* data, size_t len, void* ctx);
+};
+
+extern HAWebSocketClient haSocket;
+#endif
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef INTENT_CACHE_H
+#define INTENT_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "command_engine.h"
+
+// LRU cache of resolved intents, keyed by the normalized transcription
+//
+// Residents repeat the same few phrases, so the command match a text resolved
+// to (including a template's slot value) is remembered and replayed without
+// matching again, or without waiting for the HA conversation agent when HA
+// could not handle the text and the local engine answered it. Each entry
+// also stores what the original resolution cost, so hits can report the time
+// they saved.
+//
+// Entries depend on commands.json and the HA entity index. Both are
+// summarized as 32-bit fingerprints; validate() drops the whole cache when
+// either changes. A fingerprint of 0 means "not known yet" (the entity
+// index before its first refresh) and is not compared. The cache serializes
+// to a flat buffer that carries its fingerprints, so a persisted cache is
+// checked against the live ones after a reboot.
+//
+// Fixed tables, no allocation. Portable; scripts/intent_cache_test.cpp runs
+// it on the host.
+
+#define INTENT_CACHE_SIZE       32
+#define INTENT_CACHE_KEY_LEN    128     // Normalized text never exceeds the raw text
+
+struct IntentCacheStats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t inserts;
+    uint32_t evictions;
+    uint32_t invalidations;
+    uint64_t savedUs;
+};
+
+class IntentCache {
+public:
+    IntentCache();
+
+    void clear();
+
+    // Cached match for a normalized key; a hit becomes most recently used
+    // and returns the cost of the original resolution in costUs
+    bool lookup(const char* key, CommandMatch& match, uint32_t* costUs = nullptr);
+
+    // Remember a resolution; evicts the least recently used entry when full.
+    // Ignored until both fingerprints are known.
+    bool insert(const char* key, const CommandMatch& match, uint32_t costUs);
+
+    // Adopt the live fingerprints (0 = unknown); returns true if the cache
+    // was dropped because one of them changed
+    bool validate(uint32_t commandsFp, uint32_t entitiesFp);
+    bool isReady() const { return commandsFingerprint && entitiesFingerprint; }
+
+    // Time saved by a hit, accumulated into the stats
+    void addSaved(uint32_t us) { stats.savedUs += us; }
+
+    // Flat image, least recently used first; load() rejects foreign layouts
+    size_t serializedSize() const;
+    size_t serialize(uint8_t* out, size_t size);
+    bool load(const uint8_t* data, size_t size);
+
+    // Changed since the last serialize()
+    bool isDirty() const { return dirty; }
+
+    size_t size() const { return count; }
+    const IntentCacheStats& getStats() const { return stats; }
+
+private:
+    struct Entry {
+        char key[INTENT_CACHE_KEY_LEN];
+        CommandMatch match;
+        uint32_t hash;
+        uint32_t costUs;
+        int8_t prev;            // Recency list, -1 = none
+        int8_t next;
+        bool used;
+    };
+
+    Entry entries[INTENT_CACHE_SIZE];
+    int8_t head;                // Most recently used
+    int8_t tail;
+    size_t count;
+    uint32_t commandsFingerprint;
+    uint32_t entitiesFingerprint;
+    bool dirty;
+    IntentCacheStats stats;
+
+    int find(const char* key, uint32_t hash) const;
+    void unlink(int i);
+    void pushFront(int i);
+};
+
+#endif
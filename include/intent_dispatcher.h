@@ -0,0 +1,139 @@
+#ifndef INTENT_DISPATCHER_H
+#define INTENT_DISPATCHER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "command_engine.h"
+#include "ha_assist_client.h"
+#include "intent_cache.h"
+
+// Hedged intent dispatch: local command engine vs. the HA conversation agent
+//
+// A transcription starts a /api/conversation/process request in a background
+// task and, at the same time, is matched by the local command engine. A local
+// match at or above "local_confident" wins at once and withdraws the HA
+// request. HA executes intents when the request arrives, so it is withdrawn
+// before it is sent, and a reply that still comes back is dropped. Otherwise
+// the dispatcher waits for HA. If HA handled the text (action_done or
+// query_answer) it wins. If HA could not, a local match at or above
+// "local_fallback" runs instead. On a timeout HA may still act on a request
+// it received, so once it was sent only a local query (no side effects)
+// falls back; anything else is reported as not answered. Win counts and
+// latency per path are in getStatusJson().
+//
+// Local resolutions are remembered in an IntentCache keyed by the normalized
+// text. A repeated phrase is executed from the cache without matching and
+// without a race, which matters most when the first time had to wait for
+// HA before falling back. Texts HA handled are not cached. The cache is saved
+// to LittleFS at most once a minute and reloaded at boot.
+
+#define INTENT_MAX_TEXT             128
+#define INTENT_DEFAULT_CONFIDENT    0.85f
+#define INTENT_DEFAULT_TIMEOUT_MS   6000
+#define INTENT_CACHE_FILE           "/intent_cache.bin"
+#define INTENT_CACHE_SAVE_MS        60000
+
+static_assert(INTENT_MAX_TEXT <= INTENT_CACHE_KEY_LEN, "normalized text must fit a cache key");
+
+enum IntentPath : uint8_t {
+    INTENT_PATH_NONE,
+    INTENT_PATH_LOCAL,
+    INTENT_PATH_HA
+};
+
+struct IntentResult {
+    IntentPath path;            // Who answered; NONE = not recognized
+    bool success;
+    bool duplicate;             // Local action dropped by the action queue dedup
+    bool cached;                // Local match replayed from the intent cache
+    bool noAnswer;              // NONE because HA got the text but did not answer in time
+    uint32_t actionId;          // Local action, reported again on completion
+    int commandId;              // Local commands.json id
+    float confidence;           // Local match confidence (1.0 for HA)
+    uint32_t latencyMs;         // dispatch() to decision
+    const char* text;
+    String reply;               // Query answer or HA speech
+};
+
+typedef void (*IntentResultCallback)(const IntentResult& result);
+
+class IntentDispatcher {
+public:
+    IntentDispatcher();
+
+    // config["intents"]: remote, local_confident, local_fallback, timeout_ms, cache
+    void begin(JsonDocument& config);
+    void loop();
+
+    // Start a race for the text; the result arrives via the callback, right
+    // away for a confident local match, otherwise from loop()
+    void dispatch(const char* text);
+    bool isPending() const { return waiting; }
+
+    void setResultCallback(IntentResultCallback callback) { resultCallback = callback; }
+
+    void getStatusJson(JsonObject obj);
+
+private:
+    struct PathStats {
+        uint32_t wins;
+        uint32_t latencySum;    // us for local matches, ms for HA replies
+        uint32_t latencyCount;
+        uint32_t latencyMax;
+    };
+
+    bool remote;
+    float localConfident;
+    float localFallback;
+    uint32_t timeoutMs;
+    IntentResultCallback resultCallback;
+
+    IntentCache cache;
+    bool cacheEnabled;
+    unsigned long lastCacheSave;
+
+    // Current race
+    char text[INTENT_MAX_TEXT];
+    char key[INTENT_MAX_TEXT];  // Normalized text
+    uint32_t started;
+    uint32_t startedUs;
+    bool fromCache;
+    bool waiting;
+    bool localFound;
+    CommandMatch localMatch;
+
+    // HA conversation task -> loop
+    TaskHandle_t task;
+    ConversationRequest haRequest;
+    volatile bool cancelRequested;
+    volatile bool haSent;       // The text is out: HA may act on it
+    volatile bool haDone;
+    ConversationReply haReply;
+    uint32_t haLatencyMs;
+
+    uint32_t dispatched;
+    uint32_t unrecognized;
+    uint32_t haRequests;
+    uint32_t haWithdrawn;       // Cancelled before sending
+    uint32_t haDiscarded;       // Answered after losing the race
+    uint32_t haBusy;            // Previous request still running, local only
+    uint32_t haErrors;
+    uint32_t haNoMatch;
+    uint32_t haTimeouts;
+    uint32_t haNoAnswer;        // Timed out after sending, no local query to fall back to
+    uint32_t localFallbacks;
+    PathStats localStats;
+    PathStats haStats;
+
+    static void conversationTask(void* param);
+    void decide(IntentPath path, bool noAnswer = false);
+    void collectHaReply();
+    void validateCache();
+    void loadCache();
+    void saveCache();
+    static void addLatency(PathStats& s, uint32_t value);
+};
+
+extern IntentDispatcher intentDispatcher;
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef INTERCOM_STREAM_H
+#define INTERCOM_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "audio_pipeline.h"
+
+// Live intercom: microphone -> RTP/UDP (G.711 µ-law, 8 kHz, 20 ms packets)
+// Frames arrive from the pipeline "streamer" stage, are decimated to 8 kHz
+// and µ-law encoded into a ring; a 20 ms pacing task turns the 32 ms capture
+// frames into evenly spaced RTP packets. RTP timestamps follow the capture
+// sample clock. RTCP sender reports go out every 5 s and receiver reports
+// from the far end are parsed for loss, jitter and round-trip time.
+// See scripts/rtp_receiver.py for a matching Linux receiver.
+
+#define INTERCOM_SAMPLE_RATE        8000
+#define INTERCOM_PACKET_MS          20
+#define INTERCOM_PACKET_SAMPLES     (INTERCOM_SAMPLE_RATE * INTERCOM_PACKET_MS / 1000)  // 160
+#define INTERCOM_RING_SAMPLES       4096    // 512 ms at 8 kHz (power of two)
+#define INTERCOM_MAX_QUEUE          (3 * INTERCOM_PACKET_SAMPLES)   // Latency bound
+#define INTERCOM_DEFAULT_PORT       5004
+#define INTERCOM_RTCP_INTERVAL_MS   5000
+#define INTERCOM_PAYLOAD_PCMU       0       // RTP payload type (RFC 3551)
+#define RTP_HEADER_SIZE             12
+
+// ============================================
+// Portable codec helpers
+// ============================================
+
+// G.711 µ-law encoder (ITU-T G.711)
+uint8_t g711MulawEncode(int16_t sample);
+
+// 2:1 decimator (31-tap half-band FIR, Q15), 16 kHz -> 8 kHz
+class HalfbandDecimator {
+public:
+    HalfbandDecimator();
+    void reset();
+
+    // in: count samples (even); out: count / 2 samples. Returns samples written.
+    size_t process(const int16_t* in, size_t count, int16_t* out);
+
+private:
+    static const int TAPS = 31;
+    int16_t history[TAPS - 1];
+};
+
+// Fixed 12-byte RTP header (RFC 3550), no CSRCs or extensions
+void rtpWriteHeader(uint8_t* buf, uint8_t payloadType, bool marker, uint16_t seq, uint32_t timestamp, uint32_t ssrc);
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+
+struct IntercomStats {
+    uint32_t packetsSent;
+    uint32_t bytesSent;
+    uint32_t sendErrors;
+    uint32_t underruns;         // Pacing tick with less than one packet queued
+    uint32_t skippedPackets;    // Dropped to bound the queue (clock drift / stalls)
+    uint32_t overflowSamples;   // Capture side could not queue (sender stalled)
+    uint32_t sinkUsMax;         // Decimate + encode time on the pipeline side
+    uint32_t intervalUsMax;     // Largest gap between consecutive packets
+    uint32_t jitterUs;          // Mean deviation of the send interval from 20 ms
+
+    // From the receiver's RTCP reports
+    uint32_t rtcpReports;
+    float remoteFractionLost;
+    int32_t remoteCumulativeLost;
+    uint32_t remoteJitterMs;
+    uint32_t rttMs;
+};
+
+class IntercomStream {
+public:
+    IntercomStream();
+
+    // Read config["intercom"] (default host/port)
+    void begin(JsonDocument& config);
+
+    // Request streaming to host:port (empty host = configured default);
+    // false without a host or WiFi. Safe from the web server task: loop()
+    // starts the sender once the previous one has exited.
+    bool start(const char* host, uint16_t port);
+    void stop();
+
+    // Main loop: carries out start()
+    void loop();
+    bool isRunning() const { return running; }
+    bool hasDefaultHost() const { return defaultHost[0] != '\0'; }
+
+    void getStatusJson(JsonObject obj);
+
+private:
+    char defaultHost[64];
+    uint16_t defaultPort;
+
+    volatile bool running;
+    volatile bool startRequested;
+    char requestedHost[64];
+    uint16_t requestedPort;
+    char host[64];
+    uint16_t port;
+    int rtpSocket;
+    int rtcpSocket;
+    uint32_t destAddr;
+    TaskHandle_t task;
+    unsigned long startedAt;
+
+    // Capture side (pipeline) -> pacing task
+    HalfbandDecimator decimator;
+    uint8_t ring[INTERCOM_RING_SAMPLES];
+    std::atomic<uint32_t> writeIndex;
+    std::atomic<uint32_t> readIndex;
+
+    // RTP state
+    uint16_t seq;
+    uint32_t ssrc;
+    uint32_t timestampBase;
+    uint32_t lastSrNtpMid;          // Middle 32 bits of the last SR's NTP time
+    uint32_t lastSrSentMs;
+
+    IntercomStats stats;
+
+    static void sinkCallback(const AudioFrame& frame);
+    void pushFrame(const AudioFrame& frame);
+
+    void launch();
+    static void senderTask(void* param);
+    void sendPacket(uint32_t tail);
+    void sendSenderReport(uint32_t tail);
+    void pollReceiverReports();
+    bool openSockets();
+    void closeSockets();
+};
+
+extern IntercomStream intercom;
+#endif
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef JOB_SCHEDULER_H
+#define JOB_SCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Periodic jobs for the main loop
+//
+// loop() used to be a chain of `if (now - lastX >= N)` blocks. They all came
+// due together after boot, and an HTTP fetch in one of them held up the UI
+// and everything after it for seconds. Jobs are now registered with a period,
+// a priority class, a run-time budget and a jitter:
+//
+//   - Each class keeps its due jobs in a min-heap on the due time. The
+//     highest class with a due job runs first, so a UI job never waits
+//     behind telemetry or a fetch.
+//   - Every due time gets a random 0..jitter ms added, so jobs with the same
+//     period drift apart instead of firing in lock-step.
+//   - A job keeps its cadence (due += period). Periods missed entirely are
+//     skipped and counted rather than run back to back.
+//   - A run longer than the budget counts as an overrun. The worst lateness
+//     and run time are kept per job.
+//
+// JOB_FETCH jobs run on a worker task (see LoopScheduler below), one at a
+// time, with an optional completion that runs on the main loop to apply the
+// result to the UI.
+//
+// Fixed-size tables, no allocation. The core is portable and takes the time
+// as a parameter; scripts/job_scheduler_test.cpp drives it with a simulated
+// clock on the host.
+
+#define JOB_MAX             12
+
+// Priority classes, highest first
+enum JobClass : uint8_t {
+    JOB_VOICE,
+    JOB_UI,
+    JOB_TELEMETRY,
+    JOB_FETCH,                  // Network fetch, run on the worker
+    JOB_CLASSES
+};
+
+typedef void (*JobFn)(void* ctx);
+
+struct JobSpec {
+    const char* name;
+    JobClass cls;
+    uint32_t periodMs;
+    uint32_t jitterMs;          // Added to each due time, 0..jitterMs
+    uint32_t budgetMs;          // Longer runs count as overruns
+    JobFn run;                  // Main loop, or the worker for JOB_FETCH
+    JobFn done;                 // JOB_FETCH only: main loop, after run; may be nullptr
+    void* ctx;
+};
+
+struct JobStats {
+    uint32_t runs;
+    uint32_t overruns;          // Ran longer than the budget
+    uint32_t skipped;           // Periods missed entirely
+    uint32_t triggered;         // Run early by trigger()
+    uint32_t lastUs;
+    uint32_t maxUs;
+    uint64_t totalUs;
+    uint32_t maxLateMs;         // Worst start after the due time
+};
+
+class JobScheduler {
+public:
+    JobScheduler();
+
+    // Job id, or -1 if the table is full. First run after firstDelayMs plus
+    // jitter.
+    int add(const JobSpec& spec, uint32_t now, uint32_t firstDelayMs);
+
+    // Pop the next due job: highest class first, then earliest due. The job
+    // is out of the heap until finish(). JOB_FETCH jobs are left alone if
+    // !fetchAllowed (the worker is busy). Returns -1 if nothing is due.
+    int next(uint32_t now, bool fetchAllowed = true);
+
+    // Record a run that started at `start` and took runUs; reschedule
+    void finish(int id, uint32_t start, uint32_t runUs);
+
+    // Run as soon as possible; if it is running, once more right after
+    void trigger(int id, uint32_t now);
+
+    // Takes effect from the next due time
+    void setPeriod(int id, uint32_t periodMs);
+
+    // Time until the next job of any class is due (0 = now, UINT32_MAX = none)
+    uint32_t nextDue(uint32_t now) const;
+
+    void seed(uint32_t seed) { rng = seed ? seed : 1; }
+
+    int getCount() const { return count; }
+    const JobSpec& getSpec(int id) const { return jobs[id].spec; }
+    const char* getName(int id) const { return jobs[id].spec.name; }
+    const JobStats& getStats(int id) const { return jobs[id].stats; }
+    bool isRunning(int id) const { return jobs[id].running; }
+
+private:
+    struct Job {
+        JobSpec spec;           // name points at the caller's string
+        uint32_t base;          // Nominal due time, without jitter
+        uint32_t due;           // base + jitter, or now after trigger()
+        bool queued;            // In its class heap
+        bool running;
+        bool retrigger;
+        JobStats stats;
+    };
+
+    Job jobs[JOB_MAX];
+    int count;
+    uint8_t heap[JOB_CLASSES][JOB_MAX];
+    uint8_t heapSize[JOB_CLASSES];
+    uint32_t rng;
+
+    uint32_t jitter(uint32_t maxMs);
+    bool before(int a, int b) const;
+    void push(int id);
+    int pop(JobClass cls);
+    void remove(int id);
+};
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#define SCHED_PASS_BUDGET_MS    20      // Stop starting main-loop jobs after this
+
+// JobScheduler on the main loop plus a worker task on core 0 for the
+// JOB_FETCH jobs. Everything except a fetch job's run() is called from
+// loop(), so jobs may touch LVGL and MQTT. A fetch job's run() must not;
+// it leaves its result for done().
+class LoopScheduler {
+public:
+    LoopScheduler();
+
+    bool begin();
+
+    // Main loop only
+    int add(const JobSpec& spec, uint32_t firstDelayMs = 0);
+    void trigger(int id);
+    void setPeriod(int id, uint32_t periodMs);
+    void loop();
+
+    void getStatusJson(JsonObject obj);
+
+private:
+    JobScheduler jobs;
+    TaskHandle_t worker;
+    volatile int workerJob;             // Handed to the worker, -1 = idle
+    volatile bool workerDone;
+    volatile uint32_t workerStart;
+    volatile uint32_t workerRunUs;
+    uint32_t passes;
+    uint32_t deferredPasses;            // Ended by the pass budget with jobs due
+
+    static void workerTask(void* param);
+};
+
+extern LoopScheduler scheduler;
+#endif
+
+#endif
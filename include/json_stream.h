@@ -0,0 +1,154 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Streaming JSON parser for large Home Assistant responses
+//
+// /api/states, calendar listings and state objects with long attribute lists
+// used to be read into a String with getString() and then deserialized or
+// scanned with indexOf, so the whole body (often hundreds of KB for
+// /api/states) sat in the heap at once, plus a JsonDocument on top of it.
+// JsonStreamParser is fed the body in whatever pieces arrive from the
+// socket and reports each scalar value together with its path. The caller
+// keeps only the fields it is after:
+//
+//   static void onValue(JsonStreamParser& p, JsonStreamType type, const char* value, size_t len, void* ctx) {
+//       if (p.match("[*].entity_id")) ...
+//   }
+//   JsonStreamParser parser;
+//   parser.begin(onValue, nullptr, &ctx);
+//   http.readJson(parser);                  // HARequest, see ha_http.h
+//
+// Memory is fixed: the container path (keys and array indexes of the first
+// JSON_STREAM_MAX_DEPTH levels) and one value buffer. Longer strings are
+// truncated (isTruncated()), deeper levels are parsed but their values
+// never match a pattern, and nothing is allocated while parsing.
+//
+// Portable; scripts/json_stream_bench.cpp checks and benchmarks it on the
+// host.
+
+#define JSON_STREAM_MAX_DEPTH   8       // Levels with a tracked key or index
+#define JSON_STREAM_MAX_NESTING 64      // Deeper documents are rejected
+#define JSON_STREAM_KEY_LEN     32
+#define JSON_STREAM_VALUE_LEN   128     // Longest value text kept (truncated)
+
+enum JsonStreamType : uint8_t {
+    JSON_STREAM_STRING,
+    JSON_STREAM_NUMBER,
+    JSON_STREAM_BOOL,
+    JSON_STREAM_NULL
+};
+
+class JsonStreamParser {
+public:
+    // Scalar value; value is NUL-terminated, the path describes where it is
+    typedef void (*ValueHandler)(JsonStreamParser& parser, JsonStreamType type, const char* value, size_t len, void* ctx);
+    // Object or array closed; the path describes where it was
+    typedef void (*CloseHandler)(JsonStreamParser& parser, void* ctx);
+
+    JsonStreamParser();
+
+    // Reset for a new document; either handler may be nullptr
+    void begin(ValueHandler onValue, CloseHandler onClose, void* ctx);
+
+    // Next piece of the document; false once it is invalid or stopped
+    bool feed(const char* data, size_t len);
+    // End of input; true if one complete document was read (or stop() was
+    // called). Flushes a number at the very end of the document.
+    bool finish();
+
+    // From a handler: ignore the rest of the input
+    void stop();
+
+    bool isDone() const { return state == DONE || state == STOPPED; }
+    bool isStopped() const { return state == STOPPED; }
+    bool hasError() const { return state == FAILED; }
+    const char* getError() const { return error; }
+    // Bytes consumed so far (the error offset after a failure)
+    size_t getOffset() const { return offset; }
+
+    // Path of the current value: containers enclosing it, outermost first
+    int getDepth() const { return depth; }
+    bool isArray(int level) const;
+    int getIndex(int level) const;
+    // Member key at that level, "" for arrays, untracked or truncated keys
+    const char* getKey(int level) const;
+    bool isTruncated() const { return truncated; }
+
+    // Whole-path match: "version", "[*].entity_id", "[0].start.date",
+    // "attributes.forecast[*].temperature"; "" is the document itself
+    bool match(const char* pattern) const;
+
+private:
+    enum State : uint8_t {
+        VALUE, ARRAY_FIRST, OBJECT_FIRST, KEY, COLON, NEXT,
+        STRING, ESCAPE, UNICODE, LITERAL, DONE, STOPPED, FAILED
+    };
+
+    ValueHandler onValue;
+    CloseHandler onClose;
+    void* ctx;
+
+    State state;
+    bool inKey;
+    bool truncated;
+    const char* error;
+    size_t offset;
+
+    int depth;
+    uint64_t arrays;            // Bit per nesting level: 1 = array
+    char keys[JSON_STREAM_MAX_DEPTH][JSON_STREAM_KEY_LEN];
+    bool keyTruncated[JSON_STREAM_MAX_DEPTH];
+    int indexes[JSON_STREAM_MAX_DEPTH];
+
+    char text[JSON_STREAM_VALUE_LEN];
+    size_t textLen;
+    uint32_t codePoint;         // \uXXXX being read
+    uint16_t highSurrogate;     // First half of a surrogate pair
+    uint8_t hexDigits;
+
+    bool step(char c);
+    void fail(const char* why);
+    void append(char c);
+    void appendCodePoint(uint32_t cp);
+    bool open(bool array);
+    bool close(bool array);
+    void valueDone();
+    bool finishLiteral();
+    void emit(JsonStreamType type);
+};
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include <Arduino.h>
+
+// Stream sink for HTTPClient::writeToStream(): feeds the parser as the body
+// arrives. Keeps accepting (and dropping) bytes after the parser stopped or
+// failed, so the rest of the response is drained and the connection stays
+// reusable.
+class JsonStreamSink : public Stream {
+public:
+    JsonStreamSink(JsonStreamParser& parser) : parser(parser), bytes(0) {}
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* data, size_t size) override {
+        if (!parser.isDone() && !parser.hasError()) {
+            parser.feed((const char*)data, size);
+        }
+        bytes += size;
+        return size;
+    }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override {}
+
+    JsonStreamParser& parser;
+    size_t bytes;
+};
+#endif
+
+#endif
@@ -5,12 +5,15 @@
 #include <lvgl.h>
 #include <TFT_eSPI.h>
 #include <FT6X36.h>
+#include <ArduinoJson.h>
+#include "change_filter.h"
 
 // UI Constants
 #define SCREEN_WIDTH 480
 #define SCREEN_HEIGHT 320
 #define MAX_PEOPLE 4
 #define MAX_CALENDAR_EVENTS 5
+#define VOICE_METER_PERIOD_MS 50    // Level meter refresh cap (20 fps)
 
 // Screen IDs
 enum ScreenID {
@@ -58,6 +61,16 @@ public:
     void showVoicePopup(const char* statusText, const char* subtitle = nullptr);
     void hideVoicePopup();
     void updateVoicePopupText(const char* statusText, const char* subtitle = nullptr);
+    void setVoiceLevelMeter(bool enabled);  // Live microphone level bar in the popup
+    
+    // Widget updates let through and skipped as unchanged
+    void getStatusJson(JsonObject obj);
+    
+    // What the dashboard shows, for the boot cache: saved when
+    // getUpdateCount() has moved, restored before HA answers
+    void saveDashboard(JsonDocument& doc);
+    void restoreDashboard(JsonVariantConst doc);
+    uint32_t getUpdateCount();
     
 private:
     TFT_eSPI tft;
@@ -97,6 +110,12 @@ private:
     lv_obj_t* gateContainer;
     lv_obj_t* gateIcon;       // Gate icon (placeholder for now)
     lv_obj_t* gateStatusLabel;
+    int8_t gateState;         // -1 = not shown yet
+    
+    // Last weather shown, as HA reported it
+    bool hasWeather;
+    float weatherTemp;
+    char weatherCondition[32];
     
     // Voice button (small, bottom right)
     lv_obj_t* voiceButton;
@@ -107,6 +126,10 @@ private:
     lv_obj_t* voicePopupStatusLabel; // "Listening" / "Processing" text
     lv_obj_t* voicePopupSubtitleLabel; // Recognized words / secondary text
     lv_obj_t* voicePopupAnimation;  // Animated indicator (pulsing circle)
+    lv_obj_t* voicePopupMeter;      // Live audio level bar
+    lv_timer_t* voiceMeterTimer;
+    uint16_t voiceMeterSeq;         // Last level snapshot sequence shown
+    int16_t voiceMeterValue;        // Displayed value (0-100) with decay
     
     // Calendar card (top right below time)
     lv_obj_t* calendarContainer;
@@ -115,6 +138,10 @@ private:
     CalendarEvent calendarEvents[MAX_CALENDAR_EVENTS];
     int calendarEventCount;
     
+    // Last values shown by the update functions above; unchanged updates
+    // return before touching LVGL
+    ChangeFilter changes;
+    
     // Quick Actions screen widgets
     lv_obj_t* quickActionsLabel;
     
@@ -133,6 +160,7 @@ private:
     static void touchpad_read(lv_indev_drv_t *indev, lv_indev_data_t *data);
     static void voice_button_cb(lv_event_t* e);
     static void screen_gesture_cb(lv_event_t* e);
+    static void voice_meter_timer_cb(lv_timer_t* timer);
     
     // Singleton instance for static callbacks
     static LVGL_UI* instance;
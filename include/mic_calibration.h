@@ -0,0 +1,106 @@
+#ifndef MIC_CALIBRATION_H
+#define MIC_CALIBRATION_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "config.h"
+
+// Microphone / threshold calibration
+// Measures ambient noise (and optionally a prompted phrase) to derive the
+// per-device speech/silence thresholds used by the recording state machine.
+// A slow drift tracker re-tunes the thresholds as the room noise changes.
+
+// Recording thresholds, all as 16-bit sample peak levels
+struct VoiceThresholds {
+    int16_t speech;      // Level that starts a recording
+    int16_t silence;     // Below this = silence (ends a recording)
+    int16_t minSpeech;   // Minimum max level during recording to send to STT
+};
+
+enum CalibrationPhase {
+    CALIBRATION_IDLE = 0,
+    CALIBRATION_NOISE,       // Measuring ambient noise, room must be quiet
+    CALIBRATION_PHRASE,      // Waiting for / recording the prompted phrase
+    CALIBRATION_DONE,
+    CALIBRATION_FAILED
+};
+
+class MicCalibration {
+public:
+    MicCalibration();
+
+    // Load persisted thresholds from config["voice"]["calibration"]
+    void begin(JsonDocument& config);
+
+    // Run from loop(): starts requested runs and persists results
+    void loop();
+
+    // Request a calibration run or cancel it (safe to call from web server
+    // task); loop() carries them out
+    bool requestStart(uint16_t noiseSeconds, bool recordPhrase);
+    void cancel();
+
+    bool isRunning() const { return phase == CALIBRATION_NOISE || phase == CALIBRATION_PHRASE; }
+    CalibrationPhase getPhase() const { return phase; }
+
+    // Feed per-frame peak level while calibrating
+    void processFrame(int16_t peakLevel);
+
+    // Feed per-frame peak level while idle (background drift tracking)
+    void trackDrift(int16_t peakLevel);
+
+    const VoiceThresholds& getThresholds() const { return thresholds; }
+    int16_t getNoiseFloor() const { return noiseFloor; }
+    bool isCalibrated() const { return calibrated; }
+
+    void getStatusJson(JsonDocument& doc);
+
+private:
+    static const int MAX_NOISE_FRAMES = 1024;   // ~32s of 512-sample frames
+    static const int MAX_PHRASE_FRAMES = 256;   // ~8s of 512-sample frames
+
+    volatile CalibrationPhase phase;
+    volatile bool startRequested;
+    volatile bool cancelRequested;
+    uint16_t requestedNoiseSeconds;
+    bool requestedPhrase;
+
+    VoiceThresholds thresholds;
+    bool calibrated;
+    bool saveRequested;
+
+    // Current run
+    bool recordPhrase;
+    unsigned long phaseStartTime;
+    unsigned long noiseDurationMs;
+    int16_t noiseLevels[MAX_NOISE_FRAMES];
+    int noiseCount;
+    int16_t phraseLevels[MAX_PHRASE_FRAMES];
+    int phraseCount;
+
+    // Results of the last run
+    int16_t noiseFloor;      // Mean noise peak level
+    int16_t noiseP95;        // 95th percentile noise peak level
+    int16_t noiseStdDev;
+    int16_t phraseLevel;     // Median peak level of the prompted phrase (0 = none)
+    time_t calibratedAt;
+    const char* lastError;
+
+    // Drift tracking (fixed point, level << 8)
+    int32_t driftEma;
+    unsigned long lastDriftCheck;
+    unsigned long lastDriftSave;
+    uint32_t driftAdjustments;
+
+    void startRun();
+    void finishNoisePhase();
+    void finishRun();
+    void fail(const char* reason);
+    void deriveThresholds();
+    void saveToConfig();
+    static int16_t percentile(int16_t* values, int count, int pct);
+};
+
+extern MicCalibration micCalibration;
+
+#endif
@@ -4,6 +4,8 @@
 #include <PubSubClient.h>
 #include <WiFi.h>
 #include <ArduinoJson.h>
+#include "audio_metrics.h"
+#include "config_service.h"
 
 typedef void (*MqttMessageCallback)(const char* topic, const char* payload);
 
@@ -27,6 +29,8 @@ public:
     void publishVoiceDetection(const char* wakeWord);
     void publishCommandExecuted(const char* command, const char* result);
     void publishPresenceUpdate(const char* person, bool present);
+    void publishVoiceMetrics(const UtteranceMetrics& metrics);
+    void publishBootReport(JsonDocument& report);
     
 private:
     WiFiClient espClient;
@@ -47,6 +51,7 @@ private:
     void loadConfig();
     void reconnect();
     static void mqttCallback(char* topic, byte* payload, unsigned int length);
+    static void onConfigChanged(const ConfigSnapshot& config, uint32_t changed, void* ctx);
     String getTopicPrefix();
 };
 
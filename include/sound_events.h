@@ -0,0 +1,262 @@
+#ifndef SOUND_EVENTS_H
+#define SOUND_EVENTS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "audio_pipeline.h"
+
+// Acoustic event detection (doorbell, knock, glass break, dog bark, ...)
+// Streaming log-mel front end + small int8 CNN loaded from a model file.
+//
+// The front end, model runtime and event tracker have no Arduino dependency
+// so clip corpora can be evaluated on a Linux host with the same code
+// (see scripts/sound_event_eval.cpp). The device part (pipeline stage,
+// inference task, MQTT publishing) is compiled only for ARDUINO.
+
+#define SOUND_EVENTS_MODEL_FILE     "/models/sound_events.bin"
+#define SOUND_EVENTS_MODEL_MAGIC    0x31564553  // "SEV1"
+#define SOUND_EVENTS_FFT_SIZE       512
+#define SOUND_EVENTS_MAX_MELS       64
+#define SOUND_EVENTS_MAX_CLASSES    16
+#define SOUND_EVENTS_MAX_LAYERS     16
+#define SOUND_EVENTS_NAME_LEN       24
+
+// ============================================
+// Log-mel front end
+// ============================================
+
+class LogMelFrontend {
+public:
+    LogMelFrontend();
+
+    // numMels triangular filters between fMin and fMax at SAMPLE_RATE
+    bool begin(int numMels, float fMin = 60.0f, float fMax = 7600.0f);
+
+    // One frame of SOUND_EVENTS_FFT_SIZE samples -> numMels log energies
+    void process(const int16_t* samples, size_t count, float* melOut);
+
+    int getNumMels() const { return numMels; }
+
+private:
+    int numMels;
+    float window[SOUND_EVENTS_FFT_SIZE];
+    float re[SOUND_EVENTS_FFT_SIZE];
+    float im[SOUND_EVENTS_FFT_SIZE];
+    float melEdges[SOUND_EVENTS_MAX_MELS + 2];      // Filter edges in FFT bins (fractional)
+
+    void fft();
+};
+
+// Sliding window of quantized log-mel rows (time x mels)
+class LogMelWindow {
+public:
+    LogMelWindow();
+    ~LogMelWindow();
+
+    bool begin(int frames, int mels, int8_t fill);
+    void push(const int8_t* row);
+    bool isFull() const { return count >= frames; }
+
+    // Copy the window oldest-first into dst (frames * mels bytes)
+    void copyTo(int8_t* dst) const;
+
+private:
+    int8_t* ring;
+    int frames;
+    int mels;
+    int head;
+    int count;
+};
+
+// ============================================
+// int8 CNN runtime
+// ============================================
+
+enum SoundLayerType {
+    SOUND_LAYER_CONV2D = 1,     // k x k, stride s, same padding, fused ReLU flag
+    SOUND_LAYER_MAXPOOL = 2,    // k x k, stride k
+    SOUND_LAYER_GAP = 3,        // Global average pooling
+    SOUND_LAYER_DENSE = 4       // Fully connected
+};
+
+// On-file layer header (little endian, 20 bytes), followed by int8 weights
+// and int32 biases, each padded to 4 bytes
+struct SoundLayerHeader {
+    uint8_t type;
+    uint8_t flags;              // bit 0: ReLU
+    uint8_t kernel;
+    uint8_t stride;
+    uint16_t outChannels;
+    uint16_t reserved;
+    float multiplier;           // inScale * weightScale / outScale
+    float outScale;             // Used to dequantize the final layer
+    int8_t outZero;
+    uint8_t pad[3];
+};
+
+struct SoundLayer {
+    SoundLayerHeader hdr;
+    const int8_t* weights;
+    const int32_t* bias;
+    uint32_t weightCount;
+    // Resolved shapes
+    uint16_t inH, inW, inC;
+    uint16_t outH, outW, outC;
+    int8_t inZero;
+};
+
+class SoundEventModel {
+public:
+    SoundEventModel();
+    ~SoundEventModel();
+
+    // Parse a model image; takes ownership of data (must be malloc'ed)
+    bool load(uint8_t* data, size_t len);
+    void unload();
+    bool isLoaded() const { return loaded; }
+
+    int getInputFrames() const { return inputFrames; }
+    int getInputMels() const { return inputMels; }
+    int getNumClasses() const { return numClasses; }
+    const char* getClassName(int index) const { return classNames[index]; }
+    size_t getArenaBytes() const { return arenaBytes; }
+    uint32_t getMacs() const { return macs; }
+
+    // Quantize one log-mel value for the input tensor
+    int8_t quantizeInput(float value) const;
+
+    // Run inference on an inputFrames x inputMels int8 patch
+    bool run(const int8_t* input, float* probs);
+
+    const char* getError() const { return error; }
+
+private:
+    bool loaded;
+    uint8_t* image;
+    int inputFrames;
+    int inputMels;
+    int numClasses;
+    float inputScale;
+    int8_t inputZero;
+    char classNames[SOUND_EVENTS_MAX_CLASSES][SOUND_EVENTS_NAME_LEN];
+    SoundLayer layers[SOUND_EVENTS_MAX_LAYERS];
+    int numLayers;
+    int8_t* arenaA;
+    int8_t* arenaB;
+    size_t arenaBytes;
+    uint32_t macs;
+    const char* error;
+
+    bool fail(const char* reason);
+};
+
+// ============================================
+// Event tracker (thresholds, persistence, cooldown)
+// ============================================
+
+class SoundEventTracker {
+public:
+    SoundEventTracker();
+
+    // Classes named "background" or starting with '_' never fire
+    void configure(const SoundEventModel& model, float threshold, uint8_t consecutive, uint16_t cooldownWindows);
+
+    // Feed one window's probabilities; returns the fired class or -1
+    int update(const float* probs, float* confidence);
+
+private:
+    int numClasses;
+    float threshold;
+    uint8_t consecutive;
+    uint16_t cooldownWindows;
+    bool ignored[SOUND_EVENTS_MAX_CLASSES];
+    uint8_t hits[SOUND_EVENTS_MAX_CLASSES];
+    uint16_t cooldown[SOUND_EVENTS_MAX_CLASSES];
+};
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+
+struct SoundEventStats {
+    uint32_t windows;           // Mel windows offered for inference
+    uint32_t inferences;
+    uint32_t skippedBudget;     // Dropped to respect the CPU cap
+    uint32_t skippedBusy;       // Previous inference still running
+    uint32_t detections;
+    uint32_t lastInferenceUs;
+    uint32_t maxInferenceUs;
+    uint64_t totalInferenceUs;
+    uint32_t frontendUsMax;
+    float cpuPercent;           // Share of one core used by inference
+};
+
+class SoundEventDetector {
+public:
+    SoundEventDetector();
+
+    // Read config["sound_events"], load the model and start the inference task
+    void begin(JsonDocument& config);
+
+    // Main loop: publishes detections and HA discovery
+    void loop();
+
+    // Called from the pipeline stage for every captured frame
+    void processFrame(const AudioFrame& frame);
+
+    bool isActive() const { return active; }
+    void getStatusJson(JsonObject obj);
+
+private:
+    bool active;
+    SoundEventModel model;
+    LogMelFrontend frontend;
+    SoundEventTracker tracker;
+
+    // Config
+    uint8_t hopFrames;
+    uint8_t cpuCapPercent;
+
+    // Log-mel window (main loop writes, copied out on hop)
+    LogMelWindow window;
+    int framesSinceHop;
+
+    // Inference hand-off (single slot)
+    int8_t* inputPatch;
+    std::atomic<bool> inputReady;
+    float probs[SOUND_EVENTS_MAX_CLASSES];
+    std::atomic<bool> resultReady;
+    TaskHandle_t task;
+
+    // CPU cap: token bucket in µs of allowed inference time
+    // (earned by the main loop, spent by the inference task)
+    std::atomic<int32_t> creditUs;
+    uint32_t lastCreditUpdate;
+    std::atomic<uint32_t> busyUsWindow;
+    uint32_t cpuWindowStart;
+
+    bool discoveryPublished;
+    SoundEventStats stats;
+    char lastEvent[SOUND_EVENTS_NAME_LEN];
+    float lastConfidence;
+    unsigned long lastEventTime;
+
+    static void inferenceTask(void* param);
+    bool loadModel();
+    void publishDiscovery();
+};
+
+class SoundEventStage : public AudioStage {
+public:
+    SoundEventStage();
+    bool process(AudioFrame& frame) override;
+};
+
+extern SoundEventDetector soundEvents;
+#endif
+
+#endif
@@ -4,6 +4,11 @@
 #include <LittleFS.h>
 #include <ArduinoJson.h>
 
+// Config, commands and presence are kept on flash as checksummed MessagePack
+// records (see flash_record.h), /config.bin next to /config.json. The JSON
+// files are only read when there is no valid record yet: the first boot
+// after an update, a fresh data/ image, or a damaged record. They are
+// imported once and not written again.
 class StorageManager {
 public:
     StorageManager();
@@ -21,6 +26,10 @@ public:
     bool loadPresence(JsonDocument& doc);
     bool savePresence(const JsonDocument& doc);
     
+    // What the dashboard last showed, painted at boot before HA answers
+    bool loadDashboard(JsonDocument& doc);
+    bool saveDashboard(const JsonDocument& doc);
+    
     // Generic file operations
     bool readFile(const char* path, String& content);
     bool writeFile(const char* path, const String& content);
@@ -31,11 +40,26 @@ public:
     void listFiles();
     size_t getTotalSpace();
     size_t getUsedSpace();
+    void getStatusJson(JsonObject obj);
     
 private:
     bool initialized;
+    
+    uint32_t recordLoads;
+    uint32_t recordSaves;
+    uint32_t jsonImports;
+    uint32_t rejectedRecords;       // Bad CRC, version or MessagePack
+    uint32_t bytesWritten;
+    uint32_t lastLoadMs;
+    uint32_t lastSaveMs;
+    uint32_t lastRecordBytes;       // Last record written...
+    uint32_t lastJsonBytes;         // ...and the same document as JSON text
+    
+    bool loadDocument(const char* path, JsonDocument& doc);
+    bool saveDocument(const char* path, const JsonDocument& doc);
+    bool readRecordFile(const char* path, JsonDocument& doc);
+    bool writeRecordFile(const char* path, const JsonDocument& doc);
     bool readJsonFile(const char* path, JsonDocument& doc);
-    bool writeJsonFile(const char* path, const JsonDocument& doc);
 };
 
 extern StorageManager storage;
@@ -0,0 +1,191 @@
+#ifndef TONE_DETECTOR_H
+#define TONE_DETECTOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "audio_pipeline.h"
+
+// DTMF and fixed-tone detection (gate intercoms, door chimes)
+// Fixed-point Goertzel filter bank with level / twist / purity validation
+// and block debouncing. The bank and detector have no Arduino dependency
+// (see scripts/tone_detector_bench.cpp); the pipeline stage, action mapping
+// and MQTT publishing are compiled only for ARDUINO.
+
+#define TONE_MAX_FREQS          16      // 8 DTMF + custom tones
+#define TONE_MAX_CUSTOM         8
+#define TONE_MAX_ACTIONS        16
+#define TONE_NAME_LEN           16
+#define TONE_SEQUENCE_LEN       16
+#define TONE_DEFAULT_BLOCK      320     // 20 ms at 16 kHz, 50 Hz bins
+#define TONE_COEFF_SHIFT        14      // Goertzel coefficients in Q14
+
+// ============================================
+// Goertzel filter bank
+// ============================================
+
+class GoertzelBank {
+public:
+    GoertzelBank();
+
+    bool begin(const float* freqs, int count, int blockSamples);
+
+    // Feed samples until the block completes; returns the number consumed.
+    // When *blockDone is set, powers are valid until the next feed().
+    size_t feed(const int16_t* samples, size_t count, bool* blockDone);
+
+    int getCount() const { return count; }
+    int getBlockSamples() const { return blockSamples; }
+
+    // Squared magnitude at frequency i, raw units ((A * N / 2)^2 for amplitude A)
+    int64_t getPower(int i) const { return power[i]; }
+
+    // Sum of x^2 over the block
+    int64_t getEnergy() const { return energy; }
+
+private:
+    int count;
+    int blockSamples;
+    int position;
+    int32_t coeff[TONE_MAX_FREQS];
+    int32_t s1[TONE_MAX_FREQS];
+    int32_t s2[TONE_MAX_FREQS];
+    int64_t power[TONE_MAX_FREQS];
+    int64_t energy;
+    int64_t energyAcc;
+};
+
+// ============================================
+// Detector (validation + debouncing)
+// ============================================
+
+struct ToneDetectorConfig {
+    bool dtmf;
+    int blockSamples;
+    float minLevelDbfs;         // Per-tone level (dBFS of a full-scale sine)
+    float maxTwistDb;           // High group above low group
+    float maxReverseTwistDb;    // Low group above high group
+    float minPeakRatioDb;       // Strongest tone over the next in its group
+    float minPurity;            // Share of block energy in the detected tones
+    uint8_t minBlocks;          // DTMF: consecutive blocks before a digit fires
+    uint16_t sequenceTimeoutBlocks;
+
+    struct Custom {
+        char name[TONE_NAME_LEN];
+        float freq;
+        uint8_t minBlocks;
+    } custom[TONE_MAX_CUSTOM];
+    int customCount;
+};
+
+struct ToneEvent {
+    char symbol[TONE_NAME_LEN];         // DTMF digit or custom tone name
+    char sequence[TONE_SEQUENCE_LEN + 1];   // DTMF digits so far (incl. this one)
+    bool dtmf;
+    float levelDbfs;
+};
+
+class ToneDetector {
+public:
+    ToneDetector();
+
+    static void defaultConfig(ToneDetectorConfig& config);
+    bool begin(const ToneDetectorConfig& config);
+
+    // Process samples; returns the number of events written (at most maxEvents)
+    int process(const int16_t* samples, size_t count, ToneEvent* events, int maxEvents);
+
+    void clearSequence();
+    const ToneDetectorConfig& getConfig() const { return cfg; }
+    const GoertzelBank& getBank() const { return bank; }
+    uint32_t getBlocks() const { return blocks; }
+
+private:
+    ToneDetectorConfig cfg;
+    GoertzelBank bank;
+    int firstCustom;
+    int64_t minPower;
+    uint32_t blocks;
+
+    // Debounce state: symbol seen in the last block and for how long
+    char dtmfCandidate;
+    uint8_t dtmfRun;
+    uint8_t dtmfGap;
+    bool dtmfLatched;
+    uint8_t customRun[TONE_MAX_CUSTOM];
+    bool customLatched[TONE_MAX_CUSTOM];
+
+    char sequence[TONE_SEQUENCE_LEN + 1];
+    uint32_t lastDigitBlock;
+
+    char classifyDtmf(float* levelDbfs);
+    bool validateCustom(int index, float* levelDbfs);
+    float toDbfs(int64_t power) const;
+    void fillEvent(ToneEvent& ev, const char* symbol, bool dtmf, float level);
+};
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+struct ToneStats {
+    uint32_t blocks;
+    uint32_t digits;
+    uint32_t tones;
+    uint32_t actions;
+    uint32_t droppedEvents;
+};
+
+class ToneMonitor {
+public:
+    ToneMonitor();
+
+    // Read config["tones"]
+    void begin(JsonDocument& config);
+
+    // Main loop: publishes events and runs mapped actions
+    void loop();
+
+    // Called from the pipeline stage for every captured frame
+    void processFrame(const AudioFrame& frame);
+
+    bool isEnabled() const { return enabled; }
+    void getStatusJson(JsonObject obj);
+
+private:
+    struct Action {
+        char key[TONE_SEQUENCE_LEN + 1];    // Digit, digit sequence or tone name
+        char action[64];                    // commands.json action string, run via actionExecutor
+    };
+
+    bool enabled;
+    ToneDetector detector;
+    Action actions[TONE_MAX_ACTIONS];
+    int actionCount;
+
+    // Events handed from the pipeline to loop()
+    ToneEvent pending[4];
+    volatile uint8_t pendingHead;
+    volatile uint8_t pendingTail;
+
+    bool discoveryPublished;
+    ToneStats stats;
+    ToneEvent lastEvent;
+    unsigned long lastEventTime;
+
+    void handleEvent(const ToneEvent& ev);
+    void publishDiscovery();
+};
+
+class ToneStage : public AudioStage {
+public:
+    ToneStage();
+    bool process(AudioFrame& frame) override;
+};
+
+extern ToneMonitor toneMonitor;
+#endif
+
+#endif
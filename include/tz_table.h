@@ -0,0 +1,33 @@
+#ifndef TZ_TABLE_H
+#define TZ_TABLE_H
+
+#include <stdint.h>
+
+// IANA zone name -> POSIX TZ string
+//
+// Home Assistant reports its zone by IANA name ("Europe/Riga"); newlib's
+// tzset() needs the POSIX rule ("EET-2EEST,M3.5.0/3,M10.5.0/4"). The mapping
+// used to be an if/else over six zones with UTC for everyone else. Now every
+// zone in tzdata is compiled in: src/tz_data.h, generated from the TZif
+// footers by scripts/generate_tz_table.py, sorted for binary search, with
+// each distinct rule stored once (about 13 KB of flash, no RAM).
+//
+// Portable; scripts/tz_table_test.cpp checks it against the host tzdata.
+
+struct TzEntry {
+    uint16_t name;              // Offset into the name pool
+    uint16_t rule;              // Offset into the rule pool
+};
+
+// POSIX TZ string for an IANA name (exact, case-sensitive), or nullptr
+const char* tzLookup(const char* zone);
+
+// tzdata release the table was generated from, e.g. "2025b"
+const char* tzDataVersion();
+
+// Table access for tests, in name order
+int tzCount();
+const char* tzZoneName(int i);
+const char* tzZoneRule(int i);
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef UTTERANCE_ARCHIVE_H
+#define UTTERANCE_ARCHIVE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "audio_metrics.h"
+
+// On-flash archive of recent utterances
+// Keeps the last N recordings sent to STT on LittleFS as IMA-ADPCM WAV (4:1)
+// plus a JSON sidecar with transcription, audio metrics and timings.
+// Entries are written append-only with increasing ids and the oldest are
+// deleted first. All flash I/O runs on a low-priority worker task so the
+// capture path only pays for one memcpy into PSRAM.
+
+#define ARCHIVE_DIR                 "/archive"
+#define ARCHIVE_DEFAULT_MAX_ENTRIES 20
+#define ARCHIVE_MAX_ENTRIES         64
+#define ARCHIVE_DEFAULT_MAX_KB      1024
+#define ARCHIVE_MIN_FREE_KB         256     // Never fill LittleFS beyond this
+#define ARCHIVE_WRITE_CHUNK         4096    // One flash sector per write
+
+struct ArchiveStats {
+    uint32_t submitted;
+    uint32_t written;
+    uint32_t droppedBusy;       // Previous utterance still being written
+    uint32_t failed;
+    uint32_t deleted;
+    uint64_t bytesWritten;      // Since boot (wear indicator)
+    uint32_t submitUsLast;      // Time spent on the caller's (main loop) side
+    uint32_t submitUsMax;
+    uint32_t writeMsLast;       // Encode + write time on the worker
+    uint32_t writeMsMax;
+    uint64_t writeMsTotal;
+};
+
+class UtteranceArchive {
+public:
+    UtteranceArchive();
+
+    // Read config["voice"]["archive"] and index existing entries
+    void begin(JsonDocument& config);
+
+    bool isEnabled() const { return enabled; }
+
+    // Queue an utterance for archiving (non-blocking, copies the samples)
+    bool submit(const int16_t* samples, size_t count, const UtteranceMetrics& metrics, uint32_t sttMs);
+
+    // Delete all entries (performed on the worker task)
+    void requestPurge();
+
+    // Entry list and statistics
+    void getListJson(JsonDocument& doc);
+
+    // Path of an entry's file, false if the id is unknown
+    bool getEntryPath(uint32_t id, bool metadata, char* path, size_t len);
+
+private:
+    struct Entry {
+        uint32_t id;
+        uint32_t bytes;
+    };
+
+    bool enabled;
+    uint16_t maxEntries;
+    uint32_t maxBytes;
+
+    // Index of stored entries, oldest first
+    Entry entries[ARCHIVE_MAX_ENTRIES];
+    int entryCount;
+    uint32_t nextId;
+    SemaphoreHandle_t mutex;
+
+    // Single pending job (PSRAM)
+    int16_t* jobSamples;
+    size_t jobCapacity;
+    size_t jobCount;
+    UtteranceMetrics jobMetrics;
+    uint32_t jobSttMs;
+    volatile bool jobBusy;
+    volatile bool purgeRequested;
+
+    TaskHandle_t workerTask;
+    ArchiveStats stats;
+
+    static void workerLoop(void* param);
+    void writeJob();
+    void purge();
+    void enforceRetention(uint32_t incomingBytes);
+    void removeOldest();
+    void loadIndex();
+    uint32_t usedBytes() const;
+    static void entryPath(uint32_t id, bool metadata, char* path, size_t len);
+};
+
+extern UtteranceArchive utteranceArchive;
+
+#endif
@@ -34,8 +34,9 @@ private:
     void handleGetConfig(AsyncWebServerRequest *request);
     void handlePostConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
     void handleGetCommands(AsyncWebServerRequest *request);
-    void handlePostCommand(AsyncWebServerRequest *request);
-    void handleDeleteCommand(AsyncWebServerRequest *request);
+    void handlePostCommand(AsyncWebServerRequest *request, uint8_t *data, size_t len);
+    void handleDeleteCommand(AsyncWebServerRequest *request, uint8_t *data, size_t len);
+    void handleRefreshEntities(AsyncWebServerRequest *request);
     void handleGetPresence(AsyncWebServerRequest *request);
     void handleHomeAssistantPersons(AsyncWebServerRequest *request, JsonDocument &config);
     void handlePostScene(AsyncWebServerRequest *request);
@@ -46,6 +47,13 @@ private:
     void handleHomeAssistantCalendar(AsyncWebServerRequest *request, JsonDocument& config);
     void handleSaveWeatherConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len);
     void handleSaveVoiceConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len);
+    void handleGetVoiceMetrics(AsyncWebServerRequest *request);
+    void handleGetArchive(AsyncWebServerRequest *request);
+    void handleDownloadArchive(AsyncWebServerRequest *request);
+    void handleGetCalibration(AsyncWebServerRequest *request);
+    void handleStartCalibration(AsyncWebServerRequest *request, uint8_t *data, size_t len);
+    void handleGetIntercom(AsyncWebServerRequest *request);
+    void handleStartIntercom(AsyncWebServerRequest *request, uint8_t *data, size_t len);
     void handleSaveHomeAssistantConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len);
     void handleCheckHomeAssistantConnection(AsyncWebServerRequest *request);
     void handleGetHomeAssistantPersons(AsyncWebServerRequest *request);
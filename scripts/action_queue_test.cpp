@@ -0,0 +1,171 @@
+// Host test for the action queue (dedup, fan-out, retries, latency)
+//
+// Drives ActionQueue with a simulated millisecond clock and a performer
+// whose failures are scripted per entity. It checks that a double trigger
+// is dropped within the dedup window but accepted after it, and that an
+// entity list is issued in one pass. A failing entity must be retried with
+// backoff without delaying the others, and give up after max attempts.
+// Also checks FIFO order, the queue-full case and that nothing allocates.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Iinclude scripts/action_queue_test.cpp src/action_executor.cpp src/command_engine.cpp -o action_queue_test
+//
+// Exits non-zero if any check fails.
+
+#include "action_executor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+struct Sim {
+    uint32_t now = 0;
+    char log[64][64];           // Entities performed, in order
+    uint32_t when[64];
+    int count = 0;
+    const char* failing = "";   // Target that fails...
+    int failuresLeft = 0;       // ...this many times
+
+    ActionOutcome outcomes[16];
+    char labels[16][ACTION_LABEL_LEN];
+    int completed = 0;
+};
+
+static bool perform(const CommandAction& a, void* ctx) {
+    Sim* sim = (Sim*)ctx;
+    if (sim->count < 64) {
+        snprintf(sim->log[sim->count], sizeof(sim->log[0]), "%s", a.target);
+        sim->when[sim->count] = sim->now;
+        sim->count++;
+    }
+    if (strcmp(a.target, sim->failing) == 0 && sim->failuresLeft != 0) {
+        sim->failuresLeft--;
+        return false;
+    }
+    return true;
+}
+
+static void complete(const ActionOutcome& o, void* ctx) {
+    Sim* sim = (Sim*)ctx;
+    if (sim->completed < 16) {
+        sim->outcomes[sim->completed] = o;
+        strncpy(sim->labels[sim->completed], o.label, ACTION_LABEL_LEN - 1);
+        sim->labels[sim->completed][ACTION_LABEL_LEN - 1] = '\0';
+        sim->completed++;
+    }
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) failures++;
+}
+
+static CommandAction action(const char* s) {
+    CommandAction a;
+    if (!parseCommandAction(s, a)) {
+        printf("FAIL bad action %s\n", s);
+        exit(1);
+    }
+    return a;
+}
+
+// Run the queue every 10 ms (one main-loop tick) until idle or `until`
+static void run(ActionQueue& q, Sim& sim, uint32_t until) {
+    while (sim.now <= until) {
+        q.process(sim.now);
+        if (q.getPending() == 0) break;
+        sim.now += 10;
+    }
+}
+
+int main() {
+    static Sim sim;
+    static ActionQueue q;
+    q.setPerformer(perform, &sim);
+    q.setCompletion(complete, &sim);
+    q.configure(1500, 4, 250);
+
+    CommandAction gate = action("homeassistant:cover.garage_door:open");
+    size_t before = allocations;
+
+    // Double trigger
+    check(q.submit(gate, "open the garage", sim.now) == ACTION_QUEUED, "first trigger queued");
+    sim.now += 300;
+    check(q.submit(gate, "open the garage", sim.now) == ACTION_DUPLICATE, "second trigger within 1.5 s dropped");
+    run(q, sim, sim.now + 1000);
+    check(sim.count == 1 && sim.completed == 1 && sim.outcomes[0].success, "gate opened once");
+    sim.now += 1500;
+    check(q.submit(gate, "open the garage", sim.now) == ACTION_QUEUED, "same action accepted after the window");
+    run(q, sim, sim.now + 1000);
+
+    // Fan-out with one entity failing twice
+    sim.count = 0;
+    sim.completed = 0;
+    sim.failing = "hallway";
+    sim.failuresLeft = 2;
+    uint32_t start = sim.now;
+    uint32_t id = 0;
+    check(q.submit(action("homeassistant:light.porch,hallway,kitchen:off"), "good night", sim.now, &id) ==
+          ACTION_QUEUED, "entity list queued");
+    check(q.submit(action("mqtt:entryhub/chime:ring"), "chime", sim.now) == ACTION_QUEUED, "second command queued");
+    q.process(sim.now);
+    check(sim.count == 4 && strcmp(sim.log[0], "porch") == 0 && strcmp(sim.log[1], "hallway") == 0 &&
+          strcmp(sim.log[2], "kitchen") == 0 && strcmp(sim.log[3], "entryhub/chime") == 0,
+          "all entities and the next command issued in one pass, in order");
+    check(sim.completed == 1 && strcmp(sim.labels[0], "chime") == 0, "chime not held up by the failing entity");
+    run(q, sim, sim.now + 5000);
+    check(sim.count == 6 && sim.when[4] - start == 250 && sim.when[5] - start == 750,
+          "hallway retried after 250 and 500 ms more");
+    check(sim.completed == 2 && sim.outcomes[1].id == id && sim.outcomes[1].success &&
+          sim.outcomes[1].actions == 3 && sim.outcomes[1].attempts == 5 && sim.outcomes[1].latencyMs == 750,
+          "group completes with latency of the slowest entity");
+
+    // Giving up
+    sim.count = 0;
+    sim.completed = 0;
+    sim.failing = "garage_door";
+    sim.failuresLeft = -1;
+    sim.now += 2000;
+    q.submit(gate, "open the garage", sim.now);
+    run(q, sim, sim.now + 10000);
+    check(sim.count == 4 && sim.completed == 1 && !sim.outcomes[0].success && sim.outcomes[0].failed == 1,
+          "failed after 4 attempts");
+
+    // Queue full
+    sim.failuresLeft = 0;
+    sim.now += 2000;
+    int queued = 0;
+    ActionStatus last = ACTION_QUEUED;
+    for (int i = 0; i < ACTION_MAX_GROUPS + 1; i++) {
+        char s[64];
+        snprintf(s, sizeof(s), "mqtt:entryhub/test/%d:x", i);
+        last = q.submit(action(s), "flood", sim.now);
+        queued += last == ACTION_QUEUED;
+    }
+    check(queued == ACTION_MAX_GROUPS && last == ACTION_REJECTED, "rejected when all command slots are busy");
+    run(q, sim, sim.now + 100);
+
+    const ActionStats& st = q.getStats();
+    printf("\nsubmitted %u, duplicates %u, rejected %u, completed %u, failed %u, retries %u, "
+           "latency avg %u ms, max %u ms\n",
+           st.submitted, st.duplicates, st.rejected, st.completed, st.failed, st.retries,
+           st.latencyCount ? (unsigned)(st.latencySumMs / st.latencyCount) : 0, st.maxLatencyMs);
+    check(allocations == before, "no allocations");
+
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,264 @@
+// Host test and benchmark for the audio pipeline
+//
+// Checks the pipeline framework with scripted stages: addStage() accepts a
+// chain only in format order (source first, at most
+// AUDIO_PIPELINE_MAX_STAGES), run() calls the stages in the order added,
+// counts a frame only if the source produced samples, and stops the chain at
+// a stage that returns false without timing the stages after it. Per-stage
+// budgets: a stage that runs past its budget counts an overrun, one within
+// it does not, and a budget of 0 never overruns.
+//
+// Then benchmarks the portable DSP stages (condition, agc, level,
+// features) on a synthesized voice-like signal and checks each against its
+// per-frame budget, and checks what they compute (DC removed, AGC gain
+// settles, peak/RMS and zero crossings of a known tone).
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Iinclude scripts/audio_pipeline_test.cpp src/audio_pipeline.cpp src/audio_stages.cpp -o audio_pipeline_test
+//
+// Exits non-zero if any check fails.
+
+#include "audio_pipeline.h"
+#include "audio_stages.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <random>
+#include <string>
+
+#define BENCH_FRAMES    2000
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// ============================================
+// Scripted stages
+// ============================================
+static std::string trace;       // Names of the stages run, in order
+
+class ScriptSource : public AudioStage {
+public:
+    ScriptSource() : AudioStage("source", AUDIO_FORMAT_NONE, AUDIO_FORMAT_PCM16, 0), produce(true) {}
+    bool process(AudioFrame& frame) override {
+        trace += "source ";
+        if (produce) {
+            for (int i = 0; i < AUDIO_FRAME_SAMPLES; i++) frame.samples[i] = (int16_t)i;
+            frame.count = AUDIO_FRAME_SAMPLES;
+        }
+        return true;
+    }
+    bool produce;
+};
+
+class ScriptStage : public AudioStage {
+public:
+    ScriptStage(const char* name, uint32_t budgetUs, uint32_t busyUs = 0, bool pass = true)
+        : AudioStage(name, AUDIO_FORMAT_PCM16, AUDIO_FORMAT_PCM16, budgetUs), busyUs(busyUs), pass(pass) {}
+    bool process(AudioFrame&) override {
+        trace += getName();
+        trace += " ";
+        uint32_t start = audioPipelineMicros();
+        while (audioPipelineMicros() - start < busyUs) {
+        }
+        return pass;
+    }
+    uint32_t busyUs;
+    bool pass;
+};
+
+class ScriptSink : public AudioStage {
+public:
+    ScriptSink() : AudioStage("sink", AUDIO_FORMAT_PCM16, AUDIO_FORMAT_NONE, 0) {}
+    bool process(AudioFrame&) override { trace += "sink "; return true; }
+};
+
+static AudioFrame frame;
+
+static void checkOrdering() {
+    AudioPipeline p;
+    check(!p.addStage(new ScriptStage("a", 0)), "pcm16 stage cannot be the source");
+    check(p.getStageCount() == 0, "rejected stage not added");
+    check(!p.run(frame), "empty pipeline runs nothing");
+
+    ScriptSource* source = new ScriptSource();
+    check(p.addStage(source), "source first");
+    check(p.addStage(new ScriptStage("a", 0)), "a after the source");
+    check(p.addStage(new ScriptStage("b", 0)), "b after a");
+    check(p.addStage(new ScriptSink()), "sink last");
+    check(!p.addStage(new ScriptStage("c", 0)), "nothing after a sink");
+    check(!p.addStage(nullptr), "null stage");
+    check(p.getStageCount() == 4, "four stages");
+    check(p.findStage("b") == p.getStage(2) && !p.findStage("c"), "findStage");
+
+    trace.clear();
+    check(p.run(frame), "frame runs");
+    check(trace == "source a b sink ", "stages in the order added");
+    check(frame.count == AUDIO_FRAME_SAMPLES && p.getFrameCount() == 1, "frame counted");
+    check(frame.seq == 0, "first frame seq 0");
+
+    source->produce = false;
+    trace.clear();
+    check(!p.run(frame), "no samples, no frame");
+    check(trace == "source ", "nothing after an empty source");
+    check(p.getFrameCount() == 1, "empty source not counted");
+    check(p.getStage(1)->getStats().frames == 1, "later stages not timed for an empty source");
+
+    AudioPipeline full;
+    full.addStage(new ScriptSource());
+    for (int i = 1; i < AUDIO_PIPELINE_MAX_STAGES; i++) {
+        full.addStage(new ScriptStage("x", 0));
+    }
+    check(full.getStageCount() == AUDIO_PIPELINE_MAX_STAGES, "pipeline full");
+    check(!full.addStage(new ScriptStage("y", 0)), "stage past the limit rejected");
+}
+
+static void checkShortCircuit() {
+    AudioPipeline p;
+    p.addStage(new ScriptSource());
+    p.addStage(new ScriptStage("a", 0));
+    ScriptStage* gate = new ScriptStage("gate", 0, 0, false);
+    p.addStage(gate);
+    p.addStage(new ScriptStage("b", 0));
+
+    trace.clear();
+    check(p.run(frame), "stopped chain still delivers the frame");
+    check(trace == "source a gate ", "stages after a failing stage skipped");
+    check(gate->getStats().frames == 1, "failing stage timed");
+    check(p.getStage(3)->getStats().frames == 0, "skipped stage not timed");
+    check(p.getFrameCount() == 1, "stopped frame counted");
+
+    gate->pass = true;
+    trace.clear();
+    p.run(frame);
+    check(trace == "source a gate b ", "chain complete again");
+    check(frame.seq == 1, "seq follows the frame count");
+}
+
+static void checkBudgets() {
+    AudioPipeline p;
+    p.addStage(new ScriptSource());
+    ScriptStage* slow = new ScriptStage("slow", 200, 1000);
+    ScriptStage* fast = new ScriptStage("fast", 5000, 0);
+    ScriptStage* unbounded = new ScriptStage("unbounded", 0, 500);
+    p.addStage(slow);
+    p.addStage(fast);
+    p.addStage(unbounded);
+
+    for (int i = 0; i < 5; i++) {
+        p.run(frame);
+    }
+    check(slow->getStats().frames == 5 && slow->getStats().overruns == 5, "over budget every frame");
+    check(slow->getStats().maxUs >= 1000 && slow->getStats().totalUs >= 5000, "slow stage timed");
+    check(fast->getStats().overruns == 0, "within budget");
+    check(unbounded->getStats().overruns == 0, "budget 0 never overruns");
+    check(p.getLastFrameUs() >= 1500 && p.getMaxFrameUs() >= p.getLastFrameUs(), "frame time covers the stages");
+
+    slow->setBudgetUs(100000);
+    p.run(frame);
+    check(slow->getStats().overruns == 5, "raised budget stops the overruns");
+
+    p.resetStats();
+    check(p.getFrameCount() == 0 && slow->getStats().frames == 0 && slow->getStats().overruns == 0, "resetStats");
+
+    AudioStage& s = *fast;
+    s.resetStats();
+    s.recordTiming(4000);
+    s.recordTiming(6000);
+    check(s.getStats().overruns == 1 && s.getStats().maxUs == 6000 && s.getStats().lastUs == 6000 &&
+          s.getStats().totalUs == 10000, "recordTiming accounting");
+}
+
+// ============================================
+// DSP stages
+// ============================================
+
+// 300 Hz tone plus a few harmonics, a DC offset and noise, scaled by level
+static void synthesize(AudioFrame& f, uint32_t n, float level, int16_t dc, std::mt19937& rng) {
+    std::normal_distribution<float> noise(0.0f, 80.0f);
+    for (int i = 0; i < AUDIO_FRAME_SAMPLES; i++) {
+        float t = (float)(n * AUDIO_FRAME_SAMPLES + i) / SAMPLE_RATE;
+        float v = sinf(2 * M_PI * 300 * t) + 0.4f * sinf(2 * M_PI * 900 * t) + 0.2f * sinf(2 * M_PI * 1500 * t);
+        f.samples[i] = (int16_t)fmaxf(-32768, fminf(32767, v * level + dc + noise(rng)));
+    }
+    f.count = AUDIO_FRAME_SAMPLES;
+}
+
+static void bench(AudioStage& stage, float level, int16_t dc) {
+    std::mt19937 rng(7);
+    stage.reset();
+    stage.resetStats();
+    for (uint32_t n = 0; n < BENCH_FRAMES; n++) {
+        synthesize(frame, n, level, dc, rng);
+        uint32_t start = audioPipelineMicros();
+        stage.process(frame);
+        stage.recordTiming(audioPipelineMicros() - start);
+    }
+    const AudioStageStats& st = stage.getStats();
+    double avg = (double)st.totalUs / st.frames;
+    printf("  %-10s avg %6.1f us  max %5u us  budget %4u us  overruns %u\n", stage.getName(), avg,
+           (unsigned)st.maxUs, (unsigned)stage.getBudgetUs(), (unsigned)st.overruns);
+    char what[64];
+    snprintf(what, sizeof(what), "%s average within budget", stage.getName());
+    check(avg < stage.getBudgetUs(), what);
+}
+
+static void checkStages() {
+    printf("Per-stage cost, %d frames of %d samples (%u us each):\n", BENCH_FRAMES, AUDIO_FRAME_SAMPLES,
+           (unsigned)AUDIO_FRAME_PERIOD_US);
+    DcRemovalStage condition;
+    AgcStage agc;
+    LevelStage level;
+    FeatureStage features;
+    bench(condition, 3000, 2000);
+    bench(agc, 1000, 0);
+    bench(level, 3000, 0);
+    bench(features, 3000, 0);
+
+    // DC offset gone after the filter settles
+    std::mt19937 rng(1);
+    condition.reset();
+    for (uint32_t n = 0; n < 20; n++) {
+        synthesize(frame, n, 3000, 4000, rng);
+        condition.process(frame);
+    }
+    double mean = 0;
+    for (int i = 0; i < AUDIO_FRAME_SAMPLES; i++) mean += frame.samples[i];
+    mean /= AUDIO_FRAME_SAMPLES;
+    check(fabs(mean) < 200, "condition removes DC");
+
+    // Quiet speech is raised towards the target, not past the gain limit
+    agc.reset();
+    for (uint32_t n = 0; n < 200; n++) {
+        synthesize(frame, n, 1000, 0, rng);
+        agc.process(frame);
+    }
+    check(agc.getGain() > 1.5f && agc.getGain() <= 8.0f, "agc raises quiet input within its limit");
+
+    // Pure 1 kHz tone at amplitude 10000: peak, RMS and 2 crossings per cycle
+    for (int i = 0; i < AUDIO_FRAME_SAMPLES; i++) {
+        frame.samples[i] = (int16_t)(10000 * sinf(2 * M_PI * 1000 * (i + 0.5f) / SAMPLE_RATE));
+    }
+    frame.count = AUDIO_FRAME_SAMPLES;
+    level.process(frame);
+    features.process(frame);
+    check(frame.peak >= 9800 && frame.peak <= 10000, "level peak");  // Samples straddle the crest
+    check(abs(frame.rms - 7071) < 150, "level RMS");
+    int expected = 2 * 1000 * AUDIO_FRAME_SAMPLES / SAMPLE_RATE;
+    check(abs(frame.zeroCrossings - expected) <= 2, "zero crossings");
+}
+
+int main() {
+    checkOrdering();
+    checkShortCircuit();
+    checkBudgets();
+    checkStages();
+
+    printf("\n%s (%d failure%s)\n", failures ? "FAILED" : "OK", failures, failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,250 @@
+// Host test for the boot dependency graph
+//
+// Checks add() (dependencies must be added first, full table, no run
+// function), that next() hands out a task only once everything it depends
+// on is done, in the order added and per side (main loop or worker), that
+// a failed task still releases its dependents, and the running-task names
+// and slowest task the boot profiler records.
+//
+// Then simulates the device's boot graph with a main loop and two workers
+// on a virtual clock: every task must run once and after its dependencies,
+// and the dashboard must be up at the same time whether WiFi takes 300 ms
+// or 20 s. Prints the timeline and compares the total with the serial sum.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Iinclude scripts/boot_graph_test.cpp src/boot_sequencer.cpp -o boot_graph_test
+//
+// Exits non-zero if any check fails.
+
+#include "boot_sequencer.h"
+#include <stdio.h>
+#include <string.h>
+
+#define WORKERS 2
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static bool runOk(void*) { return true; }
+
+static BootTaskSpec spec(const char* name, BootWhere where) {
+    BootTaskSpec s = { name, where, runOk, nullptr, nullptr };
+    return s;
+}
+
+// ============================================
+// Graph rules
+// ============================================
+static void checkRules() {
+    BootGraph g;
+    int a = g.add(spec("a", BOOT_MAIN), 0);
+    check(a == 0, "first task gets id 0");
+    check(g.add(spec("self", BOOT_MAIN), BOOT_DEP(1)) == -1, "depending on itself rejected");
+    check(g.add(spec("later", BOOT_MAIN), BOOT_DEP(5)) == -1, "depending on a later task rejected");
+    BootTaskSpec none = spec("none", BOOT_MAIN);
+    none.run = nullptr;
+    check(g.add(none, 0) == -1, "task without run rejected");
+
+    int b = g.add(spec("b", BOOT_WORKER), BOOT_DEP(a));
+    int c = g.add(spec("c", BOOT_MAIN), BOOT_DEP(a));
+    int d = g.add(spec("d", BOOT_MAIN), BOOT_DEP(b) | BOOT_DEP(c));
+    int e = g.add(spec("e", BOOT_MAIN), 0);
+
+    check(g.next(BOOT_WORKER) == -1, "worker task waits for its dependency");
+    check(g.next(BOOT_MAIN) == a, "main tasks in the order added");
+    check(g.next(BOOT_MAIN) == e, "independent task does not wait behind a running one");
+    check(g.next(BOOT_MAIN) == -1, "nothing else ready");
+    g.finish(a, true, 0, 10);
+    check(g.next(BOOT_WORKER) == b, "worker task ready after its dependency");
+    check(g.next(BOOT_MAIN) == c, "main task ready after its dependency");
+    char running[16];
+    g.describeRunning(running, sizeof(running));
+    check(strcmp(running, "b+c+e") == 0, "running tasks named in id order");
+    g.describeRunning(running, 4);
+    check(strcmp(running, "b+c") == 0, "only whole names when cut");
+    g.finish(c, true, 10, 20);
+    check(g.next(BOOT_MAIN) == -1, "d waits for the worker task");
+    g.finish(b, false, 10, 30);
+    check(g.isDone(b) && !g.getOk(b), "failed task is done");
+    check(g.next(BOOT_MAIN) == d, "failed dependency still releases d");
+    g.finish(d, true, 30, 40);
+    check(!g.isFinished(), "e still running");
+    check(g.getRunning() == 1, "one running");
+    g.finish(e, true, 0, 50);
+    check(g.isFinished(), "all done");
+    check(g.getSlowest() == e, "slowest task");
+    g.describeRunning(running, sizeof(running));
+    check(running[0] == '\0', "nothing running");
+    g.finish(e, true, 0, 60);
+    check(g.getEndUs(e) == 50, "finishing twice is ignored");
+
+    BootGraph full;
+    for (int i = 0; i < BOOT_MAX_TASKS; i++) {
+        full.add(spec("t", BOOT_MAIN), 0);
+    }
+    check(full.add(spec("t", BOOT_MAIN), 0) == -1, "full table rejected");
+}
+
+// ============================================
+// Simulated device boot
+// ============================================
+struct SimTask {
+    const char* name;
+    BootWhere where;
+    uint32_t ms;
+    const char* deps[6];
+};
+
+// The shape of setupSystem()'s graph, with rough device durations
+static const SimTask BOOT[] = {
+    { "led", BOOT_MAIN, 5, {} },
+    { "storage", BOOT_MAIN, 60, {} },
+    { "config", BOOT_MAIN, 40, { "storage", "led" } },
+    { "display", BOOT_MAIN, 350, { "config" } },
+    { "dashboard", BOOT_MAIN, 80, { "display" } },
+    { "wifi", BOOT_WORKER, 0, { "config" } },         // Duration per run
+    { "ntp", BOOT_WORKER, 800, { "wifi" } },
+    { "audio", BOOT_MAIN, 250, { "dashboard" } },
+    { "mqtt", BOOT_MAIN, 120, { "wifi", "dashboard" } },
+    { "web", BOOT_MAIN, 30, { "wifi", "dashboard" } },
+    { "ota", BOOT_MAIN, 10, { "wifi" } },
+    { "ha", BOOT_MAIN, 40, { "mqtt" } },
+    { "services", BOOT_MAIN, 150, { "config", "audio", "wifi", "dashboard" } },
+    { "notifications", BOOT_MAIN, 5, { "config" } },
+    { "probe", BOOT_WORKER, 1500, { "services" } },
+    { "jobs", BOOT_MAIN, 5, { "services", "mqtt", "ntp" } },
+};
+#define BOOT_COUNT (int)(sizeof(BOOT) / sizeof(BOOT[0]))
+
+static int findTask(const char* name) {
+    for (int i = 0; i < BOOT_COUNT; i++) {
+        if (strcmp(BOOT[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+struct SimResult {
+    uint32_t dashboardMs;
+    uint32_t totalMs;
+    uint32_t serialMs;
+};
+
+static SimResult simulate(uint32_t wifiMs, bool print) {
+    BootGraph g;
+    for (int i = 0; i < BOOT_COUNT; i++) {
+        uint32_t deps = 0;
+        for (const char* d : BOOT[i].deps) {
+            if (d) deps |= BOOT_DEP(findTask(d));
+        }
+        check(g.add(spec(BOOT[i].name, BOOT[i].where), deps) == i, "boot task added");
+    }
+    auto duration = [&](int id) { return id == findTask("wifi") ? wifiMs : BOOT[id].ms; };
+
+    // Virtual clock in ms; one main loop, WORKERS workers, a queue for the rest
+    uint32_t now = 0;
+    int mainTask = -1;
+    uint32_t mainEnd = 0, mainStart = 0;
+    int workerTask[WORKERS];
+    uint32_t workerStart[WORKERS], workerEnd[WORKERS];
+    for (int w = 0; w < WORKERS; w++) workerTask[w] = -1;
+    int queue[BOOT_MAX_TASKS];
+    int queued = 0;
+    int runs[BOOT_MAX_TASKS] = {};
+
+    while (!g.isFinished()) {
+        if (mainTask >= 0 && mainEnd <= now) {
+            g.finish(mainTask, true, mainStart * 1000, mainEnd * 1000);
+            mainTask = -1;
+        }
+        for (int w = 0; w < WORKERS; w++) {
+            if (workerTask[w] >= 0 && workerEnd[w] <= now) {
+                g.finish(workerTask[w], true, workerStart[w] * 1000, workerEnd[w] * 1000);
+                workerTask[w] = -1;
+            }
+        }
+        if (g.isFinished()) {
+            break;
+        }
+        int id;
+        while ((id = g.next(BOOT_WORKER)) >= 0) {
+            queue[queued++] = id;
+            runs[id]++;
+        }
+        for (int w = 0; w < WORKERS && queued > 0; w++) {
+            if (workerTask[w] < 0) {
+                workerTask[w] = queue[0];
+                memmove(queue, queue + 1, --queued * sizeof(int));
+                workerStart[w] = now;
+                workerEnd[w] = now + duration(workerTask[w]);
+            }
+        }
+        if (mainTask < 0 && (id = g.next(BOOT_MAIN)) >= 0) {
+            runs[id]++;
+            mainTask = id;
+            mainStart = now;
+            mainEnd = now + duration(id);
+            continue;           // A zero-length task finishes at the same time
+        }
+
+        uint32_t next = UINT32_MAX;
+        if (mainTask >= 0) next = mainEnd;
+        for (int w = 0; w < WORKERS; w++) {
+            if (workerTask[w] >= 0 && workerEnd[w] < next) next = workerEnd[w];
+        }
+        if (next == UINT32_MAX) {
+            check(false, "boot graph stalled");
+            break;
+        }
+        now = next;
+    }
+
+    SimResult r = { 0, now, 0 };
+    for (int i = 0; i < BOOT_COUNT; i++) {
+        r.serialMs += duration(i);
+        if (runs[i] != 1) {
+            printf("FAIL: %s ran %d times\n", BOOT[i].name, runs[i]);
+            failures++;
+        }
+        for (int d = 0; d < i; d++) {
+            if ((g.getDeps(i) & BOOT_DEP(d)) && g.getStartUs(i) < g.getEndUs(d)) {
+                printf("FAIL: %s started before %s finished\n", BOOT[i].name, BOOT[d].name);
+                failures++;
+            }
+        }
+    }
+    r.dashboardMs = g.getEndUs(findTask("dashboard")) / 1000;
+
+    if (print) {
+        printf("\nWiFi %u ms:\n", (unsigned)wifiMs);
+        for (int i = 0; i < BOOT_COUNT; i++) {
+            printf("  %-14s %-6s %6u .. %6u ms\n", BOOT[i].name, BOOT[i].where == BOOT_WORKER ? "worker" : "main",
+                   (unsigned)(g.getStartUs(i) / 1000), (unsigned)(g.getEndUs(i) / 1000));
+        }
+        printf("  dashboard up at %u ms, boot done at %u ms, serial sum %u ms\n", (unsigned)r.dashboardMs,
+               (unsigned)r.totalMs, (unsigned)r.serialMs);
+    }
+    return r;
+}
+
+static void checkBoot() {
+    SimResult fast = simulate(300, true);
+    SimResult slow = simulate(20000, true);
+    check(fast.dashboardMs == slow.dashboardMs, "dashboard does not wait for WiFi");
+    check(fast.dashboardMs < 2000, "dashboard within 2 s");
+    check(fast.totalMs < fast.serialMs, "parallel boot shorter than serial");
+    check(slow.totalMs < slow.serialMs, "parallel boot shorter than serial with slow WiFi");
+}
+
+int main() {
+    checkRules();
+    checkBoot();
+
+    printf("\n%s (%d failure%s)\n", failures ? "FAILED" : "OK", failures, failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,193 @@
+// Host test for the boot profiler's trace and history
+//
+// Checks the RTC trace (a fresh trace is valid, any changed byte or a
+// missing terminator makes it invalid, long stages are cut), the record a
+// boot starts from it (power-on and garbage RTC memory are not traced, a
+// watchdog restart keeps the stage, note and uptime), the history ring
+// (newest first, wraps at BOOT_HISTORY_LEN, sequence numbers keep counting)
+// and its NVS image (round trip, CRC, version and size are checked).
+//
+// Then replays a unit that hits the WiFi watchdog twice during boot and
+// browns out once after it, and checks what the history says.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Iinclude scripts/boot_profiler_test.cpp src/boot_profiler.cpp src/flash_record.cpp -o boot_profiler_test
+//
+// Exits non-zero if any check fails.
+
+#include "boot_profiler.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// ============================================
+// Trace and records
+// ============================================
+static void checkTrace() {
+    check(strcmp(bootResetName(BOOT_RESET_BROWNOUT), "brownout") == 0, "brownout named");
+    check(strcmp(bootResetName(BOOT_RESET_TASK_WDT), "task_watchdog") == 0, "task watchdog named");
+    check(strcmp(bootResetName(200), "unknown") == 0, "out of range is unknown");
+
+    BootTrace t;
+    memset(&t, 0xA5, sizeof(t));
+    check(!bootTraceValid(t), "garbage RTC memory is not a trace");
+    bootTraceReset(t);
+    check(bootTraceValid(t), "fresh trace valid");
+    bootTraceSetStage(t, "wifi+display");
+    bootTraceSetUptime(t, 40);
+    check(bootTraceValid(t) && strcmp(t.stage, "wifi+display") == 0, "stage set");
+
+    BootTrace flipped = t;
+    flipped.uptimeS ^= 1;
+    check(!bootTraceValid(flipped), "changed uptime detected");
+    flipped = t;
+    flipped.stage[0] = 'W';
+    check(!bootTraceValid(flipped), "changed stage detected");
+
+    char longStage[64];
+    memset(longStage, 'x', sizeof(longStage) - 1);
+    longStage[sizeof(longStage) - 1] = '\0';
+    bootTraceSetStage(t, longStage);
+    check(bootTraceValid(t) && strlen(t.stage) == BOOT_STAGE_LEN - 1, "long stage cut");
+
+    bootTraceSetStage(t, "ntp");
+    bootTraceSetNote(t, "wifi_watchdog");
+    BootRecord r;
+    bootRecordStart(r, BOOT_RESET_SW, t, "1.0.0");
+    check(r.traced && strcmp(r.lastStage, "ntp") == 0 && strcmp(r.note, "wifi_watchdog") == 0 &&
+          r.prevUptimeS == 40, "software restart keeps the trace");
+    check(r.dashboardUs == 0 && r.finishedUs == 0 && strcmp(r.version, "1.0.0") == 0, "new record");
+
+    bootRecordStart(r, BOOT_RESET_POWERON, t, "1.0.0");
+    check(!r.traced && r.lastStage[0] == '\0' && r.note[0] == '\0', "power-on is not traced");
+
+    memset(&t, 0, sizeof(t));
+    bootRecordStart(r, BOOT_RESET_PANIC, t, "1.0.0");
+    check(!r.traced && r.resetReason == BOOT_RESET_PANIC, "panic without a trace keeps the reason");
+}
+
+// ============================================
+// History and its NVS image
+// ============================================
+static BootRecord record(uint8_t reason, uint32_t finishedUs) {
+    BootTrace none;
+    memset(&none, 0, sizeof(none));
+    BootRecord r;
+    bootRecordStart(r, reason, none, "1.0.0");
+    r.finishedUs = finishedUs;
+    return r;
+}
+
+static void checkHistory() {
+    BootHistory h;
+    check(h.getCount() == 0, "empty history");
+    for (uint32_t i = 1; i <= BOOT_HISTORY_LEN + 3; i++) {
+        h.add(record(BOOT_RESET_SW, i * 1000));
+    }
+    check(h.getCount() == BOOT_HISTORY_LEN, "history capped");
+    check(h.get(0).seq == BOOT_HISTORY_LEN + 3 && h.get(0).finishedUs == (BOOT_HISTORY_LEN + 3) * 1000,
+          "newest first");
+    check(h.get(BOOT_HISTORY_LEN - 1).seq == 4, "oldest kept");
+    h.newest().dashboardUs = 123;
+    check(h.get(0).dashboardUs == 123, "newest() updates the latest record");
+
+    std::vector<uint8_t> image(h.serializedSize());
+    check(h.serialize(image.data(), image.size() - 1) == 0, "short buffer refused");
+    check(h.serialize(image.data(), image.size()) == image.size(), "serialized");
+
+    BootHistory back;
+    check(back.deserialize(image.data(), image.size()), "round trip");
+    check(back.getCount() == h.getCount() && back.get(0).seq == h.get(0).seq &&
+          back.get(0).dashboardUs == 123 && back.get(BOOT_HISTORY_LEN - 1).seq == 4, "same records");
+    check(back.add(record(BOOT_RESET_SW, 0)).seq == BOOT_HISTORY_LEN + 4, "sequence continues after reload");
+
+    std::vector<uint8_t> bad = image;
+    bad[bad.size() / 2] ^= 0x10;
+    check(!back.deserialize(bad.data(), bad.size()) && back.getCount() == 0, "corrupt image rejected");
+    bad = image;
+    bad[0] ^= 1;
+    check(!back.deserialize(bad.data(), bad.size()), "other version rejected");
+    check(!back.deserialize(image.data(), image.size() - 4), "other size rejected");
+}
+
+// ============================================
+// Replayed reboots
+// ============================================
+struct Run {
+    uint8_t resetReason;        // Of the reset that started this run
+    const char* stopStage;      // Where it was when it ended
+    const char* note;           // Restart reason, or nullptr
+    uint32_t uptimeS;
+    bool finished;
+};
+
+static void checkReplay() {
+    // Stuck in WiFi twice, third boot finishes, then a brownout while running
+    static const Run RUNS[] = {
+        { BOOT_RESET_POWERON, "wifi", "wifi_portal", 180, false },
+        { BOOT_RESET_SW, "wifi", "wifi_portal", 181, false },
+        { BOOT_RESET_SW, BOOT_STAGE_RUNNING, nullptr, 7200, true },
+        { BOOT_RESET_BROWNOUT, "setup", nullptr, 0, false },
+    };
+    BootTrace rtc;
+    memset(&rtc, 0x5A, sizeof(rtc));        // Power-on contents
+    std::vector<uint8_t> nvs;
+
+    for (const Run& run : RUNS) {
+        BootHistory h;
+        if (!nvs.empty()) {
+            check(h.deserialize(nvs.data(), nvs.size()), "history reloaded");
+        }
+        BootRecord current;
+        bootRecordStart(current, run.resetReason, rtc, "1.0.0");
+        bootTraceReset(rtc);
+        h.add(current);
+        bootTraceSetStage(rtc, run.stopStage);
+        if (run.finished) {
+            h.newest().dashboardUs = 540000;
+            h.newest().finishedUs = 3200000;
+        }
+        if (run.note) {
+            bootTraceSetNote(rtc, run.note);
+        }
+        bootTraceSetUptime(rtc, run.uptimeS);
+        nvs.resize(h.serializedSize());
+        h.serialize(nvs.data(), nvs.size());
+    }
+
+    BootHistory h;
+    check(h.deserialize(nvs.data(), nvs.size()) && h.getCount() == 4, "four boots recorded");
+    printf("Replayed history, newest first:\n");
+    for (int i = 0; i < h.getCount(); i++) {
+        const BootRecord& r = h.get(i);
+        printf("  #%u %-9s previous: %-8s %-12s %5u s   finished %u ms\n", (unsigned)r.seq,
+               bootResetName(r.resetReason), r.traced ? r.lastStage : "-", r.note[0] ? r.note : "-",
+               (unsigned)r.prevUptimeS, (unsigned)(r.finishedUs / 1000));
+    }
+    check(!h.get(3).traced, "first boot after power-on has no previous run");
+    check(h.get(2).traced && strcmp(h.get(2).lastStage, "wifi") == 0 && strcmp(h.get(2).note, "wifi_portal") == 0,
+          "second boot: previous stuck in wifi, portal restart");
+    check(h.get(2).finishedUs == 0, "stuck boot never finished");
+    check(h.get(1).finishedUs == 3200000, "third boot finished");
+    check(h.get(0).resetReason == BOOT_RESET_BROWNOUT && h.get(0).traced &&
+          strcmp(h.get(0).lastStage, BOOT_STAGE_RUNNING) == 0 && h.get(0).note[0] == '\0' &&
+          h.get(0).prevUptimeS == 7200, "brownout while running, no restart note");
+}
+
+int main() {
+    checkTrace();
+    checkHistory();
+    checkReplay();
+
+    printf("\n%s (%d failure%s)\n", failures ? "FAILED" : "OK", failures, failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}
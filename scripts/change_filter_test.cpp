@@ -0,0 +1,127 @@
+// Host test for the display change filter
+//
+// Checks that only a changed hash gets through, per key, and that field
+// boundaries matter to the hash. A formatted value that rounds to the same
+// text must count as unchanged. invalidate() must let the next update
+// through. Suppressed updates are counted per key and per hour, including
+// an idle gap of more than an hour and the millis() wrap. Also checks the
+// key-table-full fallback and that nothing allocates.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Iinclude scripts/change_filter_test.cpp src/change_filter.cpp -o change_filter_test
+//
+// Exits non-zero if any check fails.
+
+#include "change_filter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static uint32_t weatherHash(float temp, const char* condition) {
+    char text[16];
+    snprintf(text, sizeof(text), "%.1f°", temp);
+    ChangeHash h;
+    h.add(text).add(condition);
+    return h.value();
+}
+
+static uint32_t personHash(const char* name, bool present) {
+    ChangeHash h;
+    h.add(name).add(present).add((int32_t)0x00FF00);
+    return h.value();
+}
+
+static void testHash() {
+    ChangeHash a, b;
+    a.add("ab").add("c");
+    b.add("a").add("bc");
+    check(a.value() != b.value(), "field boundaries are hashed");
+    check(personHash("Anna", true) != personHash("Anna", false), "presence flag is hashed");
+    check(weatherHash(21.04f, "sunny") == weatherHash(21.02f, "sunny"), "same shown text, same hash");
+    check(weatherHash(21.04f, "sunny") != weatherHash(21.06f, "sunny"), "different shown text");
+}
+
+static void testFilter() {
+    ChangeFilter f;
+    uint32_t t = 1000;
+    check(f.update("weather", weatherHash(20.0f, "rainy"), t), "first update goes through");
+    check(!f.update("weather", weatherHash(20.0f, "rainy"), t + 30000), "repeat suppressed");
+    check(!f.update("weather", weatherHash(20.01f, "rainy"), t + 60000), "rounds to the same text");
+    check(f.update("weather", weatherHash(20.5f, "rainy"), t + 90000), "change goes through");
+
+    check(f.update("person0", personHash("Anna", true), t), "other key tracked separately");
+    check(!f.update("person0", personHash("Anna", true), t), "person repeat suppressed");
+    check(f.update("person1", personHash("Anna", true), t), "same value, different key");
+
+    f.invalidate("person0");
+    check(f.update("person0", personHash("Anna", true), t), "invalidated key goes through");
+    f.invalidateAll();
+    check(f.update("weather", weatherHash(20.5f, "rainy"), t), "invalidateAll");
+
+    const ChangeStats& s = f.getStats(t + 100000);
+    check(s.suppressed == 3 && s.changes == 6, "totals");
+    check(f.getCount() == 3 && strcmp(f.getKey(0), "weather") == 0, "keys in first-use order");
+    check(f.getKeyStats(0).suppressed == 2 && f.getKeyStats(1).suppressed == 1, "per-key counts");
+}
+
+static void testHours() {
+    ChangeFilter f;
+    uint32_t t = 0xFFFFFFFFu - CHANGE_HOUR_MS / 2;      // Wraps within the first hour
+    f.update("gate", 1, t);
+    for (int i = 1; i <= 120; i++) {
+        f.update("gate", 1, t + i * 30000);           // Every 30 s for an hour
+    }
+    const ChangeStats& s = f.getStats(t + 120 * 30000 + 1);
+    check(s.suppressedLastHour == 119 && s.suppressedThisHour == 1, "rolls over at the hour across the wrap");
+
+    uint32_t later = t + 120 * 30000 + 3 * CHANGE_HOUR_MS;
+    f.update("gate", 1, later);
+    const ChangeStats& idle = f.getStats(later);
+    check(idle.suppressedLastHour == 0 && idle.suppressedThisHour == 1, "idle hours leave nothing behind");
+    check(idle.suppressed == 121, "total keeps counting");
+}
+
+static void testFull() {
+    ChangeFilter f;
+    char key[CHANGE_KEY_LEN];
+    for (int i = 0; i < CHANGE_MAX_KEYS; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        f.update(key, 7, 0);
+    }
+    check(f.update("extra", 7, 0) && f.update("extra", 7, 0), "untracked key never suppressed");
+    check(f.getCount() == CHANGE_MAX_KEYS, "table full");
+}
+
+int main() {
+    size_t before = allocations;
+    testHash();
+    testFilter();
+    testHours();
+    testFull();
+    check(allocations == before, "no allocation");
+
+    printf("%s (%d failure%s)\n", failures ? "FAILED" : "OK", failures, failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}
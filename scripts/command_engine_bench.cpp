@@ -0,0 +1,173 @@
+// Host test and benchmark for the voice command engine
+//
+// Generates a 500-command set ("turn on the kitchen light", "close the
+// office blind", ...), compiles it into CommandMatcher and matches every
+// phrase wrapped in typical ASR filler ("hey can you ... please"), plus
+// sentences that must not match. The same queries go through a
+// generalization of the old processVoiceCommand() chain: commands tried in
+// order, each one firing when all of its words occur in the text
+// (String::indexOf), as the hard-coded "light" + "on" branches did.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Iinclude scripts/command_engine_bench.cpp src/command_engine.cpp -o command_engine_bench
+//
+// Exits non-zero if the engine mismatches any query.
+
+#include "command_engine.h"
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+static const char* VERBS[] = {
+    "turn on", "turn off", "open", "close", "dim", "brighten", "start", "stop", "lock", "unlock"
+};
+static const char* DEVICES[] = {
+    "light", "lamp", "fan", "blind", "heater", "tv", "speaker", "door", "window", "curtain"
+};
+static const char* ROOMS[] = {
+    "living room", "kitchen", "bedroom", "office", "garage", "hallway", "bathroom", "porch",
+    "attic", "basement", "dining room", "guest room", "nursery", "laundry", "patio", "study"
+};
+
+struct Command {
+    std::string phrase;
+    std::string action;
+};
+
+static std::vector<Command> buildCommands(size_t count) {
+    std::vector<Command> out;
+    for (const char* room : ROOMS) {
+        for (const char* device : DEVICES) {
+            for (const char* verb : VERBS) {
+                if (out.size() == count) {
+                    return out;
+                }
+                std::string object = std::string(room) + "_" + device;
+                for (char& c : object) {
+                    if (c == ' ') c = '_';
+                }
+                out.push_back({ std::string(verb) + " the " + room + " " + device,
+                                "homeassistant:switch." + object + ":" + verb });
+            }
+        }
+    }
+    return out;
+}
+
+// The old approach, generalized: first command whose words all occur in the text
+static int oldChain(const std::vector<std::vector<std::string>>& keywords, const std::string& text) {
+    for (size_t i = 0; i < keywords.size(); i++) {
+        bool all = true;
+        for (const std::string& k : keywords[i]) {
+            if (text.find(k) == std::string::npos) {
+                all = false;
+                break;
+            }
+        }
+        if (all) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static std::string lower(std::string s) {
+    for (char& c : s) c = (char)tolower((unsigned char)c);
+    return s;
+}
+
+int main() {
+    const size_t COMMANDS = 500;
+    std::vector<Command> commands = buildCommands(COMMANDS);
+
+    // Compile
+    auto t0 = std::chrono::steady_clock::now();
+    CommandMatcher matcher;
+    for (size_t i = 0; i < commands.size(); i++) {
+        CommandAction action;
+        if (!parseCommandAction(commands[i].action.c_str(), action)) {
+            printf("FAIL invalid action %s\n", commands[i].action.c_str());
+            return 1;
+        }
+        matcher.addPhrase(commands[i].phrase.c_str(), (int)i);
+    }
+    matcher.compile();
+    double compileUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+
+    std::vector<std::vector<std::string>> keywords(commands.size());
+    for (size_t i = 0; i < commands.size(); i++) {
+        CommandMatcher::tokenize(commands[i].phrase.c_str(), keywords[i]);
+    }
+
+    // Queries: every command with filler, plus negatives (expected -1)
+    static const char* PREFIX[] = { "", "hey ", "can you ", "please ", "could you please " };
+    static const char* SUFFIX[] = { "", " please", " now", " thanks", "" };
+    std::vector<std::pair<std::string, int>> queries;
+    for (size_t i = 0; i < commands.size(); i++) {
+        queries.push_back({ std::string(PREFIX[i % 5]) + commands[i].phrase + SUFFIX[(i / 5) % 5], (int)i });
+    }
+    static const char* NEGATIVE[] = {
+        "what is the weather like tomorrow",
+        "tell me a joke",
+        "is the kitchen light on",
+        "who is at the front door",
+        "set a timer for ten minutes",
+        "play some music in the office"
+    };
+    for (const char* n : NEGATIVE) {
+        queries.push_back({ n, -1 });
+    }
+
+    // Correctness
+    int engineErrors = 0;
+    int chainErrors = 0;
+    for (const auto& q : queries) {
+        CommandMatch m;
+        int got = matcher.match(q.first.c_str(), m) ? m.command : -1;
+        if (got != q.second) {
+            engineErrors++;
+            printf("FAIL engine '%s' -> %d, expected %d\n", q.first.c_str(), got, q.second);
+        }
+        if (oldChain(keywords, lower(q.first)) != q.second) {
+            chainErrors++;
+        }
+    }
+
+    // Throughput
+    const int ROUNDS = 20;
+    volatile int sink = 0;
+
+    auto t1 = std::chrono::steady_clock::now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (const auto& q : queries) {
+            CommandMatch m;
+            matcher.match(q.first.c_str(), m);
+            sink = sink + m.command;
+        }
+    }
+    double engineUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t1).count();
+
+    auto t2 = std::chrono::steady_clock::now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (const auto& q : queries) {
+            // The old code lowercased a String copy before the chain
+            sink = sink + oldChain(keywords, lower(q.first));
+        }
+    }
+    double chainUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t2).count();
+
+    size_t n = queries.size() * ROUNDS;
+    printf("Commands: %zu, phrases: %zu, states: %zu, vocabulary: %zu, memory: %zu bytes, compile: %.0f us\n",
+           commands.size(), matcher.getPhraseCount(), matcher.getStateCount(),
+           matcher.getVocabularySize(), matcher.getMemoryBytes(), compileUs);
+    printf("Queries: %zu (%zu negative)\n\n", queries.size(), sizeof(NEGATIVE) / sizeof(NEGATIVE[0]));
+    printf("%-28s %10s %10s\n", "", "us/query", "errors");
+    printf("%-28s %10.2f %10d\n", "command engine (automaton)", engineUs / n, engineErrors);
+    printf("%-28s %10.2f %10d\n", "old chain (indexOf)", chainUs / n, chainErrors);
+    printf("\nSpeedup: %.1fx\n", chainUs / engineUs);
+
+    printf("\n%s\n", engineErrors ? "FAILED" : "PASSED");
+    return engineErrors ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+// Host test for fuzzy command matching against recorded mishearings
+//
+// Compiles the phrases from data/commands.json, runs every line of the
+// corpus (scripts/command_mishearings.tsv) through the verbatim pass and,
+// if that finds nothing, the fuzzy pass, and checks the command picked.
+// Also verifies that matching does not allocate and reports timing.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Iinclude scripts/command_fuzzy_test.cpp src/command_engine.cpp -o command_fuzzy_test
+//   ./command_fuzzy_test [data/commands.json] [scripts/command_mishearings.tsv] [--min-confidence 0.65]
+//
+// Exits non-zero if any corpus line fails.
+
+#include "command_engine.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Count heap allocations while matching
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// Minimal extraction of "command" and "phrases" strings from commands.json
+// (enough for the file layout the web API writes; no escapes in phrases)
+struct Command {
+    std::string phrase;
+    std::vector<std::string> aliases;
+};
+
+static bool readString(const std::string& s, size_t& pos, std::string& out) {
+    size_t start = s.find('"', pos);
+    if (start == std::string::npos) return false;
+    size_t end = s.find('"', start + 1);
+    if (end == std::string::npos) return false;
+    out = s.substr(start + 1, end - start - 1);
+    pos = end + 1;
+    return true;
+}
+
+static std::vector<Command> loadCommands(const char* path) {
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string s = ss.str();
+
+    std::vector<Command> out;
+    size_t pos = 0;
+    while (true) {
+        size_t obj = s.find('{', pos + 1);
+        if (obj == std::string::npos) break;
+        size_t objEnd = s.find('}', obj);
+        std::string body = s.substr(obj, objEnd - obj);
+        pos = objEnd;
+
+        size_t k = body.find("\"command\"");
+        if (k == std::string::npos) continue;
+        if (body.find("\"enabled\": false") != std::string::npos) continue;
+        Command c;
+        size_t p = body.find(':', k) + 1;
+        readString(body, p, c.phrase);
+
+        size_t a = body.find("\"phrases\"");
+        if (a != std::string::npos) {
+            size_t open = body.find('[', a);
+            size_t close = body.find(']', open);
+            size_t q = open;
+            std::string alias;
+            while (readString(body, q, alias) && q <= close) {
+                c.aliases.push_back(alias);
+            }
+        }
+        out.push_back(c);
+    }
+    return out;
+}
+
+int main(int argc, char** argv) {
+    const char* commandsPath = "data/commands.json";
+    const char* corpusPath = "scripts/command_mishearings.tsv";
+    float minConfidence = COMMAND_MIN_CONFIDENCE;
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--min-confidence") == 0 && i + 1 < argc) {
+            minConfidence = (float)atof(argv[++i]);
+        } else if (positional++ == 0) {
+            commandsPath = argv[i];
+        } else {
+            corpusPath = argv[i];
+        }
+    }
+
+    std::vector<Command> commands = loadCommands(commandsPath);
+    if (commands.empty()) {
+        fprintf(stderr, "No commands in %s\n", commandsPath);
+        return 2;
+    }
+
+    // {slot} templates need the entity index (scripts/entity_index_bench.cpp),
+    // they are compiled here but never match
+    CommandMatcher matcher;
+    for (size_t i = 0; i < commands.size(); i++) {
+        for (size_t k = 0; k <= commands[i].aliases.size(); k++) {
+            const std::string& p = k == 0 ? commands[i].phrase : commands[i].aliases[k - 1];
+            if (p.find('{') != std::string::npos) {
+                matcher.addTemplate(p.c_str(), (int)i);
+            } else {
+                matcher.addPhrase(p.c_str(), (int)i);
+            }
+        }
+    }
+    matcher.compile();
+
+    std::ifstream corpus(corpusPath);
+    if (!corpus) {
+        fprintf(stderr, "Cannot open %s\n", corpusPath);
+        return 2;
+    }
+
+    std::vector<std::pair<std::string, int>> cases;
+    std::string line;
+    while (std::getline(corpus, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos) continue;
+        std::string heard = line.substr(0, tab);
+        std::string expected = line.substr(tab + 1);
+        int index = -1;
+        if (expected != "-") {
+            for (size_t i = 0; i < commands.size(); i++) {
+                if (commands[i].phrase == expected) index = (int)i;
+            }
+            if (index < 0) {
+                fprintf(stderr, "Corpus refers to unknown command '%s'\n", expected.c_str());
+                return 2;
+            }
+        }
+        cases.push_back({ heard, index });
+    }
+
+    int failures = 0;
+    int verbatim = 0;
+    int fuzzy = 0;
+    size_t allocs = 0;
+    for (const auto& c : cases) {
+        CommandMatch m;
+        size_t before = allocations;
+        bool exact = matcher.match(c.first.c_str(), m);
+        bool found = exact || matcher.matchFuzzy(c.first.c_str(), m, minConfidence);
+        allocs += allocations - before;
+
+        int got = found ? m.command : -1;
+        bool ok = got == c.second;
+        if (!ok) failures++;
+        if (found) (exact ? verbatim : fuzzy)++;
+        printf("%s %-32s -> %-22s %s %.2f\n", ok ? "ok  " : "FAIL", c.first.c_str(),
+               got >= 0 ? commands[got].phrase.c_str() : "-", exact ? "exact" : "fuzzy", m.confidence);
+    }
+
+    // Timing: fuzzy pass on every line (the slow path)
+    const int ROUNDS = 200;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (const auto& c : cases) {
+            CommandMatch m;
+            matcher.matchFuzzy(c.first.c_str(), m, minConfidence);
+        }
+    }
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+
+    printf("\n%zu commands, %zu phrases, %zu vocabulary words, %zu bytes\n", commands.size(),
+           matcher.getPhraseCount(), matcher.getVocabularySize(), matcher.getMemoryBytes());
+    printf("%zu cases: %d verbatim, %d fuzzy, %d failed; %zu allocations while matching\n",
+           cases.size(), verbatim, fuzzy, failures, allocs);
+    printf("Fuzzy pass: %.2f us/query\n", us / (ROUNDS * cases.size()));
+
+    bool pass = failures == 0 && allocs == 0;
+    printf("\n%s\n", pass ? "PASSED" : "FAILED");
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,237 @@
+// Host test and benchmark for the on-flash config format
+//
+// Checks the record container (CRC-32 test vector, round trip, and that a
+// flipped bit, a cut-off write, another version or another payload format
+// are rejected), then saves and loads each file two ways, through real files
+// in a temporary directory:
+//
+//   json     what StorageManager::writeJsonFile()/readJsonFile() did:
+//            serializeJson() to a String, write it, read it all back and
+//            deserializeJson()
+//   record   what it does now: MessagePack in a flash_record.h container,
+//            written to .tmp and renamed, read back, CRC checked and
+//            deserializeMsgPack()
+//
+// and reports bytes written per save and save/load time. The loaded
+// documents must equal the original. Host times only rank the two; the
+// flash write itself is slower on the device, which makes bytes written the
+// number that carries over.
+//
+// Without arguments it uses data/config.json, data/commands.json and
+// data/presence.json; other files (e.g. GET /api/config saved to a file) can
+// be given instead:
+//
+//   ./config_format_bench config.json
+//
+// Build (from the repository root; ArduinoJson comes from the PlatformIO
+// library folder, so run `pio pkg install` once):
+//   g++ -std=c++17 -O2 -Iinclude -I.pio/libdeps/esp32-s3-devkitc-1/ArduinoJson/src scripts/config_format_bench.cpp src/flash_record.cpp -o config_format_bench
+//
+// Exits non-zero if a check fails or a round trip changes the document.
+
+#include "flash_record.h"
+#include <ArduinoJson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#define RUNS    200
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static bool readFile(const char* path, std::string& content) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    char buf[4096];
+    size_t n;
+    content.clear();
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        content.append(buf, n);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool writeFile(const char* path, const void* data, size_t len) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    bool ok = fwrite(data, 1, len, f) == len;
+    return fclose(f) == 0 && ok;
+}
+
+// ============================================
+// Record checks
+// ============================================
+static std::vector<uint8_t> makeRecord(const char* payload) {
+    size_t len = strlen(payload);
+    std::vector<uint8_t> record(FLASH_RECORD_HEADER + len);
+    memcpy(record.data() + FLASH_RECORD_HEADER, payload, len);
+    flashRecordSeal(record.data(), len, FLASH_RECORD_MSGPACK);
+    return record;
+}
+
+static const char* openRecord(const std::vector<uint8_t>& record, uint8_t format = FLASH_RECORD_MSGPACK) {
+    const uint8_t* payload;
+    size_t len;
+    return flashRecordOpen(record.data(), record.size(), format, &payload, &len);
+}
+
+static void runChecks() {
+    check(flashRecordCrc((const uint8_t*)"123456789", 9) == 0xCBF43926u, "CRC-32 check value");
+    check(flashRecordCrc((const uint8_t*)"6789", 4, flashRecordCrc((const uint8_t*)"12345", 5)) == 0xCBF43926u,
+          "incremental CRC");
+
+    std::vector<uint8_t> record = makeRecord("\x81\xa4name\xa3hub");
+    const uint8_t* payload;
+    size_t len;
+    check(flashRecordOpen(record.data(), record.size(), FLASH_RECORD_MSGPACK, &payload, &len) == nullptr &&
+          len == 10 && memcmp(payload, "\x81\xa4name\xa3hub", 10) == 0, "valid record opens");
+
+    for (size_t bit = 0; bit < record.size() * 8; bit++) {
+        std::vector<uint8_t> bad = record;
+        bad[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+        if (bit / 8 == 6 || bit / 8 == 7) {
+            continue;           // Reserved bytes are not checked
+        }
+        if (!openRecord(bad)) {
+            printf("FAIL: flipped bit %u accepted\n", (unsigned)bit);
+            failures++;
+            break;
+        }
+    }
+
+    std::vector<uint8_t> cut(record.begin(), record.end() - 1);
+    check(openRecord(cut) != nullptr, "cut-off record rejected");
+    check(openRecord(std::vector<uint8_t>(record.begin(), record.begin() + 8)) != nullptr, "short header rejected");
+
+    std::vector<uint8_t> version = record;
+    version[4] = FLASH_RECORD_VERSION + 1;
+    check(openRecord(version) != nullptr, "other version rejected");
+    check(openRecord(record, FLASH_RECORD_MSGPACK + 1) != nullptr, "other payload format rejected");
+
+    std::vector<uint8_t> empty = makeRecord("");
+    check(openRecord(empty) == nullptr, "empty payload opens");
+}
+
+// ============================================
+// Save and load paths
+// ============================================
+struct Result {
+    size_t bytes;
+    double saveUs;
+    double loadUs;
+    bool same;
+};
+
+static bool saveJson(const char* path, const JsonDocument& doc, size_t& bytes) {
+    std::string output;
+    serializeJson(doc, output);
+    bytes = output.size();
+    return writeFile(path, output.data(), output.size());
+}
+
+static bool loadJson(const char* path, JsonDocument& doc) {
+    std::string content;
+    return readFile(path, content) && !deserializeJson(doc, content);
+}
+
+static bool saveRecord(const char* path, const JsonDocument& doc, size_t& bytes) {
+    std::vector<uint8_t> data(FLASH_RECORD_HEADER + measureMsgPack(doc));
+    size_t len = serializeMsgPack(doc, data.data() + FLASH_RECORD_HEADER, data.size() - FLASH_RECORD_HEADER);
+    bytes = flashRecordSeal(data.data(), len, FLASH_RECORD_MSGPACK);
+    std::string tmpPath = std::string(path) + ".tmp";
+    return writeFile(tmpPath.c_str(), data.data(), bytes) && rename(tmpPath.c_str(), path) == 0;
+}
+
+static bool loadRecord(const char* path, JsonDocument& doc) {
+    std::string content;
+    if (!readFile(path, content)) {
+        return false;
+    }
+    const uint8_t* payload;
+    size_t len;
+    return !flashRecordOpen((const uint8_t*)content.data(), content.size(), FLASH_RECORD_MSGPACK, &payload, &len) &&
+           !deserializeMsgPack(doc, payload, len);
+}
+
+template <typename Save, typename Load>
+static Result measure(const JsonDocument& doc, const char* path, Save save, Load load) {
+    Result r = { 0, 0, 0, true };
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < RUNS; i++) {
+        r.same &= save(path, doc, r.bytes);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < RUNS; i++) {
+        JsonDocument loaded;
+        r.same &= load(path, loaded) && loaded.as<JsonVariantConst>() == doc.as<JsonVariantConst>();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    r.saveUs = std::chrono::duration<double, std::micro>(t1 - t0).count() / RUNS;
+    r.loadUs = std::chrono::duration<double, std::micro>(t2 - t1).count() / RUNS;
+    remove(path);
+    return r;
+}
+
+static void bench(const char* file, const char* dir) {
+    std::string text;
+    JsonDocument doc;
+    if (!readFile(file, text) || deserializeJson(doc, text)) {
+        printf("FAIL: cannot read %s\n", file);
+        failures++;
+        return;
+    }
+
+    std::string jsonPath = std::string(dir) + "/doc.json";
+    std::string recordPath = std::string(dir) + "/doc.bin";
+    Result json = measure(doc, jsonPath.c_str(), saveJson, loadJson);
+    Result record = measure(doc, recordPath.c_str(), saveRecord, loadRecord);
+
+    printf("\n%s\n", file);
+    printf("  %-8s %8s %12s %12s\n", "format", "bytes", "save us", "load us");
+    printf("  %-8s %8u %12.1f %12.1f\n", "json", (unsigned)json.bytes, json.saveUs, json.loadUs);
+    printf("  %-8s %8u %12.1f %12.1f\n", "record", (unsigned)record.bytes, record.saveUs, record.loadUs);
+    printf("  record writes %.0f%% of the JSON bytes, loads in %.0f%% of the time\n",
+           100.0 * record.bytes / json.bytes, 100.0 * record.loadUs / json.loadUs);
+    check(json.same, "JSON round trip");
+    check(record.same, "record round trip");
+}
+
+int main(int argc, char** argv) {
+    runChecks();
+
+    char dir[] = "/tmp/config_format_XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            bench(argv[i], dir);
+        }
+    } else {
+        bench("data/config.json", dir);
+        bench("data/commands.json", dir);
+        bench("data/presence.json", dir);
+    }
+    rmdir(dir);
+
+    printf("\n%s (%d failure%s)\n", failures ? "FAILED" : "OK", failures, failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}
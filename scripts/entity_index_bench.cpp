@@ -0,0 +1,247 @@
+// Host test and benchmark for the Home Assistant entity index
+//
+// Builds a synthetic house of 1200+ entities (lights, switches, covers,
+// locks and fans in 40 areas, named the way HA users do: "Kitchen Ceiling
+// Light", "Porch Lamp 2", ...), indexes them and resolves slot text taken
+// from the names: verbatim, without the device noun, with the area prefixed
+// and with one or two typos. Then runs "turn on {light}" style templates
+// through CommandMatcher with the index as slot resolver, and an incremental
+// refresh with renames and removals.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Iinclude scripts/entity_index_bench.cpp src/entity_index.cpp src/command_engine.cpp -o entity_index_bench
+//
+// Exits non-zero if accuracy is below 95%, a lookup takes 1 ms or more, or
+// a refresh check fails.
+
+#include "entity_index.h"
+#include "command_engine.h"
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+static const char* AREAS[] = {
+    "Kitchen", "Living Room", "Dining Room", "Hallway", "Porch", "Garage", "Office", "Study",
+    "Master Bedroom", "Guest Room", "Nursery", "Bathroom", "Laundry", "Basement", "Attic", "Patio",
+    "Garden", "Driveway", "Pantry", "Den", "Library", "Gym", "Workshop", "Playroom",
+    "Sunroom", "Foyer", "Mudroom", "Closet", "Balcony", "Terrace", "Shed", "Cellar",
+    "Loft", "Studio", "Lounge", "Veranda", "Conservatory", "Utility", "Stairs", "Landing"
+};
+
+struct Kind {
+    const char* domain;
+    const char* noun;
+};
+
+static const Kind KINDS[] = {
+    { "light", "Light" }, { "light", "Lamp" }, { "light", "Ceiling Light" }, { "light", "Spotlight" },
+    { "switch", "Plug" }, { "switch", "Heater" }, { "cover", "Blind" }, { "cover", "Shutter" },
+    { "lock", "Lock" }, { "fan", "Fan" }
+};
+
+struct TestEntity {
+    std::string id;
+    std::string name;
+    std::string area;
+};
+
+static std::string objectId(const std::string& name) {
+    std::string s;
+    for (char c : name) {
+        s += c == ' ' ? '_' : (char)tolower((unsigned char)c);
+    }
+    return s;
+}
+
+static std::vector<TestEntity> buildHouse() {
+    std::vector<TestEntity> out;
+    for (const char* area : AREAS) {
+        for (const Kind& k : KINDS) {
+            for (int n = 1; n <= 3; n++) {
+                std::string name = std::string(area) + " " + k.noun;
+                if (n > 1) name += " " + std::to_string(n);
+                out.push_back({ std::string(k.domain) + "." + objectId(name), name, area });
+            }
+        }
+    }
+    return out;
+}
+
+// Deterministic typo: swap two letters or drop one
+static std::string typo(const std::string& s, unsigned seed) {
+    std::string t = s;
+    size_t i = 1 + seed % (t.size() - 2);
+    if (t[i] == ' ' || t[i + 1] == ' ') {
+        return t;
+    }
+    if (seed & 1) {
+        std::swap(t[i], t[i + 1]);
+    } else {
+        t.erase(i, 1);
+    }
+    return t;
+}
+
+static std::string lower(std::string s) {
+    for (char& c : s) c = (char)tolower((unsigned char)c);
+    return s;
+}
+
+struct Query {
+    std::string text;
+    std::string domain;
+    std::string expected;
+};
+
+static float resolveSlot(const char* slot, const char* text, char* value, size_t valueSize, void* ctx) {
+    EntityIndex* index = (EntityIndex*)ctx;
+    EntityHit hit;
+    if (!index->lookup(text, slot, hit)) {
+        return 0.0f;
+    }
+    snprintf(value, valueSize, "%s", index->getObjectId(hit.entity));
+    return hit.confidence;
+}
+
+int main() {
+    int failures = 0;
+    std::vector<TestEntity> house = buildHouse();
+
+    EntityIndex index;
+    auto t0 = std::chrono::steady_clock::now();
+    index.beginRefresh();
+    for (const TestEntity& e : house) {
+        index.upsert(e.id.c_str(), e.name.c_str(), e.area.c_str());
+    }
+    index.endRefresh();
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    // Queries: first instance of each area/kind (the "2" and "3" duplicates
+    // are distractors one edit away)
+    std::vector<Query> queries;
+    unsigned seed = 7;
+    for (size_t i = 0; i < house.size(); i += 3) {
+        const TestEntity& e = house[i];
+        std::string domain = e.id.substr(0, e.id.find('.'));
+        std::string name = lower(e.name);
+        queries.push_back({ name, domain, e.id });
+        queries.push_back({ "the " + name + "s", domain, e.id });
+        seed = seed * 1103515245u + 12345u;
+        queries.push_back({ typo(name, seed >> 8), domain, e.id });
+    }
+    // Area + short name for entities whose name does not start with the area
+    index.upsert("light.reading", "Reading Lamp", "Library");
+    queries.push_back({ "library reading lamp", "light", "light.reading" });
+    queries.push_back({ "reading", "light", "light.reading" });
+    queries.push_back({ "redding lamp", "light", "light.reading" });
+
+    int correct = 0;
+    for (const Query& q : queries) {
+        EntityHit hit;
+        bool found = index.lookup(q.text.c_str(), q.domain.c_str(), hit);
+        if (found && q.expected == index.getEntityId(hit.entity)) {
+            correct++;
+        } else if ((int)(&q - &queries[0]) - correct < 10) {
+            printf("MISS '%s' -> %s (expected %s)\n", q.text.c_str(),
+                   found ? index.getEntityId(hit.entity) : "none", q.expected.c_str());
+        }
+    }
+    double accuracy = (double)correct / queries.size();
+
+    // Timing: average over all rounds; worst = slowest query, taking each
+    // query's best round so host scheduling noise does not count
+    const int ROUNDS = 5;
+    std::vector<double> best(queries.size(), 1e9);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < queries.size(); i++) {
+            auto s = std::chrono::steady_clock::now();
+            EntityHit hit;
+            index.lookup(queries[i].text.c_str(), queries[i].domain.c_str(), hit);
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - s).count();
+            if (us < best[i]) best[i] = us;
+        }
+    }
+    double avgUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t1).count() /
+                   (queries.size() * ROUNDS);
+    double worstUs = 0;
+    for (double us : best) {
+        if (us > worstUs) worstUs = us;
+    }
+
+    printf("Entities: %zu, keys: %zu, memory: %zu bytes, build: %.1f ms\n",
+           index.size(), index.getKeyCount(), index.getMemoryBytes(), buildMs);
+    printf("Lookups: %zu, accuracy %.1f%%, %.1f us average, %.1f us worst\n",
+           queries.size(), accuracy * 100, avgUs, worstUs);
+    if (accuracy < 0.95) {
+        printf("FAIL accuracy below 95%%\n");
+        failures++;
+    }
+    if (worstUs >= 1000) {
+        printf("FAIL lookup took %.0f us\n", worstUs);
+        failures++;
+    }
+
+    // Templates through the command matcher
+    CommandMatcher matcher;
+    matcher.addPhrase("turn on the lights", 0);
+    matcher.addTemplate("turn on {light}", 1);
+    matcher.addTemplate("{light} off", 2);
+    matcher.addTemplate("open {cover}", 3);
+    matcher.compile();
+
+    struct TemplateCase {
+        const char* text;
+        int command;
+        const char* value;
+    } templateCases[] = {
+        { "turn on the porch light", 1, "porch_light" },
+        { "please turn on the kitchen celing light", 1, "kitchen_ceiling_light" },
+        { "turn on reading lamp", 1, "reading" },
+        { "office spotlight off", 2, "office_spotlight" },
+        { "open the garage blinds", 3, "garage_blind" },
+        { "turn on the toaster", -1, "" },
+        { "open the spotlight", -1, "" }           // Only lights are spotlights
+    };
+    for (const TemplateCase& c : templateCases) {
+        CommandMatch m;
+        bool found = matcher.matchTemplate(c.text, resolveSlot, &index, m);
+        int got = found ? m.command : -1;
+        if (got != c.command || (found && strcmp(m.value, c.value) != 0)) {
+            printf("FAIL template '%s' -> %d '%s', expected %d '%s'\n", c.text, got, m.value, c.command, c.value);
+            failures++;
+        }
+    }
+
+    // Incremental refresh: unchanged entities are skipped, a rename gets new
+    // keys, removed ones disappear and eventually trigger a rebuild
+    index.beginRefresh();
+    int changed = 0;
+    for (size_t i = 0; i < house.size(); i++) {
+        const TestEntity& e = house[i];
+        if (i % 3 == 2) continue;      // Removed
+        std::string name = e.id == "light.porch_light" ? "Front Porch Light" : e.name;
+        changed += index.upsert(e.id.c_str(), name.c_str(), e.area.c_str());
+    }
+    index.upsert("light.reading", "Reading Lamp", "Library");
+    auto t2 = std::chrono::steady_clock::now();
+    int removed = index.endRefresh();
+    double sweepUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t2).count();
+
+    EntityHit hit;
+    bool renamed = index.lookup("front porch light", "light", hit) &&
+                   strcmp(index.getEntityId(hit.entity), "light.porch_light") == 0;
+    bool gone = !index.lookup("porch light 3", "light", hit) ||
+                strcmp(index.getEntityId(hit.entity), "light.porch_light_3") != 0;
+    printf("Refresh: %d changed, %d removed, %u rebuilds, sweep %.0f us, %zu entities\n",
+           changed, removed, index.getRebuilds(), sweepUs, index.size());
+    if (changed != 1 || removed != (int)(house.size() / 3) || !renamed || !gone || index.getTombstones() != 0) {
+        printf("FAIL refresh\n");
+        failures++;
+    }
+
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
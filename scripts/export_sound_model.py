@@ -0,0 +1,267 @@
+#!/usr/bin/env python3
+"""
+Export a trained Keras sound event classifier to the on-device SEV1 format
+(/models/sound_events.bin, see include/sound_events.h)
+
+Supported layers: Conv2D (odd kernel, 'same' padding, relu/linear),
+MaxPooling2D (square, stride == pool size), GlobalAveragePooling2D, Dense.
+The model input is (frames, mels, 1) log-mel patches as computed by
+LogMelFrontend; a trailing softmax is dropped (the device applies it).
+
+Post-training quantization: symmetric per-tensor int8 weights, asymmetric
+per-tensor int8 activations calibrated on WAV clips.
+
+Usage:
+  export_sound_model.py model.keras --classes background,doorbell,knock \\
+      --calibration clips/ --output data/models/sound_events.bin
+
+Requires: numpy, tensorflow (only to read the Keras model)
+"""
+
+import argparse
+import glob
+import os
+import struct
+import sys
+import wave
+
+import numpy as np
+
+MAGIC = 0x31564553              # "SEV1"
+VERSION = 1
+NAME_LEN = 24
+SAMPLE_RATE = 16000
+FFT_SIZE = 512
+FRAME_SAMPLES = 512             # One pipeline frame (AUDIO_FRAME_SAMPLES)
+
+LAYER_CONV2D = 1
+LAYER_MAXPOOL = 2
+LAYER_GAP = 3
+LAYER_DENSE = 4
+
+
+# ============================================
+# Front end (mirrors LogMelFrontend)
+# ============================================
+
+def hz_to_mel(hz):
+    return 2595.0 * np.log10(1.0 + hz / 700.0)
+
+
+def mel_to_hz(mel):
+    return 700.0 * (10.0 ** (mel / 2595.0) - 1.0)
+
+
+def mel_filterbank(num_mels, f_min=60.0, f_max=7600.0):
+    """Triangular filters with fractional bin edges, (num_mels, FFT_SIZE/2+1)"""
+    mels = np.linspace(hz_to_mel(f_min), hz_to_mel(f_max), num_mels + 2)
+    edges = mel_to_hz(mels) * FFT_SIZE / SAMPLE_RATE
+    bins = np.arange(FFT_SIZE // 2 + 1, dtype=np.float64)
+    bank = np.zeros((num_mels, bins.size))
+    for m in range(num_mels):
+        left, center, right = edges[m], edges[m + 1], edges[m + 2]
+        up = (bins - left) / (center - left)
+        down = (right - bins) / (right - center)
+        bank[m] = np.maximum(0.0, np.minimum(up, down))
+    return bank
+
+
+def log_mel(samples, num_mels):
+    """16-bit PCM -> (frames, num_mels) log-mel, one row per 512-sample frame"""
+    window = 0.5 - 0.5 * np.cos(2.0 * np.pi * np.arange(FFT_SIZE) / FFT_SIZE)
+    bank = mel_filterbank(num_mels)
+    frames = len(samples) // FRAME_SAMPLES
+    out = np.zeros((frames, num_mels), dtype=np.float32)
+    for i in range(frames):
+        x = samples[i * FRAME_SAMPLES:(i + 1) * FRAME_SAMPLES] / 32768.0
+        power = np.abs(np.fft.rfft(x * window, FFT_SIZE)) ** 2
+        out[i] = np.log(bank @ power + 1e-6)
+    return out
+
+
+def read_wav(path):
+    with wave.open(path, "rb") as w:
+        if w.getframerate() != SAMPLE_RATE or w.getnchannels() != 1 or w.getsampwidth() != 2:
+            raise ValueError(f"{path}: expected 16 kHz mono 16-bit PCM")
+        return np.frombuffer(w.readframes(w.getnframes()), dtype="<i2").astype(np.float64)
+
+
+def calibration_patches(directory, frames, mels, hop):
+    """All (frames, mels, 1) windows from the WAV files under directory"""
+    patches = []
+    for path in sorted(glob.glob(os.path.join(directory, "**", "*.wav"), recursive=True)):
+        feats = log_mel(read_wav(path), mels)
+        for start in range(0, len(feats) - frames + 1, hop):
+            patches.append(feats[start:start + frames, :, np.newaxis])
+    if not patches:
+        raise ValueError(f"no calibration windows found in {directory}")
+    return np.stack(patches).astype(np.float32)
+
+
+# ============================================
+# Float reference model (layer specs)
+# ============================================
+
+def keras_to_specs(model):
+    """Keras model -> list of layer dicts understood by the exporter"""
+    specs = []
+    for layer in model.layers:
+        kind = layer.__class__.__name__
+        cfg = layer.get_config()
+        act = cfg.get("activation", "linear")
+        if kind in ("InputLayer", "Dropout", "Flatten", "Reshape"):
+            continue
+        if kind == "Activation" and act == "softmax":
+            continue
+        if kind == "Conv2D":
+            k = cfg["kernel_size"]
+            if k[0] != k[1] or k[0] % 2 == 0 or cfg["padding"] != "same":
+                raise ValueError(f"{layer.name}: only odd square kernels with 'same' padding")
+            if cfg["strides"][0] != cfg["strides"][1]:
+                raise ValueError(f"{layer.name}: strides must be equal")
+            w, b = layer.get_weights()
+            specs.append({"type": LAYER_CONV2D, "w": w, "b": b, "kernel": k[0],
+                          "stride": cfg["strides"][0], "relu": act == "relu"})
+        elif kind == "MaxPooling2D":
+            p = cfg["pool_size"]
+            if p[0] != p[1] or tuple(cfg["strides"]) != tuple(p):
+                raise ValueError(f"{layer.name}: only square pools with stride == pool size")
+            specs.append({"type": LAYER_MAXPOOL, "kernel": p[0]})
+        elif kind == "GlobalAveragePooling2D":
+            specs.append({"type": LAYER_GAP})
+        elif kind == "Dense":
+            if act not in ("linear", "relu", "softmax"):
+                raise ValueError(f"{layer.name}: unsupported activation {act}")
+            w, b = layer.get_weights()
+            specs.append({"type": LAYER_DENSE, "w": w, "b": b, "relu": act == "relu"})
+        else:
+            raise ValueError(f"{layer.name}: unsupported layer {kind}")
+    return specs
+
+
+def forward(spec, x):
+    """Float forward of one layer on a (N, H, W, C) batch"""
+    t = spec["type"]
+    if t == LAYER_CONV2D:
+        k, s = spec["kernel"], spec["stride"]
+        pad = (k - 1) // 2
+        n, h, w, _ = x.shape
+        xp = np.pad(x, ((0, 0), (pad, k - 1 - pad), (pad, k - 1 - pad), (0, 0)))
+        oh, ow = (h + s - 1) // s, (w + s - 1) // s
+        y = np.zeros((n, oh, ow, spec["w"].shape[3]), dtype=np.float32)
+        for ky in range(k):
+            for kx in range(k):
+                patch = xp[:, ky:ky + (oh - 1) * s + 1:s, kx:kx + (ow - 1) * s + 1:s, :]
+                y += patch @ spec["w"][ky, kx]
+        y += spec["b"]
+    elif t == LAYER_MAXPOOL:
+        k = spec["kernel"]
+        n, h, w, c = x.shape
+        oh, ow = h // k, w // k
+        y = x[:, :oh * k, :ow * k, :].reshape(n, oh, k, ow, k, c).max(axis=(2, 4))
+    elif t == LAYER_GAP:
+        y = x.mean(axis=(1, 2), keepdims=True)
+    else:
+        y = x.reshape(x.shape[0], -1) @ spec["w"] + spec["b"]
+        y = y.reshape(y.shape[0], 1, 1, -1)
+    if spec.get("relu"):
+        y = np.maximum(y, 0.0)
+    return y
+
+
+# ============================================
+# Quantization and serialization
+# ============================================
+
+def activation_params(values):
+    """Asymmetric int8 (scale, zero) covering the observed range and 0"""
+    lo = min(float(np.percentile(values, 0.01)), 0.0)
+    hi = max(float(np.percentile(values, 99.99)), 0.0)
+    scale = max(hi - lo, 1e-8) / 255.0
+    zero = int(np.clip(round(-128 - lo / scale), -128, 127))
+    return scale, zero
+
+
+def pad4(data):
+    return data + b"\0" * (-len(data) % 4)
+
+
+def export(specs, classes, patches):
+    frames, mels = patches.shape[1], patches.shape[2]
+    in_scale, in_zero = activation_params(patches)
+    out = struct.pack("<IHHHHHbBf", MAGIC, VERSION, frames, mels, len(classes), len(specs),
+                      in_zero, 0, in_scale)
+    for name in classes:
+        raw = name.encode("ascii")[:NAME_LEN - 1]
+        out += raw + b"\0" * (NAME_LEN - len(raw))
+
+    x = patches
+    scale, zero = in_scale, in_zero
+    macs = 0
+    for spec in specs:
+        t = spec["type"]
+        x = forward(spec, x)
+
+        if t in (LAYER_MAXPOOL, LAYER_GAP):
+            # Quantization parameters pass through unchanged
+            out += struct.pack("<BBBBHHffb3x", t, 0, spec.get("kernel", 0), spec.get("kernel", 0),
+                               0, 0, 0.0, scale, zero)
+            continue
+
+        w = spec["w"]
+        if t == LAYER_CONV2D:
+            # Keras HWIO -> device [oc][ky][kx][ic]
+            wq_src = np.transpose(w, (3, 0, 1, 2))
+            macs += x.shape[1] * x.shape[2] * w.size
+        else:
+            # Keras (in, out) -> device [oc][in], input flattened HWC like the device
+            wq_src = w.T
+            macs += w.size
+        w_scale = max(float(np.abs(w).max()), 1e-8) / 127.0
+        wq = np.clip(np.round(wq_src / w_scale), -127, 127).astype(np.int8)
+        bq = np.round(spec["b"] / (scale * w_scale)).astype(np.int32)
+
+        out_scale, out_zero = activation_params(x)
+        multiplier = scale * w_scale / out_scale
+        flags = 1 if spec.get("relu") else 0
+        out += struct.pack("<BBBBHHffb3x", t, flags, spec.get("kernel", 1), spec.get("stride", 1),
+                           wq.shape[0], 0, multiplier, out_scale, out_zero)
+        out += pad4(wq.tobytes())
+        out += bq.astype("<i4").tobytes()
+        scale, zero = out_scale, out_zero
+
+    if x.shape[-1] != len(classes):
+        raise ValueError(f"model has {x.shape[-1]} outputs but {len(classes)} classes were given")
+    return out, macs
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("model", help="Keras model (.keras / .h5)")
+    parser.add_argument("--classes", required=True, help="Comma separated class names in output order")
+    parser.add_argument("--calibration", required=True, help="Directory of 16 kHz mono WAV clips")
+    parser.add_argument("--hop", type=int, default=8, help="Calibration window hop in frames")
+    parser.add_argument("--output", default="data/models/sound_events.bin")
+    args = parser.parse_args()
+
+    import tensorflow as tf
+    model = tf.keras.models.load_model(args.model, compile=False)
+    _, frames, mels, channels = model.input_shape
+    if channels != 1:
+        print("Model input must be (frames, mels, 1)", file=sys.stderr)
+        return 1
+
+    classes = [c.strip() for c in args.classes.split(",") if c.strip()]
+    patches = calibration_patches(args.calibration, frames, mels, args.hop)
+    data, macs = export(keras_to_specs(model), classes, patches)
+
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, "wb") as f:
+        f.write(data)
+    print(f"Wrote {args.output}: {len(data)} bytes, {len(classes)} classes, "
+          f"{frames}x{mels} input, {macs} MACs ({len(patches)} calibration windows)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+"""
+Generate src/tz_data.h: every IANA zone name with its POSIX TZ string.
+
+The POSIX string is the footer of the zone's TZif file (version 2 and up),
+the rule zic writes for times after the last explicit transition. That is
+what newlib's tzset() understands, so the table maps e.g.
+
+    Europe/Riga  ->  EET-2EEST,M3.5.0/3,M10.5.0/4
+
+Names are sorted (strcmp order) for binary search; identical POSIX strings
+are stored once. Run it again when tzdata changes and commit the result:
+
+    python3 scripts/generate_tz_table.py [--zoneinfo /usr/share/zoneinfo]
+
+scripts/tz_table_test.cpp checks the generated table against the same
+tzdata.
+"""
+
+import argparse
+import os
+import sys
+from pathlib import Path
+
+SCRIPT_DIR = Path(__file__).parent
+PROJECT_ROOT = SCRIPT_DIR.parent
+OUTPUT = PROJECT_ROOT / "src" / "tz_data.h"
+
+# Not zones: alternate trees, links to the local zone, placeholders
+SKIP_DIRS = {"posix", "right"}
+SKIP_NAMES = {"localtime", "posixrules", "Factory"}
+
+
+def read_footer(path):
+    """POSIX TZ string from a TZif file, or None if it is not TZif v2+."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < 44 or data[:4] != b"TZif" or data[4:5] not in (b"2", b"3", b"4"):
+        return None
+    # The footer is the last line: "\n<posix>\n"
+    end = data.rstrip(b"\n")
+    start = end.rfind(b"\n")
+    if start < 0:
+        return None
+    footer = end[start + 1:].decode("ascii")
+    return footer or None
+
+
+def read_version(zoneinfo):
+    for name in ("tzdata.zi", "+VERSION"):
+        path = zoneinfo / name
+        if path.exists():
+            with open(path) as f:
+                line = f.readline().strip()
+            return line.replace("# version", "").strip()
+    return "unknown"
+
+
+def collect(zoneinfo):
+    zones = {}
+    for root, dirs, files in os.walk(zoneinfo):
+        dirs[:] = sorted(d for d in dirs if not (Path(root) == zoneinfo and d in SKIP_DIRS))
+        for name in files:
+            path = Path(root) / name
+            zone = path.relative_to(zoneinfo).as_posix()
+            if zone in SKIP_NAMES:
+                continue
+            footer = read_footer(path)
+            if footer:
+                zones[zone] = footer
+    return zones
+
+
+def c_string(text):
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"') + '\\0"'
+
+
+def generate(zones, version):
+    names = sorted(zones, key=lambda z: z.encode("ascii"))
+    rules = sorted(set(zones.values()))
+
+    rule_offset = {}
+    offset = 0
+    for rule in rules:
+        rule_offset[rule] = offset
+        offset += len(rule) + 1
+    rules_size = offset
+
+    name_offset = {}
+    offset = 0
+    for name in names:
+        name_offset[name] = offset
+        offset += len(name) + 1
+    names_size = offset
+
+    if names_size > 0xFFFF or rules_size > 0xFFFF:
+        sys.exit("Table too large for 16-bit offsets")
+
+    out = []
+    out.append("// Generated by scripts/generate_tz_table.py - do not edit")
+    out.append(f"// tzdata {version}: {len(names)} zones, {len(rules)} distinct rules")
+    out.append("")
+    out.append(f'#define TZ_DATA_VERSION "{version}"')
+    out.append(f"#define TZ_DATA_COUNT {len(names)}")
+    out.append("")
+    out.append("static const char TZ_NAMES[] =")
+    for name in names:
+        out.append(f"    {c_string(name)}")
+    out.append("    ;")
+    out.append("")
+    out.append("static const char TZ_RULES[] =")
+    for rule in rules:
+        out.append(f"    {c_string(rule)}")
+    out.append("    ;")
+    out.append("")
+    out.append("// Offsets into TZ_NAMES and TZ_RULES, sorted by name")
+    out.append("static const TzEntry TZ_ENTRIES[TZ_DATA_COUNT] = {")
+    for name in names:
+        out.append(f"    {{ {name_offset[name]}, {rule_offset[zones[name]]} }},  // {name}")
+    out.append("};")
+    out.append("")
+
+    size = names_size + rules_size + 4 * len(names)
+    return "\n".join(out), size
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--zoneinfo", default="/usr/share/zoneinfo", help="tzdata directory")
+    parser.add_argument("--output", default=str(OUTPUT), help="header to write")
+    args = parser.parse_args()
+
+    zoneinfo = Path(args.zoneinfo)
+    zones = collect(zoneinfo)
+    if not zones:
+        sys.exit(f"No TZif v2+ zones found in {zoneinfo}")
+
+    version = read_version(zoneinfo)
+    text, size = generate(zones, version)
+    with open(args.output, "w") as f:
+        f.write(text)
+    print(f"✓ {args.output}: tzdata {version}, {len(zones)} zones, {size} bytes of flash")
+
+
+if __name__ == "__main__":
+    main()
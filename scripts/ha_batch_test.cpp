@@ -0,0 +1,123 @@
+// Host test for the batched HA state fetch (template building and parsing)
+//
+// Builds the /api/template template for a presence/weather/gate/timezone
+// batch and compares it with the expected Jinja, checks that entity ids and
+// attribute names that could break out of the template are rejected, and
+// parses rendered responses: lines in any order, entities HA does not have
+// (no line, not "unknown"), missing attribute columns, truncated values and
+// extra values.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Iinclude scripts/ha_batch_test.cpp src/ha_batch.cpp -o ha_batch_test
+//
+// Exits non-zero if any check fails.
+
+#include "ha_batch.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) failures++;
+}
+
+static int parse(HAStateBatch& batch, const char* text) {
+    return batch.parse(text, strlen(text));
+}
+
+int main() {
+    static HAStateBatch batch;
+
+    // Building
+    check(batch.addEntity("person.alice") == 0 && batch.addEntity("person.bob") == 1, "entities added in order");
+    check(batch.addEntity("person.alice") == 0, "duplicate returns the same index");
+    check(batch.addEntity("person.x'] %}{{ 1") == -1, "quote rejected");
+    check(batch.addEntity("person") == -1 && batch.addEntity("a.b.c") == -1 && batch.addEntity("Person.Alice") == -1,
+          "ids that are not domain.object_id rejected");
+    batch.addEntity("weather.forecast_home");
+    batch.addEntity("cover.gate");
+    check(batch.addAttribute("friendly_name") && batch.addAttribute("temperature") && batch.addAttribute("temperature"),
+          "attributes added, duplicate ignored");
+    check(!batch.addAttribute("friendly-name"), "attribute name with a dash rejected");
+    check(batch.addValue("tz", "now().tzinfo"), "value added");
+    check(!batch.addValue("bad", "1 }}{{ 2"), "value closing the expression rejected");
+    check(batch.getItemCount() == 5, "five items");
+
+    char tmpl[1024];
+    size_t len = batch.buildTemplate(tmpl, sizeof(tmpl));
+    const char* expected =
+        "{% for e in ['person.alice','person.bob','weather.forecast_home','cover.gate'] %}"
+        "{% if states[e] is not none %}"
+        "{{ e }}\t{{ states(e) | string | replace('\\t',' ') | replace('\\n',' ') }}"
+        "{% for a in ['friendly_name','temperature'] %}{% set v = state_attr(e, a) %}"
+        "\t{{ ('' if v is none else v) | string | replace('\\t',' ') | replace('\\n',' ') }}{% endfor %}"
+        "\n{% endif %}{% endfor %}"
+        "=tz\t{{ (now().tzinfo) | string | replace('\\t',' ') | replace('\\n',' ') }}\n";
+    check(len == strlen(expected) && strcmp(tmpl, expected) == 0, "template matches");
+    if (strcmp(tmpl, expected) != 0) printf("%s\n", tmpl);
+    check(batch.buildTemplate(tmpl, 64) == 0, "too small a buffer fails");
+
+    // Parsing
+    int found = parse(batch,
+        "weather.forecast_home\tpartlycloudy\tForecast Home\t-2.5\n"
+        "person.alice\thome\tAlice\t\n"
+        "light.unrelated\ton\tLamp\t\n"
+        "cover.gate\tclosed\n"
+        "=tz\tEurope/Riga\n");
+    check(found == 4, "four of five items found");
+    const HABatchEntity* alice = batch.find("person.alice");
+    check(alice && alice->found && strcmp(alice->state, "home") == 0 &&
+          strcmp(batch.getAttribute(*alice, "friendly_name"), "Alice") == 0, "person state and name");
+    check(!batch.find("person.bob")->found && batch.find("person.bob")->state[0] == '\0', "missing entity not found");
+    const HABatchEntity* weather = batch.find("weather.forecast_home");
+    check(weather && strcmp(weather->state, "partlycloudy") == 0 &&
+          strcmp(batch.getAttribute(*weather, "temperature"), "-2.5") == 0, "weather state and temperature");
+    const HABatchEntity* gate = batch.find("cover.gate");
+    check(gate && gate->found && strcmp(gate->state, "closed") == 0 &&
+          batch.getAttribute(*gate, "friendly_name")[0] == '\0', "short line leaves attributes empty");
+    check(batch.getValue("tz") && strcmp(batch.getValue("tz"), "Europe/Riga") == 0, "value");
+    check(!batch.find("light.unrelated") && batch.getAttribute(*gate, "humidity")[0] == '\0',
+          "unrequested entity and attribute ignored");
+
+    // A mistyped or deleted person gets no line, so no card
+    HAStateBatch people;
+    people.addEntity("person.alice");
+    people.addEntity("person.alcie");
+    people.addAttribute("friendly_name");
+    check(people.buildTemplate(tmpl, sizeof(tmpl)) > 0 && strstr(tmpl, "{% if states[e] is not none %}"),
+          "template skips entities HA does not have");
+    found = parse(people, "person.alice\tnot_home\tAlice\n");
+    check(found == 1 && people.find("person.alice")->found && !people.find("person.alcie")->found,
+          "entity HA does not have stays not found");
+
+    // A second response replaces the first
+    char longName[200];
+    memset(longName, 'x', sizeof(longName) - 1);
+    longName[sizeof(longName) - 1] = '\0';
+    char response[512];
+    snprintf(response, sizeof(response), "person.bob\tnot_home\t%s\t\n", longName);
+    found = parse(batch, response);
+    check(found == 1 && !batch.find("person.alice")->found && !batch.getValue("tz"), "previous results cleared");
+    const HABatchEntity* bob = batch.find("person.bob");
+    check(strlen(batch.getAttribute(*bob, "friendly_name")) == HA_BATCH_TEXT_LEN - 1, "long value truncated");
+    check(parse(batch, "person.bob") == 0 && parse(batch, "") == 0, "incomplete and empty responses");
+
+    // Capacity
+    HAStateBatch full;
+    char id[32];
+    int added = 0;
+    for (int i = 0; i < HA_BATCH_MAX_ENTITIES + 2; i++) {
+        snprintf(id, sizeof(id), "sensor.s%d", i);
+        if (full.addEntity(id) >= 0) added++;
+    }
+    check(added == HA_BATCH_MAX_ENTITIES, "entity capacity enforced");
+    check(full.buildTemplate(tmpl, sizeof(tmpl)) > 0, "full batch fits a 1 KB template");
+
+    batch.clear();
+    check(batch.isEmpty() && batch.getItemCount() == 0, "cleared batch is empty");
+
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,349 @@
+#!/usr/bin/env python3
+"""
+Stand-in Home Assistant WebSocket API server (/api/websocket)
+
+Speaks enough of the HA protocol to exercise the panel's push client
+(src/ha_websocket.cpp) without a real HA instance:
+
+  auth_required -> auth -> auth_ok / auth_invalid
+  subscribe_entities (with entity_ids) -> result, then a compressed
+      snapshot {"a": ...} and diffs {"c": {"+", "-"}} / {"r": [...]}
+  ping -> pong, plus WebSocket ping/pong/close frames
+
+State changes come from stdin, one command per line, and are pushed to
+every subscribed client:
+
+  set <entity_id> <state> [name=value ...]     change state (and attributes)
+  attr <entity_id> name=value [name=value ...] change attributes only
+  unset <entity_id> name [name ...]            remove attributes
+  del <entity_id>                              remove the entity
+  quit
+
+Values that parse as numbers are sent as numbers. --scenario replaces stdin
+with a scripted sequence used by scripts/ha_ws_test.cpp. It includes a
+fragmented message with a WebSocket ping between the fragments, and it
+checks that the ping is answered.
+
+Usage:
+  ha_ws_standin.py --port 8123 --token test-token
+  (point integrations.home_assistant.url at http://<this pc>:8123)
+
+Only the Python standard library is needed.
+"""
+
+import argparse
+import base64
+import hashlib
+import json
+import socket
+import struct
+import sys
+import threading
+import time
+
+GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+OP_CONT, OP_TEXT, OP_CLOSE, OP_PING, OP_PONG = 0x0, 0x1, 0x8, 0x9, 0xA
+
+INITIAL_STATES = {
+    "person.alice": {"s": "home", "a": {"friendly_name": "Alice"}},
+    "person.bob": {"s": "not_home", "a": {"friendly_name": "Bob"}},
+    "weather.forecast_home": {
+        "s": "sunny",
+        "a": {"friendly_name": "Forecast Home", "temperature": 21.5, "humidity": 40},
+    },
+    "calendar.family": {"s": "off", "a": {"friendly_name": "Family"}},
+    "light.porch": {"s": "off", "a": {"friendly_name": "Porch Light"}},
+}
+
+
+def parse_value(text):
+    for cast in (int, float):
+        try:
+            return cast(text)
+        except ValueError:
+            pass
+    return text
+
+
+class Client:
+    def __init__(self, server, sock, addr):
+        self.server = server
+        self.sock = sock
+        self.addr = addr
+        self.lock = threading.Lock()
+        self.subscription = None        # (id, set of entity ids)
+        self.pong_event = threading.Event()
+
+    # --- framing ---------------------------------------------------------
+
+    def send_frame(self, op, payload, fin=True):
+        header = bytes([(0x80 if fin else 0) | op])
+        n = len(payload)
+        if n < 126:
+            header += bytes([n])
+        elif n < 65536:
+            header += bytes([126]) + struct.pack(">H", n)
+        else:
+            header += bytes([127]) + struct.pack(">Q", n)
+        with self.lock:
+            self.sock.sendall(header + payload)
+
+    def send_json(self, obj):
+        self.send_frame(OP_TEXT, json.dumps(obj, separators=(",", ":")).encode())
+
+    def recv_exact(self, n):
+        data = b""
+        while len(data) < n:
+            chunk = self.sock.recv(n - len(data))
+            if not chunk:
+                raise ConnectionError("closed")
+            data += chunk
+        return data
+
+    def recv_frame(self):
+        b0, b1 = self.recv_exact(2)
+        op = b0 & 0x0F
+        if not b1 & 0x80:
+            raise ConnectionError("unmasked client frame")
+        n = b1 & 0x7F
+        if n == 126:
+            n = struct.unpack(">H", self.recv_exact(2))[0]
+        elif n == 127:
+            n = struct.unpack(">Q", self.recv_exact(8))[0]
+        mask = self.recv_exact(4)
+        data = bytearray(self.recv_exact(n))
+        for i in range(n):
+            data[i] ^= mask[i & 3]
+        return op, bytes(data)
+
+    # --- protocol --------------------------------------------------------
+
+    def handshake(self):
+        request = b""
+        while b"\r\n\r\n" not in request:
+            chunk = self.sock.recv(1024)
+            if not chunk:
+                raise ConnectionError("closed during handshake")
+            request += chunk
+        headers = {}
+        lines = request.decode(errors="replace").split("\r\n")
+        for line in lines[1:]:
+            if ":" in line:
+                k, v = line.split(":", 1)
+                headers[k.strip().lower()] = v.strip()
+        if not lines[0].startswith("GET /api/websocket ") or "sec-websocket-key" not in headers:
+            self.sock.sendall(b"HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n")
+            raise ConnectionError("not a websocket request")
+        accept = base64.b64encode(hashlib.sha1((headers["sec-websocket-key"] + GUID).encode()).digest())
+        # auth_required goes out in the same segment, as HA often does
+        response = (b"HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+                    b"Connection: Upgrade\r\nSec-WebSocket-Accept: " + accept + b"\r\n\r\n")
+        first = json.dumps({"type": "auth_required", "ha_version": "standin"}).encode()
+        with self.lock:
+            self.sock.sendall(response + bytes([0x81, len(first)]) + first)
+
+    def run(self):
+        try:
+            self.handshake()
+            while True:
+                op, data = self.recv_frame()
+                if op == OP_CLOSE:
+                    self.send_frame(OP_CLOSE, data[:2])
+                    break
+                if op == OP_PING:
+                    self.send_frame(OP_PONG, data)
+                elif op == OP_PONG:
+                    self.pong_event.set()
+                elif op == OP_TEXT:
+                    self.on_message(json.loads(data))
+        except (ConnectionError, OSError, ValueError) as e:
+            log(f"{self.addr[0]}: {e}")
+        finally:
+            self.server.drop(self)
+            self.sock.close()
+
+    def on_message(self, msg):
+        kind = msg.get("type")
+        if kind == "auth":
+            if msg.get("access_token") == self.server.token:
+                self.send_json({"type": "auth_ok", "ha_version": "standin"})
+            else:
+                self.send_json({"type": "auth_invalid", "message": "Invalid access token or password"})
+                raise ConnectionError("bad token")
+        elif kind == "subscribe_entities":
+            wanted = set(msg.get("entity_ids") or self.server.states.keys())
+            self.send_json({"id": msg["id"], "type": "result", "success": True, "result": None})
+            with self.server.lock:
+                snapshot = {e: self.server.compressed(e) for e in wanted if e in self.server.states}
+                self.subscription = (msg["id"], wanted)
+            self.send_json({"id": msg["id"], "type": "event", "event": {"a": snapshot}})
+            log(f"{self.addr[0]}: subscribed to {len(wanted)} entities")
+            if self.server.scenario:
+                threading.Thread(target=self.server.run_scenario, args=(self,), daemon=True).start()
+        elif kind == "ping":
+            self.send_json({"id": msg["id"], "type": "pong"})
+        else:
+            self.send_json({"id": msg.get("id"), "type": "result", "success": False,
+                            "error": {"code": "unknown_command", "message": "Unknown command."}})
+
+    def push(self, entity, event, fragments=1):
+        sub = self.subscription
+        if not sub or entity not in sub[1]:
+            return
+        text = json.dumps({"id": sub[0], "type": "event", "event": event}, separators=(",", ":")).encode()
+        if fragments <= 1:
+            self.send_frame(OP_TEXT, text)
+            return
+        # Fragmented, with a WebSocket ping between the first two fragments
+        size = len(text) // fragments + 1
+        parts = [text[i:i + size] for i in range(0, len(text), size)]
+        self.pong_event.clear()
+        for i, part in enumerate(parts):
+            self.send_frame(OP_TEXT if i == 0 else OP_CONT, part, fin=i == len(parts) - 1)
+            if i == 0:
+                self.send_frame(OP_PING, b"standin")
+
+
+class Server:
+    def __init__(self, token, scenario):
+        self.token = token
+        self.scenario = scenario
+        self.lock = threading.Lock()
+        self.states = {k: {"s": v["s"], "a": dict(v["a"]), "lc": time.time()} for k, v in INITIAL_STATES.items()}
+        self.clients = []
+
+    def compressed(self, entity):
+        st = self.states[entity]
+        return {"s": st["s"], "a": st["a"], "c": "standin", "lc": st["lc"]}
+
+    def drop(self, client):
+        with self.lock:
+            if client in self.clients:
+                self.clients.remove(client)
+
+    def broadcast(self, entity, event, fragments=1):
+        with self.lock:
+            clients = list(self.clients)
+        for c in clients:
+            try:
+                c.push(entity, event, fragments)
+            except OSError:
+                pass
+
+    # --- state changes ---------------------------------------------------
+
+    def set_state(self, entity, state, attrs=None, fragments=1):
+        now = time.time()
+        with self.lock:
+            if entity not in self.states:
+                self.states[entity] = {"s": state, "a": dict(attrs or {}), "lc": now}
+                event = {"a": {entity: self.compressed(entity)}}
+            else:
+                st = self.states[entity]
+                plus = {"c": "standin", "lu": now}
+                if state is not None and state != st["s"]:
+                    st["s"] = state
+                    st["lc"] = now
+                    plus["s"] = state
+                    plus["lc"] = now
+                if attrs:
+                    st["a"].update(attrs)
+                    plus["a"] = attrs
+                event = {"c": {entity: {"+": plus}}}
+        self.broadcast(entity, event, fragments)
+
+    def unset_attrs(self, entity, names):
+        with self.lock:
+            for n in names:
+                self.states.get(entity, {"a": {}})["a"].pop(n, None)
+        self.broadcast(entity, {"c": {entity: {"-": {"a": names}}}})
+
+    def remove(self, entity):
+        with self.lock:
+            self.states.pop(entity, None)
+        self.broadcast(entity, {"r": [entity]})
+
+    def command(self, line):
+        words = line.split()
+        if not words:
+            return True
+        cmd, args = words[0], words[1:]
+        attrs = {}
+        for a in args[2:] if cmd == "set" else args[1:]:
+            if "=" in a:
+                k, v = a.split("=", 1)
+                attrs[k] = parse_value(v)
+        if cmd == "set" and len(args) >= 2:
+            self.set_state(args[0], args[1], attrs)
+        elif cmd == "attr" and args:
+            self.set_state(args[0], None, attrs)
+        elif cmd == "unset" and len(args) >= 2:
+            self.unset_attrs(args[0], args[1:])
+        elif cmd == "del" and args:
+            self.remove(args[0])
+        elif cmd == "quit":
+            return False
+        else:
+            log(f"unknown command: {line.strip()}")
+        return True
+
+    def run_scenario(self, client):
+        """Scripted sequence checked by scripts/ha_ws_test.cpp"""
+        steps = [
+            lambda: self.set_state("person.alice", "not_home"),
+            lambda: self.set_state("weather.forecast_home", None, {"temperature": 19.0, "humidity": 55}),
+            lambda: self.set_state("light.porch", "on"),        # Not subscribed, never sent
+            lambda: self.set_state("person.bob", "home", {"friendly_name": "Bob " + "x" * 300}, fragments=3),
+            lambda: self.unset_attrs("weather.forecast_home", ["temperature"]),
+            lambda: self.remove("person.bob"),
+            lambda: self.set_state("person.bob", "home", {"friendly_name": "Bob"}),
+        ]
+        for step in steps:
+            time.sleep(0.1)
+            step()
+        # Answering the ping between the fragments is required
+        if client.pong_event.wait(2.0):
+            self.set_state("calendar.family", "on", {"friendly_name": "Family"})
+        else:
+            client.send_frame(OP_CLOSE, struct.pack(">H", 1002) + b"no pong")
+
+    def serve(self, port):
+        listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        listener.bind(("0.0.0.0", port))
+        listener.listen(4)
+        log(f"listening on port {port}")
+        while True:
+            sock, addr = listener.accept()
+            sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            client = Client(self, sock, addr)
+            with self.lock:
+                self.clients.append(client)
+            threading.Thread(target=client.run, daemon=True).start()
+
+
+def log(text):
+    print(f"[standin] {text}", file=sys.stderr, flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("--port", type=int, default=8123)
+    parser.add_argument("--token", default="test-token")
+    parser.add_argument("--scenario", action="store_true", help="scripted changes instead of stdin")
+    args = parser.parse_args()
+
+    server = Server(args.token, args.scenario)
+    threading.Thread(target=server.serve, args=(args.port,), daemon=True).start()
+
+    if args.scenario:
+        while True:
+            time.sleep(1)
+    for line in sys.stdin:
+        if not server.command(line):
+            break
+
+
+if __name__ == "__main__":
+    main()
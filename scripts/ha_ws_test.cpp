@@ -0,0 +1,307 @@
+// Host test for the HA WebSocket client against scripts/ha_ws_standin.py
+//
+// Starts the stand-in server in scenario mode and connects to it over TCP.
+// The socket is read in small random chunks so frame headers and payloads
+// arrive split at arbitrary points. The connection is driven through the same
+// layers the device uses (handshake check, WsDecoder, HASession,
+// HAStateCache). The test checks:
+//   - authentication, then a live subscription to four entities
+//   - the snapshot values
+//   - each diff in the scenario: state change, attribute change, attribute
+//     removal, entity removal and re-add, and a message fragmented around a
+//     WebSocket ping that must be answered
+//   - that the HA keep-alive ping gets its pong
+//   - that a wrong token ends in auth_invalid
+// It also reports push latency: HA's last_changed against the time the
+// change is applied.
+//
+// Build and run (from the repository root):
+//   g++ -std=c++17 -O2 -Iinclude scripts/ha_ws_test.cpp src/ha_websocket.cpp -o ha_ws_test
+//   ./ha_ws_test [port]
+//
+// Needs python3. Exits non-zero if any check fails.
+
+#include "ha_websocket.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) failures++;
+}
+
+static uint32_t nowMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static double epochSeconds() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+struct Connection {
+    int fd = -1;
+    WsDecoder decoder;
+    HASession session;
+    bool closed = false;
+    uint32_t pingsAnswered = 0;
+    uint32_t clockOffset = 0;       // Added to the clock to fast-forward keep-alive
+    double latencySum = 0;
+    double latencyMax = 0;
+    int latencyCount = 0;
+
+    uint32_t now() const { return nowMs() + clockOffset; }
+
+    bool sendFrame(WsOpcode op, const uint8_t* data, size_t len) {
+        std::string frame(len + 14, '\0');
+        uint8_t mask[4] = { (uint8_t)rand(), (uint8_t)rand(), (uint8_t)rand(), (uint8_t)rand() };
+        size_t n = wsEncodeFrame(op, data, len, mask, (uint8_t*)&frame[0], frame.size());
+        return n && send(fd, frame.data(), n, MSG_NOSIGNAL) == (ssize_t)n;
+    }
+
+    static bool sendText(const char* text, size_t len, void* ctx) {
+        return ((Connection*)ctx)->sendFrame(WS_OP_TEXT, (const uint8_t*)text, len);
+    }
+
+    static void onFrame(WsOpcode op, const uint8_t* data, size_t len, void* ctx) {
+        Connection* c = (Connection*)ctx;
+        if (op == WS_OP_TEXT) {
+            if (!c->session.onMessage((const char*)data, len, c->now())) c->closed = true;
+        } else if (op == WS_OP_PING) {
+            c->sendFrame(WS_OP_PONG, data, len);
+            c->pingsAnswered++;
+        } else if (op == WS_OP_CLOSE) {
+            c->closed = true;
+        }
+    }
+
+    bool open(uint16_t port, const char* token) {
+        session.begin(token, sendText, this);
+        session.getCache().addEntity("person.alice");
+        session.getCache().addEntity("person.bob");
+        session.getCache().addEntity("weather.forecast_home");
+        session.getCache().addEntity("calendar.family");
+        session.getCache().watchAttribute("friendly_name");
+        session.getCache().watchAttribute("temperature");
+        decoder.setHandler(onFrame, this);
+
+        // The stand-in may still be starting
+        for (int attempt = 0; attempt < 50; attempt++) {
+            fd = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(port);
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0) break;
+            close(fd);
+            fd = -1;
+            usleep(100000);
+        }
+        if (fd < 0) return false;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        uint8_t nonce[16];
+        for (uint8_t& b : nonce) b = (uint8_t)rand();
+        char key[25];
+        wsMakeKey(nonce, key);
+        char request[256];
+        size_t len = wsBuildHandshake("127.0.0.1", port, "/api/websocket", key, request, sizeof(request));
+        send(fd, request, len, MSG_NOSIGNAL);
+
+        // Headers byte by byte, auth_required may follow in the same segment
+        char response[512];
+        size_t n = 0;
+        while (n + 1 < sizeof(response)) {
+            if (recv(fd, &response[n], 1, 0) != 1) return false;
+            n++;
+            if (n >= 4 && memcmp(response + n - 4, "\r\n\r\n", 4) == 0) break;
+        }
+        response[n] = '\0';
+        session.reset(now());
+        return wsCheckHandshake(response, key);
+    }
+
+    // Read and apply for up to `ms`, in random chunks of 1..64 bytes
+    void pump(uint32_t ms) {
+        uint32_t end = nowMs() + ms;
+        while (!closed && (int32_t)(end - nowMs()) > 0) {
+            pollfd p = { fd, POLLIN, 0 };
+            if (poll(&p, 1, 10) > 0) {
+                uint8_t buf[64];
+                ssize_t r = recv(fd, buf, 1 + rand() % sizeof(buf), 0);
+                if (r <= 0) {
+                    closed = true;
+                    break;
+                }
+                if (!decoder.feed(buf, r)) {
+                    printf("     decoder error\n");
+                    closed = true;
+                }
+            }
+            if (!session.poll(now())) {
+                closed = true;
+            }
+        }
+    }
+
+    // Every change applied so far, in order
+    HAEntityState log[64];
+    int logged = 0;
+    double seenLc[HA_WS_MAX_ENTITIES] = {};
+
+    // Pump in 5 ms slices, logging changes as they are applied. Latency is
+    // sampled when last_changed moves: HA's timestamp against now.
+    void collect(uint32_t ms) {
+        uint32_t end = nowMs() + ms;
+        while (!closed && (int32_t)(end - nowMs()) > 0) {
+            pump(5);
+            HAEntityState s;
+            while (session.getCache().popChanged(s)) {
+                for (size_t i = 0; i < session.getCache().getEntityCount(); i++) {
+                    if (strcmp(session.getCache().getEntityId(i), s.entityId) != 0) continue;
+                    if (seenLc[i] != 0 && s.lastChanged > seenLc[i]) {
+                        double lat = (epochSeconds() - s.lastChanged) * 1000.0;
+                        latencySum += lat;
+                        latencyCount++;
+                        if (lat > latencyMax) latencyMax = lat;
+                    }
+                    seenLc[i] = s.lastChanged;
+                }
+                if (logged < 64) log[logged++] = s;
+            }
+        }
+    }
+
+    void shutdown() {
+        if (fd >= 0) {
+            uint8_t code[2] = { 0x03, 0xe8 };   // 1000
+            sendFrame(WS_OP_CLOSE, code, 2);
+            close(fd);
+            fd = -1;
+        }
+    }
+};
+
+static void unitChecks() {
+    // RFC 6455 section 1.3 example
+    char accept[29];
+    wsAcceptFor("dGhlIHNhbXBsZSBub25jZQ==", accept);
+    check(strcmp(accept, "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") == 0, "accept value matches RFC 6455 example");
+
+    // Masked frames round-trip through a server-side unmask
+    uint8_t frame[300];
+    uint8_t payload[200];
+    for (int i = 0; i < 200; i++) payload[i] = (uint8_t)i;
+    uint8_t mask[4] = { 1, 2, 3, 4 };
+    size_t n = wsEncodeFrame(WS_OP_TEXT, payload, 200, mask, frame, sizeof(frame));
+    bool ok = n == 208 && frame[0] == 0x81 && frame[1] == (0x80 | 126) && frame[2] == 0 && frame[3] == 200;
+    for (int i = 0; i < 200 && ok; i++) ok = (frame[8 + i] ^ mask[i & 3]) == payload[i];
+    check(ok, "client frames use the 16-bit length form and are masked");
+
+    // Masked server frames are a protocol error
+    WsDecoder d;
+    check(!d.feed(frame, n), "masked server frame rejected");
+
+    // Diffs for entities we did not subscribe to are ignored
+    HAStateCache cache;
+    cache.addEntity("person.alice");
+    const char* event = "{\"a\":{\"person.alice\":{\"s\":\"home\",\"a\":{}},\"light.x\":{\"s\":\"on\",\"a\":{}}}}";
+    check(cache.apply(event, strlen(event), 0) == 1 && cache.getIgnored() == 1, "unsubscribed entity ignored");
+    const char* same = "{\"c\":{\"person.alice\":{\"+\":{\"lu\":5.0,\"c\":\"x\"}}}}";
+    HAEntityState s;
+    cache.popChanged(s);
+    check(cache.apply(same, strlen(same), 0) == 0 && !cache.popChanged(s), "context-only update is not a change");
+}
+
+int main(int argc, char** argv) {
+    uint16_t port = argc > 1 ? (uint16_t)atoi(argv[1]) : 18123;
+    srand((unsigned)time(nullptr));
+
+    unitChecks();
+
+    char portArg[8];
+    snprintf(portArg, sizeof(portArg), "%u", port);
+    pid_t server = fork();
+    if (server == 0) {
+        execlp("python3", "python3", "scripts/ha_ws_standin.py", "--port", portArg, "--token", "secret",
+               "--scenario", (char*)nullptr);
+        perror("python3");
+        _exit(127);
+    }
+
+    static Connection c;
+    check(c.open(port, "secret"), "handshake accepted");
+
+    // Snapshot, then the scripted changes 100 ms apart
+    c.collect(1500);
+    check(c.session.isLive(), "authenticated and subscribed");
+    const HAEntityState* log = c.log;
+    int n = c.logged;
+    for (int i = 0; i < n; i++) {
+        printf("     %-22s %-9s %-12.12s %s\n", log[i].entityId, log[i].known ? log[i].state : "(removed)",
+               log[i].attrs[0], log[i].attrs[1]);
+    }
+    auto is = [&](int i, const char* id, const char* state) {
+        return i < n && strcmp(log[i].entityId, id) == 0 && strcmp(log[i].state, state) == 0;
+    };
+    bool snapshot = n >= 4;
+    for (int i = 0; i < 4 && snapshot; i++) {
+        const HAEntityState& e = log[i];
+        if (strcmp(e.entityId, "person.alice") == 0) snapshot = is(i, "person.alice", "home") && !strcmp(e.attrs[0], "Alice");
+        if (strcmp(e.entityId, "weather.forecast_home") == 0) snapshot = !strcmp(e.attrs[1], "21.5");
+    }
+    check(snapshot, "snapshot: four entities, alice home, weather 21.5");
+    check(is(4, "person.alice", "not_home"), "alice left");
+    check(is(5, "weather.forecast_home", "sunny") && !strcmp(log[5].attrs[1], "19.0"),
+          "temperature diff applied, state kept");
+    check(is(6, "person.bob", "home") && !strncmp(log[6].attrs[0], "Bob xxx", 7) &&
+          strlen(log[6].attrs[0]) == HA_WS_ATTR_LEN - 1,
+          "fragmented message reassembled (unsubscribed change never delivered)");
+    check(c.pingsAnswered == 1, "ping between fragments answered");
+    check(is(7, "weather.forecast_home", "sunny") && log[7].attrs[1][0] == '\0', "attribute removal applied");
+    check(n > 8 && !strcmp(log[8].entityId, "person.bob") && !log[8].known, "entity removal applied");
+    check(is(9, "person.bob", "home") && log[9].known && !strcmp(log[9].attrs[0], "Bob"), "entity re-added");
+    check(!c.closed && is(10, "calendar.family", "on"), "stand-in confirmed the pong");
+
+    // Keep-alive: fast-forward past the idle interval
+    c.clockOffset = HA_WS_PING_MS + 1000;
+    c.pump(200);
+    check(!c.closed && c.session.getPings() == 1 && c.session.isLive(), "keep-alive ping answered");
+
+    printf("\nmessages %u, events %u, changes %u, push latency avg %.1f ms, max %.1f ms\n",
+           c.session.getMessages(), c.session.getCache().getEvents(), c.session.getCache().getChanges(),
+           c.latencyCount ? c.latencySum / c.latencyCount : 0.0, c.latencyMax);
+    check(c.latencyCount >= 3 && c.latencyMax < 100.0, "every state change applied within 100 ms of last_changed");
+    c.shutdown();
+
+    static Connection bad;
+    check(bad.open(port, "wrong"), "second handshake accepted");
+    bad.pump(300);
+    check(bad.session.getState() == HA_SESSION_FAILED && strstr(bad.session.getError(), "auth_invalid"),
+          "wrong token ends in auth_invalid");
+    bad.shutdown();
+
+    kill(server, SIGTERM);
+    waitpid(server, nullptr, 0);
+
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,155 @@
+// Host test for the intent cache (LRU order, invalidation, persistence)
+//
+// Fills an IntentCache past its capacity and checks that the least recently
+// used entry is evicted and that a hit protects an entry. Changing the
+// commands or entity fingerprint must drop everything, while an unknown (0)
+// fingerprint must not. A serialized cache must load back with its entries,
+// recency order and fingerprints, and a damaged image must be rejected.
+// Also checks that the entity index fingerprint does not depend on refresh
+// order but does change when an entity is renamed or removed.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Iinclude scripts/intent_cache_test.cpp src/intent_cache.cpp src/entity_index.cpp src/command_engine.cpp -o intent_cache_test
+//
+// Exits non-zero if any check fails.
+
+#include "intent_cache.h"
+#include "entity_index.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) failures++;
+}
+
+static CommandMatch matchFor(int command) {
+    CommandMatch m;
+    memset(&m, 0, sizeof(m));
+    m.command = command;
+    m.confidence = 1.0f;
+    return m;
+}
+
+static void keyFor(int i, char* key, size_t size) {
+    snprintf(key, size, "phrase number %d", i);
+}
+
+int main() {
+    static IntentCache cache;
+    char key[64];
+    CommandMatch m;
+    uint32_t cost = 0;
+
+    // Not ready until both fingerprints are known
+    cache.validate(0x1111, 0);
+    check(!cache.insert("open gate", matchFor(1), 500), "insert ignored while entities are unknown");
+    cache.validate(0x1111, 0x2222);
+    check(cache.insert("open gate", matchFor(1), 500), "insert accepted once both are known");
+    check(cache.lookup("open gate", m, &cost) && m.command == 1 && cost == 500, "hit returns match and cost");
+    check(!cache.lookup("close gate", m), "miss");
+
+    // LRU eviction
+    size_t before = allocations;
+    cache.clear();
+    for (int i = 0; i < INTENT_CACHE_SIZE; i++) {
+        keyFor(i, key, sizeof(key));
+        cache.insert(key, matchFor(i), 100 + i);
+    }
+    check(cache.size() == INTENT_CACHE_SIZE, "filled to capacity");
+    keyFor(0, key, sizeof(key));
+    cache.lookup(key, m);                                   // 0 is now most recent, 1 is oldest
+    keyFor(INTENT_CACHE_SIZE, key, sizeof(key));
+    cache.insert(key, matchFor(INTENT_CACHE_SIZE), 1);
+    keyFor(1, key, sizeof(key));
+    bool evicted = !cache.lookup(key, m);
+    keyFor(0, key, sizeof(key));
+    bool kept = cache.lookup(key, m) && m.command == 0;
+    check(evicted && kept && cache.getStats().evictions == 1, "least recently used evicted, recent hit kept");
+    keyFor(5, key, sizeof(key));
+    cache.insert(key, matchFor(50), 7);
+    check(cache.size() == INTENT_CACHE_SIZE && cache.lookup(key, m) && m.command == 50,
+          "re-insert updates in place");
+    check(allocations == before, "no allocations");
+
+    // Persistence
+    static uint8_t image[sizeof(IntentCache)];
+    size_t len = cache.serialize(image, sizeof(image));
+    check(len == cache.serializedSize() && !cache.isDirty(), "serialized");
+    static IntentCache restored;
+    check(restored.load(image, len) && restored.size() == cache.size(), "loaded back");
+    keyFor(2, key, sizeof(key));
+    check(restored.lookup(key, m, &cost) && m.command == 2 && cost == 102, "entry survives");
+    // 3 is the least recently used in both
+    keyFor(INTENT_CACHE_SIZE + 1, key, sizeof(key));
+    restored.insert(key, matchFor(99), 1);
+    keyFor(3, key, sizeof(key));
+    check(!restored.lookup(key, m), "recency order survives");
+    check(!restored.validate(0x1111, 0) && restored.size() == INTENT_CACHE_SIZE,
+          "restored cache kept while entities are still unknown");
+    check(!restored.validate(0x1111, 0x2222) && restored.size() == INTENT_CACHE_SIZE,
+          "restored cache kept when fingerprints match");
+
+    image[len - 1] ^= 0xff;
+    static IntentCache damaged;
+    check(!damaged.load(image, len - 1) && damaged.size() == 0, "truncated image rejected");
+    image[0] ^= 0xff;
+    check(!damaged.load(image, len) && damaged.size() == 0, "foreign image rejected");
+
+    // Invalidation
+    check(cache.validate(0x1111, 0x3333) && cache.size() == 0, "entity change drops the cache");
+    cache.insert("open gate", matchFor(1), 500);
+    check(cache.validate(0x4444, 0x3333) && cache.size() == 0, "commands change drops the cache");
+    cache.insert("open gate", matchFor(1), 500);
+    check(!cache.validate(0x4444, 0) && cache.size() == 1, "unknown fingerprint is not a change");
+
+    // Entity fingerprint
+    EntityIndex a, b;
+    a.beginRefresh();
+    a.upsert("light.porch", "Porch Light", "Outside");
+    a.upsert("cover.garage_door", "Garage Door", "Garage");
+    a.endRefresh();
+    b.beginRefresh();
+    b.upsert("cover.garage_door", "Garage Door", "Garage");
+    b.upsert("light.porch", "Porch Light", "Outside");
+    b.endRefresh();
+    uint32_t fp = a.getFingerprint();
+    check(fp == b.getFingerprint(), "entity fingerprint independent of order");
+    b.beginRefresh();
+    b.upsert("cover.garage_door", "Garage Door", "Garage");
+    b.upsert("light.porch", "Front Porch Light", "Outside");
+    b.endRefresh();
+    check(b.getFingerprint() != fp, "rename changes the fingerprint");
+    b.beginRefresh();
+    b.upsert("light.porch", "Porch Light", "Outside");
+    b.endRefresh();
+    a.beginRefresh();
+    a.upsert("light.porch", "Porch Light", "Outside");
+    a.endRefresh();
+    check(b.getFingerprint() == a.getFingerprint() && a.getFingerprint() != fp,
+          "removal changes it, same contents agree again");
+
+    const IntentCacheStats& st = cache.getStats();
+    printf("\nhits %u, misses %u, inserts %u, evictions %u, invalidations %u, entry %u bytes\n",
+           st.hits, st.misses, st.inserts, st.evictions, st.invalidations,
+           (unsigned)((sizeof(IntentCache) - sizeof(IntentCacheStats)) / INTENT_CACHE_SIZE));
+
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,221 @@
+// Host test for the job scheduler (priorities, cadence, jitter, overruns)
+//
+// Drives JobScheduler with a simulated millisecond clock. It checks that due
+// jobs come out highest class first, and that fetch jobs wait while the
+// worker is busy. A job must keep its cadence, with jitter spreading
+// same-period jobs within their window. Missed periods are skipped and
+// counted, and long runs count as overruns. trigger() must run a job early,
+// or once more right after a running one. Also checks millis() wrap-around,
+// heap order against a brute-force reference and that nothing allocates.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Iinclude scripts/job_scheduler_test.cpp src/job_scheduler.cpp -o job_scheduler_test
+//
+// Exits non-zero if any check fails.
+
+#include "job_scheduler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static void noop(void*) {}
+
+static JobSpec spec(const char* name, JobClass cls, uint32_t periodMs, uint32_t jitterMs = 0, uint32_t budgetMs = 0) {
+    JobSpec s = { name, cls, periodMs, jitterMs, budgetMs, noop, nullptr, nullptr };
+    return s;
+}
+
+// Poll every millisecond from `from` to `to`; run each due job for runMs.
+// Returns how often job `id` started, and the start times in `starts`.
+static int simulate(JobScheduler& s, int id, uint32_t from, uint32_t to, uint32_t runMs,
+                    uint32_t* starts = nullptr, int maxStarts = 0) {
+    int n = 0;
+    for (uint32_t now = from; now != to; now++) {
+        int j;
+        while ((j = s.next(now)) >= 0) {
+            if (j == id) {
+                if (starts && n < maxStarts) starts[n] = now;
+                n++;
+            }
+            s.finish(j, now, runMs * 1000);
+        }
+    }
+    return n;
+}
+
+static void testPriority() {
+    JobScheduler s;
+    int fetch = s.add(spec("fetch", JOB_FETCH, 1000), 0, 0);
+    int telemetry = s.add(spec("telemetry", JOB_TELEMETRY, 1000), 0, 0);
+    int ui = s.add(spec("ui", JOB_UI, 1000), 0, 0);
+    int voice = s.add(spec("voice", JOB_VOICE, 1000), 0, 0);
+
+    check(s.next(0, false) == voice, "voice first");
+    check(s.next(0, false) == ui, "then UI");
+    check(s.next(0, false) == telemetry, "then telemetry");
+    check(s.next(0, false) == -1, "fetch waits for the worker");
+    check(s.next(0, true) == fetch, "fetch once the worker is free");
+    check(s.next(0, true) == -1, "nothing else due");
+    check(s.isRunning(fetch) && s.isRunning(voice), "popped jobs are running");
+
+    // Earliest due first within a class
+    JobScheduler t;
+    int late = t.add(spec("late", JOB_UI, 1000), 0, 30);
+    int early = t.add(spec("early", JOB_UI, 1000), 0, 10);
+    check(t.next(5) == -1, "not due yet");
+    check(t.nextDue(5) == 5, "next due in 5 ms");
+    check(t.next(40) == early && t.next(40) == late, "earliest due first");
+    check(t.nextDue(40) == UINT32_MAX, "empty while running");
+}
+
+static void testCadence() {
+    JobScheduler s;
+    int id = s.add(spec("tick", JOB_TELEMETRY, 100), 0, 0);
+    uint32_t starts[10];
+    int n = simulate(s, id, 0, 1000, 7, starts, 10);
+    check(n == 10, "ten runs in a second");
+    bool steady = true;
+    for (int i = 0; i < n && i < 10; i++) {
+        steady &= starts[i] == (uint32_t)i * 100;
+    }
+    check(steady, "cadence kept despite 7 ms runs");
+    check(s.getStats(id).runs == 10 && s.getStats(id).skipped == 0, "runs counted, none skipped");
+    check(s.getStats(id).maxUs == 7000 && s.getStats(id).totalUs == 70000, "run time stats");
+}
+
+static void testJitter() {
+    JobScheduler s;
+    s.seed(12345);
+    int a = s.add(spec("a", JOB_FETCH, 1000, 200), 0, 0);
+    int b = s.add(spec("b", JOB_FETCH, 1000, 200), 0, 0);
+    uint32_t startsA[20], startsB[20];
+    int na = 0, nb = 0;
+    bool inWindow = true;
+    for (uint32_t now = 0; now < 20000; now++) {
+        int j;
+        while ((j = s.next(now)) >= 0) {
+            uint32_t slot = now / 1000 * 1000;
+            inWindow &= now - slot <= 200;
+            if (j == a && na < 20) startsA[na++] = now;
+            if (j == b && nb < 20) startsB[nb++] = now;
+            s.finish(j, now, 0);
+        }
+    }
+    check(na == 20 && nb == 20, "jittered jobs run once per period");
+    check(inWindow, "starts stay within period + jitter");
+    int same = 0;
+    for (int i = 0; i < 20; i++) {
+        same += startsA[i] == startsB[i];
+    }
+    check(same < 5, "same-period jobs do not fire in lock-step");
+}
+
+static void testSkipAndOverrun() {
+    JobScheduler s;
+    int id = s.add(spec("slow", JOB_TELEMETRY, 100, 0, 10), 0, 0);
+    check(s.next(0) == id, "first run");
+    s.finish(id, 0, 5000);
+    check(s.next(99) == -1 && s.next(350) == id, "late poll runs once");
+    s.finish(id, 350, 15000);
+    const JobStats& st = s.getStats(id);
+    check(st.skipped == 2, "two missed periods skipped");
+    check(st.maxLateMs == 250, "lateness recorded");
+    check(st.overruns == 1, "15 ms run over a 10 ms budget");
+    check(s.nextDue(365) == 35, "back on the 100 ms grid");
+}
+
+static void testTrigger() {
+    JobScheduler s;
+    int id = s.add(spec("calendar", JOB_FETCH, 1000), 0, 1000);
+    s.trigger(id, 10);
+    check(s.next(10) == id, "triggered job runs at once");
+
+    // Triggered again while running: once more right after
+    s.trigger(id, 20);
+    s.finish(id, 10, 30000);
+    check(s.next(40) == id, "rerun right after the running one");
+    s.finish(id, 40, 1000);
+    check(s.next(999) == -1 && s.next(2000) == id, "then back to the period");
+    check(s.getStats(id).triggered == 2, "triggers counted");
+
+    // One-shot: only runs when triggered
+    int once = s.add(spec("once", JOB_UI, 0), 0, 5000);
+    check(s.next(5000) == once, "one-shot runs at its time");
+    s.finish(once, 5000, 0);
+    check(s.nextDue(5001) > 10000, "one-shot not rescheduled");
+    s.trigger(once, 6000);
+    check(s.next(6000) == once, "one-shot triggered again");
+}
+
+static void testWrap() {
+    JobScheduler s;
+    uint32_t start = 0xFFFFFF00u;
+    int id = s.add(spec("wrap", JOB_UI, 100), start, 0);
+    int n = simulate(s, id, start, start + 1000, 1);
+    check(n == 10, "ten runs across the millis() wrap");
+}
+
+static void testHeapOrder() {
+    JobScheduler s;
+    s.seed(99);
+    int ids[JOB_MAX];
+    for (int i = 0; i < JOB_MAX; i++) {
+        ids[i] = s.add(spec("x", JOB_UI, 50 + i * 37, 40), 0, (i * 7919) % 300);
+    }
+    check(s.add(spec("full", JOB_UI, 10), 0, 0) == -1, "table full");
+
+    bool ordered = true;
+    for (uint32_t now = 0; now < 20000; now += 3) {
+        int j;
+        while ((j = s.next(now)) >= 0) {
+            s.finish(j, now, (now % 5) * 1000);
+        }
+        ordered &= s.nextDue(now) > 0;
+        if (now % 997 == 0) {
+            s.trigger(ids[now % JOB_MAX], now);
+        }
+    }
+    check(ordered, "every due job popped in the same pass");
+    bool ran = true;
+    for (int i = 0; i < JOB_MAX; i++) {
+        ran &= (int)s.getStats(ids[i]).runs >= 20000 / (50 + i * 37 + 40) - 1;
+    }
+    check(ran, "each job ran about once per period");
+}
+
+int main() {
+    size_t before = allocations;
+    testPriority();
+    testCadence();
+    testJitter();
+    testSkipAndOverrun();
+    testTrigger();
+    testWrap();
+    testHeapOrder();
+    check(allocations == before, "no allocation");
+
+    printf("%s (%d failure%s)\n", failures ? "FAILED" : "OK", failures, failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}
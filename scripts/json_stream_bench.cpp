@@ -0,0 +1,443 @@
+// Host test and benchmark for the streaming JSON parser
+//
+// Checks path matching, escapes, truncation, invalid documents and that
+// splitting the input at every byte gives the same result. Then parses a
+// large /api/states response and a calendar listing two ways:
+//
+//   full body   the whole response in one buffer (what http.getString()
+//               did), then scanned for "entity_id":"stt. as before
+//   streamed    JsonStreamParser fed in HTTP_DOWNLOAD_UNIT_SIZE pieces, as
+//               HARequest::readJson() does
+//
+// and reports parse time and peak heap. The peak is measured by counting
+// every operator new/malloc on the host. A JsonDocument built from the full
+// body (the other old path) would cost several times the body on top; it is
+// not reproduced here because ArduinoJson is a device dependency.
+//
+// Without arguments the payloads are synthetic: 1500 entities with
+// realistic attributes (about 900 KB), and 60 calendar events. Recorded
+// payloads can be given instead:
+//
+//   curl -H "Authorization: Bearer $TOKEN" http://ha:8123/api/states > states.json
+//   curl -H "Authorization: Bearer $TOKEN" "http://ha:8123/api/calendars/calendar.family?start=2026-01-01&end=2026-02-01" > calendar.json
+//   ./json_stream_bench states.json calendar.json
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Iinclude scripts/json_stream_bench.cpp src/json_stream.cpp -o json_stream_bench
+//
+// Exits non-zero if a check fails, the two paths disagree, or streaming
+// allocates.
+
+#include "json_stream.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+
+#define CHUNK_SIZE  1436        // HTTP_DOWNLOAD_UNIT_SIZE in platformio.ini
+#define RUNS        20
+
+// ============================================
+// Heap accounting
+// ============================================
+static size_t heapNow = 0;
+static size_t heapPeak = 0;
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    size_t* p = (size_t*)malloc(size + sizeof(size_t));
+    if (!p) throw std::bad_alloc();
+    *p = size;
+    heapNow += size;
+    allocations++;
+    if (heapNow > heapPeak) heapPeak = heapNow;
+    return p + 1;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    size_t* p = (size_t*)ptr - 1;
+    heapNow -= *p;
+    free(p);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+static void resetPeak() {
+    heapPeak = heapNow;
+    allocations = 0;
+}
+
+// ============================================
+// Checks
+// ============================================
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) failures++;
+}
+
+// Every value as "path=value" lines, the path rebuilt from the parser
+struct Collect {
+    std::string out;
+    int closes = 0;
+};
+
+static void collectValue(JsonStreamParser& p, JsonStreamType type, const char* value, size_t len, void* ctx) {
+    Collect& c = *(Collect*)ctx;
+    for (int level = 0; level < p.getDepth(); level++) {
+        if (p.isArray(level)) {
+            c.out += "[" + std::to_string(p.getIndex(level)) + "]";
+        } else {
+            c.out += std::string(".") + p.getKey(level);
+        }
+    }
+    c.out += "=";
+    c.out += type == JSON_STREAM_STRING ? "s:" : type == JSON_STREAM_NUMBER ? "n:" : type == JSON_STREAM_BOOL ? "b:" : "z:";
+    c.out.append(value, len);
+    c.out += "\n";
+}
+
+static void collectClose(JsonStreamParser&, void* ctx) {
+    ((Collect*)ctx)->closes++;
+}
+
+static bool parseAll(const char* json, Collect& c, size_t step = 0) {
+    JsonStreamParser p;
+    p.begin(collectValue, collectClose, &c);
+    size_t len = strlen(json);
+    if (step == 0) {
+        p.feed(json, len);
+    } else {
+        for (size_t i = 0; i < len; i += step) {
+            p.feed(json + i, len - i < step ? len - i : step);
+        }
+    }
+    return p.finish();
+}
+
+static bool valid(const char* json) {
+    Collect c;
+    return parseAll(json, c);
+}
+
+struct MatchProbe {
+    const char* pattern;
+    std::string seen;
+};
+
+static void probeValue(JsonStreamParser& p, JsonStreamType, const char* value, size_t, void* ctx) {
+    MatchProbe& m = *(MatchProbe*)ctx;
+    if (p.match(m.pattern)) {
+        if (!m.seen.empty()) m.seen += ",";
+        m.seen += value;
+    }
+}
+
+static std::string matchAll(const char* json, const char* pattern) {
+    MatchProbe m = { pattern, "" };
+    JsonStreamParser p;
+    p.begin(probeValue, nullptr, &m);
+    p.feed(json, strlen(json));
+    p.finish();
+    return m.seen;
+}
+
+static void stopAtSecond(JsonStreamParser& p, JsonStreamType, const char*, size_t, void* ctx) {
+    if (++*(int*)ctx == 2) p.stop();
+}
+
+static void runChecks() {
+    const char* doc =
+        "{\"version\":\"2026.10.1\",\"n\":-1.5e3,\"ok\":true,\"none\":null,"
+        "\"list\":[{\"entity_id\":\"stt.whisper\",\"a\":{\"x\":[1,[2,3]]}},{\"entity_id\":\"light.k\"},[]],"
+        "\"esc\":\"q\\\"b\\\\s\\/n\\nt\\tu\\u00e4\\ud83d\\ude00\"}";
+
+    Collect c;
+    check(parseAll(doc, c), "document parses");
+    const char* expected =
+        ".version=s:2026.10.1\n.n=n:-1.5e3\n.ok=b:true\n.none=z:null\n"
+        ".list[0].entity_id=s:stt.whisper\n.list[0].a.x[0]=n:1\n.list[0].a.x[1][0]=n:2\n.list[0].a.x[1][1]=n:3\n"
+        ".list[1].entity_id=s:light.k\n"
+        ".esc=s:q\"b\\s/n\nt\tu\xc3\xa4\xf0\x9f\x98\x80\n";
+    check(c.out == expected, "paths, types and escapes");
+    if (c.out != expected) printf("%s", c.out.c_str());
+    check(c.closes == 8, "close handler per container");
+
+    bool same = true;
+    for (size_t step = 1; step <= 7; step++) {
+        Collect split;
+        same = same && parseAll(doc, split, step) && split.out == c.out;
+    }
+    check(same, "same result at any split");
+
+    check(matchAll(doc, "version") == "2026.10.1", "match top-level key");
+    check(matchAll(doc, "[*].version").empty() && matchAll(doc, "list").empty(), "depth must match");
+    check(matchAll(doc, "list[*].entity_id") == "stt.whisper,light.k", "match wildcard index");
+    check(matchAll(doc, "list[1].entity_id") == "light.k", "match fixed index");
+    check(matchAll(doc, ".list[0].a.x[1][*]") == "2,3", "match nested arrays");
+    check(matchAll("[\"a\",\"b\"]", "[*]") == "a,b" && matchAll("42", "") == "42", "root array and scalar");
+
+    // Truncation never splits a UTF-8 character
+    std::string longValue = "{\"k\":\"";
+    for (int i = 0; i < JSON_STREAM_VALUE_LEN; i++) longValue += "\xc3\xa4";
+    longValue += "\"}";
+    Collect t;
+    size_t kept = (JSON_STREAM_VALUE_LEN - 1) / 2 * 2;
+    check(parseAll(longValue.c_str(), t) && t.out == ".k=s:" + longValue.substr(6, kept) + "\n",
+          "long value truncated on a character boundary");
+    std::string longKey = std::string("{\"") + std::string(40, 'k') + "\":1,\"" + std::string(40, 'k') + "\":{\"v\":2}}";
+    check(matchAll(longKey.c_str(), (std::string(40, 'k') + ".v").c_str()).empty() &&
+          matchAll(longKey.c_str(), (std::string(JSON_STREAM_KEY_LEN - 1, 'k') + ".v").c_str()).empty(),
+          "truncated keys never match");
+
+    // Deeper than the tracked levels: parsed, not matched
+    std::string deep;
+    for (int i = 0; i < JSON_STREAM_MAX_DEPTH + 2; i++) deep += "[";
+    deep += "7";
+    for (int i = 0; i < JSON_STREAM_MAX_DEPTH + 2; i++) deep += "]";
+    check(valid(deep.c_str()), "untracked levels parse");
+    std::string tooDeep(JSON_STREAM_MAX_NESTING + 1, '[');
+    check(!valid(tooDeep.c_str()), "nesting limit");
+
+    int seen = 0;
+    JsonStreamParser p;
+    p.begin(stopAtSecond, nullptr, &seen);
+    p.feed("[1,2,3,", 7);
+    check(p.isStopped() && p.finish() && seen == 2, "stop from a handler");
+
+    const char* invalid[] = {
+        "", "{", "[1,]", "{\"a\"}", "{\"a\":1,}", "[1 2]", "{\"a\":tru}", "[nan]", "[0x10]",
+        "\"a\nb\"", "\"\\x\"", "\"\\u12g4\"", "[1]]", "{\"a\":1} x", "[}", "{]"
+    };
+    bool rejected = true;
+    for (const char* s : invalid) {
+        if (valid(s)) {
+            printf("     accepted: %s\n", s);
+            rejected = false;
+        }
+    }
+    check(rejected, "invalid documents rejected");
+    check(valid(" {\"a\" : [ ] , \"b\" : { } } \r\n") && valid("-0.5") && valid("[true,false,null]"),
+          "whitespace, empty containers and literals");
+}
+
+// ============================================
+// Payloads
+// ============================================
+static std::string readFile(const char* path) {
+    std::string s;
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        exit(2);
+    }
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) s.append(buf, n);
+    fclose(f);
+    return s;
+}
+
+static std::string syntheticStates() {
+    static const char* domains[] = { "light", "sensor", "switch", "binary_sensor", "automation", "cover", "media_player" };
+    std::string s = "[";
+    char buf[1024];
+    for (int i = 0; i < 1500; i++) {
+        const char* domain = domains[i % 7];
+        if (i == 700) domain = "stt";
+        if (i == 1400) domain = "stt";
+        snprintf(buf, sizeof(buf),
+            "%s{\"entity_id\":\"%s.device_%d\",\"state\":\"%s\",\"attributes\":{"
+            "\"friendly_name\":\"R\\u00e4um %d Device \\\"%d\\\"\",\"icon\":\"mdi:lightbulb\","
+            "\"supported_color_modes\":[\"brightness\",\"color_temp\",\"hs\"],\"min_mireds\":153,\"max_mireds\":500,"
+            "\"effect_list\":[\"colorloop\",\"random\",\"none\"],\"brightness\":%d,\"hs_color\":[%d.5,%d.25],"
+            "\"device_class\":null,\"assumed_state\":false,\"supported_features\":%d},"
+            "\"last_changed\":\"2026-10-16T08:%02d:11.123456+00:00\",\"last_reported\":\"2026-10-16T08:%02d:11.123456+00:00\","
+            "\"last_updated\":\"2026-10-16T08:%02d:11.123456+00:00\","
+            "\"context\":{\"id\":\"01JA%022dXYZ0123456789ABCD\",\"parent_id\":null,\"user_id\":null}}",
+            i ? "," : "", domain, i, i % 3 ? "on" : "unavailable", i, i, i % 256, i % 360, i % 100, i % 64,
+            i % 60, i % 60, i % 60, i);
+        s += buf;
+    }
+    s += "]";
+    return s;
+}
+
+static std::string syntheticCalendar() {
+    std::string s = "[";
+    char buf[1024];
+    for (int i = 0; i < 60; i++) {
+        snprintf(buf, sizeof(buf),
+            "%s{\"start\":{\"dateTime\":\"2026-10-%02dT%02d:30:00+03:00\"},\"end\":{\"dateTime\":\"2026-10-%02dT%02d:30:00+03:00\"},"
+            "\"summary\":\"Event %d\",\"description\":\"%s\",\"location\":\"Room %d\",\"uid\":\"%08x-uid\",\"recurrence_id\":null,\"rrule\":null}",
+            i ? "," : "", 1 + i % 28, 8 + i % 10, 1 + i % 28, 9 + i % 10, i,
+            "Agenda:\\n1. Review\\n2. Planning\\n3. Anything else that came up during the week and needs a decision", i, i * 2654435761u);
+        s += buf;
+    }
+    s += "]";
+    return s;
+}
+
+// ============================================
+// Benchmark
+// ============================================
+struct SttScan {
+    char providers[8][JSON_STREAM_VALUE_LEN];
+    int count;
+};
+
+static void onSttValue(JsonStreamParser& p, JsonStreamType type, const char* value, size_t, void* ctx) {
+    SttScan& scan = *(SttScan*)ctx;
+    if (type == JSON_STREAM_STRING && strncmp(value, "stt.", 4) == 0 && p.match("[*].entity_id") && scan.count < 8) {
+        strcpy(scan.providers[scan.count++], value + 4);
+    }
+}
+
+struct EventScan {
+    char summary[64];
+    char start[32];
+    int events;
+    int withStart;
+};
+
+static void onEventValue(JsonStreamParser& p, JsonStreamType, const char* value, size_t, void* ctx) {
+    EventScan& scan = *(EventScan*)ctx;
+    if (p.match("[*].summary")) {
+        snprintf(scan.summary, sizeof(scan.summary), "%s", value);
+    } else if (p.match("[*].start.dateTime") || p.match("[*].start.date")) {
+        snprintf(scan.start, sizeof(scan.start), "%s", value);
+    }
+}
+
+static void onEventClose(JsonStreamParser& p, void* ctx) {
+    EventScan& scan = *(EventScan*)ctx;
+    if (p.match("[*]")) {
+        scan.events++;
+        if (scan.start[0]) scan.withStart++;
+        scan.summary[0] = '\0';
+        scan.start[0] = '\0';
+    }
+}
+
+struct Result {
+    double ms;
+    size_t peak;
+    size_t allocs;
+};
+
+template <typename F>
+static Result measure(F run) {
+    std::vector<double> times;
+    Result r = { 0, 0, 0 };
+    for (int i = 0; i < RUNS; i++) {
+        resetPeak();
+        size_t base = heapNow;
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        r.peak = heapPeak - base;
+        r.allocs = allocations;
+    }
+    std::sort(times.begin(), times.end());
+    r.ms = times[RUNS / 2];
+    return r;
+}
+
+static void report(const char* name, const char* method, size_t bytes, const Result& r) {
+    printf("%-10s %-10s %8.2f ms %7.1f MB/s  peak heap %8zu B  allocations %zu\n",
+           name, method, r.ms, bytes / 1e6 / (r.ms / 1e3), r.peak, r.allocs);
+}
+
+// Body arriving in socket-sized pieces, collected the way getString() did
+static void fullBody(const std::string& payload, std::string& body) {
+    body.clear();
+    body.reserve(payload.size());          // Content-Length is known
+    for (size_t i = 0; i < payload.size(); i += CHUNK_SIZE) {
+        body.append(payload, i, CHUNK_SIZE);
+    }
+}
+
+static bool streamed(const std::string& payload, JsonStreamParser& parser) {
+    for (size_t i = 0; i < payload.size(); i += CHUNK_SIZE) {
+        size_t n = payload.size() - i < CHUNK_SIZE ? payload.size() - i : CHUNK_SIZE;
+        if (!parser.feed(payload.data() + i, n)) break;
+    }
+    return parser.finish();
+}
+
+int main(int argc, char** argv) {
+    runChecks();
+    printf("\n");
+
+    std::string states = argc > 1 ? readFile(argv[1]) : syntheticStates();
+    std::string calendar = argc > 2 ? readFile(argv[2]) : syntheticCalendar();
+    printf("/api/states: %zu bytes%s, calendar: %zu bytes%s, parser: %zu bytes\n\n",
+           states.size(), argc > 1 ? "" : " (synthetic)", calendar.size(), argc > 2 ? "" : " (synthetic)",
+           sizeof(JsonStreamParser));
+
+    // STT discovery: old indexOf scan of the full body
+    std::vector<std::string> oldProviders;
+    Result full = measure([&]() {
+        std::string body;
+        fullBody(states, body);
+        oldProviders.clear();
+        size_t idx = 0;
+        while ((idx = body.find("\"entity_id\":\"stt.", idx)) != std::string::npos) {
+            size_t start = idx + 17;
+            size_t end = body.find('"', start);
+            if (end == std::string::npos) break;
+            oldProviders.push_back(body.substr(start, end - start));
+            idx = end;
+        }
+    });
+    report("states", "full body", states.size(), full);
+
+    static JsonStreamParser parser;
+    static SttScan scan;
+    bool ok = true;
+    Result stream = measure([&]() {
+        scan.count = 0;
+        parser.begin(onSttValue, nullptr, &scan);
+        ok = streamed(states, parser);
+    });
+    report("states", "streamed", states.size(), stream);
+
+    bool same = ok && (int)oldProviders.size() == scan.count;
+    for (int i = 0; same && i < scan.count; i++) {
+        same = oldProviders[i] == scan.providers[i];
+    }
+    check(same, "streamed STT providers match the full-body scan");
+    check(stream.allocs == 0, "streaming /api/states allocates nothing");
+    if (!ok) printf("     parse error at %zu: %s\n", parser.getOffset(), parser.getError());
+
+    // Calendar
+    Result calFull = measure([&]() {
+        std::string body;
+        fullBody(calendar, body);
+    });
+    report("calendar", "full body", calendar.size(), calFull);
+
+    static EventScan events;
+    Result calStream = measure([&]() {
+        memset(&events, 0, sizeof(events));
+        parser.begin(onEventValue, onEventClose, &events);
+        ok = streamed(calendar, parser);
+    });
+    report("calendar", "streamed", calendar.size(), calStream);
+    check(ok && events.events > 0 && events.withStart == events.events, "every calendar event has a start");
+    check(calStream.allocs == 0, "streaming the calendar allocates nothing");
+
+    printf("\nPeak heap: %zu KB full body vs %zu B streamed (parser state %zu B, static)\n",
+           full.peak / 1024, stream.peak, sizeof(JsonStreamParser));
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
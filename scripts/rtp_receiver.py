@@ -0,0 +1,306 @@
+#!/usr/bin/env python3
+"""
+Local RTP receiver for the Entry Hub intercom stream (G.711 µ-law, 8 kHz)
+
+Receives the RTP stream, reports loss / reordering / interarrival jitter
+(RFC 3550) and sends RTCP receiver reports back so the device can show the
+same figures plus round-trip time in GET /api/intercom.
+
+Optional:
+  --play              play the stream through aplay (ALSA)
+  --wav FILE          record the decoded stream to a WAV file
+  --measure-latency   play short 2 kHz bursts on this machine's speaker
+                      (hold it next to the hub's microphone) and time how
+                      long until each burst arrives back in the RTP stream
+
+Usage:
+  curl -X POST http://<hub>/api/intercom/start -d '{"host":"<this pc>","port":5004}'
+  rtp_receiver.py --port 5004 --play --measure-latency
+
+Only the Python standard library is needed (plus aplay for --play /
+--measure-latency).
+"""
+
+import argparse
+import math
+import random
+import select
+import socket
+import struct
+import subprocess
+import sys
+import threading
+import time
+import wave
+
+PAYLOAD_PCMU = 0
+SAMPLE_RATE = 8000
+REPORT_INTERVAL = 5.0
+
+BURST_FREQ = 2000.0
+BURST_MS = 40
+EMIT_RATE = 16000
+EMIT_BUFFER_US = 20000          # aplay buffer for the burst emitter
+
+
+def mulaw_table():
+    table = []
+    for byte in range(256):
+        u = ~byte & 0xFF
+        sign = u & 0x80
+        exponent = (u >> 4) & 0x07
+        mantissa = u & 0x0F
+        sample = (((mantissa << 3) + 0x84) << exponent) - 0x84
+        table.append(-sample if sign else sample)
+    return table
+
+
+MULAW = mulaw_table()
+
+
+class Stats:
+    """RFC 3550 receiver statistics (A.1 / A.3 / A.8)"""
+
+    def __init__(self):
+        self.ssrc = None
+        self.base_seq = None
+        self.max_seq = 0
+        self.cycles = 0
+        self.received = 0
+        self.duplicates = 0
+        self.reordered = 0
+        self.jitter = 0.0
+        self.transit = None
+        self.expected_prior = 0
+        self.received_prior = 0
+        self.start = time.monotonic()
+
+    def update(self, seq, ts, arrival):
+        if self.base_seq is None:
+            self.base_seq = seq
+            self.max_seq = seq
+        else:
+            delta = (seq - self.max_seq) & 0xFFFF
+            if delta == 0:
+                self.duplicates += 1
+                return False
+            if delta < 0x8000:
+                if seq < self.max_seq:
+                    self.cycles += 1 << 16
+                self.max_seq = seq
+            else:
+                self.reordered += 1
+
+        self.received += 1
+        transit = arrival * SAMPLE_RATE - ts
+        if self.transit is not None:
+            d = abs(transit - self.transit)
+            # Ignore 32-bit timestamp wrap
+            if d < 1 << 30:
+                self.jitter += (d - self.jitter) / 16.0
+        self.transit = transit
+        return True
+
+    @property
+    def extended_max(self):
+        return self.cycles + self.max_seq
+
+    @property
+    def expected(self):
+        return 0 if self.base_seq is None else self.extended_max - self.base_seq + 1
+
+    @property
+    def lost(self):
+        return self.expected - self.received
+
+    def interval_fraction_lost(self):
+        expected = self.expected - self.expected_prior
+        received = self.received - self.received_prior
+        self.expected_prior = self.expected
+        self.received_prior = self.received
+        lost = expected - received
+        return 0 if expected <= 0 or lost <= 0 else min(255, (lost << 8) // expected)
+
+
+class LatencyProbe:
+    """Plays tone bursts locally and matches them in the received audio"""
+
+    def __init__(self, interval):
+        self.interval = interval
+        self.pending = []           # Emission times waiting for detection
+        self.results = []
+        self.noise = 100.0
+        self.lock = threading.Lock()
+        self.proc = subprocess.Popen(
+            ["aplay", "-q", "-t", "raw", "-f", "S16_LE", "-r", str(EMIT_RATE), "-c", "1",
+             f"--buffer-time={EMIT_BUFFER_US}"], stdin=subprocess.PIPE)
+        threading.Thread(target=self._emit_loop, daemon=True).start()
+
+    def _emit_loop(self):
+        chunk = EMIT_RATE // 100                        # 10 ms
+        silence = b"\0\0" * chunk
+        n = EMIT_RATE * BURST_MS // 1000
+        burst = b"".join(struct.pack("<h", int(12000 * math.sin(2 * math.pi * BURST_FREQ * i / EMIT_RATE)))
+                         for i in range(n))
+        next_burst = time.monotonic() + self.interval
+        while True:
+            now = time.monotonic()
+            if now >= next_burst:
+                # aplay blocks once its buffer is full, so what we write now
+                # plays about one buffer later
+                with self.lock:
+                    self.pending.append(now + EMIT_BUFFER_US / 1e6)
+                self.proc.stdin.write(burst)
+                next_burst = now + self.interval * random.uniform(0.8, 1.2)
+            else:
+                self.proc.stdin.write(silence)
+            self.proc.stdin.flush()
+
+    def feed(self, samples, arrival):
+        # 5 ms energy windows; the packet's last sample arrived at `arrival`
+        win = SAMPLE_RATE // 200
+        for start in range(0, len(samples) - win + 1, win):
+            energy = sum(s * s for s in samples[start:start + win]) / win
+            onset = energy > self.noise * 30
+            if not onset:
+                self.noise += (energy - self.noise) * 0.05
+                continue
+            with self.lock:
+                # Drop bursts that never showed up
+                self.pending = [t for t in self.pending if arrival - t < 1.0]
+                if self.pending and self.pending[0] <= arrival + 0.05:
+                    emitted = self.pending.pop(0)
+                    self.results.append((arrival - emitted) * 1000.0)
+            return
+
+    def summary(self):
+        if not self.results:
+            return "no bursts detected yet"
+        r = sorted(self.results[-50:])
+        return (f"n={len(self.results)} min {r[0]:.0f} ms, median {r[len(r) // 2]:.0f} ms, "
+                f"max {r[-1]:.0f} ms")
+
+
+def build_rr(our_ssrc, stats, lsr, sr_arrival):
+    fraction = stats.interval_fraction_lost()
+    lost = max(-0x800000, min(0x7FFFFF, stats.lost)) & 0xFFFFFF
+    dlsr = int((time.monotonic() - sr_arrival) * 65536) if lsr else 0
+    block = struct.pack("!IB3sIIII", stats.ssrc, fraction, lost.to_bytes(3, "big"),
+                        stats.extended_max & 0xFFFFFFFF, int(stats.jitter), lsr, dlsr)
+    header = struct.pack("!BBHI", 0x81, 201, 7, our_ssrc)
+    return header + block
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=5004, help="RTP port (RTCP is port + 1)")
+    parser.add_argument("--play", action="store_true", help="Play through aplay")
+    parser.add_argument("--jitter-ms", type=int, default=60, help="Playback buffer for --play")
+    parser.add_argument("--wav", help="Record decoded audio to this WAV file")
+    parser.add_argument("--measure-latency", action="store_true", help="Emit tone bursts and time them")
+    parser.add_argument("--burst-interval", type=float, default=2.0, help="Seconds between bursts")
+    args = parser.parse_args()
+
+    rtp = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    rtp.bind(("0.0.0.0", args.port))
+    rtcp = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    rtcp.bind(("0.0.0.0", args.port + 1))
+
+    player = None
+    if args.play:
+        player = subprocess.Popen(
+            ["aplay", "-q", "-t", "raw", "-f", "MU_LAW", "-r", str(SAMPLE_RATE), "-c", "1",
+             f"--buffer-time={args.jitter_ms * 1000}"], stdin=subprocess.PIPE)
+
+    recorder = None
+    if args.wav:
+        recorder = wave.open(args.wav, "wb")
+        recorder.setnchannels(1)
+        recorder.setsampwidth(2)
+        recorder.setframerate(SAMPLE_RATE)
+
+    probe = LatencyProbe(args.burst_interval) if args.measure_latency else None
+
+    our_ssrc = random.getrandbits(32)
+    stats = Stats()
+    rtcp_peer = None
+    lsr = 0
+    sr_arrival = 0.0
+    last_report = time.monotonic()
+    print(f"Listening for RTP on :{args.port} (RTCP :{args.port + 1})")
+
+    try:
+        while True:
+            ready, _, _ = select.select([rtp, rtcp], [], [], 0.5)
+            now = time.monotonic()
+
+            if rtp in ready:
+                data, peer = rtp.recvfrom(2048)
+                if len(data) < 12 or data[0] >> 6 != 2 or data[1] & 0x7F != PAYLOAD_PCMU:
+                    continue
+                seq, ts, ssrc = struct.unpack("!HII", data[2:12])
+                header = 12 + 4 * (data[0] & 0x0F)
+                payload = data[header:]
+
+                if stats.ssrc != ssrc:
+                    if stats.ssrc is not None:
+                        print(f"New stream SSRC {ssrc:08x}, resetting statistics")
+                    stats = Stats()
+                    stats.ssrc = ssrc
+                    rtcp_peer = (peer[0], peer[1] + 1)
+
+                prev_max = stats.extended_max
+                if not stats.update(seq, ts, now):
+                    continue
+
+                # Conceal short gaps with silence so playback stays in sync
+                gap = stats.extended_max - prev_max - 1 if stats.received > 1 else 0
+                if 0 < gap < 25:
+                    filler = b"\xff" * (len(payload) * gap)
+                    if player:
+                        player.stdin.write(filler)
+                    if recorder:
+                        recorder.writeframes(b"\0\0" * len(filler))
+
+                if player:
+                    player.stdin.write(payload)
+                    player.stdin.flush()
+                samples = [MULAW[b] for b in payload]
+                if recorder:
+                    recorder.writeframes(struct.pack(f"<{len(samples)}h", *samples))
+                if probe:
+                    probe.feed(samples, now)
+
+            if rtcp in ready:
+                data, peer = rtcp.recvfrom(2048)
+                if len(data) >= 28 and data[1] == 200:
+                    msw, lsw = struct.unpack("!II", data[8:16])
+                    lsr = ((msw & 0xFFFF) << 16) | (lsw >> 16)
+                    sr_arrival = now
+                    rtcp_peer = peer
+
+            if now - last_report >= REPORT_INTERVAL and stats.ssrc is not None:
+                last_report = now
+                expected = max(stats.expected, 1)
+                print(f"[{now - stats.start:6.0f}s] received {stats.received}, lost {stats.lost} "
+                      f"({100.0 * stats.lost / expected:.2f}%), reordered {stats.reordered}, "
+                      f"duplicates {stats.duplicates}, jitter {stats.jitter / SAMPLE_RATE * 1000:.1f} ms")
+                if probe:
+                    print(f"        capture->arrival: {probe.summary()}"
+                          + (f" (+{args.jitter_ms} ms playback buffer = mouth-to-ear)" if player else ""))
+                if rtcp_peer:
+                    rtcp.sendto(build_rr(our_ssrc, stats, lsr, sr_arrival), rtcp_peer)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if recorder:
+            recorder.close()
+        for proc in (player, probe.proc if probe else None):
+            if proc:
+                proc.stdin.close()
+                proc.terminate()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
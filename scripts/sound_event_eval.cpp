@@ -0,0 +1,230 @@
+// Host evaluation of the sound event detector on a clip corpus
+//
+// Runs the same front end, int8 model runtime and tracker as the device
+// over 16 kHz mono 16-bit WAV clips laid out as <corpus>/<label>/*.wav.
+// A clip counts as correct when the first event fired matches its label;
+// clips under background/ (or silence/, _*/) must fire nothing.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Iinclude scripts/sound_event_eval.cpp src/sound_events.cpp -o sound_event_eval
+//
+// Usage:
+//   ./sound_event_eval model.bin corpus/ [--hop 8] [--threshold 0.7]
+//                      [--consecutive 2] [--min-accuracy 0.9] [-v]
+//
+// Exits non-zero if the accuracy is below --min-accuracy, so it can gate
+// model updates.
+
+#include "sound_events.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static bool readWav(const fs::path& path, std::vector<int16_t>& samples) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    uint8_t hdr[12];
+    bool ok = fread(hdr, 1, 12, f) == 12 && memcmp(hdr, "RIFF", 4) == 0 && memcmp(hdr + 8, "WAVE", 4) == 0;
+    bool formatOk = false;
+
+    while (ok) {
+        uint8_t chunk[8];
+        if (fread(chunk, 1, 8, f) != 8) { ok = false; break; }
+        uint32_t size = chunk[4] | (chunk[5] << 8) | (chunk[6] << 16) | ((uint32_t)chunk[7] << 24);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[16];
+            if (size < 16 || fread(fmt, 1, 16, f) != 16) { ok = false; break; }
+            uint16_t format = fmt[0] | (fmt[1] << 8);
+            uint16_t channels = fmt[2] | (fmt[3] << 8);
+            uint32_t rate = fmt[4] | (fmt[5] << 8) | (fmt[6] << 16) | ((uint32_t)fmt[7] << 24);
+            uint16_t bits = fmt[14] | (fmt[15] << 8);
+            formatOk = format == 1 && channels == 1 && rate == SAMPLE_RATE && bits == 16;
+            fseek(f, size - 16 + (size & 1), SEEK_CUR);
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!formatOk) { ok = false; break; }
+            samples.resize(size / 2);
+            ok = fread(samples.data(), 2, samples.size(), f) == samples.size();
+            break;
+        } else {
+            fseek(f, size + (size & 1), SEEK_CUR);
+        }
+    }
+
+    fclose(f);
+    return ok && formatOk;
+}
+
+static bool loadModel(const char* path, SoundEventModel& model) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* data = (uint8_t*)malloc(len);
+    bool ok = data && fread(data, 1, len, f) == (size_t)len;
+    fclose(f);
+    if (!ok) {
+        free(data);
+        return false;
+    }
+    if (!model.load(data, len)) {
+        fprintf(stderr, "Invalid model: %s\n", model.getError());
+        return false;
+    }
+    return true;
+}
+
+static bool isBackground(const std::string& label) {
+    return label.empty() || label[0] == '_' || label == "background" || label == "silence";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s model.bin corpus/ [--hop N] [--threshold P] [--consecutive N] "
+                        "[--min-accuracy A] [-v]\n", argv[0]);
+        return 2;
+    }
+
+    const char* modelPath = argv[1];
+    fs::path corpus = argv[2];
+    int hop = 8;
+    float threshold = 0.7f;
+    int consecutive = 2;
+    float minAccuracy = 0.0f;
+    bool verbose = false;
+
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--hop") == 0 && i + 1 < argc) hop = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) threshold = atof(argv[++i]);
+        else if (strcmp(argv[i], "--consecutive") == 0 && i + 1 < argc) consecutive = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--min-accuracy") == 0 && i + 1 < argc) minAccuracy = atof(argv[++i]);
+        else if (strcmp(argv[i], "-v") == 0) verbose = true;
+        else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (hop < 1) hop = 1;
+
+    SoundEventModel model;
+    if (!loadModel(modelPath, model)) {
+        return 2;
+    }
+    printf("Model: %d classes, %dx%d input, %u MACs\n",
+           model.getNumClasses(), model.getInputFrames(), model.getInputMels(), model.getMacs());
+
+    LogMelFrontend frontend;
+    frontend.begin(model.getInputMels());
+
+    std::vector<fs::path> clips;
+    for (const auto& entry : fs::recursive_directory_iterator(corpus)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".wav") {
+            clips.push_back(entry.path());
+        }
+    }
+    std::sort(clips.begin(), clips.end());
+    if (clips.empty()) {
+        fprintf(stderr, "No .wav clips under %s\n", corpus.c_str());
+        return 2;
+    }
+
+    struct ClassResult { int clips = 0; int correct = 0; };
+    std::map<std::string, ClassResult> results;
+    std::vector<int8_t> patch((size_t)model.getInputFrames() * model.getInputMels());
+    int total = 0, correct = 0, unreadable = 0;
+    uint64_t windows = 0;
+
+    for (const auto& clip : clips) {
+        std::vector<int16_t> samples;
+        if (!readWav(clip, samples)) {
+            fprintf(stderr, "Skipping %s (not 16 kHz mono 16-bit PCM)\n", clip.c_str());
+            unreadable++;
+            continue;
+        }
+
+        std::string label = clip.parent_path().filename().string();
+
+        // Fresh detector state per clip, mirroring SoundEventDetector::processFrame
+        LogMelWindow window;
+        window.begin(model.getInputFrames(), model.getInputMels(), model.quantizeInput(logf(1e-6f)));
+        SoundEventTracker tracker;
+        tracker.configure(model, threshold, consecutive, 0xFFFF);
+
+        std::string fired;
+        float firedConfidence = 0.0f;
+        float firedAt = 0.0f;
+        int sinceHop = 0;
+
+        for (size_t pos = 0; pos + AUDIO_FRAME_SAMPLES <= samples.size() && fired.empty(); pos += AUDIO_FRAME_SAMPLES) {
+            float mel[SOUND_EVENTS_MAX_MELS];
+            int8_t row[SOUND_EVENTS_MAX_MELS];
+            frontend.process(&samples[pos], AUDIO_FRAME_SAMPLES, mel);
+            for (int m = 0; m < model.getInputMels(); m++) {
+                row[m] = model.quantizeInput(mel[m]);
+            }
+            window.push(row);
+
+            if (++sinceHop < hop || !window.isFull()) {
+                continue;
+            }
+            sinceHop = 0;
+            windows++;
+
+            float probs[SOUND_EVENTS_MAX_CLASSES];
+            window.copyTo(patch.data());
+            model.run(patch.data(), probs);
+
+            float confidence;
+            int cls = tracker.update(probs, &confidence);
+            if (cls >= 0) {
+                fired = model.getClassName(cls);
+                firedConfidence = confidence;
+                firedAt = (float)(pos + AUDIO_FRAME_SAMPLES) / SAMPLE_RATE;
+            }
+        }
+
+        bool ok = isBackground(label) ? fired.empty() : fired == label;
+        total++;
+        if (ok) correct++;
+        results[label].clips++;
+        if (ok) results[label].correct++;
+
+        if (verbose || !ok) {
+            if (fired.empty()) {
+                printf("%s %s: no event\n", ok ? "ok  " : "FAIL", clip.c_str());
+            } else {
+                printf("%s %s: %s (%.2f) at %.2f s\n", ok ? "ok  " : "FAIL", clip.c_str(),
+                       fired.c_str(), firedConfidence, firedAt);
+            }
+        }
+    }
+
+    printf("\n%-24s %6s %8s\n", "label", "clips", "accuracy");
+    for (const auto& r : results) {
+        printf("%-24s %6d %7.1f%%\n", r.first.c_str(), r.second.clips,
+               100.0f * r.second.correct / r.second.clips);
+    }
+
+    float accuracy = total ? (float)correct / total : 0.0f;
+    printf("\nTotal: %d/%d correct (%.1f%%), %llu windows, %d unreadable\n",
+           correct, total, accuracy * 100.0f, (unsigned long long)windows, unreadable);
+
+    if (accuracy < minAccuracy) {
+        printf("Accuracy below minimum %.1f%%\n", minAccuracy * 100.0f);
+        return 1;
+    }
+    return 0;
+}
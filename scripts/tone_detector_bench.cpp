@@ -0,0 +1,282 @@
+// Host test and benchmark for the Goertzel tone detector
+//
+// Synthesizes DTMF digits and fixed tones (with noise, twist, off-frequency
+// and too-short variants), runs them through ToneDetector in 512-sample
+// frames exactly like the pipeline stage, checks the detected symbols, and
+// measures the per-frame processing cost.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Iinclude scripts/tone_detector_bench.cpp src/tone_detector.cpp -o tone_detector_bench
+//
+// Exits non-zero if any case fails.
+
+#include "tone_detector.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+static const float ROWS[4] = { 697.0f, 770.0f, 852.0f, 941.0f };
+static const float COLS[4] = { 1209.0f, 1336.0f, 1477.0f, 1633.0f };
+static const char* KEYS = "123A456B789C*0#D";
+
+class Signal {
+public:
+    explicit Signal(uint32_t seed = 1) : rng(seed) {}
+
+    void tone(float f1, float dbfs1, float f2, float dbfs2, int ms) {
+        int n = ms * SAMPLE_RATE / 1000;
+        float a1 = powf(10.0f, dbfs1 / 20.0f) * 32767.0f;
+        float a2 = powf(10.0f, dbfs2 / 20.0f) * 32767.0f;
+        for (int i = 0; i < n; i++, t++) {
+            float v = 0;
+            if (f1 > 0) v += a1 * sinf(2.0f * (float)M_PI * f1 * t / SAMPLE_RATE);
+            if (f2 > 0) v += a2 * sinf(2.0f * (float)M_PI * f2 * t / SAMPLE_RATE);
+            buf.push_back(v);
+        }
+    }
+
+    void digit(char key, int ms, float dbfs = -20.0f, float twistDb = 0.0f, float detune = 1.0f) {
+        const char* p = strchr(KEYS, key);
+        int idx = (int)(p - KEYS);
+        tone(ROWS[idx / 4] * detune, dbfs, COLS[idx % 4] * detune, dbfs + twistDb, ms);
+    }
+
+    void silence(int ms) { tone(0, 0, 0, 0, ms); }
+
+    // Voiced-speech-like harmonic stack with pitch glide
+    void voice(int ms, float dbfs) {
+        int n = ms * SAMPLE_RATE / 1000;
+        float a = powf(10.0f, dbfs / 20.0f) * 32767.0f / 4;
+        float phase = 0;
+        for (int i = 0; i < n; i++, t++) {
+            float f0 = 140.0f + 30.0f * sinf(2.0f * (float)M_PI * 3.0f * t / SAMPLE_RATE);
+            phase += 2.0f * (float)M_PI * f0 / SAMPLE_RATE;
+            float v = 0;
+            for (int h = 1; h <= 12; h++) v += a / h * sinf(phase * h);
+            buf.push_back(v);
+        }
+    }
+
+    void addNoise(float dbfs) {
+        std::normal_distribution<float> dist(0.0f, powf(10.0f, dbfs / 20.0f) * 32767.0f);
+        for (float& v : buf) v += dist(rng);
+    }
+
+    std::vector<int16_t> pcm() const {
+        std::vector<int16_t> out(buf.size());
+        for (size_t i = 0; i < buf.size(); i++) {
+            float v = buf[i];
+            out[i] = (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+        }
+        return out;
+    }
+
+private:
+    std::vector<float> buf;
+    long t = 0;
+    std::mt19937 rng;
+};
+
+static std::string detect(const std::vector<int16_t>& pcm, const ToneDetectorConfig& cfg) {
+    ToneDetector det;
+    det.begin(cfg);
+
+    std::string out;
+    ToneEvent events[4];
+    for (size_t pos = 0; pos + AUDIO_FRAME_SAMPLES <= pcm.size(); pos += AUDIO_FRAME_SAMPLES) {
+        int n = det.process(&pcm[pos], AUDIO_FRAME_SAMPLES, events, 4);
+        for (int i = 0; i < n; i++) {
+            // Custom tone names in brackets, DTMF digits as is
+            out += events[i].dtmf ? events[i].symbol : "[" + std::string(events[i].symbol) + "]";
+        }
+    }
+    return out;
+}
+
+static int failures = 0;
+
+static void check(const char* name, const std::string& got, const std::string& expected) {
+    bool ok = got == expected;
+    if (!ok) failures++;
+    printf("%s %-40s got '%s'%s%s%s\n", ok ? "ok  " : "FAIL", name, got.c_str(),
+           ok ? "" : " expected '", ok ? "" : expected.c_str(), ok ? "" : "'");
+}
+
+int main() {
+    ToneDetectorConfig cfg;
+    ToneDetector::defaultConfig(cfg);
+
+    {
+        Signal s;
+        for (const char* k = KEYS; *k; k++) {
+            s.digit(*k, 60);
+            s.silence(60);
+        }
+        s.addNoise(-50);
+        check("all 16 digits, 60 ms on/off", detect(s.pcm(), cfg), KEYS);
+    }
+    {
+        Signal s;
+        for (const char* k = "0819"; *k; k++) {
+            s.digit(*k, 50, -30);
+            s.silence(50);
+        }
+        s.addNoise(-45);
+        check("digits at -30 dBFS in -45 dBFS noise", detect(s.pcm(), cfg), "0819");
+    }
+    {
+        Signal s;
+        s.digit('5', 800);
+        s.addNoise(-50);
+        check("held digit fires once", detect(s.pcm(), cfg), "5");
+    }
+    {
+        Signal s;
+        s.digit('7', 100);
+        s.silence(40);
+        s.digit('7', 100);
+        s.addNoise(-50);
+        check("repeated digit with 40 ms gap", detect(s.pcm(), cfg), "77");
+    }
+    {
+        Signal s;
+        s.digit('3', 20);
+        s.silence(200);
+        s.addNoise(-50);
+        check("20 ms burst rejected", detect(s.pcm(), cfg), "");
+    }
+    {
+        Signal s;
+        s.digit('6', 100, -20, 6);
+        s.silence(100);
+        s.digit('6', 100, -20, -6);
+        s.addNoise(-50);
+        check("twist +/-6 dB accepted", detect(s.pcm(), cfg), "66");
+    }
+    {
+        Signal s;
+        s.digit('6', 100, -20, 14);
+        s.silence(100);
+        s.digit('6', 100, -26, -14);
+        s.addNoise(-50);
+        check("twist +/-14 dB rejected", detect(s.pcm(), cfg), "");
+    }
+    {
+        Signal s;
+        s.digit('2', 100, -20, 0, 1.015f);
+        s.silence(100);
+        s.digit('2', 100, -20, 0, 0.985f);
+        s.addNoise(-50);
+        check("+/-1.5% frequency deviation accepted", detect(s.pcm(), cfg), "22");
+    }
+    {
+        Signal s;
+        s.digit('2', 100, -20, 0, 1.04f);
+        s.silence(100);
+        s.digit('2', 100, -20, 0, 0.96f);
+        s.addNoise(-50);
+        check("+/-4% frequency deviation rejected", detect(s.pcm(), cfg), "");
+    }
+    {
+        Signal s;
+        s.digit('9', 100, -50);
+        s.addNoise(-70);
+        check("-50 dBFS digit below level", detect(s.pcm(), cfg), "");
+    }
+    {
+        Signal s;
+        s.silence(3000);
+        s.addNoise(-15);
+        check("loud white noise", detect(s.pcm(), cfg), "");
+    }
+    {
+        Signal s;
+        s.voice(3000, -12);
+        s.addNoise(-50);
+        check("voiced speech-like signal", detect(s.pcm(), cfg), "");
+    }
+    {
+        ToneDetectorConfig c = cfg;
+        c.customCount = 2;
+        strcpy(c.custom[0].name, "ding");
+        c.custom[0].freq = 988.0f;
+        c.custom[0].minBlocks = 4;
+        strcpy(c.custom[1].name, "dong");
+        c.custom[1].freq = 784.0f;
+        c.custom[1].minBlocks = 4;
+
+        Signal s;
+        s.tone(988, -20, 0, 0, 400);
+        s.tone(784, -20, 0, 0, 600);
+        s.silence(200);
+        s.tone(988, -20, 0, 0, 50);
+        s.silence(200);
+        s.digit('4', 80);
+        s.addNoise(-50);
+        check("custom chime tones + digit", detect(s.pcm(), c), "[ding][dong]4");
+    }
+    {
+        Signal s;
+        for (const char* k = "12#"; *k; k++) {
+            s.digit(*k, 60);
+            s.silence(60);
+        }
+        s.addNoise(-50);
+        ToneDetector det;
+        det.begin(cfg);
+        std::vector<int16_t> pcm = s.pcm();
+        ToneEvent events[4];
+        std::string seq;
+        for (size_t pos = 0; pos + AUDIO_FRAME_SAMPLES <= pcm.size(); pos += AUDIO_FRAME_SAMPLES) {
+            int n = det.process(&pcm[pos], AUDIO_FRAME_SAMPLES, events, 4);
+            if (n > 0) seq = events[n - 1].sequence;
+        }
+        check("sequence accumulates", seq, "12#");
+    }
+
+    // Per-frame cost over 30 s of noisy digits
+    {
+        Signal s(7);
+        for (int i = 0; i < 250; i++) {
+            s.digit(KEYS[i % 16], 60);
+            s.silence(60);
+        }
+        s.addNoise(-40);
+        std::vector<int16_t> pcm = s.pcm();
+
+        ToneDetectorConfig c = cfg;
+        c.customCount = 2;
+        strcpy(c.custom[0].name, "ding");
+        c.custom[0].freq = 988.0f;
+        strcpy(c.custom[1].name, "dong");
+        c.custom[1].freq = 784.0f;
+
+        ToneDetector det;
+        det.begin(c);
+        ToneEvent events[4];
+        size_t frames = 0;
+        double worst = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t pos = 0; pos + AUDIO_FRAME_SAMPLES <= pcm.size(); pos += AUDIO_FRAME_SAMPLES) {
+            auto f0 = std::chrono::steady_clock::now();
+            det.process(&pcm[pos], AUDIO_FRAME_SAMPLES, events, 4);
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - f0).count();
+            if (us > worst) worst = us;
+            frames++;
+        }
+        double total = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        double avg = total / frames;
+        printf("\nBenchmark: %d frequencies, %zu frames: %.2f us/frame avg, %.2f us max "
+               "(%.3f%% of a %lu us frame)\n", det.getBank().getCount(), frames, avg, worst,
+               100.0 * avg / AUDIO_FRAME_PERIOD_US, (unsigned long)AUDIO_FRAME_PERIOD_US);
+        printf("Inner loop: %d multiply-accumulates per frame\n",
+               det.getBank().getCount() * AUDIO_FRAME_SAMPLES);
+    }
+
+    printf("\n%s (%d failure%s)\n", failures ? "FAILED" : "PASSED", failures, failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,208 @@
+// Host test for the compiled-in timezone table
+//
+// Checks the table against the host's tzdata (/usr/share/zoneinfo, or the
+// directory given as the first argument):
+//
+//   - names are unique and in strcmp order, so the binary search finds
+//     every one of them, and near misses (prefix, case, empty) find nothing
+//   - each entry's POSIX string equals the footer of the zone's TZif file
+//   - the POSIX string gives the same UTC offset and DST flag as the full
+//     zone file, every 3 hours from now for two years (glibc's localtime()
+//     with TZ set to the rule and to the zone name), except for the zones
+//     in APPROXIMATE
+//   - the zones the old if/else knew map to what they did before
+//
+// A host tzdata of another release than the table's is reported; zones
+// whose rules changed in between then show up as mismatches.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Iinclude scripts/tz_table_test.cpp src/tz_table.cpp -o tz_table_test
+//
+// Exits non-zero if any check fails.
+
+#include "tz_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#define SAMPLE_STEP     (3 * 3600)
+#define SAMPLE_SPAN     (2 * 366 * 86400)
+
+// Morocco leaves summer time for Ramadan, which no POSIX rule can express;
+// tzdata lists those transitions explicitly up to 2087 and the footer only
+// holds after that. On the device these are an hour off during Ramadan.
+static const char* APPROXIMATE[] = { "Africa/Casablanca", "Africa/El_Aaiun" };
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// Last line of a TZif v2+ file, "" if there is none
+static std::string readFooter(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        return "";
+    }
+    std::string data;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        data.append(buf, n);
+    }
+    fclose(f);
+    if (data.size() < 44 || data.compare(0, 4, "TZif") != 0 || data[4] < '2') {
+        return "";
+    }
+    while (!data.empty() && data.back() == '\n') {
+        data.pop_back();
+    }
+    size_t start = data.rfind('\n');
+    return start == std::string::npos ? "" : data.substr(start + 1);
+}
+
+static std::string hostVersion(const std::string& zoneinfo) {
+    FILE* f = fopen((zoneinfo + "/tzdata.zi").c_str(), "r");
+    if (!f) {
+        return "unknown";
+    }
+    char line[64] = "";
+    if (!fgets(line, sizeof(line), f)) line[0] = '\0';
+    fclose(f);
+    std::string v = line;
+    if (v.compare(0, 10, "# version ") == 0) v = v.substr(10);
+    while (!v.empty() && (v.back() == '\n' || v.back() == '\r')) v.pop_back();
+    return v;
+}
+
+struct Sample {
+    long offset;
+    int isdst;
+};
+
+static void sample(const char* tz, time_t from, std::vector<Sample>& out) {
+    setenv("TZ", tz, 1);
+    tzset();
+    out.clear();
+    for (time_t t = from; t < from + SAMPLE_SPAN; t += SAMPLE_STEP) {
+        struct tm tm;
+        localtime_r(&t, &tm);
+        out.push_back({ tm.tm_gmtoff, tm.tm_isdst > 0 });
+    }
+}
+
+static void checkOrderAndLookup() {
+    int n = tzCount();
+    check(n > 300, "table has the whole tzdata");
+    for (int i = 1; i < n; i++) {
+        if (strcmp(tzZoneName(i - 1), tzZoneName(i)) >= 0) {
+            printf("FAIL: %s not before %s\n", tzZoneName(i - 1), tzZoneName(i));
+            failures++;
+        }
+    }
+    int missed = 0;
+    for (int i = 0; i < n; i++) {
+        if (tzLookup(tzZoneName(i)) != tzZoneRule(i)) {
+            missed++;
+        }
+    }
+    check(missed == 0, "every name is found by binary search");
+
+    check(tzLookup(nullptr) == nullptr, "null name");
+    check(tzLookup("") == nullptr, "empty name");
+    check(tzLookup("Europe/Rig") == nullptr, "prefix is not a match");
+    check(tzLookup("Europe/Rigaa") == nullptr, "longer name is not a match");
+    check(tzLookup("europe/riga") == nullptr, "lookup is case-sensitive");
+    check(tzLookup("Mars/Olympus_Mons") == nullptr, "unknown zone");
+    check(tzLookup("UTC") && strcmp(tzLookup("UTC"), "UTC0") == 0, "UTC");
+}
+
+static void checkOldMappings() {
+    static const char* OLD[][2] = {
+        { "Europe/Riga", "EET-2EEST,M3.5.0/3,M10.5.0/4" },
+        { "Europe/Helsinki", "EET-2EEST,M3.5.0/3,M10.5.0/4" },
+        { "Europe/Athens", "EET-2EEST,M3.5.0/3,M10.5.0/4" },
+        { "Europe/London", "GMT0BST,M3.5.0/1,M10.5.0" },
+        { "Europe/Berlin", "CET-1CEST,M3.5.0,M10.5.0/3" },
+        { "Europe/Paris", "CET-1CEST,M3.5.0,M10.5.0/3" },
+        { "Europe/Rome", "CET-1CEST,M3.5.0,M10.5.0/3" },
+        { "America/New_York", "EST5EDT,M3.2.0,M11.1.0" },
+        { "America/Los_Angeles", "PST8PDT,M3.2.0,M11.1.0" },
+    };
+    for (auto& m : OLD) {
+        const char* rule = tzLookup(m[0]);
+        if (!rule || strcmp(rule, m[1]) != 0) {
+            printf("FAIL: %s -> %s, was %s\n", m[0], rule ? rule : "(none)", m[1]);
+            failures++;
+        }
+    }
+}
+
+static void checkAgainstTzdata(const std::string& zoneinfo) {
+    std::string version = hostVersion(zoneinfo);
+    printf("table tzdata %s, host tzdata %s (%s)\n", tzDataVersion(), version.c_str(), zoneinfo.c_str());
+    if (version != tzDataVersion()) {
+        printf("note: releases differ, rule changes in between show as mismatches\n");
+    }
+
+    time_t now = time(nullptr);
+    std::vector<Sample> byRule, byZone;
+    int footerMismatches = 0;
+    int missing = 0;
+    int offsetMismatches = 0;
+    for (int i = 0; i < tzCount(); i++) {
+        const char* name = tzZoneName(i);
+        const char* rule = tzZoneRule(i);
+        std::string footer = readFooter(zoneinfo + "/" + name);
+        if (footer.empty()) {
+            missing++;
+            continue;
+        }
+        if (footer != rule) {
+            printf("FAIL: %s: table %s, tzdata %s\n", name, rule, footer.c_str());
+            footerMismatches++;
+        }
+
+        bool approximate = false;
+        for (const char* a : APPROXIMATE) {
+            approximate |= strcmp(a, name) == 0;
+        }
+        if (approximate) {
+            continue;
+        }
+
+        sample(rule, now, byRule);
+        sample((":" + zoneinfo + "/" + name).c_str(), now, byZone);
+        for (size_t k = 0; k < byRule.size(); k++) {
+            if (byRule[k].offset != byZone[k].offset || byRule[k].isdst != byZone[k].isdst) {
+                time_t t = now + (time_t)k * SAMPLE_STEP;
+                printf("FAIL: %s at %ld: rule %+ld%s, tzdata %+ld%s\n", name, (long)t, byRule[k].offset,
+                       byRule[k].isdst ? " dst" : "", byZone[k].offset, byZone[k].isdst ? " dst" : "");
+                offsetMismatches++;
+                break;
+            }
+        }
+    }
+    printf("%d zones: %d footer mismatches, %d offset mismatches, %d missing on the host, %d not compared\n",
+           tzCount(), footerMismatches, offsetMismatches, missing, (int)(sizeof(APPROXIMATE) / sizeof(APPROXIMATE[0])));
+    failures += footerMismatches + offsetMismatches;
+    check(missing < tzCount() / 10, "host tzdata present");
+}
+
+int main(int argc, char** argv) {
+    std::string zoneinfo = argc > 1 ? argv[1] : "/usr/share/zoneinfo";
+
+    checkOrderAndLookup();
+    checkOldMappings();
+    checkAgainstTzdata(zoneinfo);
+
+    printf("\n%s (%d failure%s)\n", failures ? "FAILED" : "OK", failures, failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,314 @@
+#include "action_executor.h"
+#include <string.h>
+
+static uint32_t hashAction(const CommandAction& a) {
+    uint32_t h = 2166136261u ^ a.type;
+    const char* fields[3] = { a.domain, a.target, a.arg };
+    for (const char* f : fields) {
+        for (const char* p = f; *p; p++) {
+            h = (h ^ (uint8_t)*p) * 16777619u;     // FNV-1a
+        }
+        h = (h ^ 0xff) * 16777619u;
+    }
+    return h;
+}
+
+// Wrap-safe "a is at or after b" for millisecond timestamps
+static inline bool reached(uint32_t now, uint32_t due) {
+    return (int32_t)(now - due) >= 0;
+}
+
+ActionQueue::ActionQueue()
+    : recentNext(0), nextId(1), nextSeq(0), performer(nullptr), performerCtx(nullptr),
+      completion(nullptr), completionCtx(nullptr), dedupMs(ACTION_DEFAULT_DEDUP_MS),
+      maxAttempts(ACTION_DEFAULT_ATTEMPTS), retryMs(ACTION_DEFAULT_RETRY_MS) {
+    memset(jobs, 0, sizeof(jobs));
+    memset(groups, 0, sizeof(groups));
+    memset(recent, 0, sizeof(recent));
+    memset(&stats, 0, sizeof(stats));
+}
+
+void ActionQueue::setPerformer(ActionPerformer fn, void* ctx) {
+    performer = fn;
+    performerCtx = ctx;
+}
+
+void ActionQueue::setCompletion(ActionCompletion fn, void* ctx) {
+    completion = fn;
+    completionCtx = ctx;
+}
+
+void ActionQueue::configure(uint32_t dedup, uint8_t attempts, uint32_t retry) {
+    dedupMs = dedup;
+    maxAttempts = attempts ? attempts : 1;
+    retryMs = retry;
+}
+
+ActionStatus ActionQueue::submit(const CommandAction& action, const char* label, uint32_t now, uint32_t* id) {
+    uint32_t hash = hashAction(action);
+    for (const Recent& r : recent) {
+        if (r.used && r.hash == hash && now - r.time < dedupMs) {
+            stats.duplicates++;
+            return ACTION_DUPLICATE;
+        }
+    }
+
+    // Entity lists only make sense for HA services and scenes
+    bool fanOut = action.type == CMD_ACTION_HOMEASSISTANT || action.type == CMD_ACTION_SCENE;
+    const char* parts[ACTION_QUEUE_SIZE];
+    size_t lens[ACTION_QUEUE_SIZE];
+    int count = 0;
+    for (const char* p = action.target; count < ACTION_QUEUE_SIZE; ) {
+        const char* comma = fanOut ? strchr(p, ',') : nullptr;
+        size_t len = comma ? (size_t)(comma - p) : strlen(p);
+        while (len && *p == ' ') { p++; len--; }
+        while (len && p[len - 1] == ' ') len--;
+        if (len) {
+            parts[count] = p;
+            lens[count++] = len;
+        }
+        if (!comma) break;
+        p = comma + 1;
+    }
+
+    int group = -1;
+    for (int i = 0; i < ACTION_MAX_GROUPS && group < 0; i++) {
+        if (!groups[i].used) group = i;
+    }
+    int freeJobs = 0;
+    for (const Job& j : jobs) {
+        if (!j.used) freeJobs++;
+    }
+    if (count == 0 || group < 0 || freeJobs < count) {
+        stats.rejected++;
+        return ACTION_REJECTED;
+    }
+
+    Recent& r = recent[recentNext];
+    recentNext = (recentNext + 1) % ACTION_DEDUP_HISTORY;
+    r.hash = hash;
+    r.time = now;
+    r.used = true;
+
+    Group& g = groups[group];
+    g.id = nextId++;
+    if (nextId == 0) nextId = 1;
+    g.submitted = now;
+    g.actions = (uint8_t)count;
+    g.remaining = (uint8_t)count;
+    g.failed = 0;
+    g.attempts = 0;
+    g.used = true;
+    strncpy(g.label, label ? label : "", sizeof(g.label) - 1);
+    g.label[sizeof(g.label) - 1] = '\0';
+
+    int part = 0;
+    for (Job& j : jobs) {
+        if (part == count) break;
+        if (j.used) continue;
+        j.action = action;
+        memcpy(j.action.target, parts[part], lens[part]);
+        j.action.target[lens[part]] = '\0';
+        j.seq = nextSeq++;
+        j.due = now;
+        j.group = (uint8_t)group;
+        j.attempts = 0;
+        j.used = true;
+        part++;
+    }
+
+    stats.submitted++;
+    if (id) *id = g.id;
+    return ACTION_QUEUED;
+}
+
+int ActionQueue::process(uint32_t now, int budget) {
+    int performed = 0;
+    uint32_t pass = nextSeq;        // Actions queued by completion callbacks wait
+
+    while (performed < budget) {
+        // Oldest due action first
+        Job* next = nullptr;
+        for (Job& j : jobs) {
+            if (j.used && reached(now, j.due) && (int32_t)(j.seq - pass) < 0 &&
+                (!next || (int32_t)(j.seq - next->seq) < 0)) {
+                next = &j;
+            }
+        }
+        if (!next) break;
+
+        bool ok = performer && performer(next->action, performerCtx);
+        next->attempts++;
+        groups[next->group].attempts++;
+        stats.performed++;
+        performed++;
+
+        if (ok) {
+            finish(*next, true, now);
+        } else if (next->attempts >= maxAttempts) {
+            finish(*next, false, now);
+        } else {
+            next->due = now + (retryMs << (next->attempts - 1));
+            stats.retries++;
+        }
+    }
+    return performed;
+}
+
+void ActionQueue::finish(Job& job, bool success, uint32_t now) {
+    Group& g = groups[job.group];
+    job.used = false;
+
+    if (success) {
+        uint32_t latency = now - g.submitted;
+        stats.lastLatencyMs = latency;
+        if (latency > stats.maxLatencyMs) stats.maxLatencyMs = latency;
+        stats.latencySumMs += latency;
+        stats.latencyCount++;
+    } else {
+        g.failed++;
+    }
+
+    if (--g.remaining > 0) {
+        return;
+    }
+
+    if (g.failed) {
+        stats.failed++;
+    } else {
+        stats.completed++;
+    }
+    g.used = false;
+
+    if (completion) {
+        ActionOutcome o;
+        o.id = g.id;
+        o.success = g.failed == 0;
+        o.actions = g.actions;
+        o.failed = g.failed;
+        o.attempts = g.attempts;
+        o.latencyMs = now - g.submitted;
+        o.label = g.label;
+        completion(o, completionCtx);
+    }
+}
+
+uint32_t ActionQueue::nextDue(uint32_t now) const {
+    uint32_t best = UINT32_MAX;
+    for (const Job& j : jobs) {
+        if (!j.used) continue;
+        if (reached(now, j.due)) return 0;
+        if (j.due - now < best) best = j.due - now;
+    }
+    return best;
+}
+
+size_t ActionQueue::getPending() const {
+    size_t n = 0;
+    for (const Job& j : jobs) {
+        if (j.used) n++;
+    }
+    return n;
+}
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include "ha_integration.h"
+#include "mqtt_client.h"
+
+ActionExecutor actionExecutor;
+
+ActionExecutor::ActionExecutor()
+    : commandHandler(nullptr), deferredHead(0), deferredCount(0), deferredDropped(0) {
+    queue.setPerformer(perform, this);
+}
+
+void ActionExecutor::begin(JsonDocument& config) {
+    JsonObject cfg = config["actions"];
+    uint32_t dedup = constrain(cfg["dedup_ms"] | ACTION_DEFAULT_DEDUP_MS, 0, 60000);
+    uint8_t attempts = constrain(cfg["max_attempts"] | ACTION_DEFAULT_ATTEMPTS, 1, 8);
+    uint32_t retry = constrain(cfg["retry_ms"] | ACTION_DEFAULT_RETRY_MS, 50, 10000);
+    queue.configure(dedup, attempts, retry);
+    log_i("Actions: dedup %lu ms, %u attempts, retry from %lu ms",
+          (unsigned long)dedup, attempts, (unsigned long)retry);
+}
+
+void ActionExecutor::loop() {
+    while (deferredCount > 0) {
+        char text[ACTION_DEFERRED_LEN];
+        memcpy(text, deferred[deferredHead], sizeof(text));
+        deferredHead = (deferredHead + 1) % ACTION_MAX_DEFERRED;
+        deferredCount--;
+        if (commandHandler) {
+            commandHandler(text);
+        }
+    }
+
+    queue.process(millis());
+}
+
+ActionStatus ActionExecutor::submit(const CommandAction& action, const char* label, uint32_t* id) {
+    ActionStatus status = queue.submit(action, label, millis(), id);
+    if (status == ACTION_DUPLICATE) {
+        log_i("Actions: duplicate '%s' dropped", label);
+    } else if (status == ACTION_REJECTED) {
+        log_w("Actions: queue full, '%s' rejected", label);
+    }
+    return status;
+}
+
+ActionStatus ActionExecutor::submit(const char* action, const char* label, uint32_t* id) {
+    CommandAction parsed;
+    if (!parseCommandAction(action, parsed) || parsed.type == CMD_ACTION_QUERY) {
+        log_w("Actions: cannot queue '%s'", action);
+        return ACTION_REJECTED;
+    }
+    return submit(parsed, label, id);
+}
+
+bool ActionExecutor::defer(const char* text) {
+    if (deferredCount == ACTION_MAX_DEFERRED) {
+        deferredDropped++;
+        return false;
+    }
+    uint8_t slot = (deferredHead + deferredCount) % ACTION_MAX_DEFERRED;
+    strlcpy(deferred[slot], text, ACTION_DEFERRED_LEN);
+    deferredCount++;
+    return true;
+}
+
+bool ActionExecutor::perform(const CommandAction& a, void* ctx) {
+    if (!mqttClient.isConnected()) {
+        return false;
+    }
+    switch (a.type) {
+        case CMD_ACTION_HOMEASSISTANT:
+            return homeAssistant.callService(a.domain, a.target, a.arg);
+        case CMD_ACTION_SCENE:
+            return homeAssistant.activateScene(a.target);
+        case CMD_ACTION_MQTT:
+            return mqttClient.publish(a.target, a.arg);
+        case CMD_ACTION_QUERY:
+            break;
+    }
+    return false;
+}
+
+void ActionExecutor::getStatusJson(JsonObject obj) {
+    const ActionStats& s = queue.getStats();
+    obj["pending"] = queue.getPending();
+    obj["submitted"] = s.submitted;
+    obj["duplicates"] = s.duplicates;
+    obj["rejected"] = s.rejected;
+    obj["completed"] = s.completed;
+    obj["failed"] = s.failed;
+    obj["performed"] = s.performed;
+    obj["retries"] = s.retries;
+    obj["deferred_dropped"] = deferredDropped;
+    obj["latency_last_ms"] = s.lastLatencyMs;
+    obj["latency_max_ms"] = s.maxLatencyMs;
+    obj["latency_avg_ms"] = s.latencyCount ? (uint32_t)(s.latencySumMs / s.latencyCount) : 0;
+}
+#endif
@@ -4,7 +4,7 @@
 AudioHandler audioHandler;
 
 AudioHandler::AudioHandler() 
-    : initialized(false), recording(false), bufferIndex(0) {
+    : initialized(false), recording(false), bufferIndex(0), levelSnapshot(0) {
 }
 
 bool AudioHandler::begin() {
@@ -123,6 +123,11 @@ size_t AudioHandler::readAudio(int16_t* buffer, size_t samples) {
     return 0;
 }
 
+void AudioHandler::publishLevel(int16_t peak) {
+    uint32_t seq = (levelSnapshot.load(std::memory_order_relaxed) >> 16) + 1;
+    levelSnapshot.store((seq << 16) | (uint16_t)peak, std::memory_order_relaxed);
+}
+
 bool AudioHandler::isRecording() {
     return recording;
 }
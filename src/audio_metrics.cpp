@@ -0,0 +1,237 @@
+#include "audio_metrics.h"
+#include <math.h>
+
+// Per-utterance audio quality metrics implementation
+
+AudioMetrics audioMetrics;
+
+// Samples the I2S DMA ring can hold before the driver starts overwriting
+static const uint32_t DMA_CAPACITY_SAMPLES = DMA_BUFFER_COUNT * DMA_BUFFER_LEN;
+
+// Anything at or beyond this magnitude is treated as clipped
+static const int32_t CLIP_LEVEL = 32767;
+
+AudioMetrics::AudioMetrics()
+    : historyHead(0),
+      historyCount(0),
+      totalCount(0),
+      active(false),
+      pending(false),
+      silenceLevel(0),
+      sampleCount(0),
+      sum(0),
+      sumSquares(0),
+      peak(0),
+      clipped(0),
+      truncated(0),
+      startMs(0),
+      frameCount(0),
+      speechSamples(0),
+      lastFrameMicros(0),
+      backlogSamples(0),
+      dropped(0) {
+    memset(&current, 0, sizeof(current));
+}
+
+void AudioMetrics::beginUtterance(int16_t silence) {
+    memset(&current, 0, sizeof(current));
+    silenceLevel = silence;
+    sampleCount = 0;
+    sum = 0;
+    sumSquares = 0;
+    peak = 0;
+    clipped = 0;
+    truncated = 0;
+    frameCount = 0;
+    speechSamples = 0;
+    backlogSamples = 0;
+    dropped = 0;
+    startMs = millis();
+    lastFrameMicros = micros();
+    active = true;
+    pending = false;
+}
+
+void AudioMetrics::copyAndAccumulate(int16_t* dest, const int16_t* src, size_t count) {
+    if (!active) {
+        memcpy(dest, src, count * sizeof(int16_t));
+        return;
+    }
+
+    // Model the DMA backlog: samples keep arriving at SAMPLE_RATE while we are
+    // away; whatever exceeds the DMA ring is overwritten by the driver.
+    unsigned long nowMicros = micros();
+    uint32_t produced = (uint64_t)(nowMicros - lastFrameMicros) * SAMPLE_RATE / 1000000;
+    lastFrameMicros = nowMicros;
+    backlogSamples += produced;
+    if (backlogSamples > DMA_CAPACITY_SAMPLES) {
+        dropped += backlogSamples - DMA_CAPACITY_SAMPLES;
+        backlogSamples = DMA_CAPACITY_SAMPLES;
+    }
+    backlogSamples = backlogSamples > count ? backlogSamples - count : 0;
+
+    int32_t frameSum = 0;
+    uint64_t frameSquares = 0;
+    int32_t framePeak = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        int32_t s = src[i];
+        dest[i] = (int16_t)s;
+
+        frameSum += s;
+        frameSquares += (uint32_t)(s * s);
+
+        int32_t a = s < 0 ? -s : s;
+        if (a > framePeak) framePeak = a;
+        if (a >= CLIP_LEVEL) clipped++;
+    }
+
+    sampleCount += count;
+    sum += frameSum;
+    sumSquares += frameSquares;
+    if (framePeak > peak) peak = framePeak;
+
+    bool speech = framePeak > silenceLevel;
+    if (speech) {
+        speechSamples += count;
+    }
+
+    if (count > 0 && frameCount < AUDIO_METRICS_MAX_FRAMES) {
+        framePower[frameCount] = (uint32_t)(frameSquares / count);
+        frameIsSpeech[frameCount] = speech;
+        frameCount++;
+    }
+}
+
+void AudioMetrics::addTruncated(size_t count) {
+    if (active) {
+        truncated += count;
+    }
+}
+
+void AudioMetrics::endUtterance() {
+    if (!active) {
+        return;
+    }
+    active = false;
+
+    current.samples = sampleCount;
+    current.durationMs = (uint64_t)sampleCount * 1000 / SAMPLE_RATE;
+    current.speechMs = (uint64_t)speechSamples * 1000 / SAMPLE_RATE;
+    current.clippedSamples = clipped;
+    current.droppedSamples = dropped;
+    current.truncatedSamples = truncated;
+
+    if (sampleCount > 0) {
+        current.dcOffset = (int16_t)(sum / (int64_t)sampleCount);
+        current.peakDbfs = toDbfs((float)peak);
+        current.rmsDbfs = toDbfs(sqrtf((float)sumSquares / sampleCount));
+    } else {
+        current.peakDbfs = current.rmsDbfs = toDbfs(0);
+    }
+
+    // SNR: mean power of speech frames vs mean power of noise frames.
+    // Recordings end on trailing silence, so noise frames are almost always
+    // present; if not, fall back to the quietest frame.
+    uint64_t speechPower = 0, noisePower = 0;
+    int speechFrames = 0, noiseFrames = 0;
+    uint32_t quietest = UINT32_MAX;
+
+    for (int i = 0; i < frameCount; i++) {
+        if (frameIsSpeech[i]) {
+            speechPower += framePower[i];
+            speechFrames++;
+        } else {
+            noisePower += framePower[i];
+            noiseFrames++;
+        }
+        if (framePower[i] < quietest) quietest = framePower[i];
+    }
+
+    float noise = noiseFrames > 0 ? (float)noisePower / noiseFrames : (float)quietest;
+    if (speechFrames > 0) {
+        float speech = (float)speechPower / speechFrames;
+        current.snrDb = 10.0f * log10f(speech / max(noise, 1.0f));
+    } else {
+        current.snrDb = 0;
+    }
+
+    current.timestamp = time(nullptr);
+    pending = true;
+
+    if (dropped > 0 || truncated > 0 || clipped > 0) {
+        log_w("Audio metrics: dropped=%u truncated=%u clipped=%u samples",
+              dropped, truncated, clipped);
+    }
+}
+
+void AudioMetrics::discard() {
+    active = false;
+    pending = false;
+}
+
+const UtteranceMetrics* AudioMetrics::attachResult(const char* transcription, const char* error) {
+    if (!pending) {
+        return nullptr;
+    }
+    pending = false;
+
+    strlcpy(current.transcription, transcription ? transcription : "", sizeof(current.transcription));
+    strlcpy(current.error, error ? error : "", sizeof(current.error));
+    current.id = ++totalCount;
+
+    UtteranceMetrics& slot = history[historyHead];
+    slot = current;
+    historyHead = (historyHead + 1) % AUDIO_METRICS_HISTORY;
+    if (historyCount < AUDIO_METRICS_HISTORY) historyCount++;
+
+    log_i("Audio metrics #%u: %ums (speech %ums), peak %.1f dBFS, rms %.1f dBFS, SNR %.1f dB, DC %d",
+          slot.id, slot.durationMs, slot.speechMs, slot.peakDbfs, slot.rmsDbfs, slot.snrDb, slot.dcOffset);
+
+    return &slot;
+}
+
+const UtteranceMetrics* AudioMetrics::getLast() const {
+    if (historyCount == 0) {
+        return nullptr;
+    }
+    int idx = (historyHead + AUDIO_METRICS_HISTORY - 1) % AUDIO_METRICS_HISTORY;
+    return &history[idx];
+}
+
+void AudioMetrics::toJson(const UtteranceMetrics& m, JsonObject obj) {
+    obj["id"] = m.id;
+    obj["timestamp"] = m.timestamp;
+    obj["transcription"] = m.transcription;
+    if (m.error[0]) {
+        obj["error"] = m.error;
+    }
+    obj["samples"] = m.samples;
+    obj["duration_ms"] = m.durationMs;
+    obj["speech_ms"] = m.speechMs;
+    obj["peak_dbfs"] = roundf(m.peakDbfs * 10) / 10;
+    obj["rms_dbfs"] = roundf(m.rmsDbfs * 10) / 10;
+    obj["snr_db"] = roundf(m.snrDb * 10) / 10;
+    obj["clipped_samples"] = m.clippedSamples;
+    obj["dc_offset"] = m.dcOffset;
+    obj["dropped_samples"] = m.droppedSamples;
+    obj["truncated_samples"] = m.truncatedSamples;
+}
+
+void AudioMetrics::getHistoryJson(JsonDocument& doc) {
+    doc["count"] = totalCount;
+    JsonArray arr = doc["utterances"].to<JsonArray>();
+
+    // Newest first
+    for (int i = 0; i < historyCount; i++) {
+        int idx = (historyHead + AUDIO_METRICS_HISTORY - 1 - i) % AUDIO_METRICS_HISTORY;
+        toJson(history[idx], arr.add<JsonObject>());
+    }
+}
+
+float AudioMetrics::toDbfs(float level) {
+    if (level < 1.0f) {
+        return -96.0f;  // Floor of 16-bit audio
+    }
+    return 20.0f * log10f(level / 32768.0f);
+}
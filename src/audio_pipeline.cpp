@@ -0,0 +1,152 @@
+#include "audio_pipeline.h"
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+// Composable audio pipeline implementation
+
+uint32_t audioPipelineMicros() {
+#ifdef ARDUINO
+    return micros();
+#else
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+const char* audioFormatName(AudioFormat format) {
+    switch (format) {
+        case AUDIO_FORMAT_PCM16: return "pcm16";
+        default:                 return "none";
+    }
+}
+
+// ============================================
+// AudioStage
+// ============================================
+
+AudioStage::AudioStage(const char* stageName, AudioFormat input, AudioFormat output, uint32_t budget)
+    : name(stageName),
+      inputFormat(input),
+      outputFormat(output),
+      budgetUs(budget) {
+    resetStats();
+}
+
+void AudioStage::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+void AudioStage::recordTiming(uint32_t us) {
+    stats.frames++;
+    stats.totalUs += us;
+    stats.lastUs = us;
+    if (us > stats.maxUs) stats.maxUs = us;
+    if (budgetUs > 0 && us > budgetUs) stats.overruns++;
+}
+
+// ============================================
+// AudioPipeline
+// ============================================
+
+AudioPipeline::AudioPipeline()
+    : stageCount(0),
+      frameCount(0),
+      lastFrameUs(0),
+      maxFrameUs(0) {
+    memset(stages, 0, sizeof(stages));
+}
+
+AudioPipeline::~AudioPipeline() {
+    clear();
+}
+
+bool AudioPipeline::addStage(AudioStage* stage) {
+    if (!stage) {
+        return false;
+    }
+
+    if (stageCount >= AUDIO_PIPELINE_MAX_STAGES) {
+        delete stage;
+        return false;
+    }
+
+    AudioFormat expected = stageCount == 0 ? AUDIO_FORMAT_NONE : stages[stageCount - 1]->getOutputFormat();
+    if (stage->getInputFormat() != expected) {
+        delete stage;
+        return false;
+    }
+
+    stages[stageCount++] = stage;
+    return true;
+}
+
+void AudioPipeline::clear() {
+    for (int i = 0; i < stageCount; i++) {
+        delete stages[i];
+        stages[i] = nullptr;
+    }
+    stageCount = 0;
+    resetStats();
+}
+
+bool AudioPipeline::run(AudioFrame& frame) {
+    if (stageCount == 0) {
+        return false;
+    }
+
+    frame.count = 0;
+    frame.seq = frameCount;
+    frame.peak = 0;
+    frame.rms = 0;
+    frame.zeroCrossings = 0;
+    frame.vadTriggered = false;
+
+    uint32_t frameStart = audioPipelineMicros();
+    uint32_t stageStart = frameStart;
+
+    for (int i = 0; i < stageCount; i++) {
+        bool cont = stages[i]->process(frame);
+
+        uint32_t now = audioPipelineMicros();
+        stages[i]->recordTiming(now - stageStart);
+        stageStart = now;
+
+        // Source produced nothing: no frame this time
+        if (i == 0 && frame.count == 0) {
+            return false;
+        }
+        if (!cont) {
+            break;
+        }
+    }
+
+    frameCount++;
+
+    // Total excludes the source, which mostly waits on the I2S DMA
+    lastFrameUs = stageStart - frameStart - stages[0]->getStats().lastUs;
+    if (lastFrameUs > maxFrameUs) maxFrameUs = lastFrameUs;
+    return true;
+}
+
+AudioStage* AudioPipeline::findStage(const char* name) const {
+    for (int i = 0; i < stageCount; i++) {
+        if (strcmp(stages[i]->getName(), name) == 0) {
+            return stages[i];
+        }
+    }
+    return nullptr;
+}
+
+void AudioPipeline::resetStats() {
+    frameCount = 0;
+    lastFrameUs = 0;
+    maxFrameUs = 0;
+    for (int i = 0; i < stageCount; i++) {
+        stages[i]->resetStats();
+    }
+}
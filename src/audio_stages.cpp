@@ -0,0 +1,284 @@
+#include "audio_stages.h"
+#include <math.h>
+
+// Audio pipeline stage implementations
+
+static inline int16_t saturate16(int32_t v) {
+    if (v > 32767) return 32767;
+    if (v < -32768) return -32768;
+    return (int16_t)v;
+}
+
+// ============================================
+// DcRemovalStage
+// ============================================
+
+// y[n] = x[n] - x[n-1] + a * y[n-1], a = 0.995 (Q15) -> ~13 Hz corner at 16 kHz
+static const int32_t DC_POLE_Q15 = 32604;
+
+DcRemovalStage::DcRemovalStage()
+    : AudioStage("condition", AUDIO_FORMAT_PCM16, AUDIO_FORMAT_PCM16, STAGE_BUDGET_CONDITION_US),
+      prevInput(0),
+      prevOutput(0) {
+}
+
+void DcRemovalStage::reset() {
+    prevInput = 0;
+    prevOutput = 0;
+}
+
+bool DcRemovalStage::process(AudioFrame& frame) {
+    for (size_t i = 0; i < frame.count; i++) {
+        int32_t x = frame.samples[i];
+        int32_t y = x - prevInput + ((DC_POLE_Q15 * prevOutput) >> 15);
+        prevInput = x;
+        prevOutput = y;
+        frame.samples[i] = saturate16(y);
+    }
+    return true;
+}
+
+// ============================================
+// AgcStage
+// ============================================
+
+AgcStage::AgcStage(int16_t target, uint8_t maxGain, int16_t gate)
+    : AudioStage("agc", AUDIO_FORMAT_PCM16, AUDIO_FORMAT_PCM16, STAGE_BUDGET_AGC_US),
+      targetPeak(target),
+      maxGainQ8((int32_t)maxGain * 256),
+      noiseGate(gate),
+      gainQ8(256) {
+}
+
+void AgcStage::reset() {
+    gainQ8 = 256;
+}
+
+bool AgcStage::process(AudioFrame& frame) {
+    int32_t peak = 0;
+    for (size_t i = 0; i < frame.count; i++) {
+        int32_t a = frame.samples[i] < 0 ? -frame.samples[i] : frame.samples[i];
+        if (a > peak) peak = a;
+    }
+
+    // Fast attack when the signal would clip, slow release otherwise.
+    // Below the noise gate the gain is held so room noise is not pumped up.
+    if (peak > noiseGate) {
+        int32_t desired = (targetPeak << 8) / peak;
+        if (desired > maxGainQ8) desired = maxGainQ8;
+        if (desired < 64) desired = 64;
+
+        if (desired < gainQ8) {
+            gainQ8 -= (gainQ8 - desired + 3) / 4;
+        } else {
+            gainQ8 += (desired - gainQ8) / 64;
+        }
+    }
+
+    if (gainQ8 != 256) {
+        for (size_t i = 0; i < frame.count; i++) {
+            frame.samples[i] = saturate16(((int32_t)frame.samples[i] * gainQ8) >> 8);
+        }
+    }
+    return true;
+}
+
+// ============================================
+// LevelStage
+// ============================================
+
+LevelStage::LevelStage()
+    : AudioStage("level", AUDIO_FORMAT_PCM16, AUDIO_FORMAT_PCM16, STAGE_BUDGET_LEVEL_US) {
+}
+
+bool LevelStage::process(AudioFrame& frame) {
+    int32_t peak = 0;
+    uint64_t sumSquares = 0;
+
+    for (size_t i = 0; i < frame.count; i++) {
+        int32_t s = frame.samples[i];
+        int32_t a = s < 0 ? -s : s;
+        if (a > peak) peak = a;
+        sumSquares += (uint32_t)(s * s);
+    }
+
+    frame.peak = saturate16(peak);
+    frame.rms = frame.count > 0 ? (int16_t)sqrtf((float)sumSquares / frame.count) : 0;
+    return true;
+}
+
+// ============================================
+// FeatureStage
+// ============================================
+
+FeatureStage::FeatureStage()
+    : AudioStage("features", AUDIO_FORMAT_PCM16, AUDIO_FORMAT_PCM16, STAGE_BUDGET_FEATURES_US) {
+}
+
+bool FeatureStage::process(AudioFrame& frame) {
+    uint16_t crossings = 0;
+    for (size_t i = 1; i < frame.count; i++) {
+        if ((frame.samples[i - 1] < 0) != (frame.samples[i] < 0)) {
+            crossings++;
+        }
+    }
+    frame.zeroCrossings = crossings;
+    return true;
+}
+
+// ============================================
+// Device stages
+// ============================================
+#ifdef ARDUINO
+#include "audio_handler.h"
+#include "voice_activity_handler.h"
+#include "ha_assist_client.h"
+#include "sound_events.h"
+#include "tone_detector.h"
+
+AudioPipeline audioPipeline;
+
+I2SSourceStage::I2SSourceStage()
+    : AudioStage("source", AUDIO_FORMAT_NONE, AUDIO_FORMAT_PCM16, AUDIO_FRAME_PERIOD_US) {
+}
+
+bool I2SSourceStage::process(AudioFrame& frame) {
+    frame.count = audioHandler.readAudio(frame.samples, AUDIO_FRAME_SAMPLES);
+    return frame.count > 0;
+}
+
+VadStage::VadStage()
+    : AudioStage("vad", AUDIO_FORMAT_PCM16, AUDIO_FORMAT_PCM16, STAGE_BUDGET_VAD_US) {
+}
+
+bool VadStage::process(AudioFrame& frame) {
+    if (frame.vadArmed) {
+        frame.vadTriggered = voiceActivity.processAudioFrame(frame.samples, frame.count);
+    }
+    return true;
+}
+
+RecorderStage::RecorderStage()
+    : AudioStage("recorder", AUDIO_FORMAT_PCM16, AUDIO_FORMAT_PCM16, STAGE_BUDGET_RECORDER_US) {
+}
+
+bool RecorderStage::process(AudioFrame& frame) {
+    // No-op unless HA Assist is recording
+    haAssist.feedAudio(frame.samples, frame.count);
+    return true;
+}
+
+volatile AudioFrameSink StreamerStage::sink = nullptr;
+
+StreamerStage::StreamerStage()
+    : AudioStage("streamer", AUDIO_FORMAT_PCM16, AUDIO_FORMAT_NONE, STAGE_BUDGET_STREAMER_US) {
+}
+
+void StreamerStage::setSink(AudioFrameSink newSink) {
+    sink = newSink;
+}
+
+bool StreamerStage::process(AudioFrame& frame) {
+    AudioFrameSink current = sink;
+    if (current) {
+        current(frame);
+    }
+    return true;
+}
+
+// ============================================
+// Pipeline setup
+// ============================================
+
+static const char* DEFAULT_PIPELINE[] = { "source", "level", "vad", "tones", "events", "recorder", "streamer" };
+
+static AudioStage* createStage(const char* name, JsonVariantConst options) {
+    if (strcmp(name, "source") == 0)    return new I2SSourceStage();
+    if (strcmp(name, "condition") == 0) return new DcRemovalStage();
+    if (strcmp(name, "level") == 0)     return new LevelStage();
+    if (strcmp(name, "features") == 0)  return new FeatureStage();
+    if (strcmp(name, "vad") == 0)       return new VadStage();
+    if (strcmp(name, "tones") == 0)     return new ToneStage();
+    if (strcmp(name, "events") == 0)    return new SoundEventStage();
+    if (strcmp(name, "recorder") == 0)  return new RecorderStage();
+    if (strcmp(name, "streamer") == 0)  return new StreamerStage();
+    if (strcmp(name, "agc") == 0) {
+        return new AgcStage(options["target"] | 8000, options["max_gain"] | 8, options["noise_gate"] | 200);
+    }
+    return nullptr;
+}
+
+static bool buildPipeline(JsonArrayConst stages) {
+    audioPipeline.clear();
+
+    for (JsonVariantConst entry : stages) {
+        // Entries are either "name" or {"stage": "name", "budget_us": N, ...}
+        const char* name = entry.is<const char*>() ? entry.as<const char*>() : (entry["stage"] | "");
+
+        AudioStage* stage = createStage(name, entry);
+        if (!stage) {
+            log_e("Audio pipeline: unknown stage '%s'", name);
+            return false;
+        }
+
+        uint32_t budget = entry["budget_us"] | 0;
+        if (budget > 0) {
+            stage->setBudgetUs(budget);
+        }
+
+        AudioFormat input = stage->getInputFormat();
+        if (!audioPipeline.addStage(stage)) {
+            log_e("Audio pipeline: stage '%s' (input %s) cannot follow previous stage",
+                  name, audioFormatName(input));
+            return false;
+        }
+    }
+
+    // The voice state machine depends on these
+    if (!audioPipeline.findStage("source") || !audioPipeline.findStage("level") ||
+        !audioPipeline.findStage("recorder")) {
+        log_e("Audio pipeline: 'source', 'level' and 'recorder' stages are required");
+        return false;
+    }
+    return true;
+}
+
+bool setupAudioPipeline(JsonDocument& config) {
+    JsonArrayConst configured = config["voice"]["pipeline"];
+
+    if (!configured.isNull() && buildPipeline(configured)) {
+        log_i("Audio pipeline: %d stages from config", audioPipeline.getStageCount());
+        return true;
+    }
+
+    JsonDocument defaults;
+    for (const char* name : DEFAULT_PIPELINE) {
+        defaults.add(name);
+    }
+    bool ok = buildPipeline(defaults.as<JsonArrayConst>());
+    log_i("Audio pipeline: %d default stages", audioPipeline.getStageCount());
+    return ok;
+}
+
+void getAudioPipelineStatsJson(JsonObject obj) {
+    obj["frames"] = audioPipeline.getFrameCount();
+    obj["frame_period_us"] = AUDIO_FRAME_PERIOD_US;
+    obj["last_frame_us"] = audioPipeline.getLastFrameUs();
+    obj["max_frame_us"] = audioPipeline.getMaxFrameUs();
+
+    JsonArray stages = obj["stages"].to<JsonArray>();
+    for (int i = 0; i < audioPipeline.getStageCount(); i++) {
+        AudioStage* stage = audioPipeline.getStage(i);
+        const AudioStageStats& stats = stage->getStats();
+
+        JsonObject s = stages.add<JsonObject>();
+        s["name"] = stage->getName();
+        s["in"] = audioFormatName(stage->getInputFormat());
+        s["out"] = audioFormatName(stage->getOutputFormat());
+        s["budget_us"] = stage->getBudgetUs();
+        s["avg_us"] = stats.frames > 0 ? (uint32_t)(stats.totalUs / stats.frames) : 0;
+        s["max_us"] = stats.maxUs;
+        s["overruns"] = stats.overruns;
+    }
+}
+#endif
@@ -0,0 +1,278 @@
+#include "boot_profiler.h"
+#include "flash_record.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char* const RESET_NAMES[] = {
+    "unknown", "power_on", "external", "software", "panic", "int_watchdog",
+    "task_watchdog", "watchdog", "deep_sleep", "brownout", "sdio"
+};
+
+const char* bootResetName(uint8_t reason) {
+    if (reason >= sizeof(RESET_NAMES) / sizeof(RESET_NAMES[0])) {
+        return "unknown";
+    }
+    return RESET_NAMES[reason];
+}
+
+static void copyText(char* dst, size_t size, const char* src) {
+    snprintf(dst, size, "%s", src ? src : "");
+}
+
+// ============================================
+// Trace
+// ============================================
+static uint32_t traceCrc(const BootTrace& t) {
+    return flashRecordCrc((const uint8_t*)&t, offsetof(BootTrace, crc));
+}
+
+void bootTraceReset(BootTrace& t) {
+    memset(&t, 0, sizeof(t));
+    t.magic = BOOT_TRACE_MAGIC;
+    t.crc = traceCrc(t);
+}
+
+bool bootTraceValid(const BootTrace& t) {
+    return t.magic == BOOT_TRACE_MAGIC && t.crc == traceCrc(t) &&
+           memchr(t.stage, '\0', sizeof(t.stage)) && memchr(t.note, '\0', sizeof(t.note));
+}
+
+void bootTraceSetStage(BootTrace& t, const char* stage) {
+    copyText(t.stage, sizeof(t.stage), stage);
+    t.crc = traceCrc(t);
+}
+
+void bootTraceSetNote(BootTrace& t, const char* note) {
+    copyText(t.note, sizeof(t.note), note);
+    t.crc = traceCrc(t);
+}
+
+void bootTraceSetUptime(BootTrace& t, uint32_t uptimeS) {
+    t.uptimeS = uptimeS;
+    t.crc = traceCrc(t);
+}
+
+// ============================================
+// Records
+// ============================================
+void bootRecordStart(BootRecord& r, uint8_t resetReason, const BootTrace& previous, const char* version) {
+    memset(&r, 0, sizeof(r));
+    r.resetReason = resetReason;
+    // Power-on clears RTC memory; a trace that checks out anyway is stale
+    r.traced = resetReason != BOOT_RESET_POWERON && bootTraceValid(previous);
+    if (r.traced) {
+        copyText(r.lastStage, sizeof(r.lastStage), previous.stage);
+        copyText(r.note, sizeof(r.note), previous.note);
+        r.prevUptimeS = previous.uptimeS;
+    }
+    copyText(r.version, sizeof(r.version), version);
+}
+
+BootHistory::BootHistory() : head(0), count(0), nextSeq(1) {
+    memset(records, 0, sizeof(records));
+}
+
+BootRecord& BootHistory::add(const BootRecord& r) {
+    BootRecord& slot = records[head];
+    slot = r;
+    slot.seq = nextSeq++;
+    head = (head + 1) % BOOT_HISTORY_LEN;
+    if (count < BOOT_HISTORY_LEN) {
+        count++;
+    }
+    return slot;
+}
+
+const BootRecord& BootHistory::get(int i) const {
+    return records[(head + BOOT_HISTORY_LEN - 1 - i) % BOOT_HISTORY_LEN];
+}
+
+size_t BootHistory::serialize(uint8_t* out, size_t size) const {
+    if (size < sizeof(Image)) {
+        return 0;
+    }
+    Image img;
+    memset(&img, 0, sizeof(img));
+    img.version = BOOT_HISTORY_VERSION;
+    img.nextSeq = nextSeq;
+    img.head = head;
+    img.count = count;
+    memcpy(img.records, records, sizeof(records));
+    img.crc = flashRecordCrc((const uint8_t*)&img.nextSeq, sizeof(img) - offsetof(Image, nextSeq));
+    memcpy(out, &img, sizeof(img));
+    return sizeof(img);
+}
+
+bool BootHistory::deserialize(const uint8_t* in, size_t size) {
+    *this = BootHistory();
+    // Another size means BootRecord changed without a version bump
+    if (size != sizeof(Image)) {
+        return false;
+    }
+    Image img;
+    memcpy(&img, in, sizeof(img));
+    if (img.version != BOOT_HISTORY_VERSION ||
+        img.crc != flashRecordCrc((const uint8_t*)&img.nextSeq, sizeof(img) - offsetof(Image, nextSeq)) ||
+        img.head >= BOOT_HISTORY_LEN || img.count > BOOT_HISTORY_LEN) {
+        return false;
+    }
+    nextSeq = img.nextSeq;
+    head = img.head;
+    count = img.count;
+    memcpy(records, img.records, sizeof(records));
+    for (BootRecord& r : records) {
+        r.lastStage[BOOT_STAGE_LEN - 1] = '\0';
+        r.note[BOOT_NOTE_LEN - 1] = '\0';
+        r.slowest[BOOT_STAGE_LEN - 1] = '\0';
+        r.version[BOOT_VERSION_LEN - 1] = '\0';
+    }
+    return true;
+}
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include <Preferences.h>
+#include <esp_system.h>
+#include "config.h"
+
+BootProfiler bootProfiler;
+
+// Not cleared on reset; bootRecordStart() checks it
+static RTC_NOINIT_ATTR BootTrace rtcTrace;
+
+// setStage() runs on the main loop, noteRestart() also on boot workers
+static portMUX_TYPE traceLock = portMUX_INITIALIZER_UNLOCKED;
+
+BootProfiler::BootProfiler() : started(false), lastUptimeWrite(0) {
+}
+
+void BootProfiler::begin() {
+    uint8_t reason = (uint8_t)esp_reset_reason();
+    BootRecord current;
+    bootRecordStart(current, reason, rtcTrace, DEVICE_VERSION);
+    bootTraceReset(rtcTrace);
+    bootTraceSetStage(rtcTrace, "setup");
+
+    Preferences prefs;
+    if (prefs.begin(BOOT_NVS_NAMESPACE, true)) {
+        size_t size = prefs.getBytesLength(BOOT_NVS_KEY);
+        if (size > 0) {
+            uint8_t* buf = (uint8_t*)malloc(size);
+            if (buf && prefs.getBytes(BOOT_NVS_KEY, buf, size) == size && !history.deserialize(buf, size)) {
+                log_w("Boot history unreadable, starting a new one");
+            }
+            free(buf);
+        }
+        prefs.end();
+    }
+
+    const BootRecord& r = history.add(current);
+    started = true;
+    save();
+
+    Serial.printf("Boot #%lu: reset %s", (unsigned long)r.seq, bootResetName(r.resetReason));
+    if (r.traced) {
+        Serial.printf(", previous run in %s after %lu s%s%s", r.lastStage, (unsigned long)r.prevUptimeS,
+                      r.note[0] ? ", restart: " : "", r.note);
+    }
+    Serial.println();
+}
+
+void BootProfiler::setStage(const char* stage) {
+    portENTER_CRITICAL(&traceLock);
+    bootTraceSetStage(rtcTrace, stage);
+    portEXIT_CRITICAL(&traceLock);
+}
+
+void BootProfiler::noteRestart(const char* reason) {
+    portENTER_CRITICAL(&traceLock);
+    bootTraceSetNote(rtcTrace, reason);
+    bootTraceSetUptime(rtcTrace, millis() / 1000);
+    portEXIT_CRITICAL(&traceLock);
+}
+
+void BootProfiler::finish(uint32_t dashboardUs, uint32_t finishedUs, const char* slowest, uint32_t slowestUs) {
+    setStage(BOOT_STAGE_RUNNING);
+    if (!started) {
+        return;
+    }
+    BootRecord& r = history.newest();
+    r.dashboardUs = dashboardUs;
+    r.finishedUs = finishedUs;
+    copyText(r.slowest, sizeof(r.slowest), slowest);
+    r.slowestUs = slowestUs;
+    save();
+}
+
+void BootProfiler::loop() {
+    if (millis() - lastUptimeWrite < BOOT_UPTIME_STEP_S * 1000UL) {
+        return;
+    }
+    lastUptimeWrite = millis();
+    portENTER_CRITICAL(&traceLock);
+    bootTraceSetUptime(rtcTrace, millis() / 1000);
+    portEXIT_CRITICAL(&traceLock);
+}
+
+void BootProfiler::save() {
+    uint8_t* buf = (uint8_t*)malloc(history.serializedSize());
+    if (!buf) {
+        return;
+    }
+    size_t size = history.serialize(buf, history.serializedSize());
+    Preferences prefs;
+    if (prefs.begin(BOOT_NVS_NAMESPACE, false)) {
+        if (prefs.putBytes(BOOT_NVS_KEY, buf, size) != size) {
+            log_w("Boot history not saved");
+        }
+        prefs.end();
+    }
+    free(buf);
+}
+
+static void recordJson(const BootRecord& r, JsonObject obj) {
+    obj["seq"] = r.seq;
+    obj["reset_reason"] = bootResetName(r.resetReason);
+    if (r.traced) {
+        obj["last_stage"] = r.lastStage;
+        obj["uptime_s"] = r.prevUptimeS;
+        if (r.note[0]) {
+            obj["restart"] = r.note;
+        }
+    }
+    if (r.dashboardUs) {
+        obj["dashboard_us"] = r.dashboardUs;
+    }
+    if (r.finishedUs) {
+        obj["finished_us"] = r.finishedUs;
+        obj["slowest"] = r.slowest;
+        obj["slowest_us"] = r.slowestUs;
+    }
+    obj["version"] = r.version;
+}
+
+void BootProfiler::getStatusJson(JsonObject obj, int maxHistory) {
+    if (!started) {
+        return;
+    }
+    const BootRecord& r = history.get(0);
+    obj["seq"] = r.seq;
+    obj["reset_reason"] = bootResetName(r.resetReason);
+    if (r.traced) {
+        JsonObject prev = obj["previous"].to<JsonObject>();
+        prev["last_stage"] = r.lastStage;
+        prev["uptime_s"] = r.prevUptimeS;
+        if (r.note[0]) {
+            prev["restart"] = r.note;
+        }
+    }
+
+    JsonArray list = obj["history"].to<JsonArray>();
+    for (int i = 0; i < history.getCount() && i < maxHistory; i++) {
+        recordJson(history.get(i), list.add<JsonObject>());
+    }
+}
+
+#endif
@@ -0,0 +1,253 @@
+#include "boot_sequencer.h"
+#include <stdio.h>
+#include <string.h>
+
+BootGraph::BootGraph() : count(0), doneCount(0), running(0), doneMask(0) {
+    memset(tasks, 0, sizeof(tasks));
+}
+
+int BootGraph::add(const BootTaskSpec& spec, uint32_t deps) {
+    if (count >= BOOT_MAX_TASKS || !spec.run) {
+        return -1;
+    }
+    // Only tasks already added: keeps the graph acyclic
+    if (deps & ~(BOOT_DEP(count) - 1)) {
+        return -1;
+    }
+    int id = count++;
+    Task& t = tasks[id];
+    t.spec = spec;
+    t.deps = deps;
+    t.state = BOOT_WAITING;
+    return id;
+}
+
+int BootGraph::next(BootWhere where) {
+    for (int id = 0; id < count; id++) {
+        Task& t = tasks[id];
+        if (t.state == BOOT_WAITING && t.spec.where == where && (t.deps & ~doneMask) == 0) {
+            t.state = BOOT_RUNNING;
+            running++;
+            return id;
+        }
+    }
+    return -1;
+}
+
+void BootGraph::finish(int id, bool ok, uint32_t startUs, uint32_t endUs) {
+    if (id < 0 || id >= count || tasks[id].state != BOOT_RUNNING) {
+        return;
+    }
+    Task& t = tasks[id];
+    t.state = BOOT_DONE;
+    t.ok = ok;
+    t.startUs = startUs;
+    t.endUs = endUs;
+    running--;
+    doneCount++;
+    doneMask |= BOOT_DEP(id);
+}
+
+void BootGraph::describeRunning(char* out, size_t size) const {
+    size_t len = 0;
+    out[0] = '\0';
+    for (int id = 0; id < count; id++) {
+        if (tasks[id].state != BOOT_RUNNING) {
+            continue;
+        }
+        int n = snprintf(out + len, size - len, "%s%s", len ? "+" : "", tasks[id].spec.name);
+        if (n < 0 || (size_t)n >= size - len) {
+            out[len] = '\0';     // Whole names only
+            return;
+        }
+        len += n;
+    }
+}
+
+int BootGraph::getSlowest() const {
+    int slowest = -1;
+    for (int id = 0; id < count; id++) {
+        if (tasks[id].state == BOOT_DONE &&
+            (slowest < 0 || tasks[id].endUs - tasks[id].startUs > tasks[slowest].endUs - tasks[slowest].startUs)) {
+            slowest = id;
+        }
+    }
+    return slowest;
+}
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+
+BootSequencer bootSequencer;
+
+BootSequencer::BootSequencer() : work(nullptr), results(nullptr), workers(0), finishedUs(0),
+                                 stageFn(nullptr), stageCtx(nullptr) {
+}
+
+int BootSequencer::add(const BootTaskSpec& spec, uint32_t deps) {
+    int id = graph.add(spec, deps);
+    if (id < 0) {
+        log_e("Boot: cannot add task %s", spec.name);
+    }
+    return id;
+}
+
+void BootSequencer::setStageCallback(BootStageFn fn, void* ctx) {
+    stageFn = fn;
+    stageCtx = ctx;
+}
+
+void BootSequencer::reportStage() {
+    if (stageFn) {
+        char running[64];
+        graph.describeRunning(running, sizeof(running));
+        stageFn(running, stageCtx);
+    }
+}
+
+bool BootSequencer::start() {
+    work = xQueueCreate(BOOT_MAX_TASKS + BOOT_WORKERS, sizeof(int));
+    results = xQueueCreate(BOOT_MAX_TASKS, sizeof(Result));
+    if (!work || !results) {
+        log_e("Boot: no queues, worker tasks run on the main loop");
+        return false;
+    }
+    for (int i = 0; i < BOOT_WORKERS; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "boot_%d", i);
+        // WiFiManager's portal and HTTPClient need the stack
+        if (xTaskCreatePinnedToCore(workerTask, name, 8192, this, 1, nullptr, 0) != pdPASS) {
+            log_e("Boot: cannot start worker %d", i);
+            break;
+        }
+        workers++;
+    }
+    return workers > 0;
+}
+
+void BootSequencer::workerTask(void* param) {
+    BootSequencer* self = (BootSequencer*)param;
+    int id;
+    while (xQueueReceive(self->work, &id, portMAX_DELAY) == pdTRUE && id >= 0) {
+        const BootTaskSpec& spec = self->graph.getSpec(id);
+        Result r;
+        r.id = id;
+        r.startUs = micros();
+        r.ok = spec.run(spec.ctx);
+        r.endUs = micros();
+        xQueueSend(self->results, &r, portMAX_DELAY);
+    }
+    vTaskDelete(nullptr);
+}
+
+void BootSequencer::runTask(int id) {
+    const BootTaskSpec& spec = graph.getSpec(id);
+    reportStage();
+    uint32_t startUs = micros();
+    bool ok = spec.run(spec.ctx);
+    finishTask(id, ok, startUs, micros());
+}
+
+void BootSequencer::finishTask(int id, bool ok, uint32_t startUs, uint32_t endUs) {
+    const BootTaskSpec& spec = graph.getSpec(id);
+    if (spec.where == BOOT_WORKER && spec.done) {
+        spec.done(ok, spec.ctx);
+    }
+    graph.finish(id, ok, startUs, endUs);
+    reportStage();
+    Serial.printf("→ %s %s (%lu ms, at %lu ms)\n", spec.name, ok ? "✓" : "✗",
+                  (unsigned long)((endUs - startUs) / 1000), (unsigned long)(endUs / 1000));
+
+    if (graph.isFinished()) {
+        finishedUs = micros();
+        for (int i = 0; i < workers; i++) {
+            int stop = -1;
+            xQueueSend(work, &stop, 0);
+        }
+        workers = 0;
+    }
+}
+
+void BootSequencer::loop() {
+    if (graph.isFinished()) {
+        return;
+    }
+
+    Result r;
+    while (results && xQueueReceive(results, &r, 0) == pdTRUE) {
+        finishTask(r.id, r.ok, r.startUs, r.endUs);
+    }
+
+    int id;
+    while ((id = graph.next(BOOT_WORKER)) >= 0) {
+        if (workers > 0) {
+            xQueueSend(work, &id, portMAX_DELAY);
+            reportStage();
+        } else {
+            runTask(id);
+        }
+    }
+
+    uint32_t passStart = millis();
+    while ((id = graph.next(BOOT_MAIN)) >= 0) {
+        runTask(id);
+        if (millis() - passStart >= BOOT_PASS_BUDGET_MS) {
+            break;
+        }
+    }
+}
+
+bool BootSequencer::runUntil(int id, uint32_t timeoutMs) {
+    uint32_t start = millis();
+    while (!graph.isDone(id)) {
+        if (millis() - start >= timeoutMs) {
+            log_w("Boot: %s not done after %lu ms", graph.getSpec(id).name, (unsigned long)timeoutMs);
+            return false;
+        }
+        loop();
+        if (!graph.isDone(id)) {
+            delay(1);           // Waiting on a worker
+        }
+    }
+    return true;
+}
+
+void BootSequencer::getStatusJson(JsonObject obj) {
+    obj["finished"] = graph.isFinished();
+    obj["finished_us"] = finishedUs;
+
+    JsonArray list = obj["tasks"].to<JsonArray>();
+    for (int i = 0; i < graph.getCount(); i++) {
+        const BootTaskSpec& spec = graph.getSpec(i);
+        JsonObject t = list.add<JsonObject>();
+        t["name"] = spec.name;
+        t["where"] = spec.where == BOOT_WORKER ? "worker" : "main";
+        BootState state = graph.getState(i);
+        t["state"] = state == BOOT_DONE ? (graph.getOk(i) ? "ok" : "failed") :
+                     state == BOOT_RUNNING ? "running" : "waiting";
+        JsonArray deps = t["deps"].to<JsonArray>();
+        for (int d = 0; d < i; d++) {
+            if (graph.getDeps(i) & BOOT_DEP(d)) {
+                deps.add(graph.getSpec(d).name);
+            }
+        }
+        if (state == BOOT_DONE) {
+            t["start_us"] = graph.getStartUs(i);
+            t["duration_us"] = graph.getEndUs(i) - graph.getStartUs(i);
+        }
+    }
+}
+
+void BootSequencer::getTimingsJson(JsonObject obj) {
+    for (int i = 0; i < graph.getCount(); i++) {
+        if (graph.getState(i) == BOOT_DONE) {
+            JsonArray t = obj[graph.getSpec(i).name].to<JsonArray>();
+            t.add(graph.getStartUs(i));
+            t.add(graph.getEndUs(i) - graph.getStartUs(i));
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,102 @@
+#include "change_filter.h"
+#include <string.h>
+
+ChangeHash& ChangeHash::add(const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return *this;
+}
+
+ChangeHash& ChangeHash::add(const char* text) {
+    return add(text ? text : "", strlen(text ? text : "") + 1);
+}
+
+ChangeFilter::ChangeFilter() : count(0), hourStart(0), started(false) {
+    memset(entries, 0, sizeof(entries));
+    memset(&total, 0, sizeof(total));
+}
+
+void ChangeFilter::rollHour(ChangeStats& s) {
+    s.suppressedLastHour = s.suppressedThisHour;
+    s.suppressedThisHour = 0;
+}
+
+void ChangeFilter::rollHour(uint32_t now) {
+    if (!started) {
+        started = true;
+        hourStart = now;
+        return;
+    }
+    if (now - hourStart < CHANGE_HOUR_MS) {
+        return;
+    }
+    // A whole idle hour in between leaves nothing for the last one
+    bool skipped = now - hourStart >= 2 * CHANGE_HOUR_MS;
+    rollHour(total);
+    for (int i = 0; i < count; i++) {
+        rollHour(entries[i].stats);
+    }
+    if (skipped) {
+        total.suppressedLastHour = 0;
+        for (int i = 0; i < count; i++) {
+            entries[i].stats.suppressedLastHour = 0;
+        }
+    }
+    hourStart += (now - hourStart) / CHANGE_HOUR_MS * CHANGE_HOUR_MS;
+}
+
+bool ChangeFilter::update(const char* key, uint32_t hash, uint32_t now) {
+    rollHour(now);
+
+    Entry* e = nullptr;
+    for (int i = 0; i < count; i++) {
+        if (strncmp(entries[i].key, key, CHANGE_KEY_LEN - 1) == 0) {
+            e = &entries[i];
+            break;
+        }
+    }
+    if (!e) {
+        if (count >= CHANGE_MAX_KEYS) {
+            return true;        // Untracked keys are never suppressed
+        }
+        // Filled in before it is counted: status readers may be on another task
+        e = &entries[count];
+        strncpy(e->key, key, CHANGE_KEY_LEN - 1);
+        e->key[CHANGE_KEY_LEN - 1] = '\0';
+        count++;
+    }
+
+    if (e->valid && e->hash == hash) {
+        e->stats.suppressed++;
+        e->stats.suppressedThisHour++;
+        total.suppressed++;
+        total.suppressedThisHour++;
+        return false;
+    }
+    e->hash = hash;
+    e->valid = true;
+    e->stats.changes++;
+    total.changes++;
+    return true;
+}
+
+void ChangeFilter::invalidate(const char* key) {
+    for (int i = 0; i < count; i++) {
+        if (strncmp(entries[i].key, key, CHANGE_KEY_LEN - 1) == 0) {
+            entries[i].valid = false;
+        }
+    }
+}
+
+void ChangeFilter::invalidateAll() {
+    for (int i = 0; i < count; i++) {
+        entries[i].valid = false;
+    }
+}
+
+const ChangeStats& ChangeFilter::getStats(uint32_t now) {
+    rollHour(now);
+    return total;
+}
@@ -0,0 +1,1055 @@
+#include "command_engine.h"
+#include <string.h>
+#include <ctype.h>
+#include <algorithm>
+
+// ============================================
+// Action parsing
+// ============================================
+
+static bool copyField(char* dst, size_t size, const char* src, size_t len) {
+    if (len == 0 || len >= size) {
+        return false;
+    }
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+    return true;
+}
+
+bool parseCommandAction(const char* action, CommandAction& out) {
+    memset(&out, 0, sizeof(out));
+    if (!action) {
+        return false;
+    }
+
+    if (strncmp(action, "homeassistant:", 14) == 0) {
+        const char* entity = action + 14;
+        const char* dot = strchr(entity, '.');
+        const char* sep = dot ? strchr(dot, ':') : nullptr;
+        if (!sep) {
+            return false;
+        }
+        out.type = CMD_ACTION_HOMEASSISTANT;
+        return copyField(out.domain, sizeof(out.domain), entity, dot - entity) &&
+               copyField(out.target, sizeof(out.target), dot + 1, sep - dot - 1) &&
+               copyField(out.arg, sizeof(out.arg), sep + 1, strlen(sep + 1));
+    }
+
+    if (strncmp(action, "scene:", 6) == 0) {
+        out.type = CMD_ACTION_SCENE;
+        return copyField(out.target, sizeof(out.target), action + 6, strlen(action + 6));
+    }
+
+    if (strncmp(action, "mqtt:", 5) == 0) {
+        const char* topic = action + 5;
+        const char* sep = strchr(topic, ':');
+        out.type = CMD_ACTION_MQTT;
+        if (!sep) {
+            return copyField(out.target, sizeof(out.target), topic, strlen(topic));
+        }
+        // Payload may be empty
+        size_t payloadLen = strlen(sep + 1);
+        if (payloadLen >= sizeof(out.arg)) {
+            return false;
+        }
+        memcpy(out.arg, sep + 1, payloadLen + 1);
+        return copyField(out.target, sizeof(out.target), topic, sep - topic);
+    }
+
+    if (strncmp(action, "query:", 6) == 0) {
+        out.type = CMD_ACTION_QUERY;
+        return copyField(out.target, sizeof(out.target), action + 6, strlen(action + 6));
+    }
+
+    return false;
+}
+
+// ============================================
+// Phonetic keys
+// ============================================
+
+static bool isVowel(char c) {
+    return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u';
+}
+
+size_t phoneticKey(const char* w, size_t len, char* key) {
+    size_t n = 0;
+    auto at = [&](size_t i) -> char { return i < len ? w[i] : '\0'; };
+    auto emit = [&](char c) {
+        if (n < COMMAND_KEY_LEN) {
+            key[n++] = c;
+        }
+    };
+
+    size_t i = 0;
+    // Silent or special initial letters
+    if (len >= 2) {
+        char a = w[0], b = w[1];
+        if (((a == 'k' || a == 'g' || a == 'p') && b == 'n') || (a == 'w' && b == 'r') || (a == 'a' && b == 'e')) {
+            i = 1;
+        } else if (a == 'w' && b == 'h') {
+            emit('W');
+            i = 2;
+        }
+    }
+    if (i == 0 && len > 0 && w[0] == 'x') {
+        emit('S');
+        i = 1;
+    }
+
+    for (; i < len && n < COMMAND_KEY_LEN; i++) {
+        char c = w[i];
+        char prev = i ? w[i - 1] : '\0';
+        char next = at(i + 1);
+        if (c == prev && c != 'c') {
+            continue;
+        }
+        if (isVowel(c)) {
+            if (i == 0) {
+                emit('A');
+            }
+            continue;
+        }
+        switch (c) {
+            case 'b':
+                if (!(prev == 'm' && i + 1 == len)) emit('B');
+                break;
+            case 'c':
+                if (next == 'i' && at(i + 2) == 'a') {
+                    emit('X');
+                } else if (next == 'h') {
+                    emit(prev == 's' ? 'K' : 'X');
+                    i++;
+                } else if (next == 'i' || next == 'e' || next == 'y') {
+                    if (prev != 's') emit('S');
+                } else {
+                    emit('K');
+                }
+                break;
+            case 'd':
+                if (next == 'g' && (at(i + 2) == 'e' || at(i + 2) == 'i' || at(i + 2) == 'y')) {
+                    emit('J');
+                    i++;
+                } else {
+                    emit('T');
+                }
+                break;
+            case 'g':
+                if (next == 'h') {
+                    // "light", "night": silent before a consonant or at the end
+                    if (!isVowel(at(i + 2))) {
+                        i++;
+                        break;
+                    }
+                    emit('K');
+                    i++;
+                } else if (next == 'n' && i + 2 == len) {
+                    // "sign"
+                } else if ((next == 'i' || next == 'e' || next == 'y') && prev != 'g') {
+                    emit('J');
+                } else {
+                    emit('K');
+                }
+                break;
+            case 'h':
+                if (isVowel(next) && !(prev == 'c' || prev == 'g' || prev == 'p' || prev == 's' || prev == 't')) {
+                    emit('H');
+                }
+                break;
+            case 'k':
+                if (prev != 'c') emit('K');
+                break;
+            case 'p':
+                if (next == 'h') {
+                    emit('F');
+                    i++;
+                } else {
+                    emit('P');
+                }
+                break;
+            case 'q':
+                emit('K');
+                break;
+            case 's':
+                if (next == 'h') {
+                    emit('X');
+                    i++;
+                } else if (next == 'i' && (at(i + 2) == 'o' || at(i + 2) == 'a')) {
+                    emit('X');
+                } else {
+                    emit('S');
+                }
+                break;
+            case 't':
+                if (next == 'i' && (at(i + 2) == 'o' || at(i + 2) == 'a')) {
+                    emit('X');
+                } else if (next == 'h') {
+                    emit('0');      // "th"
+                    i++;
+                } else if (!(next == 'c' && at(i + 2) == 'h')) {
+                    emit('T');
+                }
+                break;
+            case 'v':
+                emit('F');
+                break;
+            case 'w':
+            case 'y':
+                if (isVowel(next)) emit(c == 'w' ? 'W' : 'Y');
+                break;
+            case 'x':
+                emit('K');
+                emit('S');
+                break;
+            case 'z':
+                emit('S');
+                break;
+            default:
+                if (c >= 'a' && c <= 'z') {
+                    emit((char)(c - 'a' + 'A'));    // f j l m n r
+                } else if (c >= '0' && c <= '9') {
+                    emit(c);
+                }
+                break;
+        }
+    }
+    return n;
+}
+
+// ============================================
+// Tokenizer
+// ============================================
+
+static const char* const FILLER_WORDS[] = {
+    "the", "a", "an", "please", "my", "our", "hey", "uh", "um"
+};
+
+static bool isFiller(const char* word, size_t len) {
+    for (const char* f : FILLER_WORDS) {
+        if (strlen(f) == len && memcmp(f, word, len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename F>
+void CommandMatcher::forEachWord(const char* text, F&& fn) {
+    char word[COMMAND_MAX_WORD];
+    size_t len = 0;
+
+    auto flush = [&]() {
+        if (len == 0) {
+            return;
+        }
+        if (!isFiller(word, len)) {
+            // Plural / possessive "s" (but keep "ss", "is", "gas", ...)
+            if (len > 3 && word[len - 1] == 's' && word[len - 2] != 's') {
+                len--;
+            }
+            fn(word, len);
+        }
+        len = 0;
+    };
+
+    for (const unsigned char* p = (const unsigned char*)text; p && *p; p++) {
+        unsigned char c = *p;
+        if (c == '\'') {
+            continue;
+        }
+        // U+2019 right single quotation mark (ASR output often uses it)
+        if (c == 0xE2 && p[1] == 0x80 && p[2] == 0x99) {
+            p += 2;
+            continue;
+        }
+        if (isalnum(c) || c >= 0x80) {
+            if (len < sizeof(word)) {
+                word[len++] = (char)tolower(c);
+            }
+        } else {
+            flush();
+        }
+    }
+    flush();
+}
+
+int CommandMatcher::tokenize(const char* text, std::vector<std::string>& words) {
+    words.clear();
+    forEachWord(text, [&](const char* w, size_t len) {
+        words.emplace_back(w, len);
+    });
+    return (int)words.size();
+}
+
+size_t CommandMatcher::normalize(const char* text, char* out, size_t size) {
+    size_t n = 0;
+    forEachWord(text, [&](const char* w, size_t len) {
+        size_t need = len + (n ? 1 : 0);
+        if (n + need >= size) {
+            return;
+        }
+        if (n) {
+            out[n++] = ' ';
+        }
+        memcpy(out + n, w, len);
+        n += len;
+    });
+    if (size) {
+        out[n] = '\0';
+    }
+    return n;
+}
+
+// ============================================
+// Vocabulary
+// ============================================
+
+static uint32_t hashWord(const char* word, size_t len) {
+    uint32_t h = 2166136261u;       // FNV-1a
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (uint8_t)word[i]) * 16777619u;
+    }
+    return h;
+}
+
+uint32_t CommandMatcher::findToken(const char* word, size_t len) const {
+    if (wordTable.empty()) {
+        return 0;
+    }
+    size_t mask = wordTable.size() - 1;
+    for (size_t slot = hashWord(word, len) & mask; ; slot = (slot + 1) & mask) {
+        uint32_t token = wordTable[slot];
+        if (token == 0) {
+            return 0;
+        }
+        const Word& w = words[token - 1];
+        if (w.len == len && memcmp(&wordText[w.offset], word, len) == 0) {
+            return token;
+        }
+    }
+}
+
+uint32_t CommandMatcher::addToken(const char* word, size_t len) {
+    uint32_t token = findToken(word, len);
+    if (token) {
+        return token;
+    }
+
+    Word w;
+    w.offset = (uint32_t)wordText.size();
+    w.len = (uint8_t)len;
+    w.keyLen = (uint8_t)phoneticKey(word, len, w.key);
+    wordText.insert(wordText.end(), word, word + len);
+    words.push_back(w);
+    token = (uint32_t)words.size();
+
+    // Keep the table at most half full
+    if (wordTable.size() < words.size() * 2) {
+        std::vector<uint32_t> old;
+        old.swap(wordTable);
+        wordTable.assign(old.empty() ? 64 : old.size() * 2, 0);
+        for (uint32_t t : old) {
+            if (t) {
+                const Word& o = words[t - 1];
+                size_t slot = hashWord(&wordText[o.offset], o.len) & (wordTable.size() - 1);
+                while (wordTable[slot]) slot = (slot + 1) & (wordTable.size() - 1);
+                wordTable[slot] = t;
+            }
+        }
+    }
+    size_t slot = hashWord(word, len) & (wordTable.size() - 1);
+    while (wordTable[slot]) slot = (slot + 1) & (wordTable.size() - 1);
+    wordTable[slot] = token;
+    return token;
+}
+
+// ============================================
+// Automaton
+// ============================================
+
+CommandMatcher::CommandMatcher() {
+    clear();
+}
+
+void CommandMatcher::clear() {
+    states.clear();
+    edges.clear();
+    pending.clear();
+    words.clear();
+    wordText.clear();
+    wordTable.clear();
+    phrases.clear();
+    phraseTokens.clear();
+    templates.clear();
+    templateTokens.clear();
+    costCache.clear();
+    phraseCount = 0;
+    compiled = false;
+
+    // State 0 is the root
+    states.push_back({ 0, 0, 0, 0, 0, -1 });
+    pending.emplace_back();
+}
+
+bool CommandMatcher::addPhrase(const char* phrase, int command) {
+    if (compiled) {
+        return false;       // clear() first
+    }
+
+    uint32_t tokens[COMMAND_MAX_PHRASE_WORDS];
+    int count = 0;
+    bool tooLong = false;
+    forEachWord(phrase, [&](const char* w, size_t len) {
+        if (count == COMMAND_MAX_PHRASE_WORDS) {
+            tooLong = true;
+            return;
+        }
+        tokens[count++] = addToken(w, len);
+    });
+    if (count == 0 || tooLong) {
+        return false;
+    }
+
+    uint32_t state = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t next = 0;
+        for (const Edge& e : pending[state]) {
+            if (e.token == tokens[i]) {
+                next = e.next;
+                break;
+            }
+        }
+        if (next == 0) {
+            next = (uint32_t)states.size();
+            states.push_back({ 0, 0, 0, 0, (uint16_t)(states[state].depth + 1), -1 });
+            pending.emplace_back();
+            pending[state].push_back({ tokens[i], next });
+        }
+        state = next;
+    }
+
+    // Duplicate phrase: the command listed first keeps it
+    if (states[state].output < 0) {
+        states[state].output = command;
+    }
+
+    phrases.push_back({ (uint32_t)phraseTokens.size(), (uint16_t)count, command });
+    phraseTokens.insert(phraseTokens.end(), tokens, tokens + count);
+    phraseCount++;
+    return true;
+}
+
+uint32_t CommandMatcher::child(uint32_t state, uint32_t token) const {
+    const State& s = states[state];
+    const Edge* first = edges.data() + s.firstEdge;
+    const Edge* last = first + s.edgeCount;
+    const Edge* it = std::lower_bound(first, last, token,
+                                      [](const Edge& e, uint32_t t) { return e.token < t; });
+    return (it != last && it->token == token) ? it->next : 0;
+}
+
+void CommandMatcher::compile() {
+    if (compiled) {
+        return;
+    }
+
+    // Flatten the trie into per-state sorted edge ranges
+    edges.clear();
+    for (size_t i = 0; i < states.size(); i++) {
+        std::vector<Edge>& out = pending[i];
+        std::sort(out.begin(), out.end(), [](const Edge& a, const Edge& b) { return a.token < b.token; });
+        states[i].firstEdge = (uint32_t)edges.size();
+        states[i].edgeCount = (uint16_t)out.size();
+        edges.insert(edges.end(), out.begin(), out.end());
+    }
+    pending.clear();
+    pending.shrink_to_fit();
+
+    // Breadth-first failure and output links
+    std::vector<uint32_t> queue;
+    queue.reserve(states.size());
+    queue.push_back(0);
+    for (size_t head = 0; head < queue.size(); head++) {
+        uint32_t s = queue[head];
+        const State& parent = states[s];
+        for (uint32_t i = 0; i < parent.edgeCount; i++) {
+            const Edge& e = edges[parent.firstEdge + i];
+            uint32_t fail = 0;
+            if (s != 0) {
+                uint32_t f = parent.fail;
+                while (true) {
+                    uint32_t c = child(f, e.token);
+                    if (c) {
+                        fail = c;
+                        break;
+                    }
+                    if (f == 0) {
+                        break;
+                    }
+                    f = states[f].fail;
+                }
+            }
+            State& node = states[e.next];
+            node.fail = fail;
+            node.outputLink = states[fail].output >= 0 ? fail : states[fail].outputLink;
+            queue.push_back(e.next);
+        }
+    }
+
+    states.shrink_to_fit();
+    edges.shrink_to_fit();
+    words.shrink_to_fit();
+    wordText.shrink_to_fit();
+    phrases.shrink_to_fit();
+    phraseTokens.shrink_to_fit();
+    templates.shrink_to_fit();
+    templateTokens.shrink_to_fit();
+
+    // Fuzzy pass scratch: one cost per (query word, vocabulary word)
+    costCache.assign((size_t)COMMAND_MAX_QUERY_WORDS * words.size(), 255);
+    compiled = true;
+}
+
+uint32_t CommandMatcher::step(uint32_t state, uint32_t token) const {
+    if (token == 0) {
+        return 0;       // Word not in any phrase
+    }
+    while (true) {
+        uint32_t c = child(state, token);
+        if (c || state == 0) {
+            return c;
+        }
+        state = states[state].fail;
+    }
+}
+
+static void resetMatch(CommandMatch& out) {
+    out.command = -1;
+    out.words = 0;
+    out.end = -1;
+    out.confidence = 0.0f;
+    out.slot[0] = '\0';
+    out.value[0] = '\0';
+}
+
+bool CommandMatcher::match(const char* text, CommandMatch& out) const {
+    resetMatch(out);
+    if (!compiled) {
+        return false;
+    }
+
+    uint32_t state = 0;
+    int pos = 0;
+    forEachWord(text, [&](const char* w, size_t len) {
+        state = step(state, findToken(w, len));
+
+        // Longest phrase ending at this word (shorter ones on the output
+        // chain can never beat it)
+        uint32_t hit = states[state].output >= 0 ? state : states[state].outputLink;
+        if (hit) {
+            const State& h = states[hit];
+            if (h.depth > out.words || (h.depth == out.words && h.output < out.command)) {
+                out.command = h.output;
+                out.words = h.depth;
+                out.end = pos;
+            }
+        }
+        pos++;
+    });
+
+    if (out.command < 0) {
+        return false;
+    }
+    out.confidence = 1.0f;
+    return true;
+}
+
+// ============================================
+// Fuzzy matching
+// ============================================
+
+// Character edit distance (words are at most COMMAND_MAX_WORD long)
+static int editDistance(const char* a, size_t la, const char* b, size_t lb) {
+    uint8_t row[COMMAND_MAX_WORD + 1];
+    for (size_t j = 0; j <= lb; j++) {
+        row[j] = (uint8_t)j;
+    }
+    for (size_t i = 1; i <= la; i++) {
+        uint8_t diag = row[0];
+        row[0] = (uint8_t)i;
+        for (size_t j = 1; j <= lb; j++) {
+            uint8_t up = row[j];
+            uint8_t best = (uint8_t)(diag + (a[i - 1] != b[j - 1]));
+            if (up + 1 < best) best = up + 1;
+            if (row[j - 1] + 1 < best) best = row[j - 1] + 1;
+            row[j] = best;
+            diag = up;
+        }
+    }
+    return row[lb];
+}
+
+uint8_t CommandMatcher::wordCost(int q, uint32_t token) const {
+    uint8_t& cached = costCache[(size_t)q * words.size() + (token - 1)];
+    if (cached != 255) {
+        return cached;
+    }
+
+    const QueryWord& qw = query[q];
+    const Word& w = words[token - 1];
+    int cost;
+    if (qw.token == token) {
+        cost = 0;
+    } else if (qw.keyLen > 0 && qw.keyLen == w.keyLen && memcmp(qw.key, w.key, w.keyLen) == 0) {
+        cost = COMMAND_COST_SOUNDALIKE;
+    } else {
+        // Mean of the relative spelling and sound distances
+        int spell = editDistance(qw.text, qw.len, &wordText[w.offset], w.len) * 100 /
+                    (qw.len > w.len ? qw.len : w.len);
+        int maxKey = qw.keyLen > w.keyLen ? qw.keyLen : w.keyLen;
+        int sound = maxKey ? editDistance(qw.key, qw.keyLen, w.key, w.keyLen) * 100 / maxKey : 100;
+        cost = 20 + (spell + sound) * 40 / 100;
+        if (cost > COMMAND_COST_WORD) cost = COMMAND_COST_WORD;
+    }
+    cached = (uint8_t)cost;
+    return cached;
+}
+
+// Two phrase words run together in one text word ("opengate")
+int CommandMatcher::mergedCost(int q, uint32_t a, uint32_t b) const {
+    const QueryWord& qw = query[q];
+    const Word& wa = words[a - 1];
+    const Word& wb = words[b - 1];
+    if (qw.len != wa.len + wb.len ||
+        memcmp(qw.text, &wordText[wa.offset], wa.len) != 0 ||
+        memcmp(qw.text + wa.len, &wordText[wb.offset], wb.len) != 0) {
+        return -1;
+    }
+    return COMMAND_COST_MERGED;
+}
+
+int CommandMatcher::loadQuery(const char* text) const {
+    int n = 0;
+    forEachWord(text, [&](const char* w, size_t len) {
+        if (n == COMMAND_MAX_QUERY_WORDS) {
+            return;
+        }
+        QueryWord& qw = query[n++];
+        memcpy(qw.text, w, len);
+        qw.len = (uint8_t)len;
+        qw.keyLen = (uint8_t)phoneticKey(w, len, qw.key);
+        qw.token = findToken(w, len);
+    });
+    return n;
+}
+
+bool CommandMatcher::matchFuzzy(const char* text, CommandMatch& out, float minConfidence) const {
+    resetMatch(out);
+    if (!compiled || words.empty()) {
+        return false;
+    }
+
+    int n = loadQuery(text);
+    if (n == 0) {
+        return false;
+    }
+    memset(costCache.data(), 255, (size_t)n * words.size());
+
+    // Semi-global alignment: the phrase must be consumed completely, the
+    // text around it is free. Rows are phrase words, columns text words.
+    int prev2[COMMAND_MAX_QUERY_WORDS + 1];
+    int prev[COMMAND_MAX_QUERY_WORDS + 1];
+    int cur[COMMAND_MAX_QUERY_WORDS + 1];
+    float bestConfidence = -1.0f;
+
+    for (const Phrase& p : phrases) {
+        // Cost bound for this phrase to still reach minConfidence
+        int limit = (int)((1.0f - minConfidence) * p.len * 100.0f + 0.5f);
+        const uint32_t* tok = &phraseTokens[p.first];
+
+        for (int j = 0; j <= n; j++) {
+            prev[j] = 0;
+        }
+        int rowMin = 0;
+        int i;
+        for (i = 1; i <= p.len; i++) {
+            cur[0] = i * COMMAND_COST_WORD;
+            rowMin = cur[0];
+            for (int j = 1; j <= n; j++) {
+                int c = prev[j - 1] + wordCost(j - 1, tok[i - 1]);
+                int del = prev[j] + COMMAND_COST_WORD;
+                int ins = cur[j - 1] + COMMAND_COST_EXTRA;
+                if (del < c) c = del;
+                if (ins < c) c = ins;
+                if (i >= 2) {
+                    int merged = mergedCost(j - 1, tok[i - 2], tok[i - 1]);
+                    if (merged >= 0 && prev2[j - 1] + merged < c) c = prev2[j - 1] + merged;
+                }
+                cur[j] = c;
+                if (c < rowMin) rowMin = c;
+            }
+            // Row minima never decrease, so this phrase is out of reach
+            if (rowMin > limit) {
+                break;
+            }
+            memcpy(prev2, prev, sizeof(int) * (n + 1));
+            memcpy(prev, cur, sizeof(int) * (n + 1));
+        }
+        if (i <= p.len) {
+            continue;
+        }
+
+        int cost = prev[1];
+        int end = 0;
+        for (int j = 2; j <= n; j++) {
+            if (prev[j] < cost) {
+                cost = prev[j];
+                end = j - 1;
+            }
+        }
+        float confidence = 1.0f - (float)cost / (p.len * 100.0f);
+        if (confidence > bestConfidence ||
+            (confidence == bestConfidence && (p.len > out.words ||
+                                              (p.len == out.words && p.command < out.command)))) {
+            bestConfidence = confidence;
+            out.command = p.command;
+            out.words = p.len;
+            out.end = end;
+        }
+    }
+    if (out.command < 0 || bestConfidence < minConfidence) {
+        out.command = -1;
+        return false;
+    }
+    out.confidence = bestConfidence;
+    return true;
+}
+
+// ============================================
+// Slot templates
+// ============================================
+
+bool CommandMatcher::addTemplate(const char* phrase, int command) {
+    const char* open = strchr(phrase, '{');
+    const char* close = open ? strchr(open, '}') : nullptr;
+    if (compiled || !close || close - open - 1 <= 0 || close - open - 1 >= COMMAND_MAX_SLOT_NAME ||
+        strchr(close, '{')) {
+        return false;       // Exactly one {slot} per template
+    }
+
+    Template t;
+    t.first = (uint32_t)templateTokens.size();
+    t.prefixLen = 0;
+    t.suffixLen = 0;
+    t.command = command;
+    memcpy(t.slot, open + 1, close - open - 1);
+    t.slot[close - open - 1] = '\0';
+
+    // Fixed words before and after the slot
+    char part[128];
+    size_t prefixLen = (size_t)(open - phrase) < sizeof(part) ? (size_t)(open - phrase) : sizeof(part) - 1;
+    memcpy(part, phrase, prefixLen);
+    part[prefixLen] = '\0';
+    forEachWord(part, [&](const char* w, size_t len) {
+        templateTokens.push_back(addToken(w, len));
+        t.prefixLen++;
+    });
+    forEachWord(close + 1, [&](const char* w, size_t len) {
+        templateTokens.push_back(addToken(w, len));
+        t.suffixLen++;
+    });
+
+    if (t.prefixLen + t.suffixLen == 0) {
+        templateTokens.resize(t.first);
+        return false;       // A bare slot would match any text
+    }
+    templates.push_back(t);
+    return true;
+}
+
+bool CommandMatcher::matchTemplate(const char* text, CommandSlotResolver resolve, void* ctx,
+                                   CommandMatch& out, float minConfidence) const {
+    resetMatch(out);
+    if (!compiled || templates.empty() || !resolve) {
+        return false;
+    }
+
+    int n = loadQuery(text);
+    char span[COMMAND_MAX_SLOT_WORDS * (COMMAND_MAX_WORD + 1)];
+    char value[sizeof(out.value)];
+    float best = 0.0f;
+
+    for (const Template& t : templates) {
+        const uint32_t* prefix = &templateTokens[t.first];
+        const uint32_t* suffix = prefix + t.prefixLen;
+
+        for (int i = 0; i + t.prefixLen < n; i++) {
+            bool ok = true;
+            for (int k = 0; k < t.prefixLen && ok; k++) {
+                ok = query[i + k].token == prefix[k];
+            }
+            if (!ok) {
+                continue;
+            }
+
+            // Slot spans [s, e): up to the suffix if there is one, otherwise
+            // longest first up to COMMAND_MAX_SLOT_WORDS words
+            int s = i + t.prefixLen;
+            int eMax = s + COMMAND_MAX_SLOT_WORDS < n ? s + COMMAND_MAX_SLOT_WORDS : n;
+            int eMin = s + 1;
+            if (t.suffixLen > 0) {
+                int found = -1;
+                for (int e = s + 1; e + t.suffixLen <= n && e <= s + COMMAND_MAX_SLOT_WORDS && found < 0; e++) {
+                    bool match = true;
+                    for (int k = 0; k < t.suffixLen && match; k++) {
+                        match = query[e + k].token == suffix[k];
+                    }
+                    if (match) found = e;
+                }
+                if (found < 0) {
+                    continue;
+                }
+                eMin = eMax = found;
+            }
+
+            for (int e = eMax; e >= eMin; e--) {
+                size_t len = 0;
+                for (int k = s; k < e; k++) {
+                    if (len) span[len++] = ' ';
+                    memcpy(span + len, query[k].text, query[k].len);
+                    len += query[k].len;
+                }
+                span[len] = '\0';
+
+                // A trailing slot may stop short of the end of the text, but
+                // each word left over lowers the score ("kitchen" must not beat
+                // "kitchen ceiling light")
+                value[0] = '\0';
+                float confidence = resolve(t.slot, span, value, sizeof(value), ctx);
+                if (confidence > 0 && t.suffixLen == 0) {
+                    confidence -= COMMAND_SLOT_SKIP_PENALTY * (n - e);
+                }
+                int words = t.prefixLen + t.suffixLen + (e - s);
+                if (confidence > best || (confidence == best && confidence > 0 && words > out.words)) {
+                    best = confidence;
+                    out.command = t.command;
+                    out.words = words;
+                    out.end = e + t.suffixLen - 1;
+                    out.confidence = confidence;
+                    memcpy(out.slot, t.slot, sizeof(out.slot));
+                    strncpy(out.value, value, sizeof(out.value) - 1);
+                    out.value[sizeof(out.value) - 1] = '\0';
+                }
+            }
+        }
+    }
+
+    if (out.command < 0 || best < minConfidence) {
+        resetMatch(out);
+        return false;
+    }
+    return true;
+}
+
+size_t CommandMatcher::getMemoryBytes() const {
+    return states.capacity() * sizeof(State) + edges.capacity() * sizeof(Edge) +
+           words.capacity() * sizeof(Word) + wordText.capacity() + wordTable.capacity() * sizeof(uint32_t) +
+           phrases.capacity() * sizeof(Phrase) + phraseTokens.capacity() * sizeof(uint32_t) +
+           templates.capacity() * sizeof(Template) + templateTokens.capacity() * sizeof(uint32_t) +
+           costCache.capacity() + sizeof(query);
+}
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include "storage_manager.h"
+#include "action_executor.h"
+
+CommandEngine commandEngine;
+
+static uint32_t hashString(uint32_t h, const char* s) {
+    for (const char* p = s; *p; p++) {
+        h = (h ^ (uint8_t)*p) * 16777619u;     // FNV-1a
+    }
+    return (h ^ 0xff) * 16777619u;
+}
+
+CommandEngine::CommandEngine()
+    : queryHandler(nullptr), slotResolver(nullptr), slotContext(nullptr), reloadPending(false),
+      minConfidence(COMMAND_MIN_CONFIDENCE), fingerprint(0), compileUs(0), lastMatchUs(0), lastConfidence(0),
+      executed(0), fuzzyMatches(0), templateMatches(0), unmatched(0) {
+}
+
+bool CommandEngine::begin() {
+    return reload();
+}
+
+void CommandEngine::loop() {
+    if (reloadPending) {
+        reloadPending = false;
+        reload();
+    }
+}
+
+bool CommandEngine::reload() {
+    unsigned long start = micros();
+
+    matcher.clear();
+    commands.clear();
+    fingerprint = 2166136261u;
+
+    JsonDocument doc;
+    if (!storage.loadCommands(doc)) {
+        log_w("Command engine: no commands file");
+        matcher.compile();
+        return false;
+    }
+    minConfidence = constrain(doc["min_confidence"] | COMMAND_MIN_CONFIDENCE, 0.3f, 1.0f);
+    fingerprint = (fingerprint ^ (uint32_t)(minConfidence * 1000)) * 16777619u;
+
+    for (JsonObject cmd : doc["commands"].as<JsonArray>()) {
+        if (!(cmd["enabled"] | true)) {
+            continue;
+        }
+
+        const char* phrase = cmd["command"] | "";
+        const char* action = cmd["action"] | "";
+        Command entry;
+        entry.id = cmd["id"] | 0;
+        entry.phrase = phrase;
+        if (!parseCommandAction(action, entry.action)) {
+            log_w("Command %d: invalid action '%s', skipped", entry.id, action);
+            continue;
+        }
+
+        // Phrases with a {slot} are templates, everything else goes into the automaton
+        int index = (int)commands.size();
+        if (!addPhrase(phrase, index)) {
+            log_w("Command %d: invalid phrase '%s', skipped", entry.id, phrase);
+            continue;
+        }
+        fingerprint = hashString(hashString(fingerprint, phrase), action);
+        for (const char* alias : cmd["phrases"].as<JsonArray>()) {
+            if (alias) {
+                addPhrase(alias, index);
+                fingerprint = hashString(fingerprint, alias);
+            }
+        }
+        commands.push_back(entry);
+    }
+
+    matcher.compile();
+    compileUs = micros() - start;
+
+    log_i("Command engine: %u commands, %u phrases, %u templates, %u states, %u bytes, compiled in %lu us",
+          (unsigned)commands.size(), (unsigned)matcher.getPhraseCount(), (unsigned)matcher.getTemplateCount(),
+          (unsigned)matcher.getStateCount(), (unsigned)matcher.getMemoryBytes(),
+          (unsigned long)compileUs);
+    return true;
+}
+
+bool CommandEngine::addPhrase(const char* phrase, int index) {
+    return strchr(phrase, '{') ? matcher.addTemplate(phrase, index) : matcher.addPhrase(phrase, index);
+}
+
+bool CommandEngine::match(const char* text, CommandMatch& m) {
+    unsigned long start = micros();
+    bool found = matcher.match(text, m);
+    if (!found && slotResolver && matcher.matchTemplate(text, slotResolver, slotContext, m, minConfidence)) {
+        found = true;
+        templateMatches++;
+    }
+    if (!found && matcher.matchFuzzy(text, m, minConfidence)) {
+        found = true;
+        fuzzyMatches++;
+    }
+    lastMatchUs = micros() - start;
+    lastConfidence = m.confidence;
+
+    if (!found) {
+        unmatched++;
+    }
+    return found;
+}
+
+bool CommandEngine::isQuery(const CommandMatch& m) const {
+    return m.command >= 0 && m.command < (int)commands.size() &&
+           commands[m.command].action.type == CMD_ACTION_QUERY;
+}
+
+CommandResult CommandEngine::execute(const char* text, const CommandMatch& m) {
+    CommandResult result;
+    result.matched = false;
+    result.success = false;
+    result.duplicate = false;
+    result.id = 0;
+    result.actionId = 0;
+    result.confidence = 0;
+
+    // The match may predate a reload
+    if (m.command < 0 || m.command >= (int)commands.size()) {
+        return result;
+    }
+
+    const Command& cmd = commands[m.command];
+    result.matched = true;
+    result.id = cmd.id;
+    result.confidence = m.confidence;
+    result.phrase = cmd.phrase;
+    result.success = dispatch(cmd, m, text, result);
+    executed++;
+    return result;
+}
+
+CommandResult CommandEngine::execute(const char* text) {
+    CommandMatch m;
+    match(text, m);
+    return execute(text, m);
+}
+
+bool CommandEngine::dispatch(const Command& cmd, const CommandMatch& m, const char* text, CommandResult& result) {
+    CommandAction a = cmd.action;
+
+    // Template match: substitute the resolved value for {slot} in the target
+    if (m.slot[0]) {
+        char* open = strchr(a.target, '{');
+        char* close = open ? strchr(open, '}') : nullptr;
+        if (close) {
+            char target[sizeof(a.target)];
+            snprintf(target, sizeof(target), "%.*s%s%s", (int)(open - a.target), a.target, m.value, close + 1);
+            memcpy(a.target, target, sizeof(target));
+        }
+    }
+
+    // Queries are answered here; everything else goes through the action
+    // queue, which reports completion later
+    if (a.type == CMD_ACTION_QUERY) {
+        if (queryHandler) {
+            result.reply = queryHandler(a.target);
+        }
+        return !result.reply.isEmpty();
+    }
+
+    ActionStatus status = actionExecutor.submit(a, text, &result.actionId);
+    result.duplicate = status == ACTION_DUPLICATE;
+    return status == ACTION_QUEUED;
+}
+
+void CommandEngine::getStatusJson(JsonObject obj) {
+    obj["commands"] = commands.size();
+    obj["phrases"] = matcher.getPhraseCount();
+    obj["states"] = matcher.getStateCount();
+    obj["vocabulary"] = matcher.getVocabularySize();
+    obj["memory_bytes"] = matcher.getMemoryBytes();
+    obj["compile_us"] = compileUs;
+    obj["last_match_us"] = lastMatchUs;
+    obj["last_confidence"] = lastConfidence;
+    obj["min_confidence"] = minConfidence;
+    obj["executed"] = executed;
+    obj["templates"] = matcher.getTemplateCount();
+    obj["fuzzy_matches"] = fuzzyMatches;
+    obj["template_matches"] = templateMatches;
+    obj["unmatched"] = unmatched;
+}
+#endif
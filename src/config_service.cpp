@@ -0,0 +1,242 @@
+#include "config_service.h"
+#include "storage_manager.h"
+#include <math.h>
+
+ConfigService configService;
+
+static const struct {
+    const char* key;
+    uint32_t bit;
+} SECTIONS[] = {
+    { "device", CONFIG_DEVICE },
+    { "network", CONFIG_NETWORK },
+    { "mqtt", CONFIG_MQTT },
+    { "voice", CONFIG_VOICE },
+    { "display", CONFIG_DISPLAY },
+    { "weather", CONFIG_WEATHER },
+    { "integrations", CONFIG_INTEGRATIONS },
+    { "presence", CONFIG_PRESENCE },
+    { "gate", CONFIG_GATE },
+    { "notifications", CONFIG_NOTIFICATIONS },
+};
+
+static uint32_t sectionBit(const char* key) {
+    for (const auto& s : SECTIONS) {
+        if (strcmp(s.key, key) == 0) {
+            return s.bit;
+        }
+    }
+    return CONFIG_OTHER;
+}
+
+ConfigService::ConfigService()
+    : pendingSections(0), listenerCount(0), flashReads(0), flashWrites(0), unchangedSaves(0), conflicts(0),
+      failures(0), gets(0), copies(0), notifications(0), lastSaveMs(0) {
+    mutex = xSemaphoreCreateMutex();
+    writeMutex = xSemaphoreCreateMutex();
+    ConfigSnapshot* empty = new ConfigSnapshot();
+    empty->generation = 0;
+    fillTyped(*empty);
+    current = ConfigRef(empty);
+}
+
+bool ConfigService::begin() {
+    ConfigSnapshot* loaded = new ConfigSnapshot();
+    bool ok = storage.loadConfig(loaded->json) && loaded->json.is<JsonObject>();
+    if (!ok) {
+        loaded->json.clear();
+    }
+    loaded->generation = ok ? 1 : 0;
+    fillTyped(*loaded);
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    flashReads++;
+    current = ConfigRef(loaded);
+    xSemaphoreGive(mutex);
+
+    if (ok) {
+        log_i("Config: %u bytes parsed once, served from RAM", (unsigned)measureJson(loaded->json));
+    }
+    return ok;
+}
+
+ConfigRef ConfigService::get() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    ConfigRef ref = current;
+    gets++;
+    xSemaphoreGive(mutex);
+    return ref;
+}
+
+uint32_t ConfigService::getGeneration() {
+    return get()->generation;
+}
+
+bool ConfigService::copy(JsonDocument& doc, uint32_t* generation) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    ConfigRef ref = current;
+    copies++;
+    xSemaphoreGive(mutex);
+
+    if (generation) {
+        *generation = ref->generation;
+    }
+    if (ref->generation == 0) {
+        return false;
+    }
+    doc = ref->json;
+    return !doc.overflowed();
+}
+
+bool ConfigService::save(const JsonDocument& doc, uint32_t ifGeneration) {
+    xSemaphoreTake(writeMutex, portMAX_DELAY);
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    ConfigRef base = current;
+    xSemaphoreGive(mutex);
+
+    if (ifGeneration != 0 && ifGeneration != base->generation) {
+        conflicts++;
+        xSemaphoreGive(writeMutex);
+        log_w("Config: save based on generation %u lost to generation %u",
+              (unsigned)ifGeneration, (unsigned)base->generation);
+        return false;
+    }
+
+    uint32_t changed = base->generation == 0 ? CONFIG_ALL : diffSections(base->json, doc);
+    if (changed == 0) {
+        unchangedSaves++;
+        xSemaphoreGive(writeMutex);
+        return true;
+    }
+
+    ConfigSnapshot* next = new ConfigSnapshot();
+    next->json = doc;
+    if (next->json.overflowed()) {
+        delete next;
+        failures++;
+        xSemaphoreGive(writeMutex);
+        log_e("Config: out of memory copying the new config");
+        return false;
+    }
+
+    uint32_t start = millis();
+    if (!storage.saveConfig(doc)) {
+        delete next;
+        failures++;
+        xSemaphoreGive(writeMutex);
+        return false;
+    }
+    lastSaveMs = millis() - start;
+    flashWrites++;
+
+    next->generation = base->generation + 1;
+    fillTyped(*next);
+    publish(next, changed);
+    xSemaphoreGive(writeMutex);
+
+    log_i("Config: generation %u saved (sections 0x%03x) in %u ms",
+          (unsigned)next->generation, (unsigned)changed, (unsigned)lastSaveMs);
+    return true;
+}
+
+void ConfigService::publish(ConfigSnapshot* next, uint32_t changed) {
+    ConfigRef ref(next);
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    current.swap(ref);
+    pendingSections |= changed;
+    xSemaphoreGive(mutex);
+    // The previous snapshot is freed here unless a reader still holds it
+}
+
+bool ConfigService::subscribe(ConfigListener listener, void* ctx, uint32_t sections) {
+    if (listenerCount >= CONFIG_MAX_LISTENERS) {
+        log_e("Config: too many listeners");
+        return false;
+    }
+    listeners[listenerCount++] = { listener, ctx, sections };
+    return true;
+}
+
+void ConfigService::loop() {
+    if (pendingSections == 0) {
+        return;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    uint32_t changed = pendingSections;
+    pendingSections = 0;
+    ConfigRef ref = current;
+    xSemaphoreGive(mutex);
+
+    for (int i = 0; i < listenerCount; i++) {
+        if (listeners[i].sections & changed) {
+            listeners[i].fn(*ref, changed, listeners[i].ctx);
+            notifications++;
+        }
+    }
+}
+
+void ConfigService::fillTyped(ConfigSnapshot& s) {
+    JsonVariantConst root = s.json.as<JsonVariantConst>();
+    JsonVariantConst ha = root["integrations"]["home_assistant"];
+    s.haUrl = ha["url"] | "";
+    s.haToken = ha["token"] | "";
+    s.haConfigured = s.haUrl.length() > 0 && s.haToken.length() > 0;
+
+    s.weatherProvider = root["weather"]["provider"] | "none";
+    s.weatherEntity = root["weather"]["home_assistant"]["entity_id"] | "weather.forecast_home";
+
+    s.presenceCount = 0;
+    for (JsonVariantConst id : root["presence"]["home_assistant"]["entity_ids"].as<JsonArrayConst>()) {
+        const char* entityId = id | "";
+        if (*entityId && s.presenceCount < CONFIG_MAX_PRESENCE) {
+            s.presenceEntities[s.presenceCount++] = entityId;
+        }
+    }
+
+    s.gateEntity = root["gate"]["home_assistant"]["entity_id"] | "";
+
+    JsonVariantConst calendar = root["integrations"]["calendar"];
+    s.calendarEnabled = (calendar["enabled"] | false) && strcmp(calendar["provider"] | "none", "homeassistant") == 0;
+    s.calendarEntity = calendar["home_assistant"]["entity_id"] | "calendar.family";
+
+    s.voiceSensitivity = root["voice"]["sensitivity"].is<float>() ? root["voice"]["sensitivity"].as<float>() : NAN;
+}
+
+uint32_t ConfigService::diffSections(const JsonDocument& a, const JsonDocument& b) {
+    JsonObjectConst oa = a.as<JsonObjectConst>();
+    JsonObjectConst ob = b.as<JsonObjectConst>();
+    if (oa.isNull() || ob.isNull()) {
+        return CONFIG_ALL;
+    }
+
+    uint32_t changed = 0;
+    for (JsonPairConst kv : oa) {
+        if (ob[kv.key()] != kv.value()) {
+            changed |= sectionBit(kv.key().c_str());
+        }
+    }
+    for (JsonPairConst kv : ob) {
+        if (!oa[kv.key()].isNull() || kv.value().isNull()) {
+            continue;           // Compared above
+        }
+        changed |= sectionBit(kv.key().c_str());
+    }
+    return changed;
+}
+
+void ConfigService::getStatusJson(JsonObject obj) {
+    ConfigRef ref = get();
+    obj["generation"] = ref->generation;
+    obj["bytes"] = measureJson(ref->json);
+    obj["flash_reads"] = flashReads;
+    obj["flash_writes"] = flashWrites;
+    obj["last_save_ms"] = lastSaveMs;
+    obj["unchanged_saves"] = unchangedSaves;
+    obj["conflicts"] = conflicts;
+    obj["failures"] = failures;
+    obj["gets"] = gets;
+    obj["copies"] = copies;
+    obj["notifications"] = notifications;
+    obj["listeners"] = listenerCount;
+}
@@ -0,0 +1,637 @@
+#include "entity_index.h"
+#include "command_engine.h"
+#include <string.h>
+
+// Trailing words dropped for the short key ("Porch Light" -> "porch")
+static const char* const DEVICE_NOUNS[] = {
+    "light", "lamp", "switch", "plug", "socket", "outlet", "fan", "cover", "blind",
+    "shade", "curtain", "door", "lock", "speaker", "tv"
+};
+
+static uint32_t hashBytes(uint32_t h, const char* s, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (uint8_t)s[i]) * 16777619u;   // FNV-1a
+    }
+    return h;
+}
+
+// Normalized keys only contain [a-z0-9 ]
+static int symbolOf(char c) {
+    if (c >= 'a' && c <= 'z') return c - 'a';
+    if (c >= '0' && c <= '9') return 26 + (c - '0');
+    return c == ' ' ? 36 : 37;
+}
+
+// Bit-parallel edit distance (Myers/Hyyro): one pattern, compared against
+// many keys in O(key length) word operations each
+struct KeyPattern {
+    uint64_t peq[38];
+    uint64_t mask;
+    uint64_t top;
+    int len;
+
+    KeyPattern(const char* key, size_t n) : len((int)n) {
+        memset(peq, 0, sizeof(peq));
+        for (size_t i = 0; i < n; i++) {
+            peq[symbolOf(key[i])] |= 1ULL << i;
+        }
+        mask = n >= 64 ? ~0ULL : (1ULL << n) - 1;
+        top = n ? 1ULL << (n - 1) : 0;
+    }
+
+    int distance(const char* key, size_t n) const {
+        if (len == 0) {
+            return (int)n;
+        }
+        uint64_t vp = mask;
+        uint64_t vn = 0;
+        int score = len;
+        for (size_t j = 0; j < n; j++) {
+            uint64_t eq = peq[symbolOf(key[j])];
+            uint64_t xv = eq | vn;
+            uint64_t xh = (((eq & vp) + vp) ^ vp) | eq;
+            uint64_t ph = vn | ~(xh | vp);
+            uint64_t mh = vp & xh;
+            if (ph & top) {
+                score++;
+            } else if (mh & top) {
+                score--;
+            }
+            ph = (ph << 1) | 1;
+            mh <<= 1;
+            vp = (mh | ~(xv | ph)) & mask;
+            vn = ph & xv;
+        }
+        return score;
+    }
+};
+
+EntityIndex::EntityIndex() : treeCount(0), live(0), rebuilds(0), fingerprint(0) {
+}
+
+void EntityIndex::clear() {
+    entities.clear();
+    pool.clear();
+    nodes.clear();
+    idTable.clear();
+    treeCount = 0;
+    live = 0;
+    fingerprint = 0;
+}
+
+uint32_t EntityIndex::addString(const char* s, size_t len) {
+    uint32_t offset = (uint32_t)pool.size();
+    pool.insert(pool.end(), s, s + len);
+    pool.push_back('\0');
+    return offset;
+}
+
+uint32_t EntityIndex::contribution(const Entity& e) const {
+    const char* id = &pool[e.idOffset];
+    return hashBytes(e.hash, id, strlen(id));
+}
+
+int EntityIndex::findEntity(const char* entityId) const {
+    if (idTable.empty()) {
+        return -1;
+    }
+    size_t mask = idTable.size() - 1;
+    for (size_t slot = hashBytes(2166136261u, entityId, strlen(entityId)) & mask; ; slot = (slot + 1) & mask) {
+        uint32_t v = idTable[slot];
+        if (v == 0) {
+            return -1;
+        }
+        if (strcmp(&pool[entities[v - 1].idOffset], entityId) == 0) {
+            return (int)(v - 1);
+        }
+    }
+}
+
+void EntityIndex::insertId(uint32_t entity) {
+    if (idTable.size() < entities.size() * 2) {
+        EntityVector<uint32_t> old;
+        old.swap(idTable);
+        idTable.assign(old.empty() ? 256 : old.size() * 2, 0);
+        for (uint32_t v : old) {
+            if (v && v - 1 != entity) {
+                insertId(v - 1);
+            }
+        }
+    }
+
+    const char* id = &pool[entities[entity].idOffset];
+    size_t mask = idTable.size() - 1;
+    size_t slot = hashBytes(2166136261u, id, strlen(id)) & mask;
+    while (idTable[slot] && strcmp(&pool[entities[idTable[slot] - 1].idOffset], id) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    idTable[slot] = entity + 1;     // New slot, or replaces an older version of the entity
+}
+
+int EntityIndex::findTree(const char* domain, size_t len) const {
+    for (int i = 0; i < treeCount; i++) {
+        if (strlen(trees[i].domain) == len && strncmp(trees[i].domain, domain, len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void EntityIndex::insertKey(const char* key, size_t len, uint32_t entity) {
+    Node node;
+    node.keyOffset = addString(key, len);
+    node.entity = entity;
+    node.firstChild = 0;
+    node.nextSibling = 0;
+    node.keyLen = (uint8_t)len;
+    node.dist = 0;
+
+    // One tree per domain, so a lookup for "light" never visits covers;
+    // domains past ENTITY_MAX_DOMAINS share the last tree
+    const char* domain = &pool[entities[entity].idOffset];
+    size_t domainLen = entities[entity].domainLen;
+    int tree = findTree(domain, domainLen);
+    if (tree < 0 && treeCount == ENTITY_MAX_DOMAINS) {
+        tree = treeCount - 1;
+    }
+    if (tree < 0) {
+        tree = treeCount++;
+        size_t n = domainLen < sizeof(trees[0].domain) - 1 ? domainLen : sizeof(trees[0].domain) - 1;
+        memcpy(trees[tree].domain, domain, n);
+        trees[tree].domain[n] = '\0';
+        trees[tree].root = (uint32_t)nodes.size();
+        if (treeCount == ENTITY_MAX_DOMAINS) {
+            trees[tree].domain[0] = '\0';      // Shared by all remaining domains
+        }
+        nodes.push_back(node);
+        return;
+    }
+
+    KeyPattern pattern(key, len);
+    uint32_t cur = trees[tree].root;
+    while (true) {
+        const Node& n = nodes[cur];
+        int d = pattern.distance(&pool[n.keyOffset], n.keyLen);
+        if (d == 0 && n.entity == entity) {
+            pool.resize(node.keyOffset);    // Same key twice for one entity
+            return;
+        }
+
+        uint32_t child = n.firstChild;
+        uint32_t last = 0;
+        while (child && nodes[child].dist != d) {
+            last = child;
+            child = nodes[child].nextSibling;
+        }
+        if (child) {
+            cur = child;
+            continue;
+        }
+
+        node.dist = (uint8_t)d;
+        uint32_t index = (uint32_t)nodes.size();
+        if (last) {
+            nodes[last].nextSibling = index;
+        } else {
+            nodes[cur].firstChild = index;
+        }
+        nodes.push_back(node);
+        return;
+    }
+}
+
+void EntityIndex::addKeys(uint32_t entity) {
+    const Entity& e = entities[entity];
+    char keys[4][ENTITY_MAX_KEY + 1];
+    size_t lens[4];
+    int count = 0;
+
+    // Friendly name
+    lens[count] = CommandMatcher::normalize(&pool[e.nameOffset], keys[count], sizeof(keys[0]));
+    if (lens[count]) count++;
+
+    // Name without a trailing device noun
+    if (count == 1) {
+        const char* space = strrchr(keys[0], ' ');
+        if (space) {
+            for (const char* noun : DEVICE_NOUNS) {
+                if (strcmp(space + 1, noun) == 0) {
+                    lens[count] = space - keys[0];
+                    memcpy(keys[count], keys[0], lens[count]);
+                    keys[count][lens[count]] = '\0';
+                    count++;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Object id ("porch_light" -> "porch light")
+    lens[count] = CommandMatcher::normalize(&pool[e.idOffset] + e.domainLen + 1, keys[count], sizeof(keys[0]));
+    if (lens[count]) count++;
+
+    // Area + name, unless the name already starts with the area
+    char area[ENTITY_MAX_KEY + 1];
+    size_t areaLen = CommandMatcher::normalize(&pool[e.areaOffset], area, sizeof(area));
+    if (areaLen && lens[0] && strncmp(keys[0], area, areaLen) != 0 && areaLen + 1 + lens[0] <= ENTITY_MAX_KEY) {
+        memcpy(keys[count], area, areaLen);
+        keys[count][areaLen] = ' ';
+        memcpy(keys[count] + areaLen + 1, keys[0], lens[0] + 1);
+        lens[count] = areaLen + 1 + lens[0];
+        count++;
+    }
+
+    for (int i = 0; i < count; i++) {
+        insertKey(keys[i], lens[i], entity);
+    }
+}
+
+void EntityIndex::beginRefresh() {
+    for (Entity& e : entities) {
+        e.seen = false;
+    }
+}
+
+bool EntityIndex::upsert(const char* entityId, const char* name, const char* area) {
+    const char* dot = strchr(entityId, '.');
+    if (!dot || dot == entityId || !dot[1]) {
+        return false;
+    }
+    if (!name) name = "";
+    if (!area) area = "";
+
+    uint32_t hash = hashBytes(hashBytes(2166136261u, name, strlen(name) + 1), area, strlen(area));
+    int existing = findEntity(entityId);
+    if (existing >= 0 && entities[existing].alive) {
+        entities[existing].seen = true;
+        if (entities[existing].hash == hash) {
+            return false;
+        }
+        // Renamed or moved: tombstone the old keys, index the new ones
+        entities[existing].alive = false;
+        fingerprint -= contribution(entities[existing]);
+        live--;
+    }
+
+    Entity e;
+    e.idOffset = addString(entityId, strlen(entityId));
+    e.nameOffset = addString(name, strlen(name));
+    e.areaOffset = addString(area, strlen(area));
+    e.hash = hash;
+    e.domainLen = (uint8_t)(dot - entityId);
+    e.alive = true;
+    e.seen = true;
+    entities.push_back(e);
+    live++;
+    fingerprint += contribution(e);
+
+    uint32_t index = (uint32_t)entities.size() - 1;
+    insertId(index);
+    addKeys(index);
+    return true;
+}
+
+int EntityIndex::endRefresh() {
+    int removed = 0;
+    for (Entity& e : entities) {
+        if (e.alive && !e.seen) {
+            e.alive = false;
+            fingerprint -= contribution(e);
+            live--;
+            removed++;
+        }
+    }
+
+    size_t dead = entities.size() - live;
+    if (dead > 16 && dead * 4 > entities.size()) {
+        rebuild();
+    }
+    return removed;
+}
+
+void EntityIndex::rebuild() {
+    EntityVector<Entity> oldEntities;
+    EntityVector<char> oldPool;
+    oldEntities.swap(entities);
+    oldPool.swap(pool);
+    nodes.clear();
+    idTable.clear();
+    treeCount = 0;
+    live = 0;
+
+    for (const Entity& o : oldEntities) {
+        if (!o.alive) {
+            continue;
+        }
+        Entity e = o;
+        e.idOffset = addString(&oldPool[o.idOffset], strlen(&oldPool[o.idOffset]));
+        e.nameOffset = addString(&oldPool[o.nameOffset], strlen(&oldPool[o.nameOffset]));
+        e.areaOffset = addString(&oldPool[o.areaOffset], strlen(&oldPool[o.areaOffset]));
+        entities.push_back(e);
+        live++;
+        insertId((uint32_t)entities.size() - 1);
+        addKeys((uint32_t)entities.size() - 1);
+    }
+    entities.shrink_to_fit();
+    pool.shrink_to_fit();
+    nodes.shrink_to_fit();
+    rebuilds++;
+}
+
+bool EntityIndex::lookup(const char* text, const char* domain, EntityHit& hit) const {
+    hit.entity = 0;
+    hit.distance = -1;
+    hit.confidence = 0.0f;
+    if (nodes.empty() || !text) {
+        return false;
+    }
+
+    char q[ENTITY_MAX_KEY + 1];
+    size_t len = CommandMatcher::normalize(text, q, sizeof(q));
+    if (len == 0) {
+        return false;
+    }
+    // Very short words only match exactly ("tv" must not become "tl")
+    int maxDist = len <= 3 ? 0 : (int)(len / 4);
+    if (maxDist < 1 && len > 3) maxDist = 1;
+    if (maxDist > ENTITY_MAX_DISTANCE) maxDist = ENTITY_MAX_DISTANCE;
+    size_t domainLen = domain ? strlen(domain) : 0;
+    KeyPattern pattern(q, len);
+
+    // Depth-first over the children within [d - maxDist, d + maxDist]
+    uint32_t stack[256];
+    int top = 0;
+    for (int i = 0; i < treeCount; i++) {
+        if (!domain || !trees[i].domain[0] ||
+            (strlen(trees[i].domain) == domainLen && strcmp(trees[i].domain, domain) == 0)) {
+            stack[top++] = trees[i].root;
+        }
+    }
+    bool found = false;
+
+    while (top > 0) {
+        const Node& n = nodes[stack[--top]];
+        int d = pattern.distance(&pool[n.keyOffset], n.keyLen);
+
+        if (d <= maxDist) {
+            const Entity& e = entities[n.entity];
+            if (e.alive && (!domain || (e.domainLen == domainLen &&
+                                        strncmp(&pool[e.idOffset], domain, domainLen) == 0))) {
+                float confidence = 1.0f - (float)d / (float)(len > n.keyLen ? len : n.keyLen);
+                if (!found || confidence > hit.confidence ||
+                    (confidence == hit.confidence && n.entity < hit.entity)) {
+                    hit.entity = n.entity;
+                    hit.distance = d;
+                    hit.confidence = confidence;
+                    found = true;
+                }
+            }
+        }
+
+        for (uint32_t c = n.firstChild; c; c = nodes[c].nextSibling) {
+            int label = nodes[c].dist;
+            if (label >= d - maxDist && label <= d + maxDist && top < (int)(sizeof(stack) / sizeof(stack[0]))) {
+                stack[top++] = c;
+            }
+        }
+    }
+    return found;
+}
+
+const char* EntityIndex::getEntityId(uint32_t entity) const {
+    return &pool[entities[entity].idOffset];
+}
+
+const char* EntityIndex::getObjectId(uint32_t entity) const {
+    return &pool[entities[entity].idOffset] + entities[entity].domainLen + 1;
+}
+
+const char* EntityIndex::getName(uint32_t entity) const {
+    return &pool[entities[entity].nameOffset];
+}
+
+const char* EntityIndex::getArea(uint32_t entity) const {
+    return &pool[entities[entity].areaOffset];
+}
+
+size_t EntityIndex::getMemoryBytes() const {
+    return entities.capacity() * sizeof(Entity) + pool.capacity() + nodes.capacity() * sizeof(Node) +
+           idTable.capacity() * sizeof(uint32_t);
+}
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include "ha_http.h"
+#include <WiFi.h>
+
+#define ENTITY_FETCH_MAX_BYTES  (256 * 1024)
+
+HAEntityIndex haEntities;
+
+// Collects the streamed template response (handles chunked encoding via
+// HTTPClient::writeToStream)
+class StagingStream : public Stream {
+public:
+    StagingStream(EntityVector<char>& buf) : buf(buf), overflow(false) {}
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* data, size_t size) override {
+        if (buf.size() + size > ENTITY_FETCH_MAX_BYTES) {
+            overflow = true;
+            return 0;
+        }
+        buf.insert(buf.end(), data, data + size);
+        return size;
+    }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override {}
+
+    EntityVector<char>& buf;
+    bool overflow;
+};
+
+HAEntityIndex::HAEntityIndex()
+    : enabled(false), loaded(false), refreshInterval(0), lastRefresh(0), refreshRequested(false), task(nullptr),
+      fetchDone(false), lastHttpCode(0), fetchMs(0), applyUs(0), lastChanged(0), lastRemoved(0),
+      lookups(0), lookupUsMax(0) {
+}
+
+void HAEntityIndex::begin(JsonDocument& config) {
+    JsonObject cfg = config["entities"];
+    enabled = cfg["enabled"] | true;
+    refreshInterval = constrain(cfg["refresh_minutes"] | 15, 1, 1440) * 60000UL;
+
+    haUrl = config["integrations"]["home_assistant"]["url"] | "";
+    haToken = config["integrations"]["home_assistant"]["token"] | "";
+    if (haUrl.isEmpty() || haToken.isEmpty()) {
+        log_w("Entity index: Home Assistant not configured");
+        enabled = false;
+    }
+    if (!haUrl.endsWith("/")) haUrl += "/";
+
+    // Only these domains are rendered by HA, everything else never leaves it
+    domains = "[";
+    JsonArray list = cfg["domains"].as<JsonArray>();
+    static const char* const DEFAULT_DOMAINS[] = { "light", "switch", "cover", "lock", "fan", "scene" };
+    size_t count = list.isNull() ? sizeof(DEFAULT_DOMAINS) / sizeof(DEFAULT_DOMAINS[0]) : list.size();
+    for (size_t i = 0; i < count; i++) {
+        const char* d = list.isNull() ? DEFAULT_DOMAINS[i] : (list[i] | "");
+        if (strspn(d, "abcdefghijklmnopqrstuvwxyz_") != strlen(d) || !*d) {
+            continue;
+        }
+        if (domains.length() > 1) domains += ",";
+        domains += "'";
+        domains += d;
+        domains += "'";
+    }
+    domains += "]";
+
+    refreshRequested = enabled;
+    log_i("Entity index: %s, domains %s, refresh every %lu min", enabled ? "enabled" : "disabled",
+          domains.c_str(), refreshInterval / 60000UL);
+}
+
+void HAEntityIndex::loop() {
+    if (!enabled) {
+        return;
+    }
+
+    if (fetchDone) {
+        fetchDone = false;
+        apply();
+    }
+
+    if (task == nullptr && WiFi.isConnected() &&
+        (refreshRequested || millis() - lastRefresh >= refreshInterval)) {
+        refreshRequested = false;
+        lastRefresh = millis();
+        if (xTaskCreatePinnedToCore(fetchTask, "entities", 8192, this, 1, &task, 0) != pdPASS) {
+            task = nullptr;
+            log_e("Entity index: cannot start fetch task");
+        }
+    }
+}
+
+void HAEntityIndex::fetchTask(void* param) {
+    HAEntityIndex* self = (HAEntityIndex*)param;
+    self->fetch();
+    self->fetchDone = true;
+    self->task = nullptr;
+    vTaskDelete(NULL);
+}
+
+void HAEntityIndex::fetch() {
+    unsigned long start = millis();
+    staging.clear();
+
+    // One line per entity: entity_id<TAB>friendly name<TAB>area
+    JsonDocument body;
+    body["template"] = String("{% for s in states if s.domain in ") + domains + " %}"
+        "{{ s.entity_id }}\t{{ s.name | replace('\\t',' ') | replace('\\n',' ') }}\t"
+        "{{ area_name(s.entity_id) or '' }}\n{% endfor %}";
+    String payload;
+    serializeJson(body, payload);
+
+    HARequest http(haUrl + "api/template", haToken.c_str(), 15000);
+    http.addHeader("Content-Type", "application/json");
+
+    lastHttpCode = http.POST(payload);
+    if (lastHttpCode == 200) {
+        StagingStream sink(staging);
+        http.writeToStream(&sink);
+        if (sink.overflow) {
+            log_e("Entity index: response exceeds %u bytes, narrow entities.domains", ENTITY_FETCH_MAX_BYTES);
+            lastHttpCode = -1;
+        }
+    }
+    http.end();
+    fetchMs = millis() - start;
+}
+
+void HAEntityIndex::apply() {
+    if (lastHttpCode != 200) {
+        log_w("Entity index: refresh failed (HTTP %d)", lastHttpCode);
+        staging.clear();
+        return;
+    }
+
+    unsigned long start = micros();
+    staging.push_back('\0');
+    index.beginRefresh();
+
+    int changed = 0;
+    char* line = staging.data();
+    while (*line) {
+        char* end = strchr(line, '\n');
+        if (end) *end = '\0';
+
+        char* name = strchr(line, '\t');
+        char* area = name ? strchr(name + 1, '\t') : nullptr;
+        if (area) {
+            *name++ = '\0';
+            *area++ = '\0';
+            if (index.upsert(line, name, area)) {
+                changed++;
+            }
+        }
+
+        if (!end) break;
+        line = end + 1;
+    }
+
+    lastRemoved = index.endRefresh();
+    lastChanged = changed;
+    loaded = true;
+    applyUs = micros() - start;
+
+    EntityVector<char>().swap(staging);
+    log_i("Entity index: %u entities (%d changed, %d removed), %u keys, %u bytes, fetch %lu ms, apply %lu us",
+          (unsigned)index.size(), changed, lastRemoved, (unsigned)index.getKeyCount(),
+          (unsigned)index.getMemoryBytes(), (unsigned long)fetchMs, (unsigned long)applyUs);
+}
+
+float HAEntityIndex::resolve(const char* text, const char* domain, char* entityId, size_t size) {
+    unsigned long start = micros();
+    EntityHit hit;
+    bool found = index.lookup(text, domain, hit);
+    uint32_t us = micros() - start;
+    lookups++;
+    if (us > lookupUsMax) lookupUsMax = us;
+
+    if (!found) {
+        return 0.0f;
+    }
+    strlcpy(entityId, index.getEntityId(hit.entity), size);
+    return hit.confidence;
+}
+
+float HAEntityIndex::resolveSlot(const char* slot, const char* text, char* value, size_t valueSize, void* ctx) {
+    HAEntityIndex* self = (HAEntityIndex*)ctx;
+    char entityId[96];
+    float confidence = self->resolve(text, slot, entityId, sizeof(entityId));
+    if (confidence > 0) {
+        strlcpy(value, strchr(entityId, '.') + 1, valueSize);
+    }
+    return confidence;
+}
+
+void HAEntityIndex::getStatusJson(JsonObject obj) {
+    obj["enabled"] = enabled;
+    obj["entities"] = index.size();
+    obj["keys"] = index.getKeyCount();
+    obj["tombstones"] = index.getTombstones();
+    obj["rebuilds"] = index.getRebuilds();
+    obj["memory_bytes"] = index.getMemoryBytes();
+    obj["refreshing"] = task != nullptr;
+    obj["last_http_code"] = lastHttpCode;
+    obj["fetch_ms"] = fetchMs;
+    obj["apply_us"] = applyUs;
+    obj["changed"] = lastChanged;
+    obj["removed"] = lastRemoved;
+    obj["lookups"] = lookups;
+    obj["lookup_us_max"] = lookupUsMax;
+}
+#endif
@@ -0,0 +1,63 @@
+#include "flash_record.h"
+#include <string.h>
+
+// Nibble-wise CRC-32 (reflected 0xEDB88320): 64 bytes of table, fast enough
+// for files of a few KB
+static const uint32_t CRC_NIBBLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint32_t flashRecordCrc(const uint8_t* data, size_t len, uint32_t crc) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = CRC_NIBBLE[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+        crc = CRC_NIBBLE[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+static void putU32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+size_t flashRecordSeal(uint8_t* record, size_t payloadLen, uint8_t format) {
+    putU32(record, FLASH_RECORD_MAGIC);
+    record[4] = FLASH_RECORD_VERSION;
+    record[5] = format;
+    record[6] = 0;
+    record[7] = 0;
+    putU32(record + 8, (uint32_t)payloadLen);
+    putU32(record + 12, flashRecordCrc(record + FLASH_RECORD_HEADER, payloadLen));
+    return FLASH_RECORD_HEADER + payloadLen;
+}
+
+const char* flashRecordOpen(const uint8_t* record, size_t size, uint8_t format,
+                            const uint8_t** payload, size_t* payloadLen) {
+    if (size < FLASH_RECORD_HEADER || getU32(record) != FLASH_RECORD_MAGIC) {
+        return "not a record";
+    }
+    if (record[4] != FLASH_RECORD_VERSION) {
+        return "unsupported version";
+    }
+    if (record[5] != format) {
+        return "unexpected payload format";
+    }
+    uint32_t len = getU32(record + 8);
+    if (len != size - FLASH_RECORD_HEADER) {
+        return "truncated";
+    }
+    if (flashRecordCrc(record + FLASH_RECORD_HEADER, len) != getU32(record + 12)) {
+        return "CRC mismatch";
+    }
+    *payload = record + FLASH_RECORD_HEADER;
+    *payloadLen = len;
+    return nullptr;
+}
@@ -1,4 +1,6 @@
 #include "ha_assist_client.h"
+#include "audio_metrics.h"
+#include "ha_http.h"
 #include <WiFi.h>
 
 HAAssistClient haAssist;
@@ -10,17 +12,13 @@ HAAssistClient::HAAssistClient()
     , _recordBufferSize(0)
     , _recordIndex(0)
     , _language("en")
+    , _lastSttMs(0)
 {
+    _connLock = xSemaphoreCreateMutex();
 }
 
 void HAAssistClient::begin(const char* baseUrl, const char* token) {
-    _baseUrl = baseUrl;
-    _token = token;
-    
-    // Remove trailing slash if present
-    if (_baseUrl.endsWith("/")) {
-        _baseUrl.remove(_baseUrl.length() - 1);
-    }
+    setConnection(baseUrl, token);
     
     // Allocate recording buffer in PSRAM if available
     _recordBufferSize = ASSIST_AUDIO_BUFFER_SIZE / sizeof(int16_t);
@@ -46,39 +44,49 @@ void HAAssistClient::begin(const char* baseUrl, const char* token) {
     discoverSTTProviders();
 }
 
+void HAAssistClient::setConnection(const char* baseUrl, const char* token) {
+    xSemaphoreTake(_connLock, portMAX_DELAY);
+    _baseUrl = baseUrl;
+    _token = token;
+    
+    // Remove trailing slash if present
+    if (_baseUrl.endsWith("/")) {
+        _baseUrl.remove(_baseUrl.length() - 1);
+    }
+    xSemaphoreGive(_connLock);
+}
+
 void HAAssistClient::discoverSTTProviders() {
     if (!WiFi.isConnected()) {
         log_w("HAAssist: WiFi not connected, skipping STT discovery");
         return;
     }
     
-    HTTPClient http;
     String url = _baseUrl + "/api/states";
-    
-    http.begin(url);
-    http.addHeader("Authorization", String("Bearer ") + _token);
-    http.setTimeout(10000);
+    HARequest http(url, _token.c_str(), 10000);
     
     int httpCode = http.GET();
     
     if (httpCode == HTTP_CODE_OK) {
-        String response = http.getString();
-        
-        // Look for stt.* entities
-        int idx = 0;
-        while ((idx = response.indexOf("\"entity_id\":\"stt.", idx)) != -1) {
-            int start = idx + 17; // After "entity_id":"stt.
-            int end = response.indexOf("\"", start);
-            if (end > start) {
-                String provider = response.substring(start, end);
-                if (_sttProvider.length() == 0) {
-                    _sttProvider = provider;
-                    log_i("HAAssist: Found STT provider: stt.%s (using as default)", provider.c_str());
-                } else {
-                    log_i("HAAssist: Found STT provider: stt.%s", provider.c_str());
-                }
+        // Look for stt.* entities. /api/states is often hundreds of KB, so
+        // it is parsed as it arrives and only the entity ids are looked at.
+        JsonStreamParser parser;
+        parser.begin([](JsonStreamParser& p, JsonStreamType type, const char* value, size_t len, void* ctx) {
+            if (type != JSON_STREAM_STRING || len <= 4 || strncmp(value, "stt.", 4) != 0 ||
+                !p.match("[*].entity_id")) {
+                return;
+            }
+            HAAssistClient* self = (HAAssistClient*)ctx;
+            if (self->_sttProvider.length() == 0) {
+                self->_sttProvider = value + 4;
+                log_i("HAAssist: Found STT provider: %s (using as default)", value);
+            } else {
+                log_i("HAAssist: Found STT provider: %s", value);
             }
-            idx = end;
+        }, nullptr, this);
+        
+        if (!http.readJson(parser)) {
+            log_w("HAAssist: Incomplete HA states response");
         }
         
         if (_sttProvider.length() == 0) {
@@ -97,11 +105,15 @@ void HAAssistClient::setResultCallback(AssistResultCallback callback) {
 }
 
 void HAAssistClient::setPipeline(const char* pipelineId) {
+    xSemaphoreTake(_connLock, portMAX_DELAY);
     _pipelineId = pipelineId;
+    xSemaphoreGive(_connLock);
 }
 
 void HAAssistClient::setLanguage(const char* lang) {
+    xSemaphoreTake(_connLock, portMAX_DELAY);
     _language = lang;
+    xSemaphoreGive(_connLock);
 }
 
 void HAAssistClient::setSTTProvider(const char* provider) {
@@ -125,14 +137,17 @@ void HAAssistClient::feedAudio(const int16_t* samples, size_t count) {
         return;
     }
     
-    // Copy samples to buffer
+    // Copy samples to buffer (quality metrics are accumulated in the same pass)
     size_t remaining = _recordBufferSize - _recordIndex;
     size_t toCopy = min(count, remaining);
     
     if (toCopy > 0) {
-        memcpy(&_recordBuffer[_recordIndex], samples, toCopy * sizeof(int16_t));
+        audioMetrics.copyAndAccumulate(&_recordBuffer[_recordIndex], samples, toCopy);
         _recordIndex += toCopy;
     }
+    if (toCopy < count) {
+        audioMetrics.addTruncated(count - toCopy);
+    }
     
     // Check if buffer is full
     if (_recordIndex >= _recordBufferSize) {
@@ -152,15 +167,18 @@ bool HAAssistClient::stopAndProcess() {
     
     if (_recordIndex < ASSIST_SAMPLE_RATE / 4) { // Less than 0.25 seconds
         log_w("HAAssist: Recording too short, ignoring");
+        audioMetrics.discard();
         _state = ASSIST_IDLE;
         return false;
     }
     
+    audioMetrics.endUtterance();
     return processVoice(_recordBuffer, _recordIndex);
 }
 
 void HAAssistClient::cancelRecording() {
     log_i("HAAssist: Cancelling recording, discarding %d samples", _recordIndex);
+    audioMetrics.discard();
     _recordIndex = 0;
     _state = ASSIST_IDLE;
 }
@@ -177,7 +195,11 @@ bool HAAssistClient::processVoice(const int16_t* audioBuffer, size_t sampleCount
     log_i("HAAssist: Processing %d audio samples...", sampleCount);
     
     // Send to STT only - skip conversation API
-    if (!sendToSTT(audioBuffer, sampleCount)) {
+    unsigned long sttStart = millis();
+    bool sttOk = sendToSTT(audioBuffer, sampleCount);
+    _lastSttMs = millis() - sttStart;
+    
+    if (!sttOk) {
         _state = ASSIST_ERROR;
         if (_callback) _callback(nullptr, nullptr, _lastError.c_str());
         _state = ASSIST_IDLE;
@@ -296,8 +318,6 @@ bool HAAssistClient::sendToSTT(const int16_t* audioBuffer, size_t sampleCount) {
     // Try different STT API endpoints
     // HA STT API: POST /api/stt/stt.{provider_name}
     
-    HTTPClient http;
-    
     // Try to get list of STT providers first if we don't have one configured
     if (_sttProvider.length() == 0) {
         // Try common provider names (entity format is stt.{name})
@@ -307,11 +327,9 @@ bool HAAssistClient::sendToSTT(const int16_t* audioBuffer, size_t sampleCount) {
             String testUrl = _baseUrl + "/api/stt/stt." + providers[i];
             log_i("HAAssist: Trying STT provider: stt.%s", providers[i]);
             
-            http.begin(testUrl);
-            http.addHeader("Authorization", String("Bearer ") + _token);
+            HARequest http(testUrl, _token.c_str(), 30000);
             http.addHeader("Content-Type", "audio/wav");
             http.addHeader("X-Speech-Content", "format=wav; codec=pcm; sample_rate=16000; bit_rate=16; channel=1; language=" + _language);
-            http.setTimeout(30000);
             
             int httpCode = http.POST(wavBuffer, wavSize);
             
@@ -341,11 +359,9 @@ bool HAAssistClient::sendToSTT(const int16_t* audioBuffer, size_t sampleCount) {
     String url = _baseUrl + "/api/stt/stt." + _sttProvider;
     log_i("HAAssist: POST to %s", url.c_str());
     
-    http.begin(url);
-    http.addHeader("Authorization", String("Bearer ") + _token);
+    HARequest http(url, _token.c_str(), 30000);
     http.addHeader("Content-Type", "audio/wav");
     http.addHeader("X-Speech-Content", "format=wav; codec=pcm; sample_rate=16000; bit_rate=16; channel=1; language=" + _language);
-    http.setTimeout(30000);
     
     int httpCode = http.POST(wavBuffer, wavSize);
     free(wavBuffer);
@@ -396,63 +412,94 @@ bool HAAssistClient::parseSTTResponse(const String& response) {
 bool HAAssistClient::sendToConversation(const char* text) {
     log_i("HAAssist: Sending to conversation: '%s'", text);
     
+    ConversationRequest request;
+    prepareConversation(text, request);
+    ConversationReply reply;
+    if (!converse(request, reply)) {
+        _lastError = reply.error;
+        log_e("HAAssist: %s", _lastError.c_str());
+        return false;
+    }
+    
+    _lastResponse = reply.speech.length() > 0 ? reply.speech : String("(No response)");
+    log_i("HAAssist: Response: '%s'", _lastResponse.c_str());
+    return true;
+}
+
+void HAAssistClient::prepareConversation(const char* text, ConversationRequest& request) const {
     JsonDocument doc;
     doc["text"] = text;
-    doc["language"] = _language;
     
+    xSemaphoreTake(_connLock, portMAX_DELAY);
+    doc["language"] = _language;
     if (_pipelineId.length() > 0) {
         doc["pipeline"] = _pipelineId;
     }
+    request.url = _baseUrl + "/api/conversation/process";
+    request.token = _token;
+    xSemaphoreGive(_connLock);
     
-    String response = makeJsonRequest("/api/conversation/process", doc);
+    request.body = "";
+    serializeJson(doc, request.body);
+}
+
+bool HAAssistClient::converse(const ConversationRequest& request, ConversationReply& reply,
+                              volatile bool* cancel, volatile bool* sent) {
+    reply.sent = false;
+    reply.httpCode = 0;
+    reply.responseType = "";
+    reply.errorCode = "";
+    reply.speech = "";
+    reply.error = "";
+    
+    HARequest http(request.url, request.token.c_str(), 15000);
+    http.addHeader("Content-Type", "application/json");
     
-    if (response.length() == 0) {
+    // HA executes the intent as soon as it receives the text, so this is the
+    // last point where the request can be withdrawn
+    if (cancel && *cancel) {
+        http.end();
+        reply.error = "Cancelled";
         return false;
     }
+    reply.sent = true;
+    if (sent) {
+        *sent = true;
+    }
+    reply.httpCode = http.POST(request.body);
     
-    // Parse response
+    if (reply.httpCode != HTTP_CODE_OK) {
+        reply.error = "HTTP " + String(reply.httpCode);
+        http.end();
+        return false;
+    }
+    String response = http.getString();
+    http.end();
+    
+    // {"response": {"response_type": "action_done", "speech": {"plain": {"speech": "..."}},
+    //  "data": {"code": "no_intent_match"}}, "conversation_id": "..."}
     JsonDocument respDoc;
     DeserializationError error = deserializeJson(respDoc, response);
-    
     if (error) {
-        _lastError = "Failed to parse conversation response";
-        log_e("HAAssist: %s: %s", _lastError.c_str(), error.c_str());
+        reply.error = String("Failed to parse conversation response: ") + error.c_str();
         return false;
     }
     
-    // Extract response text
-    // Response format: {"response": {"speech": {"plain": {"speech": "..."}}}, "conversation_id": "..."}
-    if (respDoc.containsKey("response")) {
-        JsonObject resp = respDoc["response"];
-        if (resp.containsKey("speech")) {
-            JsonObject speech = resp["speech"];
-            if (speech.containsKey("plain")) {
-                _lastResponse = speech["plain"]["speech"].as<String>();
-            }
-        }
+    JsonObject resp = respDoc["response"];
+    reply.responseType = resp["response_type"] | "";
+    reply.errorCode = resp["data"]["code"] | "";
+    reply.speech = resp["speech"]["plain"]["speech"] | "";
+    if (reply.speech.length() == 0) {
+        // Alternate response format
+        reply.speech = respDoc["speech"]["plain"]["speech"] | "";
     }
-    
-    if (_lastResponse.length() == 0) {
-        // Try alternate response format
-        if (respDoc.containsKey("speech")) {
-            _lastResponse = respDoc["speech"]["plain"]["speech"].as<String>();
-        } else {
-            _lastResponse = "(No response)";
-        }
-    }
-    
-    log_i("HAAssist: Response: '%s'", _lastResponse.c_str());
     return true;
 }
 
 String HAAssistClient::makeJsonRequest(const char* endpoint, JsonDocument& doc) {
-    HTTPClient http;
     String url = _baseUrl + endpoint;
-    
-    http.begin(url);
-    http.addHeader("Authorization", String("Bearer ") + _token);
+    HARequest http(url, _token.c_str(), 15000);
     http.addHeader("Content-Type", "application/json");
-    http.setTimeout(15000);
     
     String body;
     serializeJson(doc, body);
@@ -475,15 +522,11 @@ String HAAssistClient::makeJsonRequest(const char* endpoint, JsonDocument& doc)
 
 String HAAssistClient::makeRequest(const char* endpoint, const char* method, 
                                     const char* contentType, const uint8_t* body, size_t bodyLen) {
-    HTTPClient http;
     String url = _baseUrl + endpoint;
-    
-    http.begin(url);
-    http.addHeader("Authorization", String("Bearer ") + _token);
+    HARequest http(url, _token.c_str(), 15000);
     if (contentType) {
         http.addHeader("Content-Type", contentType);
     }
-    http.setTimeout(15000);
     
     int httpCode;
     if (strcmp(method, "POST") == 0) {
@@ -0,0 +1,305 @@
+#include "ha_batch.h"
+#include <string.h>
+#include <stdio.h>
+
+// Keeps tabs and newlines inside a rendered value from breaking the line format
+#define HA_BATCH_CLEAN "| string | replace('\\t',' ') | replace('\\n',' ')"
+
+static bool isIdentifier(const char* s, bool allowDot) {
+    if (!*s) {
+        return false;
+    }
+    int dots = 0;
+    for (; *s; s++) {
+        if (*s == '.') {
+            if (!allowDot) return false;
+            dots++;
+        } else if (!((*s >= 'a' && *s <= 'z') || (*s >= '0' && *s <= '9') || *s == '_')) {
+            return false;
+        }
+    }
+    return !allowDot || dots == 1;
+}
+
+static void copyText(char* dst, size_t size, const char* src, size_t len) {
+    if (len >= size) len = size - 1;
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+HAStateBatch::HAStateBatch() {
+    clear();
+}
+
+void HAStateBatch::clear() {
+    memset(entities, 0, sizeof(entities));
+    memset(attrNames, 0, sizeof(attrNames));
+    memset(values, 0, sizeof(values));
+    entityCount = 0;
+    attrCount = 0;
+    valueCount = 0;
+}
+
+int HAStateBatch::addEntity(const char* entityId) {
+    if (strlen(entityId) >= HA_BATCH_ID_LEN || !isIdentifier(entityId, true)) {
+        return -1;
+    }
+    for (int i = 0; i < entityCount; i++) {
+        if (strcmp(entities[i].entityId, entityId) == 0) {
+            return i;
+        }
+    }
+    if (entityCount >= HA_BATCH_MAX_ENTITIES) {
+        return -1;
+    }
+    strcpy(entities[entityCount].entityId, entityId);
+    return entityCount++;
+}
+
+bool HAStateBatch::addAttribute(const char* name) {
+    if (strlen(name) >= HA_BATCH_NAME_LEN || !isIdentifier(name, false)) {
+        return false;
+    }
+    for (int i = 0; i < attrCount; i++) {
+        if (strcmp(attrNames[i], name) == 0) {
+            return true;
+        }
+    }
+    if (attrCount >= HA_BATCH_MAX_ATTRS) {
+        return false;
+    }
+    strcpy(attrNames[attrCount++], name);
+    return true;
+}
+
+bool HAStateBatch::addValue(const char* name, const char* expression) {
+    if (valueCount >= HA_BATCH_MAX_VALUES || strlen(name) >= HA_BATCH_NAME_LEN || !isIdentifier(name, false) ||
+        strlen(expression) >= HA_BATCH_EXPR_LEN || strstr(expression, "}}") || strstr(expression, "%}")) {
+        return false;
+    }
+    strcpy(values[valueCount].name, name);
+    strcpy(values[valueCount].expression, expression);
+    valueCount++;
+    return true;
+}
+
+size_t HAStateBatch::buildTemplate(char* out, size_t size) const {
+    size_t len = 0;
+    bool ok = true;
+    auto append = [&](const char* s) {
+        size_t n = strlen(s);
+        if (!ok || len + n >= size) {
+            ok = false;
+            return;
+        }
+        memcpy(out + len, s, n);
+        len += n;
+    };
+
+    // {% for e in ['person.a','weather.home'] %}{% if states[e] is not none %}
+    //   e<TAB>state{% for a in [...] %}<TAB>attr{% endfor %}\n{% endif %}{% endfor %}
+    if (entityCount > 0) {
+        append("{% for e in [");
+        for (int i = 0; i < entityCount; i++) {
+            if (i > 0) append(",");
+            append("'");
+            append(entities[i].entityId);
+            append("'");
+        }
+        append("] %}{% if states[e] is not none %}{{ e }}\t{{ states(e) " HA_BATCH_CLEAN " }}");
+        if (attrCount > 0) {
+            append("{% for a in [");
+            for (int i = 0; i < attrCount; i++) {
+                if (i > 0) append(",");
+                append("'");
+                append(attrNames[i]);
+                append("'");
+            }
+            append("] %}{% set v = state_attr(e, a) %}\t{{ ('' if v is none else v) " HA_BATCH_CLEAN " }}{% endfor %}");
+        }
+        append("\n{% endif %}{% endfor %}");
+    }
+
+    // =name<TAB>value
+    for (int i = 0; i < valueCount; i++) {
+        append("=");
+        append(values[i].name);
+        append("\t{{ (");
+        append(values[i].expression);
+        append(") " HA_BATCH_CLEAN " }}\n");
+    }
+
+    if (!ok) {
+        return 0;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+int HAStateBatch::parse(const char* text, size_t len) {
+    for (int i = 0; i < entityCount; i++) {
+        entities[i].found = false;
+        entities[i].state[0] = '\0';
+        for (int a = 0; a < HA_BATCH_MAX_ATTRS; a++) {
+            entities[i].attrs[a][0] = '\0';
+        }
+    }
+    for (int i = 0; i < valueCount; i++) {
+        values[i].found = false;
+        values[i].text[0] = '\0';
+    }
+
+    int found = 0;
+    const char* end = text + len;
+    const char* line = text;
+    while (line < end) {
+        const char* eol = (const char*)memchr(line, '\n', end - line);
+        if (!eol) eol = end;
+
+        // Split into at most 2 + HA_BATCH_MAX_ATTRS fields
+        const char* fields[2 + HA_BATCH_MAX_ATTRS];
+        size_t lengths[2 + HA_BATCH_MAX_ATTRS];
+        int count = 0;
+        const char* p = line;
+        while (count < 2 + HA_BATCH_MAX_ATTRS) {
+            const char* tab = (const char*)memchr(p, '\t', eol - p);
+            fields[count] = p;
+            lengths[count] = (tab ? tab : eol) - p;
+            count++;
+            if (!tab) break;
+            p = tab + 1;
+        }
+
+        if (count >= 2 && lengths[0] > 1 && fields[0][0] == '=') {
+            for (int i = 0; i < valueCount; i++) {
+                if (!values[i].found && strlen(values[i].name) == lengths[0] - 1 &&
+                    memcmp(values[i].name, fields[0] + 1, lengths[0] - 1) == 0) {
+                    copyText(values[i].text, sizeof(values[i].text), fields[1], lengths[1]);
+                    values[i].found = true;
+                    found++;
+                    break;
+                }
+            }
+        } else if (count >= 2) {
+            for (int i = 0; i < entityCount; i++) {
+                HABatchEntity& e = entities[i];
+                if (e.found || strlen(e.entityId) != lengths[0] || memcmp(e.entityId, fields[0], lengths[0]) != 0) {
+                    continue;
+                }
+                copyText(e.state, sizeof(e.state), fields[1], lengths[1]);
+                for (int a = 0; a < attrCount && 2 + a < count; a++) {
+                    copyText(e.attrs[a], sizeof(e.attrs[a]), fields[2 + a], lengths[2 + a]);
+                }
+                e.found = true;
+                found++;
+                break;
+            }
+        }
+
+        line = eol + 1;
+    }
+    return found;
+}
+
+const HABatchEntity* HAStateBatch::find(const char* entityId) const {
+    for (int i = 0; i < entityCount; i++) {
+        if (strcmp(entities[i].entityId, entityId) == 0) {
+            return &entities[i];
+        }
+    }
+    return nullptr;
+}
+
+const char* HAStateBatch::getAttribute(const HABatchEntity& e, const char* name) const {
+    for (int a = 0; a < attrCount; a++) {
+        if (strcmp(attrNames[a], name) == 0) {
+            return e.attrs[a];
+        }
+    }
+    return "";
+}
+
+const char* HAStateBatch::getValue(const char* name) const {
+    for (int i = 0; i < valueCount; i++) {
+        if (values[i].found && strcmp(values[i].name, name) == 0) {
+            return values[i].text;
+        }
+    }
+    return nullptr;
+}
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include "ha_http.h"
+
+#define HA_BATCH_TEMPLATE_SIZE  1536
+
+HABatchClient haBatch;
+
+HABatchClient::HABatchClient()
+    : lastHttpCode(0), fetches(0), failures(0), items(0), lastItems(0), lastMs(0), msSum(0), msMax(0) {
+}
+
+bool HABatchClient::fetch(HAStateBatch& batch, const char* haUrl, const char* token, uint32_t timeoutMs) {
+    if (batch.isEmpty()) {
+        return true;
+    }
+
+    static char tmpl[HA_BATCH_TEMPLATE_SIZE];
+    if (batch.buildTemplate(tmpl, sizeof(tmpl)) == 0) {
+        log_e("HA batch: template exceeds %d bytes", HA_BATCH_TEMPLATE_SIZE);
+        return false;
+    }
+    JsonDocument body;
+    body["template"] = tmpl;
+    String payload;
+    serializeJson(body, payload);
+
+    String url = String(haUrl);
+    if (!url.endsWith("/")) url += "/";
+    url += "api/template";
+
+    unsigned long start = millis();
+    HARequest http(url, token, timeoutMs);
+    http.addHeader("Content-Type", "application/json");
+    lastHttpCode = http.POST(payload);
+    bool ok = lastHttpCode == 200;
+    int found = 0;
+    if (ok) {
+        String response = http.getString();
+        found = batch.parse(response.c_str(), response.length());
+    }
+    http.end();
+
+    lastMs = millis() - start;
+    lastItems = batch.getItemCount();
+    fetches++;
+    if (!ok) {
+        failures++;
+        log_w("HA batch: HTTP %d after %lu ms", lastHttpCode, (unsigned long)lastMs);
+        return false;
+    }
+    items += lastItems;
+    msSum += lastMs;
+    if (lastMs > msMax) msMax = lastMs;
+    log_d("HA batch: %d of %u items in one round trip, %lu ms", found, (unsigned)lastItems, (unsigned long)lastMs);
+    return true;
+}
+
+void HABatchClient::getStatusJson(JsonObject obj) {
+    uint32_t succeeded = fetches - failures;
+    obj["round_trips"] = fetches;
+    obj["failures"] = failures;
+    obj["items"] = items;
+    obj["items_per_round_trip"] = succeeded ? (float)items / succeeded : 0.0f;
+    // One GET per entity or value before batching
+    obj["round_trips_saved"] = items - succeeded;
+    obj["last_items"] = lastItems;
+    obj["last_ms"] = lastMs;
+    obj["avg_ms"] = succeeded ? msSum / succeeded : 0;
+    obj["max_ms"] = msMax;
+    obj["last_http_code"] = lastHttpCode;
+}
+#endif
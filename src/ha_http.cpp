@@ -0,0 +1,406 @@
+#include "ha_http.h"
+
+HAHttpPool haHttp;
+
+// Splits http[s]://host[:port]/... ; false for anything the pool should not
+// handle (other schemes, credentials in the URL, oversized host names)
+static bool parseUrl(const String& url, char* host, size_t size, uint16_t& port, bool& secure) {
+    int scheme = url.indexOf("://");
+    if (scheme < 0) {
+        return false;
+    }
+    String protocol = url.substring(0, scheme);
+    if (protocol == "http") {
+        secure = false;
+        port = 80;
+    } else if (protocol == "https") {
+        secure = true;
+        port = 443;
+    } else {
+        return false;
+    }
+
+    int start = scheme + 3;
+    int end = url.indexOf('/', start);
+    String authority = url.substring(start, end < 0 ? url.length() : end);
+    if (authority.indexOf('@') >= 0) {
+        return false;
+    }
+    int colon = authority.lastIndexOf(':');
+    if (colon >= 0) {
+        port = authority.substring(colon + 1).toInt();
+        authority.remove(colon);
+    }
+    if (authority.isEmpty() || authority.length() >= size || port == 0) {
+        return false;
+    }
+    strcpy(host, authority.c_str());
+    return true;
+}
+
+// ============================================
+// Pool
+// ============================================
+
+HAHttpPool::HAHttpPool() : keepAlive(true), idleMs(HA_HTTP_IDLE_MS) {
+    memset(slots, 0, sizeof(slots));
+    memset(&stats, 0, sizeof(stats));
+    mutex = xSemaphoreCreateMutex();
+}
+
+void HAHttpPool::begin(JsonDocument& config) {
+    JsonObject cfg = config["ha_http"];
+    keepAlive = cfg["keep_alive"] | true;
+    idleMs = constrain(cfg["idle_s"] | HA_HTTP_IDLE_MS / 1000, 5, 70) * 1000UL;
+    if (!keepAlive) {
+        closeIdle();
+    }
+    log_i("HA HTTP: keep-alive %s, %d connections, idle limit %lu s", keepAlive ? "on" : "off",
+          HA_HTTP_SLOTS, (unsigned long)(idleMs / 1000));
+}
+
+void HAHttpPool::closeIdle() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for (int i = 0; i < HA_HTTP_SLOTS; i++) {
+        if (!slots[i].busy && slots[i].client) {
+            slots[i].client->stop();
+            slots[i].requests = 0;
+        }
+    }
+    xSemaphoreGive(mutex);
+}
+
+int HAHttpPool::acquire(const char* host, uint16_t port, bool secure) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (!keepAlive) {
+        stats.unpooled++;
+        xSemaphoreGive(mutex);
+        return -1;
+    }
+
+    // Prefer the most recently used connection to the same endpoint, then an
+    // empty slot, then the least recently used one
+    int best = -1;
+    bool bestSame = false;
+    for (int i = 0; i < HA_HTTP_SLOTS; i++) {
+        HAHttpSlot& s = slots[i];
+        if (s.busy) {
+            continue;
+        }
+        bool same = s.client && s.secure == secure && s.port == port && strcmp(s.host, host) == 0;
+        if (best < 0) {
+            best = i;
+            bestSame = same;
+            continue;
+        }
+        HAHttpSlot& b = slots[best];
+        if (same != bestSame) {
+            if (same) {
+                best = i;
+                bestSame = true;
+            }
+        } else if (same) {
+            if ((int32_t)(s.lastUsedMs - b.lastUsedMs) > 0) best = i;
+        } else if (!s.client && b.client) {
+            best = i;
+        } else if (s.client && b.client && (int32_t)(s.lastUsedMs - b.lastUsedMs) < 0) {
+            best = i;
+        }
+    }
+    if (best < 0) {
+        stats.unpooled++;
+        xSemaphoreGive(mutex);
+        return -1;
+    }
+    slots[best].busy = true;
+    xSemaphoreGive(mutex);
+
+    // The slot is ours now; connection changes happen outside the lock
+    HAHttpSlot& s = slots[best];
+    if (!bestSame) {
+        if (s.client && s.secure != secure) {
+            s.client->stop();
+            delete s.client;
+            s.client = nullptr;
+        } else if (s.client) {
+            s.client->stop();
+        }
+        if (!s.client) {
+            if (secure) {
+                WiFiClientSecure* tls = new WiFiClientSecure();
+                tls->setInsecure();     // Same as HTTPClient::begin(url) without a CA
+                s.client = tls;
+            } else {
+                s.client = new WiFiClient();
+            }
+        }
+        strcpy(s.host, host);
+        s.port = port;
+        s.secure = secure;
+        s.requests = 0;
+    } else if (millis() - s.lastUsedMs > idleMs && s.client->connected()) {
+        // HA may be about to close it; reconnect rather than race it
+        s.client->stop();
+        s.requests = 0;
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        stats.expired++;
+        xSemaphoreGive(mutex);
+    }
+    return best;
+}
+
+void HAHttpPool::release(int slot, bool discarded) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    slots[slot].busy = false;
+    slots[slot].lastUsedMs = millis();
+    if (discarded) {
+        slots[slot].requests = 0;
+        stats.discarded++;
+    }
+    xSemaphoreGive(mutex);
+}
+
+void HAHttpPool::getAuthHeader(const char* token, String& header) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (authToken != token) {
+        authToken = token;
+        authHeader = String("Bearer ") + token;
+    }
+    header = authHeader;
+    xSemaphoreGive(mutex);
+}
+
+void HAHttpPool::recordRequest(bool reused, bool retried) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    stats.requests++;
+    if (reused) stats.reused++;
+    if (retried) stats.retries++;
+    xSemaphoreGive(mutex);
+}
+
+void HAHttpPool::recordStreamed(size_t bytes) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    stats.streamed++;
+    stats.streamedBytes += bytes;
+    if (bytes > stats.streamedMaxBytes) stats.streamedMaxBytes = bytes;
+    xSemaphoreGive(mutex);
+}
+
+void HAHttpPool::recordConnect(bool ok, uint32_t ms) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (ok) {
+        stats.connects++;
+        stats.connectMsSum += ms;
+        if (ms > stats.connectMsMax) stats.connectMsMax = ms;
+    } else {
+        stats.connectFailures++;
+    }
+    xSemaphoreGive(mutex);
+}
+
+void HAHttpPool::getStatusJson(JsonObject obj) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    HAHttpStats st = stats;
+    HAHttpSlot snapshot[HA_HTTP_SLOTS];
+    bool open[HA_HTTP_SLOTS];
+    for (int i = 0; i < HA_HTTP_SLOTS; i++) {
+        snapshot[i] = slots[i];
+        open[i] = slots[i].client && (slots[i].busy || slots[i].client->connected());
+    }
+    xSemaphoreGive(mutex);
+
+    uint32_t connectMsAvg = st.connects ? st.connectMsSum / st.connects : 0;
+    obj["keep_alive"] = keepAlive;
+    obj["requests"] = st.requests;
+    obj["reused"] = st.reused;
+    obj["reuse_rate"] = st.requests ? (float)st.reused / st.requests : 0.0f;
+    obj["connects"] = st.connects;
+    obj["connect_failures"] = st.connectFailures;
+    obj["connect_ms_avg"] = connectMsAvg;
+    obj["connect_ms_max"] = st.connectMsMax;
+    // Each reuse skipped one handshake of average cost
+    obj["saved_ms"] = st.reused * connectMsAvg;
+    obj["retries"] = st.retries;
+    obj["expired"] = st.expired;
+    obj["discarded"] = st.discarded;
+    obj["unpooled"] = st.unpooled;
+    obj["streamed"] = st.streamed;
+    obj["streamed_bytes"] = st.streamedBytes;
+    obj["streamed_max_bytes"] = st.streamedMaxBytes;
+
+    JsonArray conns = obj["connections"].to<JsonArray>();
+    uint32_t now = millis();
+    for (int i = 0; i < HA_HTTP_SLOTS; i++) {
+        if (!snapshot[i].client) {
+            continue;
+        }
+        JsonObject c = conns.add<JsonObject>();
+        c["host"] = snapshot[i].host;
+        c["port"] = snapshot[i].port;
+        c["tls"] = snapshot[i].secure;
+        c["open"] = open[i];
+        c["busy"] = snapshot[i].busy;
+        c["requests"] = snapshot[i].requests;
+        c["idle_ms"] = snapshot[i].busy ? 0 : now - snapshot[i].lastUsedMs;
+    }
+}
+
+// ============================================
+// Request
+// ============================================
+
+// What is left of the deadline, at least 500 ms (HTTPClient timeouts are 16 bit)
+static uint16_t remainingMs(uint32_t start, uint32_t timeout) {
+    uint32_t elapsed = millis() - start;
+    if (elapsed + 500 >= timeout) {
+        return 500;
+    }
+    return timeout - elapsed > UINT16_MAX ? UINT16_MAX : timeout - elapsed;
+}
+
+HARequest::HARequest(const String& url, const char* token, uint32_t timeoutMs)
+    : slot(-1), began(false), consumed(false), requested(false), timeoutMs(timeoutMs) {
+    char host[HA_HTTP_HOST_LEN];
+    uint16_t port;
+    bool secure;
+    if (parseUrl(url, host, sizeof(host), port, secure)) {
+        slot = haHttp.acquire(host, port, secure);
+    }
+
+    if (slot >= 0) {
+        setReuse(true);
+        began = HTTPClient::begin(*haHttp.slots[slot].client, url);
+        if (!began) {
+            haHttp.release(slot, false);
+            slot = -1;
+        }
+    }
+    if (slot < 0 && !began) {
+        began = HTTPClient::begin(url);
+        setConnectTimeout(timeoutMs);
+    }
+
+    if (began && token && *token) {
+        String auth;
+        haHttp.getAuthHeader(token, auth);
+        addHeader("Authorization", auth);
+    }
+}
+
+HARequest::~HARequest() {
+    end();
+}
+
+bool HARequest::connectSlot(uint32_t timeout) {
+    HAHttpSlot& s = haHttp.slots[slot];
+    uint32_t start = millis();
+    bool ok = s.secure ? static_cast<WiFiClientSecure*>(s.client)->connect(s.host, s.port, timeout)
+                       : s.client->connect(s.host, s.port, timeout);
+    haHttp.recordConnect(ok, millis() - start);
+    s.requests = 0;
+    return ok;
+}
+
+int HARequest::sendRequest(const char* type, uint8_t* payload, size_t size) {
+    if (!began) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    requested = true;
+    consumed = false;
+    uint32_t start = millis();
+
+    if (slot < 0) {
+        setTimeout(remainingMs(start, timeoutMs));
+        haHttp.recordRequest(false, false);
+        return HTTPClient::sendRequest(type, payload, size);
+    }
+
+    bool reused = _client->connected();
+    if (!reused && !connectSlot(timeoutMs)) {
+        haHttp.recordRequest(false, false);
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    setTimeout(remainingMs(start, timeoutMs));
+    int code = HTTPClient::sendRequest(type, payload, size);
+
+    // HA closed the kept connection under us. Resend only if the request
+    // cannot have reached it complete (a GET is always safe to repeat).
+    bool retried = false;
+    if (reused && (code == HTTPC_ERROR_SEND_HEADER_FAILED || code == HTTPC_ERROR_SEND_PAYLOAD_FAILED ||
+                   (code == HTTPC_ERROR_CONNECTION_LOST && strcmp(type, "GET") == 0))) {
+        retried = true;
+        _client->stop();
+        if (connectSlot(remainingMs(start, timeoutMs))) {
+            setTimeout(remainingMs(start, timeoutMs));
+            code = HTTPClient::sendRequest(type, payload, size);
+        }
+    }
+    haHttp.recordRequest(reused && !retried, retried);
+    if (code > 0) {
+        haHttp.slots[slot].requests++;
+        consumed = getSize() == 0;
+    }
+    return code;
+}
+
+int HARequest::GET() {
+    return sendRequest("GET");
+}
+
+int HARequest::POST(String payload) {
+    return sendRequest("POST", (uint8_t*)payload.c_str(), payload.length());
+}
+
+int HARequest::POST(uint8_t* payload, size_t size) {
+    return sendRequest("POST", payload, size);
+}
+
+String HARequest::getString() {
+    String body = HTTPClient::getString();
+    consumed = true;
+    return body;
+}
+
+int HARequest::writeToStream(Stream* stream) {
+    int written = HTTPClient::writeToStream(stream);
+    consumed = written >= 0;
+    return written;
+}
+
+bool HARequest::readJson(JsonStreamParser& parser) {
+    JsonStreamSink sink(parser);
+    int written = writeToStream(&sink);
+    haHttp.recordStreamed(sink.bytes);
+    if (written < 0) {
+        log_w("HA request: body lost after %u bytes (%d)", (unsigned)sink.bytes, written);
+        return false;
+    }
+    if (!parser.finish()) {
+        log_w("HA request: invalid JSON at byte %u: %s", (unsigned)parser.getOffset(), parser.getError());
+        return false;
+    }
+    return true;
+}
+
+void HARequest::end() {
+    if (!began) {
+        return;
+    }
+    began = false;
+    if (slot < 0) {
+        HTTPClient::end();
+        return;
+    }
+
+    // A connection only goes back open if nothing of this response is left
+    // on it; an unused lease keeps whatever state it had
+    bool keep = requested ? (consumed && _canReuse && _client->connected()) : _client->connected();
+    if (!keep) {
+        _client->stop();
+    }
+    // HTTPClient::end() and ~HTTPClient() would close the pooled connection
+    _client = nullptr;
+    HTTPClient::end();
+    haHttp.release(slot, requested && !keep);
+    slot = -1;
+}
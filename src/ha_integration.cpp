@@ -10,8 +10,8 @@ HomeAssistantIntegration::HomeAssistantIntegration()
 void HomeAssistantIntegration::begin() {
     Serial.println("Initializing Home Assistant integration...");
     
-    // Publish discovery messages after a delay
-    delay(2000);
+    // Started by the boot sequencer after MQTT's connection attempt, so no
+    // fixed wait before publishing
     publishDiscovery();
     
     Serial.println("Home Assistant integration ready");
@@ -135,7 +135,7 @@ void HomeAssistantIntegration::publishSwitchDiscovery(const char* name) {
     mqttClient.publishJson(topic.c_str(), doc, true);
 }
 
-void HomeAssistantIntegration::controlLight(const char* entityId, bool state, int brightness) {
+bool HomeAssistantIntegration::controlLight(const char* entityId, bool state, int brightness) {
     String topic = String("homeassistant/light/") + entityId + "/set";
     
     JsonDocument doc;
@@ -145,22 +145,22 @@ void HomeAssistantIntegration::controlLight(const char* entityId, bool state, in
         doc["brightness"] = brightness;
     }
     
-    mqttClient.publishJson(topic.c_str(), doc);
+    return mqttClient.publishJson(topic.c_str(), doc);
 }
 
-void HomeAssistantIntegration::controlSwitch(const char* entityId, bool state) {
+bool HomeAssistantIntegration::controlSwitch(const char* entityId, bool state) {
     String topic = String("homeassistant/switch/") + entityId + "/set";
-    mqttClient.publish(topic.c_str(), state ? "ON" : "OFF");
+    return mqttClient.publish(topic.c_str(), state ? "ON" : "OFF");
 }
 
-void HomeAssistantIntegration::controlLock(const char* entityId, bool locked) {
+bool HomeAssistantIntegration::controlLock(const char* entityId, bool locked) {
     String topic = String("homeassistant/lock/") + entityId + "/set";
-    mqttClient.publish(topic.c_str(), locked ? "LOCK" : "UNLOCK");
+    return mqttClient.publish(topic.c_str(), locked ? "LOCK" : "UNLOCK");
 }
 
-void HomeAssistantIntegration::controlCover(const char* entityId, const char* action) {
+bool HomeAssistantIntegration::controlCover(const char* entityId, const char* action) {
     String topic = String("homeassistant/cover/") + entityId + "/set";
-    mqttClient.publish(topic.c_str(), action);
+    return mqttClient.publish(topic.c_str(), action);
 }
 
 void HomeAssistantIntegration::updatePresenceSensor(const char* person, bool present) {
@@ -175,9 +175,27 @@ void HomeAssistantIntegration::updateVoiceCommandSensor(const char* command) {
     mqttClient.publish("entryhub/sensor/voice_command", command);
 }
 
-void HomeAssistantIntegration::activateScene(const char* sceneId) {
+bool HomeAssistantIntegration::activateScene(const char* sceneId) {
     String topic = String("homeassistant/scene/") + sceneId + "/set";
-    mqttClient.publish(topic.c_str(), "ON");
+    return mqttClient.publish(topic.c_str(), "ON");
+}
+
+bool HomeAssistantIntegration::callService(const char* domain, const char* objectId, const char* service) {
+    bool off = strcmp(service, "off") == 0 || strcmp(service, "turn_off") == 0;
+    
+    if (strcmp(domain, "light") == 0) {
+        return controlLight(objectId, !off);
+    } else if (strcmp(domain, "switch") == 0) {
+        return controlSwitch(objectId, !off);
+    } else if (strcmp(domain, "lock") == 0) {
+        return controlLock(objectId, strcmp(service, "lock") == 0);
+    } else if (strcmp(domain, "cover") == 0) {
+        return controlCover(objectId, service);
+    } else if (strcmp(domain, "scene") == 0) {
+        return activateScene(objectId);
+    }
+    Serial.printf("Unsupported action domain: %s\n", domain);
+    return false;
 }
 
 String HomeAssistantIntegration::getUniqueId(const char* component) {
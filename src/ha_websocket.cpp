@@ -0,0 +1,1066 @@
+#include "ha_websocket.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <string>
+
+// ============================================
+// Handshake helpers
+// ============================================
+
+static const char BASE64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static size_t base64Encode(const uint8_t* in, size_t len, char* out) {
+    size_t n = 0;
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = (uint32_t)in[i] << 16;
+        if (i + 1 < len) v |= (uint32_t)in[i + 1] << 8;
+        if (i + 2 < len) v |= in[i + 2];
+        out[n++] = BASE64[(v >> 18) & 63];
+        out[n++] = BASE64[(v >> 12) & 63];
+        out[n++] = i + 1 < len ? BASE64[(v >> 6) & 63] : '=';
+        out[n++] = i + 2 < len ? BASE64[v & 63] : '=';
+    }
+    out[n] = '\0';
+    return n;
+}
+
+static inline uint32_t rol(uint32_t v, int n) {
+    return (v << n) | (v >> (32 - n));
+}
+
+// SHA-1, only used for the 60-byte handshake accept value
+static void sha1(const uint8_t* data, size_t len, uint8_t digest[20]) {
+    uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    uint64_t bits = (uint64_t)len * 8;
+    size_t total = ((len + 8) / 64 + 1) * 64;
+
+    for (size_t block = 0; block < total; block += 64) {
+        uint8_t chunk[64];
+        for (size_t i = 0; i < 64; i++) {
+            size_t pos = block + i;
+            if (pos < len) chunk[i] = data[pos];
+            else if (pos == len) chunk[i] = 0x80;
+            else if (pos >= total - 8) chunk[i] = (uint8_t)(bits >> (8 * (total - 1 - pos)));
+            else chunk[i] = 0;
+        }
+
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            w[i] = (uint32_t)chunk[4 * i] << 24 | (uint32_t)chunk[4 * i + 1] << 16 |
+                   (uint32_t)chunk[4 * i + 2] << 8 | chunk[4 * i + 3];
+        }
+        for (int i = 16; i < 80; i++) {
+            w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20)      { f = (b & c) | (~b & d);           k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d;                    k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d);  k = 0x8F1BBCDC; }
+            else             { f = b ^ c ^ d;                    k = 0xCA62C1D6; }
+            uint32_t t = rol(a, 5) + f + e + k + w[i];
+            e = d; d = c; c = rol(b, 30); b = a; a = t;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    for (int i = 0; i < 5; i++) {
+        digest[4 * i] = (uint8_t)(h[i] >> 24);
+        digest[4 * i + 1] = (uint8_t)(h[i] >> 16);
+        digest[4 * i + 2] = (uint8_t)(h[i] >> 8);
+        digest[4 * i + 3] = (uint8_t)h[i];
+    }
+}
+
+void wsMakeKey(const uint8_t nonce[16], char key[25]) {
+    base64Encode(nonce, 16, key);
+}
+
+void wsAcceptFor(const char* key, char accept[29]) {
+    char buf[128];
+    int n = snprintf(buf, sizeof(buf), "%s258EAFA5-E914-47DA-95CA-C5AB0DC85B11", key);
+    uint8_t digest[20];
+    sha1((const uint8_t*)buf, n > 0 && (size_t)n < sizeof(buf) ? (size_t)n : 0, digest);
+    base64Encode(digest, 20, accept);
+}
+
+size_t wsBuildHandshake(const char* host, uint16_t port, const char* path, const char* key, char* out, size_t size) {
+    int n = snprintf(out, size,
+                     "GET %s HTTP/1.1\r\n"
+                     "Host: %s:%u\r\n"
+                     "Upgrade: websocket\r\n"
+                     "Connection: Upgrade\r\n"
+                     "Sec-WebSocket-Key: %s\r\n"
+                     "Sec-WebSocket-Version: 13\r\n"
+                     "\r\n",
+                     path, host, (unsigned)port, key);
+    return n > 0 && (size_t)n < size ? (size_t)n : 0;
+}
+
+bool wsCheckHandshake(const char* response, const char* key) {
+    if (strncmp(response, "HTTP/1.1 101", 12) != 0) {
+        return false;
+    }
+
+    static const char HEADER[] = "sec-websocket-accept:";
+    for (const char* line = strchr(response, '\n'); line; line = strchr(line, '\n')) {
+        line++;
+        size_t i = 0;
+        while (HEADER[i] && tolower((unsigned char)line[i]) == HEADER[i]) i++;
+        if (HEADER[i]) {
+            continue;
+        }
+        const char* value = line + i;
+        while (*value == ' ') value++;
+        char expected[29];
+        wsAcceptFor(key, expected);
+        return strncmp(value, expected, 28) == 0 && (value[28] == '\r' || value[28] == '\n' || !value[28]);
+    }
+    return false;
+}
+
+// ============================================
+// Framing
+// ============================================
+
+size_t wsEncodeFrame(WsOpcode op, const uint8_t* payload, size_t len, const uint8_t mask[4], uint8_t* out, size_t size) {
+    size_t header = 2 + (len < 126 ? 0 : len < 65536 ? 2 : 8) + 4;
+    if (size < header + len) {
+        return 0;
+    }
+
+    size_t n = 0;
+    out[n++] = 0x80 | op;       // FIN, never fragmented
+    if (len < 126) {
+        out[n++] = 0x80 | (uint8_t)len;
+    } else if (len < 65536) {
+        out[n++] = 0x80 | 126;
+        out[n++] = (uint8_t)(len >> 8);
+        out[n++] = (uint8_t)len;
+    } else {
+        out[n++] = 0x80 | 127;
+        for (int i = 7; i >= 0; i--) {
+            out[n++] = (uint8_t)((uint64_t)len >> (8 * i));
+        }
+    }
+    memcpy(out + n, mask, 4);
+    n += 4;
+    for (size_t i = 0; i < len; i++) {
+        out[n++] = payload[i] ^ mask[i & 3];
+    }
+    return n;
+}
+
+WsDecoder::WsDecoder() : handler(nullptr), handlerCtx(nullptr) {
+    reset();
+}
+
+void WsDecoder::reset() {
+    headerLen = 0;
+    headerNeed = 2;
+    remaining = 0;
+    opcode = WS_OP_CONTINUATION;
+    fin = false;
+    messageOp = WS_OP_TEXT;
+    inMessage = false;
+    message.clear();
+    controlLen = 0;
+}
+
+bool WsDecoder::feed(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        // Header bytes
+        if (headerLen < headerNeed) {
+            header[headerLen++] = data[i++];
+            if (headerLen == 2) {
+                if (header[1] & 0x80) {
+                    return false;       // Servers never mask
+                }
+                uint8_t len7 = header[1] & 0x7f;
+                headerNeed = 2 + (len7 == 126 ? 2 : len7 == 127 ? 8 : 0);
+            }
+            if (headerLen == headerNeed && !startFrame()) {
+                return false;
+            }
+            continue;
+        }
+
+        // Payload bytes
+        size_t n = (size_t)((uint64_t)(len - i) < remaining ? len - i : remaining);
+        if (opcode >= WS_OP_CLOSE) {
+            memcpy(control + controlLen, data + i, n);
+            controlLen += n;
+        } else {
+            message.insert(message.end(), data + i, data + i + n);
+        }
+        i += n;
+        remaining -= n;
+        if (remaining == 0 && !endFrame()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WsDecoder::startFrame() {
+    fin = header[0] & 0x80;
+    opcode = (WsOpcode)(header[0] & 0x0f);
+    uint8_t len7 = header[1] & 0x7f;
+    if (len7 == 126) {
+        remaining = (uint64_t)header[2] << 8 | header[3];
+    } else if (len7 == 127) {
+        remaining = 0;
+        for (int i = 0; i < 8; i++) {
+            remaining = remaining << 8 | header[2 + i];
+        }
+    } else {
+        remaining = len7;
+    }
+
+    if (header[0] & 0x70) {
+        return false;           // No extensions negotiated
+    }
+    switch (opcode) {
+        case WS_OP_CLOSE:
+        case WS_OP_PING:
+        case WS_OP_PONG:
+            if (!fin || remaining > sizeof(control)) {
+                return false;
+            }
+            controlLen = 0;
+            break;
+        case WS_OP_TEXT:
+        case WS_OP_BINARY:
+            if (inMessage) {
+                return false;
+            }
+            inMessage = true;
+            messageOp = opcode;
+            message.clear();
+            // fall through
+        case WS_OP_CONTINUATION:
+            if (!inMessage || message.size() + remaining > HA_WS_MAX_MESSAGE) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+    }
+
+    return remaining > 0 || endFrame();
+}
+
+bool WsDecoder::endFrame() {
+    headerLen = 0;
+    headerNeed = 2;
+
+    if (opcode >= WS_OP_CLOSE) {
+        if (handler) handler(opcode, control, controlLen, handlerCtx);
+        return true;
+    }
+    if (fin) {
+        inMessage = false;
+        if (handler) handler(messageOp, message.data(), message.size(), handlerCtx);
+        message.clear();
+    }
+    return true;
+}
+
+// ============================================
+// Minimal JSON scanning
+// ============================================
+//
+// Messages are complete in memory once reassembled, so values are located
+// as spans of the original text instead of being parsed into a tree.
+
+struct JsonSpan {
+    const char* p;
+    const char* end;
+};
+
+static const char* skipWs(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+    return p;
+}
+
+static const char* skipString(const char* p, const char* end) {
+    for (p++; p < end; p++) {
+        if (*p == '\\') p++;
+        else if (*p == '"') return p + 1;
+    }
+    return nullptr;
+}
+
+static const char* skipValue(const char* p, const char* end) {
+    p = skipWs(p, end);
+    if (p >= end) return nullptr;
+    if (*p == '"') return skipString(p, end);
+    if (*p == '{' || *p == '[') {
+        int depth = 0;
+        while (p < end) {
+            if (*p == '"') {
+                p = skipString(p, end);
+                if (!p) return nullptr;
+                continue;
+            }
+            if (*p == '{' || *p == '[') depth++;
+            else if (*p == '}' || *p == ']') {
+                if (--depth == 0) return p + 1;
+            }
+            p++;
+        }
+        return nullptr;
+    }
+    while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\n' && *p != '\r') p++;
+    return p;
+}
+
+// fn(key, value) for each member of an object (key without quotes, not
+// unescaped); false if the span is not a well-formed object
+template <typename F>
+static bool forEachMember(JsonSpan obj, F&& fn) {
+    const char* p = skipWs(obj.p, obj.end);
+    if (p >= obj.end || *p != '{') return false;
+    p = skipWs(p + 1, obj.end);
+    if (p < obj.end && *p == '}') return true;
+    while (p < obj.end) {
+        if (*p != '"') return false;
+        const char* keyEnd = skipString(p, obj.end);
+        if (!keyEnd) return false;
+        JsonSpan key = { p + 1, keyEnd - 1 };
+        p = skipWs(keyEnd, obj.end);
+        if (p >= obj.end || *p != ':') return false;
+        const char* v = skipWs(p + 1, obj.end);
+        const char* vEnd = skipValue(v, obj.end);
+        if (!vEnd) return false;
+        fn(key, JsonSpan{ v, vEnd });
+        p = skipWs(vEnd, obj.end);
+        if (p < obj.end && *p == ',') {
+            p = skipWs(p + 1, obj.end);
+        } else {
+            return p < obj.end && *p == '}';
+        }
+    }
+    return false;
+}
+
+template <typename F>
+static bool forEachElement(JsonSpan arr, F&& fn) {
+    const char* p = skipWs(arr.p, arr.end);
+    if (p >= arr.end || *p != '[') return false;
+    p = skipWs(p + 1, arr.end);
+    if (p < arr.end && *p == ']') return true;
+    while (p < arr.end) {
+        const char* vEnd = skipValue(p, arr.end);
+        if (!vEnd) return false;
+        fn(JsonSpan{ p, vEnd });
+        p = skipWs(vEnd, arr.end);
+        if (p < arr.end && *p == ',') {
+            p = skipWs(p + 1, arr.end);
+        } else {
+            return p < arr.end && *p == ']';
+        }
+    }
+    return false;
+}
+
+static bool keyIs(JsonSpan key, const char* name) {
+    size_t len = strlen(name);
+    return (size_t)(key.end - key.p) == len && memcmp(key.p, name, len) == 0;
+}
+
+static bool findMember(JsonSpan obj, const char* name, JsonSpan& out) {
+    bool found = false;
+    forEachMember(obj, [&](JsonSpan key, JsonSpan value) {
+        if (!found && keyIs(key, name)) {
+            out = value;
+            found = true;
+        }
+    });
+    return found;
+}
+
+static void putUtf8(uint32_t cp, char* out, size_t& n, size_t size) {
+    char buf[4];
+    size_t len;
+    if (cp < 0x80) { buf[0] = (char)cp; len = 1; }
+    else if (cp < 0x800) { buf[0] = (char)(0xC0 | cp >> 6); buf[1] = (char)(0x80 | (cp & 0x3F)); len = 2; }
+    else {
+        buf[0] = (char)(0xE0 | cp >> 12);
+        buf[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        buf[2] = (char)(0x80 | (cp & 0x3F));
+        len = 3;
+    }
+    if (n + len < size) {
+        memcpy(out + n, buf, len);
+        n += len;
+    }
+}
+
+// Text of a scalar: strings unescaped, numbers and booleans as written, null
+// and containers as ""; truncated to fit
+static size_t scalarText(JsonSpan v, char* out, size_t size) {
+    size_t n = 0;
+    const char* p = skipWs(v.p, v.end);
+    if (p < v.end && *p == '"') {
+        for (p++; p < v.end && *p != '"' && n + 1 < size; p++) {
+            if (*p != '\\' || p + 1 >= v.end) {
+                out[n++] = *p;
+                continue;
+            }
+            p++;
+            switch (*p) {
+                case 'n': out[n++] = '\n'; break;
+                case 't': out[n++] = '\t'; break;
+                case 'r': out[n++] = '\r'; break;
+                case 'b': out[n++] = '\b'; break;
+                case 'f': out[n++] = '\f'; break;
+                case 'u':
+                    if (p + 4 < v.end) {
+                        char hex[5] = { p[1], p[2], p[3], p[4], 0 };
+                        putUtf8((uint32_t)strtoul(hex, nullptr, 16), out, n, size);
+                        p += 4;
+                    }
+                    break;
+                default: out[n++] = *p; break;
+            }
+        }
+    } else if (p < v.end && *p != '{' && *p != '[' && strncmp(p, "null", 4) != 0) {
+        while (p < v.end && n + 1 < size) out[n++] = *p++;
+    }
+    if (size) out[n] = '\0';
+    return n;
+}
+
+static double numberOf(JsonSpan v) {
+    char buf[32];
+    scalarText(v, buf, sizeof(buf));
+    return strtod(buf, nullptr);
+}
+
+static bool stringIs(JsonSpan v, const char* s) {
+    const char* p = skipWs(v.p, v.end);
+    size_t len = strlen(s);
+    return p < v.end && *p == '"' && (size_t)(v.end - p) == len + 2 && memcmp(p + 1, s, len) == 0;
+}
+
+// ============================================
+// State cache
+// ============================================
+
+HAStateCache::HAStateCache() : entityCount(0), attrCount(0), events(0), changes(0), ignored(0) {
+    memset(entities, 0, sizeof(entities));
+    memset(attrNames, 0, sizeof(attrNames));
+}
+
+bool HAStateCache::addEntity(const char* entityId) {
+    size_t len = strlen(entityId);
+    if (entityCount == HA_WS_MAX_ENTITIES || len == 0 || len >= HA_WS_ENTITY_LEN || indexOf(entityId, len) >= 0) {
+        return false;
+    }
+    HAEntityState& e = entities[entityCount++];
+    memset(&e, 0, sizeof(e));
+    memcpy(e.entityId, entityId, len + 1);
+    return true;
+}
+
+bool HAStateCache::watchAttribute(const char* name) {
+    if (attrCount == HA_WS_MAX_ATTRS || strlen(name) >= sizeof(attrNames[0])) {
+        return false;
+    }
+    strcpy(attrNames[attrCount++], name);
+    return true;
+}
+
+void HAStateCache::reset() {
+    for (size_t i = 0; i < entityCount; i++) {
+        HAEntityState& e = entities[i];
+        e.state[0] = '\0';
+        memset(e.attrs, 0, sizeof(e.attrs));
+        e.lastChanged = 0;
+        e.known = false;
+        e.changed = false;
+    }
+}
+
+int HAStateCache::indexOf(const char* entityId, size_t len) const {
+    for (size_t i = 0; i < entityCount; i++) {
+        if (strncmp(entities[i].entityId, entityId, len) == 0 && entities[i].entityId[len] == '\0') {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+bool HAStateCache::applyState(HAEntityState& e, const char* json, size_t len, bool replace) {
+    JsonSpan obj = { json, json + len };
+    bool differs = !e.known;
+    char buf[HA_WS_STATE_LEN];
+    JsonSpan v;
+
+    if (findMember(obj, "s", v)) {
+        scalarText(v, buf, sizeof(buf));
+        if (strcmp(buf, e.state) != 0) {
+            strcpy(e.state, buf);
+            differs = true;
+        }
+    }
+    if (findMember(obj, "lc", v)) {
+        e.lastChanged = numberOf(v);
+    }
+
+    JsonSpan attrs;
+    bool haveAttrs = findMember(obj, "a", attrs);
+    for (size_t i = 0; i < attrCount; i++) {
+        char value[HA_WS_ATTR_LEN];
+        if (haveAttrs && findMember(attrs, attrNames[i], v)) {
+            scalarText(v, value, sizeof(value));
+        } else if (replace) {
+            value[0] = '\0';
+        } else {
+            continue;           // Diffs only carry attributes that changed
+        }
+        if (strcmp(value, e.attrs[i]) != 0) {
+            strcpy(e.attrs[i], value);
+            differs = true;
+        }
+    }
+
+    e.known = true;
+    return differs;
+}
+
+int HAStateCache::apply(const char* json, size_t len, uint32_t now) {
+    JsonSpan event = { json, json + len };
+    int changed = 0;
+    events++;
+
+    auto touch = [&](HAEntityState& e) {
+        e.changed = true;
+        e.receivedMs = now;
+        e.updates++;
+        changes++;
+        changed++;
+    };
+
+    JsonSpan section;
+    if (findMember(event, "a", section)) {
+        forEachMember(section, [&](JsonSpan id, JsonSpan value) {
+            int i = indexOf(id.p, id.end - id.p);
+            if (i < 0) {
+                ignored++;
+                return;
+            }
+            if (applyState(entities[i], value.p, value.end - value.p, true)) {
+                touch(entities[i]);
+            }
+        });
+    }
+
+    if (findMember(event, "c", section)) {
+        forEachMember(section, [&](JsonSpan id, JsonSpan diff) {
+            int i = indexOf(id.p, id.end - id.p);
+            if (i < 0) {
+                ignored++;
+                return;
+            }
+            HAEntityState& e = entities[i];
+            bool differs = false;
+            JsonSpan part;
+            if (findMember(diff, "+", part)) {
+                differs = applyState(e, part.p, part.end - part.p, false);
+            }
+            JsonSpan removed;
+            if (findMember(diff, "-", part) && findMember(part, "a", removed)) {
+                forEachElement(removed, [&](JsonSpan name) {
+                    for (size_t a = 0; a < attrCount; a++) {
+                        if (stringIs(name, attrNames[a]) && e.attrs[a][0]) {
+                            e.attrs[a][0] = '\0';
+                            differs = true;
+                        }
+                    }
+                });
+            }
+            if (differs) {
+                touch(e);
+            }
+        });
+    }
+
+    if (findMember(event, "r", section)) {
+        forEachElement(section, [&](JsonSpan v) {
+            char id[HA_WS_ENTITY_LEN];
+            size_t n = scalarText(v, id, sizeof(id));
+            int i = indexOf(id, n);
+            if (i >= 0 && entities[i].known) {
+                HAEntityState& e = entities[i];
+                e.known = false;
+                e.state[0] = '\0';
+                memset(e.attrs, 0, sizeof(e.attrs));
+                touch(e);
+            }
+        });
+    }
+    return changed;
+}
+
+const HAEntityState* HAStateCache::find(const char* entityId) const {
+    int i = indexOf(entityId, strlen(entityId));
+    return i >= 0 ? &entities[i] : nullptr;
+}
+
+const char* HAStateCache::getAttribute(const HAEntityState& s, const char* name) const {
+    for (size_t i = 0; i < attrCount; i++) {
+        if (strcmp(attrNames[i], name) == 0) {
+            return s.attrs[i];
+        }
+    }
+    return "";
+}
+
+bool HAStateCache::popChanged(HAEntityState& out) {
+    for (size_t i = 0; i < entityCount; i++) {
+        if (entities[i].changed) {
+            entities[i].changed = false;
+            out = entities[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================
+// Session
+// ============================================
+
+HASession::HASession()
+    : token(""), sender(nullptr), senderCtx(nullptr), state(HA_SESSION_CONNECTING), nextId(1),
+      subscribeId(0), pingId(0), pingSentMs(0), lastRxMs(0), messages(0), pings(0), lastPingRttMs(0) {
+    error[0] = '\0';
+}
+
+void HASession::begin(const char* accessToken, Sender fn, void* ctx) {
+    token = accessToken;
+    sender = fn;
+    senderCtx = ctx;
+}
+
+void HASession::reset(uint32_t now) {
+    state = HA_SESSION_CONNECTING;
+    nextId = 1;
+    subscribeId = 0;
+    pingId = 0;
+    lastRxMs = now;
+    error[0] = '\0';
+}
+
+bool HASession::send(const char* text, size_t len) {
+    return sender && sender(text, len, senderCtx);
+}
+
+void HASession::fail(const char* why, const char* detail, size_t detailLen) {
+    state = HA_SESSION_FAILED;
+    snprintf(error, sizeof(error), "%s%s%.*s", why, detailLen ? ": " : "", (int)detailLen, detail);
+}
+
+bool HASession::subscribe() {
+    std::string msg;
+    subscribeId = nextId++;
+    msg.reserve(64 + cache.getEntityCount() * (HA_WS_ENTITY_LEN + 3));
+    msg += "{\"id\":";
+    msg += std::to_string(subscribeId);
+    msg += ",\"type\":\"subscribe_entities\",\"entity_ids\":[";
+    for (size_t i = 0; i < cache.getEntityCount(); i++) {
+        if (i) msg += ',';
+        msg += '"';
+        msg += cache.getEntityId(i);
+        msg += '"';
+    }
+    msg += "]}";
+    state = HA_SESSION_SUBSCRIBING;
+    return send(msg.data(), msg.size());
+}
+
+bool HASession::onMessage(const char* text, size_t len, uint32_t now) {
+    JsonSpan root = { text, text + len };
+    JsonSpan type, v;
+    messages++;
+    lastRxMs = now;
+
+    if (!findMember(root, "type", type)) {
+        return true;
+    }
+
+    if (stringIs(type, "auth_required")) {
+        char msg[512];
+        int n = snprintf(msg, sizeof(msg), "{\"type\":\"auth\",\"access_token\":\"%s\"}", token);
+        if (n <= 0 || (size_t)n >= sizeof(msg)) {
+            fail("token too long", "", 0);
+            return false;
+        }
+        state = HA_SESSION_AUTHENTICATING;
+        return send(msg, n);
+    }
+
+    if (stringIs(type, "auth_ok")) {
+        return subscribe();
+    }
+
+    if (stringIs(type, "auth_invalid")) {
+        char detail[48] = "";
+        if (findMember(root, "message", v)) scalarText(v, detail, sizeof(detail));
+        fail("auth_invalid", detail, strlen(detail));
+        return false;
+    }
+
+    uint32_t id = findMember(root, "id", v) ? (uint32_t)numberOf(v) : 0;
+
+    if (stringIs(type, "result") && id == subscribeId) {
+        JsonSpan success;
+        if (findMember(root, "success", success) && skipWs(success.p, success.end)[0] == 't') {
+            state = HA_SESSION_LIVE;
+            return true;
+        }
+        char detail[48] = "";
+        JsonSpan err;
+        if (findMember(root, "error", err) && findMember(err, "message", v)) scalarText(v, detail, sizeof(detail));
+        fail("subscribe_entities refused", detail, strlen(detail));
+        return false;
+    }
+
+    if (stringIs(type, "event") && id == subscribeId) {
+        if (findMember(root, "event", v)) {
+            cache.apply(v.p, v.end - v.p, now);
+        }
+        state = HA_SESSION_LIVE;
+        return true;
+    }
+
+    if (stringIs(type, "pong") && id == pingId && pingId) {
+        lastPingRttMs = now - pingSentMs;
+        pingId = 0;
+    }
+    return true;
+}
+
+bool HASession::poll(uint32_t now) {
+    if (state == HA_SESSION_FAILED) {
+        return false;
+    }
+    if (state != HA_SESSION_LIVE) {
+        // Stalled during auth or subscribe
+        return now - lastRxMs < HA_WS_PONG_TIMEOUT_MS;
+    }
+
+    if (pingId) {
+        return now - pingSentMs < HA_WS_PONG_TIMEOUT_MS;
+    }
+    if (now - lastRxMs >= HA_WS_PING_MS) {
+        char msg[48];
+        pingId = nextId++;
+        pingSentMs = now;
+        pings++;
+        int n = snprintf(msg, sizeof(msg), "{\"id\":%lu,\"type\":\"ping\"}", (unsigned long)pingId);
+        return send(msg, n);
+    }
+    return true;
+}
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include <sys/time.h>
+#include <esp_random.h>
+
+HAWebSocketClient haSocket;
+
+static const char* sessionStateName(HASessionState s) {
+    switch (s) {
+        case HA_SESSION_CONNECTING:     return "connecting";
+        case HA_SESSION_AUTHENTICATING: return "authenticating";
+        case HA_SESSION_SUBSCRIBING:    return "subscribing";
+        case HA_SESSION_LIVE:           return "live";
+        default:                        return "failed";
+    }
+}
+
+HAWebSocketClient::HAWebSocketClient()
+    : mutex(nullptr), task(nullptr), stateCallback(nullptr), allowed(true), enabled(false), port(8123),
+      live(false), dropRequested(false), reconnectRequested(false), connects(0), failures(0), disconnects(0),
+      bytesIn(0), handshakeMs(0), delivered(0), deliveryMsMax(0), deliveryMsSum(0), lastChangeAgeMs(0) {
+}
+
+void HAWebSocketClient::begin(JsonDocument& config) {
+    allowed = config["ha_websocket"]["enabled"] | true;
+    mutex = xSemaphoreCreateMutex();
+    decoder.setHandler(onFrame, this);
+    enabled = applyConnection(config["integrations"]["home_assistant"]["url"] | "",
+                              config["integrations"]["home_assistant"]["token"] | "");
+    log_i("HA WebSocket: %s (%s:%u)", enabled ? "enabled" : "disabled", host.c_str(), port);
+}
+
+void HAWebSocketClient::setConnection(const char* haUrl, const char* haToken) {
+    if (mutex == nullptr) {
+        return;
+    }
+    bool usable = applyConnection(haUrl, haToken);
+    // Until the new session is live the REST polls cover the display
+    live = false;
+    reconnectRequested = true;
+    enabled = usable;
+    log_i("HA WebSocket: connection changed, %s (%s:%u)", usable ? "reconnecting" : "disabled", host.c_str(), port);
+}
+
+// Host, port and token from the HA URL; false if the socket cannot use them
+bool HAWebSocketClient::applyConnection(const char* haUrl, const char* haToken) {
+    String url = haUrl;
+    bool usable = allowed;
+    if (url.startsWith("http://")) {
+        url = url.substring(7);
+    } else {
+        // wss:// would need TLS on a long-lived socket; HTTPS setups keep polling
+        if (!url.isEmpty()) log_w("HA WebSocket: only http:// URLs are supported, using REST polling");
+        usable = false;
+    }
+    int slash = url.indexOf('/');
+    if (slash >= 0) url = url.substring(0, slash);
+    int colon = url.indexOf(':');
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    host = colon >= 0 ? url.substring(0, colon) : url;
+    port = colon >= 0 ? url.substring(colon + 1).toInt() : 80;
+    token = haToken;
+    session.begin(token.c_str(), sendText, this);
+    usable = usable && !host.isEmpty() && !token.isEmpty();
+    xSemaphoreGive(mutex);
+    return usable;
+}
+
+void HAWebSocketClient::loop() {
+    if (!enabled) {
+        return;
+    }
+
+    if (task == nullptr && WiFi.isConnected() && session.getCache().getEntityCount() > 0) {
+        if (xTaskCreatePinnedToCore(networkTask, "ha_ws", 8192, this, 1, &task, 0) != pdPASS) {
+            task = nullptr;
+            log_e("HA WebSocket: cannot start network task");
+            enabled = false;
+        }
+    }
+
+    // Hand changed entities to the UI on this (the LVGL) thread
+    HAEntityState s;
+    for (;;) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        bool more = session.getCache().popChanged(s);
+        xSemaphoreGive(mutex);
+        if (!more) {
+            break;
+        }
+
+        uint32_t ms = millis() - s.receivedMs;
+        delivered++;
+        deliveryMsSum += ms;
+        if (ms > deliveryMsMax) deliveryMsMax = ms;
+
+        struct timeval tv;
+        gettimeofday(&tv, nullptr);
+        if (tv.tv_sec > 1000000000 && s.lastChanged > 0) {
+            double age = (tv.tv_sec + tv.tv_usec / 1e6 - s.lastChanged) * 1000.0;
+            lastChangeAgeMs = age > 0 ? (uint32_t)age : 0;
+        }
+
+        if (stateCallback) {
+            stateCallback(s);
+        }
+    }
+}
+
+void HAWebSocketClient::networkTask(void* param) {
+    ((HAWebSocketClient*)param)->run();
+}
+
+void HAWebSocketClient::run() {
+    uint32_t backoffMs = 1000;
+    for (;;) {
+        if (!WiFi.isConnected() || !enabled) {
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            continue;
+        }
+        if (!connect()) {
+            failures++;
+            pause(backoffMs);
+            backoffMs = min(backoffMs * 2, (uint32_t)60000);
+            continue;
+        }
+
+        uint8_t buf[1024];
+        dropRequested = false;
+        while (client.connected() && !dropRequested && !reconnectRequested) {
+            int n = client.available() ? client.read(buf, sizeof(buf)) : 0;
+            if (n > 0) {
+                bytesIn += n;
+                if (!decoder.feed(buf, n)) {
+                    log_w("HA WebSocket: protocol error, reconnecting");
+                    break;
+                }
+            } else {
+                vTaskDelay(pdMS_TO_TICKS(5));
+            }
+            if (!session.poll(millis())) {
+                break;
+            }
+            bool nowLive = session.isLive();
+            if (nowLive && !live) {
+                backoffMs = 1000;
+                log_i("HA WebSocket: live, %u entities subscribed", (unsigned)session.getCache().getEntityCount());
+            }
+            live = nowLive;
+        }
+
+        live = false;
+        client.stop();
+        disconnects++;
+        if (reconnectRequested) {
+            backoffMs = 1000;
+            continue;
+        }
+        if (session.getState() == HA_SESSION_FAILED) {
+            // Bad token or refused subscription: no point hammering HA
+            log_e("HA WebSocket: %s", session.getError());
+            backoffMs = 300000;
+        } else {
+            log_w("HA WebSocket: disconnected");
+        }
+        pause(backoffMs);
+        backoffMs = min(backoffMs * 2, (uint32_t)300000);
+    }
+}
+
+// Backoff that a changed connection cuts short
+void HAWebSocketClient::pause(uint32_t ms) {
+    for (uint32_t waited = 0; waited < ms && !reconnectRequested; waited += 100) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
+
+bool HAWebSocketClient::connect() {
+    unsigned long start = millis();
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    String connectHost = host;
+    uint16_t connectPort = port;
+    if (reconnectRequested) {
+        // States from the previous instance must not outlive the switch
+        session.getCache().reset();
+        reconnectRequested = false;
+    }
+    xSemaphoreGive(mutex);
+    if (!client.connect(connectHost.c_str(), connectPort, 5000)) {
+        return false;
+    }
+    client.setNoDelay(true);
+
+    uint8_t nonce[16];
+    esp_fill_random(nonce, sizeof(nonce));
+    char key[25];
+    wsMakeKey(nonce, key);
+    char request[256];
+    size_t len = wsBuildHandshake(connectHost.c_str(), connectPort, "/api/websocket", key, request, sizeof(request));
+    client.write((const uint8_t*)request, len);
+
+    // Read the response headers byte by byte: HA's auth_required frame can
+    // follow in the same segment and must stay in the socket for the decoder
+    char response[512];
+    size_t n = 0;
+    while (millis() - start < 5000 && client.connected()) {
+        int c = client.read();
+        if (c < 0) {
+            vTaskDelay(pdMS_TO_TICKS(2));
+            continue;
+        }
+        if (n + 1 < sizeof(response)) response[n++] = (char)c;
+        if (n >= 4 && memcmp(response + n - 4, "\r\n\r\n", 4) == 0) break;
+    }
+    response[n] = '\0';
+
+    if (!wsCheckHandshake(response, key)) {
+        log_w("HA WebSocket: upgrade refused");
+        client.stop();
+        return false;
+    }
+
+    decoder.reset();
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    session.reset(millis());
+    xSemaphoreGive(mutex);
+    handshakeMs = millis() - start;
+    connects++;
+    return true;
+}
+
+bool HAWebSocketClient::sendFrame(WsOpcode op, const uint8_t* data, size_t len) {
+    std::vector<uint8_t> frame(len + 14);
+    uint32_t mask = esp_random();
+    size_t n = wsEncodeFrame(op, data, len, (const uint8_t*)&mask, frame.data(), frame.size());
+    return n && client.write(frame.data(), n) == n;
+}
+
+bool HAWebSocketClient::sendText(const char* text, size_t len, void* ctx) {
+    return ((HAWebSocketClient*)ctx)->sendFrame(WS_OP_TEXT, (const uint8_t*)text, len);
+}
+
+void HAWebSocketClient::onFrame(WsOpcode op, const uint8_t* data, size_t len, void* ctx) {
+    HAWebSocketClient* self = (HAWebSocketClient*)ctx;
+    switch (op) {
+        case WS_OP_TEXT: {
+            xSemaphoreTake(self->mutex, portMAX_DELAY);
+            bool ok = self->session.onMessage((const char*)data, len, millis());
+            xSemaphoreGive(self->mutex);
+            if (!ok) self->dropRequested = true;
+            break;
+        }
+        case WS_OP_PING:
+            self->sendFrame(WS_OP_PONG, data, len);
+            break;
+        case WS_OP_CLOSE:
+            self->sendFrame(WS_OP_CLOSE, data, len >= 2 ? 2 : 0);
+            self->dropRequested = true;
+            break;
+        default:
+            break;
+    }
+}
+
+void HAWebSocketClient::getStatusJson(JsonObject obj) {
+    HAStateCache& cache = session.getCache();
+    obj["enabled"] = enabled;
+    obj["live"] = live;
+    obj["state"] = sessionStateName(session.getState());
+    obj["entities"] = cache.getEntityCount();
+    obj["connects"] = connects;
+    obj["failures"] = failures;
+    obj["disconnects"] = disconnects;
+    obj["messages"] = session.getMessages();
+    obj["events"] = cache.getEvents();
+    obj["changes"] = cache.getChanges();
+    obj["ignored"] = cache.getIgnored();
+    obj["bytes_in"] = bytesIn;
+    obj["handshake_ms"] = handshakeMs;
+    obj["pings"] = session.getPings();
+    obj["ping_rtt_ms"] = session.getLastPingRttMs();
+    obj["delivered"] = delivered;
+    obj["delivery_ms_avg"] = delivered ? deliveryMsSum / delivered : 0;
+    obj["delivery_ms_max"] = deliveryMsMax;
+    obj["last_change_age_ms"] = lastChangeAgeMs;
+    if (session.getState() == HA_SESSION_FAILED) {
+        obj["error"] = session.getError();
+    }
+}
+#endif
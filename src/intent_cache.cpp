@@ -0,0 +1,189 @@
+#include "intent_cache.h"
+#include <string.h>
+
+#define INTENT_CACHE_MAGIC      0x31434e49u     // "INC1"
+
+struct IntentCacheHeader {
+    uint32_t magic;
+    uint16_t entryBytes;        // Layout check: key + match + cost
+    uint16_t count;
+    uint32_t commandsFingerprint;
+    uint32_t entitiesFingerprint;
+};
+
+static const size_t ENTRY_BYTES = INTENT_CACHE_KEY_LEN + sizeof(CommandMatch) + sizeof(uint32_t);
+
+static uint32_t hashKey(const char* key) {
+    uint32_t h = 2166136261u;
+    for (const char* p = key; *p; p++) {
+        h = (h ^ (uint8_t)*p) * 16777619u;     // FNV-1a
+    }
+    return h;
+}
+
+IntentCache::IntentCache() : commandsFingerprint(0), entitiesFingerprint(0) {
+    memset(&stats, 0, sizeof(stats));
+    clear();
+    dirty = false;
+}
+
+void IntentCache::clear() {
+    memset(entries, 0, sizeof(entries));
+    head = -1;
+    tail = -1;
+    count = 0;
+    dirty = true;
+}
+
+int IntentCache::find(const char* key, uint32_t hash) const {
+    for (int i = 0; i < INTENT_CACHE_SIZE; i++) {
+        if (entries[i].used && entries[i].hash == hash && strcmp(entries[i].key, key) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void IntentCache::unlink(int i) {
+    Entry& e = entries[i];
+    if (e.prev >= 0) entries[e.prev].next = e.next; else head = e.next;
+    if (e.next >= 0) entries[e.next].prev = e.prev; else tail = e.prev;
+    e.prev = e.next = -1;
+}
+
+void IntentCache::pushFront(int i) {
+    Entry& e = entries[i];
+    e.prev = -1;
+    e.next = head;
+    if (head >= 0) entries[head].prev = (int8_t)i;
+    head = (int8_t)i;
+    if (tail < 0) tail = (int8_t)i;
+}
+
+bool IntentCache::lookup(const char* key, CommandMatch& match, uint32_t* costUs) {
+    int i = find(key, hashKey(key));
+    if (i < 0) {
+        stats.misses++;
+        return false;
+    }
+    if (head != i) {
+        unlink(i);
+        pushFront(i);
+    }
+    match = entries[i].match;
+    if (costUs) *costUs = entries[i].costUs;
+    stats.hits++;
+    return true;
+}
+
+bool IntentCache::insert(const char* key, const CommandMatch& match, uint32_t costUs) {
+    size_t len = strlen(key);
+    if (!isReady() || len == 0 || len >= INTENT_CACHE_KEY_LEN) {
+        return false;
+    }
+
+    uint32_t hash = hashKey(key);
+    int i = find(key, hash);
+    if (i >= 0) {
+        unlink(i);
+    } else if (count < INTENT_CACHE_SIZE) {
+        for (i = 0; entries[i].used; i++) {}
+        count++;
+    } else {
+        i = tail;
+        unlink(i);
+        stats.evictions++;
+    }
+
+    Entry& e = entries[i];
+    memcpy(e.key, key, len + 1);
+    e.match = match;
+    e.hash = hash;
+    e.costUs = costUs;
+    e.used = true;
+    pushFront(i);
+    stats.inserts++;
+    dirty = true;
+    return true;
+}
+
+bool IntentCache::validate(uint32_t commandsFp, uint32_t entitiesFp) {
+    bool changed = (commandsFp && commandsFingerprint && commandsFp != commandsFingerprint) ||
+                   (entitiesFp && entitiesFingerprint && entitiesFp != entitiesFingerprint);
+    if (changed && count) {
+        clear();
+        stats.invalidations++;
+    }
+    if (commandsFp && commandsFp != commandsFingerprint) {
+        commandsFingerprint = commandsFp;
+        dirty = true;
+    }
+    if (entitiesFp && entitiesFp != entitiesFingerprint) {
+        entitiesFingerprint = entitiesFp;
+        dirty = true;
+    }
+    return changed;
+}
+
+size_t IntentCache::serializedSize() const {
+    return sizeof(IntentCacheHeader) + count * ENTRY_BYTES;
+}
+
+size_t IntentCache::serialize(uint8_t* out, size_t size) {
+    size_t need = serializedSize();
+    if (size < need) {
+        return 0;
+    }
+
+    IntentCacheHeader h;
+    h.magic = INTENT_CACHE_MAGIC;
+    h.entryBytes = (uint16_t)ENTRY_BYTES;
+    h.count = (uint16_t)count;
+    h.commandsFingerprint = commandsFingerprint;
+    h.entitiesFingerprint = entitiesFingerprint;
+    memcpy(out, &h, sizeof(h));
+
+    uint8_t* p = out + sizeof(h);
+    for (int i = tail; i >= 0; i = entries[i].prev) {
+        const Entry& e = entries[i];
+        memcpy(p, e.key, INTENT_CACHE_KEY_LEN);
+        memcpy(p + INTENT_CACHE_KEY_LEN, &e.match, sizeof(CommandMatch));
+        memcpy(p + INTENT_CACHE_KEY_LEN + sizeof(CommandMatch), &e.costUs, sizeof(uint32_t));
+        p += ENTRY_BYTES;
+    }
+    dirty = false;
+    return need;
+}
+
+bool IntentCache::load(const uint8_t* data, size_t size) {
+    IntentCacheHeader h;
+    if (size < sizeof(h)) {
+        return false;
+    }
+    memcpy(&h, data, sizeof(h));
+    if (h.magic != INTENT_CACHE_MAGIC || h.entryBytes != ENTRY_BYTES || h.count > INTENT_CACHE_SIZE ||
+        size != sizeof(h) + h.count * ENTRY_BYTES) {
+        return false;
+    }
+
+    clear();
+    commandsFingerprint = h.commandsFingerprint;
+    entitiesFingerprint = h.entitiesFingerprint;
+
+    const uint8_t* p = data + sizeof(h);
+    for (int n = 0; n < h.count; n++, p += ENTRY_BYTES) {
+        Entry& e = entries[count];
+        memcpy(e.key, p, INTENT_CACHE_KEY_LEN);
+        if (e.key[INTENT_CACHE_KEY_LEN - 1] != '\0' || e.key[0] == '\0') {
+            continue;
+        }
+        memcpy(&e.match, p + INTENT_CACHE_KEY_LEN, sizeof(CommandMatch));
+        memcpy(&e.costUs, p + INTENT_CACHE_KEY_LEN + sizeof(CommandMatch), sizeof(uint32_t));
+        e.hash = hashKey(e.key);
+        e.used = true;
+        pushFront((int)count);
+        count++;
+    }
+    dirty = false;
+    return true;
+}
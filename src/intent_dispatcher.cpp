@@ -0,0 +1,322 @@
+#include "intent_dispatcher.h"
+#include <WiFi.h>
+#include <LittleFS.h>
+#include <vector>
+#include "entity_index.h"
+
+IntentDispatcher intentDispatcher;
+
+static const char* pathName(IntentPath path) {
+    switch (path) {
+        case INTENT_PATH_LOCAL: return "local";
+        case INTENT_PATH_HA:    return "ha";
+        default:                return "none";
+    }
+}
+
+IntentDispatcher::IntentDispatcher()
+    : remote(true), localConfident(INTENT_DEFAULT_CONFIDENT), localFallback(COMMAND_MIN_CONFIDENCE),
+      timeoutMs(INTENT_DEFAULT_TIMEOUT_MS), resultCallback(nullptr), cacheEnabled(true), lastCacheSave(0),
+      started(0), startedUs(0), fromCache(false), waiting(false),
+      localFound(false), task(nullptr), cancelRequested(false), haSent(false), haDone(false), haLatencyMs(0),
+      dispatched(0), unrecognized(0), haRequests(0), haWithdrawn(0), haDiscarded(0), haBusy(0),
+      haErrors(0), haNoMatch(0), haTimeouts(0), haNoAnswer(0), localFallbacks(0) {
+    text[0] = '\0';
+    key[0] = '\0';
+    memset(&localMatch, 0, sizeof(localMatch));
+    memset(&localStats, 0, sizeof(localStats));
+    memset(&haStats, 0, sizeof(haStats));
+}
+
+void IntentDispatcher::begin(JsonDocument& config) {
+    JsonObject cfg = config["intents"];
+    remote = cfg["remote"] | true;
+    localConfident = constrain(cfg["local_confident"] | INTENT_DEFAULT_CONFIDENT, 0.3f, 1.0f);
+    localFallback = constrain(cfg["local_fallback"] | COMMAND_MIN_CONFIDENCE, 0.3f, localConfident);
+    timeoutMs = constrain(cfg["timeout_ms"] | INTENT_DEFAULT_TIMEOUT_MS, 500, 15000);
+    cacheEnabled = cfg["cache"] | true;
+    log_i("Intents: HA conversation %s, local wins at %.2f, fallback at %.2f, timeout %lu ms",
+          remote ? "enabled" : "disabled", localConfident, localFallback, (unsigned long)timeoutMs);
+
+    if (cacheEnabled) {
+        loadCache();
+    }
+    lastCacheSave = millis();
+}
+
+void IntentDispatcher::dispatch(const char* input) {
+    if (haDone) {
+        haDone = false;
+        collectHaReply();
+    }
+    if (waiting) {
+        // A new utterance supersedes the one still waiting for HA
+        cancelRequested = true;
+        waiting = false;
+    }
+
+    strlcpy(text, input, sizeof(text));
+    started = millis();
+    startedUs = micros();
+    dispatched++;
+    fromCache = false;
+
+    if (cacheEnabled) {
+        validateCache();
+        CommandMatcher::normalize(text, key, sizeof(key));
+        uint32_t costUs = 0;
+        if (cache.lookup(key, localMatch, &costUs)) {
+            uint32_t hitUs = micros() - startedUs;
+            cache.addSaved(costUs > hitUs ? costUs - hitUs : 0);
+            localFound = true;
+            fromCache = true;
+            decide(INTENT_PATH_LOCAL);
+            return;
+        }
+    }
+
+    // Start HA first so its connection setup overlaps the local match
+    bool raced = false;
+    if (remote && WiFi.isConnected()) {
+        if (task != nullptr) {
+            haBusy++;
+        } else {
+            haAssist.prepareConversation(text, haRequest);
+            cancelRequested = false;
+            haSent = false;
+            haDone = false;
+            if (xTaskCreatePinnedToCore(conversationTask, "intent_ha", 8192, this, 1, &task, 0) == pdPASS) {
+                haRequests++;
+                raced = true;
+            } else {
+                task = nullptr;
+                log_e("Intents: cannot start conversation task");
+            }
+        }
+    }
+
+    unsigned long matchStart = micros();
+    localFound = commandEngine.match(text, localMatch);
+    addLatency(localStats, micros() - matchStart);
+
+    if (localFound && localMatch.confidence >= localConfident) {
+        cancelRequested = true;
+        decide(INTENT_PATH_LOCAL);
+        return;
+    }
+
+    if (!raced) {
+        decide(localFound && localMatch.confidence >= localFallback ? INTENT_PATH_LOCAL : INTENT_PATH_NONE);
+        return;
+    }
+
+    waiting = true;
+}
+
+void IntentDispatcher::loop() {
+    if (haDone) {
+        haDone = false;
+        collectHaReply();
+    }
+
+    if (cacheEnabled) {
+        validateCache();
+        if (cache.isDirty() && millis() - lastCacheSave >= INTENT_CACHE_SAVE_MS) {
+            saveCache();
+        }
+    }
+
+    if (waiting && millis() - started >= timeoutMs) {
+        // A reply that still arrives is discarded
+        log_w("Intents: HA conversation timed out after %lu ms", (unsigned long)timeoutMs);
+        haTimeouts++;
+        cancelRequested = true;
+        waiting = false;
+        bool fallback = localFound && localMatch.confidence >= localFallback;
+        // Once sent it cannot be withdrawn and HA may still carry it out:
+        // running the local action as well could open the gate twice
+        if (haSent && !(fallback && commandEngine.isQuery(localMatch))) {
+            if (fallback) {
+                log_w("Intents: HA may still act on '%s', not running it locally", text);
+            }
+            haNoAnswer++;
+            decide(INTENT_PATH_NONE, true);
+            return;
+        }
+        decide(fallback ? INTENT_PATH_LOCAL : INTENT_PATH_NONE);
+    }
+}
+
+void IntentDispatcher::conversationTask(void* param) {
+    IntentDispatcher* self = (IntentDispatcher*)param;
+    unsigned long start = millis();
+    HAAssistClient::converse(self->haRequest, self->haReply, &self->cancelRequested, &self->haSent);
+    self->haLatencyMs = millis() - start;
+    self->haDone = true;
+    self->task = nullptr;
+    vTaskDelete(NULL);
+}
+
+void IntentDispatcher::collectHaReply() {
+    const ConversationReply& r = haReply;
+    if (!r.sent) {
+        haWithdrawn++;
+        return;
+    }
+    addLatency(haStats, haLatencyMs);
+
+    if (!waiting) {
+        // Lost the race (or timed out) after the request went out
+        haDiscarded++;
+        log_w("Intents: HA answered '%s' after the decision, discarded", r.responseType.c_str());
+        return;
+    }
+    waiting = false;
+
+    bool handled = r.responseType == "action_done" || r.responseType == "query_answer";
+    if (handled) {
+        decide(INTENT_PATH_HA);
+        return;
+    }
+
+    if (r.httpCode != HTTP_CODE_OK || r.responseType.isEmpty()) {
+        haErrors++;
+        log_w("Intents: HA conversation failed: %s", r.error.c_str());
+    } else {
+        haNoMatch++;
+        log_i("Intents: HA could not handle it (%s)", r.errorCode.c_str());
+    }
+    bool fallback = localFound && localMatch.confidence >= localFallback;
+    if (fallback) {
+        localFallbacks++;
+    }
+    decide(fallback ? INTENT_PATH_LOCAL : INTENT_PATH_NONE);
+}
+
+void IntentDispatcher::decide(IntentPath path, bool noAnswer) {
+    IntentResult result;
+    result.path = path;
+    result.success = false;
+    result.duplicate = false;
+    result.cached = fromCache;
+    result.noAnswer = path == INTENT_PATH_NONE && noAnswer;
+    result.actionId = 0;
+    result.commandId = 0;
+    result.confidence = 0;
+    result.latencyMs = millis() - started;
+    result.text = text;
+
+    if (path == INTENT_PATH_LOCAL) {
+        CommandResult r = commandEngine.execute(text, localMatch);
+        result.success = r.success;
+        result.duplicate = r.duplicate;
+        result.actionId = r.actionId;
+        result.commandId = r.id;
+        result.confidence = r.confidence;
+        result.reply = r.reply;
+        localStats.wins++;
+
+        // Remember what this resolution cost, including any wait for HA
+        if (cacheEnabled && !fromCache && r.matched) {
+            cache.insert(key, localMatch, micros() - startedUs);
+        }
+    } else if (path == INTENT_PATH_HA) {
+        result.success = true;
+        result.confidence = 1.0f;
+        result.reply = haReply.speech;
+        haStats.wins++;
+    } else {
+        unrecognized++;
+    }
+
+    log_i("Intents: '%s' -> %s%s after %lu ms", text, pathName(path), fromCache ? " (cached)" : "",
+          (unsigned long)result.latencyMs);
+    if (resultCallback) {
+        resultCallback(result);
+    }
+}
+
+void IntentDispatcher::validateCache() {
+    if (cache.validate(commandEngine.getFingerprint(), haEntities.getFingerprint())) {
+        log_i("Intents: commands or entities changed, cache cleared");
+    }
+}
+
+void IntentDispatcher::loadCache() {
+    File file = LittleFS.open(INTENT_CACHE_FILE, "r");
+    if (!file) {
+        return;
+    }
+    std::vector<uint8_t> data(file.size());
+    bool ok = file.read(data.data(), data.size()) == data.size() && cache.load(data.data(), data.size());
+    file.close();
+    if (ok) {
+        log_i("Intents: %u cached intents restored", (unsigned)cache.size());
+    } else {
+        log_w("Intents: cache file unreadable, starting empty");
+        LittleFS.remove(INTENT_CACHE_FILE);
+    }
+}
+
+void IntentDispatcher::saveCache() {
+    lastCacheSave = millis();
+    std::vector<uint8_t> data(cache.serializedSize());
+    size_t len = cache.serialize(data.data(), data.size());
+
+    File file = LittleFS.open(INTENT_CACHE_FILE, "w");
+    if (!file || file.write(data.data(), len) != len) {
+        log_e("Intents: cannot write %s", INTENT_CACHE_FILE);
+    }
+    if (file) {
+        file.close();
+    }
+}
+
+void IntentDispatcher::addLatency(PathStats& s, uint32_t value) {
+    s.latencySum += value;
+    s.latencyCount++;
+    if (value > s.latencyMax) s.latencyMax = value;
+}
+
+void IntentDispatcher::getStatusJson(JsonObject obj) {
+    obj["remote"] = remote;
+    obj["local_confident"] = localConfident;
+    obj["local_fallback"] = localFallback;
+    obj["dispatched"] = dispatched;
+    obj["unrecognized"] = unrecognized;
+    obj["pending"] = waiting;
+
+    JsonObject local = obj["local"].to<JsonObject>();
+    local["wins"] = localStats.wins;
+    local["win_rate"] = dispatched ? (float)localStats.wins / dispatched : 0.0f;
+    local["fallbacks"] = localFallbacks;
+    local["match_us_avg"] = localStats.latencyCount ? localStats.latencySum / localStats.latencyCount : 0;
+    local["match_us_max"] = localStats.latencyMax;
+
+    JsonObject ha = obj["ha"].to<JsonObject>();
+    ha["requests"] = haRequests;
+    ha["wins"] = haStats.wins;
+    ha["win_rate"] = dispatched ? (float)haStats.wins / dispatched : 0.0f;
+    ha["withdrawn"] = haWithdrawn;
+    ha["discarded"] = haDiscarded;
+    ha["busy"] = haBusy;
+    ha["no_match"] = haNoMatch;
+    ha["errors"] = haErrors;
+    ha["timeouts"] = haTimeouts;
+    ha["no_answer"] = haNoAnswer;
+    ha["latency_ms_avg"] = haStats.latencyCount ? haStats.latencySum / haStats.latencyCount : 0;
+    ha["latency_ms_max"] = haStats.latencyMax;
+
+    const IntentCacheStats& cs = cache.getStats();
+    uint32_t lookups = cs.hits + cs.misses;
+    JsonObject c = obj["cache"].to<JsonObject>();
+    c["enabled"] = cacheEnabled;
+    c["entries"] = cache.size();
+    c["capacity"] = INTENT_CACHE_SIZE;
+    c["hits"] = cs.hits;
+    c["misses"] = cs.misses;
+    c["hit_rate"] = lookups ? (float)cs.hits / lookups : 0.0f;
+    c["evictions"] = cs.evictions;
+    c["invalidations"] = cs.invalidations;
+    c["saved_ms"] = (uint32_t)(cs.savedUs / 1000);
+}
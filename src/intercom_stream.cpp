@@ -0,0 +1,470 @@
+#include "intercom_stream.h"
+#include <string.h>
+
+// Live intercom stream - portable codec helpers
+
+uint8_t g711MulawEncode(int16_t sample) {
+    const int32_t BIAS = 0x84;
+    const int32_t CLIP = 32635;
+
+    int32_t s = sample;
+    uint8_t sign = 0;
+    if (s < 0) {
+        s = -s;
+        sign = 0x80;
+    }
+    if (s > CLIP) s = CLIP;
+    s += BIAS;
+
+    uint8_t exponent = 7;
+    for (int32_t mask = 0x4000; (s & mask) == 0 && exponent > 0; mask >>= 1) {
+        exponent--;
+    }
+    uint8_t mantissa = (s >> (exponent + 3)) & 0x0F;
+    return ~(sign | (exponent << 4) | mantissa);
+}
+
+// Kaiser-windowed (beta 4) half-band low-pass: -0.2 dB at 3.4 kHz,
+// -32 dB from 4.6 kHz. Odd taps around the centre are zero, so only the
+// centre and the 8 symmetric pairs below are applied.
+static const int16_t HALFBAND_CENTER = 16397;
+static const int16_t HALFBAND_PAIRS[8] = { 10359, -3245, 1715, -1005, 590, -328, 161, -62 };
+
+HalfbandDecimator::HalfbandDecimator() {
+    reset();
+}
+
+void HalfbandDecimator::reset() {
+    memset(history, 0, sizeof(history));
+}
+
+size_t HalfbandDecimator::process(const int16_t* in, size_t count, int16_t* out) {
+    // History followed by the new block, in chunks of one pipeline frame
+    int16_t buf[TAPS - 1 + AUDIO_FRAME_SAMPLES];
+    size_t written = 0;
+
+    while (count >= 2) {
+        size_t chunk = count > AUDIO_FRAME_SAMPLES ? AUDIO_FRAME_SAMPLES : count & ~(size_t)1;
+        memcpy(buf, history, sizeof(history));
+        memcpy(buf + TAPS - 1, in, chunk * sizeof(int16_t));
+
+        for (size_t m = 0; m < chunk / 2; m++) {
+            const int16_t* c = buf + 2 * m + (TAPS - 1) / 2;
+            int32_t acc = (int32_t)HALFBAND_CENTER * c[0];
+            for (int j = 0; j < 8; j++) {
+                int d = 2 * j + 1;
+                acc += (int32_t)HALFBAND_PAIRS[j] * (c[-d] + c[d]);
+            }
+            acc = (acc + (1 << 14)) >> 15;
+            if (acc > 32767) acc = 32767;
+            if (acc < -32768) acc = -32768;
+            out[written++] = (int16_t)acc;
+        }
+
+        memcpy(history, buf + chunk, sizeof(history));
+        in += chunk;
+        count -= chunk;
+    }
+    return written;
+}
+
+void rtpWriteHeader(uint8_t* buf, uint8_t payloadType, bool marker, uint16_t seq, uint32_t timestamp, uint32_t ssrc) {
+    buf[0] = 0x80;                                  // V=2, no padding/extension/CSRC
+    buf[1] = (marker ? 0x80 : 0) | (payloadType & 0x7F);
+    buf[2] = seq >> 8;
+    buf[3] = seq & 0xFF;
+    buf[4] = timestamp >> 24;
+    buf[5] = (timestamp >> 16) & 0xFF;
+    buf[6] = (timestamp >> 8) & 0xFF;
+    buf[7] = timestamp & 0xFF;
+    buf[8] = ssrc >> 24;
+    buf[9] = (ssrc >> 16) & 0xFF;
+    buf[10] = (ssrc >> 8) & 0xFF;
+    buf[11] = ssrc & 0xFF;
+}
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include <WiFi.h>
+#include <sys/time.h>
+#include <lwip/sockets.h>
+#include "audio_stages.h"
+
+IntercomStream intercom;
+
+static inline void put32(uint8_t* p, uint32_t v) {
+    p[0] = v >> 24; p[1] = (v >> 16) & 0xFF; p[2] = (v >> 8) & 0xFF; p[3] = v & 0xFF;
+}
+
+static inline uint32_t get32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// NTP timestamp (RFC 3550 sender reports) from the system clock
+static void ntpNow(uint32_t* msw, uint32_t* lsw) {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    *msw = (uint32_t)tv.tv_sec + 2208988800UL;
+    *lsw = (uint32_t)((uint64_t)tv.tv_usec * 4294967296ULL / 1000000ULL);
+}
+
+IntercomStream::IntercomStream()
+    : defaultPort(INTERCOM_DEFAULT_PORT),
+      running(false),
+      startRequested(false),
+      requestedPort(0),
+      port(0),
+      rtpSocket(-1),
+      rtcpSocket(-1),
+      destAddr(0),
+      task(nullptr),
+      startedAt(0),
+      writeIndex(0),
+      readIndex(0),
+      seq(0),
+      ssrc(0),
+      timestampBase(0),
+      lastSrNtpMid(0),
+      lastSrSentMs(0) {
+    defaultHost[0] = '\0';
+    requestedHost[0] = '\0';
+    host[0] = '\0';
+    memset(&stats, 0, sizeof(stats));
+}
+
+void IntercomStream::begin(JsonDocument& config) {
+    JsonObject cfg = config["intercom"];
+    strlcpy(defaultHost, cfg["host"] | "", sizeof(defaultHost));
+    defaultPort = cfg["port"] | INTERCOM_DEFAULT_PORT;
+
+    if (cfg["auto_start"] | false) {
+        start("", 0);
+    }
+}
+
+bool IntercomStream::start(const char* destHost, uint16_t destPort) {
+    const char* target = (destHost && destHost[0]) ? destHost : defaultHost;
+    if (!target[0] || WiFi.status() != WL_CONNECTED) {
+        return false;
+    }
+
+    stop();
+    strlcpy(requestedHost, target, sizeof(requestedHost));
+    requestedPort = destPort ? destPort : defaultPort;
+    startRequested = true;
+    return true;
+}
+
+void IntercomStream::loop() {
+    // The previous sender task closes its sockets on the way out
+    if (!startRequested || task != nullptr) {
+        return;
+    }
+    startRequested = false;
+    launch();
+}
+
+void IntercomStream::launch() {
+    strlcpy(host, requestedHost, sizeof(host));
+    port = requestedPort;
+
+    ssrc = esp_random();
+    seq = esp_random() & 0xFFFF;
+    timestampBase = esp_random();
+    lastSrNtpMid = 0;
+    lastSrSentMs = 0;
+    memset(&stats, 0, sizeof(stats));
+    decimator.reset();
+    writeIndex.store(0);
+    readIndex.store(0);
+    startedAt = millis();
+
+    // Host name resolution and socket setup happen on the sender task
+    running = true;
+    if (xTaskCreatePinnedToCore(senderTask, "intercom", 4096, this, 3, &task, 0) != pdPASS) {
+        running = false;
+        task = nullptr;
+        log_w("Intercom: cannot start sender task");
+        return;
+    }
+    StreamerStage::setSink(sinkCallback);
+
+    log_i("Intercom: streaming PCMU/8000 to %s:%u", host, port);
+}
+
+void IntercomStream::stop() {
+    startRequested = false;
+    if (!running) {
+        return;
+    }
+    StreamerStage::setSink(nullptr);
+    running = false;
+    log_i("Intercom: stopped after %u packets", stats.packetsSent);
+}
+
+// ============================================
+// Capture side (pipeline "streamer" stage, main loop)
+// ============================================
+
+void IntercomStream::sinkCallback(const AudioFrame& frame) {
+    intercom.pushFrame(frame);
+}
+
+void IntercomStream::pushFrame(const AudioFrame& frame) {
+    if (!running) {
+        return;
+    }
+
+    uint32_t start = micros();
+
+    int16_t narrow[AUDIO_FRAME_SAMPLES / 2];
+    size_t n = decimator.process(frame.samples, frame.count, narrow);
+
+    uint32_t head = writeIndex.load(std::memory_order_relaxed);
+    uint32_t tail = readIndex.load(std::memory_order_acquire);
+    if (head - tail + n > INTERCOM_RING_SAMPLES) {
+        stats.overflowSamples += n;
+        return;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        ring[(head + i) & (INTERCOM_RING_SAMPLES - 1)] = g711MulawEncode(narrow[i]);
+    }
+    writeIndex.store(head + n, std::memory_order_release);
+
+    uint32_t elapsed = micros() - start;
+    if (elapsed > stats.sinkUsMax) stats.sinkUsMax = elapsed;
+}
+
+// ============================================
+// Pacing / sender task (core 0)
+// ============================================
+
+bool IntercomStream::openSockets() {
+    IPAddress ip;
+    if (!ip.fromString(host) && !WiFi.hostByName(host, ip)) {
+        log_e("Intercom: cannot resolve %s", host);
+        return false;
+    }
+    destAddr = (uint32_t)ip;
+
+    rtpSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    rtcpSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (rtpSocket < 0 || rtcpSocket < 0) {
+        closeSockets();
+        return false;
+    }
+
+    // Local RTP/RTCP ports mirror the destination pair so receiver reports
+    // can be sent back to <source port> + 1
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(INTERCOM_DEFAULT_PORT);
+    bind(rtpSocket, (struct sockaddr*)&local, sizeof(local));
+    local.sin_port = htons(INTERCOM_DEFAULT_PORT + 1);
+    bind(rtcpSocket, (struct sockaddr*)&local, sizeof(local));
+
+    // Never let a full WiFi queue stall the pacing clock
+    fcntl(rtpSocket, F_SETFL, O_NONBLOCK);
+    fcntl(rtcpSocket, F_SETFL, O_NONBLOCK);
+    return true;
+}
+
+void IntercomStream::closeSockets() {
+    if (rtpSocket >= 0) close(rtpSocket);
+    if (rtcpSocket >= 0) close(rtcpSocket);
+    rtpSocket = -1;
+    rtcpSocket = -1;
+}
+
+void IntercomStream::senderTask(void* param) {
+    IntercomStream* self = (IntercomStream*)param;
+
+    if (!self->openSockets()) {
+        StreamerStage::setSink(nullptr);
+        self->running = false;
+    }
+
+    TickType_t wake = xTaskGetTickCount();
+    uint32_t lastSendUs = 0;
+    const uint32_t P = INTERCOM_PACKET_SAMPLES;
+
+    while (self->running) {
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(INTERCOM_PACKET_MS));
+
+        uint32_t head = self->writeIndex.load(std::memory_order_acquire);
+        uint32_t tail = self->readIndex.load(std::memory_order_relaxed);
+
+        // Bound latency: if capture ran ahead (drift, stalls), skip whole
+        // packets; timestamps keep advancing so the receiver sees the gap
+        while (head - tail > INTERCOM_MAX_QUEUE) {
+            tail += P;
+            self->stats.skippedPackets++;
+        }
+
+        if (head - tail < P) {
+            self->stats.underruns++;
+            self->readIndex.store(tail, std::memory_order_release);
+            continue;
+        }
+
+        self->sendPacket(tail);
+        tail += P;
+        self->readIndex.store(tail, std::memory_order_release);
+
+        // Send interval regularity (RFC 3550 style running mean deviation)
+        uint32_t now = micros();
+        if (lastSendUs != 0) {
+            uint32_t interval = now - lastSendUs;
+            if (interval > self->stats.intervalUsMax) self->stats.intervalUsMax = interval;
+            int32_t dev = (int32_t)interval - INTERCOM_PACKET_MS * 1000;
+            if (dev < 0) dev = -dev;
+            self->stats.jitterUs += ((int32_t)dev - (int32_t)self->stats.jitterUs) / 16;
+        }
+        lastSendUs = now;
+
+        if (millis() - self->lastSrSentMs >= INTERCOM_RTCP_INTERVAL_MS) {
+            self->sendSenderReport(head);
+        }
+        self->pollReceiverReports();
+    }
+
+    self->closeSockets();
+    self->task = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void IntercomStream::sendPacket(uint32_t tail) {
+    uint8_t packet[RTP_HEADER_SIZE + INTERCOM_PACKET_SAMPLES];
+    rtpWriteHeader(packet, INTERCOM_PAYLOAD_PCMU, stats.packetsSent == 0, seq++, timestampBase + tail, ssrc);
+
+    for (uint32_t i = 0; i < INTERCOM_PACKET_SAMPLES; i++) {
+        packet[RTP_HEADER_SIZE + i] = ring[(tail + i) & (INTERCOM_RING_SAMPLES - 1)];
+    }
+
+    struct sockaddr_in dest;
+    memset(&dest, 0, sizeof(dest));
+    dest.sin_family = AF_INET;
+    dest.sin_addr.s_addr = destAddr;
+    dest.sin_port = htons(port);
+
+    if (sendto(rtpSocket, packet, sizeof(packet), 0, (struct sockaddr*)&dest, sizeof(dest)) == (int)sizeof(packet)) {
+        stats.packetsSent++;
+        stats.bytesSent += INTERCOM_PACKET_SAMPLES;
+    } else {
+        stats.sendErrors++;
+    }
+}
+
+void IntercomStream::sendSenderReport(uint32_t head) {
+    uint8_t sr[28];
+    uint32_t msw, lsw;
+    ntpNow(&msw, &lsw);
+
+    sr[0] = 0x80;           // V=2, RC=0
+    sr[1] = 200;            // SR
+    sr[2] = 0;
+    sr[3] = 6;              // Length in 32-bit words minus one
+    put32(sr + 4, ssrc);
+    put32(sr + 8, msw);
+    put32(sr + 12, lsw);
+    put32(sr + 16, timestampBase + head);   // Newest captured sample ~ now
+    put32(sr + 20, stats.packetsSent);
+    put32(sr + 24, stats.bytesSent);
+
+    struct sockaddr_in dest;
+    memset(&dest, 0, sizeof(dest));
+    dest.sin_family = AF_INET;
+    dest.sin_addr.s_addr = destAddr;
+    dest.sin_port = htons(port + 1);
+    sendto(rtcpSocket, sr, sizeof(sr), 0, (struct sockaddr*)&dest, sizeof(dest));
+
+    lastSrNtpMid = (msw << 16) | (lsw >> 16);
+    lastSrSentMs = millis();
+}
+
+void IntercomStream::pollReceiverReports() {
+    uint8_t buf[256];
+    int len;
+
+    while ((len = recv(rtcpSocket, buf, sizeof(buf), 0)) > 0) {
+        // Walk the compound packet for RR/SR report blocks about our SSRC
+        int offset = 0;
+        while (offset + 8 <= len) {
+            const uint8_t* p = buf + offset;
+            uint8_t count = p[0] & 0x1F;
+            uint8_t type = p[1];
+            int size = (((p[2] << 8) | p[3]) + 1) * 4;
+            if ((p[0] >> 6) != 2 || offset + size > len) {
+                break;
+            }
+
+            int blockStart = type == 201 ? 8 : (type == 200 ? 28 : size);
+            for (int i = 0; i < count && blockStart + 24 * (i + 1) <= size; i++) {
+                const uint8_t* b = p + blockStart + 24 * i;
+                if (get32(b) != ssrc) {
+                    continue;
+                }
+
+                stats.rtcpReports++;
+                stats.remoteFractionLost = b[4] / 256.0f;
+                int32_t lost = ((int32_t)b[5] << 16) | (b[6] << 8) | b[7];
+                if (lost & 0x800000) lost |= 0xFF000000;    // 24-bit signed
+                stats.remoteCumulativeLost = lost;
+                stats.remoteJitterMs = get32(b + 12) * 1000 / INTERCOM_SAMPLE_RATE;
+
+                // RTT = now - LSR - DLSR, all in 1/65536 s
+                uint32_t lsr = get32(b + 16);
+                uint32_t dlsr = get32(b + 20);
+                if (lsr != 0) {
+                    uint32_t msw, lsw;
+                    ntpNow(&msw, &lsw);
+                    uint32_t nowMid = (msw << 16) | (lsw >> 16);
+                    stats.rttMs = (uint32_t)((uint64_t)(nowMid - lsr - dlsr) * 1000 / 65536);
+                }
+            }
+            offset += size;
+        }
+    }
+}
+
+void IntercomStream::getStatusJson(JsonObject obj) {
+    obj["running"] = running;
+    obj["starting"] = startRequested;
+    obj["codec"] = "PCMU/8000";
+    obj["packet_ms"] = INTERCOM_PACKET_MS;
+    obj["default_host"] = defaultHost;
+    obj["default_port"] = defaultPort;
+    if (!running && stats.packetsSent == 0) {
+        return;
+    }
+
+    obj["host"] = host;
+    obj["port"] = port;
+    obj["ssrc"] = ssrc;
+    obj["uptime_s"] = running ? (millis() - startedAt) / 1000 : 0;
+    obj["queue_ms"] = (writeIndex.load() - readIndex.load()) * 1000 / INTERCOM_SAMPLE_RATE;
+    obj["packets_sent"] = stats.packetsSent;
+    obj["bytes_sent"] = stats.bytesSent;
+    obj["send_errors"] = stats.sendErrors;
+    obj["underruns"] = stats.underruns;
+    obj["skipped_packets"] = stats.skippedPackets;
+    obj["overflow_samples"] = stats.overflowSamples;
+    obj["sink_us_max"] = stats.sinkUsMax;
+    obj["interval_us_max"] = stats.intervalUsMax;
+    obj["send_jitter_us"] = stats.jitterUs;
+
+    JsonObject remote = obj["receiver"].to<JsonObject>();
+    remote["reports"] = stats.rtcpReports;
+    if (stats.rtcpReports > 0) {
+        remote["fraction_lost"] = roundf(stats.remoteFractionLost * 1000) / 1000;
+        remote["cumulative_lost"] = stats.remoteCumulativeLost;
+        remote["jitter_ms"] = stats.remoteJitterMs;
+        remote["rtt_ms"] = stats.rttMs;
+    }
+}
+#endif
@@ -0,0 +1,323 @@
+#include "job_scheduler.h"
+#include <string.h>
+
+JobScheduler::JobScheduler() : count(0), rng(0x9E3779B9u) {
+    memset(jobs, 0, sizeof(jobs));
+    memset(heapSize, 0, sizeof(heapSize));
+}
+
+uint32_t JobScheduler::jitter(uint32_t maxMs) {
+    if (maxMs == 0) {
+        return 0;
+    }
+    rng ^= rng << 13;           // xorshift32
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng % (maxMs + 1);
+}
+
+int JobScheduler::add(const JobSpec& spec, uint32_t now, uint32_t firstDelayMs) {
+    if (count >= JOB_MAX || !spec.run || spec.cls >= JOB_CLASSES) {
+        return -1;
+    }
+    int id = count++;
+    Job& j = jobs[id];
+    j.spec = spec;
+    j.base = now + firstDelayMs;
+    j.due = j.base + jitter(spec.jitterMs);
+    push(id);
+    return id;
+}
+
+// Wrap-safe: due times are millis() values
+bool JobScheduler::before(int a, int b) const {
+    return (int32_t)(jobs[a].due - jobs[b].due) < 0;
+}
+
+void JobScheduler::push(int id) {
+    JobClass cls = jobs[id].spec.cls;
+    uint8_t* h = heap[cls];
+    int i = heapSize[cls]++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!before(id, h[parent])) {
+            break;
+        }
+        h[i] = h[parent];
+        i = parent;
+    }
+    h[i] = (uint8_t)id;
+    jobs[id].queued = true;
+}
+
+int JobScheduler::pop(JobClass cls) {
+    uint8_t* h = heap[cls];
+    int top = h[0];
+    int last = h[--heapSize[cls]];
+    int n = heapSize[cls];
+    int i = 0;
+    while (true) {
+        int child = 2 * i + 1;
+        if (child >= n) {
+            break;
+        }
+        if (child + 1 < n && before(h[child + 1], h[child])) {
+            child++;
+        }
+        if (!before(h[child], last)) {
+            break;
+        }
+        h[i] = h[child];
+        i = child;
+    }
+    if (n > 0) {
+        h[i] = (uint8_t)last;
+    }
+    jobs[top].queued = false;
+    return top;
+}
+
+void JobScheduler::remove(int id) {
+    JobClass cls = jobs[id].spec.cls;
+    uint8_t* h = heap[cls];
+    int n = heapSize[cls];
+    int k = 0;
+    while (k < n && h[k] != id) {
+        k++;
+    }
+    if (k == n) {
+        return;
+    }
+    // Small heaps: rebuild without it
+    uint8_t rest[JOB_MAX];
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+        if (i != k) {
+            rest[m++] = h[i];
+        }
+    }
+    heapSize[cls] = 0;
+    for (int i = 0; i < m; i++) {
+        push(rest[i]);
+    }
+    jobs[id].queued = false;
+}
+
+int JobScheduler::next(uint32_t now, bool fetchAllowed) {
+    for (int cls = 0; cls < JOB_CLASSES; cls++) {
+        if (heapSize[cls] == 0 || (cls == JOB_FETCH && !fetchAllowed)) {
+            continue;
+        }
+        if ((int32_t)(now - jobs[heap[cls][0]].due) >= 0) {
+            int id = pop((JobClass)cls);
+            jobs[id].running = true;
+            return id;
+        }
+    }
+    return -1;
+}
+
+void JobScheduler::finish(int id, uint32_t start, uint32_t runUs) {
+    Job& j = jobs[id];
+    JobStats& s = j.stats;
+    j.running = false;
+
+    s.runs++;
+    s.lastUs = runUs;
+    s.totalUs += runUs;
+    if (runUs > s.maxUs) s.maxUs = runUs;
+    if (j.spec.budgetMs && runUs > j.spec.budgetMs * 1000) {
+        s.overruns++;
+    }
+    int32_t late = (int32_t)(start - j.due);
+    if (late > 0 && (uint32_t)late > s.maxLateMs) {
+        s.maxLateMs = late;
+    }
+
+    uint32_t end = start + runUs / 1000;
+    if (j.retrigger) {
+        j.retrigger = false;
+        j.due = end;
+        push(id);
+        return;
+    }
+    if (j.spec.periodMs == 0) {
+        return;                 // One-shot until triggered again
+    }
+
+    j.base += j.spec.periodMs;
+    if ((int32_t)(end - j.base) >= 0) {
+        // Fell behind: skip to the next slot still ahead
+        uint32_t missed = (end - j.base) / j.spec.periodMs + 1;
+        s.skipped += missed;
+        j.base += missed * j.spec.periodMs;
+    }
+    j.due = j.base + jitter(j.spec.jitterMs);
+    push(id);
+}
+
+void JobScheduler::trigger(int id, uint32_t now) {
+    if (id < 0 || id >= count) {
+        return;
+    }
+    Job& j = jobs[id];
+    j.stats.triggered++;
+    if (j.running) {
+        j.retrigger = true;
+        return;
+    }
+    if (j.queued) {
+        remove(id);
+    }
+    j.due = now;
+    push(id);
+}
+
+void JobScheduler::setPeriod(int id, uint32_t periodMs) {
+    if (id >= 0 && id < count) {
+        jobs[id].spec.periodMs = periodMs;
+    }
+}
+
+uint32_t JobScheduler::nextDue(uint32_t now) const {
+    uint32_t wait = UINT32_MAX;
+    for (int cls = 0; cls < JOB_CLASSES; cls++) {
+        if (heapSize[cls] == 0) {
+            continue;
+        }
+        int32_t d = (int32_t)(jobs[heap[cls][0]].due - now);
+        uint32_t w = d > 0 ? (uint32_t)d : 0;
+        if (w < wait) wait = w;
+    }
+    return wait;
+}
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+
+LoopScheduler scheduler;
+
+static const char* CLASS_NAMES[JOB_CLASSES] = { "voice", "ui", "telemetry", "fetch" };
+
+LoopScheduler::LoopScheduler()
+    : worker(nullptr), workerJob(-1), workerDone(false), workerStart(0), workerRunUs(0), passes(0),
+      deferredPasses(0) {
+}
+
+bool LoopScheduler::begin() {
+    jobs.seed(esp_random());
+    if (xTaskCreatePinnedToCore(workerTask, "sched_fetch", 8192, this, 1, &worker, 0) != pdPASS) {
+        worker = nullptr;
+        log_e("Scheduler: no worker task, fetches run on the main loop");
+        return false;
+    }
+    return true;
+}
+
+int LoopScheduler::add(const JobSpec& spec, uint32_t firstDelayMs) {
+    int id = jobs.add(spec, millis(), firstDelayMs);
+    if (id < 0) {
+        log_e("Scheduler: cannot add job %s", spec.name);
+    }
+    return id;
+}
+
+void LoopScheduler::trigger(int id) {
+    jobs.trigger(id, millis());
+}
+
+void LoopScheduler::setPeriod(int id, uint32_t periodMs) {
+    jobs.setPeriod(id, periodMs);
+}
+
+void LoopScheduler::workerTask(void* param) {
+    LoopScheduler* self = (LoopScheduler*)param;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        int id = self->workerJob;
+        if (id < 0 || self->workerDone) {
+            continue;
+        }
+        const JobSpec& spec = self->jobs.getSpec(id);
+        uint32_t t0 = micros();
+        spec.run(spec.ctx);
+        self->workerRunUs = micros() - t0;
+        self->workerDone = true;
+    }
+}
+
+void LoopScheduler::loop() {
+    passes++;
+
+    // Apply a finished fetch before handing out the next one
+    if (workerDone) {
+        int id = workerJob;
+        const JobSpec& spec = jobs.getSpec(id);
+        if (spec.done) {
+            spec.done(spec.ctx);
+        }
+        jobs.finish(id, workerStart, workerRunUs);
+        workerDone = false;
+        workerJob = -1;
+    }
+
+    uint32_t passStart = millis();
+    int id;
+    while ((id = jobs.next(millis(), workerJob < 0)) >= 0) {
+        const JobSpec& spec = jobs.getSpec(id);
+        if (spec.cls == JOB_FETCH && worker) {
+            workerStart = millis();
+            workerJob = id;
+            xTaskNotifyGive(worker);
+            continue;
+        }
+
+        uint32_t start = millis();
+        uint32_t t0 = micros();
+        spec.run(spec.ctx);
+        if (spec.cls == JOB_FETCH && spec.done) {
+            spec.done(spec.ctx);
+        }
+        jobs.finish(id, start, micros() - t0);
+
+        // The rest waits for the next pass; audio and LVGL get their turn first
+        if (millis() - passStart >= SCHED_PASS_BUDGET_MS) {
+            if (jobs.nextDue(millis()) == 0) {
+                deferredPasses++;
+            }
+            break;
+        }
+    }
+}
+
+void LoopScheduler::getStatusJson(JsonObject obj) {
+    obj["passes"] = passes;
+    obj["deferred_passes"] = deferredPasses;
+    obj["worker"] = worker != nullptr;
+    int busy = workerJob;
+    obj["worker_job"] = busy >= 0 ? jobs.getName(busy) : nullptr;
+
+    JsonArray list = obj["jobs"].to<JsonArray>();
+    for (int i = 0; i < jobs.getCount(); i++) {
+        const JobSpec& spec = jobs.getSpec(i);
+        const JobStats& s = jobs.getStats(i);
+        JsonObject j = list.add<JsonObject>();
+        j["name"] = spec.name;
+        j["class"] = CLASS_NAMES[spec.cls];
+        j["period_ms"] = spec.periodMs;
+        j["budget_ms"] = spec.budgetMs;
+        j["runs"] = s.runs;
+        j["avg_us"] = s.runs ? (uint32_t)(s.totalUs / s.runs) : 0;
+        j["last_us"] = s.lastUs;
+        j["max_us"] = s.maxUs;
+        j["overruns"] = s.overruns;
+        j["skipped"] = s.skipped;
+        j["triggered"] = s.triggered;
+        j["max_late_ms"] = s.maxLateMs;
+        j["running"] = jobs.isRunning(i);
+    }
+}
+
+#endif
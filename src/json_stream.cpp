@@ -0,0 +1,444 @@
+#include "json_stream.h"
+#include <string.h>
+#include <stdlib.h>
+
+JsonStreamParser::JsonStreamParser() {
+    begin(nullptr, nullptr, nullptr);
+}
+
+void JsonStreamParser::begin(ValueHandler valueHandler, CloseHandler closeHandler, void* context) {
+    onValue = valueHandler;
+    onClose = closeHandler;
+    ctx = context;
+    state = VALUE;
+    inKey = false;
+    truncated = false;
+    error = nullptr;
+    offset = 0;
+    depth = 0;
+    arrays = 0;
+    textLen = 0;
+    text[0] = '\0';
+    codePoint = 0;
+    highSurrogate = 0;
+    hexDigits = 0;
+}
+
+bool JsonStreamParser::feed(const char* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (state == STOPPED || state == FAILED) {
+            return false;
+        }
+        if (state == STRING && !highSurrogate) {
+            // Plain run of a string in one go
+            size_t run = i;
+            while (run < len && data[run] != '"' && data[run] != '\\' && (uint8_t)data[run] >= 0x20) {
+                run++;
+            }
+            size_t n = run - i;
+            size_t room = sizeof(text) - 1 - textLen;
+            if (n > room) {
+                truncated = true;
+            }
+            memcpy(text + textLen, data + i, n < room ? n : room);
+            textLen += n < room ? n : room;
+            offset += n;
+            i = run;
+            if (i == len) {
+                break;
+            }
+        }
+        // A literal ends at the first character that is not part of it,
+        // which is then read again in the state that follows
+        while (!step(data[i])) {
+            if (state == FAILED) {
+                return false;
+            }
+        }
+        offset++;
+    }
+    return state != STOPPED && state != FAILED;
+}
+
+bool JsonStreamParser::finish() {
+    if (state == LITERAL && depth == 0) {
+        finishLiteral();
+    }
+    if (state == DONE || state == STOPPED) {
+        return true;
+    }
+    if (state != FAILED) {
+        fail(offset == 0 ? "Empty input" : "Incomplete input");
+    }
+    return false;
+}
+
+void JsonStreamParser::stop() {
+    if (state != FAILED) {
+        state = STOPPED;
+    }
+}
+
+bool JsonStreamParser::isArray(int level) const {
+    return level >= 0 && level < depth && ((arrays >> level) & 1);
+}
+
+int JsonStreamParser::getIndex(int level) const {
+    return isArray(level) && level < JSON_STREAM_MAX_DEPTH ? indexes[level] : -1;
+}
+
+const char* JsonStreamParser::getKey(int level) const {
+    if (level < 0 || level >= depth || level >= JSON_STREAM_MAX_DEPTH || isArray(level) || keyTruncated[level]) {
+        return "";
+    }
+    return keys[level];
+}
+
+bool JsonStreamParser::match(const char* pattern) const {
+    int level = 0;
+    const char* p = pattern;
+    while (*p) {
+        if (level >= depth || level >= JSON_STREAM_MAX_DEPTH) {
+            return false;
+        }
+        if (*p == '[') {
+            if (!isArray(level)) {
+                return false;
+            }
+            p++;
+            if (*p == '*') {
+                p++;
+            } else {
+                char* end;
+                long n = strtol(p, &end, 10);
+                if (end == p || n != indexes[level]) {
+                    return false;
+                }
+                p = end;
+            }
+            if (*p++ != ']') {
+                return false;
+            }
+        } else {
+            if (*p == '.') {
+                p++;
+            }
+            size_t n = strcspn(p, ".[");
+            if (isArray(level) || keyTruncated[level] || strlen(keys[level]) != n || memcmp(keys[level], p, n) != 0) {
+                return false;
+            }
+            p += n;
+        }
+        level++;
+    }
+    return level == depth;
+}
+
+void JsonStreamParser::fail(const char* why) {
+    state = FAILED;
+    error = why;
+}
+
+void JsonStreamParser::append(char c) {
+    if (textLen < sizeof(text) - 1) {
+        text[textLen++] = c;
+    } else {
+        truncated = true;
+    }
+}
+
+void JsonStreamParser::appendCodePoint(uint32_t cp) {
+    char utf8[4];
+    size_t n;
+    if (cp < 0x80) {
+        utf8[0] = (char)cp;
+        n = 1;
+    } else if (cp < 0x800) {
+        utf8[0] = (char)(0xC0 | (cp >> 6));
+        utf8[1] = (char)(0x80 | (cp & 0x3F));
+        n = 2;
+    } else if (cp < 0x10000) {
+        utf8[0] = (char)(0xE0 | (cp >> 12));
+        utf8[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        utf8[2] = (char)(0x80 | (cp & 0x3F));
+        n = 3;
+    } else {
+        utf8[0] = (char)(0xF0 | (cp >> 18));
+        utf8[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        utf8[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        utf8[3] = (char)(0x80 | (cp & 0x3F));
+        n = 4;
+    }
+    // Never cut a character in half
+    if (textLen + n > sizeof(text) - 1) {
+        truncated = true;
+        return;
+    }
+    memcpy(text + textLen, utf8, n);
+    textLen += n;
+}
+
+bool JsonStreamParser::open(bool array) {
+    if (depth >= JSON_STREAM_MAX_NESTING) {
+        fail("Nesting too deep");
+        return false;
+    }
+    if (array) {
+        arrays |= (uint64_t)1 << depth;
+    } else {
+        arrays &= ~((uint64_t)1 << depth);
+    }
+    if (depth < JSON_STREAM_MAX_DEPTH) {
+        keys[depth][0] = '\0';
+        keyTruncated[depth] = false;
+        indexes[depth] = 0;
+    }
+    depth++;
+    state = array ? ARRAY_FIRST : OBJECT_FIRST;
+    return true;
+}
+
+bool JsonStreamParser::close(bool array) {
+    if (depth == 0 || isArray(depth - 1) != array) {
+        fail(array ? "Unexpected ]" : "Unexpected }");
+        return false;
+    }
+    depth--;
+    if (onClose) {
+        onClose(*this, ctx);
+    }
+    if (state != STOPPED) {
+        valueDone();
+    }
+    return true;
+}
+
+void JsonStreamParser::valueDone() {
+    state = depth == 0 ? DONE : NEXT;
+}
+
+void JsonStreamParser::emit(JsonStreamType type) {
+    if (truncated) {
+        // Drop a UTF-8 sequence the limit cut short
+        size_t lead = textLen;
+        while (lead > 0 && ((uint8_t)text[lead - 1] & 0xC0) == 0x80) {
+            lead--;
+        }
+        if (lead > 0 && ((uint8_t)text[lead - 1] & 0x80)) {
+            uint8_t b = text[lead - 1];
+            size_t need = b >= 0xF0 ? 4 : b >= 0xE0 ? 3 : 2;
+            if (textLen - (lead - 1) < need) {
+                textLen = lead - 1;
+            }
+        }
+    }
+    text[textLen] = '\0';
+    if (onValue) {
+        onValue(*this, type, text, textLen, ctx);
+    }
+    if (state != STOPPED) {
+        valueDone();
+    }
+}
+
+bool JsonStreamParser::finishLiteral() {
+    text[textLen] = '\0';
+    JsonStreamType type;
+    if (strcmp(text, "true") == 0 || strcmp(text, "false") == 0) {
+        type = JSON_STREAM_BOOL;
+    } else if (strcmp(text, "null") == 0) {
+        type = JSON_STREAM_NULL;
+    } else {
+        char* end;
+        strtod(text, &end);
+        if (!(text[0] == '-' || (text[0] >= '0' && text[0] <= '9')) || *end != '\0' || truncated) {
+            fail("Invalid literal");
+            return false;
+        }
+        type = JSON_STREAM_NUMBER;
+    }
+    emit(type);
+    return true;
+}
+
+// Returns false if c has to be read again in the new state
+bool JsonStreamParser::step(char c) {
+    bool space = c == ' ' || c == '\t' || c == '\n' || c == '\r';
+
+    switch (state) {
+        case ARRAY_FIRST:
+            if (space) return true;
+            if (c == ']') {
+                close(true);
+                return true;
+            }
+            state = VALUE;
+            return false;
+
+        case VALUE:
+            if (space) return true;
+            textLen = 0;
+            truncated = false;
+            if (c == '{') {
+                open(false);
+            } else if (c == '[') {
+                open(true);
+            } else if (c == '"') {
+                inKey = false;
+                state = STRING;
+            } else if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+                append(c);
+                state = LITERAL;
+            } else {
+                fail("Unexpected character");
+            }
+            return true;
+
+        case OBJECT_FIRST:
+        case KEY:
+            if (space) return true;
+            if (c == '}' && state == OBJECT_FIRST) {
+                close(false);
+            } else if (c == '"') {
+                textLen = 0;
+                truncated = false;
+                inKey = true;
+                state = STRING;
+            } else {
+                fail("Expected a key");
+            }
+            return true;
+
+        case COLON:
+            if (space) return true;
+            if (c == ':') {
+                state = VALUE;
+            } else {
+                fail("Expected :");
+            }
+            return true;
+
+        case NEXT:
+            if (space) return true;
+            if (c == ',') {
+                if (isArray(depth - 1)) {
+                    if (depth <= JSON_STREAM_MAX_DEPTH) {
+                        indexes[depth - 1]++;
+                    }
+                    state = VALUE;
+                } else {
+                    state = KEY;
+                }
+            } else if (c == ']' || c == '}') {
+                close(c == ']');
+            } else {
+                fail("Expected , or a closing bracket");
+            }
+            return true;
+
+        case STRING:
+            if (c == '"') {
+                if (highSurrogate) {
+                    appendCodePoint(0xFFFD);
+                    highSurrogate = 0;
+                }
+                if (inKey) {
+                    if (depth <= JSON_STREAM_MAX_DEPTH) {
+                        size_t n = textLen < JSON_STREAM_KEY_LEN ? textLen : JSON_STREAM_KEY_LEN - 1;
+                        memcpy(keys[depth - 1], text, n);
+                        keys[depth - 1][n] = '\0';
+                        keyTruncated[depth - 1] = truncated || textLen >= JSON_STREAM_KEY_LEN;
+                    }
+                    state = COLON;
+                } else {
+                    emit(JSON_STREAM_STRING);
+                }
+            } else if (c == '\\') {
+                state = ESCAPE;
+            } else if ((uint8_t)c < 0x20) {
+                fail("Control character in string");
+            } else {
+                if (highSurrogate) {
+                    appendCodePoint(0xFFFD);
+                    highSurrogate = 0;
+                }
+                append(c);
+            }
+            return true;
+
+        case ESCAPE: {
+            if (c == 'u') {
+                codePoint = 0;
+                hexDigits = 0;
+                state = UNICODE;
+                return true;
+            }
+            if (highSurrogate) {
+                appendCodePoint(0xFFFD);
+                highSurrogate = 0;
+            }
+            const char* from = "\"\\/bfnrt";
+            const char* to = "\"\\/\b\f\n\r\t";
+            const char* e = strchr(from, c);
+            if (!e || !c) {
+                fail("Invalid escape");
+                return true;
+            }
+            append(to[e - from]);
+            state = STRING;
+            return true;
+        }
+
+        case UNICODE: {
+            int digit;
+            if (c >= '0' && c <= '9') digit = c - '0';
+            else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+            else {
+                fail("Invalid \\u escape");
+                return true;
+            }
+            codePoint = (codePoint << 4) | digit;
+            if (++hexDigits < 4) {
+                return true;
+            }
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                if (highSurrogate) {
+                    appendCodePoint(0xFFFD);
+                }
+                highSurrogate = (uint16_t)codePoint;
+            } else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+                appendCodePoint(highSurrogate ? 0x10000 + ((highSurrogate - 0xD800) << 10) + (codePoint - 0xDC00) : 0xFFFD);
+                highSurrogate = 0;
+            } else {
+                if (highSurrogate) {
+                    appendCodePoint(0xFFFD);
+                    highSurrogate = 0;
+                }
+                appendCodePoint(codePoint);
+            }
+            state = STRING;
+            return true;
+        }
+
+        case LITERAL:
+            if ((c >= '0' && c <= '9') || (c && strchr(".-+eEtruefalsn", c))) {
+                append(c);
+                return true;
+            }
+            finishLiteral();
+            return state == STOPPED;
+
+        case DONE:
+            // Only whitespace may follow the document
+            if (!space) {
+                fail("Data after the document");
+            }
+            return true;
+
+        case STOPPED:
+        case FAILED:
+            return true;
+    }
+    return true;
+}
@@ -1,5 +1,6 @@
 #include "lvgl_ui.h"
 #include "pins.h"
+#include "audio_handler.h"
 #include <Wire.h>
 #include <Ticker.h>
 
@@ -44,12 +45,19 @@ LVGL_UI::LVGL_UI()
     : touch(&Wire, TOUCH_INT),
       currentScreen(SCREEN_MAIN),
       personCount(0),
+      gateState(-1),
+      hasWeather(false),
+      weatherTemp(0),
       voiceCallback(nullptr),
       voicePopupOverlay(nullptr),
       voicePopupContainer(nullptr),
       voicePopupStatusLabel(nullptr),
       voicePopupSubtitleLabel(nullptr),
-      voicePopupAnimation(nullptr) {
+      voicePopupAnimation(nullptr),
+      voicePopupMeter(nullptr),
+      voiceMeterTimer(nullptr),
+      voiceMeterSeq(0),
+      voiceMeterValue(0) {
     instance = this;
     
     for (int i = 0; i < SCREEN_COUNT; i++) {
@@ -426,6 +434,16 @@ void LVGL_UI::updateWeather(float temp, const char* condition) {
     // Format temperature with degree symbol
     char tempStr[16];
     snprintf(tempStr, sizeof(tempStr), "%.1f°", temp);
+    
+    // Same text as on screen: nothing to redraw
+    ChangeHash hash;
+    hash.add(tempStr).add(condition);
+    if (!changes.update("weather", hash.value(), millis())) return;
+    
+    hasWeather = true;
+    weatherTemp = temp;
+    strlcpy(weatherCondition, condition, sizeof(weatherCondition));
+    
     lv_label_set_text(tempLabel, tempStr);
     
     // Map condition to display text and icon
@@ -482,6 +500,12 @@ void LVGL_UI::updateWeather(float temp, const char* condition) {
 void LVGL_UI::updatePersonPresence(int personIndex, const char* name, bool present, uint32_t color) {
     if (personIndex < 0 || personIndex >= MAX_PEOPLE) return;
     
+    char key[CHANGE_KEY_LEN];
+    snprintf(key, sizeof(key), "person%d", personIndex);
+    ChangeHash hash;
+    hash.add(name).add(present).add((int32_t)color);
+    if (!changes.update(key, hash.value(), millis())) return;
+    
     strncpy(people[personIndex].name, name, sizeof(people[personIndex].name) - 1);
     people[personIndex].present = present;
     people[personIndex].color = color;
@@ -509,6 +533,15 @@ void LVGL_UI::updatePersonPresence(int personIndex, const char* name, bool prese
 void LVGL_UI::updateCalendar(CalendarEvent* events, int eventCount) {
     if (!calendarEventLabel || !calendarMoreButton) return;
     
+    // The badge shows the count, the label the first event; hash all shown
+    // events so the stored list stays current too
+    ChangeHash hash;
+    hash.add((int32_t)eventCount);
+    for (int i = 0; i < min(eventCount, MAX_CALENDAR_EVENTS); i++) {
+        hash.add(events[i].title).add(events[i].time);
+    }
+    if (!changes.update("calendar", hash.value(), millis())) return;
+    
     // Store events
     calendarEventCount = min(eventCount, MAX_CALENDAR_EVENTS);
     for (int i = 0; i < calendarEventCount; i++) {
@@ -605,6 +638,11 @@ void LVGL_UI::setAnyoneHome(bool isHome) {
 void LVGL_UI::updateGateStatus(bool isOpen) {
     if (!gateStatusLabel || !gateIcon) return;
     
+    ChangeHash hash;
+    hash.add(isOpen);
+    if (!changes.update("gate", hash.value(), millis())) return;
+    gateState = isOpen ? 1 : 0;
+    
     if (isOpen) {
         lv_label_set_text(gateStatusLabel, "Open");
         lv_img_set_src(gateIcon, &gate_open);  // Show open gate image
@@ -614,6 +652,94 @@ void LVGL_UI::updateGateStatus(bool isOpen) {
     }
 }
 
+void LVGL_UI::getStatusJson(JsonObject obj) {
+    const ChangeStats& total = changes.getStats(millis());
+    obj["updates"] = total.changes;
+    obj["unchanged"] = total.suppressed;
+    obj["redraws_avoided_this_hour"] = total.suppressedThisHour;
+    obj["redraws_avoided_last_hour"] = total.suppressedLastHour;
+    
+    JsonObject widgets = obj["widgets"].to<JsonObject>();
+    for (int i = 0; i < changes.getCount(); i++) {
+        const ChangeStats& s = changes.getKeyStats(i);
+        JsonObject w = widgets[changes.getKey(i)].to<JsonObject>();
+        w["updates"] = s.changes;
+        w["unchanged"] = s.suppressed;
+    }
+}
+
+// YYYYMMDD in local time, 0 while the clock is not set
+static int localDay() {
+    time_t now = time(nullptr);
+    if (now < 1000000000) {
+        return 0;
+    }
+    struct tm tm;
+    localtime_r(&now, &tm);
+    return (tm.tm_year + 1900) * 10000 + (tm.tm_mon + 1) * 100 + tm.tm_mday;
+}
+
+void LVGL_UI::saveDashboard(JsonDocument& doc) {
+    doc.clear();
+    if (hasWeather) {
+        doc["weather"]["temp"] = weatherTemp;
+        doc["weather"]["condition"] = weatherCondition;
+    }
+    JsonArray list = doc["people"].to<JsonArray>();
+    for (int i = 0; i < personCount; i++) {
+        JsonObject p = list.add<JsonObject>();
+        p["name"] = people[i].name;
+        p["present"] = people[i].present;
+        p["color"] = people[i].color;
+    }
+    if (gateState >= 0) {
+        doc["gate_open"] = gateState == 1;
+    }
+    doc["calendar_day"] = localDay();
+    JsonArray events = doc["calendar"].to<JsonArray>();
+    for (int i = 0; i < calendarEventCount; i++) {
+        JsonObject e = events.add<JsonObject>();
+        e["title"] = calendarEvents[i].title;
+        e["time"] = calendarEvents[i].time;
+    }
+}
+
+void LVGL_UI::restoreDashboard(JsonVariantConst doc) {
+    if (doc["weather"].is<JsonObjectConst>()) {
+        updateWeather(doc["weather"]["temp"] | 0.0f, doc["weather"]["condition"] | "");
+    }
+    int i = 0;
+    for (JsonObjectConst p : doc["people"].as<JsonArrayConst>()) {
+        if (i >= MAX_PEOPLE) break;
+        updatePersonPresence(i++, p["name"] | "", p["present"] | false, p["color"] | 0x00FF00);
+    }
+    if (doc["gate_open"].is<bool>()) {
+        updateGateStatus(doc["gate_open"].as<bool>());
+    }
+    
+    // Event times are relative ("TODAY 14:00"), so only the same day's list
+    // is shown until the calendar job has run
+    int day = localDay();
+    if (day == 0 || (doc["calendar_day"] | -1) != day) {
+        return;
+    }
+    CalendarEvent events[MAX_CALENDAR_EVENTS];
+    int count = 0;
+    for (JsonObjectConst e : doc["calendar"].as<JsonArrayConst>()) {
+        if (count >= MAX_CALENDAR_EVENTS) break;
+        strlcpy(events[count].title, e["title"] | "", sizeof(events[count].title));
+        strlcpy(events[count].time, e["time"] | "", sizeof(events[count].time));
+        count++;
+    }
+    if (count > 0) {
+        updateCalendar(events, count);
+    }
+}
+
+uint32_t LVGL_UI::getUpdateCount() {
+    return changes.getStats(millis()).changes;
+}
+
 void LVGL_UI::showScreen(ScreenID screenId) {
     if (screenId < 0 || screenId >= SCREEN_COUNT || !screens[screenId]) return;
     
@@ -738,6 +864,19 @@ void LVGL_UI::showVoicePopup(const char* statusText, const char* subtitle) {
         lv_label_set_long_mode(voicePopupSubtitleLabel, LV_LABEL_LONG_WRAP);
         lv_obj_set_width(voicePopupSubtitleLabel, 360);
         lv_obj_align(voicePopupSubtitleLabel, LV_ALIGN_TOP_MID, 0, 165);
+        
+        // Live level meter (bottom strip), hidden until enabled
+        voicePopupMeter = lv_bar_create(voicePopupContainer);
+        lv_obj_set_size(voicePopupMeter, 300, 10);
+        lv_obj_align(voicePopupMeter, LV_ALIGN_BOTTOM_MID, 0, -4);
+        lv_bar_set_range(voicePopupMeter, 0, 100);
+        lv_obj_set_style_bg_color(voicePopupMeter, lv_color_hex(0x2a2a40), LV_PART_MAIN);
+        lv_obj_set_style_bg_color(voicePopupMeter, lv_color_hex(0x22c55e), LV_PART_INDICATOR);
+        lv_obj_set_style_anim_time(voicePopupMeter, 0, LV_PART_MAIN);
+        lv_obj_add_flag(voicePopupMeter, LV_OBJ_FLAG_HIDDEN);
+        
+        voiceMeterTimer = lv_timer_create(voice_meter_timer_cb, VOICE_METER_PERIOD_MS, this);
+        lv_timer_pause(voiceMeterTimer);
     } else {
         // Update existing popup
         updateVoicePopupText(statusText, subtitle);
@@ -753,6 +892,49 @@ void LVGL_UI::hideVoicePopup() {
         log_i("🚫 Hiding popup");
         lv_obj_add_flag(voicePopupOverlay, LV_OBJ_FLAG_HIDDEN);
     }
+    setVoiceLevelMeter(false);
+}
+
+void LVGL_UI::setVoiceLevelMeter(bool enabled) {
+    if (!voicePopupMeter || !voiceMeterTimer) {
+        return;
+    }
+    
+    if (enabled) {
+        voiceMeterValue = 0;
+        lv_bar_set_value(voicePopupMeter, 0, LV_ANIM_OFF);
+        lv_obj_clear_flag(voicePopupMeter, LV_OBJ_FLAG_HIDDEN);
+        lv_timer_resume(voiceMeterTimer);
+    } else {
+        lv_timer_pause(voiceMeterTimer);
+        lv_obj_add_flag(voicePopupMeter, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+void LVGL_UI::voice_meter_timer_cb(lv_timer_t* timer) {
+    LVGL_UI* ui = (LVGL_UI*)timer->user_data;
+    
+    // Lock-free read of the latest captured frame level
+    uint32_t snapshot = audioHandler.getLevelSnapshot();
+    uint16_t seq = snapshot >> 16;
+    int16_t peak = (int16_t)(snapshot & 0xFFFF);
+    
+    int16_t target = ui->voiceMeterValue;
+    if (seq != ui->voiceMeterSeq) {
+        ui->voiceMeterSeq = seq;
+        // Map -60..0 dBFS to 0..100 so quiet speech still moves the bar
+        float db = peak > 0 ? 20.0f * log10f(peak / 32768.0f) : -60.0f;
+        target = constrain((int)((db + 60.0f) * 100.0f / 60.0f), 0, 100);
+    }
+    
+    // Fast rise, slow fall (peak meter ballistics)
+    int16_t value = target >= ui->voiceMeterValue ? target : max(target, (int16_t)(ui->voiceMeterValue - 8));
+    
+    // Only touch the bar (and invalidate its small area) when the value moves
+    if (value != ui->voiceMeterValue) {
+        ui->voiceMeterValue = value;
+        lv_bar_set_value(ui->voicePopupMeter, value, LV_ANIM_OFF);
+    }
 }
 
 void LVGL_UI::updateVoicePopupText(const char* statusText, const char* subtitle) {
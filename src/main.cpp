@@ -30,22 +30,70 @@
 #include "audio_handler.h"
 #include "voice_activity_handler.h"
 #include "storage_manager.h"
+#include "config_service.h"
 #include "web_server.h"
 #include "ha_integration.h"
 #include "ha_assist_client.h"
 #include "lvgl_ui.h"
 #include "led_feedback.h"
 #include "notification_manager.h"
+#include "mic_calibration.h"
+#include "audio_metrics.h"
+#include "audio_stages.h"
+#include "utterance_archive.h"
+#include "sound_events.h"
+#include "tone_detector.h"
+#include "intercom_stream.h"
+#include "command_engine.h"
+#include "entity_index.h"
+#include "action_executor.h"
+#include "intent_dispatcher.h"
+#include "ha_websocket.h"
+#include "ha_http.h"
+#include "ha_batch.h"
+#include "json_stream.h"
+#include "job_scheduler.h"
+#include "tz_table.h"
+#include "boot_sequencer.h"
+#include "boot_profiler.h"
 
 // System state
-unsigned long lastStatusUpdate = 0;
 unsigned long lastWeatherUpdate = 0;
 unsigned long lastPresenceUpdate = 0;
-unsigned long lastCalendarUpdate = 0;
 unsigned long lastTimezoneUpdate = 0;
-bool systemReady = false;
+bool systemReady = false;                      // Every boot task has run
 bool timezoneSet = false;
 
+// Boot, see setupSystem()
+const unsigned long BOOT_DASHBOARD_TIMEOUT_MS = 10000;  // setup() returns by then regardless
+int bootDisplayTask = -1;
+int bootDashboardTask = -1;
+bool bootReportPending = false;                // Boot report goes out with the next status job
+
+// Periodic work, see setupJobs()
+int statusJob = -1;
+int statesJob = -1;
+int calendarJob = -1;
+int dashboardJob = -1;
+uint32_t dashboardSavedUpdates = 0;            // lvglUI.getUpdateCount() at the last cache write
+volatile bool statesRefreshForced = false;     // Next states job fetches everything
+bool pushedEntitiesStale = false;              // Entities changed since boot: poll them over REST
+bool calendarFetched = false;
+
+// Last weather reading (answers the "query:weather" command)
+float lastWeatherTemp = 0.0f;
+String lastWeatherState;
+
+// Entities pushed over the HA WebSocket. Cards are numbered by the REST
+// refresh, which skips people HA does not know; presenceCards[i] is the card
+// of presenceEntities[i] as of the last refresh, -1 if it got none.
+String presenceEntities[MAX_PEOPLE];
+int presenceCards[MAX_PEOPLE];
+int presenceEntityCount = 0;
+String weatherEntity;
+String gateEntity;
+String calendarEntity;
+
 // Voice recording state machine
 enum VoiceState {
     VOICE_IDLE,              // Waiting for trigger (loud sound)
@@ -65,9 +113,7 @@ const unsigned long WAIT_FOR_SPEECH_TIMEOUT_MS = 3000;  // 3 sec to start speaki
 const unsigned long SILENCE_DURATION_MS = 700;          // 700ms silence = end of speech
 const unsigned long MIN_RECORDING_MS = 500;             // Minimum recording duration
 const unsigned long MAX_RECORDING_MS = 10000;           // Maximum 10 seconds
-const int16_t SPEECH_THRESHOLD = 500;                   // Audio level to consider as speech (16-bit samples)
-const int16_t SILENCE_THRESHOLD = 100;                  // Below this = silence (noise floor is ~20-30)
-const int16_t MIN_SPEECH_LEVEL = 300;                   // Minimum max level during RECORDING to send to STT
+// Speech/silence/min-speech levels are per-device, see micCalibration.getThresholds()
 
 // Popup auto-hide
 unsigned long popupHideTime = 0;
@@ -81,22 +127,29 @@ unsigned long lastAudioLevelLog = 0;
 
 // Forward declarations
 void setupSystem();
-void testIntegrationsOnStartup(JsonDocument& config);
+void onBootFinished();
+void publishBootReport();
+void testIntegrationsOnStartup();
 void handleVoiceRecognition();
+void startListening();
 void handleMqttMessages(const char* topic, const char* payload);
 void publishSystemStatus();
 void processVoiceCommand(const char* command);
+void onActionComplete(const ActionOutcome& outcome, void* ctx);
+void onIntentResult(const IntentResult& result);
+void setupStatePush(JsonDocument& config);
+void setupJobs();
+void onHaStateChanged(const HAEntityState& state);
+void onConfigChanged(const ConfigSnapshot& config, uint32_t changed, void* ctx);
 void onAssistResult(const char* transcription, const char* response, const char* error);
-void updateWeatherDisplay();
-void updatePresenceDisplay();
-void updateCalendarDisplay();
-void setTimezoneFromHA();
+void applyTimezone(const char* timezone);
+String answerCommandQuery(const char* query);
 
 
 void setup() {
-    // Initialize serial communication
+    // Initialize serial communication. No wait for a monitor: the panel
+    // comes first, and the boot timeline is in GET /api/status
     Serial.begin(115200);
-    delay(1000);
     
     Serial.println("\n\n");
     Serial.println("╔═══════════════════════════════════════╗");
@@ -106,15 +159,31 @@ void setup() {
     Serial.println("╚═══════════════════════════════════════╝");
     Serial.println();
     
-    // Initialize system
-    setupSystem();
+    // Reset reason and how far the previous run got, before anything can hang
+    bootProfiler.begin();
     
-    Serial.println("\n✓ System initialization complete!");
-    Serial.println("══════════════════════════════════════════\n");
-    systemReady = true;
+    // Returns with the dashboard up; the rest of the boot runs from loop()
+    setupSystem();
 }
 
 void loop() {
+    // Until every boot task has run only the display and the boot tasks
+    // run here; the other modules may not have started yet
+    if (!systemReady) {
+        bootSequencer.loop();
+        if (bootSequencer.isDone(bootDisplayTask)) {
+            lvglUI.loop();
+        }
+        ledFeedback.loop();
+        configService.loop();
+        bootProfiler.loop();
+        if (bootSequencer.isFinished()) {
+            onBootFinished();
+        }
+        delay(5);
+        return;
+    }
+    
     // During voice recording, prioritize audio capture over UI updates
     // LVGL updates can take 20-50ms and starve audio sampling
     bool isVoiceActive = (voiceState == VOICE_WAITING_SPEECH || voiceState == VOICE_RECORDING);
@@ -125,9 +194,10 @@ void loop() {
         haAssist.loop();  // Needed for state management
         ledFeedback.loop();  // Visual feedback
         
-        // Still need some LVGL ticks for the popup, but less frequently
+        // Still need some LVGL ticks for the popup, but less frequently.
+        // Only the small level meter redraws here, so a 50ms cadence stays cheap.
         static unsigned long lastLvglTick = 0;
-        if (millis() - lastLvglTick >= 100) {  // LVGL every 100ms during recording
+        if (millis() - lastLvglTick >= VOICE_METER_PERIOD_MS) {  // LVGL every 50ms during recording
             lvglUI.loop();
             lastLvglTick = millis();
         }
@@ -144,6 +214,18 @@ void loop() {
     lvglUI.loop();
     ledFeedback.loop();
     notificationManager.loop();
+    micCalibration.loop();
+    soundEvents.loop();
+    toneMonitor.loop();
+    intercom.loop();
+    commandEngine.loop();
+    haEntities.loop();
+    actionExecutor.loop();
+    intentDispatcher.loop();
+    haSocket.loop();
+    configService.loop();
+    scheduler.loop();
+    bootProfiler.loop();
     
     // Audio processing for voice activity detection
     audioHandler.loop();
@@ -161,73 +243,95 @@ void loop() {
         popupShouldAutoHide = false;
     }
     
-    // Periodic status updates
-    unsigned long now = millis();
-    if (now - lastStatusUpdate >= 30000) { // Every 30 seconds
-        lastStatusUpdate = now;
-        publishSystemStatus();
+    // Small delay to prevent watchdog issues
+    delay(10);
+}
+
+// ============================================
+// Boot tasks, see boot_sequencer.h
+// ============================================
+static bool bootLed(void* ctx) {
+    // First, for visual feedback during boot
+    if (!ledFeedback.begin(LED_PIN, LED_BRIGHTNESS)) {
+        Serial.println("✗ WARNING: LED initialization failed");
+        return false;
     }
-    
-    // Periodic weather updates
-    if (now - lastWeatherUpdate >= 300000) { // Every 5 minutes
-        lastWeatherUpdate = now;
-        updateWeatherDisplay();
+    ledFeedback.showBooting();
+    return true;
+}
+
+static bool bootStorage(void* ctx) {
+    if (!storage.begin()) {
+        return false;
     }
-    
-    // Periodic presence updates
-    if (now - lastPresenceUpdate >= 30000) { // Every 30 seconds
-        lastPresenceUpdate = now;
-        updatePresenceDisplay();
+    storage.listFiles();
+    return true;
+}
+
+static bool bootConfig(void* ctx) {
+    // Parsed once here; everything after reads the in-memory snapshot
+    bool ok = configService.begin();
+    
+    // The rule cached from HA's last answer, so the clock shows local time
+    // before HA is reachable; UTC until there is one
+    ConfigRef config = configService.get();
+    const char* cachedTz = config->json["device"]["posix_tz"] | "";
+    if (*cachedTz) {
+        setenv("TZ", cachedTz, 1);
+        tzset();
+        timezoneSet = true;
     }
     
-    // Periodic calendar updates
-    if (now - lastCalendarUpdate >= 600000) { // Every 10 minutes
-        lastCalendarUpdate = now;
-        updateCalendarDisplay();
+    // WiFi starts next
+    ledFeedback.showWiFiConnecting();
+    return ok;
+}
+
+static bool bootDisplay(void* ctx) {
+    if (!lvglUI.begin()) {
+        return false;
     }
     
-    // Timezone update (retry until successful, then check daily)
-    unsigned long timezoneInterval = timezoneSet ? 86400000 : 60000; // Daily if set, every 1 min if not
-    if (now - lastTimezoneUpdate >= timezoneInterval) {
-        lastTimezoneUpdate = now;
-        setTimezoneFromHA();
-    }
+    // Pre-create voice popup during setup so it's ready instantly (avoids blocking during recording)
+    lvglUI.showVoicePopup("", "");  // Create with empty text
+    lvglUI.hideVoicePopup();  // Hide it immediately
     
-    // Small delay to prevent watchdog issues
-    delay(10);
+    lvglUI.setVoiceButtonCallback([]() {
+        if (voiceState == VOICE_IDLE && systemReady && !micCalibration.isRunning()) {
+            log_i("🎙️ Voice button pressed - waiting for speech");
+            startListening();
+        }
+    });
+    return true;
 }
 
-void setupSystem() {
-    Serial.println("Initializing system components...\n");
-    
-    // 0. LED Feedback (first for visual feedback during boot)
-    Serial.print("→ LED feedback... ");
-    if (ledFeedback.begin(LED_PIN, LED_BRIGHTNESS)) {
-        ledFeedback.showBooting();
-        Serial.println("✓");
-    } else {
-        Serial.println("✗ WARNING: LED initialization failed");
+// What the dashboard showed before the reset, until the first fetch
+static bool bootDashboard(void* ctx) {
+    JsonDocument cached;
+    if (storage.loadDashboard(cached)) {
+        lvglUI.restoreDashboard(cached);
     }
-    
-    // 1. Storage (must be first)
-    Serial.print("→ Storage system... ");
-    if (storage.begin()) {
-        Serial.println("✓");
-        storage.listFiles();
-    } else {
-        Serial.println("✗ FAILED!");
-    }
-    
-    // 2. WiFi
-    Serial.print("→ WiFi connection... ");
-    ledFeedback.showWiFiConnecting();
+    dashboardSavedUpdates = lvglUI.getUpdateCount();
+    lvglUI.updateTime();
+    lvglUI.loop();              // First frame now, not after the next task
+    return true;
+}
+
+// Worker: WiFiManager blocks until connected, or runs its portal
+static bool bootWifi(void* ctx) {
     wifiMgr.begin();
+    return true;
+}
+
+static void bootWifiDone(bool ok, void* ctx) {
     ledFeedback.showWiFiConnected();
-    Serial.println("✓");
+}
+
+// Worker: the clock is only waited for here, nothing else blocks on it
+static bool bootNtp(void* ctx) {
+    const char* tz = getenv("TZ");
+    configTzTime(tz && *tz ? tz : "UTC0", "pool.ntp.org", "time.nist.gov");
     
-    // 2.5. NTP Time Sync
-    Serial.print("→ NTP time sync... ");
-    configTime(0, 0, "pool.ntp.org", "time.nist.gov");  // Start with UTC
     // Wait for time to be set (max 10 seconds)
     time_t now = 0;
     int retry = 0;
@@ -236,37 +340,21 @@ void setupSystem() {
         time(&now);
         retry++;
     }
-    if (now > 1000000000) {
-        struct tm* timeinfo = localtime(&now);
-        char timeStr[30];
-        strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", timeinfo);
-        Serial.printf("✓ (%s)\n", timeStr);
-    } else {
+    if (now < 1000000000) {
         Serial.println("✗ WARNING: Time sync failed");
+        return false;
     }
-    
-    // 3. MQTT
-    Serial.print("→ MQTT client... ");
-    mqttClient.begin();
-    mqttClient.setCallback(handleMqttMessages);
-    Serial.println("✓");
-    
-    // 4. Web Server
-    Serial.print("→ Web server... ");
-    webServer.begin();
-    Serial.println("✓");
-    Serial.printf("   Access admin panel at: http://%s\n", wifiMgr.getIPAddress().c_str());
-    Serial.printf("   Or: http://%s.local\n", HOSTNAME);
-    
-    // 5. OTA Updates
-    Serial.print("→ OTA updates... ");
-    otaManager.begin();
-    Serial.println("✓");
-    
-    // 6. Audio Input
-    Serial.print("→ I2S audio input... ");
-    if (audioHandler.begin()) {
-        Serial.println("✓");
+    struct tm timeinfo;
+    localtime_r(&now, &timeinfo);
+    char timeStr[30];
+    strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &timeinfo);
+    Serial.printf("   Time: %s\n", timeStr);
+    return true;
+}
+
+static bool bootAudio(void* ctx) {
+    bool ok = audioHandler.begin();
+    if (ok) {
         // Quick microphone test
         audioHandler.testMicrophone();
         audioHandler.startRecording();
@@ -274,94 +362,50 @@ void setupSystem() {
         Serial.println("✗ WARNING: Audio initialization failed");
     }
     
-    // 7. Voice Activity Detection
-    Serial.print("→ Voice activity detection... ");
-    if (voiceActivity.begin()) {
-        Serial.println("✓");
-    } else {
-        Serial.println("✗ Failed");
+    // Voice Activity Detection
+    if (!voiceActivity.begin()) {
+        Serial.println("✗ WARNING: Voice activity detection failed");
+        ok = false;
     }
-    
-    // 8. Home Assistant
-    Serial.print("→ Home Assistant integration... ");
+    return ok;
+}
+
+static bool bootMqtt(void* ctx) {
+    mqttClient.begin();
+    mqttClient.setCallback(handleMqttMessages);
+    return true;
+}
+
+static bool bootWeb(void* ctx) {
+    webServer.begin();
+    Serial.printf("   Access admin panel at: http://%s\n", wifiMgr.getIPAddress().c_str());
+    Serial.printf("   Or: http://%s.local\n", HOSTNAME);
+    return true;
+}
+
+static bool bootOta(void* ctx) {
+    otaManager.begin();
+    return true;
+}
+
+// Discovery goes out once MQTT has had its connection attempt
+static bool bootHomeAssistant(void* ctx) {
     homeAssistant.begin();
-    Serial.println("✓");
-    
-    // Fetch timezone from Home Assistant
-    Serial.print("→ Setting timezone from HA... ");
-    setTimezoneFromHA();
-    Serial.println("✓");
-    
-    // 8.5. HA Assist Client (voice-to-text pipeline)
-    Serial.print("→ HA Assist client... ");
-    haAssist.begin(HA_BASE_URL, HA_TOKEN);
-    haAssist.setResultCallback(onAssistResult);
-    haAssist.setLanguage("en");
-    Serial.println("✓");
-    Serial.printf("   Assist endpoint: %s\n", HA_BASE_URL);
-    
-    // 9. Display
-    Serial.print("→ LVGL Display... ");
-    lvglUI.begin();
-    
-    // Pre-create voice popup during setup so it's ready instantly (avoids blocking during recording)
-    lvglUI.showVoicePopup("", "");  // Create with empty text
-    lvglUI.hideVoicePopup();  // Hide it immediately
-    
-    lvglUI.setVoiceButtonCallback([]() {
-        if (voiceState == VOICE_IDLE && systemReady) {
-            log_i("🎙️ Voice button pressed - waiting for speech");
-            
-            // Clear auto-hide flag AND timer immediately
-            popupShouldAutoHide = false;
-            popupHideTime = 0;
-            
-            // Start in WAITING_SPEECH state (same as voice trigger)
-            voiceState = VOICE_WAITING_SPEECH;
-            voiceStateStartTime = millis();
-            silenceStartTime = 0;
-            
-            // Reset audio monitoring
-            totalAudioSamples = 0;
-            maxAudioLevel = 0;
-            sumAbsAudioLevel = 0;
-            lastAudioLevelLog = millis();
-            
-            // Start recording
-            haAssist.startRecording();
-            
-            // Show popup and LED
-            lvglUI.showVoicePopup("Listening...", "Speak now");
-            ledFeedback.showListening();
-        }
-    });
-    Serial.println("✓");
-    
-    // Initial data fetch for display
-    Serial.print("→ Fetching initial data... ");
-    updateWeatherDisplay();
-    updatePresenceDisplay();
-    updateCalendarDisplay();
-    Serial.println("✓");
-    
-    // 10. Notification Manager
-    Serial.print("→ Notification manager... ");
+    return true;
+}
+
+static bool bootNotifications(void* ctx) {
     notificationManager.begin();
-    Serial.println("✓");
-    
-    // LED to idle state after boot
-    ledFeedback.showIdle();
-    
-    // Load configuration
-    Serial.print("\n→ Loading configuration... ");
+    return true;
+}
+
+// Modules configured from config.json
+static bool bootServices(void* ctx) {
     JsonDocument config;
-    bool configExists = storage.loadConfig(config);
+    bool configExists = configService.copy(config);
     bool needsSave = false;
     
     if (configExists) {
-        Serial.println("✓");
-        // Apply configuration settings here
-        
         // Load voice sensitivity from config
         if (config["voice"]["sensitivity"].is<float>()) {
             float sensitivity = config["voice"]["sensitivity"].as<float>();
@@ -369,6 +413,9 @@ void setupSystem() {
             Serial.printf("   Voice sensitivity: %.2f\n", sensitivity);
         }
         
+        // Load per-device recording thresholds
+        micCalibration.begin(config);
+        
         // Update existing config with token from secrets.h if missing
         if (!config["integrations"]["home_assistant"]["token"].is<const char*>() || 
             String(config["integrations"]["home_assistant"]["token"].as<const char*>()).isEmpty()) {
@@ -380,7 +427,7 @@ void setupSystem() {
             needsSave = true;
         }
     } else {
-        Serial.println("⚠️  Using defaults");
+        Serial.println("⚠️  Using default configuration");
         // Create default configuration with secrets from secrets.h
         config["device"]["name"] = DEVICE_NAME;
         config["device"]["version"] = DEVICE_VERSION;
@@ -395,39 +442,110 @@ void setupSystem() {
         needsSave = true;
     }
     
-    if (needsSave) {
-        storage.saveConfig(config);
-    }
-    
-    // Test integrations if configured
-    Serial.print("\n→ Testing integrations... ");
-    testIntegrationsOnStartup(config);
-    Serial.println("✓");
+    // HA Assist Client (voice-to-text pipeline)
+    haAssist.begin(HA_BASE_URL, HA_TOKEN);
+    haAssist.setResultCallback(onAssistResult);
+    haAssist.setLanguage("en");
+    Serial.printf("   Assist endpoint: %s\n", HA_BASE_URL);
     
-    // Show dashboard on display
-    delay(1000);
-    // display.showDashboard();  // Disabled - using LVGL
+    // Audio pipeline stages from config (defaults if not configured)
+    setupAudioPipeline(config);
+    utteranceArchive.begin(config);
+    soundEvents.begin(config);
+    toneMonitor.begin(config);
+    intercom.begin(config);
+    
+    // HA REST calls made before this point used the pool defaults
+    haHttp.begin(config);
+    
+    // Voice commands from commands.json; {slot} phrases resolve against HA
+    // entities, actions run through the queue
+    actionExecutor.begin(config);
+    actionExecutor.setCompletion(onActionComplete, nullptr);
+    actionExecutor.setCommandHandler(processVoiceCommand);
+    haEntities.begin(config);
+    setupStatePush(config);
+    configService.subscribe(onConfigChanged, nullptr,
+                            CONFIG_VOICE | CONFIG_INTEGRATIONS | CONFIG_WEATHER | CONFIG_PRESENCE | CONFIG_GATE);
+    intentDispatcher.begin(config);
+    intentDispatcher.setResultCallback(onIntentResult);
+    commandEngine.setQueryHandler(answerCommandQuery);
+    commandEngine.setSlotResolver(HAEntityIndex::resolveSlot, &haEntities);
+    commandEngine.begin();
     
-    // Update display with WiFi status
-    if (wifiMgr.isConnected()) {
-        // display.updateWiFiStatus(true, wifiMgr.getRSSI());  // Disabled - using LVGL
+    if (needsSave) {
+        configService.save(config);
     }
+    return true;
+}
+
+// Worker: the HA and weather probes block on HTTP
+static bool bootProbe(void* ctx) {
+    testIntegrationsOnStartup();
+    return true;
+}
+
+// Periodic status, HA state and calendar refreshes; the first ones run
+// right away and replace the cached dashboard
+static bool bootJobs(void* ctx) {
+    setupJobs();
+    return true;
+}
+
+// Running boot tasks into RTC memory: a reset shows how far boot got
+static void onBootStage(const char* running, void* ctx) {
+    bootProfiler.setStage(running);
+}
+
+void setupSystem() {
+    Serial.println("Initializing system components...\n");
     
-    // Publish initial status
-    delay(2000);
-    publishSystemStatus();
+    // Display in parallel with networking; anything that blocks on the
+    // network runs on a worker
+    int led = bootSequencer.add({ "led", BOOT_MAIN, bootLed, nullptr, nullptr }, 0);
+    int store = bootSequencer.add({ "storage", BOOT_MAIN, bootStorage, nullptr, nullptr }, 0);
+    int config = bootSequencer.add({ "config", BOOT_MAIN, bootConfig, nullptr, nullptr },
+                                   BOOT_DEP(store) | BOOT_DEP(led));
+    bootDisplayTask = bootSequencer.add({ "display", BOOT_MAIN, bootDisplay, nullptr, nullptr }, BOOT_DEP(config));
+    int dashboard = bootSequencer.add({ "dashboard", BOOT_MAIN, bootDashboard, nullptr, nullptr },
+                                      BOOT_DEP(bootDisplayTask));
+    bootDashboardTask = dashboard;
+    int wifi = bootSequencer.add({ "wifi", BOOT_WORKER, bootWifi, bootWifiDone, nullptr }, BOOT_DEP(config));
+    int ntp = bootSequencer.add({ "ntp", BOOT_WORKER, bootNtp, nullptr, nullptr }, BOOT_DEP(wifi));
+    int audio = bootSequencer.add({ "audio", BOOT_MAIN, bootAudio, nullptr, nullptr }, BOOT_DEP(dashboard));
+    int mqtt = bootSequencer.add({ "mqtt", BOOT_MAIN, bootMqtt, nullptr, nullptr },
+                                 BOOT_DEP(wifi) | BOOT_DEP(dashboard));
+    bootSequencer.add({ "web", BOOT_MAIN, bootWeb, nullptr, nullptr }, BOOT_DEP(wifi) | BOOT_DEP(dashboard));
+    bootSequencer.add({ "ota", BOOT_MAIN, bootOta, nullptr, nullptr }, BOOT_DEP(wifi));
+    bootSequencer.add({ "ha", BOOT_MAIN, bootHomeAssistant, nullptr, nullptr }, BOOT_DEP(mqtt));
+    int services = bootSequencer.add({ "services", BOOT_MAIN, bootServices, nullptr, nullptr },
+                                     BOOT_DEP(config) | BOOT_DEP(audio) | BOOT_DEP(wifi) | BOOT_DEP(dashboard));
+    bootSequencer.add({ "notifications", BOOT_MAIN, bootNotifications, nullptr, nullptr }, BOOT_DEP(config));
+    bootSequencer.add({ "probe", BOOT_WORKER, bootProbe, nullptr, nullptr }, BOOT_DEP(services));
+    bootSequencer.add({ "jobs", BOOT_MAIN, bootJobs, nullptr, nullptr },
+                      BOOT_DEP(services) | BOOT_DEP(mqtt) | BOOT_DEP(ntp));
+    
+    bootSequencer.setStageCallback(onBootStage, nullptr);
+    bootSequencer.start();
+    bootSequencer.runUntil(dashboard, BOOT_DASHBOARD_TIMEOUT_MS);
+    Serial.printf("\n✓ Dashboard up after %lu ms\n\n", (unsigned long)(bootSequencer.getDoneUs(dashboard) / 1000));
+}
+
+void onBootFinished() {
+    // LED to idle state after boot
+    ledFeedback.showIdle();
+    systemReady = true;
     
-    // Initial weather fetch
-    Serial.print("→ Fetching initial weather... ");
-    updateWeatherDisplay();
-    lastWeatherUpdate = millis();
-    Serial.println("✓");
-    
-    // Load and display presence data
-    Serial.print("→ Loading presence data... ");
-    updatePresenceDisplay();
-    lastPresenceUpdate = millis();
-    Serial.println("✓");
+    const BootGraph& graph = bootSequencer.getGraph();
+    int slowest = graph.getSlowest();
+    bootProfiler.finish(bootSequencer.getDoneUs(bootDashboardTask), bootSequencer.getFinishedUs(),
+                        slowest >= 0 ? graph.getSpec(slowest).name : "",
+                        slowest >= 0 ? graph.getEndUs(slowest) - graph.getStartUs(slowest) : 0);
+    bootReportPending = true;
+    
+    Serial.printf("\n✓ System initialization complete after %lu ms\n",
+                  (unsigned long)(bootSequencer.getFinishedUs() / 1000));
+    Serial.println("══════════════════════════════════════════\n");
 }
 
 // Callback for HA Assist results
@@ -435,6 +553,14 @@ void onAssistResult(const char* transcription, const char* response, const char*
     voiceState = VOICE_IDLE;  // Reset state machine
     ledFeedback.showIdle();
     
+    // Publish audio quality metrics next to the transcription
+    const UtteranceMetrics* metrics = audioMetrics.attachResult(transcription, error);
+    if (metrics) {
+        mqttClient.publishVoiceMetrics(*metrics);
+        utteranceArchive.submit(haAssist.getRecordedAudio(), haAssist.getRecordedSamples(),
+                                *metrics, haAssist.getLastSttMs());
+    }
+    
     if (error) {
         Serial.printf("❌ Assist error: %s\n", error);
         lvglUI.showVoicePopup("Error", error);
@@ -472,50 +598,63 @@ void onAssistResult(const char* transcription, const char* response, const char*
     popupShouldAutoHide = true;
 }
 
-// Helper to calculate max audio level in buffer
-int16_t getMaxAudioLevel(int16_t* buffer, size_t samples) {
-    int16_t maxLevel = 0;
-    for (size_t i = 0; i < samples; i++) {
-        int16_t absVal = abs(buffer[i]);
-        if (absVal > maxLevel) maxLevel = absVal;
-    }
-    return maxLevel;
+// Voice trigger and voice button: wait for speech with the recorder and
+// the utterance metrics running from the start
+void startListening() {
+    // Clear auto-hide flag AND timer immediately
+    popupShouldAutoHide = false;
+    popupHideTime = 0;
+    
+    voiceState = VOICE_WAITING_SPEECH;
+    voiceStateStartTime = millis();
+    silenceStartTime = 0;
+    
+    // Reset audio monitoring
+    totalAudioSamples = 0;
+    maxAudioLevel = 0;
+    sumAbsAudioLevel = 0;
+    lastAudioLevelLog = millis();
+    
+    // Start recording (to capture from beginning)
+    haAssist.startRecording();
+    audioMetrics.beginUtterance(micCalibration.getThresholds().silence);
+    
+    // Show popup, level meter and LED
+    lvglUI.showVoicePopup("Listening...", "Speak now");
+    lvglUI.setVoiceLevelMeter(true);
+    ledFeedback.showListening();
 }
 
 void handleVoiceRecognition() {
     unsigned long now = millis();
     
-    // Read audio samples (always, for both detection and recording)
-    int16_t audioBuffer[512];
-    size_t samplesRead = audioHandler.readAudio(audioBuffer, 512);
+    // Run one frame through the audio pipeline (source -> ... -> recorder).
+    // The VAD stage may only trigger while idle and not calibrating.
+    static AudioFrame frame;
+    frame.vadArmed = (voiceState == VOICE_IDLE) && !micCalibration.isRunning();
     
-    if (samplesRead == 0) {
+    if (!audioPipeline.run(frame)) {
         return;
     }
     
-    // Calculate current audio level
-    int16_t currentLevel = getMaxAudioLevel(audioBuffer, samplesRead);
+    size_t samplesRead = frame.count;
+    int16_t currentLevel = frame.peak;
+    audioHandler.publishLevel(currentLevel);  // For the popup level meter
+    const VoiceThresholds& thresholds = micCalibration.getThresholds();
     
     switch (voiceState) {
         case VOICE_IDLE: {
+            // Calibration owns the microphone while it runs
+            if (micCalibration.isRunning()) {
+                micCalibration.processFrame(currentLevel);
+                break;
+            }
+            micCalibration.trackDrift(currentLevel);
+            
             // Check for voice activity trigger (loud sound)
-            if (voiceActivity.processAudioFrame(audioBuffer, samplesRead)) {
+            if (frame.vadTriggered) {
                 // Triggered! Start waiting for speech
-                voiceState = VOICE_WAITING_SPEECH;
-                voiceStateStartTime = now;
-                
-                // Show popup immediately
-                lvglUI.showVoicePopup("Listening...", "Speak now");
-                ledFeedback.showListening();
-                
-                // Reset audio monitoring
-                totalAudioSamples = 0;
-                maxAudioLevel = 0;
-                sumAbsAudioLevel = 0;
-                lastAudioLevelLog = now;
-                
-                // Start recording (to capture from beginning)
-                haAssist.startRecording();
+                startListening();
                 
                 Serial.println("\n═══════════════════════════════════");
                 Serial.println("🎤 TRIGGERED! Waiting for speech...");
@@ -529,8 +668,7 @@ void handleVoiceRecognition() {
         }
         
         case VOICE_WAITING_SPEECH: {
-            // Feed audio to recorder (capturing everything from trigger)
-            haAssist.feedAudio(audioBuffer, samplesRead);
+            // Audio is fed to the recorder by the pipeline (capturing everything from trigger)
             totalAudioSamples += samplesRead;
             
             // Don't track maxAudioLevel here - only track during actual RECORDING
@@ -546,7 +684,7 @@ void handleVoiceRecognition() {
             }
             
             // After cooldown, check if speech started (audio above threshold)
-            if (currentLevel > SPEECH_THRESHOLD) {
+            if (currentLevel > thresholds.speech) {
                 voiceState = VOICE_RECORDING;
                 lastSpeechTime = now;
                 silenceStartTime = 0;
@@ -572,8 +710,7 @@ void handleVoiceRecognition() {
         }
         
         case VOICE_RECORDING: {
-            // Feed audio to recorder
-            haAssist.feedAudio(audioBuffer, samplesRead);
+            // Audio is fed to the recorder by the pipeline
             totalAudioSamples += samplesRead;
             
             // Track max level for stats
@@ -587,7 +724,7 @@ void handleVoiceRecognition() {
             }
             
             // Check for speech vs silence
-            if (currentLevel > SILENCE_THRESHOLD) {
+            if (currentLevel > thresholds.silence) {
                 // Still speaking (or at least some audio)
                 lastSpeechTime = now;
                 silenceStartTime = 0;
@@ -617,8 +754,8 @@ void handleVoiceRecognition() {
                 }
                 
                 // Check if recording had actual speech (not just silence)
-                if (maxAudioLevel < MIN_SPEECH_LEVEL) {
-                    Serial.printf("⚠️  No speech detected in recording (max level %ld < %d), cancelling...\n", maxAudioLevel, MIN_SPEECH_LEVEL);
+                if (maxAudioLevel < thresholds.minSpeech) {
+                    Serial.printf("⚠️  No speech detected in recording (max level %ld < %d), cancelling...\n", maxAudioLevel, thresholds.minSpeech);
                     haAssist.cancelRecording();  // Discard audio, don't send to STT
                     lvglUI.hideVoicePopup();
                     ledFeedback.showIdle();
@@ -632,6 +769,7 @@ void handleVoiceRecognition() {
                 } else {
                     // Process the recording
                     voiceState = VOICE_PROCESSING;
+                    lvglUI.setVoiceLevelMeter(false);
                     lvglUI.updateVoicePopupText("Processing...", "");
                     ledFeedback.showProcessing();
                     haAssist.stopAndProcess();
@@ -648,89 +786,81 @@ void handleVoiceRecognition() {
     }
 }
 
-// Normalize command text to handle common speech recognition errors
-String normalizeCommand(const char* rawCommand) {
-    String cmd = String(rawCommand);
-    cmd.toLowerCase();
-    cmd.trim();
+void processVoiceCommand(const char* command) {
+    Serial.printf("Raw command: %s\n", command);
     
-    // Common mishearings for "gate"
-    cmd.replace("open date", "open gate");
-    cmd.replace("open this", "open gate");
-    cmd.replace("open gate", "open gate");
-    cmd.replace("open the gate", "open gate");
-    cmd.replace("opened", "open gate");
-    cmd.replace("opengate", "open gate");
+    // Update sensors with original command
+    homeAssistant.updateVoiceCommandSensor(command);
     
-    // Common mishearings for "garage"
-    cmd.replace("garage door", "garage");
-    cmd.replace("the garage", "garage");
+    // Race the local command engine against the HA conversation agent;
+    // the outcome arrives in onIntentResult()
+    intentDispatcher.dispatch(command);
+}
+
+void onIntentResult(const IntentResult& result) {
+    const char* command = result.text;
+    
+    if (result.path == INTENT_PATH_NONE && result.noAnswer) {
+        Serial.println("→ No answer from Home Assistant");
+        mqttClient.publishCommandExecuted(command, "no_answer");
+        lvglUI.updateVoicePopupText(command, "No answer from Home Assistant");
+    } else if (result.path == INTENT_PATH_NONE) {
+        Serial.println("→ Command not recognized");
+        mqttClient.publishCommandExecuted(command, "not_recognized");
+    } else if (result.path == INTENT_PATH_HA) {
+        Serial.printf("→ Handled by Home Assistant after %lu ms\n", (unsigned long)result.latencyMs);
+        mqttClient.publishCommandExecuted(command, "success");
+    } else {
+        Serial.printf("→ Command %d (confidence %.2f%s)%s\n", result.commandId, result.confidence,
+                      result.cached ? ", cached" : "",
+                      result.duplicate ? " (duplicate)" : result.success ? "" : " (failed)");
+        if (result.duplicate) {
+            mqttClient.publishCommandExecuted(command, "duplicate");
+        } else if (!result.success || result.actionId == 0) {
+            // Queued actions report in onActionComplete()
+            mqttClient.publishCommandExecuted(command, result.success ? "success" : "failed");
+        }
+    }
     
-    // Clean up extra spaces
-    while (cmd.indexOf("  ") >= 0) {
-        cmd.replace("  ", " ");
+    if (!result.reply.isEmpty()) {
+        Serial.printf("  %s\n", result.reply.c_str());
+        lvglUI.updateVoicePopupText(command, result.reply.c_str());
     }
     
-    return cmd;
+    webServer.broadcastMessage("command_executed", command);
 }
 
-void processVoiceCommand(const char* command) {
-    Serial.printf("Raw command: %s\n", command);
-    
-    // Normalize the command first
-    String normalized = normalizeCommand(command);
-    Serial.printf("Normalized: %s\n", normalized.c_str());
+void onActionComplete(const ActionOutcome& outcome, void* ctx) {
+    Serial.printf("→ Action %lu \"%s\" %s: %u/%u entities, %u attempts, %lu ms\n",
+                  (unsigned long)outcome.id, outcome.label, outcome.success ? "done" : "failed",
+                  outcome.actions - outcome.failed, outcome.actions, outcome.attempts,
+                  (unsigned long)outcome.latencyMs);
+    mqttClient.publishCommandExecuted(outcome.label, outcome.success ? "success" : "failed");
+}
+
+String answerCommandQuery(const char* query) {
+    char text[64];
     
-    // Update sensors with original command
-    homeAssistant.updateVoiceCommandSensor(command);
-    mqttClient.publishCommandExecuted(command, "success");
-    
-    // Parse and execute normalized command
-    String cmd = normalized;
-    
-    if (cmd.indexOf("light") >= 0) {
-        if (cmd.indexOf("on") >= 0) {
-            Serial.println("→ Turning lights ON");
-            homeAssistant.controlLight("living_room", true);
-        } else if (cmd.indexOf("off") >= 0) {
-            Serial.println("→ Turning lights OFF");
-            homeAssistant.controlLight("living_room", false);
-        }
-    }
-    else if (cmd.indexOf("gate") >= 0 || cmd.indexOf("garage") >= 0) {
-        if (cmd.indexOf("open") >= 0) {
-            Serial.println("→ Opening gate/garage");
-            homeAssistant.controlCover("garage_door", "open");
-        } else if (cmd.indexOf("close") >= 0) {
-            Serial.println("→ Closing gate/garage");
-            homeAssistant.controlCover("garage_door", "close");
-        } else {
-            Serial.println("→ Toggling gate/garage");
-            homeAssistant.controlCover("garage_door", "toggle");
+    if (strcmp(query, "time") == 0) {
+        time_t now = time(nullptr);
+        if (now < 1000000000) {
+            return "Time not synced yet";
         }
+        struct tm* timeinfo = localtime(&now);
+        strftime(text, sizeof(text), "It's %H:%M", timeinfo);
+        return String(text);
     }
-    else if (cmd.indexOf("lock") >= 0 || cmd.indexOf("door") >= 0) {
-        if (cmd.indexOf("lock") >= 0) {
-            Serial.println("→ Locking door");
-            homeAssistant.controlLock("front_door", true);
-        } else if (cmd.indexOf("unlock") >= 0) {
-            Serial.println("→ Unlocking door");
-            homeAssistant.controlLock("front_door", false);
+    
+    if (strcmp(query, "weather") == 0) {
+        if (lastWeatherState.isEmpty()) {
+            return "No weather data yet";
         }
-    }
-    else if (cmd.indexOf("good night") >= 0) {
-        Serial.println("→ Activating Good Night scene");
-        homeAssistant.activateScene("good_night");
-    }
-    else if (cmd.indexOf("welcome home") >= 0) {
-        Serial.println("→ Activating Welcome Home scene");
-        homeAssistant.activateScene("welcome_home");
-    }
-    else {
-        Serial.println("→ Command not recognized");
+        snprintf(text, sizeof(text), "%.1f°C, %s", lastWeatherTemp, lastWeatherState.c_str());
+        return String(text);
     }
     
-    webServer.broadcastMessage("command_executed", command);
+    Serial.printf("Unknown query: %s\n", query);
+    return "";
 }
 
 void handleMqttMessages(const char* topic, const char* payload) {
@@ -740,14 +870,17 @@ void handleMqttMessages(const char* topic, const char* payload) {
     
     // Handle remote commands
     if (topicStr.equals("entryhub/command")) {
-        processVoiceCommand(payload);
+        // Processed on the next loop pass so this callback returns immediately
+        if (!actionExecutor.defer(payload)) {
+            Serial.println("Command queue full, dropped");
+        }
     }
     // Handle configuration updates
     else if (topicStr.equals("entryhub/config")) {
         JsonDocument doc;
         DeserializationError error = deserializeJson(doc, payload);
         if (!error) {
-            storage.saveConfig(doc);
+            configService.save(doc);
             Serial.println("Configuration updated via MQTT");
         }
     }
@@ -758,6 +891,16 @@ void handleMqttMessages(const char* topic, const char* payload) {
     }
 }
 
+// This boot's task timings, reset reason and the last few boots
+void publishBootReport() {
+    JsonDocument doc;
+    doc["device"] = DEVICE_NAME;
+    doc["finished_us"] = bootSequencer.getFinishedUs();
+    bootSequencer.getTimingsJson(doc["tasks"].to<JsonObject>());
+    bootProfiler.getStatusJson(doc.as<JsonObject>(), BOOT_MQTT_HISTORY);
+    mqttClient.publishBootReport(doc);
+}
+
 void publishSystemStatus() {
     if (!mqttClient.isConnected()) {
         return;
@@ -797,8 +940,14 @@ void publishSystemStatus() {
     webServer.broadcastStatus(doc);
 }
 
-void testIntegrationsOnStartup(JsonDocument& config) {
+// Runs on a boot worker: reads the snapshot, probes, and writes only the
+// status fields back, so saves made meanwhile by the main loop are kept
+void testIntegrationsOnStartup() {
     Serial.println("Starting integration tests...");
+    ConfigRef snapshot = configService.get();
+    JsonVariantConst config = snapshot->json;
+    const char* haStatus = nullptr;
+    const char* weatherStatus = nullptr;
     
     // Test Home Assistant integration
     if (config["integrations"]["home_assistant"]["enabled"] == true) {
@@ -806,30 +955,27 @@ void testIntegrationsOnStartup(JsonDocument& config) {
         const char* haToken = config["integrations"]["home_assistant"]["token"];
         
         if (haUrl && strlen(haUrl) > 0 && haToken && strlen(haToken) > 0) {
-            Serial.print("\n  → Home Assistant... ");
-            
-            HTTPClient http;
             String url = String(haUrl);
             if (!url.endsWith("/")) url += "/";
             url += "api/";
             
-            http.begin(url);
-            http.addHeader("Authorization", String("Bearer ") + haToken);
-            http.setTimeout(5000);
-            
+            HARequest http(url, haToken);
             int httpCode = http.GET();
+            if (httpCode == 200) {
+                http.getString();   // Leaves the connection reusable
+            }
             http.end();
             
             if (httpCode == 200) {
-                Serial.print("✓ Connected");
-                config["integrations"]["home_assistant"]["status"] = "connected";
+                Serial.println("  → Home Assistant... ✓ Connected");
+                haStatus = "connected";
             } else {
-                Serial.printf("✗ Failed (HTTP %d)", httpCode);
-                config["integrations"]["home_assistant"]["status"] = "failed";
+                Serial.printf("  → Home Assistant... ✗ Failed (HTTP %d)\n", httpCode);
+                haStatus = "failed";
             }
         } else {
-            Serial.print("\n  → Home Assistant... ⚠️ Not configured");
-            config["integrations"]["home_assistant"]["status"] = "not_configured";
+            Serial.println("  → Home Assistant... ⚠️ Not configured");
+            haStatus = "not_configured";
         }
     }
     
@@ -839,8 +985,6 @@ void testIntegrationsOnStartup(JsonDocument& config) {
         const char* location = config["weather"]["location"];
         
         if (apiKey && strlen(apiKey) > 0 && location && strlen(location) > 0) {
-            Serial.print("\n  → OpenWeatherMap... ");
-            
             HTTPClient http;
             String url = "http://api.openweathermap.org/data/2.5/weather?q=";
             url += location;
@@ -854,342 +998,552 @@ void testIntegrationsOnStartup(JsonDocument& config) {
             http.end();
             
             if (httpCode == 200) {
-                Serial.print("✓ Connected");
-                config["weather"]["status"] = "connected";
+                Serial.println("  → OpenWeatherMap... ✓ Connected");
+                weatherStatus = "connected";
             } else {
-                Serial.printf("✗ Failed (HTTP %d)", httpCode);
-                config["weather"]["status"] = "failed";
+                Serial.printf("  → OpenWeatherMap... ✗ Failed (HTTP %d)\n", httpCode);
+                weatherStatus = "failed";
             }
         } else {
-            Serial.print("\n  → OpenWeatherMap... ⚠️ Not configured");
-            config["weather"]["status"] = "not_configured";
+            Serial.println("  → OpenWeatherMap... ⚠️ Not configured");
+            weatherStatus = "not_configured";
         }
     } else if (config["weather"]["provider"] == "homeassistant") {
         // Weather from HA - depends on HA connection
-        config["weather"]["status"] = config["integrations"]["home_assistant"]["status"];
+        weatherStatus = haStatus;
     }
+    snapshot.reset();
     
     // Save updated config with status
-    storage.saveConfig(config);
+    for (int attempt = 0; attempt < 3; attempt++) {
+        JsonDocument doc;
+        uint32_t generation;
+        if (!configService.copy(doc, &generation)) {
+            return;
+        }
+        if (haStatus) doc["integrations"]["home_assistant"]["status"] = haStatus;
+        if (weatherStatus) doc["weather"]["status"] = weatherStatus;
+        if (configService.save(doc, generation)) {
+            return;
+        }
+    }
+    log_w("Integration status not saved: config kept changing");
 }
 
-void updateWeatherDisplay() {
-    // Fetch weather from Home Assistant
-    JsonDocument config;
-    if (!storage.loadConfig(config)) {
-        log_e("Failed to load config for weather");
-        return;
+// Gate tile state for a cover, lock or binary sensor: 1 open, 0 closed, -1 unknown
+static int gateOpenState(const char* state) {
+    if (strcmp(state, "open") == 0 || strcmp(state, "opening") == 0 || strcmp(state, "closing") == 0 ||
+        strcmp(state, "on") == 0 || strcmp(state, "unlocked") == 0) {
+        return 1;
     }
-    
-    const char* provider = config["weather"]["provider"] | "none";
-    if (strcmp(provider, "homeassistant") != 0) {
-        log_i("Weather provider not Home Assistant, skipping");
-        return;
+    if (strcmp(state, "closed") == 0 || strcmp(state, "off") == 0 || strcmp(state, "locked") == 0) {
+        return 0;
     }
-    
-    const char* haUrl = config["integrations"]["home_assistant"]["url"];
-    const char* haToken = config["integrations"]["home_assistant"]["token"];
-    const char* entityId = config["weather"]["home_assistant"]["entity_id"] | "weather.forecast_home";
-    
-    if (!haUrl || strlen(haUrl) == 0 || !haToken || strlen(haToken) == 0) {
-        log_e("Home Assistant not configured for weather");
-        return;
+    return -1;
+}
+
+// One HA state refresh: what was asked for, with the config it was built
+// from, so the result is applied against the same entities
+struct StateFetch {
+    ConfigRef config;
+    const char* weatherId;
+    bool presence;
+    bool timezone;
+    bool ok;
+};
+
+// Filled by fetchHomeAssistantStates(), possibly on the scheduler's worker
+// task, and applied by the main loop. A few KB, so not on a task's stack.
+static StateFetch stateFetch;
+static HAStateBatch stateBatch;
+
+static bool fetchHomeAssistantStates(bool weather, bool presence, bool timezone) {
+    StateFetch& f = stateFetch;
+    HAStateBatch& batch = stateBatch;
+    f.config = configService.get();
+    f.ok = false;
+    const ConfigSnapshot* config = f.config.get();
+    if (!config->haConfigured) {
+        log_e("Home Assistant not configured for states");
+        return false;
     }
-    
-    // Build URL
-    String url = String(haUrl);
-    if (!url.endsWith("/")) url += "/";
-    url += "api/states/";
-    url += entityId;
-    
-    // Make HTTP request
-    HTTPClient http;
-    http.begin(url);
-    http.addHeader("Authorization", String("Bearer ") + haToken);
-    http.setTimeout(5000);
-    
-    int httpCode = http.GET();
-    
-    if (httpCode == 200) {
-        String payload = http.getString();
-        http.end();
-        
-        JsonDocument haDoc;
-        DeserializationError error = deserializeJson(haDoc, payload);
-        
-        if (!error) {
-            float temp = haDoc["attributes"]["temperature"] | 0.0f;
-            const char* state = haDoc["state"] | "unknown";
-            
-            log_i("Weather updated: %.1f°C, %s", temp, state);
-            
-            // Only update if we have valid data
-            if (temp != 0.0f || strcmp(state, "unknown") != 0) {
-                lvglUI.updateWeather(temp, state);
-            } else {
-                log_w("Weather data incomplete, skipping update");
-            }
-        } else {
-            log_e("Failed to parse weather JSON: %s", error.c_str());
+
+    batch.clear();
+    batch.addAttribute("friendly_name");
+    batch.addAttribute("temperature");
+
+    f.weatherId = nullptr;
+    if (weather && config->weatherProvider == "homeassistant") {
+        f.weatherId = config->weatherEntity.c_str();
+        batch.addEntity(f.weatherId);
+    }
+
+    int personCount = min(config->presenceCount, MAX_PEOPLE);
+    const char* gateId = config->gateEntity.c_str();
+    f.presence = presence;
+    if (presence) {
+        for (int i = 0; i < personCount; i++) {
+            batch.addEntity(config->presenceEntities[i].c_str());
+        }
+        if (*gateId) {
+            batch.addEntity(gateId);
         }
-    } else {
-        http.end();
-        log_e("Failed to fetch weather from HA: HTTP %d", httpCode);
     }
-}
 
-void updatePresenceDisplay() {
-    // Load config to get HA settings
-    JsonDocument config;
-    if (!storage.loadConfig(config)) {
-        log_e("Failed to load config for presence");
-        return;
+    f.timezone = timezone;
+    if (timezone) {
+        // now() is in HA's configured zone; its tzinfo renders as the IANA name
+        batch.addValue("time_zone", "now().tzinfo");
     }
-    
-    const char* haUrl = config["integrations"]["home_assistant"]["url"];
-    const char* haToken = config["integrations"]["home_assistant"]["token"];
-    
-    if (!haUrl || strlen(haUrl) == 0 || !haToken || strlen(haToken) == 0) {
-        log_e("Home Assistant not configured for presence");
-        return;
+
+    if (batch.isEmpty()) {
+        return false;
     }
-    
-    // Check if person tracking is configured
-    if (!config["presence"]["home_assistant"]["entity_ids"].is<JsonArray>()) {
-        log_w("No person entities configured");
-        return;
+
+    if (!haBatch.fetch(batch, config->haUrl.c_str(), config->haToken.c_str())) {
+        log_e("Failed to fetch HA states: HTTP %d", haBatch.getLastHttpCode());
+        return false;
     }
-    
-    JsonArray entityIds = config["presence"]["home_assistant"]["entity_ids"].as<JsonArray>();
-    if (entityIds.size() == 0) {
-        log_w("No person entities configured");
+    f.ok = true;
+    return true;
+}
+
+static void applyHomeAssistantStates() {
+    StateFetch& f = stateFetch;
+    HAStateBatch& batch = stateBatch;
+    if (!f.ok) {
         return;
     }
-    
-    // Fetch each person entity from Home Assistant
-    int personIndex = 0;
-    for (JsonVariant entityId : entityIds) {
-        if (personIndex >= MAX_PEOPLE) break;
-        
-        String url = String(haUrl);
-        if (!url.endsWith("/")) url += "/";
-        url += "api/states/";
-        url += entityId.as<String>();
-        
-        HTTPClient http;
-        http.begin(url);
-        http.addHeader("Authorization", String("Bearer ") + haToken);
-        http.setTimeout(3000);
-        
-        int httpCode = http.GET();
-        
-        if (httpCode == 200) {
-            String payload = http.getString();
-            JsonDocument personDoc;
-            deserializeJson(personDoc, payload);
-            
-            // Extract person name
-            String name;
-            if (personDoc["attributes"]["friendly_name"]) {
-                name = personDoc["attributes"]["friendly_name"].as<String>();
+    f.ok = false;
+    const ConfigSnapshot* config = f.config.get();
+
+    if (f.weatherId) {
+        const HABatchEntity* e = batch.find(f.weatherId);
+        if (e && e->found) {
+            float temp = atof(batch.getAttribute(*e, "temperature"));
+            log_i("Weather updated: %.1f°C, %s", temp, e->state);
+
+            // Only update if we have valid data
+            if (temp != 0.0f || strcmp(e->state, "unknown") != 0) {
+                lvglUI.updateWeather(temp, e->state);
+                lastWeatherTemp = temp;
+                lastWeatherState = e->state;
             } else {
-                String entityIdStr = entityId.as<String>();
-                name = entityIdStr.substring(entityIdStr.indexOf('.') + 1);
+                log_w("Weather data incomplete, skipping update");
+            }
+        }
+    }
+
+    if (f.presence) {
+        int personCount = min(config->presenceCount, MAX_PEOPLE);
+        int personIndex = 0;
+        for (int i = 0; i < presenceEntityCount; i++) {
+            presenceCards[i] = -1;
+        }
+        for (int i = 0; i < personCount; i++) {
+            const HABatchEntity* e = batch.find(config->presenceEntities[i].c_str());
+            if (!e || !e->found) continue;
+
+            String name = batch.getAttribute(*e, "friendly_name");
+            if (name.isEmpty()) {
+                name = e->entityId;
+                name = name.substring(name.indexOf('.') + 1);
                 if (name.length() > 0) name[0] = toupper(name[0]);
             }
-            
-            // Check if person is home
-            bool present = (personDoc["state"].as<String>() == "home");
-            
+
+            bool present = strcmp(e->state, "home") == 0;
             lvglUI.updatePersonPresence(personIndex, name.c_str(), present, 0x00FF00);
+            for (int j = 0; j < presenceEntityCount; j++) {
+                if (presenceEntities[j] == e->entityId) {
+                    presenceCards[j] = personIndex;
+                }
+            }
             personIndex++;
         }
-        
-        http.end();
+
+        const char* gateId = config->gateEntity.c_str();
+        const HABatchEntity* gate = *gateId ? batch.find(gateId) : nullptr;
+        int open = gate && gate->found ? gateOpenState(gate->state) : -1;
+        if (open >= 0) {
+            lvglUI.updateGateStatus(open == 1);
+        }
+    }
+
+    if (f.timezone) {
+        const char* tz = batch.getValue("time_zone");
+        if (tz && *tz) {
+            applyTimezone(tz);
+        } else {
+            log_w("No timezone from HA");
+        }
     }
 }
 
-void setTimezoneFromHA() {
+void applyTimezone(const char* timezone) {
+    const char* posixTz = tzLookup(timezone);
+    if (!posixTz) {
+        // Newer than the table, or not an IANA name. Not cached.
+        if (timezoneSet) {
+            log_w("Unknown timezone %s (tzdata %s), keeping the current one", timezone, tzDataVersion());
+        } else {
+            log_w("Unknown timezone %s (tzdata %s), using UTC", timezone, tzDataVersion());
+            setenv("TZ", "UTC0", 1);
+            tzset();
+            timezoneSet = true;
+        }
+        return;
+    }
+
+    setenv("TZ", posixTz, 1);
+    tzset();
+    timezoneSet = true;
+    log_i("Timezone set to: %s (POSIX: %s)", timezone, posixTz);
+
+    // Cache it for the next boot; written only when HA's zone changes
+    ConfigRef current = configService.get();
+    JsonVariantConst device = current->json["device"];
+    if (strcmp(device["timezone"] | "", timezone) == 0 && strcmp(device["posix_tz"] | "", posixTz) == 0) {
+        return;
+    }
     JsonDocument config;
-    if (!storage.loadConfig(config)) {
-        log_e("Failed to load config for timezone");
+    uint32_t generation;
+    if (configService.copy(config, &generation)) {
+        config["device"]["timezone"] = timezone;
+        config["device"]["posix_tz"] = posixTz;
+        configService.save(config, generation);
+    }
+}
+
+// Calendar events as they stream in from /api/calendars/<entity>
+struct CalendarScan {
+    CalendarEvent events[MAX_CALENDAR_EVENTS];
+    int count;
+    char summary[sizeof(CalendarEvent::title)];
+    char start[32];             // dateTime, or date for all-day events
+    int todayDay;
+    int tomorrowDay;
+};
+
+static void onCalendarValue(JsonStreamParser& parser, JsonStreamType type, const char* value, size_t len, void* ctx) {
+    CalendarScan& scan = *(CalendarScan*)ctx;
+    if (type != JSON_STREAM_STRING) {
         return;
     }
-    
-    const char* haUrl = config["integrations"]["home_assistant"]["url"];
-    const char* haToken = config["integrations"]["home_assistant"]["token"];
-    
-    if (!haUrl || strlen(haUrl) == 0 || !haToken || strlen(haToken) == 0) {
-        log_e("Home Assistant not configured for timezone");
+    if (parser.match("[*].summary")) {
+        strlcpy(scan.summary, value, sizeof(scan.summary));
+    } else if (parser.match("[*].start.dateTime") || (parser.match("[*].start.date") && !scan.start[0])) {
+        strlcpy(scan.start, value, sizeof(scan.start));
+    }
+}
+
+static void onCalendarClose(JsonStreamParser& parser, void* ctx) {
+    CalendarScan& scan = *(CalendarScan*)ctx;
+    if (!parser.match("[*]")) {
         return;
     }
     
-    // Fetch HA config to get timezone
-    String url = String(haUrl);
-    if (!url.endsWith("/")) url += "/";
-    url += "api/config";
-    
-    HTTPClient http;
-    http.begin(url);
-    http.addHeader("Authorization", String("Bearer ") + haToken);
-    http.setTimeout(5000);
+    CalendarEvent& event = scan.events[scan.count++];
+    const char* start = scan.start;
     
-    int httpCode = http.GET();
+    // Copy title
+    strlcpy(event.title, scan.summary[0] ? scan.summary : "Event", sizeof(event.title));
     
-    if (httpCode == 200) {
-        String payload = http.getString();
-        JsonDocument haConfig;
-        DeserializationError error = deserializeJson(haConfig, payload);
+    // Determine day and extract time
+    if (strlen(start) >= 10) {
+        // Extract day from date (YYYY-MM-DD)
+        int eventDay = atoi(start + 8);
+        const char* dayLabel = "";
         
-        if (!error) {
-            const char* timezone = haConfig["time_zone"];
-            if (timezone && strlen(timezone) > 0) {
-                // Convert timezone name to POSIX format
-                // Most common European timezones
-                String tz = String(timezone);
-                String posixTz;
-                
-                if (tz == "Europe/Riga" || tz == "Europe/Helsinki" || tz == "Europe/Athens") {
-                    posixTz = "EET-2EEST,M3.5.0/3,M10.5.0/4";
-                } else if (tz == "Europe/London") {
-                    posixTz = "GMT0BST,M3.5.0/1,M10.5.0";
-                } else if (tz == "Europe/Berlin" || tz == "Europe/Paris" || tz == "Europe/Rome") {
-                    posixTz = "CET-1CEST,M3.5.0,M10.5.0/3";
-                } else if (tz == "America/New_York") {
-                    posixTz = "EST5EDT,M3.2.0,M11.1.0";
-                } else if (tz == "America/Los_Angeles") {
-                    posixTz = "PST8PDT,M3.2.0,M11.1.0";
-                } else {
-                    // Default to UTC if unknown
-                    posixTz = "UTC0";
-                    log_w("Unknown timezone %s, using UTC", timezone);
-                }
-                
-                setenv("TZ", posixTz.c_str(), 1);
-                tzset();
-                timezoneSet = true;
-                log_i("Timezone set to: %s (POSIX: %s)", timezone, posixTz.c_str());
-            } else {
-                log_w("No timezone in HA config");
-            }
+        if (eventDay == scan.todayDay) {
+            dayLabel = "TODAY";
+        } else if (eventDay == scan.tomorrowDay) {
+            dayLabel = "TOMORROW";
+        }
+        
+        // Check if it's a datetime or just date
+        if (strchr(start, 'T') && strlen(start) >= 16) {
+            // Has time component
+            snprintf(event.time, sizeof(event.time), "%s %.2s:%.2s", dayLabel, start + 11, start + 14);
         } else {
-            log_e("Failed to parse HA config");
+            // All-day event
+            snprintf(event.time, sizeof(event.time), "%s All day", dayLabel);
         }
     } else {
-        log_e("Failed to fetch HA config: HTTP %d", httpCode);
+        strcpy(event.time, "");
     }
     
-    http.end();
+    scan.summary[0] = '\0';
+    scan.start[0] = '\0';
+    if (scan.count == MAX_CALENDAR_EVENTS) {
+        // The rest of the body is drained unparsed
+        parser.stop();
+    }
 }
 
-void updateCalendarDisplay() {
-    JsonDocument config;
-    if (!storage.loadConfig(config)) {
-        log_e("Failed to load config for calendar");
-        return;
-    }
-    
-    const char* haUrl = config["integrations"]["home_assistant"]["url"];
-    const char* haToken = config["integrations"]["home_assistant"]["token"];
-    const char* entityId = config["integrations"]["calendar"]["home_assistant"]["entity_id"] | "calendar.family";
-    
-    if (!haUrl || strlen(haUrl) == 0 || !haToken || strlen(haToken) == 0) {
-        return;
+// Filled by fetchCalendar(), possibly on the scheduler's worker task, and
+// shown by the main loop
+static CalendarScan calendarScan;
+
+static bool fetchCalendar() {
+    ConfigRef config = configService.get();
+    if (!config->haConfigured) {
+        return false;
     }
     
     // Build URL for calendar events
-    String url = String(haUrl);
+    String url = config->haUrl;
     if (!url.endsWith("/")) url += "/";
     url += "api/calendars/";
-    url += entityId;
+    url += config->calendarEntity;
     
-    // Get events for today only
+    // Get events for today only (localtime_r: this may run off the main loop)
     time_t now = time(nullptr);
-    struct tm* timeinfo = localtime(&now);
+    struct tm today;
+    localtime_r(&now, &today);
     
     char startDate[12];
     char endDate[12];
     
     // Start: today at 00:00
     snprintf(startDate, sizeof(startDate), "%04d-%02d-%02d",
-             timeinfo->tm_year + 1900, timeinfo->tm_mon + 1, timeinfo->tm_mday);
+             today.tm_year + 1900, today.tm_mon + 1, today.tm_mday);
     
     // End: day after tomorrow at 00:00 (to include tomorrow's events)
     time_t endTime = now + (2 * 24 * 60 * 60);
-    struct tm* endTimeinfo = localtime(&endTime);
+    struct tm end;
+    localtime_r(&endTime, &end);
     snprintf(endDate, sizeof(endDate), "%04d-%02d-%02d",
-             endTimeinfo->tm_year + 1900, endTimeinfo->tm_mon + 1, endTimeinfo->tm_mday);
+             end.tm_year + 1900, end.tm_mon + 1, end.tm_mday);
     
     url += "?start=";
     url += startDate;
     url += "&end=";
     url += endDate;
     
-    HTTPClient http;
-    http.begin(url);
-    http.addHeader("Authorization", String("Bearer ") + haToken);
-    http.setTimeout(5000);
+    HARequest http(url, config->haToken.c_str());
     
     int httpCode = http.GET();
+    bool ok = false;
     
     if (httpCode == 200) {
-        String payload = http.getString();
-        JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, payload);
+        // Parsed as it arrives; descriptions and the rest are never stored
+        CalendarScan& scan = calendarScan;
+        memset(&scan, 0, sizeof(scan));
         
-        if (!error) {
-            JsonArray haEvents = doc.as<JsonArray>();
-            int eventCount = min((int)haEvents.size(), MAX_CALENDAR_EVENTS);
-            CalendarEvent events[MAX_CALENDAR_EVENTS];
-            
-            // Get today's and tomorrow's dates for comparison
-            int todayDay = timeinfo->tm_mday;
-            time_t tomorrow = now + (24 * 60 * 60);
-            struct tm* tomorrowInfo = localtime(&tomorrow);
-            int tomorrowDay = tomorrowInfo->tm_mday;
-            
-            for (int i = 0; i < eventCount; i++) {
-                JsonObject event = haEvents[i];
-                const char* summary = event["summary"] | "Event";
-                const char* start = event["start"]["dateTime"] | event["start"]["date"];
-                
-                // Copy title
-                strncpy(events[i].title, summary, sizeof(events[i].title) - 1);
-                events[i].title[sizeof(events[i].title) - 1] = '\0';
-                
-                // Determine day and extract time
-                if (start && strlen(start) >= 10) {
-                    // Extract day from date (YYYY-MM-DD)
-                    int eventDay = atoi(start + 8);
-                    const char* dayLabel = "";
-                    
-                    if (eventDay == todayDay) {
-                        dayLabel = "TODAY";
-                    } else if (eventDay == tomorrowDay) {
-                        dayLabel = "TOMORROW";
-                    }
-                    
-                    // Check if it's a datetime or just date
-                    if (strchr(start, 'T') && strlen(start) >= 16) {
-                        // Has time component
-                        snprintf(events[i].time, sizeof(events[i].time), "%s %.2s:%.2s", 
-                                dayLabel, start + 11, start + 14);
-                    } else {
-                        // All-day event
-                        snprintf(events[i].time, sizeof(events[i].time), "%s All day", dayLabel);
-                    }
-                } else {
-                    strcpy(events[i].time, "");
-                }
-            }
-            
-            lvglUI.updateCalendar(events, eventCount);
-        } else {
-            log_e("Failed to parse calendar response: %s", error.c_str());
+        // Today's and tomorrow's dates for comparison
+        scan.todayDay = today.tm_mday;
+        time_t tomorrow = now + (24 * 60 * 60);
+        struct tm next;
+        localtime_r(&tomorrow, &next);
+        scan.tomorrowDay = next.tm_mday;
+        
+        JsonStreamParser parser;
+        parser.begin(onCalendarValue, onCalendarClose, &scan);
+        ok = http.readJson(parser);
+        if (!ok) {
+            log_e("Failed to parse calendar response: %s", parser.getError() ? parser.getError() : "connection lost");
         }
     } else {
         log_e("Failed to fetch calendar from HA: HTTP %d", httpCode);
     }
     
     http.end();
-}
\ No newline at end of file
+    return ok;
+}
+
+// ============================================
+// Scheduled jobs
+// ============================================
+static void runStatusJob(void* ctx) {
+    publishSystemStatus();
+    if (bootReportPending && mqttClient.isConnected()) {
+        publishBootReport();
+        bootReportPending = false;
+    }
+}
+
+// Worker task. Weather (every 5 minutes), presence and gate (every 30
+// seconds) and the timezone (retried every minute until set, then daily;
+// the first forced run asks unless it was cached) share one REST round
+// trip. Weather, presence and gate are pushed over the HA WebSocket and
+// only polled while it is down, once after a config change, and for good
+// once their settings change (the subscription is fixed at boot).
+static void fetchStatesJob(void* ctx) {
+    stateFetch.ok = false;
+    unsigned long now = millis();
+    bool forced = statesRefreshForced;
+    statesRefreshForced = false;
+    bool live = haSocket.isLive() && !pushedEntitiesStale;
+    bool weatherDue = forced || (!live && now - lastWeatherUpdate >= 300000);
+    bool presenceDue = forced || (!live && now - lastPresenceUpdate >= 30000);
+    unsigned long timezoneInterval = timezoneSet ? 86400000 : 60000;
+    bool timezoneDue = (forced && !timezoneSet) || now - lastTimezoneUpdate >= timezoneInterval;
+    if (!weatherDue && !presenceDue && !timezoneDue) {
+        return;
+    }
+    if (weatherDue) lastWeatherUpdate = now;
+    if (presenceDue) lastPresenceUpdate = now;
+    if (timezoneDue) lastTimezoneUpdate = now;
+    fetchHomeAssistantStates(weatherDue, presenceDue, timezoneDue);
+}
+
+static void applyStatesJob(void* ctx) {
+    applyHomeAssistantStates();
+}
+
+// Worker task
+static void fetchCalendarJob(void* ctx) {
+    calendarFetched = fetchCalendar();
+}
+
+static void applyCalendarJob(void* ctx) {
+    if (calendarFetched) {
+        lvglUI.updateCalendar(calendarScan.events, calendarScan.count);
+    }
+}
+
+// What the dashboard shows, for the next boot; only written when a widget
+// changed since the last write
+static void saveDashboardJob(void* ctx) {
+    uint32_t updates = lvglUI.getUpdateCount();
+    if (updates == dashboardSavedUpdates) {
+        return;
+    }
+    JsonDocument doc;
+    lvglUI.saveDashboard(doc);
+    if (storage.saveDashboard(doc)) {
+        dashboardSavedUpdates = updates;
+    }
+}
+
+void setupJobs() {
+    scheduler.begin();
+    
+    // The first status, states and calendar runs replace the boot fetch and
+    // the cached dashboard, so they start right away; jitter keeps the 30 s
+    // jobs from firing together after that
+    JobSpec status = { "status", JOB_TELEMETRY, 30000, 2000, 100, runStatusJob, nullptr, nullptr };
+    JobSpec states = { "ha_states", JOB_FETCH, 30000, 3000, 5000, fetchStatesJob, applyStatesJob, nullptr };
+    JobSpec calendar = { "calendar", JOB_FETCH, 600000, 10000, 5000, fetchCalendarJob, applyCalendarJob, nullptr };
+    JobSpec dashboard = { "dashboard", JOB_TELEMETRY, 300000, 10000, 200, saveDashboardJob, nullptr, nullptr };
+    statesRefreshForced = true;
+    statusJob = scheduler.add(status, 0);
+    statesJob = scheduler.add(states, 0);
+    calendarJob = scheduler.add(calendar, 0);
+    dashboardJob = scheduler.add(dashboard, 300000);
+}
+
+void setupStatePush(JsonDocument& config) {
+    haSocket.begin(config);
+    haSocket.watchAttribute("friendly_name");
+    haSocket.watchAttribute("temperature");
+    
+    for (JsonVariant entityId : config["presence"]["home_assistant"]["entity_ids"].as<JsonArray>()) {
+        if (presenceEntityCount >= MAX_PEOPLE) break;
+        presenceEntities[presenceEntityCount] = entityId.as<String>();
+        presenceCards[presenceEntityCount] = -1;
+        haSocket.addEntity(presenceEntities[presenceEntityCount].c_str());
+        presenceEntityCount++;
+    }
+    
+    const char* provider = config["weather"]["provider"] | "none";
+    if (strcmp(provider, "homeassistant") == 0) {
+        weatherEntity = config["weather"]["home_assistant"]["entity_id"] | "weather.forecast_home";
+        haSocket.addEntity(weatherEntity.c_str());
+    }
+    
+    // Event lists still come from the calendar REST API; a state change of
+    // the entity (an event starting or ending) triggers a refetch
+    gateEntity = config["gate"]["home_assistant"]["entity_id"] | "";
+    if (!gateEntity.isEmpty()) {
+        haSocket.addEntity(gateEntity.c_str());
+    }
+    
+    calendarEntity = config["integrations"]["calendar"]["home_assistant"]["entity_id"] | "calendar.family";
+    haSocket.addEntity(calendarEntity.c_str());
+    
+    haSocket.setStateCallback(onHaStateChanged);
+}
+
+// Saved settings take effect without a reboot. Entities followed over the
+// HA WebSocket are fixed at boot; once their settings change, weather,
+// presence and gate go back to the REST polls until the next reboot.
+void onConfigChanged(const ConfigSnapshot& config, uint32_t changed, void* ctx) {
+    if ((changed & CONFIG_VOICE) && !isnan(config.voiceSensitivity)) {
+        voiceActivity.setSensitivity(config.voiceSensitivity);
+        log_i("Voice sensitivity updated to: %.2f", config.voiceSensitivity);
+    }
+    
+    if (changed & (CONFIG_WEATHER | CONFIG_PRESENCE | CONFIG_GATE)) {
+        pushedEntitiesStale = true;
+    }
+    
+    if (changed & CONFIG_INTEGRATIONS) {
+        // Kept connections may lead to the previous HA instance
+        haHttp.closeIdle();
+        if (config.haConfigured) {
+            haAssist.setConnection(config.haUrl.c_str(), config.haToken.c_str());
+        }
+        haSocket.setConnection(config.haUrl.c_str(), config.haToken.c_str());
+        scheduler.trigger(calendarJob);
+    }
+    
+    if (systemReady && config.haConfigured &&
+        (changed & (CONFIG_WEATHER | CONFIG_PRESENCE | CONFIG_GATE | CONFIG_INTEGRATIONS))) {
+        statesRefreshForced = true;
+        scheduler.trigger(statesJob);
+    }
+}
+
+void onHaStateChanged(const HAEntityState& state) {
+    if (calendarEntity == state.entityId) {
+        scheduler.trigger(calendarJob);
+        return;
+    }
+    // The REST polls own weather, presence and gate now
+    if (pushedEntitiesStale) {
+        return;
+    }
+    
+    for (int i = 0; i < presenceEntityCount; i++) {
+        if (presenceEntities[i] != state.entityId) continue;
+        
+        // Not on a card yet (HA did not know it at the last refresh):
+        // renumber the cards with a full refresh
+        if (presenceCards[i] < 0) {
+            statesRefreshForced = true;
+            scheduler.trigger(statesJob);
+            return;
+        }
+        
+        String name = haSocket.getAttribute(state, "friendly_name");
+        if (name.isEmpty()) {
+            name = presenceEntities[i].substring(presenceEntities[i].indexOf('.') + 1);
+            if (name.length() > 0) name[0] = toupper(name[0]);
+        }
+        bool present = strcmp(state.state, "home") == 0;
+        log_i("Presence pushed: %s %s", name.c_str(), present ? "home" : state.state);
+        lvglUI.updatePersonPresence(presenceCards[i], name.c_str(), present, 0x00FF00);
+        return;
+    }
+    
+    if (weatherEntity == state.entityId) {
+        const char* temperature = haSocket.getAttribute(state, "temperature");
+        float temp = atof(temperature);
+        if (*temperature && strcmp(state.state, "unknown") != 0) {
+            log_i("Weather pushed: %.1f°C, %s", temp, state.state);
+            lvglUI.updateWeather(temp, state.state);
+            lastWeatherTemp = temp;
+            lastWeatherState = state.state;
+        }
+        return;
+    }
+    
+    if (!gateEntity.isEmpty() && gateEntity == state.entityId) {
+        int open = state.known ? gateOpenState(state.state) : -1;
+        if (open >= 0) {
+            lvglUI.updateGateStatus(open == 1);
+        }
+        return;
+    }
+}
@@ -0,0 +1,370 @@
+#include "mic_calibration.h"
+#include "config_service.h"
+#include "lvgl_ui.h"
+#include "led_feedback.h"
+#include <algorithm>
+
+// Microphone / threshold calibration implementation
+
+MicCalibration micCalibration;
+
+static const char* phaseName(CalibrationPhase phase) {
+    switch (phase) {
+        case CALIBRATION_NOISE:  return "noise";
+        case CALIBRATION_PHRASE: return "phrase";
+        case CALIBRATION_DONE:   return "done";
+        case CALIBRATION_FAILED: return "failed";
+        default:                 return "idle";
+    }
+}
+
+MicCalibration::MicCalibration()
+    : phase(CALIBRATION_IDLE),
+      startRequested(false),
+      cancelRequested(false),
+      requestedNoiseSeconds(CALIBRATION_DEFAULT_NOISE_SECONDS),
+      requestedPhrase(false),
+      calibrated(false),
+      saveRequested(false),
+      recordPhrase(false),
+      phaseStartTime(0),
+      noiseDurationMs(0),
+      noiseCount(0),
+      phraseCount(0),
+      noiseFloor(0),
+      noiseP95(0),
+      noiseStdDev(0),
+      phraseLevel(0),
+      calibratedAt(0),
+      lastError(nullptr),
+      driftEma(0),
+      lastDriftCheck(0),
+      lastDriftSave(0),
+      driftAdjustments(0) {
+    thresholds.speech = VOICE_DEFAULT_SPEECH_THRESHOLD;
+    thresholds.silence = VOICE_DEFAULT_SILENCE_THRESHOLD;
+    thresholds.minSpeech = VOICE_DEFAULT_MIN_SPEECH_LEVEL;
+}
+
+void MicCalibration::begin(JsonDocument& config) {
+    JsonObject cal = config["voice"]["calibration"];
+
+    if (!cal.isNull() && cal["speech_threshold"].is<int>()) {
+        thresholds.speech = cal["speech_threshold"] | VOICE_DEFAULT_SPEECH_THRESHOLD;
+        thresholds.silence = cal["silence_threshold"] | VOICE_DEFAULT_SILENCE_THRESHOLD;
+        thresholds.minSpeech = cal["min_speech_level"] | VOICE_DEFAULT_MIN_SPEECH_LEVEL;
+        noiseFloor = cal["noise_floor"] | 0;
+        noiseP95 = cal["noise_p95"] | 0;
+        noiseStdDev = cal["noise_stddev"] | 0;
+        phraseLevel = cal["phrase_level"] | 0;
+        calibratedAt = cal["calibrated_at"] | 0;
+        driftAdjustments = cal["drift_adjustments"] | 0;
+        calibrated = noiseFloor > 0;
+
+        log_i("Calibration loaded: speech=%d silence=%d min=%d (noise floor %d)",
+              thresholds.speech, thresholds.silence, thresholds.minSpeech, noiseFloor);
+    } else {
+        log_i("No microphone calibration, using default thresholds");
+    }
+
+    driftEma = (int32_t)noiseFloor << 8;
+    lastDriftCheck = millis();
+    lastDriftSave = millis();
+}
+
+void MicCalibration::loop() {
+    if (cancelRequested) {
+        cancelRequested = false;
+        startRequested = false;
+        if (isRunning()) {
+            log_i("Calibration cancelled");
+            fail("Cancelled");
+        }
+    }
+
+    if (startRequested) {
+        startRequested = false;
+        startRun();
+    }
+
+    // Hide result popup a few seconds after the run finished
+    if ((phase == CALIBRATION_DONE || phase == CALIBRATION_FAILED) &&
+        phaseStartTime != 0 && millis() - phaseStartTime >= 3000) {
+        lvglUI.hideVoicePopup();
+        ledFeedback.showIdle();
+        phaseStartTime = 0;
+    }
+
+    if (saveRequested) {
+        saveRequested = false;
+        saveToConfig();
+    }
+}
+
+bool MicCalibration::requestStart(uint16_t noiseSeconds, bool withPhrase) {
+    if (isRunning() || startRequested) {
+        return false;
+    }
+
+    requestedNoiseSeconds = constrain(noiseSeconds, 1, CALIBRATION_MAX_NOISE_SECONDS);
+    requestedPhrase = withPhrase;
+    startRequested = true;
+    return true;
+}
+
+void MicCalibration::cancel() {
+    // fail() updates the popup and LED, which only the main loop may touch
+    cancelRequested = true;
+}
+
+void MicCalibration::startRun() {
+    recordPhrase = requestedPhrase;
+    noiseDurationMs = (unsigned long)requestedNoiseSeconds * 1000;
+    noiseCount = 0;
+    phraseCount = 0;
+    lastError = nullptr;
+    phaseStartTime = millis();
+    phase = CALIBRATION_NOISE;
+
+    log_i("🎚️ Calibration started: %us noise measurement%s",
+          requestedNoiseSeconds, recordPhrase ? " + prompted phrase" : "");
+
+    lvglUI.showVoicePopup("Calibrating", "Please stay quiet");
+    lvglUI.setVoiceLevelMeter(true);
+    ledFeedback.showProcessing();
+}
+
+void MicCalibration::processFrame(int16_t peakLevel) {
+    unsigned long now = millis();
+
+    if (phase == CALIBRATION_NOISE) {
+        if (noiseCount < MAX_NOISE_FRAMES) {
+            noiseLevels[noiseCount++] = peakLevel;
+        }
+
+        if (now - phaseStartTime >= noiseDurationMs || noiseCount >= MAX_NOISE_FRAMES) {
+            finishNoisePhase();
+        }
+    } else if (phase == CALIBRATION_PHRASE) {
+        // Only keep frames that stand out of the measured noise
+        if (peakLevel > thresholds.silence && phraseCount < MAX_PHRASE_FRAMES) {
+            phraseLevels[phraseCount++] = peakLevel;
+        }
+
+        if (now - phaseStartTime >= CALIBRATION_PHRASE_TIMEOUT_MS || phraseCount >= MAX_PHRASE_FRAMES) {
+            finishRun();
+        }
+    }
+}
+
+void MicCalibration::finishNoisePhase() {
+    if (noiseCount < 10) {
+        fail("Not enough audio captured");
+        return;
+    }
+
+    int64_t sum = 0;
+    for (int i = 0; i < noiseCount; i++) {
+        sum += noiseLevels[i];
+    }
+    int32_t mean = sum / noiseCount;
+
+    int64_t sumSq = 0;
+    for (int i = 0; i < noiseCount; i++) {
+        int32_t d = noiseLevels[i] - mean;
+        sumSq += (int64_t)d * d;
+    }
+
+    noiseFloor = max((int32_t)1, mean);
+    noiseStdDev = (int16_t)sqrtf((float)sumSq / noiseCount);
+    noiseP95 = percentile(noiseLevels, noiseCount, 95);
+    phraseLevel = 0;
+
+    log_i("Noise: mean=%d p95=%d stddev=%d (%d frames)", noiseFloor, noiseP95, noiseStdDev, noiseCount);
+
+    // Preliminary thresholds so the phrase phase can separate speech from noise
+    deriveThresholds();
+
+    if (recordPhrase) {
+        phase = CALIBRATION_PHRASE;
+        phaseStartTime = millis();
+        lvglUI.updateVoicePopupText("Say a command", "e.g. \"open the gate\"");
+        ledFeedback.showListening();
+    } else {
+        finishRun();
+    }
+}
+
+void MicCalibration::finishRun() {
+    if (recordPhrase) {
+        if (phraseCount >= 5) {
+            phraseLevel = percentile(phraseLevels, phraseCount, 50);
+            log_i("Phrase: median peak=%d (%d speech frames)", phraseLevel, phraseCount);
+        } else {
+            lastError = "No phrase heard, thresholds derived from noise only";
+            log_w("Calibration: %s", lastError);
+        }
+    }
+
+    deriveThresholds();
+
+    calibrated = true;
+    calibratedAt = time(nullptr);
+    driftEma = (int32_t)noiseFloor << 8;
+    lastDriftCheck = millis();
+    lastDriftSave = millis();
+    saveRequested = true;
+
+    phase = CALIBRATION_DONE;
+    phaseStartTime = millis();
+
+    log_i("✓ Calibration complete: speech=%d silence=%d min=%d",
+          thresholds.speech, thresholds.silence, thresholds.minSpeech);
+
+    char subtitle[64];
+    snprintf(subtitle, sizeof(subtitle), "Speech %d / Silence %d", thresholds.speech, thresholds.silence);
+    lvglUI.setVoiceLevelMeter(false);
+    lvglUI.updateVoicePopupText("Calibrated", subtitle);
+    ledFeedback.showSuccess();
+}
+
+void MicCalibration::fail(const char* reason) {
+    lastError = reason;
+    phase = CALIBRATION_FAILED;
+    phaseStartTime = millis();
+
+    log_w("Calibration failed: %s", reason);
+    lvglUI.setVoiceLevelMeter(false);
+    lvglUI.updateVoicePopupText("Calibration failed", reason);
+    ledFeedback.showError();
+}
+
+void MicCalibration::deriveThresholds() {
+    // Silence sits well above the noise floor so room noise never keeps a
+    // recording open. With a ~25 noise floor this reproduces the original
+    // hand-tuned 100/500/300 values.
+    int32_t silence = max((int32_t)noiseFloor * 4, (int32_t)noiseP95 * 2);
+    silence = constrain(silence, 40, 4000);
+
+    int32_t speech = silence * 5;
+    int32_t minSpeech = silence * 3;
+
+    if (phraseLevel > 0) {
+        // Speech must trigger comfortably below the user's normal speaking level
+        speech = constrain((int32_t)phraseLevel / 2, silence * 2, silence * 5);
+        minSpeech = constrain((int32_t)phraseLevel / 3, silence * 2, speech);
+    }
+
+    thresholds.silence = (int16_t)silence;
+    thresholds.speech = (int16_t)min(speech, (int32_t)30000);
+    thresholds.minSpeech = (int16_t)min(minSpeech, (int32_t)30000);
+}
+
+void MicCalibration::trackDrift(int16_t peakLevel) {
+    if (!calibrated || isRunning()) {
+        return;
+    }
+
+    // Only quiet frames describe the room noise; speech and bangs are ignored
+    if (peakLevel < thresholds.speech) {
+        // EMA with alpha = 1/512 (~16s time constant at 31 frames/s)
+        driftEma += (((int32_t)peakLevel << 8) - driftEma) / 512;
+    }
+
+    unsigned long now = millis();
+    if (now - lastDriftCheck < CALIBRATION_DRIFT_CHECK_MS) {
+        return;
+    }
+    lastDriftCheck = now;
+
+    int32_t current = driftEma >> 8;
+    if (current <= 0 || noiseFloor <= 0) {
+        return;
+    }
+
+    float ratio = (float)current / noiseFloor;
+    if (ratio > 0.77f && ratio < 1.3f) {
+        return;
+    }
+
+    int16_t oldSpeech = thresholds.speech;
+    int16_t oldSilence = thresholds.silence;
+
+    noiseFloor = (int16_t)current;
+    noiseP95 = (int16_t)constrain((int32_t)(noiseP95 * ratio), 1, 30000);
+    noiseStdDev = (int16_t)(noiseStdDev * ratio);
+    deriveThresholds();
+    driftAdjustments++;
+
+    log_i("🎚️ Noise floor drifted (x%.2f): speech %d→%d, silence %d→%d",
+          ratio, oldSpeech, thresholds.speech, oldSilence, thresholds.silence);
+
+    // Limit flash writes; the RAM thresholds are already in effect
+    if (now - lastDriftSave >= CALIBRATION_DRIFT_MIN_SAVE_MS) {
+        lastDriftSave = now;
+        saveRequested = true;
+    }
+}
+
+void MicCalibration::saveToConfig() {
+    JsonDocument config;
+    if (!configService.copy(config)) {
+        log_e("Failed to load config for calibration");
+        return;
+    }
+
+    JsonObject cal = config["voice"]["calibration"].to<JsonObject>();
+    cal["speech_threshold"] = thresholds.speech;
+    cal["silence_threshold"] = thresholds.silence;
+    cal["min_speech_level"] = thresholds.minSpeech;
+    cal["noise_floor"] = noiseFloor;
+    cal["noise_p95"] = noiseP95;
+    cal["noise_stddev"] = noiseStdDev;
+    cal["phrase_level"] = phraseLevel;
+    cal["calibrated_at"] = calibratedAt;
+    cal["drift_adjustments"] = driftAdjustments;
+
+    if (configService.save(config)) {
+        log_i("Calibration saved to config");
+    }
+}
+
+void MicCalibration::getStatusJson(JsonDocument& doc) {
+    CalibrationPhase current = phase;
+    doc["phase"] = phaseName(current);
+    doc["running"] = isRunning() || startRequested;
+    doc["calibrated"] = calibrated;
+
+    if (current == CALIBRATION_NOISE && noiseDurationMs > 0) {
+        doc["progress"] = min(100UL, (millis() - phaseStartTime) * 100 / noiseDurationMs);
+    } else if (current == CALIBRATION_PHRASE) {
+        doc["progress"] = min(100UL, (millis() - phaseStartTime) * 100 / CALIBRATION_PHRASE_TIMEOUT_MS);
+    }
+
+    doc["thresholds"]["speech"] = thresholds.speech;
+    doc["thresholds"]["silence"] = thresholds.silence;
+    doc["thresholds"]["min_speech"] = thresholds.minSpeech;
+
+    doc["noise"]["floor"] = noiseFloor;
+    doc["noise"]["p95"] = noiseP95;
+    doc["noise"]["stddev"] = noiseStdDev;
+    doc["phrase_level"] = phraseLevel;
+    doc["calibrated_at"] = calibratedAt;
+
+    doc["drift"]["current_floor"] = driftEma >> 8;
+    doc["drift"]["adjustments"] = driftAdjustments;
+
+    if (lastError) {
+        doc["error"] = lastError;
+    }
+}
+
+int16_t MicCalibration::percentile(int16_t* values, int count, int pct) {
+    if (count <= 0) return 0;
+
+    // Sorts in place - callers are done with the raw frame order
+    std::sort(values, values + count);
+    int idx = (count * pct) / 100;
+    if (idx >= count) idx = count - 1;
+    return values[idx];
+}
@@ -1,6 +1,6 @@
 #include "mqtt_client.h"
 #include "config.h"
-#include "storage_manager.h"
+#include "config_service.h"
 #include "notification_manager.h"
 
 MQTTClientManager mqttClient;
@@ -17,8 +17,13 @@ MQTTClientManager::MQTTClientManager()
 }
 
 void MQTTClientManager::loadConfig() {
-    JsonDocument config;
-    if (storage.loadConfig(config)) {
+    ConfigRef ref = configService.get();
+    const JsonDocument& config = ref->json;
+    // Cleared fields must not linger from the previous config
+    memset(mqttBroker, 0, sizeof(mqttBroker));
+    memset(mqttUsername, 0, sizeof(mqttUsername));
+    memset(mqttPassword, 0, sizeof(mqttPassword));
+    if (ref->generation) {
         mqttEnabled = config["mqtt"]["enabled"] | false;
         mqttValidated = config["mqtt"]["validated"] | false;
         const char* broker = config["mqtt"]["broker"];
@@ -49,6 +54,11 @@ void MQTTClientManager::loadConfig() {
 
 void MQTTClientManager::begin() {
     loadConfig();
+    configService.subscribe(onConfigChanged, this, CONFIG_MQTT);
+    
+    client.setCallback(mqttCallback);
+    client.setBufferSize(MQTT_BUFFER_SIZE);
+    client.setKeepAlive(MQTT_KEEPALIVE);
     
     if (!mqttEnabled || strlen(mqttBroker) == 0) {
         Serial.println("MQTT disabled or not configured");
@@ -56,9 +66,6 @@ void MQTTClientManager::begin() {
     }
     
     client.setServer(mqttBroker, mqttPort);
-    client.setCallback(mqttCallback);
-    client.setBufferSize(MQTT_BUFFER_SIZE);
-    client.setKeepAlive(MQTT_KEEPALIVE);
     
     Serial.printf("MQTT Client initialized - connecting to %s:%d\n", mqttBroker, mqttPort);
     
@@ -229,6 +236,22 @@ void MQTTClientManager::publishCommandExecuted(const char* command, const char*
     publishJson(topic.c_str(), doc);
 }
 
+void MQTTClientManager::publishVoiceMetrics(const UtteranceMetrics& metrics) {
+    JsonDocument doc;
+    AudioMetrics::toJson(metrics, doc.to<JsonObject>());
+    
+    String topic = String(mqttTopicPrefix) + "/voice/metrics";
+    publishJson(topic.c_str(), doc);
+}
+
+// Retained: the broker keeps each unit's last boot for fleet dashboards
+void MQTTClientManager::publishBootReport(JsonDocument& report) {
+    String topic = getTopicPrefix() + "/boot";
+    if (!publishJson(topic.c_str(), report, true)) {
+        log_w("Boot report not published (%u bytes)", (unsigned)measureJson(report));
+    }
+}
+
 void MQTTClientManager::publishPresenceUpdate(const char* person, bool present) {
     JsonDocument doc;
     doc["person"] = person;
@@ -239,6 +262,29 @@ void MQTTClientManager::publishPresenceUpdate(const char* person, bool present)
     publishJson(topic.c_str(), doc);
 }
 
+void MQTTClientManager::onConfigChanged(const ConfigSnapshot& config, uint32_t changed, void* ctx) {
+    MQTTClientManager* self = (MQTTClientManager*)ctx;
+    
+    // Only a changed connection is worth dropping the session for; the
+    // validated flag alone just changes the retry policy
+    char before[sizeof(mqttBroker) + sizeof(mqttUsername) + sizeof(mqttPassword) + sizeof(mqttClientId) + sizeof(mqttTopicPrefix) + 16];
+    snprintf(before, sizeof(before), "%d|%s|%u|%s|%s|%s|%s", self->mqttEnabled, self->mqttBroker, self->mqttPort,
+             self->mqttUsername, self->mqttPassword, self->mqttClientId, self->mqttTopicPrefix);
+    self->loadConfig();
+    char after[sizeof(before)];
+    snprintf(after, sizeof(after), "%d|%s|%u|%s|%s|%s|%s", self->mqttEnabled, self->mqttBroker, self->mqttPort,
+             self->mqttUsername, self->mqttPassword, self->mqttClientId, self->mqttTopicPrefix);
+    if (strcmp(before, after) == 0) {
+        return;
+    }
+    
+    Serial.println("MQTT settings changed, reconnecting");
+    if (self->client.connected()) {
+        self->client.disconnect();
+    }
+    self->forceReconnect();
+}
+
 void MQTTClientManager::forceReconnect() {
     Serial.println("Force reconnecting MQTT...");
     reconnectFailures = 0; // Reset failure count for forced reconnect
@@ -1,5 +1,5 @@
 #include "notification_manager.h"
-#include "storage_manager.h"
+#include "config_service.h"
 #include "config.h"
 
 NotificationManager notificationManager;
@@ -21,6 +21,10 @@ NotificationManager::NotificationManager()
 
 void NotificationManager::begin() {
     loadConfig();
+    // Saved notification settings apply without a reboot
+    configService.subscribe([](const ConfigSnapshot& config, uint32_t changed, void* ctx) {
+        ((NotificationManager*)ctx)->loadConfig();
+    }, this, CONFIG_NOTIFICATIONS);
     Serial.println("Notification Manager initialized");
 }
 
@@ -161,8 +165,9 @@ String NotificationManager::getCurrentNotification() {
 }
 
 void NotificationManager::loadConfig() {
-    JsonDocument config;
-    if (storage.loadConfig(config)) {
+    ConfigRef ref = configService.get();
+    const JsonDocument& config = ref->json;
+    if (ref->generation) {
         notificationsEnabled = config["notifications"]["enabled"] | true;
         
         // Load individual notification settings
@@ -1,5 +1,6 @@
 #include "ota_manager.h"
 #include "config.h"
+#include "boot_profiler.h"
 
 OTAManager otaManager;
 
@@ -49,6 +50,8 @@ void OTAManager::onOTAStart() {
 
 void OTAManager::onOTAEnd() {
     Serial.println("\nOTA Update Complete");
+    // ArduinoOTA restarts right after this
+    bootProfiler.noteRestart("ota");
 }
 
 void OTAManager::onOTAProgress(unsigned int progress, unsigned int total) {
@@ -0,0 +1,793 @@
+#include "sound_events.h"
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+
+// Acoustic event detection - portable front end, model runtime and tracker
+
+// Model file header (little endian, 20 bytes), followed by class names
+// (SOUND_EVENTS_NAME_LEN bytes each) and the layers
+struct SoundModelHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t inputFrames;
+    uint16_t inputMels;
+    uint16_t numClasses;
+    uint16_t numLayers;
+    int8_t inputZero;
+    uint8_t pad;
+    float inputScale;
+};
+
+static inline int8_t clampInt8(int32_t v) {
+    if (v > 127) return 127;
+    if (v < -128) return -128;
+    return (int8_t)v;
+}
+
+static inline size_t align4(size_t v) {
+    return (v + 3) & ~(size_t)3;
+}
+
+// ============================================
+// LogMelFrontend
+// ============================================
+
+static float hzToMel(float hz) {
+    return 2595.0f * log10f(1.0f + hz / 700.0f);
+}
+
+static float melToHz(float mel) {
+    return 700.0f * (powf(10.0f, mel / 2595.0f) - 1.0f);
+}
+
+LogMelFrontend::LogMelFrontend() : numMels(0) {
+}
+
+bool LogMelFrontend::begin(int mels, float fMin, float fMax) {
+    if (mels <= 0 || mels > SOUND_EVENTS_MAX_MELS) {
+        return false;
+    }
+    numMels = mels;
+
+    for (int i = 0; i < SOUND_EVENTS_FFT_SIZE; i++) {
+        window[i] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / SOUND_EVENTS_FFT_SIZE);
+    }
+
+    // numMels + 2 equally spaced points on the mel scale, kept as fractional
+    // FFT bins so narrow low-frequency filters do not collapse to zero width
+    float melMin = hzToMel(fMin);
+    float melMax = hzToMel(fMax);
+    for (int i = 0; i < numMels + 2; i++) {
+        float hz = melToHz(melMin + (melMax - melMin) * i / (numMels + 1));
+        melEdges[i] = hz * SOUND_EVENTS_FFT_SIZE / SAMPLE_RATE;
+    }
+    return true;
+}
+
+void LogMelFrontend::fft() {
+    const int n = SOUND_EVENTS_FFT_SIZE;
+
+    // Bit reversal
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    // Iterative radix-2 butterflies
+    for (int len = 2; len <= n; len <<= 1) {
+        float ang = -2.0f * (float)M_PI / len;
+        float wr = cosf(ang), wi = sinf(ang);
+        for (int i = 0; i < n; i += len) {
+            float cr = 1.0f, ci = 0.0f;
+            for (int k = 0; k < len / 2; k++) {
+                int a = i + k, b = i + k + len / 2;
+                float tr = re[b] * cr - im[b] * ci;
+                float ti = re[b] * ci + im[b] * cr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+                float nr = cr * wr - ci * wi;
+                ci = cr * wi + ci * wr;
+                cr = nr;
+            }
+        }
+    }
+}
+
+void LogMelFrontend::process(const int16_t* samples, size_t count, float* melOut) {
+    for (int i = 0; i < SOUND_EVENTS_FFT_SIZE; i++) {
+        float s = i < (int)count ? samples[i] / 32768.0f : 0.0f;
+        re[i] = s * window[i];
+        im[i] = 0.0f;
+    }
+
+    fft();
+
+    // Power spectrum in place (bins 0..N/2)
+    for (int i = 0; i <= SOUND_EVENTS_FFT_SIZE / 2; i++) {
+        re[i] = re[i] * re[i] + im[i] * im[i];
+    }
+
+    // Triangular filters: weight = min(rising, falling) slope, clipped at 0
+    for (int m = 0; m < numMels; m++) {
+        float left = melEdges[m], center = melEdges[m + 1], right = melEdges[m + 2];
+        int first = (int)ceilf(left);
+        int last = (int)floorf(right);
+        if (last > SOUND_EVENTS_FFT_SIZE / 2) last = SOUND_EVENTS_FFT_SIZE / 2;
+
+        float energy = 0.0f;
+        for (int k = first; k <= last; k++) {
+            float up = (k - left) / (center - left);
+            float down = (right - k) / (right - center);
+            float weight = up < down ? up : down;
+            if (weight > 0.0f) {
+                energy += re[k] * weight;
+            }
+        }
+        melOut[m] = logf(energy + 1e-6f);
+    }
+}
+
+// ============================================
+// LogMelWindow
+// ============================================
+
+LogMelWindow::LogMelWindow()
+    : ring(nullptr), frames(0), mels(0), head(0), count(0) {
+}
+
+LogMelWindow::~LogMelWindow() {
+    free(ring);
+}
+
+bool LogMelWindow::begin(int numFrames, int numMels, int8_t fill) {
+    free(ring);
+    frames = numFrames;
+    mels = numMels;
+    head = 0;
+    count = 0;
+    ring = (int8_t*)malloc((size_t)frames * mels);
+    if (!ring) {
+        return false;
+    }
+    memset(ring, fill, (size_t)frames * mels);
+    return true;
+}
+
+void LogMelWindow::push(const int8_t* row) {
+    memcpy(ring + (size_t)head * mels, row, mels);
+    head = (head + 1) % frames;
+    if (count < frames) count++;
+}
+
+void LogMelWindow::copyTo(int8_t* dst) const {
+    size_t tail = (size_t)(frames - head) * mels;
+    memcpy(dst, ring + (size_t)head * mels, tail);
+    memcpy(dst + tail, ring, (size_t)head * mels);
+}
+
+// ============================================
+// SoundEventModel
+// ============================================
+
+SoundEventModel::SoundEventModel()
+    : loaded(false),
+      image(nullptr),
+      inputFrames(0),
+      inputMels(0),
+      numClasses(0),
+      inputScale(1.0f),
+      inputZero(0),
+      numLayers(0),
+      arenaA(nullptr),
+      arenaB(nullptr),
+      arenaBytes(0),
+      macs(0),
+      error(nullptr) {
+    memset(classNames, 0, sizeof(classNames));
+}
+
+SoundEventModel::~SoundEventModel() {
+    unload();
+}
+
+void SoundEventModel::unload() {
+    free(image);
+    free(arenaA);
+    free(arenaB);
+    image = nullptr;
+    arenaA = arenaB = nullptr;
+    arenaBytes = 0;
+    numLayers = 0;
+    loaded = false;
+}
+
+bool SoundEventModel::fail(const char* reason) {
+    error = reason;
+    unload();
+    return false;
+}
+
+bool SoundEventModel::load(uint8_t* data, size_t len) {
+    unload();
+    image = data;
+    error = nullptr;
+
+    SoundModelHeader hdr;
+    if (len < sizeof(hdr)) return fail("file too short");
+    memcpy(&hdr, data, sizeof(hdr));
+
+    if (hdr.magic != SOUND_EVENTS_MODEL_MAGIC || hdr.version != 1) return fail("bad magic/version");
+    if (hdr.numClasses == 0 || hdr.numClasses > SOUND_EVENTS_MAX_CLASSES) return fail("bad class count");
+    if (hdr.numLayers == 0 || hdr.numLayers > SOUND_EVENTS_MAX_LAYERS) return fail("bad layer count");
+    if (hdr.inputMels == 0 || hdr.inputMels > SOUND_EVENTS_MAX_MELS || hdr.inputFrames == 0) return fail("bad input shape");
+
+    inputFrames = hdr.inputFrames;
+    inputMels = hdr.inputMels;
+    numClasses = hdr.numClasses;
+    inputScale = hdr.inputScale;
+    inputZero = hdr.inputZero;
+
+    size_t offset = sizeof(hdr);
+    if (offset + (size_t)numClasses * SOUND_EVENTS_NAME_LEN > len) return fail("truncated class names");
+    for (int i = 0; i < numClasses; i++) {
+        memcpy(classNames[i], data + offset, SOUND_EVENTS_NAME_LEN);
+        classNames[i][SOUND_EVENTS_NAME_LEN - 1] = '\0';
+        offset += SOUND_EVENTS_NAME_LEN;
+    }
+
+    // Walk layers, resolve shapes and size the ping-pong arenas
+    uint16_t h = inputFrames, w = inputMels, c = 1;
+    int8_t zero = inputZero;
+    size_t maxTensor = (size_t)h * w * c;
+    macs = 0;
+
+    for (int i = 0; i < hdr.numLayers; i++) {
+        SoundLayer& L = layers[i];
+        if (offset + sizeof(SoundLayerHeader) > len) return fail("truncated layer header");
+        memcpy(&L.hdr, data + offset, sizeof(SoundLayerHeader));
+        offset += sizeof(SoundLayerHeader);
+
+        L.inH = h; L.inW = w; L.inC = c;
+        L.inZero = zero;
+
+        uint8_t k = L.hdr.kernel ? L.hdr.kernel : 1;
+        uint8_t s = L.hdr.stride ? L.hdr.stride : 1;
+        uint32_t biasCount = 0;
+
+        switch (L.hdr.type) {
+            case SOUND_LAYER_CONV2D:
+                L.outH = (h + s - 1) / s;
+                L.outW = (w + s - 1) / s;
+                L.outC = L.hdr.outChannels;
+                L.weightCount = (uint32_t)L.outC * k * k * c;
+                biasCount = L.outC;
+                macs += (uint32_t)L.outH * L.outW * L.weightCount;
+                break;
+            case SOUND_LAYER_MAXPOOL:
+                L.outH = h / k;
+                L.outW = w / k;
+                L.outC = c;
+                L.weightCount = 0;
+                L.hdr.outZero = zero;
+                break;
+            case SOUND_LAYER_GAP:
+                L.outH = 1;
+                L.outW = 1;
+                L.outC = c;
+                L.weightCount = 0;
+                L.hdr.outZero = zero;
+                break;
+            case SOUND_LAYER_DENSE:
+                L.outH = 1;
+                L.outW = 1;
+                L.outC = L.hdr.outChannels;
+                L.weightCount = (uint32_t)L.outC * h * w * c;
+                biasCount = L.outC;
+                macs += L.weightCount;
+                break;
+            default:
+                return fail("unknown layer type");
+        }
+
+        if (L.outH == 0 || L.outW == 0 || L.outC == 0) return fail("layer output is empty");
+
+        size_t weightBytes = align4(L.weightCount);
+        size_t biasBytes = biasCount * sizeof(int32_t);
+        if (offset + weightBytes + biasBytes > len) return fail("truncated layer data");
+
+        L.weights = L.weightCount ? (const int8_t*)(data + offset) : nullptr;
+        offset += weightBytes;
+        L.bias = biasCount ? (const int32_t*)(data + offset) : nullptr;
+        offset += biasBytes;
+
+        h = L.outH; w = L.outW; c = L.outC;
+        zero = L.hdr.outZero;
+        size_t tensor = (size_t)h * w * c;
+        if (tensor > maxTensor) maxTensor = tensor;
+    }
+
+    numLayers = hdr.numLayers;
+    if (h * w * c != numClasses) return fail("output size does not match class count");
+
+    arenaBytes = maxTensor;
+    arenaA = (int8_t*)malloc(arenaBytes);
+    arenaB = (int8_t*)malloc(arenaBytes);
+    if (!arenaA || !arenaB) return fail("out of memory");
+
+    loaded = true;
+    return true;
+}
+
+int8_t SoundEventModel::quantizeInput(float value) const {
+    return clampInt8((int32_t)lroundf(value / inputScale) + inputZero);
+}
+
+bool SoundEventModel::run(const int8_t* input, float* probs) {
+    if (!loaded) {
+        return false;
+    }
+
+    const int8_t* in = input;
+    int8_t* out = arenaA;
+
+    for (int li = 0; li < numLayers; li++) {
+        const SoundLayer& L = layers[li];
+        const int32_t zi = L.inZero;
+        const int32_t zo = L.hdr.outZero;
+        const int32_t lo = (L.hdr.flags & 1) ? zo : -128;   // Fused ReLU
+
+        switch (L.hdr.type) {
+            case SOUND_LAYER_CONV2D: {
+                const int k = L.hdr.kernel, s = L.hdr.stride ? L.hdr.stride : 1;
+                const int pad = (k - 1) / 2;
+                for (int oy = 0; oy < L.outH; oy++) {
+                    for (int ox = 0; ox < L.outW; ox++) {
+                        int8_t* dst = out + ((size_t)oy * L.outW + ox) * L.outC;
+                        for (int oc = 0; oc < L.outC; oc++) {
+                            int32_t acc = L.bias[oc];
+                            const int8_t* wk = L.weights + (size_t)oc * k * k * L.inC;
+                            for (int ky = 0; ky < k; ky++) {
+                                int iy = oy * s + ky - pad;
+                                if (iy < 0 || iy >= L.inH) { wk += k * L.inC; continue; }
+                                for (int kx = 0; kx < k; kx++, wk += L.inC) {
+                                    int ix = ox * s + kx - pad;
+                                    if (ix < 0 || ix >= L.inW) continue;
+                                    const int8_t* src = in + ((size_t)iy * L.inW + ix) * L.inC;
+                                    for (int ic = 0; ic < L.inC; ic++) {
+                                        acc += (src[ic] - zi) * wk[ic];
+                                    }
+                                }
+                            }
+                            int32_t v = (int32_t)lroundf(acc * L.hdr.multiplier) + zo;
+                            dst[oc] = clampInt8(v < lo ? lo : v);
+                        }
+                    }
+                }
+                break;
+            }
+
+            case SOUND_LAYER_MAXPOOL: {
+                const int k = L.hdr.kernel;
+                for (int oy = 0; oy < L.outH; oy++) {
+                    for (int ox = 0; ox < L.outW; ox++) {
+                        for (int c = 0; c < L.outC; c++) {
+                            int8_t m = -128;
+                            for (int ky = 0; ky < k; ky++) {
+                                for (int kx = 0; kx < k; kx++) {
+                                    int8_t v = in[(((size_t)(oy * k + ky)) * L.inW + ox * k + kx) * L.inC + c];
+                                    if (v > m) m = v;
+                                }
+                            }
+                            out[((size_t)oy * L.outW + ox) * L.outC + c] = m;
+                        }
+                    }
+                }
+                break;
+            }
+
+            case SOUND_LAYER_GAP: {
+                const int32_t area = (int32_t)L.inH * L.inW;
+                for (int c = 0; c < L.outC; c++) {
+                    int32_t sum = 0;
+                    for (int p = 0; p < area; p++) {
+                        sum += in[(size_t)p * L.inC + c];
+                    }
+                    out[c] = clampInt8((sum + (sum >= 0 ? area / 2 : -area / 2)) / area);
+                }
+                break;
+            }
+
+            case SOUND_LAYER_DENSE: {
+                const int n = L.inH * L.inW * L.inC;
+                for (int oc = 0; oc < L.outC; oc++) {
+                    const int8_t* wr = L.weights + (size_t)oc * n;
+                    int32_t acc = L.bias[oc];
+                    for (int i = 0; i < n; i++) {
+                        acc += (in[i] - zi) * wr[i];
+                    }
+                    int32_t v = (int32_t)lroundf(acc * L.hdr.multiplier) + zo;
+                    out[oc] = clampInt8(v < lo ? lo : v);
+                }
+                break;
+            }
+        }
+
+        in = out;
+        out = (out == arenaA) ? arenaB : arenaA;
+    }
+
+    // Dequantize logits of the last layer and apply softmax
+    const SoundLayer& last = layers[numLayers - 1];
+    float maxLogit = -1e30f;
+    for (int i = 0; i < numClasses; i++) {
+        probs[i] = (in[i] - last.hdr.outZero) * last.hdr.outScale;
+        if (probs[i] > maxLogit) maxLogit = probs[i];
+    }
+    float sum = 0.0f;
+    for (int i = 0; i < numClasses; i++) {
+        probs[i] = expf(probs[i] - maxLogit);
+        sum += probs[i];
+    }
+    for (int i = 0; i < numClasses; i++) {
+        probs[i] /= sum;
+    }
+    return true;
+}
+
+// ============================================
+// SoundEventTracker
+// ============================================
+
+SoundEventTracker::SoundEventTracker()
+    : numClasses(0),
+      threshold(0.7f),
+      consecutive(2),
+      cooldownWindows(20) {
+    memset(ignored, 0, sizeof(ignored));
+    memset(hits, 0, sizeof(hits));
+    memset(cooldown, 0, sizeof(cooldown));
+}
+
+void SoundEventTracker::configure(const SoundEventModel& model, float thr, uint8_t cons, uint16_t cool) {
+    numClasses = model.getNumClasses();
+    threshold = thr;
+    consecutive = cons > 0 ? cons : 1;
+    cooldownWindows = cool;
+
+    for (int i = 0; i < numClasses; i++) {
+        const char* name = model.getClassName(i);
+        ignored[i] = name[0] == '_' || strcmp(name, "background") == 0 || strcmp(name, "silence") == 0;
+        hits[i] = 0;
+        cooldown[i] = 0;
+    }
+}
+
+int SoundEventTracker::update(const float* probs, float* confidence) {
+    int fired = -1;
+    float best = 0.0f;
+
+    for (int i = 0; i < numClasses; i++) {
+        if (cooldown[i] > 0) cooldown[i]--;
+        if (ignored[i]) continue;
+
+        if (probs[i] >= threshold) {
+            if (hits[i] < 255) hits[i]++;
+        } else {
+            hits[i] = 0;
+        }
+
+        if (hits[i] >= consecutive && cooldown[i] == 0 && probs[i] > best) {
+            fired = i;
+            best = probs[i];
+        }
+    }
+
+    if (fired >= 0) {
+        cooldown[fired] = cooldownWindows;
+        hits[fired] = 0;
+        if (confidence) *confidence = best;
+    }
+    return fired;
+}
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include <LittleFS.h>
+#include "mqtt_client.h"
+#include "config.h"
+
+SoundEventDetector soundEvents;
+
+SoundEventDetector::SoundEventDetector()
+    : active(false),
+      hopFrames(8),
+      cpuCapPercent(10),
+      framesSinceHop(0),
+      inputPatch(nullptr),
+      inputReady(false),
+      resultReady(false),
+      task(nullptr),
+      creditUs(0),
+      lastCreditUpdate(0),
+      busyUsWindow(0),
+      cpuWindowStart(0),
+      discoveryPublished(false),
+      lastConfidence(0),
+      lastEventTime(0) {
+    memset(&stats, 0, sizeof(stats));
+    memset(probs, 0, sizeof(probs));
+    lastEvent[0] = '\0';
+}
+
+bool SoundEventDetector::loadModel() {
+    File file = LittleFS.open(SOUND_EVENTS_MODEL_FILE, "r");
+    if (!file) {
+        return false;
+    }
+
+    size_t len = file.size();
+    uint8_t* data = (uint8_t*)malloc(len);
+    if (!data) {
+        file.close();
+        log_e("Sound events: cannot allocate %u bytes for model", len);
+        return false;
+    }
+    size_t got = file.read(data, len);
+    file.close();
+
+    if (got != len) {
+        free(data);
+        log_e("Sound events: short read of model file");
+        return false;
+    }
+
+    // Model owns data from here on, also on failure
+    if (!model.load(data, len)) {
+        log_e("Sound events: invalid model: %s", model.getError());
+        return false;
+    }
+    return true;
+}
+
+void SoundEventDetector::begin(JsonDocument& config) {
+    JsonObject cfg = config["sound_events"];
+    if (!(cfg["enabled"] | true)) {
+        log_i("Sound events: disabled in config");
+        return;
+    }
+
+    if (!loadModel()) {
+        log_i("Sound events: no model at %s, detector disabled", SOUND_EVENTS_MODEL_FILE);
+        return;
+    }
+
+    hopFrames = constrain(cfg["hop_frames"] | 8, 1, 64);
+    cpuCapPercent = constrain(cfg["cpu_cap_percent"] | 10, 1, 100);
+    float threshold = cfg["threshold"] | 0.7f;
+    uint8_t consecutive = cfg["consecutive"] | 2;
+    uint32_t cooldownMs = cfg["cooldown_ms"] | 5000;
+    uint32_t hopMs = (uint32_t)hopFrames * AUDIO_FRAME_PERIOD_US / 1000;
+    tracker.configure(model, threshold, consecutive, cooldownMs / max(hopMs, (uint32_t)1));
+
+    frontend.begin(model.getInputMels());
+    inputPatch = (int8_t*)malloc((size_t)model.getInputFrames() * model.getInputMels());
+    if (!inputPatch || !window.begin(model.getInputFrames(), model.getInputMels(), model.quantizeInput(logf(1e-6f)))) {
+        log_e("Sound events: out of memory");
+        model.unload();
+        return;
+    }
+
+    creditUs = 0;
+    lastCreditUpdate = micros();
+    cpuWindowStart = millis();
+
+    // Inference runs beside WiFi/LVGL on core 0 at low priority
+    xTaskCreatePinnedToCore(inferenceTask, "sound_events", 4096, this, 1, &task, 0);
+    active = true;
+
+    log_i("Sound events: %d classes, %dx%d input, %u MACs, %u B arena, hop %u ms, CPU cap %u%%",
+          model.getNumClasses(), model.getInputFrames(), model.getInputMels(), model.getMacs(),
+          model.getArenaBytes() * 2, hopMs, cpuCapPercent);
+}
+
+void SoundEventDetector::processFrame(const AudioFrame& frame) {
+    if (!active) {
+        return;
+    }
+
+    uint32_t start = micros();
+
+    // Log-mel for this frame into the window
+    float mel[SOUND_EVENTS_MAX_MELS];
+    int8_t row[SOUND_EVENTS_MAX_MELS];
+    frontend.process(frame.samples, frame.count, mel);
+    for (int m = 0; m < model.getInputMels(); m++) {
+        row[m] = model.quantizeInput(mel[m]);
+    }
+    window.push(row);
+
+    uint32_t frontendUs = micros() - start;
+    if (frontendUs > stats.frontendUsMax) stats.frontendUsMax = frontendUs;
+
+    // Earn inference budget: cap% of wall-clock time, at most two hops' worth banked
+    uint32_t now = micros();
+    int32_t earned = (int32_t)((uint64_t)(now - lastCreditUpdate) * cpuCapPercent / 100);
+    lastCreditUpdate = now;
+    int32_t maxCredit = (int32_t)((uint32_t)hopFrames * AUDIO_FRAME_PERIOD_US * cpuCapPercent / 100 * 2);
+    int32_t credit = creditUs.fetch_add(earned) + earned;
+    if (credit > maxCredit) creditUs.fetch_sub(credit - maxCredit);
+
+    if (++framesSinceHop < hopFrames || !window.isFull()) {
+        return;
+    }
+    framesSinceHop = 0;
+    stats.windows++;
+
+    if (inputReady.load()) {
+        stats.skippedBusy++;
+        return;
+    }
+    if (creditUs.load() < (int32_t)stats.lastInferenceUs) {
+        stats.skippedBudget++;
+        return;
+    }
+
+    window.copyTo(inputPatch);
+    inputReady.store(true);
+    xTaskNotifyGive(task);
+}
+
+void SoundEventDetector::inferenceTask(void* param) {
+    SoundEventDetector* self = (SoundEventDetector*)param;
+    float result[SOUND_EVENTS_MAX_CLASSES];
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!self->inputReady.load()) {
+            continue;
+        }
+
+        uint32_t start = micros();
+        bool ok = self->model.run(self->inputPatch, result);
+        uint32_t elapsed = micros() - start;
+
+        self->stats.inferences++;
+        self->stats.lastInferenceUs = elapsed;
+        self->stats.totalInferenceUs += elapsed;
+        if (elapsed > self->stats.maxInferenceUs) self->stats.maxInferenceUs = elapsed;
+        self->busyUsWindow.fetch_add(elapsed);
+        self->creditUs.fetch_sub(elapsed);
+
+        if (ok && !self->resultReady.load()) {
+            memcpy(self->probs, result, sizeof(result));
+            self->resultReady.store(true);
+        }
+        self->inputReady.store(false);
+    }
+}
+
+void SoundEventDetector::loop() {
+    if (!active) {
+        return;
+    }
+
+    if (!discoveryPublished && mqttClient.isConnected()) {
+        publishDiscovery();
+    }
+
+    // CPU share over ~5 s windows
+    unsigned long now = millis();
+    if (now - cpuWindowStart >= 5000) {
+        stats.cpuPercent = busyUsWindow.exchange(0) / 10.0f / (now - cpuWindowStart);
+        cpuWindowStart = now;
+    }
+
+    if (!resultReady.load()) {
+        return;
+    }
+
+    float confidence = 0;
+    int cls = tracker.update(probs, &confidence);
+    resultReady.store(false);
+
+    if (cls < 0) {
+        return;
+    }
+
+    const char* name = model.getClassName(cls);
+    stats.detections++;
+    strlcpy(lastEvent, name, sizeof(lastEvent));
+    lastConfidence = confidence;
+    lastEventTime = now;
+
+    log_i("🔔 Sound event: %s (%.0f%%)", name, confidence * 100);
+
+    // HA MQTT event entity payload
+    JsonDocument doc;
+    doc["event_type"] = name;
+    doc["confidence"] = roundf(confidence * 100) / 100;
+    String topic = String("entryhub/event/sound_") + name;
+    mqttClient.publishJson(topic.c_str(), doc);
+}
+
+void SoundEventDetector::publishDiscovery() {
+    for (int i = 0; i < model.getNumClasses(); i++) {
+        const char* name = model.getClassName(i);
+        if (name[0] == '_' || strcmp(name, "background") == 0 || strcmp(name, "silence") == 0) {
+            continue;
+        }
+
+        JsonDocument doc;
+        String objectId = String("sound_") + name;
+
+        String label = String(name);
+        label.replace("_", " ");
+        label.setCharAt(0, toupper(label[0]));
+
+        doc["name"] = label;
+        doc["unique_id"] = String(DEVICE_NAME) + "_" + objectId;
+        doc["state_topic"] = String("entryhub/event/") + objectId;
+        doc["event_types"][0] = name;
+        if (strcmp(name, "doorbell") == 0) {
+            doc["device_class"] = "doorbell";
+        }
+
+        JsonObject device = doc["device"].to<JsonObject>();
+        device["identifiers"][0] = DEVICE_NAME;
+        device["name"] = DEVICE_NAME;
+
+        String topic = String(HA_DISCOVERY_PREFIX) + "/event/" + DEVICE_NAME + "/" + objectId + "/config";
+        mqttClient.publishJson(topic.c_str(), doc, true);
+    }
+
+    discoveryPublished = true;
+    log_i("Sound events: HA discovery published");
+}
+
+void SoundEventDetector::getStatusJson(JsonObject obj) {
+    obj["active"] = active;
+    if (!active) {
+        return;
+    }
+
+    obj["classes"] = model.getNumClasses();
+    obj["windows"] = stats.windows;
+    obj["inferences"] = stats.inferences;
+    obj["skipped_budget"] = stats.skippedBudget;
+    obj["skipped_busy"] = stats.skippedBusy;
+    obj["detections"] = stats.detections;
+    obj["inference_us_last"] = stats.lastInferenceUs;
+    obj["inference_us_max"] = stats.maxInferenceUs;
+    obj["inference_us_avg"] = stats.inferences ? (uint32_t)(stats.totalInferenceUs / stats.inferences) : 0;
+    obj["frontend_us_max"] = stats.frontendUsMax;
+    obj["cpu_percent"] = roundf(stats.cpuPercent * 10) / 10;
+    obj["cpu_cap_percent"] = cpuCapPercent;
+
+    if (lastEvent[0]) {
+        obj["last_event"] = lastEvent;
+        obj["last_confidence"] = roundf(lastConfidence * 100) / 100;
+        obj["last_event_age_s"] = (millis() - lastEventTime) / 1000;
+    }
+}
+
+SoundEventStage::SoundEventStage()
+    : AudioStage("events", AUDIO_FORMAT_PCM16, AUDIO_FORMAT_PCM16, 1500) {
+}
+
+bool SoundEventStage::process(AudioFrame& frame) {
+    soundEvents.processFrame(frame);
+    return true;
+}
+#endif
@@ -1,9 +1,13 @@
 #include "storage_manager.h"
 #include "config.h"
+#include "flash_record.h"
+#include <vector>
 
 StorageManager storage;
 
-StorageManager::StorageManager() : initialized(false) {
+StorageManager::StorageManager()
+    : initialized(false), recordLoads(0), recordSaves(0), jsonImports(0), rejectedRecords(0), bytesWritten(0),
+      lastLoadMs(0), lastSaveMs(0), lastRecordBytes(0), lastJsonBytes(0) {
 }
 
 bool StorageManager::begin() {
@@ -25,27 +29,35 @@ bool StorageManager::begin() {
 }
 
 bool StorageManager::loadConfig(JsonDocument& doc) {
-    return readJsonFile(CONFIG_FILE, doc);
+    return loadDocument(CONFIG_FILE, doc);
 }
 
 bool StorageManager::saveConfig(const JsonDocument& doc) {
-    return writeJsonFile(CONFIG_FILE, doc);
+    return saveDocument(CONFIG_FILE, doc);
 }
 
 bool StorageManager::loadCommands(JsonDocument& doc) {
-    return readJsonFile(COMMANDS_FILE, doc);
+    return loadDocument(COMMANDS_FILE, doc);
 }
 
 bool StorageManager::saveCommands(const JsonDocument& doc) {
-    return writeJsonFile(COMMANDS_FILE, doc);
+    return saveDocument(COMMANDS_FILE, doc);
 }
 
 bool StorageManager::loadPresence(JsonDocument& doc) {
-    return readJsonFile(PRESENCE_FILE, doc);
+    return loadDocument(PRESENCE_FILE, doc);
 }
 
 bool StorageManager::savePresence(const JsonDocument& doc) {
-    return writeJsonFile(PRESENCE_FILE, doc);
+    return saveDocument(PRESENCE_FILE, doc);
+}
+
+bool StorageManager::loadDashboard(JsonDocument& doc) {
+    return loadDocument(DASHBOARD_FILE, doc);
+}
+
+bool StorageManager::saveDashboard(const JsonDocument& doc) {
+    return saveDocument(DASHBOARD_FILE, doc);
 }
 
 bool StorageManager::readFile(const char* path, String& content) {
@@ -144,8 +156,117 @@ bool StorageManager::readJsonFile(const char* path, JsonDocument& doc) {
     return true;
 }
 
-bool StorageManager::writeJsonFile(const char* path, const JsonDocument& doc) {
-    String output;
-    serializeJson(doc, output);
-    return writeFile(path, output);
+// "/config.json" -> "/config.bin"
+static String recordPath(const char* path) {
+    String p = path;
+    if (p.endsWith(".json")) {
+        p.remove(p.length() - 5);
+    }
+    return p + ".bin";
+}
+
+bool StorageManager::loadDocument(const char* path, JsonDocument& doc) {
+    String binPath = recordPath(path);
+    uint32_t start = millis();
+    if (readRecordFile(binPath.c_str(), doc)) {
+        recordLoads++;
+        lastLoadMs = millis() - start;
+        return true;
+    }
+    
+    // No usable record: import the JSON file and store it as one
+    if (!fileExists(path) || !readJsonFile(path, doc)) {
+        return false;
+    }
+    jsonImports++;
+    Serial.printf("Imported %s, stored as %s from now on\n", path, binPath.c_str());
+    writeRecordFile(binPath.c_str(), doc);
+    return true;
+}
+
+bool StorageManager::saveDocument(const char* path, const JsonDocument& doc) {
+    return writeRecordFile(recordPath(path).c_str(), doc);
+}
+
+bool StorageManager::readRecordFile(const char* path, JsonDocument& doc) {
+    if (!initialized || !LittleFS.exists(path)) {
+        return false;
+    }
+    
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> data(file.size());
+    bool complete = file.read(data.data(), data.size()) == data.size();
+    file.close();
+    
+    const uint8_t* payload = nullptr;
+    size_t len = 0;
+    const char* why = complete ? flashRecordOpen(data.data(), data.size(), FLASH_RECORD_MSGPACK, &payload, &len)
+                               : "short read";
+    if (!why) {
+        DeserializationError error = deserializeMsgPack(doc, payload, len);
+        if (error) {
+            why = error.c_str();
+        }
+    }
+    if (why) {
+        Serial.printf("Ignoring %s: %s\n", path, why);
+        rejectedRecords++;
+        doc.clear();
+        return false;
+    }
+    return true;
+}
+
+bool StorageManager::writeRecordFile(const char* path, const JsonDocument& doc) {
+    if (!initialized) {
+        Serial.println("Storage not initialized");
+        return false;
+    }
+    
+    uint32_t start = millis();
+    std::vector<uint8_t> data(FLASH_RECORD_HEADER + measureMsgPack(doc));
+    size_t len = serializeMsgPack(doc, data.data() + FLASH_RECORD_HEADER, data.size() - FLASH_RECORD_HEADER);
+    size_t size = flashRecordSeal(data.data(), len, FLASH_RECORD_MSGPACK);
+    
+    // Written beside the old record and renamed over it, so a reset
+    // mid-write leaves the previous version rather than half a file
+    String tmpPath = String(path) + ".tmp";
+    File file = LittleFS.open(tmpPath, "w");
+    if (!file) {
+        Serial.printf("Failed to open file for writing: %s\n", tmpPath.c_str());
+        return false;
+    }
+    bool ok = file.write(data.data(), size) == size;
+    file.close();
+    if (!ok || !LittleFS.rename(tmpPath, path)) {
+        Serial.printf("Failed to write %s\n", path);
+        LittleFS.remove(tmpPath);
+        return false;
+    }
+    
+    recordSaves++;
+    bytesWritten += size;
+    lastSaveMs = millis() - start;
+    lastRecordBytes = size;
+    lastJsonBytes = measureJson(doc);
+    Serial.printf("Wrote %s (%u bytes, %u as JSON) in %u ms\n", path, (unsigned)size, (unsigned)lastJsonBytes,
+                  (unsigned)lastSaveMs);
+    return true;
+}
+
+void StorageManager::getStatusJson(JsonObject obj) {
+    obj["total"] = getTotalSpace();
+    obj["used"] = getUsedSpace();
+    obj["record_loads"] = recordLoads;
+    obj["record_saves"] = recordSaves;
+    obj["json_imports"] = jsonImports;
+    obj["rejected_records"] = rejectedRecords;
+    obj["bytes_written"] = bytesWritten;
+    obj["last_load_ms"] = lastLoadMs;
+    obj["last_save_ms"] = lastSaveMs;
+    obj["last_record_bytes"] = lastRecordBytes;
+    obj["last_json_bytes"] = lastJsonBytes;
 }
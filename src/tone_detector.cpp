@@ -0,0 +1,512 @@
+#include "tone_detector.h"
+#include <math.h>
+#include <string.h>
+
+// DTMF / fixed-tone detection - portable Goertzel bank and detector
+
+static const float DTMF_ROWS[4] = { 697.0f, 770.0f, 852.0f, 941.0f };
+static const float DTMF_COLS[4] = { 1209.0f, 1336.0f, 1477.0f, 1633.0f };
+static const char DTMF_KEYS[4][4] = {
+    { '1', '2', '3', 'A' },
+    { '4', '5', '6', 'B' },
+    { '7', '8', '9', 'C' },
+    { '*', '0', '#', 'D' }
+};
+
+static inline float dbToPowerRatio(float db) {
+    return powf(10.0f, db / 10.0f);
+}
+
+// ============================================
+// GoertzelBank
+// ============================================
+
+GoertzelBank::GoertzelBank()
+    : count(0),
+      blockSamples(TONE_DEFAULT_BLOCK),
+      position(0),
+      energy(0),
+      energyAcc(0) {
+    memset(coeff, 0, sizeof(coeff));
+    memset(s1, 0, sizeof(s1));
+    memset(s2, 0, sizeof(s2));
+    memset(power, 0, sizeof(power));
+}
+
+bool GoertzelBank::begin(const float* freqs, int n, int block) {
+    if (n <= 0 || n > TONE_MAX_FREQS || block < 64) {
+        return false;
+    }
+
+    for (int i = 0; i < n; i++) {
+        // Below ~100 Hz the resonator state can outgrow int32 at full scale
+        if (freqs[i] < 100.0f || freqs[i] >= SAMPLE_RATE / 2) {
+            return false;
+        }
+        float w = 2.0f * (float)M_PI * freqs[i] / SAMPLE_RATE;
+        coeff[i] = (int32_t)lroundf(2.0f * cosf(w) * (1 << TONE_COEFF_SHIFT));
+    }
+
+    count = n;
+    blockSamples = block;
+    position = 0;
+    energyAcc = 0;
+    memset(s1, 0, sizeof(s1));
+    memset(s2, 0, sizeof(s2));
+    return true;
+}
+
+size_t GoertzelBank::feed(const int16_t* samples, size_t n, bool* blockDone) {
+    size_t take = (size_t)(blockSamples - position);
+    if (take > n) take = n;
+
+    // One resonator at a time keeps its state in registers
+    for (int i = 0; i < count; i++) {
+        const int64_t c = coeff[i];
+        int32_t a = s1[i], b = s2[i];
+        for (size_t k = 0; k < take; k++) {
+            int32_t s0 = samples[k] + (int32_t)((c * a) >> TONE_COEFF_SHIFT) - b;
+            b = a;
+            a = s0;
+        }
+        s1[i] = a;
+        s2[i] = b;
+    }
+
+    int64_t e = 0;
+    for (size_t k = 0; k < take; k++) {
+        e += (int32_t)samples[k] * samples[k];
+    }
+    energyAcc += e;
+    position += take;
+
+    *blockDone = position >= blockSamples;
+    if (*blockDone) {
+        for (int i = 0; i < count; i++) {
+            int64_t a = s1[i], b = s2[i];
+            power[i] = a * a + b * b - ((coeff[i] * a) >> TONE_COEFF_SHIFT) * b;
+            if (power[i] < 0) power[i] = 0;
+            s1[i] = 0;
+            s2[i] = 0;
+        }
+        energy = energyAcc;
+        energyAcc = 0;
+        position = 0;
+    }
+    return take;
+}
+
+// ============================================
+// ToneDetector
+// ============================================
+
+ToneDetector::ToneDetector()
+    : firstCustom(0),
+      minPower(0),
+      blocks(0),
+      dtmfCandidate(0),
+      dtmfRun(0),
+      dtmfGap(0),
+      dtmfLatched(false),
+      lastDigitBlock(0) {
+    defaultConfig(cfg);
+    memset(customRun, 0, sizeof(customRun));
+    memset(customLatched, 0, sizeof(customLatched));
+    sequence[0] = '\0';
+}
+
+void ToneDetector::defaultConfig(ToneDetectorConfig& c) {
+    memset(&c, 0, sizeof(c));
+    c.dtmf = true;
+    c.blockSamples = TONE_DEFAULT_BLOCK;
+    c.minLevelDbfs = -36.0f;
+    c.maxTwistDb = 8.0f;
+    c.maxReverseTwistDb = 8.0f;
+    c.minPeakRatioDb = 8.0f;
+    c.minPurity = 0.6f;
+    c.minBlocks = 2;                // 40 ms (ITU-T Q.24 minimum digit length)
+    c.sequenceTimeoutBlocks = 150;  // 3 s
+}
+
+bool ToneDetector::begin(const ToneDetectorConfig& config) {
+    cfg = config;
+    if (cfg.customCount > TONE_MAX_CUSTOM) cfg.customCount = TONE_MAX_CUSTOM;
+    if (cfg.minBlocks == 0) cfg.minBlocks = 1;
+
+    float freqs[TONE_MAX_FREQS];
+    int n = 0;
+    if (cfg.dtmf) {
+        for (int i = 0; i < 4; i++) freqs[n++] = DTMF_ROWS[i];
+        for (int i = 0; i < 4; i++) freqs[n++] = DTMF_COLS[i];
+    }
+    firstCustom = n;
+    for (int i = 0; i < cfg.customCount; i++) {
+        freqs[n++] = cfg.custom[i].freq;
+        if (cfg.custom[i].minBlocks == 0) cfg.custom[i].minBlocks = 1;
+    }
+
+    if (!bank.begin(freqs, n, cfg.blockSamples)) {
+        return false;
+    }
+
+    // Power of a sine at minLevelDbfs: (A * N / 2)^2
+    double amplitude = pow(10.0, cfg.minLevelDbfs / 20.0) * 32768.0 * cfg.blockSamples / 2.0;
+    minPower = (int64_t)(amplitude * amplitude);
+
+    blocks = 0;
+    dtmfCandidate = 0;
+    dtmfRun = 0;
+    dtmfGap = 0;
+    dtmfLatched = false;
+    memset(customRun, 0, sizeof(customRun));
+    memset(customLatched, 0, sizeof(customLatched));
+    sequence[0] = '\0';
+    return true;
+}
+
+void ToneDetector::clearSequence() {
+    sequence[0] = '\0';
+}
+
+float ToneDetector::toDbfs(int64_t power) const {
+    double fullScale = 32768.0 * cfg.blockSamples / 2.0;
+    return (float)(10.0 * log10((double)power + 1.0) - 20.0 * log10(fullScale));
+}
+
+char ToneDetector::classifyDtmf(float* levelDbfs) {
+    // Strongest and runner-up in each group
+    int row = 0, col = 0;
+    int64_t rowNext = 0, colNext = 0;
+    for (int i = 1; i < 4; i++) {
+        if (bank.getPower(i) > bank.getPower(row)) {
+            rowNext = bank.getPower(row);
+            row = i;
+        } else if (bank.getPower(i) > rowNext) {
+            rowNext = bank.getPower(i);
+        }
+        if (bank.getPower(4 + i) > bank.getPower(4 + col)) {
+            colNext = bank.getPower(4 + col);
+            col = i;
+        } else if (bank.getPower(4 + i) > colNext) {
+            colNext = bank.getPower(4 + i);
+        }
+    }
+
+    float pr = (float)bank.getPower(row);
+    float pc = (float)bank.getPower(4 + col);
+
+    // Level: both tones present
+    if (bank.getPower(row) < minPower || bank.getPower(4 + col) < minPower) return 0;
+
+    // Twist: the two groups at comparable levels
+    if (pc > pr * dbToPowerRatio(cfg.maxTwistDb)) return 0;
+    if (pr > pc * dbToPowerRatio(cfg.maxReverseTwistDb)) return 0;
+
+    // Each tone clearly above its neighbours in the group
+    float peak = dbToPowerRatio(cfg.minPeakRatioDb);
+    if (pr < rowNext * peak || pc < colNext * peak) return 0;
+
+    // Purity: the pair carries most of the block energy (rejects speech/music)
+    double toneEnergy = 2.0 * ((double)pr + pc) / cfg.blockSamples;
+    if (toneEnergy < cfg.minPurity * (double)bank.getEnergy()) return 0;
+
+    *levelDbfs = toDbfs(bank.getPower(row) > bank.getPower(4 + col) ? bank.getPower(row) : bank.getPower(4 + col));
+    return DTMF_KEYS[row][col];
+}
+
+bool ToneDetector::validateCustom(int index, float* levelDbfs) {
+    int64_t p = bank.getPower(firstCustom + index);
+    if (p < minPower) return false;
+
+    double toneEnergy = 2.0 * (double)p / cfg.blockSamples;
+    if (toneEnergy < cfg.minPurity * (double)bank.getEnergy()) return false;
+
+    *levelDbfs = toDbfs(p);
+    return true;
+}
+
+void ToneDetector::fillEvent(ToneEvent& ev, const char* symbol, bool dtmf, float level) {
+    strncpy(ev.symbol, symbol, TONE_NAME_LEN - 1);
+    ev.symbol[TONE_NAME_LEN - 1] = '\0';
+    memcpy(ev.sequence, sequence, sizeof(ev.sequence));
+    ev.dtmf = dtmf;
+    ev.levelDbfs = level;
+}
+
+int ToneDetector::process(const int16_t* samples, size_t count, ToneEvent* events, int maxEvents) {
+    int produced = 0;
+
+    while (count > 0) {
+        bool done = false;
+        size_t used = bank.feed(samples, count, &done);
+        samples += used;
+        count -= used;
+        if (!done) {
+            break;
+        }
+        blocks++;
+
+        if (cfg.dtmf) {
+            float level = 0;
+            char sym = classifyDtmf(&level);
+
+            if (sym != 0 && sym == dtmfCandidate) {
+                if (dtmfRun < 255) dtmfRun++;
+                dtmfGap = 0;
+            } else if (sym == 0 && dtmfLatched && ++dtmfGap < 2) {
+                // Tolerate one dropped block inside a held digit
+            } else {
+                dtmfCandidate = sym;
+                dtmfRun = sym ? 1 : 0;
+                dtmfGap = 0;
+                dtmfLatched = false;
+            }
+
+            if (sym != 0 && !dtmfLatched && dtmfRun >= cfg.minBlocks) {
+                dtmfLatched = true;
+
+                if (blocks - lastDigitBlock > cfg.sequenceTimeoutBlocks) {
+                    sequence[0] = '\0';
+                }
+                size_t len = strlen(sequence);
+                if (len >= TONE_SEQUENCE_LEN) {
+                    memmove(sequence, sequence + 1, len);
+                    len--;
+                }
+                sequence[len] = sym;
+                sequence[len + 1] = '\0';
+                lastDigitBlock = blocks;
+
+                if (produced < maxEvents) {
+                    char name[2] = { sym, '\0' };
+                    fillEvent(events[produced++], name, true, level);
+                }
+            }
+        }
+
+        for (int i = 0; i < cfg.customCount; i++) {
+            float level = 0;
+            if (validateCustom(i, &level)) {
+                if (customRun[i] < 255) customRun[i]++;
+            } else {
+                customRun[i] = 0;
+                customLatched[i] = false;
+            }
+
+            if (!customLatched[i] && customRun[i] >= cfg.custom[i].minBlocks) {
+                customLatched[i] = true;
+                if (produced < maxEvents) {
+                    fillEvent(events[produced++], cfg.custom[i].name, false, level);
+                }
+            }
+        }
+    }
+
+    return produced;
+}
+
+// ============================================
+// Device integration
+// ============================================
+#ifdef ARDUINO
+#include "mqtt_client.h"
+#include "action_executor.h"
+#include "config.h"
+
+ToneMonitor toneMonitor;
+
+static const char* DTMF_SYMBOLS = "0123456789*#ABCD";
+
+ToneMonitor::ToneMonitor()
+    : enabled(false),
+      actionCount(0),
+      pendingHead(0),
+      pendingTail(0),
+      discoveryPublished(false),
+      lastEventTime(0) {
+    memset(&stats, 0, sizeof(stats));
+    memset(&lastEvent, 0, sizeof(lastEvent));
+}
+
+void ToneMonitor::begin(JsonDocument& config) {
+    JsonObject cfg = config["tones"];
+    if (!(cfg["enabled"] | false)) {
+        log_i("Tones: disabled in config");
+        return;
+    }
+
+    ToneDetectorConfig dc;
+    ToneDetector::defaultConfig(dc);
+    dc.dtmf = cfg["dtmf"] | true;
+    dc.blockSamples = constrain(cfg["block_samples"] | TONE_DEFAULT_BLOCK, 128, 2048);
+    dc.minLevelDbfs = cfg["min_level_dbfs"] | dc.minLevelDbfs;
+    dc.maxTwistDb = cfg["max_twist_db"] | dc.maxTwistDb;
+    dc.maxReverseTwistDb = cfg["max_reverse_twist_db"] | dc.maxReverseTwistDb;
+    dc.minPeakRatioDb = cfg["min_peak_ratio_db"] | dc.minPeakRatioDb;
+    dc.minPurity = cfg["min_purity"] | dc.minPurity;
+
+    float blockMs = dc.blockSamples * 1000.0f / SAMPLE_RATE;
+    dc.minBlocks = constrain((int)ceilf((cfg["min_duration_ms"] | 40) / blockMs), 1, 50);
+    dc.sequenceTimeoutBlocks = (uint16_t)((cfg["sequence_timeout_ms"] | 3000) / blockMs);
+
+    for (JsonObject tone : cfg["custom"].as<JsonArray>()) {
+        if (dc.customCount >= TONE_MAX_CUSTOM) break;
+        ToneDetectorConfig::Custom& c = dc.custom[dc.customCount];
+        strlcpy(c.name, tone["name"] | "tone", sizeof(c.name));
+        c.freq = tone["freq"] | 0.0f;
+        c.minBlocks = constrain((int)ceilf((tone["min_duration_ms"] | 100) / blockMs), 1, 255);
+        dc.customCount++;
+    }
+
+    if (!detector.begin(dc)) {
+        log_e("Tones: invalid configuration (frequencies must be 100..%d Hz)", SAMPLE_RATE / 2);
+        return;
+    }
+
+    actionCount = 0;
+    for (JsonPair kv : cfg["actions"].as<JsonObject>()) {
+        if (actionCount >= TONE_MAX_ACTIONS) break;
+        strlcpy(actions[actionCount].key, kv.key().c_str(), sizeof(actions[0].key));
+        strlcpy(actions[actionCount].action, kv.value() | "", sizeof(actions[0].action));
+        actionCount++;
+    }
+
+    enabled = true;
+    log_i("Tones: %d frequencies, %d-sample blocks (%.1f ms), %d actions",
+          detector.getBank().getCount(), dc.blockSamples, blockMs, actionCount);
+}
+
+void ToneMonitor::processFrame(const AudioFrame& frame) {
+    if (!enabled) {
+        return;
+    }
+
+    ToneEvent events[4];
+    int n = detector.process(frame.samples, frame.count, events, 4);
+    stats.blocks = detector.getBlocks();
+
+    for (int i = 0; i < n; i++) {
+        uint8_t next = (pendingHead + 1) % 4;
+        if (next == pendingTail) {
+            stats.droppedEvents++;
+            continue;
+        }
+        pending[pendingHead] = events[i];
+        pendingHead = next;
+    }
+}
+
+void ToneMonitor::loop() {
+    if (!enabled) {
+        return;
+    }
+
+    if (!discoveryPublished && mqttClient.isConnected()) {
+        publishDiscovery();
+    }
+
+    while (pendingTail != pendingHead) {
+        ToneEvent ev = pending[pendingTail];
+        pendingTail = (pendingTail + 1) % 4;
+        handleEvent(ev);
+    }
+}
+
+void ToneMonitor::handleEvent(const ToneEvent& ev) {
+    if (ev.dtmf) stats.digits++;
+    else stats.tones++;
+    lastEvent = ev;
+    lastEventTime = millis();
+
+    log_i("🎵 Tone: %s (%.0f dBFS)%s%s", ev.symbol, ev.levelDbfs,
+          ev.dtmf ? " sequence " : "", ev.dtmf ? ev.sequence : "");
+
+    JsonDocument doc;
+    doc["event_type"] = ev.symbol;
+    doc["level_dbfs"] = roundf(ev.levelDbfs);
+    if (ev.dtmf) {
+        doc["sequence"] = ev.sequence;
+    }
+    mqttClient.publishJson("entryhub/event/tone", doc);
+
+    // Exact symbol / tone name, or a DTMF code ending the current sequence
+    for (int i = 0; i < actionCount; i++) {
+        const Action& a = actions[i];
+        bool match = strcmp(a.key, ev.symbol) == 0;
+        if (!match && ev.dtmf && strlen(a.key) > 1) {
+            size_t seqLen = strlen(ev.sequence), keyLen = strlen(a.key);
+            match = seqLen >= keyLen && strcmp(ev.sequence + seqLen - keyLen, a.key) == 0;
+            if (match) {
+                detector.clearSequence();
+            }
+        }
+
+        if (match) {
+            log_i("Tones: '%s' -> %s", a.key, a.action);
+            char label[32];
+            snprintf(label, sizeof(label), "tone %s", a.key);
+            if (actionExecutor.submit(a.action, label) == ACTION_QUEUED) {
+                stats.actions++;
+            }
+        }
+    }
+}
+
+void ToneMonitor::publishDiscovery() {
+    JsonDocument doc;
+    doc["name"] = "Tone";
+    doc["unique_id"] = String(DEVICE_NAME) + "_tone";
+    doc["state_topic"] = "entryhub/event/tone";
+    doc["icon"] = "mdi:dialpad";
+
+    JsonArray types = doc["event_types"].to<JsonArray>();
+    for (const char* s = DTMF_SYMBOLS; *s; s++) {
+        char name[2] = { *s, '\0' };
+        types.add(name);
+    }
+    const ToneDetectorConfig& dc = detector.getConfig();
+    for (int i = 0; i < dc.customCount; i++) {
+        types.add(dc.custom[i].name);
+    }
+
+    JsonObject device = doc["device"].to<JsonObject>();
+    device["identifiers"][0] = DEVICE_NAME;
+    device["name"] = DEVICE_NAME;
+
+    String topic = String(HA_DISCOVERY_PREFIX) + "/event/" + DEVICE_NAME + "/tone/config";
+    mqttClient.publishJson(topic.c_str(), doc, true);
+
+    discoveryPublished = true;
+    log_i("Tones: HA discovery published");
+}
+
+void ToneMonitor::getStatusJson(JsonObject obj) {
+    obj["enabled"] = enabled;
+    if (!enabled) {
+        return;
+    }
+
+    obj["frequencies"] = detector.getBank().getCount();
+    obj["block_samples"] = detector.getBank().getBlockSamples();
+    obj["blocks"] = stats.blocks;
+    obj["digits"] = stats.digits;
+    obj["tones"] = stats.tones;
+    obj["actions"] = stats.actions;
+    obj["dropped_events"] = stats.droppedEvents;
+
+    if (lastEvent.symbol[0]) {
+        obj["last_event"] = lastEvent.symbol;
+        obj["last_sequence"] = lastEvent.sequence;
+        obj["last_event_age_s"] = (millis() - lastEventTime) / 1000;
+    }
+}
+
+ToneStage::ToneStage()
+    : AudioStage("tones", AUDIO_FORMAT_PCM16, AUDIO_FORMAT_PCM16, 300) {
+}
+
+bool ToneStage::process(AudioFrame& frame) {
+    toneMonitor.processFrame(frame);
+    return true;
+}
+#endif
@@ -0,0 +1,1303 @@
+// Generated by scripts/generate_tz_table.py - do not edit
+// tzdata 2025b: 597 zones, 94 distinct rules
+
+#define TZ_DATA_VERSION "2025b"
+#define TZ_DATA_COUNT 597
+
+static const char TZ_NAMES[] =
+    "Africa/Abidjan\0"
+    "Africa/Accra\0"
+    "Africa/Addis_Ababa\0"
+    "Africa/Algiers\0"
+    "Africa/Asmara\0"
+    "Africa/Asmera\0"
+    "Africa/Bamako\0"
+    "Africa/Bangui\0"
+    "Africa/Banjul\0"
+    "Africa/Bissau\0"
+    "Africa/Blantyre\0"
+    "Africa/Brazzaville\0"
+    "Africa/Bujumbura\0"
+    "Africa/Cairo\0"
+    "Africa/Casablanca\0"
+    "Africa/Ceuta\0"
+    "Africa/Conakry\0"
+    "Africa/Dakar\0"
+    "Africa/Dar_es_Salaam\0"
+    "Africa/Djibouti\0"
+    "Africa/Douala\0"
+    "Africa/El_Aaiun\0"
+    "Africa/Freetown\0"
+    "Africa/Gaborone\0"
+    "Africa/Harare\0"
+    "Africa/Johannesburg\0"
+    "Africa/Juba\0"
+    "Africa/Kampala\0"
+    "Africa/Khartoum\0"
+    "Africa/Kigali\0"
+    "Africa/Kinshasa\0"
+    "Africa/Lagos\0"
+    "Africa/Libreville\0"
+    "Africa/Lome\0"
+    "Africa/Luanda\0"
+    "Africa/Lubumbashi\0"
+    "Africa/Lusaka\0"
+    "Africa/Malabo\0"
+    "Africa/Maputo\0"
+    "Africa/Maseru\0"
+    "Africa/Mbabane\0"
+    "Africa/Mogadishu\0"
+    "Africa/Monrovia\0"
+    "Africa/Nairobi\0"
+    "Africa/Ndjamena\0"
+    "Africa/Niamey\0"
+    "Africa/Nouakchott\0"
+    "Africa/Ouagadougou\0"
+    "Africa/Porto-Novo\0"
+    "Africa/Sao_Tome\0"
+    "Africa/Timbuktu\0"
+    "Africa/Tripoli\0"
+    "Africa/Tunis\0"
+    "Africa/Windhoek\0"
+    "America/Adak\0"
+    "America/Anchorage\0"
+    "America/Anguilla\0"
+    "America/Antigua\0"
+    "America/Araguaina\0"
+    "America/Argentina/Buenos_Aires\0"
+    "America/Argentina/Catamarca\0"
+    "America/Argentina/ComodRivadavia\0"
+    "America/Argentina/Cordoba\0"
+    "America/Argentina/Jujuy\0"
+    "America/Argentina/La_Rioja\0"
+    "America/Argentina/Mendoza\0"
+    "America/Argentina/Rio_Gallegos\0"
+    "America/Argentina/Salta\0"
+    "America/Argentina/San_Juan\0"
+    "America/Argentina/San_Luis\0"
+    "America/Argentina/Tucuman\0"
+    "America/Argentina/Ushuaia\0"
+    "America/Aruba\0"
+    "America/Asuncion\0"
+    "America/Atikokan\0"
+    "America/Atka\0"
+    "America/Bahia\0"
+    "America/Bahia_Banderas\0"
+    "America/Barbados\0"
+    "America/Belem\0"
+    "America/Belize\0"
+    "America/Blanc-Sablon\0"
+    "America/Boa_Vista\0"
+    "America/Bogota\0"
+    "America/Boise\0"
+    "America/Buenos_Aires\0"
+    "America/Cambridge_Bay\0"
+    "America/Campo_Grande\0"
+    "America/Cancun\0"
+    "America/Caracas\0"
+    "America/Catamarca\0"
+    "America/Cayenne\0"
+    "America/Cayman\0"
+    "America/Chicago\0"
+    "America/Chihuahua\0"
+    "America/Ciudad_Juarez\0"
+    "America/Coral_Harbour\0"
+    "America/Cordoba\0"
+    "America/Costa_Rica\0"
+    "America/Coyhaique\0"
+    "America/Creston\0"
+    "America/Cuiaba\0"
+    "America/Curacao\0"
+    "America/Danmarkshavn\0"
+    "America/Dawson\0"
+    "America/Dawson_Creek\0"
+    "America/Denver\0"
+    "America/Detroit\0"
+    "America/Dominica\0"
+    "America/Edmonton\0"
+    "America/Eirunepe\0"
+    "America/El_Salvador\0"
+    "America/Ensenada\0"
+    "America/Fort_Nelson\0"
+    "America/Fort_Wayne\0"
+    "America/Fortaleza\0"
+    "America/Glace_Bay\0"
+    "America/Godthab\0"
+    "America/Goose_Bay\0"
+    "America/Grand_Turk\0"
+    "America/Grenada\0"
+    "America/Guadeloupe\0"
+    "America/Guatemala\0"
+    "America/Guayaquil\0"
+    "America/Guyana\0"
+    "America/Halifax\0"
+    "America/Havana\0"
+    "America/Hermosillo\0"
+    "America/Indiana/Indianapolis\0"
+    "America/Indiana/Knox\0"
+    "America/Indiana/Marengo\0"
+    "America/Indiana/Petersburg\0"
+    "America/Indiana/Tell_City\0"
+    "America/Indiana/Vevay\0"
+    "America/Indiana/Vincennes\0"
+    "America/Indiana/Winamac\0"
+    "America/Indianapolis\0"
+    "America/Inuvik\0"
+    "America/Iqaluit\0"
+    "America/Jamaica\0"
+    "America/Jujuy\0"
+    "America/Juneau\0"
+    "America/Kentucky/Louisville\0"
+    "America/Kentucky/Monticello\0"
+    "America/Knox_IN\0"
+    "America/Kralendijk\0"
+    "America/La_Paz\0"
+    "America/Lima\0"
+    "America/Los_Angeles\0"
+    "America/Louisville\0"
+    "America/Lower_Princes\0"
+    "America/Maceio\0"
+    "America/Managua\0"
+    "America/Manaus\0"
+    "America/Marigot\0"
+    "America/Martinique\0"
+    "America/Matamoros\0"
+    "America/Mazatlan\0"
+    "America/Mendoza\0"
+    "America/Menominee\0"
+    "America/Merida\0"
+    "America/Metlakatla\0"
+    "America/Mexico_City\0"
+    "America/Miquelon\0"
+    "America/Moncton\0"
+    "America/Monterrey\0"
+    "America/Montevideo\0"
+    "America/Montreal\0"
+    "America/Montserrat\0"
+    "America/Nassau\0"
+    "America/New_York\0"
+    "America/Nipigon\0"
+    "America/Nome\0"
+    "America/Noronha\0"
+    "America/North_Dakota/Beulah\0"
+    "America/North_Dakota/Center\0"
+    "America/North_Dakota/New_Salem\0"
+    "America/Nuuk\0"
+    "America/Ojinaga\0"
+    "America/Panama\0"
+    "America/Pangnirtung\0"
+    "America/Paramaribo\0"
+    "America/Phoenix\0"
+    "America/Port-au-Prince\0"
+    "America/Port_of_Spain\0"
+    "America/Porto_Acre\0"
+    "America/Porto_Velho\0"
+    "America/Puerto_Rico\0"
+    "America/Punta_Arenas\0"
+    "America/Rainy_River\0"
+    "America/Rankin_Inlet\0"
+    "America/Recife\0"
+    "America/Regina\0"
+    "America/Resolute\0"
+    "America/Rio_Branco\0"
+    "America/Rosario\0"
+    "America/Santa_Isabel\0"
+    "America/Santarem\0"
+    "America/Santiago\0"
+    "America/Santo_Domingo\0"
+    "America/Sao_Paulo\0"
+    "America/Scoresbysund\0"
+    "America/Shiprock\0"
+    "America/Sitka\0"
+    "America/St_Barthelemy\0"
+    "America/St_Johns\0"
+    "America/St_Kitts\0"
+    "America/St_Lucia\0"
+    "America/St_Thomas\0"
+    "America/St_Vincent\0"
+    "America/Swift_Current\0"
+    "America/Tegucigalpa\0"
+    "America/Thule\0"
+    "America/Thunder_Bay\0"
+    "America/Tijuana\0"
+    "America/Toronto\0"
+    "America/Tortola\0"
+    "America/Vancouver\0"
+    "America/Virgin\0"
+    "America/Whitehorse\0"
+    "America/Winnipeg\0"
+    "America/Yakutat\0"
+    "America/Yellowknife\0"
+    "Antarctica/Casey\0"
+    "Antarctica/Davis\0"
+    "Antarctica/DumontDUrville\0"
+    "Antarctica/Macquarie\0"
+    "Antarctica/Mawson\0"
+    "Antarctica/McMurdo\0"
+    "Antarctica/Palmer\0"
+    "Antarctica/Rothera\0"
+    "Antarctica/South_Pole\0"
+    "Antarctica/Syowa\0"
+    "Antarctica/Troll\0"
+    "Antarctica/Vostok\0"
+    "Arctic/Longyearbyen\0"
+    "Asia/Aden\0"
+    "Asia/Almaty\0"
+    "Asia/Amman\0"
+    "Asia/Anadyr\0"
+    "Asia/Aqtau\0"
+    "Asia/Aqtobe\0"
+    "Asia/Ashgabat\0"
+    "Asia/Ashkhabad\0"
+    "Asia/Atyrau\0"
+    "Asia/Baghdad\0"
+    "Asia/Bahrain\0"
+    "Asia/Baku\0"
+    "Asia/Bangkok\0"
+    "Asia/Barnaul\0"
+    "Asia/Beirut\0"
+    "Asia/Bishkek\0"
+    "Asia/Brunei\0"
+    "Asia/Calcutta\0"
+    "Asia/Chita\0"
+    "Asia/Choibalsan\0"
+    "Asia/Chongqing\0"
+    "Asia/Chungking\0"
+    "Asia/Colombo\0"
+    "Asia/Dacca\0"
+    "Asia/Damascus\0"
+    "Asia/Dhaka\0"
+    "Asia/Dili\0"
+    "Asia/Dubai\0"
+    "Asia/Dushanbe\0"
+    "Asia/Famagusta\0"
+    "Asia/Gaza\0"
+    "Asia/Harbin\0"
+    "Asia/Hebron\0"
+    "Asia/Ho_Chi_Minh\0"
+    "Asia/Hong_Kong\0"
+    "Asia/Hovd\0"
+    "Asia/Irkutsk\0"
+    "Asia/Istanbul\0"
+    "Asia/Jakarta\0"
+    "Asia/Jayapura\0"
+    "Asia/Jerusalem\0"
+    "Asia/Kabul\0"
+    "Asia/Kamchatka\0"
+    "Asia/Karachi\0"
+    "Asia/Kashgar\0"
+    "Asia/Kathmandu\0"
+    "Asia/Katmandu\0"
+    "Asia/Khandyga\0"
+    "Asia/Kolkata\0"
+    "Asia/Krasnoyarsk\0"
+    "Asia/Kuala_Lumpur\0"
+    "Asia/Kuching\0"
+    "Asia/Kuwait\0"
+    "Asia/Macao\0"
+    "Asia/Macau\0"
+    "Asia/Magadan\0"
+    "Asia/Makassar\0"
+    "Asia/Manila\0"
+    "Asia/Muscat\0"
+    "Asia/Nicosia\0"
+    "Asia/Novokuznetsk\0"
+    "Asia/Novosibirsk\0"
+    "Asia/Omsk\0"
+    "Asia/Oral\0"
+    "Asia/Phnom_Penh\0"
+    "Asia/Pontianak\0"
+    "Asia/Pyongyang\0"
+    "Asia/Qatar\0"
+    "Asia/Qostanay\0"
+    "Asia/Qyzylorda\0"
+    "Asia/Rangoon\0"
+    "Asia/Riyadh\0"
+    "Asia/Saigon\0"
+    "Asia/Sakhalin\0"
+    "Asia/Samarkand\0"
+    "Asia/Seoul\0"
+    "Asia/Shanghai\0"
+    "Asia/Singapore\0"
+    "Asia/Srednekolymsk\0"
+    "Asia/Taipei\0"
+    "Asia/Tashkent\0"
+    "Asia/Tbilisi\0"
+    "Asia/Tehran\0"
+    "Asia/Tel_Aviv\0"
+    "Asia/Thimbu\0"
+    "Asia/Thimphu\0"
+    "Asia/Tokyo\0"
+    "Asia/Tomsk\0"
+    "Asia/Ujung_Pandang\0"
+    "Asia/Ulaanbaatar\0"
+    "Asia/Ulan_Bator\0"
+    "Asia/Urumqi\0"
+    "Asia/Ust-Nera\0"
+    "Asia/Vientiane\0"
+    "Asia/Vladivostok\0"
+    "Asia/Yakutsk\0"
+    "Asia/Yangon\0"
+    "Asia/Yekaterinburg\0"
+    "Asia/Yerevan\0"
+    "Atlantic/Azores\0"
+    "Atlantic/Bermuda\0"
+    "Atlantic/Canary\0"
+    "Atlantic/Cape_Verde\0"
+    "Atlantic/Faeroe\0"
+    "Atlantic/Faroe\0"
+    "Atlantic/Jan_Mayen\0"
+    "Atlantic/Madeira\0"
+    "Atlantic/Reykjavik\0"
+    "Atlantic/South_Georgia\0"
+    "Atlantic/St_Helena\0"
+    "Atlantic/Stanley\0"
+    "Australia/ACT\0"
+    "Australia/Adelaide\0"
+    "Australia/Brisbane\0"
+    "Australia/Broken_Hill\0"
+    "Australia/Canberra\0"
+    "Australia/Currie\0"
+    "Australia/Darwin\0"
+    "Australia/Eucla\0"
+    "Australia/Hobart\0"
+    "Australia/LHI\0"
+    "Australia/Lindeman\0"
+    "Australia/Lord_Howe\0"
+    "Australia/Melbourne\0"
+    "Australia/NSW\0"
+    "Australia/North\0"
+    "Australia/Perth\0"
+    "Australia/Queensland\0"
+    "Australia/South\0"
+    "Australia/Sydney\0"
+    "Australia/Tasmania\0"
+    "Australia/Victoria\0"
+    "Australia/West\0"
+    "Australia/Yancowinna\0"
+    "Brazil/Acre\0"
+    "Brazil/DeNoronha\0"
+    "Brazil/East\0"
+    "Brazil/West\0"
+    "CET\0"
+    "CST6CDT\0"
+    "Canada/Atlantic\0"
+    "Canada/Central\0"
+    "Canada/Eastern\0"
+    "Canada/Mountain\0"
+    "Canada/Newfoundland\0"
+    "Canada/Pacific\0"
+    "Canada/Saskatchewan\0"
+    "Canada/Yukon\0"
+    "Chile/Continental\0"
+    "Chile/EasterIsland\0"
+    "Cuba\0"
+    "EET\0"
+    "EST\0"
+    "EST5EDT\0"
+    "Egypt\0"
+    "Eire\0"
+    "Etc/GMT\0"
+    "Etc/GMT+0\0"
+    "Etc/GMT+1\0"
+    "Etc/GMT+10\0"
+    "Etc/GMT+11\0"
+    "Etc/GMT+12\0"
+    "Etc/GMT+2\0"
+    "Etc/GMT+3\0"
+    "Etc/GMT+4\0"
+    "Etc/GMT+5\0"
+    "Etc/GMT+6\0"
+    "Etc/GMT+7\0"
+    "Etc/GMT+8\0"
+    "Etc/GMT+9\0"
+    "Etc/GMT-0\0"
+    "Etc/GMT-1\0"
+    "Etc/GMT-10\0"
+    "Etc/GMT-11\0"
+    "Etc/GMT-12\0"
+    "Etc/GMT-13\0"
+    "Etc/GMT-14\0"
+    "Etc/GMT-2\0"
+    "Etc/GMT-3\0"
+    "Etc/GMT-4\0"
+    "Etc/GMT-5\0"
+    "Etc/GMT-6\0"
+    "Etc/GMT-7\0"
+    "Etc/GMT-8\0"
+    "Etc/GMT-9\0"
+    "Etc/GMT0\0"
+    "Etc/Greenwich\0"
+    "Etc/UCT\0"
+    "Etc/UTC\0"
+    "Etc/Universal\0"
+    "Etc/Zulu\0"
+    "Europe/Amsterdam\0"
+    "Europe/Andorra\0"
+    "Europe/Astrakhan\0"
+    "Europe/Athens\0"
+    "Europe/Belfast\0"
+    "Europe/Belgrade\0"
+    "Europe/Berlin\0"
+    "Europe/Bratislava\0"
+    "Europe/Brussels\0"
+    "Europe/Bucharest\0"
+    "Europe/Budapest\0"
+    "Europe/Busingen\0"
+    "Europe/Chisinau\0"
+    "Europe/Copenhagen\0"
+    "Europe/Dublin\0"
+    "Europe/Gibraltar\0"
+    "Europe/Guernsey\0"
+    "Europe/Helsinki\0"
+    "Europe/Isle_of_Man\0"
+    "Europe/Istanbul\0"
+    "Europe/Jersey\0"
+    "Europe/Kaliningrad\0"
+    "Europe/Kiev\0"
+    "Europe/Kirov\0"
+    "Europe/Kyiv\0"
+    "Europe/Lisbon\0"
+    "Europe/Ljubljana\0"
+    "Europe/London\0"
+    "Europe/Luxembourg\0"
+    "Europe/Madrid\0"
+    "Europe/Malta\0"
+    "Europe/Mariehamn\0"
+    "Europe/Minsk\0"
+    "Europe/Monaco\0"
+    "Europe/Moscow\0"
+    "Europe/Nicosia\0"
+    "Europe/Oslo\0"
+    "Europe/Paris\0"
+    "Europe/Podgorica\0"
+    "Europe/Prague\0"
+    "Europe/Riga\0"
+    "Europe/Rome\0"
+    "Europe/Samara\0"
+    "Europe/San_Marino\0"
+    "Europe/Sarajevo\0"
+    "Europe/Saratov\0"
+    "Europe/Simferopol\0"
+    "Europe/Skopje\0"
+    "Europe/Sofia\0"
+    "Europe/Stockholm\0"
+    "Europe/Tallinn\0"
+    "Europe/Tirane\0"
+    "Europe/Tiraspol\0"
+    "Europe/Ulyanovsk\0"
+    "Europe/Uzhgorod\0"
+    "Europe/Vaduz\0"
+    "Europe/Vatican\0"
+    "Europe/Vienna\0"
+    "Europe/Vilnius\0"
+    "Europe/Volgograd\0"
+    "Europe/Warsaw\0"
+    "Europe/Zagreb\0"
+    "Europe/Zaporozhye\0"
+    "Europe/Zurich\0"
+    "GB\0"
+    "GB-Eire\0"
+    "GMT\0"
+    "GMT+0\0"
+    "GMT-0\0"
+    "GMT0\0"
+    "Greenwich\0"
+    "HST\0"
+    "Hongkong\0"
+    "Iceland\0"
+    "Indian/Antananarivo\0"
+    "Indian/Chagos\0"
+    "Indian/Christmas\0"
+    "Indian/Cocos\0"
+    "Indian/Comoro\0"
+    "Indian/Kerguelen\0"
+    "Indian/Mahe\0"
+    "Indian/Maldives\0"
+    "Indian/Mauritius\0"
+    "Indian/Mayotte\0"
+    "Indian/Reunion\0"
+    "Iran\0"
+    "Israel\0"
+    "Jamaica\0"
+    "Japan\0"
+    "Kwajalein\0"
+    "Libya\0"
+    "MET\0"
+    "MST\0"
+    "MST7MDT\0"
+    "Mexico/BajaNorte\0"
+    "Mexico/BajaSur\0"
+    "Mexico/General\0"
+    "NZ\0"
+    "NZ-CHAT\0"
+    "Navajo\0"
+    "PRC\0"
+    "PST8PDT\0"
+    "Pacific/Apia\0"
+    "Pacific/Auckland\0"
+    "Pacific/Bougainville\0"
+    "Pacific/Chatham\0"
+    "Pacific/Chuuk\0"
+    "Pacific/Easter\0"
+    "Pacific/Efate\0"
+    "Pacific/Enderbury\0"
+    "Pacific/Fakaofo\0"
+    "Pacific/Fiji\0"
+    "Pacific/Funafuti\0"
+    "Pacific/Galapagos\0"
+    "Pacific/Gambier\0"
+    "Pacific/Guadalcanal\0"
+    "Pacific/Guam\0"
+    "Pacific/Honolulu\0"
+    "Pacific/Johnston\0"
+    "Pacific/Kanton\0"
+    "Pacific/Kiritimati\0"
+    "Pacific/Kosrae\0"
+    "Pacific/Kwajalein\0"
+    "Pacific/Majuro\0"
+    "Pacific/Marquesas\0"
+    "Pacific/Midway\0"
+    "Pacific/Nauru\0"
+    "Pacific/Niue\0"
+    "Pacific/Norfolk\0"
+    "Pacific/Noumea\0"
+    "Pacific/Pago_Pago\0"
+    "Pacific/Palau\0"
+    "Pacific/Pitcairn\0"
+    "Pacific/Pohnpei\0"
+    "Pacific/Ponape\0"
+    "Pacific/Port_Moresby\0"
+    "Pacific/Rarotonga\0"
+    "Pacific/Saipan\0"
+    "Pacific/Samoa\0"
+    "Pacific/Tahiti\0"
+    "Pacific/Tarawa\0"
+    "Pacific/Tongatapu\0"
+    "Pacific/Truk\0"
+    "Pacific/Wake\0"
+    "Pacific/Wallis\0"
+    "Pacific/Yap\0"
+    "Poland\0"
+    "Portugal\0"
+    "ROC\0"
+    "ROK\0"
+    "Singapore\0"
+    "Turkey\0"
+    "UCT\0"
+    "US/Alaska\0"
+    "US/Aleutian\0"
+    "US/Arizona\0"
+    "US/Central\0"
+    "US/East-Indiana\0"
+    "US/Eastern\0"
+    "US/Hawaii\0"
+    "US/Indiana-Starke\0"
+    "US/Michigan\0"
+    "US/Mountain\0"
+    "US/Pacific\0"
+    "US/Samoa\0"
+    "UTC\0"
+    "Universal\0"
+    "W-SU\0"
+    "WET\0"
+    "Zulu\0"
+    ;
+
+static const char TZ_RULES[] =
+    "<+00>0<+02>-2,M3.5.0/1,M10.5.0/3\0"
+    "<+01>-1\0"
+    "<+02>-2\0"
+    "<+0330>-3:30\0"
+    "<+03>-3\0"
+    "<+0430>-4:30\0"
+    "<+04>-4\0"
+    "<+0530>-5:30\0"
+    "<+0545>-5:45\0"
+    "<+05>-5\0"
+    "<+0630>-6:30\0"
+    "<+06>-6\0"
+    "<+07>-7\0"
+    "<+0845>-8:45\0"
+    "<+08>-8\0"
+    "<+09>-9\0"
+    "<+1030>-10:30<+11>-11,M10.1.0,M4.1.0\0"
+    "<+10>-10\0"
+    "<+11>-11\0"
+    "<+11>-11<+12>,M10.1.0,M4.1.0/3\0"
+    "<+1245>-12:45<+1345>,M9.5.0/2:45,M4.1.0/3:45\0"
+    "<+12>-12\0"
+    "<+13>-13\0"
+    "<+14>-14\0"
+    "<-01>1\0"
+    "<-01>1<+00>,M3.5.0/0,M10.5.0/1\0"
+    "<-02>2\0"
+    "<-02>2<-01>,M3.5.0/-1,M10.5.0/0\0"
+    "<-03>3\0"
+    "<-03>3<-02>,M3.2.0,M11.1.0\0"
+    "<-04>4\0"
+    "<-04>4<-03>,M9.1.6/24,M4.1.6/24\0"
+    "<-05>5\0"
+    "<-06>6\0"
+    "<-06>6<-05>,M9.1.6/22,M4.1.6/22\0"
+    "<-07>7\0"
+    "<-08>8\0"
+    "<-0930>9:30\0"
+    "<-09>9\0"
+    "<-10>10\0"
+    "<-11>11\0"
+    "<-12>12\0"
+    "ACST-9:30\0"
+    "ACST-9:30ACDT,M10.1.0,M4.1.0/3\0"
+    "AEST-10\0"
+    "AEST-10AEDT,M10.1.0,M4.1.0/3\0"
+    "AKST9AKDT,M3.2.0,M11.1.0\0"
+    "AST4\0"
+    "AST4ADT,M3.2.0,M11.1.0\0"
+    "AWST-8\0"
+    "CAT-2\0"
+    "CET-1\0"
+    "CET-1CEST,M3.5.0,M10.5.0/3\0"
+    "CST-8\0"
+    "CST5CDT,M3.2.0/0,M11.1.0/1\0"
+    "CST6\0"
+    "CST6CDT,M3.2.0,M11.1.0\0"
+    "ChST-10\0"
+    "EAT-3\0"
+    "EET-2\0"
+    "EET-2EEST,M3.4.4/50,M10.4.4/50\0"
+    "EET-2EEST,M3.5.0,M10.5.0/3\0"
+    "EET-2EEST,M3.5.0/0,M10.5.0/0\0"
+    "EET-2EEST,M3.5.0/3,M10.5.0/4\0"
+    "EET-2EEST,M4.5.5/0,M10.5.4/24\0"
+    "EST5\0"
+    "EST5EDT,M3.2.0,M11.1.0\0"
+    "GMT0\0"
+    "GMT0BST,M3.5.0/1,M10.5.0\0"
+    "HKT-8\0"
+    "HST10\0"
+    "HST10HDT,M3.2.0,M11.1.0\0"
+    "IST-1GMT0,M10.5.0,M3.5.0/1\0"
+    "IST-2IDT,M3.4.4/26,M10.5.0\0"
+    "IST-5:30\0"
+    "JST-9\0"
+    "KST-9\0"
+    "MET-1MEST,M3.5.0,M10.5.0/3\0"
+    "MSK-3\0"
+    "MST7\0"
+    "MST7MDT,M3.2.0,M11.1.0\0"
+    "NST3:30NDT,M3.2.0,M11.1.0\0"
+    "NZST-12NZDT,M9.5.0,M4.1.0/3\0"
+    "PKT-5\0"
+    "PST-8\0"
+    "PST8PDT,M3.2.0,M11.1.0\0"
+    "SAST-2\0"
+    "SST11\0"
+    "UTC0\0"
+    "WAT-1\0"
+    "WET0WEST,M3.5.0/1,M10.5.0\0"
+    "WIB-7\0"
+    "WIT-9\0"
+    "WITA-8\0"
+    ;
+
+// Offsets into TZ_NAMES and TZ_RULES, sorted by name
+static const TzEntry TZ_ENTRIES[TZ_DATA_COUNT] = {
+    { 0, 1026 },  // Africa/Abidjan
+    { 15, 1026 },  // Africa/Accra
+    { 28, 840 },  // Africa/Addis_Ababa
+    { 47, 738 },  // Africa/Algiers
+    { 62, 840 },  // Africa/Asmara
+    { 76, 840 },  // Africa/Asmera
+    { 90, 1026 },  // Africa/Bamako
+    { 104, 1335 },  // Africa/Bangui
+    { 118, 1026 },  // Africa/Banjul
+    { 132, 1026 },  // Africa/Bissau
+    { 146, 732 },  // Africa/Blantyre
+    { 162, 1335 },  // Africa/Brazzaville
+    { 181, 732 },  // Africa/Bujumbura
+    { 198, 968 },  // Africa/Cairo
+    { 211, 33 },  // Africa/Casablanca
+    { 229, 744 },  // Africa/Ceuta
+    { 242, 1026 },  // Africa/Conakry
+    { 257, 1026 },  // Africa/Dakar
+    { 270, 840 },  // Africa/Dar_es_Salaam
+    { 291, 840 },  // Africa/Djibouti
+    { 307, 1335 },  // Africa/Douala
+    { 321, 33 },  // Africa/El_Aaiun
+    { 337, 1026 },  // Africa/Freetown
+    { 353, 732 },  // Africa/Gaborone
+    { 369, 732 },  // Africa/Harare
+    { 383, 1317 },  // Africa/Johannesburg
+    { 403, 732 },  // Africa/Juba
+    { 415, 840 },  // Africa/Kampala
+    { 430, 732 },  // Africa/Khartoum
+    { 446, 732 },  // Africa/Kigali
+    { 460, 1335 },  // Africa/Kinshasa
+    { 476, 1335 },  // Africa/Lagos
+    { 489, 1335 },  // Africa/Libreville
+    { 507, 1026 },  // Africa/Lome
+    { 519, 1335 },  // Africa/Luanda
+    { 533, 732 },  // Africa/Lubumbashi
+    { 551, 732 },  // Africa/Lusaka
+    { 565, 1335 },  // Africa/Malabo
+    { 579, 732 },  // Africa/Maputo
+    { 593, 1317 },  // Africa/Maseru
+    { 607, 1317 },  // Africa/Mbabane
+    { 622, 840 },  // Africa/Mogadishu
+    { 639, 1026 },  // Africa/Monrovia
+    { 655, 840 },  // Africa/Nairobi
+    { 670, 1335 },  // Africa/Ndjamena
+    { 686, 1335 },  // Africa/Niamey
+    { 700, 1026 },  // Africa/Nouakchott
+    { 718, 1026 },  // Africa/Ouagadougou
+    { 737, 1335 },  // Africa/Porto-Novo
+    { 755, 1026 },  // Africa/Sao_Tome
+    { 771, 1026 },  // Africa/Timbuktu
+    { 787, 846 },  // Africa/Tripoli
+    { 802, 738 },  // Africa/Tunis
+    { 815, 732 },  // Africa/Windhoek
+    { 831, 1068 },  // America/Adak
+    { 844, 672 },  // America/Anchorage
+    { 862, 697 },  // America/Anguilla
+    { 879, 697 },  // America/Antigua
+    { 895, 418 },  // America/Araguaina
+    { 913, 418 },  // America/Argentina/Buenos_Aires
+    { 944, 418 },  // America/Argentina/Catamarca
+    { 972, 418 },  // America/Argentina/ComodRivadavia
+    { 1005, 418 },  // America/Argentina/Cordoba
+    { 1031, 418 },  // America/Argentina/Jujuy
+    { 1055, 418 },  // America/Argentina/La_Rioja
+    { 1082, 418 },  // America/Argentina/Mendoza
+    { 1108, 418 },  // America/Argentina/Rio_Gallegos
+    { 1139, 418 },  // America/Argentina/Salta
+    { 1163, 418 },  // America/Argentina/San_Juan
+    { 1190, 418 },  // America/Argentina/San_Luis
+    { 1217, 418 },  // America/Argentina/Tucuman
+    { 1243, 418 },  // America/Argentina/Ushuaia
+    { 1269, 697 },  // America/Aruba
+    { 1283, 418 },  // America/Asuncion
+    { 1300, 998 },  // America/Atikokan
+    { 1317, 1068 },  // America/Atka
+    { 1330, 418 },  // America/Bahia
+    { 1344, 804 },  // America/Bahia_Banderas
+    { 1367, 697 },  // America/Barbados
+    { 1384, 418 },  // America/Belem
+    { 1398, 804 },  // America/Belize
+    { 1413, 697 },  // America/Blanc-Sablon
+    { 1434, 452 },  // America/Boa_Vista
+    { 1452, 491 },  // America/Bogota
+    { 1467, 1205 },  // America/Boise
+    { 1481, 418 },  // America/Buenos_Aires
+    { 1502, 1205 },  // America/Cambridge_Bay
+    { 1524, 452 },  // America/Campo_Grande
+    { 1545, 998 },  // America/Cancun
+    { 1560, 452 },  // America/Caracas
+    { 1576, 418 },  // America/Catamarca
+    { 1594, 418 },  // America/Cayenne
+    { 1610, 998 },  // America/Cayman
+    { 1625, 809 },  // America/Chicago
+    { 1641, 804 },  // America/Chihuahua
+    { 1659, 1205 },  // America/Ciudad_Juarez
+    { 1681, 998 },  // America/Coral_Harbour
+    { 1703, 418 },  // America/Cordoba
+    { 1719, 804 },  // America/Costa_Rica
+    { 1738, 418 },  // America/Coyhaique
+    { 1756, 1200 },  // America/Creston
+    { 1772, 452 },  // America/Cuiaba
+    { 1787, 697 },  // America/Curacao
+    { 1803, 1026 },  // America/Danmarkshavn
+    { 1824, 1200 },  // America/Dawson
+    { 1839, 1200 },  // America/Dawson_Creek
+    { 1860, 1205 },  // America/Denver
+    { 1875, 1003 },  // America/Detroit
+    { 1891, 697 },  // America/Dominica
+    { 1908, 1205 },  // America/Edmonton
+    { 1925, 491 },  // America/Eirunepe
+    { 1942, 804 },  // America/El_Salvador
+    { 1962, 1294 },  // America/Ensenada
+    { 1979, 1200 },  // America/Fort_Nelson
+    { 1999, 1003 },  // America/Fort_Wayne
+    { 2018, 418 },  // America/Fortaleza
+    { 2036, 702 },  // America/Glace_Bay
+    { 2054, 386 },  // America/Godthab
+    { 2070, 702 },  // America/Goose_Bay
+    { 2088, 1003 },  // America/Grand_Turk
+    { 2107, 697 },  // America/Grenada
+    { 2123, 697 },  // America/Guadeloupe
+    { 2142, 804 },  // America/Guatemala
+    { 2160, 491 },  // America/Guayaquil
+    { 2178, 452 },  // America/Guyana
+    { 2193, 702 },  // America/Halifax
+    { 2209, 777 },  // America/Havana
+    { 2224, 1200 },  // America/Hermosillo
+    { 2243, 1003 },  // America/Indiana/Indianapolis
+    { 2272, 809 },  // America/Indiana/Knox
+    { 2293, 1003 },  // America/Indiana/Marengo
+    { 2317, 1003 },  // America/Indiana/Petersburg
+    { 2344, 809 },  // America/Indiana/Tell_City
+    { 2370, 1003 },  // America/Indiana/Vevay
+    { 2392, 1003 },  // America/Indiana/Vincennes
+    { 2418, 1003 },  // America/Indiana/Winamac
+    { 2442, 1003 },  // America/Indianapolis
+    { 2463, 1205 },  // America/Inuvik
+    { 2478, 1003 },  // America/Iqaluit
+    { 2494, 998 },  // America/Jamaica
+    { 2510, 418 },  // America/Jujuy
+    { 2524, 672 },  // America/Juneau
+    { 2539, 1003 },  // America/Kentucky/Louisville
+    { 2567, 1003 },  // America/Kentucky/Monticello
+    { 2595, 809 },  // America/Knox_IN
+    { 2611, 697 },  // America/Kralendijk
+    { 2630, 452 },  // America/La_Paz
+    { 2645, 491 },  // America/Lima
+    { 2658, 1294 },  // America/Los_Angeles
+    { 2678, 1003 },  // America/Louisville
+    { 2697, 697 },  // America/Lower_Princes
+    { 2719, 418 },  // America/Maceio
+    { 2734, 804 },  // America/Managua
+    { 2750, 452 },  // America/Manaus
+    { 2765, 697 },  // America/Marigot
+    { 2781, 697 },  // America/Martinique
+    { 2800, 809 },  // America/Matamoros
+    { 2818, 1200 },  // America/Mazatlan
+    { 2835, 418 },  // America/Mendoza
+    { 2851, 809 },  // America/Menominee
+    { 2869, 804 },  // America/Merida
+    { 2884, 672 },  // America/Metlakatla
+    { 2903, 804 },  // America/Mexico_City
+    { 2923, 425 },  // America/Miquelon
+    { 2940, 702 },  // America/Moncton
+    { 2956, 804 },  // America/Monterrey
+    { 2974, 418 },  // America/Montevideo
+    { 2993, 1003 },  // America/Montreal
+    { 3010, 697 },  // America/Montserrat
+    { 3029, 1003 },  // America/Nassau
+    { 3044, 1003 },  // America/New_York
+    { 3061, 1003 },  // America/Nipigon
+    { 3077, 672 },  // America/Nome
+    { 3090, 379 },  // America/Noronha
+    { 3106, 809 },  // America/North_Dakota/Beulah
+    { 3134, 809 },  // America/North_Dakota/Center
+    { 3162, 809 },  // America/North_Dakota/New_Salem
+    { 3193, 386 },  // America/Nuuk
+    { 3206, 809 },  // America/Ojinaga
+    { 3222, 998 },  // America/Panama
+    { 3237, 1003 },  // America/Pangnirtung
+    { 3257, 418 },  // America/Paramaribo
+    { 3276, 1200 },  // America/Phoenix
+    { 3292, 1003 },  // America/Port-au-Prince
+    { 3315, 697 },  // America/Port_of_Spain
+    { 3337, 491 },  // America/Porto_Acre
+    { 3356, 452 },  // America/Porto_Velho
+    { 3376, 697 },  // America/Puerto_Rico
+    { 3396, 418 },  // America/Punta_Arenas
+    { 3417, 809 },  // America/Rainy_River
+    { 3437, 809 },  // America/Rankin_Inlet
+    { 3458, 418 },  // America/Recife
+    { 3473, 804 },  // America/Regina
+    { 3488, 809 },  // America/Resolute
+    { 3505, 491 },  // America/Rio_Branco
+    { 3524, 418 },  // America/Rosario
+    { 3540, 1294 },  // America/Santa_Isabel
+    { 3561, 418 },  // America/Santarem
+    { 3578, 459 },  // America/Santiago
+    { 3595, 697 },  // America/Santo_Domingo
+    { 3617, 418 },  // America/Sao_Paulo
+    { 3635, 386 },  // America/Scoresbysund
+    { 3656, 1205 },  // America/Shiprock
+    { 3673, 672 },  // America/Sitka
+    { 3687, 697 },  // America/St_Barthelemy
+    { 3709, 1228 },  // America/St_Johns
+    { 3726, 697 },  // America/St_Kitts
+    { 3743, 697 },  // America/St_Lucia
+    { 3760, 697 },  // America/St_Thomas
+    { 3778, 697 },  // America/St_Vincent
+    { 3797, 804 },  // America/Swift_Current
+    { 3819, 804 },  // America/Tegucigalpa
+    { 3839, 702 },  // America/Thule
+    { 3853, 1003 },  // America/Thunder_Bay
+    { 3873, 1294 },  // America/Tijuana
+    { 3889, 1003 },  // America/Toronto
+    { 3905, 697 },  // America/Tortola
+    { 3921, 1294 },  // America/Vancouver
+    { 3939, 697 },  // America/Virgin
+    { 3954, 1200 },  // America/Whitehorse
+    { 3973, 809 },  // America/Winnipeg
+    { 3990, 672 },  // America/Yakutat
+    { 4006, 1205 },  // America/Yellowknife
+    { 4026, 167 },  // Antarctica/Casey
+    { 4043, 146 },  // Antarctica/Davis
+    { 4060, 220 },  // Antarctica/DumontDUrville
+    { 4086, 643 },  // Antarctica/Macquarie
+    { 4107, 117 },  // Antarctica/Mawson
+    { 4125, 1254 },  // Antarctica/McMurdo
+    { 4144, 418 },  // Antarctica/Palmer
+    { 4162, 418 },  // Antarctica/Rothera
+    { 4181, 1254 },  // Antarctica/South_Pole
+    { 4203, 62 },  // Antarctica/Syowa
+    { 4220, 0 },  // Antarctica/Troll
+    { 4237, 117 },  // Antarctica/Vostok
+    { 4255, 744 },  // Arctic/Longyearbyen
+    { 4275, 62 },  // Asia/Aden
+    { 4285, 117 },  // Asia/Almaty
+    { 4297, 62 },  // Asia/Amman
+    { 4308, 314 },  // Asia/Anadyr
+    { 4320, 117 },  // Asia/Aqtau
+    { 4331, 117 },  // Asia/Aqtobe
+    { 4343, 117 },  // Asia/Ashgabat
+    { 4357, 117 },  // Asia/Ashkhabad
+    { 4372, 117 },  // Asia/Atyrau
+    { 4384, 62 },  // Asia/Baghdad
+    { 4397, 62 },  // Asia/Bahrain
+    { 4410, 83 },  // Asia/Baku
+    { 4420, 146 },  // Asia/Bangkok
+    { 4433, 146 },  // Asia/Barnaul
+    { 4446, 910 },  // Asia/Beirut
+    { 4458, 138 },  // Asia/Bishkek
+    { 4471, 167 },  // Asia/Brunei
+    { 4483, 1146 },  // Asia/Calcutta
+    { 4497, 175 },  // Asia/Chita
+    { 4508, 167 },  // Asia/Choibalsan
+    { 4524, 771 },  // Asia/Chongqing
+    { 4539, 771 },  // Asia/Chungking
+    { 4554, 91 },  // Asia/Colombo
+    { 4567, 138 },  // Asia/Dacca
+    { 4578, 62 },  // Asia/Damascus
+    { 4592, 138 },  // Asia/Dhaka
+    { 4603, 175 },  // Asia/Dili
+    { 4613, 83 },  // Asia/Dubai
+    { 4624, 117 },  // Asia/Dushanbe
+    { 4638, 939 },  // Asia/Famagusta
+    { 4653, 852 },  // Asia/Gaza
+    { 4663, 771 },  // Asia/Harbin
+    { 4675, 852 },  // Asia/Hebron
+    { 4687, 146 },  // Asia/Ho_Chi_Minh
+    { 4704, 1056 },  // Asia/Hong_Kong
+    { 4719, 146 },  // Asia/Hovd
+    { 4729, 167 },  // Asia/Irkutsk
+    { 4742, 62 },  // Asia/Istanbul
+    { 4756, 1367 },  // Asia/Jakarta
+    { 4769, 1373 },  // Asia/Jayapura
+    { 4783, 1119 },  // Asia/Jerusalem
+    { 4798, 70 },  // Asia/Kabul
+    { 4809, 314 },  // Asia/Kamchatka
+    { 4824, 1282 },  // Asia/Karachi
+    { 4837, 138 },  // Asia/Kashgar
+    { 4850, 104 },  // Asia/Kathmandu
+    { 4865, 104 },  // Asia/Katmandu
+    { 4879, 175 },  // Asia/Khandyga
+    { 4893, 1146 },  // Asia/Kolkata
+    { 4906, 146 },  // Asia/Krasnoyarsk
+    { 4923, 167 },  // Asia/Kuala_Lumpur
+    { 4941, 167 },  // Asia/Kuching
+    { 4954, 62 },  // Asia/Kuwait
+    { 4966, 771 },  // Asia/Macao
+    { 4977, 771 },  // Asia/Macau
+    { 4988, 229 },  // Asia/Magadan
+    { 5001, 1379 },  // Asia/Makassar
+    { 5015, 1288 },  // Asia/Manila
+    { 5027, 83 },  // Asia/Muscat
+    { 5039, 939 },  // Asia/Nicosia
+    { 5052, 146 },  // Asia/Novokuznetsk
+    { 5070, 146 },  // Asia/Novosibirsk
+    { 5087, 138 },  // Asia/Omsk
+    { 5097, 117 },  // Asia/Oral
+    { 5107, 146 },  // Asia/Phnom_Penh
+    { 5123, 1367 },  // Asia/Pontianak
+    { 5138, 1161 },  // Asia/Pyongyang
+    { 5153, 62 },  // Asia/Qatar
+    { 5164, 117 },  // Asia/Qostanay
+    { 5178, 117 },  // Asia/Qyzylorda
+    { 5193, 125 },  // Asia/Rangoon
+    { 5206, 62 },  // Asia/Riyadh
+    { 5218, 146 },  // Asia/Saigon
+    { 5230, 229 },  // Asia/Sakhalin
+    { 5244, 117 },  // Asia/Samarkand
+    { 5259, 1161 },  // Asia/Seoul
+    { 5270, 771 },  // Asia/Shanghai
+    { 5284, 167 },  // Asia/Singapore
+    { 5299, 229 },  // Asia/Srednekolymsk
+    { 5318, 771 },  // Asia/Taipei
+    { 5330, 117 },  // Asia/Tashkent
+    { 5344, 83 },  // Asia/Tbilisi
+    { 5357, 49 },  // Asia/Tehran
+    { 5369, 1119 },  // Asia/Tel_Aviv
+    { 5383, 138 },  // Asia/Thimbu
+    { 5395, 138 },  // Asia/Thimphu
+    { 5408, 1155 },  // Asia/Tokyo
+    { 5419, 146 },  // Asia/Tomsk
+    { 5430, 1379 },  // Asia/Ujung_Pandang
+    { 5449, 167 },  // Asia/Ulaanbaatar
+    { 5466, 167 },  // Asia/Ulan_Bator
+    { 5482, 138 },  // Asia/Urumqi
+    { 5494, 220 },  // Asia/Ust-Nera
+    { 5508, 146 },  // Asia/Vientiane
+    { 5523, 220 },  // Asia/Vladivostok
+    { 5540, 175 },  // Asia/Yakutsk
+    { 5553, 125 },  // Asia/Yangon
+    { 5565, 117 },  // Asia/Yekaterinburg
+    { 5584, 83 },  // Asia/Yerevan
+    { 5597, 348 },  // Atlantic/Azores
+    { 5613, 702 },  // Atlantic/Bermuda
+    { 5630, 1341 },  // Atlantic/Canary
+    { 5646, 341 },  // Atlantic/Cape_Verde
+    { 5666, 1341 },  // Atlantic/Faeroe
+    { 5682, 1341 },  // Atlantic/Faroe
+    { 5697, 744 },  // Atlantic/Jan_Mayen
+    { 5716, 1341 },  // Atlantic/Madeira
+    { 5733, 1026 },  // Atlantic/Reykjavik
+    { 5752, 379 },  // Atlantic/South_Georgia
+    { 5775, 1026 },  // Atlantic/St_Helena
+    { 5794, 418 },  // Atlantic/Stanley
+    { 5811, 643 },  // Australia/ACT
+    { 5825, 604 },  // Australia/Adelaide
+    { 5844, 635 },  // Australia/Brisbane
+    { 5863, 604 },  // Australia/Broken_Hill
+    { 5885, 643 },  // Australia/Canberra
+    { 5904, 643 },  // Australia/Currie
+    { 5921, 594 },  // Australia/Darwin
+    { 5938, 154 },  // Australia/Eucla
+    { 5954, 643 },  // Australia/Hobart
+    { 5971, 183 },  // Australia/LHI
+    { 5985, 635 },  // Australia/Lindeman
+    { 6004, 183 },  // Australia/Lord_Howe
+    { 6024, 643 },  // Australia/Melbourne
+    { 6044, 643 },  // Australia/NSW
+    { 6058, 594 },  // Australia/North
+    { 6074, 725 },  // Australia/Perth
+    { 6090, 635 },  // Australia/Queensland
+    { 6111, 604 },  // Australia/South
+    { 6127, 643 },  // Australia/Sydney
+    { 6144, 643 },  // Australia/Tasmania
+    { 6163, 643 },  // Australia/Victoria
+    { 6182, 725 },  // Australia/West
+    { 6197, 604 },  // Australia/Yancowinna
+    { 6218, 491 },  // Brazil/Acre
+    { 6230, 379 },  // Brazil/DeNoronha
+    { 6247, 418 },  // Brazil/East
+    { 6259, 452 },  // Brazil/West
+    { 6271, 744 },  // CET
+    { 6275, 809 },  // CST6CDT
+    { 6283, 702 },  // Canada/Atlantic
+    { 6299, 809 },  // Canada/Central
+    { 6314, 1003 },  // Canada/Eastern
+    { 6329, 1205 },  // Canada/Mountain
+    { 6345, 1228 },  // Canada/Newfoundland
+    { 6365, 1294 },  // Canada/Pacific
+    { 6380, 804 },  // Canada/Saskatchewan
+    { 6400, 1200 },  // Canada/Yukon
+    { 6413, 459 },  // Chile/Continental
+    { 6431, 505 },  // Chile/EasterIsland
+    { 6450, 777 },  // Cuba
+    { 6455, 939 },  // EET
+    { 6459, 998 },  // EST
+    { 6463, 1003 },  // EST5EDT
+    { 6471, 968 },  // Egypt
+    { 6477, 1092 },  // Eire
+    { 6482, 1026 },  // Etc/GMT
+    { 6490, 1026 },  // Etc/GMT+0
+    { 6500, 341 },  // Etc/GMT+1
+    { 6510, 570 },  // Etc/GMT+10
+    { 6521, 578 },  // Etc/GMT+11
+    { 6532, 586 },  // Etc/GMT+12
+    { 6543, 379 },  // Etc/GMT+2
+    { 6553, 418 },  // Etc/GMT+3
+    { 6563, 452 },  // Etc/GMT+4
+    { 6573, 491 },  // Etc/GMT+5
+    { 6583, 498 },  // Etc/GMT+6
+    { 6593, 537 },  // Etc/GMT+7
+    { 6603, 544 },  // Etc/GMT+8
+    { 6613, 563 },  // Etc/GMT+9
+    { 6623, 1026 },  // Etc/GMT-0
+    { 6633, 33 },  // Etc/GMT-1
+    { 6643, 220 },  // Etc/GMT-10
+    { 6654, 229 },  // Etc/GMT-11
+    { 6665, 314 },  // Etc/GMT-12
+    { 6676, 323 },  // Etc/GMT-13
+    { 6687, 332 },  // Etc/GMT-14
+    { 6698, 41 },  // Etc/GMT-2
+    { 6708, 62 },  // Etc/GMT-3
+    { 6718, 83 },  // Etc/GMT-4
+    { 6728, 117 },  // Etc/GMT-5
+    { 6738, 138 },  // Etc/GMT-6
+    { 6748, 146 },  // Etc/GMT-7
+    { 6758, 167 },  // Etc/GMT-8
+    { 6768, 175 },  // Etc/GMT-9
+    { 6778, 1026 },  // Etc/GMT0
+    { 6787, 1026 },  // Etc/Greenwich
+    { 6801, 1330 },  // Etc/UCT
+    { 6809, 1330 },  // Etc/UTC
+    { 6817, 1330 },  // Etc/Universal
+    { 6831, 1330 },  // Etc/Zulu
+    { 6840, 744 },  // Europe/Amsterdam
+    { 6857, 744 },  // Europe/Andorra
+    { 6872, 83 },  // Europe/Astrakhan
+    { 6889, 939 },  // Europe/Athens
+    { 6903, 1031 },  // Europe/Belfast
+    { 6918, 744 },  // Europe/Belgrade
+    { 6934, 744 },  // Europe/Berlin
+    { 6948, 744 },  // Europe/Bratislava
+    { 6966, 744 },  // Europe/Brussels
+    { 6982, 939 },  // Europe/Bucharest
+    { 6999, 744 },  // Europe/Budapest
+    { 7015, 744 },  // Europe/Busingen
+    { 7031, 883 },  // Europe/Chisinau
+    { 7047, 744 },  // Europe/Copenhagen
+    { 7065, 1092 },  // Europe/Dublin
+    { 7079, 744 },  // Europe/Gibraltar
+    { 7096, 1031 },  // Europe/Guernsey
+    { 7112, 939 },  // Europe/Helsinki
+    { 7128, 1031 },  // Europe/Isle_of_Man
+    { 7147, 62 },  // Europe/Istanbul
+    { 7163, 1031 },  // Europe/Jersey
+    { 7177, 846 },  // Europe/Kaliningrad
+    { 7196, 939 },  // Europe/Kiev
+    { 7208, 1194 },  // Europe/Kirov
+    { 7221, 939 },  // Europe/Kyiv
+    { 7233, 1341 },  // Europe/Lisbon
+    { 7247, 744 },  // Europe/Ljubljana
+    { 7264, 1031 },  // Europe/London
+    { 7278, 744 },  // Europe/Luxembourg
+    { 7296, 744 },  // Europe/Madrid
+    { 7310, 744 },  // Europe/Malta
+    { 7323, 939 },  // Europe/Mariehamn
+    { 7340, 62 },  // Europe/Minsk
+    { 7353, 744 },  // Europe/Monaco
+    { 7367, 1194 },  // Europe/Moscow
+    { 7381, 939 },  // Europe/Nicosia
+    { 7396, 744 },  // Europe/Oslo
+    { 7408, 744 },  // Europe/Paris
+    { 7421, 744 },  // Europe/Podgorica
+    { 7438, 744 },  // Europe/Prague
+    { 7452, 939 },  // Europe/Riga
+    { 7464, 744 },  // Europe/Rome
+    { 7476, 83 },  // Europe/Samara
+    { 7490, 744 },  // Europe/San_Marino
+    { 7508, 744 },  // Europe/Sarajevo
+    { 7524, 83 },  // Europe/Saratov
+    { 7539, 1194 },  // Europe/Simferopol
+    { 7557, 744 },  // Europe/Skopje
+    { 7571, 939 },  // Europe/Sofia
+    { 7584, 744 },  // Europe/Stockholm
+    { 7601, 939 },  // Europe/Tallinn
+    { 7616, 744 },  // Europe/Tirane
+    { 7630, 883 },  // Europe/Tiraspol
+    { 7646, 83 },  // Europe/Ulyanovsk
+    { 7663, 939 },  // Europe/Uzhgorod
+    { 7679, 744 },  // Europe/Vaduz
+    { 7692, 744 },  // Europe/Vatican
+    { 7707, 744 },  // Europe/Vienna
+    { 7721, 939 },  // Europe/Vilnius
+    { 7736, 1194 },  // Europe/Volgograd
+    { 7753, 744 },  // Europe/Warsaw
+    { 7767, 744 },  // Europe/Zagreb
+    { 7781, 939 },  // Europe/Zaporozhye
+    { 7799, 744 },  // Europe/Zurich
+    { 7813, 1031 },  // GB
+    { 7816, 1031 },  // GB-Eire
+    { 7824, 1026 },  // GMT
+    { 7828, 1026 },  // GMT+0
+    { 7834, 1026 },  // GMT-0
+    { 7840, 1026 },  // GMT0
+    { 7845, 1026 },  // Greenwich
+    { 7855, 1062 },  // HST
+    { 7859, 1056 },  // Hongkong
+    { 7868, 1026 },  // Iceland
+    { 7876, 840 },  // Indian/Antananarivo
+    { 7896, 138 },  // Indian/Chagos
+    { 7910, 146 },  // Indian/Christmas
+    { 7927, 125 },  // Indian/Cocos
+    { 7940, 840 },  // Indian/Comoro
+    { 7954, 117 },  // Indian/Kerguelen
+    { 7971, 83 },  // Indian/Mahe
+    { 7983, 117 },  // Indian/Maldives
+    { 7999, 83 },  // Indian/Mauritius
+    { 8016, 840 },  // Indian/Mayotte
+    { 8031, 83 },  // Indian/Reunion
+    { 8046, 49 },  // Iran
+    { 8051, 1119 },  // Israel
+    { 8058, 998 },  // Jamaica
+    { 8066, 1155 },  // Japan
+    { 8072, 314 },  // Kwajalein
+    { 8082, 846 },  // Libya
+    { 8088, 1167 },  // MET
+    { 8092, 1200 },  // MST
+    { 8096, 1205 },  // MST7MDT
+    { 8104, 1294 },  // Mexico/BajaNorte
+    { 8121, 1200 },  // Mexico/BajaSur
+    { 8136, 804 },  // Mexico/General
+    { 8151, 1254 },  // NZ
+    { 8154, 269 },  // NZ-CHAT
+    { 8162, 1205 },  // Navajo
+    { 8169, 771 },  // PRC
+    { 8173, 1294 },  // PST8PDT
+    { 8181, 323 },  // Pacific/Apia
+    { 8194, 1254 },  // Pacific/Auckland
+    { 8211, 229 },  // Pacific/Bougainville
+    { 8232, 269 },  // Pacific/Chatham
+    { 8248, 220 },  // Pacific/Chuuk
+    { 8262, 505 },  // Pacific/Easter
+    { 8277, 229 },  // Pacific/Efate
+    { 8291, 323 },  // Pacific/Enderbury
+    { 8309, 323 },  // Pacific/Fakaofo
+    { 8325, 314 },  // Pacific/Fiji
+    { 8338, 314 },  // Pacific/Funafuti
+    { 8355, 498 },  // Pacific/Galapagos
+    { 8373, 563 },  // Pacific/Gambier
+    { 8389, 229 },  // Pacific/Guadalcanal
+    { 8409, 832 },  // Pacific/Guam
+    { 8422, 1062 },  // Pacific/Honolulu
+    { 8439, 1062 },  // Pacific/Johnston
+    { 8456, 323 },  // Pacific/Kanton
+    { 8471, 332 },  // Pacific/Kiritimati
+    { 8490, 229 },  // Pacific/Kosrae
+    { 8505, 314 },  // Pacific/Kwajalein
+    { 8523, 314 },  // Pacific/Majuro
+    { 8538, 551 },  // Pacific/Marquesas
+    { 8556, 1324 },  // Pacific/Midway
+    { 8571, 314 },  // Pacific/Nauru
+    { 8585, 578 },  // Pacific/Niue
+    { 8598, 238 },  // Pacific/Norfolk
+    { 8614, 229 },  // Pacific/Noumea
+    { 8629, 1324 },  // Pacific/Pago_Pago
+    { 8647, 175 },  // Pacific/Palau
+    { 8661, 544 },  // Pacific/Pitcairn
+    { 8678, 229 },  // Pacific/Pohnpei
+    { 8694, 229 },  // Pacific/Ponape
+    { 8709, 220 },  // Pacific/Port_Moresby
+    { 8730, 570 },  // Pacific/Rarotonga
+    { 8748, 832 },  // Pacific/Saipan
+    { 8763, 1324 },  // Pacific/Samoa
+    { 8777, 570 },  // Pacific/Tahiti
+    { 8792, 314 },  // Pacific/Tarawa
+    { 8807, 323 },  // Pacific/Tongatapu
+    { 8825, 220 },  // Pacific/Truk
+    { 8838, 314 },  // Pacific/Wake
+    { 8851, 314 },  // Pacific/Wallis
+    { 8866, 220 },  // Pacific/Yap
+    { 8878, 744 },  // Poland
+    { 8885, 1341 },  // Portugal
+    { 8894, 771 },  // ROC
+    { 8898, 1161 },  // ROK
+    { 8902, 167 },  // Singapore
+    { 8912, 62 },  // Turkey
+    { 8919, 1330 },  // UCT
+    { 8923, 672 },  // US/Alaska
+    { 8933, 1068 },  // US/Aleutian
+    { 8945, 1200 },  // US/Arizona
+    { 8956, 809 },  // US/Central
+    { 8967, 1003 },  // US/East-Indiana
+    { 8983, 1003 },  // US/Eastern
+    { 8994, 1062 },  // US/Hawaii
+    { 9004, 809 },  // US/Indiana-Starke
+    { 9022, 1003 },  // US/Michigan
+    { 9034, 1205 },  // US/Mountain
+    { 9046, 1294 },  // US/Pacific
+    { 9057, 1324 },  // US/Samoa
+    { 9066, 1330 },  // UTC
+    { 9070, 1330 },  // Universal
+    { 9080, 1194 },  // W-SU
+    { 9085, 1341 },  // WET
+    { 9089, 1330 },  // Zulu
+};
@@ -0,0 +1,41 @@
+#include "tz_table.h"
+#include <string.h>
+
+#include "tz_data.h"
+
+const char* tzLookup(const char* zone) {
+    if (!zone || !*zone) {
+        return nullptr;
+    }
+    int lo = 0;
+    int hi = TZ_DATA_COUNT - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int cmp = strcmp(zone, TZ_NAMES + TZ_ENTRIES[mid].name);
+        if (cmp == 0) {
+            return TZ_RULES + TZ_ENTRIES[mid].rule;
+        }
+        if (cmp < 0) {
+            hi = mid - 1;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return nullptr;
+}
+
+const char* tzDataVersion() {
+    return TZ_DATA_VERSION;
+}
+
+int tzCount() {
+    return TZ_DATA_COUNT;
+}
+
+const char* tzZoneName(int i) {
+    return TZ_NAMES + TZ_ENTRIES[i].name;
+}
+
+const char* tzZoneRule(int i) {
+    return TZ_RULES + TZ_ENTRIES[i].rule;
+}
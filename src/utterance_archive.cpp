@@ -0,0 +1,447 @@
+#include "utterance_archive.h"
+#include "ha_assist_client.h"
+#include <LittleFS.h>
+#include <algorithm>
+
+// On-flash utterance archive implementation
+
+UtteranceArchive utteranceArchive;
+
+// ============================================
+// IMA ADPCM encoder (mono, 256-byte blocks)
+// ============================================
+
+#define ADPCM_BLOCK_ALIGN       256
+#define ADPCM_SAMPLES_PER_BLOCK 505     // 1 in header + 2 per data byte
+#define ADPCM_HEADER_SIZE       60      // RIFF + fmt(20) + fact + data
+
+static const int16_t adpcmStepTable[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+
+static const int8_t adpcmIndexTable[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+struct AdpcmState {
+    int32_t predictor;
+    int32_t index;
+};
+
+static uint8_t adpcmEncodeSample(AdpcmState& st, int16_t sample) {
+    int32_t step = adpcmStepTable[st.index];
+    int32_t diff = sample - st.predictor;
+    uint8_t nibble = 0;
+
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+
+    // Same rounding as the decoder so predictor stays in sync
+    int32_t delta = step >> 3;
+    if (diff >= step) { nibble |= 4; diff -= step; delta += step; }
+    step >>= 1;
+    if (diff >= step) { nibble |= 2; diff -= step; delta += step; }
+    step >>= 1;
+    if (diff >= step) { nibble |= 1; delta += step; }
+
+    st.predictor += (nibble & 8) ? -delta : delta;
+    if (st.predictor > 32767) st.predictor = 32767;
+    if (st.predictor < -32768) st.predictor = -32768;
+
+    st.index += adpcmIndexTable[nibble];
+    if (st.index < 0) st.index = 0;
+    if (st.index > 88) st.index = 88;
+
+    return nibble;
+}
+
+// Encode one block; missing samples at the end are padded with silence
+static void adpcmEncodeBlock(AdpcmState& st, const int16_t* samples, size_t count, uint8_t* out) {
+    int16_t first = count > 0 ? samples[0] : 0;
+    st.predictor = first;
+
+    out[0] = first & 0xFF;
+    out[1] = (first >> 8) & 0xFF;
+    out[2] = (uint8_t)st.index;
+    out[3] = 0;
+
+    for (int i = 0; i < ADPCM_BLOCK_ALIGN - 4; i++) {
+        size_t a = 1 + i * 2;
+        size_t b = a + 1;
+        uint8_t lo = adpcmEncodeSample(st, a < count ? samples[a] : 0);
+        uint8_t hi = adpcmEncodeSample(st, b < count ? samples[b] : 0);
+        out[4 + i] = lo | (hi << 4);
+    }
+}
+
+static void putLE16(uint8_t* p, uint16_t v) { p[0] = v & 0xFF; p[1] = v >> 8; }
+static void putLE32(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; i++) p[i] = (v >> (8 * i)) & 0xFF; }
+
+static void createAdpcmWavHeader(uint8_t* h, uint32_t sampleCount, uint32_t dataSize) {
+    memcpy(h, "RIFF", 4);
+    putLE32(h + 4, ADPCM_HEADER_SIZE - 8 + dataSize);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    putLE32(h + 16, 20);
+    putLE16(h + 20, 0x0011);                                  // IMA ADPCM
+    putLE16(h + 22, 1);                                       // Mono
+    putLE32(h + 24, ASSIST_SAMPLE_RATE);
+    putLE32(h + 28, ASSIST_SAMPLE_RATE * ADPCM_BLOCK_ALIGN / ADPCM_SAMPLES_PER_BLOCK);
+    putLE16(h + 32, ADPCM_BLOCK_ALIGN);
+    putLE16(h + 34, 4);                                       // Bits per sample
+    putLE16(h + 36, 2);                                       // Extra format bytes
+    putLE16(h + 38, ADPCM_SAMPLES_PER_BLOCK);
+    memcpy(h + 40, "fact", 4);
+    putLE32(h + 44, 4);
+    putLE32(h + 48, sampleCount);
+    memcpy(h + 52, "data", 4);
+    putLE32(h + 56, dataSize);
+}
+
+// ============================================
+// UtteranceArchive
+// ============================================
+
+UtteranceArchive::UtteranceArchive()
+    : enabled(false),
+      maxEntries(ARCHIVE_DEFAULT_MAX_ENTRIES),
+      maxBytes(ARCHIVE_DEFAULT_MAX_KB * 1024),
+      entryCount(0),
+      nextId(1),
+      mutex(nullptr),
+      jobSamples(nullptr),
+      jobCapacity(0),
+      jobCount(0),
+      jobSttMs(0),
+      jobBusy(false),
+      purgeRequested(false),
+      workerTask(nullptr) {
+    memset(&stats, 0, sizeof(stats));
+    memset(&jobMetrics, 0, sizeof(jobMetrics));
+}
+
+void UtteranceArchive::begin(JsonDocument& config) {
+    JsonObject cfg = config["voice"]["archive"];
+    enabled = cfg["enabled"] | false;
+    maxEntries = constrain(cfg["max_entries"] | ARCHIVE_DEFAULT_MAX_ENTRIES, 1, ARCHIVE_MAX_ENTRIES);
+    maxBytes = (uint32_t)(cfg["max_kb"] | ARCHIVE_DEFAULT_MAX_KB) * 1024;
+
+    if (!mutex) {
+        mutex = xSemaphoreCreateMutex();
+    }
+
+    if (!LittleFS.exists(ARCHIVE_DIR)) {
+        LittleFS.mkdir(ARCHIVE_DIR);
+    }
+    loadIndex();
+
+    if (!enabled) {
+        log_i("Utterance archive disabled (%d entries on flash)", entryCount);
+        return;
+    }
+
+    if (!jobSamples) {
+        jobCapacity = ASSIST_AUDIO_BUFFER_SIZE / sizeof(int16_t);
+        jobSamples = (int16_t*)ps_malloc(jobCapacity * sizeof(int16_t));
+        if (!jobSamples) {
+            log_e("Utterance archive: failed to allocate job buffer");
+            enabled = false;
+            return;
+        }
+    }
+
+    if (!workerTask) {
+        xTaskCreatePinnedToCore(workerLoop, "archive", 6144, this, 1, &workerTask, 0);
+    }
+
+    log_i("Utterance archive: %d entries, %u KB used (max %u entries / %u KB)",
+          entryCount, usedBytes() / 1024, maxEntries, maxBytes / 1024);
+}
+
+bool UtteranceArchive::submit(const int16_t* samples, size_t count, const UtteranceMetrics& metrics, uint32_t sttMs) {
+    if (!enabled || !samples || count == 0) {
+        return false;
+    }
+
+    stats.submitted++;
+    if (jobBusy) {
+        stats.droppedBusy++;
+        log_w("Utterance archive: writer busy, dropping utterance #%u", metrics.id);
+        return false;
+    }
+
+    uint32_t start = micros();
+    jobCount = min(count, jobCapacity);
+    memcpy(jobSamples, samples, jobCount * sizeof(int16_t));
+    jobMetrics = metrics;
+    jobSttMs = sttMs;
+    jobBusy = true;
+    xTaskNotifyGive(workerTask);
+
+    stats.submitUsLast = micros() - start;
+    if (stats.submitUsLast > stats.submitUsMax) stats.submitUsMax = stats.submitUsLast;
+    return true;
+}
+
+void UtteranceArchive::requestPurge() {
+    purgeRequested = true;
+    if (workerTask) {
+        xTaskNotifyGive(workerTask);
+    } else {
+        purge();
+    }
+}
+
+void UtteranceArchive::workerLoop(void* param) {
+    UtteranceArchive* self = (UtteranceArchive*)param;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (self->purgeRequested) {
+            self->purgeRequested = false;
+            self->purge();
+        }
+        if (self->jobBusy) {
+            self->writeJob();
+            self->jobBusy = false;
+        }
+    }
+}
+
+void UtteranceArchive::writeJob() {
+    uint32_t start = millis();
+
+    uint32_t blocks = (jobCount + ADPCM_SAMPLES_PER_BLOCK - 1) / ADPCM_SAMPLES_PER_BLOCK;
+    uint32_t dataSize = blocks * ADPCM_BLOCK_ALIGN;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    enforceRetention(ADPCM_HEADER_SIZE + dataSize);
+    uint32_t id = nextId++;
+    xSemaphoreGive(mutex);
+
+    char path[40];
+    entryPath(id, false, path, sizeof(path));
+
+    File file = LittleFS.open(path, "w");
+    if (!file) {
+        log_e("Utterance archive: cannot create %s", path);
+        stats.failed++;
+        return;
+    }
+
+    // Header and blocks are staged in one sector-sized buffer so flash is
+    // written in whole 4 KB chunks
+    static uint8_t chunk[ARCHIVE_WRITE_CHUNK];
+    size_t used = ADPCM_HEADER_SIZE;
+    createAdpcmWavHeader(chunk, jobCount, dataSize);
+
+    AdpcmState st = {0, 0};
+    size_t written = 0;
+    bool ok = true;
+
+    for (uint32_t b = 0; b < blocks && ok; b++) {
+        size_t offset = (size_t)b * ADPCM_SAMPLES_PER_BLOCK;
+        size_t n = min((size_t)ADPCM_SAMPLES_PER_BLOCK, jobCount - offset);
+
+        if (used + ADPCM_BLOCK_ALIGN > sizeof(chunk)) {
+            ok = file.write(chunk, used) == used;
+            written += used;
+            used = 0;
+        }
+        adpcmEncodeBlock(st, &jobSamples[offset], n, &chunk[used]);
+        used += ADPCM_BLOCK_ALIGN;
+    }
+    if (ok && used > 0) {
+        ok = file.write(chunk, used) == used;
+        written += used;
+    }
+    file.close();
+
+    if (!ok) {
+        log_e("Utterance archive: write failed for %s", path);
+        LittleFS.remove(path);
+        stats.failed++;
+        return;
+    }
+
+    // Metadata sidecar
+    JsonDocument meta;
+    meta["id"] = id;
+    meta["codec"] = "ima_adpcm";
+    meta["sample_rate"] = ASSIST_SAMPLE_RATE;
+    meta["samples"] = jobCount;
+    meta["wav_bytes"] = written;
+    meta["stt_ms"] = jobSttMs;
+    AudioMetrics::toJson(jobMetrics, meta["metrics"].to<JsonObject>());
+
+    char metaPath[40];
+    entryPath(id, true, metaPath, sizeof(metaPath));
+    File metaFile = LittleFS.open(metaPath, "w");
+    if (metaFile) {
+        written += serializeJson(meta, metaFile);
+        metaFile.close();
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    entries[entryCount].id = id;
+    entries[entryCount].bytes = written;
+    entryCount++;
+    xSemaphoreGive(mutex);
+
+    uint32_t elapsed = millis() - start;
+    stats.written++;
+    stats.bytesWritten += written;
+    stats.writeMsLast = elapsed;
+    stats.writeMsTotal += elapsed;
+    if (elapsed > stats.writeMsMax) stats.writeMsMax = elapsed;
+
+    log_i("Utterance archive: #%u saved (%u bytes, %u ms)", id, written, elapsed);
+}
+
+// Caller holds the mutex
+void UtteranceArchive::enforceRetention(uint32_t incomingBytes) {
+    while (entryCount > 0 && entryCount >= maxEntries) {
+        removeOldest();
+    }
+    while (entryCount > 0 && usedBytes() + incomingBytes > maxBytes) {
+        removeOldest();
+    }
+
+    // Leave room for config and web files
+    size_t freeBytes = LittleFS.totalBytes() - LittleFS.usedBytes();
+    while (entryCount > 0 && freeBytes < incomingBytes + ARCHIVE_MIN_FREE_KB * 1024) {
+        freeBytes += entries[0].bytes;
+        removeOldest();
+    }
+}
+
+// Caller holds the mutex
+void UtteranceArchive::removeOldest() {
+    char path[40];
+    entryPath(entries[0].id, false, path, sizeof(path));
+    LittleFS.remove(path);
+    entryPath(entries[0].id, true, path, sizeof(path));
+    LittleFS.remove(path);
+
+    memmove(&entries[0], &entries[1], (entryCount - 1) * sizeof(Entry));
+    entryCount--;
+    stats.deleted++;
+}
+
+void UtteranceArchive::purge() {
+    // Before begin() nothing is indexed yet
+    if (!mutex) {
+        return;
+    }
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    int count = entryCount;
+    while (entryCount > 0) {
+        removeOldest();
+    }
+    xSemaphoreGive(mutex);
+
+    log_i("Utterance archive: purged %d entries", count);
+}
+
+void UtteranceArchive::loadIndex() {
+    entryCount = 0;
+    nextId = 1;
+
+    File dir = LittleFS.open(ARCHIVE_DIR);
+    if (!dir || !dir.isDirectory()) {
+        return;
+    }
+
+    File file = dir.openNextFile();
+    while (file) {
+        const char* name = file.name();
+        const char* ext = strrchr(name, '.');
+        if (ext && strcmp(ext, ".wav") == 0 && entryCount < ARCHIVE_MAX_ENTRIES) {
+            uint32_t id = strtoul(name, nullptr, 10);
+            if (id > 0) {
+                entries[entryCount].id = id;
+                entries[entryCount].bytes = file.size();
+                entryCount++;
+                if (id >= nextId) nextId = id + 1;
+            }
+        }
+        file = dir.openNextFile();
+    }
+
+    std::sort(entries, entries + entryCount, [](const Entry& a, const Entry& b) { return a.id < b.id; });
+}
+
+uint32_t UtteranceArchive::usedBytes() const {
+    uint32_t total = 0;
+    for (int i = 0; i < entryCount; i++) {
+        total += entries[i].bytes;
+    }
+    return total;
+}
+
+void UtteranceArchive::entryPath(uint32_t id, bool metadata, char* path, size_t len) {
+    snprintf(path, len, ARCHIVE_DIR "/%08u.%s", id, metadata ? "json" : "wav");
+}
+
+bool UtteranceArchive::getEntryPath(uint32_t id, bool metadata, char* path, size_t len) {
+    bool found = false;
+
+    // The web server can ask before begin() has run
+    if (!mutex) {
+        return false;
+    }
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for (int i = 0; i < entryCount; i++) {
+        if (entries[i].id == id) {
+            found = true;
+            break;
+        }
+    }
+    xSemaphoreGive(mutex);
+
+    if (found) {
+        entryPath(id, metadata, path, len);
+    }
+    return found;
+}
+
+void UtteranceArchive::getListJson(JsonDocument& doc) {
+    doc["enabled"] = enabled;
+    doc["max_entries"] = maxEntries;
+    doc["max_kb"] = maxBytes / 1024;
+    doc["writing"] = (bool)jobBusy;
+
+    JsonArray list = doc["entries"].to<JsonArray>();
+    if (mutex) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        doc["used_bytes"] = usedBytes();
+        for (int i = entryCount - 1; i >= 0; i--) {
+            JsonObject e = list.add<JsonObject>();
+            e["id"] = entries[i].id;
+            e["bytes"] = entries[i].bytes;
+        }
+        xSemaphoreGive(mutex);
+    }
+
+    JsonObject s = doc["stats"].to<JsonObject>();
+    s["submitted"] = stats.submitted;
+    s["written"] = stats.written;
+    s["dropped_busy"] = stats.droppedBusy;
+    s["failed"] = stats.failed;
+    s["deleted"] = stats.deleted;
+    s["bytes_written"] = stats.bytesWritten;
+    s["submit_us_last"] = stats.submitUsLast;
+    s["submit_us_max"] = stats.submitUsMax;
+    s["write_ms_last"] = stats.writeMsLast;
+    s["write_ms_max"] = stats.writeMsMax;
+    s["write_ms_avg"] = stats.written > 0 ? (uint32_t)(stats.writeMsTotal / stats.written) : 0;
+    s["write_kbps"] = stats.writeMsTotal > 0 ? (uint32_t)(stats.bytesWritten / stats.writeMsTotal) : 0;
+}
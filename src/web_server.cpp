@@ -1,10 +1,30 @@
 #include "web_server.h"
 #include "config.h"
 #include "storage_manager.h"
+#include "config_service.h"
 #include "mqtt_client.h"
 #include "audio_handler.h"
 #include "voice_activity_handler.h"
 #include "notification_manager.h"
+#include "lvgl_ui.h"
+#include "mic_calibration.h"
+#include "audio_metrics.h"
+#include "audio_stages.h"
+#include "utterance_archive.h"
+#include "sound_events.h"
+#include "tone_detector.h"
+#include "intercom_stream.h"
+#include "command_engine.h"
+#include "entity_index.h"
+#include "action_executor.h"
+#include "intent_dispatcher.h"
+#include "ha_websocket.h"
+#include "ha_http.h"
+#include "ha_batch.h"
+#include "job_scheduler.h"
+#include "boot_sequencer.h"
+#include "boot_profiler.h"
+#include "json_stream.h"
 #include <WiFi.h>
 #include <LittleFS.h>
 #include <HTTPClient.h>
@@ -102,6 +122,65 @@ void WebServerManager::setupAPIEndpoints() {
             handleSaveHomeAssistantConfig(request, data, len);
         });
     
+    // Per-utterance audio quality metrics
+    server.on("/api/voice/metrics", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        handleGetVoiceMetrics(request);
+    });
+    
+    // Utterance archive (sub-paths first: handlers also match "<uri>/...")
+    server.on("/api/voice/archive/download", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        handleDownloadArchive(request);
+    });
+    
+    server.on("/api/voice/archive/purge", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        utteranceArchive.requestPurge();
+        request->send(200, "application/json", "{\"success\":true}");
+    });
+    
+    server.on("/api/voice/archive", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        handleGetArchive(request);
+    });
+    
+    // Microphone calibration (sub-paths first: handlers also match "<uri>/...")
+    server.on("/api/voice/calibration", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        handleGetCalibration(request);
+    });
+    
+    server.on("/api/voice/calibrate/cancel", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        micCalibration.cancel();
+        request->send(200, "application/json", "{\"success\":true}");
+    });
+    
+    server.on("/api/voice/calibrate", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        // No body: the body callback never runs, start with the defaults
+        if (request->contentLength() == 0) {
+            handleStartCalibration(request, nullptr, 0);
+        }
+    }, NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            handleStartCalibration(request, data, len);
+        });
+    
+    // Live intercom stream (sub-paths first)
+    server.on("/api/intercom/start", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        // No body: the body callback never runs
+        if (request->contentLength() == 0) {
+            handleStartIntercom(request, nullptr, 0);
+        }
+    }, NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            handleStartIntercom(request, data, len);
+        });
+    
+    server.on("/api/intercom/stop", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        intercom.stop();
+        request->send(200, "application/json", "{\"success\":true}");
+    });
+    
+    server.on("/api/intercom", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        handleGetIntercom(request);
+    });
+    
     server.on("/api/homeassistant/test", HTTP_GET, [this](AsyncWebServerRequest *request) {
         handleCheckHomeAssistantConnection(request);
     });
@@ -123,17 +202,24 @@ void WebServerManager::setupAPIEndpoints() {
             handlePostConfig(request, data, len, index, total);
         });
     
-    // Voice commands
+    // Voice commands (sub-paths first)
+    server.on("/api/commands/delete", HTTP_POST, [this](AsyncWebServerRequest *request) {}, NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            handleDeleteCommand(request, data, len);
+        });
+    
     server.on("/api/commands", HTTP_GET, [this](AsyncWebServerRequest *request) {
         handleGetCommands(request);
     });
     
-    server.on("/api/commands", HTTP_POST, [this](AsyncWebServerRequest *request) {
-        handlePostCommand(request);
-    });
+    server.on("/api/commands", HTTP_POST, [this](AsyncWebServerRequest *request) {}, NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            handlePostCommand(request, data, len);
+        });
     
-    server.on("/api/commands/delete", HTTP_POST, [this](AsyncWebServerRequest *request) {
-        handleDeleteCommand(request);
+    // Entity index for {slot} commands
+    server.on("/api/entities/refresh", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        handleRefreshEntities(request);
     });
     
     // Presence
@@ -191,6 +277,22 @@ void WebServerManager::handleGetStatus(AsyncWebServerRequest *request) {
     
     doc["audio"]["recording"] = audioHandler.isRecording();
     doc["audio"]["buffer_size"] = audioHandler.getBufferSize();
+    getAudioPipelineStatsJson(doc["audio"]["pipeline"].to<JsonObject>());
+    soundEvents.getStatusJson(doc["sound_events"].to<JsonObject>());
+    toneMonitor.getStatusJson(doc["tones"].to<JsonObject>());
+    commandEngine.getStatusJson(doc["command_engine"].to<JsonObject>());
+    haEntities.getStatusJson(doc["entities"].to<JsonObject>());
+    actionExecutor.getStatusJson(doc["actions"].to<JsonObject>());
+    intentDispatcher.getStatusJson(doc["intents"].to<JsonObject>());
+    haSocket.getStatusJson(doc["ha_websocket"].to<JsonObject>());
+    haHttp.getStatusJson(doc["ha_http"].to<JsonObject>());
+    haBatch.getStatusJson(doc["ha_batch"].to<JsonObject>());
+    configService.getStatusJson(doc["config"].to<JsonObject>());
+    scheduler.getStatusJson(doc["scheduler"].to<JsonObject>());
+    JsonObject boot = doc["boot"].to<JsonObject>();
+    bootSequencer.getStatusJson(boot);
+    bootProfiler.getStatusJson(boot);
+    lvglUI.getStatusJson(doc["ui"].to<JsonObject>());
     
     doc["voice"]["mode"] = voiceActivity.getWakeMode() == WAKE_MODE_THRESHOLD ? "threshold" : "manual";
     doc["voice"]["active"] = voiceActivity.isVoiceDetected();
@@ -198,8 +300,7 @@ void WebServerManager::handleGetStatus(AsyncWebServerRequest *request) {
     doc["voice"]["baseline"] = voiceActivity.getAdaptiveBaseline();
     doc["voice"]["threshold"] = voiceActivity.getThreshold();
     
-    doc["storage"]["total"] = storage.getTotalSpace();
-    doc["storage"]["used"] = storage.getUsedSpace();
+    storage.getStatusJson(doc["storage"].to<JsonObject>());
     
     String response;
     serializeJson(doc, response);
@@ -207,11 +308,11 @@ void WebServerManager::handleGetStatus(AsyncWebServerRequest *request) {
 }
 
 void WebServerManager::handleGetConfig(AsyncWebServerRequest *request) {
-    JsonDocument doc;
+    ConfigRef config = configService.get();
     
-    if (storage.loadConfig(doc)) {
+    if (config->generation) {
         String response;
-        serializeJson(doc, response);
+        serializeJson(config->json, response);
         request->send(200, "application/json", response);
     } else {
         request->send(500, "application/json", "{\"error\":\"Failed to load config\"}");
@@ -251,7 +352,8 @@ void WebServerManager::handlePostConfig(AsyncWebServerRequest *request, uint8_t
     // For simplicity, let's load existing and merge top-level keys
     
     JsonDocument config;
-    if (!storage.loadConfig(config)) {
+    uint32_t generation;
+    if (!configService.copy(config, &generation)) {
         Serial.println("Warning: Could not load existing config, using defaults");
         config["device"]["name"] = DEVICE_NAME;
     }
@@ -272,11 +374,14 @@ void WebServerManager::handlePostConfig(AsyncWebServerRequest *request, uint8_t
     if (!newConfig["presence"].isNull()) config["presence"] = newConfig["presence"];
     
     Serial.println("Attempting to save config...");
-    if (storage.saveConfig(config)) {
+    if (configService.save(config, generation)) {
         Serial.println("Config saved successfully");
         request->send(200, "application/json", "{\"success\":true}");
         // Notify clients of config change
         broadcastMessage("config_updated", "Configuration updated");
+    } else if (configService.getGeneration() != generation) {
+        // Saved by someone else since we copied it; the client reloads and retries
+        request->send(409, "application/json", "{\"error\":\"Config changed meanwhile, reload and retry\"}");
     } else {
         Serial.println("Failed to save config to storage");
         request->send(500, "application/json", "{\"error\":\"Failed to save config\"}");
@@ -297,20 +402,106 @@ void WebServerManager::handleGetCommands(AsyncWebServerRequest *request) {
     }
 }
 
-void WebServerManager::handlePostCommand(AsyncWebServerRequest *request) {
-    // TODO: Implement command addition/update
-    request->send(200, "application/json", "{\"success\":true}");
+void WebServerManager::handlePostCommand(AsyncWebServerRequest *request, uint8_t *data, size_t len) {
+    JsonDocument body;
+    if (deserializeJson(body, data, len)) {
+        request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+        return;
+    }
+    
+    const char* phrase = body["command"] | "";
+    const char* action = body["action"] | "";
+    std::vector<std::string> words;
+    CommandAction parsed;
+    if (CommandMatcher::tokenize(phrase, words) == 0) {
+        request->send(400, "application/json", "{\"error\":\"Command phrase is empty\"}");
+        return;
+    }
+    if (!parseCommandAction(action, parsed)) {
+        request->send(400, "application/json", "{\"error\":\"Invalid action\"}");
+        return;
+    }
+    
+    JsonDocument doc;
+    if (!storage.loadCommands(doc)) {
+        doc["commands"].to<JsonArray>();
+    }
+    JsonArray commands = doc["commands"];
+    
+    // Update by id, otherwise append with the next free id
+    int id = body["id"] | 0;
+    int maxId = 0;
+    JsonObject entry;
+    for (JsonObject cmd : commands) {
+        int cmdId = cmd["id"] | 0;
+        if (id > 0 && cmdId == id) {
+            entry = cmd;
+        }
+        maxId = max(maxId, cmdId);
+    }
+    if (entry.isNull()) {
+        entry = commands.add<JsonObject>();
+        id = id > 0 ? id : maxId + 1;
+    }
+    
+    entry["id"] = id;
+    entry["command"] = phrase;
+    entry["action"] = action;
+    entry["category"] = body["category"] | (entry["category"] | "Custom");
+    entry["enabled"] = body["enabled"] | (entry["enabled"] | true);
+    if (body["phrases"].is<JsonArray>()) {
+        entry["phrases"] = body["phrases"];
+    }
+    
+    if (!storage.saveCommands(doc)) {
+        request->send(500, "application/json", "{\"error\":\"Failed to save commands\"}");
+        return;
+    }
+    commandEngine.requestReload();
+    
+    request->send(200, "application/json", "{\"success\":true,\"id\":" + String(id) + "}");
 }
 
-void WebServerManager::handleDeleteCommand(AsyncWebServerRequest *request) {
-    // TODO: Implement command deletion
+void WebServerManager::handleDeleteCommand(AsyncWebServerRequest *request, uint8_t *data, size_t len) {
+    JsonDocument body;
+    if (deserializeJson(body, data, len) || !(body["id"].is<int>())) {
+        request->send(400, "application/json", "{\"error\":\"Missing command id\"}");
+        return;
+    }
+    int id = body["id"];
+    
+    JsonDocument doc;
+    if (!storage.loadCommands(doc)) {
+        request->send(404, "application/json", "{\"error\":\"Command not found\"}");
+        return;
+    }
+    
+    JsonArray commands = doc["commands"];
+    for (size_t i = 0; i < commands.size(); i++) {
+        if ((commands[i]["id"] | 0) == id) {
+            commands.remove(i);
+            if (!storage.saveCommands(doc)) {
+                request->send(500, "application/json", "{\"error\":\"Failed to save commands\"}");
+                return;
+            }
+            commandEngine.requestReload();
+            request->send(200, "application/json", "{\"success\":true}");
+            return;
+        }
+    }
+    
+    request->send(404, "application/json", "{\"error\":\"Command not found\"}");
+}
+
+void WebServerManager::handleRefreshEntities(AsyncWebServerRequest *request) {
+    haEntities.requestRefresh();
     request->send(200, "application/json", "{\"success\":true}");
 }
 
 void WebServerManager::handleGetPresence(AsyncWebServerRequest *request) {
     JsonDocument config;
     
-    if (!storage.loadConfig(config)) {
+    if (!configService.copy(config)) {
         request->send(500, "application/json", "{\"error\":\"Failed to load config\"}");
         return;
     }
@@ -339,72 +530,74 @@ void WebServerManager::handleHomeAssistantPersons(AsyncWebServerRequest *request
     JsonDocument response;
     JsonArray people = response["people"].to<JsonArray>();
     
-    // Fetch each person entity from Home Assistant
+    // All persons in one /api/template round trip
+    static HAStateBatch batch;
+    batch.clear();
+    batch.addAttribute("friendly_name");
+    batch.addAttribute("icon");
+    batch.addAttribute("latitude");
+    batch.addAttribute("longitude");
+    batch.addAttribute("source");
     for (JsonVariant entityId : entityIds) {
-        String url = String(haUrl);
-        if (!url.endsWith("/")) url += "/";
-        url += "api/states/";
-        url += entityId.as<String>();
+        batch.addEntity(entityId | "");
+    }
+    
+    if (!haBatch.fetch(batch, haUrl, haToken)) {
+        String errorResponse = "{\"error\":\"Failed to connect to Home Assistant\",\"code\":";
+        errorResponse += haBatch.getLastHttpCode();
+        errorResponse += "}";
+        request->send(500, "application/json", errorResponse);
+        return;
+    }
+    
+    for (JsonVariant entityId : entityIds) {
+        const HABatchEntity* e = batch.find(entityId | "");
+        if (!e || !e->found) continue;
         
-        HTTPClient http;
-        http.begin(url);
-        http.addHeader("Authorization", String("Bearer ") + haToken);
-        http.addHeader("Content-Type", "application/json");
-        http.setTimeout(3000);
+        // Extract person data
+        JsonDocument person;
+        String entityIdStr = e->entityId;
+        String name = batch.getAttribute(*e, "friendly_name");
         
-        int httpCode = http.GET();
+        if (name.isEmpty()) {
+            name = entityIdStr.substring(entityIdStr.indexOf('.') + 1);
+            if (name.length() > 0) name[0] = toupper(name[0]); // Capitalize first letter
+        }
         
-        if (httpCode == 200) {
-            String payload = http.getString();
-            JsonDocument personDoc;
-            deserializeJson(personDoc, payload);
-            
-            // Extract person data
-            JsonDocument person;
-            String entityIdStr = entityId.as<String>();
-            String name;
-            
-            if (personDoc["attributes"]["friendly_name"]) {
-                name = personDoc["attributes"]["friendly_name"].as<String>();
-            } else {
-                name = entityIdStr.substring(entityIdStr.indexOf('.') + 1);
-                if (name.length() > 0) name[0] = toupper(name[0]); // Capitalize first letter
-            }
-            
-            person["entity_id"] = entityIdStr;
-            person["name"] = name;
-            person["present"] = (personDoc["state"].as<String>() == "home");
-            person["location"] = personDoc["state"].as<String>();
-            
-            // Get avatar from attributes if available
-            if (personDoc["attributes"]["icon"]) {
-                person["avatar"] = personDoc["attributes"]["icon"].as<String>();
+        person["entity_id"] = entityIdStr;
+        person["name"] = name;
+        person["present"] = strcmp(e->state, "home") == 0;
+        person["location"] = e->state;
+        
+        // Get avatar from attributes if available
+        const char* icon = batch.getAttribute(*e, "icon");
+        if (*icon) {
+            person["avatar"] = icon;
+        } else {
+            // Default avatars based on entity_id
+            if (entityIdStr.indexOf("john") >= 0 || entityIdStr.indexOf("dad") >= 0) {
+                person["avatar"] = "👨";
+            } else if (entityIdStr.indexOf("jane") >= 0 || entityIdStr.indexOf("mom") >= 0) {
+                person["avatar"] = "👩";
+            } else if (entityIdStr.indexOf("kid") >= 0 || entityIdStr.indexOf("child") >= 0) {
+                person["avatar"] = "👶";
             } else {
-                // Default avatars based on entity_id
-                if (entityIdStr.indexOf("john") >= 0 || entityIdStr.indexOf("dad") >= 0) {
-                    person["avatar"] = "👨";
-                } else if (entityIdStr.indexOf("jane") >= 0 || entityIdStr.indexOf("mom") >= 0) {
-                    person["avatar"] = "👩";
-                } else if (entityIdStr.indexOf("kid") >= 0 || entityIdStr.indexOf("child") >= 0) {
-                    person["avatar"] = "👶";
-                } else {
-                    person["avatar"] = "👤";
-                }
-            }
-            
-            // Get additional attributes
-            if (personDoc["attributes"]["latitude"]) {
-                person["latitude"] = personDoc["attributes"]["latitude"].as<float>();
-                person["longitude"] = personDoc["attributes"]["longitude"].as<float>();
+                person["avatar"] = "👤";
             }
-            if (personDoc["attributes"]["source"]) {
-                person["source"] = personDoc["attributes"]["source"].as<String>();
-            }
-            
-            people.add(person);
         }
         
-        http.end();
+        // Get additional attributes
+        const char* latitude = batch.getAttribute(*e, "latitude");
+        if (*latitude) {
+            person["latitude"] = atof(latitude);
+            person["longitude"] = atof(batch.getAttribute(*e, "longitude"));
+        }
+        const char* source = batch.getAttribute(*e, "source");
+        if (*source) {
+            person["source"] = source;
+        }
+        
+        people.add(person);
     }
     
     String responseStr;
@@ -428,7 +621,7 @@ void WebServerManager::handleSaveWeatherConfig(AsyncWebServerRequest *request, u
     
     // Load existing config
     JsonDocument config;
-    if (!storage.loadConfig(config)) {
+    if (!configService.copy(config)) {
         config["device"]["name"] = DEVICE_NAME;
     }
     
@@ -447,7 +640,7 @@ void WebServerManager::handleSaveWeatherConfig(AsyncWebServerRequest *request, u
     }
     
     // Save config
-    if (storage.saveConfig(config)) {
+    if (configService.save(config)) {
         request->send(200, "application/json", "{\"success\":true}");
     } else {
         request->send(500, "application/json", "{\"error\":\"Failed to save config\"}");
@@ -465,7 +658,7 @@ void WebServerManager::handleSaveVoiceConfig(AsyncWebServerRequest *request, uin
     
     // Load existing config
     JsonDocument config;
-    if (!storage.loadConfig(config)) {
+    if (!configService.copy(config)) {
         config["device"]["name"] = DEVICE_NAME;
     }
     
@@ -475,21 +668,112 @@ void WebServerManager::handleSaveVoiceConfig(AsyncWebServerRequest *request, uin
             float sensitivity = newVoiceConfig["voice"]["sensitivity"].as<float>();
             config["voice"]["sensitivity"] = sensitivity;
             
-            // Apply immediately to voice activity handler
-            voiceActivity.setSensitivity(sensitivity);
-            
+            // Applied to the voice activity handler by the config listener
             log_i("Voice sensitivity updated to: %.2f", sensitivity);
         }
     }
     
     // Save config
-    if (storage.saveConfig(config)) {
+    if (configService.save(config)) {
         request->send(200, "application/json", "{\"success\":true}");
     } else {
         request->send(500, "application/json", "{\"error\":\"Failed to save config\"}");
     }
 }
 
+void WebServerManager::handleGetVoiceMetrics(AsyncWebServerRequest *request) {
+    JsonDocument doc;
+    audioMetrics.getHistoryJson(doc);
+    
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
+void WebServerManager::handleGetArchive(AsyncWebServerRequest *request) {
+    JsonDocument doc;
+    utteranceArchive.getListJson(doc);
+    
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
+void WebServerManager::handleDownloadArchive(AsyncWebServerRequest *request) {
+    if (!request->hasParam("id")) {
+        request->send(400, "application/json", "{\"error\":\"Missing id\"}");
+        return;
+    }
+    
+    uint32_t id = request->getParam("id")->value().toInt();
+    bool metadata = request->hasParam("type") && request->getParam("type")->value() == "json";
+    
+    char path[40];
+    if (!utteranceArchive.getEntryPath(id, metadata, path, sizeof(path)) || !LittleFS.exists(path)) {
+        request->send(404, "application/json", "{\"error\":\"Entry not found\"}");
+        return;
+    }
+    
+    request->send(LittleFS, path, metadata ? "application/json" : "audio/wav", !metadata);
+}
+
+void WebServerManager::handleGetCalibration(AsyncWebServerRequest *request) {
+    JsonDocument doc;
+    micCalibration.getStatusJson(doc);
+    
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
+void WebServerManager::handleStartCalibration(AsyncWebServerRequest *request, uint8_t *data, size_t len) {
+    JsonDocument body;
+    if (len > 0 && deserializeJson(body, data, len)) {
+        request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+        return;
+    }
+    
+    uint16_t duration = body["duration"] | CALIBRATION_DEFAULT_NOISE_SECONDS;
+    bool phrase = body["phrase"] | false;
+    
+    if (!micCalibration.requestStart(duration, phrase)) {
+        request->send(409, "application/json", "{\"error\":\"Calibration already running\"}");
+        return;
+    }
+    
+    request->send(200, "application/json", "{\"success\":true}");
+}
+
+void WebServerManager::handleGetIntercom(AsyncWebServerRequest *request) {
+    JsonDocument doc;
+    intercom.getStatusJson(doc.to<JsonObject>());
+    
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
+void WebServerManager::handleStartIntercom(AsyncWebServerRequest *request, uint8_t *data, size_t len) {
+    JsonDocument body;
+    if (len > 0 && deserializeJson(body, data, len)) {
+        request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+        return;
+    }
+    
+    // Without a host in the body or config, stream back to the caller
+    String host = body["host"] | "";
+    if (host.isEmpty() && !intercom.hasDefaultHost()) {
+        host = request->client()->remoteIP().toString();
+    }
+    
+    if (!intercom.start(host.c_str(), body["port"] | 0)) {
+        request->send(503, "application/json", "{\"error\":\"Cannot start intercom stream\"}");
+        return;
+    }
+    
+    request->send(200, "application/json", "{\"success\":true}");
+}
+
 void WebServerManager::handleSaveHomeAssistantConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len) {
     JsonDocument newHAConfig;
     DeserializationError error = deserializeJson(newHAConfig, data, len);
@@ -501,7 +785,7 @@ void WebServerManager::handleSaveHomeAssistantConfig(AsyncWebServerRequest *requ
     
     // Load existing config
     JsonDocument config;
-    if (!storage.loadConfig(config)) {
+    if (!configService.copy(config)) {
         config["device"]["name"] = DEVICE_NAME;
     }
     
@@ -509,7 +793,7 @@ void WebServerManager::handleSaveHomeAssistantConfig(AsyncWebServerRequest *requ
     config["integrations"]["home_assistant"] = newHAConfig;
     
     // Save config
-    if (storage.saveConfig(config)) {
+    if (configService.save(config)) {
         request->send(200, "application/json", "{\"success\":true}");
         Serial.println("Home Assistant configuration updated");
     } else {
@@ -520,7 +804,7 @@ void WebServerManager::handleSaveHomeAssistantConfig(AsyncWebServerRequest *requ
 void WebServerManager::handleCheckHomeAssistantConnection(AsyncWebServerRequest *request) {
     JsonDocument config;
     
-    if (!storage.loadConfig(config)) {
+    if (!configService.copy(config)) {
         request->send(500, "application/json", "{\"error\":\"Failed to load config\"}");
         return;
     }
@@ -543,25 +827,28 @@ void WebServerManager::handleCheckHomeAssistantConnection(AsyncWebServerRequest
     if (!url.endsWith("/")) url += "/";
     url += "api/config";
     
-    HTTPClient http;
-    http.begin(url);
-    http.addHeader("Authorization", String("Bearer ") + haToken);
+    HARequest http(url, haToken);
     http.addHeader("Content-Type", "application/json");
     
     int httpCode = http.GET();
     
     if (httpCode == 200) {
-        String payload = http.getString();
-        http.end();
-        
-        // Parse HA config response
-        JsonDocument haConfig;
-        deserializeJson(haConfig, payload);
-        
+        // Parse HA config response; the component list is skipped unstored
         JsonDocument response;
         response["connected"] = true;
-        response["version"] = haConfig["version"].as<String>();
-        response["location_name"] = haConfig["location_name"].as<String>();
+        response["version"] = "null";
+        response["location_name"] = "null";
+        
+        JsonStreamParser parser;
+        parser.begin([](JsonStreamParser& p, JsonStreamType type, const char* value, size_t len, void* ctx) {
+            JsonDocument& response = *(JsonDocument*)ctx;
+            if (p.match("version") || p.match("location_name")) {
+                response[p.getKey(0)] = value;
+            }
+        }, nullptr, &response);
+        http.readJson(parser);
+        http.end();
+        
         response["url"] = haUrl;
         
         String responseStr;
@@ -579,7 +866,7 @@ void WebServerManager::handleCheckHomeAssistantConnection(AsyncWebServerRequest
 void WebServerManager::handleGetHomeAssistantPersons(AsyncWebServerRequest *request) {
     JsonDocument config;
     
-    if (!storage.loadConfig(config)) {
+    if (!configService.copy(config)) {
         request->send(500, "application/json", "{\"error\":\"Failed to load config\"}");
         return;
     }
@@ -597,11 +884,8 @@ void WebServerManager::handleGetHomeAssistantPersons(AsyncWebServerRequest *requ
     if (!url.endsWith("/")) url += "/";
     url += "api/template";
     
-    HTTPClient http;
-    http.begin(url);
-    http.addHeader("Authorization", String("Bearer ") + haToken);
+    HARequest http(url, haToken, 10000);
     http.addHeader("Content-Type", "application/json");
-    http.setTimeout(10000);
     
     // Template to get person entities with their state and friendly name
     String templatePayload = "{\"template\":\"[{% for person in states.person %}{\\\"entity_id\\\":\\\"{{ person.entity_id }}\\\",\\\"state\\\":\\\"{{ person.state }}\\\",\\\"name\\\":\\\"{{ person.attributes.friendly_name | default(person.name) }}\\\"}{% if not loop.last %},{% endif %}{% endfor %}]\"}";
@@ -644,7 +928,7 @@ void WebServerManager::handleGetHomeAssistantPersons(AsyncWebServerRequest *requ
 void WebServerManager::handleGetHomeAssistantWeatherEntities(AsyncWebServerRequest *request) {
     JsonDocument config;
     
-    if (!storage.loadConfig(config)) {
+    if (!configService.copy(config)) {
         request->send(500, "application/json", "{\"error\":\"Failed to load config\"}");
         return;
     }
@@ -662,11 +946,8 @@ void WebServerManager::handleGetHomeAssistantWeatherEntities(AsyncWebServerReque
     if (!url.endsWith("/")) url += "/";
     url += "api/template";
     
-    HTTPClient http;
-    http.begin(url);
-    http.addHeader("Authorization", String("Bearer ") + haToken);
+    HARequest http(url, haToken, 10000);
     http.addHeader("Content-Type", "application/json");
-    http.setTimeout(10000);
     
     // Template to get weather entities with their friendly name
     String templatePayload = "{\"template\":\"[{% for weather in states.weather %}{\\\"entity_id\\\":\\\"{{ weather.entity_id }}\\\",\\\"state\\\":\\\"{{ weather.state }}\\\",\\\"name\\\":\\\"{{ weather.attributes.friendly_name | default(weather.name) }}\\\"}{% if not loop.last %},{% endif %}{% endfor %}]\"}";
@@ -701,7 +982,7 @@ void WebServerManager::handleGetHomeAssistantWeatherEntities(AsyncWebServerReque
 void WebServerManager::handleGetHomeAssistantCalendarEntities(AsyncWebServerRequest *request) {
     JsonDocument config;
     
-    if (!storage.loadConfig(config)) {
+    if (!configService.copy(config)) {
         request->send(500, "application/json", "{\"error\":\"Failed to load config\"}");
         return;
     }
@@ -719,11 +1000,8 @@ void WebServerManager::handleGetHomeAssistantCalendarEntities(AsyncWebServerRequ
     if (!url.endsWith("/")) url += "/";
     url += "api/template";
     
-    HTTPClient http;
-    http.begin(url);
-    http.addHeader("Authorization", String("Bearer ") + haToken);
+    HARequest http(url, haToken, 10000);
     http.addHeader("Content-Type", "application/json");
-    http.setTimeout(10000);
     
     // Template to get calendar entities with their friendly name
     String templatePayload = "{\"template\":\"[{% for cal in states.calendar %}{\\\"entity_id\\\":\\\"{{ cal.entity_id }}\\\",\\\"state\\\":\\\"{{ cal.state }}\\\",\\\"name\\\":\\\"{{ cal.attributes.friendly_name | default(cal.name) }}\\\"}{% if not loop.last %},{% endif %}{% endfor %}]\"}";
@@ -758,7 +1036,7 @@ void WebServerManager::handleGetHomeAssistantCalendarEntities(AsyncWebServerRequ
 void WebServerManager::handleGetWeather(AsyncWebServerRequest *request) {
     JsonDocument config;
     
-    if (!storage.loadConfig(config)) {
+    if (!configService.copy(config)) {
         request->send(500, "application/json", "{\"error\":\"Failed to load config\"}");
         return;
     }
@@ -832,35 +1110,38 @@ void WebServerManager::handleHomeAssistantWeather(AsyncWebServerRequest *request
     url += entityId;
     
     // Make HTTP request
-    HTTPClient http;
-    http.begin(url);
-    
-    // Add authorization header if token is provided
-    if (haToken && strlen(haToken) > 0) {
-        String auth = "Bearer ";
-        auth += haToken;
-        http.addHeader("Authorization", auth);
-    }
+    // Authorization is only added if a token is configured
+    HARequest http(url, haToken);
     
     int httpCode = http.GET();
     
     if (httpCode == 200) {
-        String payload = http.getString();
-        http.end();
-        
-        // Parse and transform HA response to standard format
-        JsonDocument haDoc;
-        deserializeJson(haDoc, payload);
-        
+        // Parse and transform HA response to standard format while it
+        // streams in; forecast and other attributes are skipped unstored
         JsonDocument weather;
-        weather["state"] = haDoc["state"].as<String>();
-        weather["temperature"] = haDoc["attributes"]["temperature"];
-        weather["humidity"] = haDoc["attributes"]["humidity"];
-        weather["pressure"] = haDoc["attributes"]["pressure"];
-        weather["wind_speed"] = haDoc["attributes"]["wind_speed"];
-        weather["description"] = haDoc["state"].as<String>();
+        weather["state"] = "null";
+        weather["temperature"] = nullptr;
+        weather["humidity"] = nullptr;
+        weather["pressure"] = nullptr;
+        weather["wind_speed"] = nullptr;
+        weather["description"] = "null";
         weather["provider"] = "homeassistant";
         
+        JsonStreamParser parser;
+        parser.begin([](JsonStreamParser& p, JsonStreamType type, const char* value, size_t len, void* ctx) {
+            JsonDocument& weather = *(JsonDocument*)ctx;
+            if (p.match("state")) {
+                weather["state"] = value;
+                weather["description"] = value;
+            } else if (type == JSON_STREAM_NUMBER &&
+                       (p.match("attributes.temperature") || p.match("attributes.humidity") ||
+                        p.match("attributes.pressure") || p.match("attributes.wind_speed"))) {
+                weather[p.getKey(1)] = strtod(value, nullptr);
+            }
+        }, nullptr, &weather);
+        http.readJson(parser);
+        http.end();
+        
         String response;
         serializeJson(weather, response);
         request->send(200, "application/json", response);
@@ -876,7 +1157,7 @@ void WebServerManager::handleHomeAssistantWeather(AsyncWebServerRequest *request
 void WebServerManager::handleGetCalendar(AsyncWebServerRequest *request) {
     JsonDocument config;
     
-    if (!storage.loadConfig(config)) {
+    if (!configService.copy(config)) {
         request->send(500, "application/json", "{\"error\":\"Failed to load config\"}");
         return;
     }
@@ -897,6 +1178,51 @@ void WebServerManager::handleGetCalendar(AsyncWebServerRequest *request) {
     }
 }
 
+// Admin calendar preview, filled from the streamed /api/calendars response
+struct CalendarPreview {
+    JsonArray events;
+    JsonObject current;
+    int index;                  // HA event the current entry comes from
+    int maxEvents;
+    int count;
+};
+
+static void onCalendarPreviewValue(JsonStreamParser& parser, JsonStreamType type, const char* value, size_t len, void* ctx) {
+    CalendarPreview& preview = *(CalendarPreview*)ctx;
+    if (type != JSON_STREAM_STRING || parser.getDepth() < 2 || !parser.isArray(0)) {
+        return;
+    }
+    if (parser.getIndex(0) != preview.index) {
+        if (preview.count >= preview.maxEvents) {
+            parser.stop();
+            return;
+        }
+        preview.index = parser.getIndex(0);
+        preview.current = preview.events.add<JsonObject>();
+        preview.count++;
+    }
+    JsonObject evt = preview.current;
+    
+    // Handle both dateTime and date formats; a bare string is the fallback
+    if (parser.match("[*].summary")) {
+        evt["summary"] = value;
+    } else if (parser.match("[*].start.dateTime") || parser.match("[*].start")) {
+        evt["start"] = value;
+        evt["all_day"] = false;
+    } else if (parser.match("[*].start.date") && !evt["start"].is<const char*>()) {
+        evt["start"] = value;
+        evt["all_day"] = true;
+    } else if (parser.match("[*].end.dateTime") || parser.match("[*].end")) {
+        evt["end"] = value;
+    } else if (parser.match("[*].end.date") && !evt["end"].is<const char*>()) {
+        evt["end"] = value;
+    } else if (parser.match("[*].description")) {
+        evt["description"] = value;
+    } else if (parser.match("[*].location")) {
+        evt["location"] = value;
+    }
+}
+
 void WebServerManager::handleHomeAssistantCalendar(AsyncWebServerRequest *request, JsonDocument& config) {
     const char* haUrl = config["integrations"]["home_assistant"]["url"];
     const char* haToken = config["integrations"]["home_assistant"]["token"];
@@ -946,81 +1272,36 @@ void WebServerManager::handleHomeAssistantCalendar(AsyncWebServerRequest *reques
     Serial.printf("Calendar API URL: %s\n", url.c_str());
     
     // Make HTTP request
-    HTTPClient http;
-    http.begin(url);
-    
-    String auth = "Bearer ";
-    auth += haToken;
-    http.addHeader("Authorization", auth);
+    HARequest http(url, haToken);
     http.addHeader("Content-Type", "application/json");
     
     int httpCode = http.GET();
     Serial.printf("Calendar API response code: %d\n", httpCode);
     
     if (httpCode == 200) {
-        String payload = http.getString();
-        http.end();
-        
-        Serial.printf("Calendar API response: %s\n", payload.substring(0, 500).c_str());
-        
-        // Parse HA calendar response
-        JsonDocument haDoc;
-        DeserializationError error = deserializeJson(haDoc, payload);
-        
-        if (error) {
-            Serial.printf("Calendar JSON parse error: %s\n", error.c_str());
-            request->send(500, "application/json", "{\"error\":\"Failed to parse calendar response\"}");
-            return;
-        }
-        
-        // Transform to our format and limit events
+        // Transform to our format and limit events while the HA response
+        // streams in; it is never held whole
         JsonDocument response;
         response["provider"] = "homeassistant";
         response["entity_id"] = entityId;
         
-        JsonArray events = response["events"].to<JsonArray>();
-        int count = 0;
+        CalendarPreview preview;
+        preview.events = response["events"].to<JsonArray>();
+        preview.index = -1;
+        preview.maxEvents = maxEvents;
+        preview.count = 0;
         
-        // HA returns array of events directly
-        JsonArray haEvents = haDoc.as<JsonArray>();
-        Serial.printf("Calendar events count from HA: %d\n", haEvents.size());
+        JsonStreamParser parser;
+        parser.begin(onCalendarPreviewValue, nullptr, &preview);
+        bool ok = http.readJson(parser);
+        http.end();
         
-        for (JsonVariant event : haEvents) {
-            if (count >= maxEvents) break;
-            
-            JsonObject evt = events.add<JsonObject>();
-            evt["summary"] = event["summary"];
-            
-            // Handle both dateTime and date formats
-            if (event["start"]["dateTime"]) {
-                evt["start"] = event["start"]["dateTime"];
-                evt["all_day"] = false;
-            } else if (event["start"]["date"]) {
-                evt["start"] = event["start"]["date"];
-                evt["all_day"] = true;
-            } else {
-                // Fallback - try direct start value
-                evt["start"] = event["start"];
-                evt["all_day"] = false;
-            }
-            
-            if (event["end"]["dateTime"]) {
-                evt["end"] = event["end"]["dateTime"];
-            } else if (event["end"]["date"]) {
-                evt["end"] = event["end"]["date"];
-            } else {
-                evt["end"] = event["end"];
-            }
-            
-            if (event["description"]) {
-                evt["description"] = event["description"];
-            }
-            if (event["location"]) {
-                evt["location"] = event["location"];
-            }
-            
-            count++;
+        if (!ok) {
+            Serial.printf("Calendar JSON parse error: %s\n", parser.getError() ? parser.getError() : "connection lost");
+            request->send(500, "application/json", "{\"error\":\"Failed to parse calendar response\"}");
+            return;
         }
+        Serial.printf("Calendar events returned: %d\n", preview.count);
         
         String output;
         serializeJson(response, output);
@@ -1081,12 +1362,12 @@ void WebServerManager::broadcastMessage(const char* type, const char* message) {
 
 void WebServerManager::handleValidateMqtt(AsyncWebServerRequest *request) {
     JsonDocument config;
-    if (!storage.loadConfig(config)) {
+    if (!configService.copy(config)) {
         request->send(500, "application/json", "{\"error\":\"Failed to load config\"}");
         return;
     }
     config["mqtt"]["validated"] = true;
-    if (storage.saveConfig(config)) {
+    if (configService.save(config)) {
         request->send(200, "application/json", "{\"success\":true}");
     } else {
         request->send(500, "application/json", "{\"error\":\"Failed to save config\"}");
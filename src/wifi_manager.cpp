@@ -1,6 +1,7 @@
 #include "wifi_manager.h"
 #include "config.h"
 #include "notification_manager.h"
+#include "boot_profiler.h"
 
 WiFiConnectionManager wifiMgr;
 
@@ -35,6 +36,7 @@ void WiFiConnectionManager::begin() {
     if (!wifiManager.autoConnect(apName.c_str())) {
         Serial.println("Failed to connect and hit timeout");
         delay(3000);
+        bootProfiler.noteRestart("wifi_portal");
         ESP.restart();
     }
     
@@ -125,6 +127,7 @@ void WiFiConnectionManager::handleReconnection() {
                 Serial.println("  - Signal too weak");
                 Serial.println("  - Router DHCP pool exhausted\n");
                 delay(5000);
+                bootProfiler.noteRestart("wifi_watchdog");
                 ESP.restart();
             }
             